@@ -0,0 +1,262 @@
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include "bench.h"
+
+#define MAX_BUFFERS 4096
+#define ROUNDS 3
+
+/* Buffer sizes range from 256 bytes to MAX_BUFFER_SIZE */
+#define MAX_BUFFER_SIZE (16 * 1024)
+
+typedef enum alloc_path_type {
+  ALLOC_PATH_VK     = 0,
+  ALLOC_PATH_BUDDY  = 1,
+  ALLOC_PATH_LINEAR = 2,
+} alloc_path_type;
+
+struct alloc_path {
+  const char *name;
+  alloc_path_type type;
+  uint64_t createNs;
+  uint64_t createCount;
+  uint64_t destroyNs;
+  uint64_t destroyCount;
+  uint64_t vkAllocateMemoryCount;
+};
+
+struct alloc_buffers {
+  VkDevice vkDevice;
+  struct uvr_vk_allocator *allocator;
+  uint32_t memoryTypeIndex;
+  uint32_t bufferCount;
+  VkDeviceSize sizes[MAX_BUFFERS];
+  VkBuffer vkBuffers[MAX_BUFFERS];
+  VkDeviceMemory vkDeviceMemory[MAX_BUFFERS];
+  struct uvr_vk_allocation allocations[MAX_BUFFERS];
+};
+
+
+/*
+ * Creates and binds buffer @b. uvr_vk_buffer_create(3) logs every buffer it creates, the
+ * allocator paths call uvr_vk_allocator_alloc(3) directly so only allocation cost is measured.
+ */
+int buffer_create(struct alloc_buffers *buffers, struct alloc_path *path, uint32_t b) {
+  VkMemoryRequirements memreqs;
+  VkResult res;
+
+  VkBufferCreateInfo createInfo = {};
+  createInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+  createInfo.size = buffers->sizes[b];
+  createInfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+  createInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+  res = vkCreateBuffer(buffers->vkDevice, &createInfo, uvr_vk_host_allocator_get_callbacks(), &buffers->vkBuffers[b]);
+  if (res)
+    return -1;
+
+  vkGetBufferMemoryRequirements(buffers->vkDevice, buffers->vkBuffers[b], &memreqs);
+
+  if (path->type == ALLOC_PATH_VK) {
+    VkMemoryAllocateInfo allocInfo = {};
+    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    allocInfo.allocationSize = memreqs.size;
+    allocInfo.memoryTypeIndex = buffers->memoryTypeIndex;
+
+    res = vkAllocateMemory(buffers->vkDevice, &allocInfo, uvr_vk_host_allocator_get_callbacks(), &buffers->vkDeviceMemory[b]);
+    if (res)
+      return -1;
+
+    path->vkAllocateMemoryCount++;
+    res = vkBindBufferMemory(buffers->vkDevice, buffers->vkBuffers[b], buffers->vkDeviceMemory[b], 0);
+  } else {
+    struct uvr_vk_allocator_alloc_info allocInfo;
+    allocInfo.allocator = buffers->allocator;
+    allocInfo.memoryRequirements = memreqs;
+    allocInfo.memoryPropertyFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+    allocInfo.mode = (path->type == ALLOC_PATH_LINEAR) ? UVR_VK_ALLOCATION_LINEAR : UVR_VK_ALLOCATION_BUDDY;
+    allocInfo.optimalTiling = VK_FALSE;
+    allocInfo.requestedSize = buffers->sizes[b];
+
+    buffers->allocations[b] = uvr_vk_allocator_alloc(&allocInfo);
+    if (!buffers->allocations[b].vkDeviceMemory)
+      return -1;
+
+    res = vkBindBufferMemory(buffers->vkDevice, buffers->vkBuffers[b], buffers->allocations[b].vkDeviceMemory,
+                             buffers->allocations[b].offset);
+  }
+
+  return (res) ? -1 : 0;
+}
+
+
+/* Linear ranges aren't freed here, they are reclaimed together by uvr_vk_allocator_reset_linear(3) */
+void buffer_destroy(struct alloc_buffers *buffers, struct alloc_path *path, uint32_t b) {
+  vkDestroyBuffer(buffers->vkDevice, buffers->vkBuffers[b], uvr_vk_host_allocator_get_callbacks());
+  buffers->vkBuffers[b] = VK_NULL_HANDLE;
+
+  if (path->type == ALLOC_PATH_VK) {
+    vkFreeMemory(buffers->vkDevice, buffers->vkDeviceMemory[b], uvr_vk_host_allocator_get_callbacks());
+    buffers->vkDeviceMemory[b] = VK_NULL_HANDLE;
+  } else if (path->type == ALLOC_PATH_BUDDY) {
+    uvr_vk_allocator_free(buffers->allocator, &buffers->allocations[b]);
+  }
+}
+
+
+int run_round(struct alloc_buffers *buffers, struct alloc_path *path);
+
+
+/*
+ * Benchmark the allocation rate of uvr_vk_allocator against one vkAllocateMemory per buffer. Each round
+ * creates up to MAX_BUFFERS device local buffers of random size, frees and recreates every other one then
+ * frees all of them. The linear path creates and resets instead, like per-frame data.
+ *
+ * Runs on lavapipe with -Dgpu=cpu.
+ *
+ * usage: underview-renderer-benchmark-allocation-rate
+ */
+int main(void) {
+  struct bench bench;
+  struct uvr_vk_destroy appd;
+  memset(&bench, 0, sizeof(bench));
+  memset(&appd, 0, sizeof(appd));
+
+  struct alloc_buffers *buffers = NULL;
+  struct alloc_path paths[3];
+  memset(paths, 0, sizeof(paths));
+  paths[0].name = "vkAllocateMemory";
+  paths[0].type = ALLOC_PATH_VK;
+  paths[1].name = "buddy";
+  paths[1].type = ALLOC_PATH_BUDDY;
+  paths[2].name = "linear";
+  paths[2].type = ALLOC_PATH_LINEAR;
+
+  VkPhysicalDeviceProperties devprops;
+  VkPhysicalDeviceMemoryProperties memprops;
+  uint32_t p, r, b, seed = 0x12345678;
+
+  struct bench_create_info benchCreateInfo;
+  benchCreateInfo.appName = "Allocation Rate Benchmark";
+  benchCreateInfo.extent2D = (VkExtent2D) { 0, 0 };
+  benchCreateInfo.frameCount = 0;
+
+  if (bench_create(&bench, &benchCreateInfo) == -1)
+    goto exit_error;
+
+  buffers = calloc(1, sizeof(struct alloc_buffers));
+  if (!buffers)
+    goto exit_error;
+
+  vkGetPhysicalDeviceProperties(bench.phdev, &devprops);
+  vkGetPhysicalDeviceMemoryProperties(bench.phdev, &memprops);
+
+  /* Leave room for the allocator's own blocks and whatever the driver allocated internally */
+  buffers->vkDevice = bench.lgdev.vkDevice;
+  buffers->allocator = &bench.allocator;
+  buffers->bufferCount = (devprops.limits.maxMemoryAllocationCount > MAX_BUFFERS + 64) ?
+                         MAX_BUFFERS : devprops.limits.maxMemoryAllocationCount - 64;
+
+  for (b = 0; b < buffers->bufferCount; b++) {
+    seed = seed * 1664525u + 1013904223u;
+    buffers->sizes[b] = 256 + ((seed >> 8) % (MAX_BUFFER_SIZE - 256));
+  }
+
+  /* Any buffer usage is supported by at least one device local memory type */
+  buffers->memoryTypeIndex = UINT32_MAX;
+  for (b = 0; b < memprops.memoryTypeCount && buffers->memoryTypeIndex == UINT32_MAX; b++) {
+    if (memprops.memoryTypes[b].propertyFlags & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)
+      buffers->memoryTypeIndex = b;
+  }
+
+  if (buffers->memoryTypeIndex == UINT32_MAX)
+    goto exit_error;
+
+  for (r = 0; r < ROUNDS; r++) {
+    for (p = 0; p < ARRAY_LEN(paths); p++) {
+      uint64_t vkAllocateMemoryCount = bench.allocator.vkAllocateMemoryCount;
+
+      if (run_round(buffers, &paths[p]) == -1)
+        goto exit_error;
+
+      if (paths[p].type != ALLOC_PATH_VK)
+        paths[p].vkAllocateMemoryCount += bench.allocator.vkAllocateMemoryCount - vkAllocateMemoryCount;
+    }
+  }
+
+  uvr_utils_log(UVR_INFO, "%u buffers of 256 to %u bytes x %u rounds", buffers->bufferCount, MAX_BUFFER_SIZE, ROUNDS);
+  for (p = 0; p < ARRAY_LEN(paths); p++) {
+    uvr_utils_log(UVR_INFO, "%-16s: %8.0f ns/create, %8.0f ns/destroy, %" PRIu64 " vkAllocateMemory calls",
+                            paths[p].name, (double) paths[p].createNs / paths[p].createCount,
+                            (double) paths[p].destroyNs / paths[p].destroyCount, paths[p].vkAllocateMemoryCount);
+  }
+
+exit_error:
+  if (buffers) {
+    for (b = 0; b < buffers->bufferCount; b++) {
+      vkDestroyBuffer(buffers->vkDevice, buffers->vkBuffers[b], uvr_vk_host_allocator_get_callbacks());
+      vkFreeMemory(buffers->vkDevice, buffers->vkDeviceMemory[b], uvr_vk_host_allocator_get_callbacks());
+      uvr_vk_allocator_free(buffers->allocator, &buffers->allocations[b]);
+    }
+  }
+
+  free(buffers);
+  bench_destroy_info(&bench, &appd);
+  uvr_vk_destory(&appd);
+  return 0;
+}
+
+
+int run_round(struct alloc_buffers *buffers, struct alloc_path *path) {
+  uint32_t b, count = buffers->bufferCount;
+  uint64_t start;
+
+  start = bench_time_ns();
+  for (b = 0; b < count; b++) {
+    if (buffer_create(buffers, path, b) == -1)
+      return -1;
+  }
+  path->createNs += bench_time_ns() - start;
+  path->createCount += count;
+
+  if (path->type == ALLOC_PATH_LINEAR) {
+    start = bench_time_ns();
+    for (b = 0; b < count; b++)
+      buffer_destroy(buffers, path, b);
+    uvr_vk_allocator_reset_linear(buffers->allocator);
+    path->destroyNs += bench_time_ns() - start;
+    path->destroyCount += count;
+    return 0;
+  }
+
+  /* Freeing every other buffer leaves holes the recreated ones have to fit into */
+  start = bench_time_ns();
+  for (b = 1; b < count; b += 2)
+    buffer_destroy(buffers, path, b);
+  path->destroyNs += bench_time_ns() - start;
+  path->destroyCount += count / 2;
+
+  start = bench_time_ns();
+  for (b = 1; b < count; b += 2) {
+    if (buffer_create(buffers, path, b) == -1)
+      return -1;
+  }
+  path->createNs += bench_time_ns() - start;
+  path->createCount += count / 2;
+
+  if (path->type == ALLOC_PATH_BUDDY) {
+    struct uvr_vk_allocator_stats stats = uvr_vk_allocator_get_stats(buffers->allocator);
+    uvr_utils_log(UVR_INFO, "buddy: %u blocks, %" PRIu64 " of %" PRIu64 " bytes used (%" PRIu64 " requested), "
+                            "fragmentation %.3f", stats.blockCount, (uint64_t) stats.usedBytes,
+                            (uint64_t) stats.reservedBytes, (uint64_t) stats.requestedBytes, stats.fragmentation);
+  }
+
+  start = bench_time_ns();
+  for (b = 0; b < count; b++)
+    buffer_destroy(buffers, path, b);
+  path->destroyNs += bench_time_ns() - start;
+  path->destroyCount += count;
+
+  return 0;
+}
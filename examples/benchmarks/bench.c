@@ -0,0 +1,361 @@
+#include <string.h>
+#include <time.h>
+
+#include "bench.h"
+
+
+static int bench_create_device(struct bench *bench, const char *appName) {
+
+  struct uvr_vk_instance_create_info vkinst;
+  vkinst.appName = appName;
+  vkinst.engineName = "No Engine";
+  vkinst.enabledLayerCount = 0;
+  vkinst.ppEnabledLayerNames = NULL;
+  vkinst.enabledExtensionCount = 0;
+  vkinst.ppEnabledExtensionNames = NULL;
+
+  bench->instance = uvr_vk_instance_create(&vkinst);
+  if (!bench->instance)
+    return -1;
+
+  /* Pass -Dgpu=cpu or set UVR_VK_PHDEV_TYPE=cpu at runtime to select lavapipe */
+  struct uvr_vk_phdev_create_info vkphdev;
+  vkphdev.vkInst = bench->instance;
+  vkphdev.vkPhdevType = VK_PHYSICAL_DEVICE_TYPE;
+  vkphdev.enabledExtensionCount = 0;
+  vkphdev.ppEnabledExtensionNames = NULL;
+  vkphdev.pRequiredFeatures = NULL;
+#ifdef INCLUDE_KMS
+  vkphdev.kmsFd = -1;
+#endif
+
+  bench->phdev = uvr_vk_phdev_create(&vkphdev);
+  if (!bench->phdev)
+    return -1;
+
+  struct uvr_vk_queue_create_info vk_queue_info;
+  vk_queue_info.vkPhdev = bench->phdev;
+  vk_queue_info.queueFlag = VK_QUEUE_GRAPHICS_BIT;
+  vk_queue_info.preferDedicated = VK_FALSE;
+
+  bench->graphics_queue = uvr_vk_queue_create(&vk_queue_info);
+  if (bench->graphics_queue.familyIndex == -1)
+    return -1;
+
+  VkPhysicalDeviceFeatures phdevfeats = uvr_vk_get_phdev_features(bench->phdev);
+
+  VkPhysicalDeviceVulkan13Features vk13features = {};
+  vk13features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES;
+  vk13features.pNext = NULL;
+  vk13features.dynamicRendering = VK_TRUE;
+
+  struct uvr_vk_lgdev_create_info vk_lgdev_info;
+  vk_lgdev_info.vkInst = bench->instance;
+  vk_lgdev_info.vkPhdev = bench->phdev;
+  vk_lgdev_info.pNext = &vk13features;
+  vk_lgdev_info.pEnabledFeatures = &phdevfeats;
+  vk_lgdev_info.enableDescriptorIndexing = VK_FALSE;
+  vk_lgdev_info.enabledExtensionCount = 0;
+  vk_lgdev_info.ppEnabledExtensionNames = NULL;
+  vk_lgdev_info.queueCount = 1;
+  vk_lgdev_info.queues = &bench->graphics_queue;
+
+  bench->lgdev = uvr_vk_lgdev_create(&vk_lgdev_info);
+  if (!bench->lgdev.vkDevice)
+    return -1;
+
+  struct uvr_vk_allocator_create_info allocatorCreateInfo;
+  allocatorCreateInfo.vkPhdev = bench->phdev;
+  allocatorCreateInfo.vkDevice = bench->lgdev.vkDevice;
+  allocatorCreateInfo.blockSize = 0;
+
+  bench->allocator = uvr_vk_allocator_create(&allocatorCreateInfo);
+  if (!bench->allocator.vkDevice)
+    return -1;
+
+  return 0;
+}
+
+
+static int bench_create_shader_modules(struct bench *bench) {
+  int ret = -1;
+
+  struct uvr_shader_destroy shadercd;
+  memset(&shadercd, 0, sizeof(shadercd));
+
+#ifdef INCLUDE_SHADERC
+  const char vertex_shader[] =
+    "#version 450\n"
+    "layout(location = 0) out vec3 v_Color;\n"
+    "vec2 positions[3] = vec2[](vec2(0.0, -0.5), vec2(0.5, 0.5), vec2(-0.5, 0.5));\n"
+    "vec3 colors[3] = vec3[](vec3(1.0, 0.0, 0.0), vec3(0.0, 1.0, 0.0), vec3(0.0, 0.0, 1.0));\n"
+    "void main() {\n"
+    "  gl_Position = vec4(positions[gl_VertexIndex], 0.0, 1.0);\n"
+    "  v_Color = colors[gl_VertexIndex];\n"
+    "}";
+
+  const char fragment_shader[] =
+    "#version 450\n"
+    "layout(location = 0) in vec3 v_Color;\n"
+    "layout(location = 0) out vec4 o_Color;\n"
+    "void main() { o_Color = vec4(v_Color, 1.0); }";
+
+  struct uvr_shader_spirv_create_info vert_shader_create_info;
+  vert_shader_create_info.kind = VK_SHADER_STAGE_VERTEX_BIT;
+  vert_shader_create_info.source = vertex_shader;
+  vert_shader_create_info.filename = "vert.spv";
+  vert_shader_create_info.entryPoint = "main";
+
+  struct uvr_shader_spirv_create_info frag_shader_create_info;
+  frag_shader_create_info.kind = VK_SHADER_STAGE_FRAGMENT_BIT;
+  frag_shader_create_info.source = fragment_shader;
+  frag_shader_create_info.filename = "frag.spv";
+  frag_shader_create_info.entryPoint = "main";
+
+  struct uvr_shader_spirv vertex = uvr_shader_compile_buffer_to_spirv(&vert_shader_create_info);
+  struct uvr_shader_spirv fragment = uvr_shader_compile_buffer_to_spirv(&frag_shader_create_info);
+#else
+  struct uvr_shader_file vertex = uvr_shader_file_load(HEADLESS_TRIANGLE_VERTEX_SHADER_SPIRV);
+  struct uvr_shader_file fragment = uvr_shader_file_load(TRIANGLE_FRAGMENT_SHADER_SPIRV);
+#endif
+
+  if (!vertex.bytes || !fragment.bytes)
+    goto exit_bench_create_shader_modules;
+
+  struct uvr_vk_shader_module_create_info vertex_shader_module_create_info;
+  vertex_shader_module_create_info.vkDevice = bench->lgdev.vkDevice;
+  vertex_shader_module_create_info.codeSize = vertex.byteSize;
+  vertex_shader_module_create_info.pCode = vertex.bytes;
+  vertex_shader_module_create_info.name = "vertex";
+
+  bench->shader_modules[0] = uvr_vk_shader_module_create(&vertex_shader_module_create_info);
+  if (!bench->shader_modules[0].shader)
+    goto exit_bench_create_shader_modules;
+
+  struct uvr_vk_shader_module_create_info frag_shader_module_create_info;
+  frag_shader_module_create_info.vkDevice = bench->lgdev.vkDevice;
+  frag_shader_module_create_info.codeSize = fragment.byteSize;
+  frag_shader_module_create_info.pCode = fragment.bytes;
+  frag_shader_module_create_info.name = "fragment";
+
+  bench->shader_modules[1] = uvr_vk_shader_module_create(&frag_shader_module_create_info);
+  if (!bench->shader_modules[1].shader)
+    goto exit_bench_create_shader_modules;
+
+  ret = 0;
+
+exit_bench_create_shader_modules:
+  /* SPIR-V is only needed until the modules exist */
+#ifdef INCLUDE_SHADERC
+  shadercd.uvr_shader_spirv = vertex;
+  uvr_shader_destroy(&shadercd);
+  shadercd.uvr_shader_spirv = fragment;
+  uvr_shader_destroy(&shadercd);
+#else
+  shadercd.uvr_shader_file = vertex;
+  uvr_shader_destroy(&shadercd);
+  shadercd.uvr_shader_file = fragment;
+  uvr_shader_destroy(&shadercd);
+#endif
+  return ret;
+}
+
+
+static int bench_create_pipeline_info(struct bench *bench) {
+  bench->shaderStages[0] = (VkPipelineShaderStageCreateInfo) {};
+  bench->shaderStages[0].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+  bench->shaderStages[0].stage = VK_SHADER_STAGE_VERTEX_BIT;
+  bench->shaderStages[0].module = bench->shader_modules[0].shader;
+  bench->shaderStages[0].pName = "main";
+
+  bench->shaderStages[1] = (VkPipelineShaderStageCreateInfo) {};
+  bench->shaderStages[1].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+  bench->shaderStages[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+  bench->shaderStages[1].module = bench->shader_modules[1].shader;
+  bench->shaderStages[1].pName = "main";
+
+  bench->vertexInput = (VkPipelineVertexInputStateCreateInfo) {};
+  bench->vertexInput.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+
+  bench->inputAssembly = (VkPipelineInputAssemblyStateCreateInfo) {};
+  bench->inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+  bench->inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+  bench->inputAssembly.primitiveRestartEnable = VK_FALSE;
+
+  bench->viewportState = (VkPipelineViewportStateCreateInfo) {};
+  bench->viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+  bench->viewportState.viewportCount = 1;
+  bench->viewportState.scissorCount = 1;
+
+  bench->rasterizer = (VkPipelineRasterizationStateCreateInfo) {};
+  bench->rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+  bench->rasterizer.polygonMode = VK_POLYGON_MODE_FILL;
+  bench->rasterizer.lineWidth = 1.0f;
+  bench->rasterizer.cullMode = VK_CULL_MODE_NONE;
+  bench->rasterizer.frontFace = VK_FRONT_FACE_CLOCKWISE;
+
+  bench->multisampling = (VkPipelineMultisampleStateCreateInfo) {};
+  bench->multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+  bench->multisampling.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+  bench->multisampling.minSampleShading = 1.0f;
+
+  bench->colorBlendAttachment = (VkPipelineColorBlendAttachmentState) {};
+  bench->colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+  bench->colorBlendAttachment.blendEnable = VK_FALSE;
+
+  bench->colorBlending = (VkPipelineColorBlendStateCreateInfo) {};
+  bench->colorBlending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+  bench->colorBlending.attachmentCount = 1;
+  bench->colorBlending.pAttachments = &bench->colorBlendAttachment;
+
+  struct uvr_vk_dynamic_state_create_info dynamicStateInfo;
+  dynamicStateInfo.vkPhdev = bench->phdev;
+  dynamicStateInfo.vkDevice = bench->lgdev.vkDevice;
+  dynamicStateInfo.flags = UVR_VK_DYNAMIC_STATE_VIEWPORT_SCISSOR;
+  dynamicStateInfo.extendedDynamicState3Enabled = VK_FALSE;
+
+  if (uvr_vk_dynamic_state_init(&bench->dynstate, &dynamicStateInfo) == -1)
+    return -1;
+
+  struct uvr_vk_pipeline_layout_create_info gplayout_info;
+  gplayout_info.vkDevice = bench->lgdev.vkDevice;
+  gplayout_info.setLayoutCount = 0;
+  gplayout_info.pSetLayouts = NULL;
+  gplayout_info.pushConstantRangeCount = 0;
+  gplayout_info.pPushConstantRanges = NULL;
+
+  bench->gplayout = uvr_vk_pipeline_layout_create(&gplayout_info);
+  if (!bench->gplayout.vkPipelineLayout)
+    return -1;
+
+  bench->renderingInfo = (VkPipelineRenderingCreateInfo) {};
+  bench->renderingInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO;
+  bench->renderingInfo.colorAttachmentCount = 1;
+  bench->renderingInfo.pColorAttachmentFormats = &bench->colorFormat;
+  bench->renderingInfo.depthAttachmentFormat = VK_FORMAT_UNDEFINED;
+  bench->renderingInfo.stencilAttachmentFormat = VK_FORMAT_UNDEFINED;
+
+  bench->gpipelineInfo.vkDevice = bench->lgdev.vkDevice;
+  bench->gpipelineInfo.stageCount = ARRAY_LEN(bench->shaderStages);
+  bench->gpipelineInfo.pStages = bench->shaderStages;
+  bench->gpipelineInfo.pVertexInputState = &bench->vertexInput;
+  bench->gpipelineInfo.pInputAssemblyState = &bench->inputAssembly;
+  bench->gpipelineInfo.pTessellationState = NULL;
+  bench->gpipelineInfo.pViewportState = &bench->viewportState;
+  bench->gpipelineInfo.pRasterizationState = &bench->rasterizer;
+  bench->gpipelineInfo.pMultisampleState = &bench->multisampling;
+  bench->gpipelineInfo.pDepthStencilState = NULL;
+  bench->gpipelineInfo.pColorBlendState = &bench->colorBlending;
+  bench->gpipelineInfo.pDynamicState = &bench->dynstate.createInfo;
+  bench->gpipelineInfo.vkPipelineLayout = bench->gplayout.vkPipelineLayout;
+  bench->gpipelineInfo.renderPass = VK_NULL_HANDLE;
+  bench->gpipelineInfo.subpass = 0;
+  bench->gpipelineInfo.vkPipelineCache = VK_NULL_HANDLE;
+  bench->gpipelineInfo.pRenderingInfo = &bench->renderingInfo;
+
+  return 0;
+}
+
+
+int bench_create(struct bench *bench, struct bench_create_info *info) {
+  bench->colorFormat = VK_FORMAT_R8G8B8A8_UNORM;
+
+  if (bench_create_device(bench, info->appName) == -1)
+    return -1;
+
+  if (info->extent2D.width && info->extent2D.height) {
+    struct uvr_vk_headless_target_create_info targetCreateInfo;
+    targetCreateInfo.allocator = &bench->allocator;
+    targetCreateInfo.vkQueue = bench->graphics_queue.vkQueue;
+    targetCreateInfo.queueFamilyIndex = bench->graphics_queue.familyIndex;
+    targetCreateInfo.format = bench->colorFormat;
+    targetCreateInfo.extent2D = info->extent2D;
+    targetCreateInfo.frameCount = info->frameCount;
+    targetCreateInfo.imageUsage = 0;
+    targetCreateInfo.readbackInterval = 0;
+    targetCreateInfo.readbackLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    targetCreateInfo.readback = NULL;
+    targetCreateInfo.readbackUserData = NULL;
+
+    bench->target = uvr_vk_headless_target_create(&targetCreateInfo);
+    if (!bench->target.vkSyncs.vkFences)
+      return -1;
+  }
+
+  if (bench_create_shader_modules(bench) == -1)
+    return -1;
+
+  if (bench_create_pipeline_info(bench) == -1)
+    return -1;
+
+  return 0;
+}
+
+
+void bench_destroy_info(struct bench *bench, struct uvr_vk_destroy *appd) {
+  appd->vkinst = bench->instance;
+  appd->uvr_vk_lgdev_cnt = 1;
+  appd->uvr_vk_lgdev = &bench->lgdev;
+  appd->uvr_vk_shader_module_cnt = ARRAY_LEN(bench->shader_modules);
+  appd->uvr_vk_shader_module = bench->shader_modules;
+  appd->uvr_vk_pipeline_layout_cnt = 1;
+  appd->uvr_vk_pipeline_layout = &bench->gplayout;
+  appd->uvr_vk_headless_target_cnt = 1;
+  appd->uvr_vk_headless_target = &bench->target;
+  appd->uvr_vk_allocator_cnt = 1;
+  appd->uvr_vk_allocator = &bench->allocator;
+}
+
+
+void bench_rendering_begin(struct bench *bench, struct uvr_vk_frame *frame, VkRenderingFlags renderingFlags) {
+  VkRect2D renderArea = {};
+  renderArea.extent = bench->target.extent2D;
+
+  /* Black with 100% opacity */
+  VkClearValue clearColor[1];
+  memset(clearColor, 0, sizeof(clearColor));
+  clearColor[0].color.float32[3] = 1.0f;
+
+  VkImage image = bench->target.images.vkImages[frame->imageIndex].image;
+  VkImageView imageView = bench->target.images.vkImageViews[frame->imageIndex].view;
+
+  struct uvr_vk_rendering_begin_info renderingBeginInfo;
+  renderingBeginInfo.vkCommandBuffer = frame->vkCommandBuffer;
+  renderingBeginInfo.renderArea = renderArea;
+  renderingBeginInfo.colorAttachmentCount = 1;
+  renderingBeginInfo.pColorImages = &image;
+  renderingBeginInfo.pColorImageViews = &imageView;
+  renderingBeginInfo.colorOldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+  renderingBeginInfo.colorLoadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+  renderingBeginInfo.colorStoreOp = VK_ATTACHMENT_STORE_OP_STORE;
+  renderingBeginInfo.pColorClearValues = clearColor;
+  renderingBeginInfo.depthImage = VK_NULL_HANDLE;
+  renderingBeginInfo.depthImageView = VK_NULL_HANDLE;
+  renderingBeginInfo.depthOldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+  renderingBeginInfo.depthLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+  renderingBeginInfo.depthStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+  renderingBeginInfo.depthClearValue = clearColor[0];
+  renderingBeginInfo.renderingFlags = renderingFlags;
+
+  uvr_vk_rendering_begin(&renderingBeginInfo);
+}
+
+
+void bench_rendering_end(struct bench *bench, struct uvr_vk_frame *frame) {
+  VkImage image = bench->target.images.vkImages[frame->imageIndex].image;
+
+  struct uvr_vk_rendering_end_info renderingEndInfo;
+  renderingEndInfo.vkCommandBuffer = frame->vkCommandBuffer;
+  renderingEndInfo.colorAttachmentCount = 1;
+  renderingEndInfo.pColorImages = &image;
+  renderingEndInfo.colorFinalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+  uvr_vk_rendering_end(&renderingEndInfo);
+}
+
+
+uint64_t bench_time_ns(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint64_t) now.tv_sec * 1000000000ull + (uint64_t) now.tv_nsec;
+}
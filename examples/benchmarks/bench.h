@@ -0,0 +1,123 @@
+#ifndef UVR_BENCH_H
+#define UVR_BENCH_H
+
+#include "vulkan.h"
+#include "shader.h"
+
+/*
+ * Headless setup shared by the benchmarks: instance, device with dynamic rendering,
+ * allocator, optional headless target and the state of the headless triangle pipeline.
+ */
+
+
+/*
+ * struct bench (Benchmark Vulkan Objects)
+ *
+ * members:
+ * @instance       - VkInstance without surface extensions
+ * @phdev          - VkPhysicalDevice of type VK_PHYSICAL_DEVICE_TYPE
+ * @lgdev          - Logical device with dynamicRendering enabled
+ * @graphics_queue - Single graphics queue every benchmark submits to
+ * @allocator      - Device memory allocator. Never copied, resources keep a pointer to it.
+ * @target         - Headless render target. Zeroed if struct bench_create_info { member: extent2D } is zero.
+ * @shader_modules - Vertex and fragment shader of the headless triangle
+ * @gplayout       - Empty pipeline layout
+ * @dynstate       - Viewport and scissor dynamic state
+ * @gpipelineInfo  - Filled in create info of the triangle pipeline. Points into the state members below,
+ *                   benchmarks copy those to create pipeline variants.
+ */
+struct bench {
+  VkInstance instance;
+  VkPhysicalDevice phdev;
+  struct uvr_vk_lgdev lgdev;
+  struct uvr_vk_queue graphics_queue;
+  struct uvr_vk_allocator allocator;
+  struct uvr_vk_headless_target target;
+
+  struct uvr_vk_shader_module shader_modules[2];
+  struct uvr_vk_pipeline_layout gplayout;
+  struct uvr_vk_dynamic_state dynstate;
+
+  VkFormat colorFormat;
+  VkPipelineShaderStageCreateInfo shaderStages[2];
+  VkPipelineVertexInputStateCreateInfo vertexInput;
+  VkPipelineInputAssemblyStateCreateInfo inputAssembly;
+  VkPipelineViewportStateCreateInfo viewportState;
+  VkPipelineRasterizationStateCreateInfo rasterizer;
+  VkPipelineMultisampleStateCreateInfo multisampling;
+  VkPipelineColorBlendAttachmentState colorBlendAttachment;
+  VkPipelineColorBlendStateCreateInfo colorBlending;
+  VkPipelineRenderingCreateInfo renderingInfo;
+  struct uvr_vk_graphics_pipeline_create_info gpipelineInfo;
+};
+
+
+/*
+ * struct bench_create_info (Benchmark Create Information)
+ *
+ * members:
+ * @appName    - Name passed to the VkInstance
+ * @extent2D   - Size of the headless target. If zero no target is created.
+ * @frameCount - Frames in flight of the headless target
+ */
+struct bench_create_info {
+  const char *appName;
+  VkExtent2D extent2D;
+  uint32_t   frameCount;
+};
+
+
+/*
+ * bench_create: Creates every member of struct bench. Readback of the headless target is disabled.
+ *
+ * args:
+ * @bench - pointer to a zeroed struct bench
+ * @info  - pointer to a struct bench_create_info
+ * return:
+ *    on success 0
+ *    on failure -1 (members created so far are released by bench_destroy_info(3) + uvr_vk_destory(3))
+ */
+int bench_create(struct bench *bench, struct bench_create_info *info);
+
+
+/*
+ * bench_destroy_info: Populates the members of @appd owned by struct bench. Benchmarks add their own
+ *                     resources to @appd before passing it to uvr_vk_destory(3).
+ *
+ * args:
+ * @bench - pointer to a struct bench
+ * @appd  - pointer to a zeroed struct uvr_vk_destroy
+ */
+void bench_destroy_info(struct bench *bench, struct uvr_vk_destroy *appd);
+
+
+/*
+ * bench_rendering_begin: Begins dynamic rendering to the headless target image of @frame, clearing it
+ *
+ * args:
+ * @bench          - pointer to a struct bench
+ * @frame          - Frame handed out by uvr_vk_headless_target_acquire(3)
+ * @renderingFlags - VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT if draws are recorded into secondaries
+ */
+void bench_rendering_begin(struct bench *bench, struct uvr_vk_frame *frame, VkRenderingFlags renderingFlags);
+
+
+/*
+ * bench_rendering_end: Ends dynamic rendering begun by bench_rendering_begin(3)
+ *
+ * args:
+ * @bench - pointer to a struct bench
+ * @frame - Frame handed out by uvr_vk_headless_target_acquire(3)
+ */
+void bench_rendering_end(struct bench *bench, struct uvr_vk_frame *frame);
+
+
+/*
+ * bench_time_ns: Reads CLOCK_MONOTONIC
+ *
+ * return:
+ *    current time in nanoseconds
+ */
+uint64_t bench_time_ns(void);
+
+#endif
@@ -0,0 +1,165 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+
+#define WIDTH 1280
+#define HEIGHT 720
+#define FRAMES_IN_FLIGHT 2
+#define FRAME_COUNT 120
+#define ROUNDS 3
+#define DRAW_COUNT 10000
+
+/* Viewport/scissor are set per draw so a frame is three calls per draw */
+#define CALLS_PER_DRAW 3
+
+struct draw_data {
+  const struct uvr_vk_device_dispatch *dispatch;
+  VkPipeline pipeline;
+  VkViewport viewport;
+  VkRect2D scissor;
+};
+
+
+/* Calls resolve to libvulkan's exported trampolines, or the loader pointers with -Dvulkan-loader=dlopen */
+void record_draws_loader(VkCommandBuffer cmdBuffer, struct draw_data *draws) {
+  uint32_t d;
+
+  vkCmdBindPipeline(cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, draws->pipeline);
+  for (d = 0; d < DRAW_COUNT; d++) {
+    vkCmdSetViewport(cmdBuffer, 0, 1, &draws->viewport);
+    vkCmdSetScissor(cmdBuffer, 0, 1, &draws->scissor);
+    vkCmdDraw(cmdBuffer, 3, 1, 0, d);
+  }
+}
+
+
+void record_draws_dispatch(VkCommandBuffer cmdBuffer, struct draw_data *draws) {
+  const struct uvr_vk_device_dispatch *dispatch = draws->dispatch;
+  uint32_t d;
+
+  dispatch->CmdBindPipeline(cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, draws->pipeline);
+  for (d = 0; d < DRAW_COUNT; d++) {
+    dispatch->CmdSetViewport(cmdBuffer, 0, 1, &draws->viewport);
+    dispatch->CmdSetScissor(cmdBuffer, 0, 1, &draws->scissor);
+    dispatch->CmdDraw(cmdBuffer, 3, 1, 0, d);
+  }
+}
+
+
+int run_frames(struct bench *bench, struct draw_data *draws,
+               void (*recordFunc)(VkCommandBuffer, struct draw_data *), uint64_t *recordNs);
+
+
+/*
+ * Microbenchmark recording DRAW_COUNT draws per frame through the loader's
+ * entry points versus the device dispatch table of struct uvr_vk_lgdev.
+ * Modes alternate over ROUNDS rounds so clock and cache drift hit both.
+ *
+ * usage: underview-renderer-benchmark-dispatch-draws
+ */
+int main(void) {
+  struct bench bench;
+  struct uvr_vk_destroy appd;
+  memset(&bench, 0, sizeof(bench));
+  memset(&appd, 0, sizeof(appd));
+
+  struct uvr_vk_graphics_pipeline gpipeline;
+  memset(&gpipeline, 0, sizeof(gpipeline));
+
+  uint64_t recordNs = 0, loaderNs = 0, dispatchNs = 0;
+  double calls = (double) FRAME_COUNT * ROUNDS * DRAW_COUNT * CALLS_PER_DRAW;
+  uint32_t r;
+
+  struct bench_create_info benchCreateInfo;
+  benchCreateInfo.appName = "Dispatch Draws Benchmark";
+  benchCreateInfo.extent2D = (VkExtent2D) { WIDTH, HEIGHT };
+  benchCreateInfo.frameCount = FRAMES_IN_FLIGHT;
+
+  if (bench_create(&bench, &benchCreateInfo) == -1)
+    goto exit_error;
+
+  gpipeline = uvr_vk_graphics_pipeline_create(&bench.gpipelineInfo);
+  if (!gpipeline.graphicsPipeline)
+    goto exit_error;
+
+  struct draw_data draws;
+  draws.dispatch = bench.lgdev.dispatch;
+  draws.pipeline = gpipeline.graphicsPipeline;
+  draws.viewport = (VkViewport) { 0.0f, 0.0f, (float) WIDTH, (float) HEIGHT, 0.0f, 1.0f };
+  draws.scissor = (VkRect2D) { { 0, 0 }, { WIDTH, HEIGHT } };
+
+  for (r = 0; r < ROUNDS; r++) {
+    if (run_frames(&bench, &draws, record_draws_loader, &recordNs) == -1)
+      goto exit_error;
+    loaderNs += recordNs;
+
+    if (run_frames(&bench, &draws, record_draws_dispatch, &recordNs) == -1)
+      goto exit_error;
+    dispatchNs += recordNs;
+  }
+
+  uvr_utils_log(UVR_INFO, "%u draws x %u frames x %u rounds", DRAW_COUNT, FRAME_COUNT, ROUNDS);
+  uvr_utils_log(UVR_INFO, "loader:   %.3f ms/frame, %.2f ns/call",
+                          (double) loaderNs / 1e6 / (FRAME_COUNT * ROUNDS), (double) loaderNs / calls);
+  uvr_utils_log(UVR_INFO, "dispatch: %.3f ms/frame, %.2f ns/call (%.1f%% faster)",
+                          (double) dispatchNs / 1e6 / (FRAME_COUNT * ROUNDS), (double) dispatchNs / calls,
+                          100.0 * ((double) loaderNs - (double) dispatchNs) / (double) loaderNs);
+
+exit_error:
+  bench_destroy_info(&bench, &appd);
+  appd.uvr_vk_graphics_pipeline_cnt = 1;
+  appd.uvr_vk_graphics_pipeline = &gpipeline;
+  uvr_vk_destory(&appd);
+  return 0;
+}
+
+
+/* Renders FRAME_COUNT frames, @recordNs receives the total time spent in @recordFunc */
+int run_frames(struct bench *bench, struct draw_data *draws,
+               void (*recordFunc)(VkCommandBuffer, struct draw_data *), uint64_t *recordNs) {
+  struct uvr_vk_frame frame;
+  uint64_t f, start;
+  int ret = -1;
+
+  *recordNs = 0;
+
+  for (f = 0; f < FRAME_COUNT; f++) {
+    if (uvr_vk_headless_target_acquire(&bench->target, &frame))
+      goto exit_run_frames;
+
+    struct uvr_vk_command_buffer_record_info commandBufferRecordInfo;
+    commandBufferRecordInfo.commandBufferCount = 1;
+    commandBufferRecordInfo.vkCommandbuffers = &bench->target.vkCommandbuffs.vkCommandbuffers[frame.frameIndex];
+    commandBufferRecordInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    commandBufferRecordInfo.pInheritanceInfo = NULL;
+    commandBufferRecordInfo.queryPool = NULL;
+    commandBufferRecordInfo.queryScopeName = NULL;
+
+    if (uvr_vk_command_buffer_record_begin(&commandBufferRecordInfo) == -1)
+      goto exit_run_frames;
+
+    bench_rendering_begin(bench, &frame, 0);
+
+    start = bench_time_ns();
+    recordFunc(frame.vkCommandBuffer, draws);
+    *recordNs += bench_time_ns() - start;
+
+    bench_rendering_end(bench, &frame);
+
+    if (uvr_vk_command_buffer_record_end(&commandBufferRecordInfo) == -1)
+      goto exit_run_frames;
+
+    if (uvr_vk_headless_target_submit(&bench->target) == -1)
+      goto exit_run_frames;
+
+    if (uvr_vk_headless_target_present(&bench->target))
+      goto exit_run_frames;
+  }
+
+  ret = 0;
+
+exit_run_frames:
+  uvr_vk_headless_target_drain(&bench->target);
+  return ret;
+}
@@ -0,0 +1,135 @@
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "bench.h"
+
+#define VARIANT_COUNT 64
+#define MAX_THREADS 16
+
+struct pipeline_variants {
+  VkPipelineInputAssemblyStateCreateInfo inputAssembly[VARIANT_COUNT];
+  VkPipelineRasterizationStateCreateInfo rasterizer[VARIANT_COUNT];
+  VkPipelineColorBlendAttachmentState colorBlendAttachment[VARIANT_COUNT];
+  VkPipelineColorBlendStateCreateInfo colorBlending[VARIANT_COUNT];
+  struct uvr_vk_graphics_pipeline_create_info createInfos[VARIANT_COUNT];
+  struct uvr_vk_graphics_pipeline pipelines[VARIANT_COUNT];
+};
+
+
+/* 4 cull modes x 2 front faces x 2 topologies x 2 depth bias x 2 blend states */
+void fill_pipeline_variants(struct bench *bench, struct pipeline_variants *variants) {
+  static const VkCullModeFlags cullModes[] = {
+    VK_CULL_MODE_NONE, VK_CULL_MODE_FRONT_BIT, VK_CULL_MODE_BACK_BIT, VK_CULL_MODE_FRONT_AND_BACK
+  };
+
+  uint32_t v;
+
+  for (v = 0; v < VARIANT_COUNT; v++) {
+    variants->inputAssembly[v] = bench->inputAssembly;
+    variants->inputAssembly[v].topology = (v & 0x8) ? VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP : VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+
+    variants->rasterizer[v] = bench->rasterizer;
+    variants->rasterizer[v].cullMode = cullModes[v & 0x3];
+    variants->rasterizer[v].frontFace = (v & 0x4) ? VK_FRONT_FACE_COUNTER_CLOCKWISE : VK_FRONT_FACE_CLOCKWISE;
+    variants->rasterizer[v].depthBiasEnable = (v & 0x10) ? VK_TRUE : VK_FALSE;
+    variants->rasterizer[v].depthBiasConstantFactor = (v & 0x10) ? 1.0f : 0.0f;
+
+    variants->colorBlendAttachment[v] = bench->colorBlendAttachment;
+    if (v & 0x20) {
+      variants->colorBlendAttachment[v].blendEnable = VK_TRUE;
+      variants->colorBlendAttachment[v].srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+      variants->colorBlendAttachment[v].dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+      variants->colorBlendAttachment[v].colorBlendOp = VK_BLEND_OP_ADD;
+      variants->colorBlendAttachment[v].srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+      variants->colorBlendAttachment[v].dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
+      variants->colorBlendAttachment[v].alphaBlendOp = VK_BLEND_OP_ADD;
+    }
+
+    variants->colorBlending[v] = bench->colorBlending;
+    variants->colorBlending[v].pAttachments = &variants->colorBlendAttachment[v];
+
+    variants->createInfos[v] = bench->gpipelineInfo;
+    variants->createInfos[v].pInputAssemblyState = &variants->inputAssembly[v];
+    variants->createInfos[v].pRasterizationState = &variants->rasterizer[v];
+    variants->createInfos[v].pColorBlendState = &variants->colorBlending[v];
+  }
+}
+
+
+/*
+ * Benchmark compiling VARIANT_COUNT graphics pipeline variants with
+ * uvr_vk_graphics_pipeline_create_batch(3) on 1..N threads.
+ *
+ * usage: underview-renderer-benchmark-pipeline-batch [max threads]
+ *
+ * No VkPipelineCache is used. Drivers with an on-disk shader cache still warm
+ * up after the first run, disable it (i.e. MESA_SHADER_CACHE_DISABLE=true)
+ * for numbers comparable across thread counts.
+ */
+int main(int argc, char *argv[]) {
+  struct bench bench;
+  struct uvr_vk_destroy appd;
+  memset(&bench, 0, sizeof(bench));
+  memset(&appd, 0, sizeof(appd));
+
+  struct pipeline_variants *variants = NULL;
+  uint32_t t, maxThreads;
+  double serialMs = 0.0;
+
+  maxThreads = (argc > 1) ? (uint32_t) strtoul(argv[1], NULL, 10) : (uint32_t) sysconf(_SC_NPROCESSORS_ONLN);
+  maxThreads = (!maxThreads) ? 1 : (maxThreads > MAX_THREADS) ? MAX_THREADS : maxThreads;
+
+  variants = calloc(1, sizeof(struct pipeline_variants));
+  if (!variants)
+    goto exit_error;
+
+  struct bench_create_info benchCreateInfo;
+  benchCreateInfo.appName = "Pipeline Batch Benchmark";
+  benchCreateInfo.extent2D = (VkExtent2D) { 0, 0 };
+  benchCreateInfo.frameCount = 0;
+
+  if (bench_create(&bench, &benchCreateInfo) == -1)
+    goto exit_error;
+
+  fill_pipeline_variants(&bench, variants);
+
+  for (t = 1; t <= maxThreads; t++) {
+    struct uvr_vk_graphics_pipeline_batch_info batchInfo;
+    batchInfo.vkDevice = bench.lgdev.vkDevice;
+    batchInfo.pipelineCount = VARIANT_COUNT;
+    batchInfo.pCreateInfos = variants->createInfos;
+    batchInfo.pPipelines = variants->pipelines;
+    batchInfo.threadCount = t;
+    batchInfo.threadPool = NULL;
+    batchInfo.pipelineCache = NULL;
+
+    struct uvr_vk_graphics_pipeline_batch_stats stats = uvr_vk_graphics_pipeline_create_batch(&batchInfo);
+
+    /* Next thread count compiles the same variants from scratch */
+    struct uvr_vk_destroy pipelined;
+    memset(&pipelined, 0, sizeof(pipelined));
+    pipelined.uvr_vk_graphics_pipeline_cnt = VARIANT_COUNT;
+    pipelined.uvr_vk_graphics_pipeline = variants->pipelines;
+    uvr_vk_destory(&pipelined);
+    memset(variants->pipelines, 0, sizeof(variants->pipelines));
+
+    if (stats.failedCount) {
+      uvr_utils_log(UVR_DANGER, "%u of %u pipeline variants failed to compile", stats.failedCount, VARIANT_COUNT);
+      goto exit_error;
+    }
+
+    if (t == 1)
+      serialMs = stats.wallMs;
+
+    uvr_utils_log(UVR_INFO, "%u pipelines %2u thread(s): %.3f ms wall, %.3f ms compile, %.2fx parallel, %.2fx over 1 thread",
+                            stats.createdCount, stats.threadCount, stats.wallMs, stats.compileMs,
+                            stats.speedup, serialMs / stats.wallMs);
+  }
+
+exit_error:
+  bench_destroy_info(&bench, &appd);
+  uvr_vk_destory(&appd);
+  free(variants);
+  return 0;
+}
@@ -0,0 +1,191 @@
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "bench.h"
+
+#define VARIANT_COUNT 16
+#define ROUNDS 3
+#define PIPELINE_CACHE_PATH "benchmark-pipeline-cache.bin"
+
+struct pipeline_variants {
+  VkPipelineInputAssemblyStateCreateInfo inputAssembly[VARIANT_COUNT];
+  VkPipelineRasterizationStateCreateInfo rasterizer[VARIANT_COUNT];
+  VkPipelineColorBlendAttachmentState colorBlendAttachment[VARIANT_COUNT];
+  VkPipelineColorBlendStateCreateInfo colorBlending[VARIANT_COUNT];
+  struct uvr_vk_graphics_pipeline_create_info createInfos[VARIANT_COUNT];
+  struct uvr_vk_graphics_pipeline pipelines[VARIANT_COUNT];
+};
+
+struct startup_time {
+  uint64_t loadNs;
+  uint64_t createNs;
+  size_t loadedSize;
+};
+
+
+/* 4 cull modes x 2 topologies x 2 blend states */
+void fill_pipeline_variants(struct bench *bench, struct pipeline_variants *variants) {
+  static const VkCullModeFlags cullModes[] = {
+    VK_CULL_MODE_NONE, VK_CULL_MODE_FRONT_BIT, VK_CULL_MODE_BACK_BIT, VK_CULL_MODE_FRONT_AND_BACK
+  };
+
+  uint32_t v;
+
+  for (v = 0; v < VARIANT_COUNT; v++) {
+    variants->inputAssembly[v] = bench->inputAssembly;
+    variants->inputAssembly[v].topology = (v & 0x4) ? VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP : VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+
+    variants->rasterizer[v] = bench->rasterizer;
+    variants->rasterizer[v].cullMode = cullModes[v & 0x3];
+
+    variants->colorBlendAttachment[v] = bench->colorBlendAttachment;
+    if (v & 0x8) {
+      variants->colorBlendAttachment[v].blendEnable = VK_TRUE;
+      variants->colorBlendAttachment[v].srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+      variants->colorBlendAttachment[v].dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+      variants->colorBlendAttachment[v].colorBlendOp = VK_BLEND_OP_ADD;
+      variants->colorBlendAttachment[v].srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+      variants->colorBlendAttachment[v].dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
+      variants->colorBlendAttachment[v].alphaBlendOp = VK_BLEND_OP_ADD;
+    }
+
+    variants->colorBlending[v] = bench->colorBlending;
+    variants->colorBlending[v].pAttachments = &variants->colorBlendAttachment[v];
+
+    variants->createInfos[v] = bench->gpipelineInfo;
+    variants->createInfos[v].pInputAssemblyState = &variants->inputAssembly[v];
+    variants->createInfos[v].pRasterizationState = &variants->rasterizer[v];
+    variants->createInfos[v].pColorBlendState = &variants->colorBlending[v];
+  }
+}
+
+
+int run_startup(struct bench *bench, struct pipeline_variants *variants, const char *filePath, struct startup_time *startup);
+
+
+/*
+ * Benchmark startup pipeline creation with struct uvr_vk_pipeline_cache. Each round deletes the on-disk
+ * blob, creates VARIANT_COUNT pipelines against an empty cache (cold start) and stores it, then creates
+ * them again against a cache seeded from the stored blob (warm start). Cache load time is part of startup.
+ *
+ * usage: underview-renderer-benchmark-pipeline-cache [cache file]
+ *
+ * Drivers with their own on-disk shader cache hide part of the cold start cost after the first run,
+ * disable it (i.e. MESA_SHADER_CACHE_DISABLE=true) to measure struct uvr_vk_pipeline_cache alone.
+ */
+int main(int argc, char *argv[]) {
+  struct bench bench;
+  struct uvr_vk_destroy appd;
+  memset(&bench, 0, sizeof(bench));
+  memset(&appd, 0, sizeof(appd));
+
+  struct pipeline_variants *variants = NULL;
+  struct startup_time cold, warm, coldTotal, warmTotal;
+  memset(&coldTotal, 0, sizeof(coldTotal));
+  memset(&warmTotal, 0, sizeof(warmTotal));
+
+  const char *filePath = (argc > 1) ? argv[1] : PIPELINE_CACHE_PATH;
+  uint32_t r;
+
+  variants = calloc(1, sizeof(struct pipeline_variants));
+  if (!variants)
+    goto exit_error;
+
+  struct bench_create_info benchCreateInfo;
+  benchCreateInfo.appName = "Pipeline Cache Benchmark";
+  benchCreateInfo.extent2D = (VkExtent2D) { 0, 0 };
+  benchCreateInfo.frameCount = 0;
+
+  if (bench_create(&bench, &benchCreateInfo) == -1)
+    goto exit_error;
+
+  fill_pipeline_variants(&bench, variants);
+
+  for (r = 0; r < ROUNDS; r++) {
+    unlink(filePath);
+
+    if (run_startup(&bench, variants, filePath, &cold) == -1)
+      goto exit_error;
+
+    if (run_startup(&bench, variants, filePath, &warm) == -1)
+      goto exit_error;
+
+    /* Blob was rejected (i.e. unwritable directory), warm numbers would just repeat the cold start */
+    if (!warm.loadedSize) {
+      uvr_utils_log(UVR_DANGER, "[x] pipeline cache blob '%s' wasn't loaded back", filePath);
+      goto exit_error;
+    }
+
+    coldTotal.loadNs += cold.loadNs;
+    coldTotal.createNs += cold.createNs;
+    warmTotal.loadNs += warm.loadNs;
+    warmTotal.createNs += warm.createNs;
+    warmTotal.loadedSize = warm.loadedSize;
+  }
+
+  uvr_utils_log(UVR_INFO, "%u pipelines x %u rounds, blob %zu bytes", VARIANT_COUNT, ROUNDS, warmTotal.loadedSize);
+  uvr_utils_log(UVR_INFO, "cold: %.3f ms (cache load %.3f ms, pipelines %.3f ms)",
+                          (double) (coldTotal.loadNs + coldTotal.createNs) / 1e6 / ROUNDS,
+                          (double) coldTotal.loadNs / 1e6 / ROUNDS, (double) coldTotal.createNs / 1e6 / ROUNDS);
+  uvr_utils_log(UVR_INFO, "warm: %.3f ms (cache load %.3f ms, pipelines %.3f ms), %.2fx faster",
+                          (double) (warmTotal.loadNs + warmTotal.createNs) / 1e6 / ROUNDS,
+                          (double) warmTotal.loadNs / 1e6 / ROUNDS, (double) warmTotal.createNs / 1e6 / ROUNDS,
+                          (double) (coldTotal.loadNs + coldTotal.createNs) / (double) (warmTotal.loadNs + warmTotal.createNs));
+
+exit_error:
+  bench_destroy_info(&bench, &appd);
+  uvr_vk_destory(&appd);
+  free(variants);
+  return 0;
+}
+
+
+/*
+ * Simulates one process start: loads the cache from @filePath, creates every variant against it,
+ * then destroys the pipelines and the cache (which writes the blob back to @filePath).
+ */
+int run_startup(struct bench *bench, struct pipeline_variants *variants, const char *filePath, struct startup_time *startup) {
+  struct uvr_vk_destroy startupd;
+  memset(&startupd, 0, sizeof(startupd));
+
+  uint32_t v;
+  uint64_t start;
+  int ret = -1;
+
+  memset(startup, 0, sizeof(struct startup_time));
+
+  start = bench_time_ns();
+
+  struct uvr_vk_pipeline_cache_create_info pcache_info;
+  pcache_info.vkPhdev = bench->phdev;
+  pcache_info.vkDevice = bench->lgdev.vkDevice;
+  pcache_info.filePath = filePath;
+
+  struct uvr_vk_pipeline_cache pcache = uvr_vk_pipeline_cache_create(&pcache_info);
+  if (!pcache.vkPipelineCache)
+    return -1;
+
+  startup->loadNs = bench_time_ns() - start;
+  startup->loadedSize = pcache.loadedSize;
+
+  start = bench_time_ns();
+  for (v = 0; v < VARIANT_COUNT; v++) {
+    variants->createInfos[v].vkPipelineCache = pcache.vkPipelineCache;
+    variants->pipelines[v] = uvr_vk_graphics_pipeline_create(&variants->createInfos[v]);
+    if (!variants->pipelines[v].graphicsPipeline)
+      goto exit_run_startup;
+  }
+  startup->createNs = bench_time_ns() - start;
+
+  ret = 0;
+
+exit_run_startup:
+  startupd.uvr_vk_graphics_pipeline_cnt = VARIANT_COUNT;
+  startupd.uvr_vk_graphics_pipeline = variants->pipelines;
+  startupd.uvr_vk_pipeline_cache_cnt = 1;
+  startupd.uvr_vk_pipeline_cache = &pcache;
+  uvr_vk_destory(&startupd);
+  memset(variants->pipelines, 0, sizeof(variants->pipelines));
+  return ret;
+}
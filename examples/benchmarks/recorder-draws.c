@@ -0,0 +1,198 @@
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "bench.h"
+
+#define WIDTH 1280
+#define HEIGHT 720
+#define FRAMES_IN_FLIGHT 2
+#define FRAME_COUNT 120
+#define DRAW_COUNT 10000
+#define MAX_THREADS 16
+
+struct draw_data {
+  const struct uvr_vk_device_dispatch *dispatch;
+  VkPipeline pipeline;
+  VkViewport viewport;
+  VkRect2D scissor;
+};
+
+
+/* Secondaries inherit no state, each worker binds the pipeline and dynamic state itself */
+void record_draws(VkCommandBuffer cmdBuffer, uint32_t UNUSED threadIndex, uint32_t first, uint32_t count, void *data) {
+  struct draw_data *draws = (struct draw_data *) data;
+  uint32_t d;
+
+  draws->dispatch->CmdBindPipeline(cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, draws->pipeline);
+  draws->dispatch->CmdSetViewport(cmdBuffer, 0, 1, &draws->viewport);
+  draws->dispatch->CmdSetScissor(cmdBuffer, 0, 1, &draws->scissor);
+  for (d = first; d < first + count; d++)
+    draws->dispatch->CmdDraw(cmdBuffer, 3, 1, 0, d);
+}
+
+
+int run_frames(struct bench *bench, struct draw_data *draws, struct uvr_vk_command_recorder *recorder, uint64_t *recordNs);
+
+
+/*
+ * Benchmark recording DRAW_COUNT draws per frame inline on the main thread,
+ * then across 1..N worker threads with struct uvr_vk_command_recorder.
+ *
+ * usage: underview-renderer-benchmark-recorder-draws [max threads]
+ */
+int main(int argc, char *argv[]) {
+  struct bench bench;
+  struct uvr_vk_destroy appd;
+  memset(&bench, 0, sizeof(bench));
+  memset(&appd, 0, sizeof(appd));
+
+  struct uvr_vk_graphics_pipeline gpipeline;
+  memset(&gpipeline, 0, sizeof(gpipeline));
+
+  uint32_t t, maxThreads;
+  uint64_t recordNs = 0;
+  double inlineMs = 0.0, ms;
+
+  maxThreads = (argc > 1) ? (uint32_t) strtoul(argv[1], NULL, 10) : (uint32_t) sysconf(_SC_NPROCESSORS_ONLN);
+  maxThreads = (!maxThreads) ? 1 : (maxThreads > MAX_THREADS) ? MAX_THREADS : maxThreads;
+
+  struct bench_create_info benchCreateInfo;
+  benchCreateInfo.appName = "Recorder Draws Benchmark";
+  benchCreateInfo.extent2D = (VkExtent2D) { WIDTH, HEIGHT };
+  benchCreateInfo.frameCount = FRAMES_IN_FLIGHT;
+
+  if (bench_create(&bench, &benchCreateInfo) == -1)
+    goto exit_error;
+
+  gpipeline = uvr_vk_graphics_pipeline_create(&bench.gpipelineInfo);
+  if (!gpipeline.graphicsPipeline)
+    goto exit_error;
+
+  struct draw_data draws;
+  draws.dispatch = bench.lgdev.dispatch;
+  draws.pipeline = gpipeline.graphicsPipeline;
+  draws.viewport = (VkViewport) { 0.0f, 0.0f, (float) WIDTH, (float) HEIGHT, 0.0f, 1.0f };
+  draws.scissor = (VkRect2D) { { 0, 0 }, { WIDTH, HEIGHT } };
+
+  if (run_frames(&bench, &draws, NULL, &recordNs) == -1)
+    goto exit_error;
+
+  inlineMs = (double) recordNs / 1e6 / FRAME_COUNT;
+  uvr_utils_log(UVR_INFO, "%u draws inline:      %.3f ms/frame", DRAW_COUNT, inlineMs);
+
+  for (t = 1; t <= maxThreads; t++) {
+    struct uvr_vk_command_recorder_create_info recorderCreateInfo;
+    recorderCreateInfo.vkDevice = bench.lgdev.vkDevice;
+    recorderCreateInfo.queueFamilyIndex = bench.graphics_queue.familyIndex;
+    recorderCreateInfo.threadCount = t;
+    recorderCreateInfo.bufferCount = FRAMES_IN_FLIGHT;
+
+    struct uvr_vk_command_recorder recorder = uvr_vk_command_recorder_create(&recorderCreateInfo);
+    if (!recorder.threadPool)
+      goto exit_error;
+
+    int ret = run_frames(&bench, &draws, &recorder, &recordNs);
+
+    /* Frames were drained, no secondary of this recorder is pending anymore */
+    struct uvr_vk_destroy recorderd;
+    memset(&recorderd, 0, sizeof(recorderd));
+    recorderd.uvr_vk_command_recorder_cnt = 1;
+    recorderd.uvr_vk_command_recorder = &recorder;
+    uvr_vk_destory(&recorderd);
+
+    if (ret == -1)
+      goto exit_error;
+
+    ms = (double) recordNs / 1e6 / FRAME_COUNT;
+    uvr_utils_log(UVR_INFO, "%u draws %2u thread(s): %.3f ms/frame (%.2fx inline)", DRAW_COUNT, t, ms, inlineMs / ms);
+  }
+
+exit_error:
+  bench_destroy_info(&bench, &appd);
+  appd.uvr_vk_graphics_pipeline_cnt = 1;
+  appd.uvr_vk_graphics_pipeline = &gpipeline;
+  uvr_vk_destory(&appd);
+  return 0;
+}
+
+
+/*
+ * Renders FRAME_COUNT frames. @recordNs receives the total time spent recording draws,
+ * from struct uvr_vk_command_recorder { member: recordNs } or around the inline loop.
+ */
+int run_frames(struct bench *bench, struct draw_data *draws, struct uvr_vk_command_recorder *recorder, uint64_t *recordNs) {
+  struct uvr_vk_frame frame;
+  uint64_t f, start;
+  int ret = -1;
+
+  VkCommandBufferInheritanceRenderingInfo inheritanceRenderingInfo = {};
+  inheritanceRenderingInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_RENDERING_INFO;
+  inheritanceRenderingInfo.colorAttachmentCount = 1;
+  inheritanceRenderingInfo.pColorAttachmentFormats = &bench->colorFormat;
+  inheritanceRenderingInfo.depthAttachmentFormat = VK_FORMAT_UNDEFINED;
+  inheritanceRenderingInfo.stencilAttachmentFormat = VK_FORMAT_UNDEFINED;
+  inheritanceRenderingInfo.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+
+  *recordNs = 0;
+
+  for (f = 0; f < FRAME_COUNT; f++) {
+    if (uvr_vk_headless_target_acquire(&bench->target, &frame))
+      goto exit_run_frames;
+
+    struct uvr_vk_command_buffer_record_info commandBufferRecordInfo;
+    commandBufferRecordInfo.commandBufferCount = 1;
+    commandBufferRecordInfo.vkCommandbuffers = &bench->target.vkCommandbuffs.vkCommandbuffers[frame.frameIndex];
+    commandBufferRecordInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    commandBufferRecordInfo.pInheritanceInfo = NULL;
+    commandBufferRecordInfo.queryPool = NULL;
+    commandBufferRecordInfo.queryScopeName = NULL;
+
+    if (uvr_vk_command_buffer_record_begin(&commandBufferRecordInfo) == -1)
+      goto exit_run_frames;
+
+    if (recorder) {
+      bench_rendering_begin(bench, &frame, VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT);
+
+      struct uvr_vk_command_recorder_record_info recordInfo;
+      recordInfo.recorder = recorder;
+      recordInfo.bufferIndex = frame.frameIndex;
+      recordInfo.vkPrimaryCommandBuffer = frame.vkCommandBuffer;
+      recordInfo.renderPass = VK_NULL_HANDLE;
+      recordInfo.subpass = 0;
+      recordInfo.framebuffer = VK_NULL_HANDLE;
+      recordInfo.pInheritanceRenderingInfo = &inheritanceRenderingInfo;
+      recordInfo.itemCount = DRAW_COUNT;
+      recordInfo.recordFunc = record_draws;
+      recordInfo.data = draws;
+
+      if (uvr_vk_command_recorder_record(&recordInfo) == -1)
+        goto exit_run_frames;
+
+      *recordNs += recorder->recordNs;
+    } else {
+      bench_rendering_begin(bench, &frame, 0);
+
+      start = bench_time_ns();
+      record_draws(frame.vkCommandBuffer, 0, 0, DRAW_COUNT, draws);
+      *recordNs += bench_time_ns() - start;
+    }
+
+    bench_rendering_end(bench, &frame);
+
+    if (uvr_vk_command_buffer_record_end(&commandBufferRecordInfo) == -1)
+      goto exit_run_frames;
+
+    if (uvr_vk_headless_target_submit(&bench->target) == -1)
+      goto exit_run_frames;
+
+    if (uvr_vk_headless_target_present(&bench->target))
+      goto exit_run_frames;
+  }
+
+  ret = 0;
+
+exit_run_frames:
+  uvr_vk_headless_target_drain(&bench->target);
+  return ret;
+}
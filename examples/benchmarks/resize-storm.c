@@ -0,0 +1,297 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+
+#define FRAMES_IN_FLIGHT 2
+#define RESIZE_COUNT 200
+#define FRAMES_PER_RESIZE 3
+
+struct resize_path {
+  const char *name;
+  struct uvr_vk_render_pass rpass;
+  struct uvr_vk_graphics_pipeline gpipeline;
+  struct uvr_vk_framebuffer framebuffers;
+  uint64_t resizeNs;
+  uint64_t framebufferNs;
+  uint64_t frameNs;
+};
+
+
+/* Same color attachment as the dynamic rendering path, left in COLOR_ATTACHMENT_OPTIMAL like bench_rendering_end(3) */
+int create_render_pass_path(struct bench *bench, struct resize_path *path) {
+  VkAttachmentDescription colorAttachment = {};
+  colorAttachment.format = bench->colorFormat;
+  colorAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
+  colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+  colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+  colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+  colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+  colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+  colorAttachment.finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+  VkAttachmentReference colorAttachmentRef = {};
+  colorAttachmentRef.attachment = 0;
+  colorAttachmentRef.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+  VkSubpassDescription subpass = {};
+  subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+  subpass.colorAttachmentCount = 1;
+  subpass.pColorAttachments = &colorAttachmentRef;
+
+  VkSubpassDependency subPassDependency;
+  subPassDependency.srcSubpass = VK_SUBPASS_EXTERNAL;
+  subPassDependency.dstSubpass = 0;
+  subPassDependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+  subPassDependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+  subPassDependency.srcAccessMask = 0;
+  subPassDependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+  subPassDependency.dependencyFlags = 0;
+
+  struct uvr_vk_render_pass_create_info renderpass_info;
+  renderpass_info.vkDevice = bench->lgdev.vkDevice;
+  renderpass_info.attachmentCount = 1;
+  renderpass_info.pAttachments = &colorAttachment;
+  renderpass_info.subpassCount = 1;
+  renderpass_info.pSubpasses = &subpass;
+  renderpass_info.dependencyCount = 1;
+  renderpass_info.pDependencies = &subPassDependency;
+
+  path->rpass = uvr_vk_render_pass_create(&renderpass_info);
+  if (!path->rpass.renderPass)
+    return -1;
+
+  struct uvr_vk_graphics_pipeline_create_info gpipelineInfo = bench->gpipelineInfo;
+  gpipelineInfo.renderPass = path->rpass.renderPass;
+  gpipelineInfo.subpass = 0;
+  gpipelineInfo.pRenderingInfo = NULL;
+
+  path->gpipeline = uvr_vk_graphics_pipeline_create(&gpipelineInfo);
+  if (!path->gpipeline.graphicsPipeline)
+    return -1;
+
+  return 0;
+}
+
+
+/* Width and height change on every resize, like dragging a window corner */
+VkExtent2D resize_extent(uint32_t r) {
+  return (VkExtent2D) { 640 + ((r * 97) % 1280), 360 + ((r * 61) % 720) };
+}
+
+
+int resize_target(struct bench *bench, struct resize_path *path, VkExtent2D extent2D);
+int run_frames(struct bench *bench, struct resize_path *path);
+
+
+/*
+ * Benchmark a resize storm: RESIZE_COUNT headless target recreations at changing sizes with
+ * FRAMES_PER_RESIZE frames rendered after each one. The render pass path rebuilds a VkFramebuffer
+ * per target image on every resize, the dynamic rendering path passes the new image views directly.
+ *
+ * usage: underview-renderer-benchmark-resize-storm
+ */
+int main(void) {
+  struct bench bench;
+  struct uvr_vk_destroy appd;
+  memset(&bench, 0, sizeof(bench));
+  memset(&appd, 0, sizeof(appd));
+
+  struct resize_path paths[2];
+  memset(paths, 0, sizeof(paths));
+  paths[0].name = "render pass";
+  paths[1].name = "dynamic rendering";
+
+  uint32_t p, r;
+
+  struct bench_create_info benchCreateInfo;
+  benchCreateInfo.appName = "Resize Storm Benchmark";
+  benchCreateInfo.extent2D = (VkExtent2D) { 0, 0 };
+  benchCreateInfo.frameCount = FRAMES_IN_FLIGHT;
+
+  if (bench_create(&bench, &benchCreateInfo) == -1)
+    goto exit_error;
+
+  if (create_render_pass_path(&bench, &paths[0]) == -1)
+    goto exit_error;
+
+  paths[1].gpipeline = uvr_vk_graphics_pipeline_create(&bench.gpipelineInfo);
+  if (!paths[1].gpipeline.graphicsPipeline)
+    goto exit_error;
+
+  for (p = 0; p < ARRAY_LEN(paths); p++) {
+    for (r = 0; r < RESIZE_COUNT; r++) {
+      if (resize_target(&bench, &paths[p], resize_extent(r)) == -1)
+        goto exit_error;
+
+      if (run_frames(&bench, &paths[p]) == -1)
+        goto exit_error;
+    }
+
+    uvr_utils_log(UVR_INFO, "%-17s: %u resizes, %.3f ms/resize (%.3f ms framebuffers), %.3f ms/frame",
+                            paths[p].name, RESIZE_COUNT, (double) paths[p].resizeNs / 1e6 / RESIZE_COUNT,
+                            (double) paths[p].framebufferNs / 1e6 / RESIZE_COUNT,
+                            (double) paths[p].frameNs / 1e6 / (RESIZE_COUNT * FRAMES_PER_RESIZE));
+  }
+
+  uvr_utils_log(UVR_INFO, "dynamic rendering resizes %.2fx faster",
+                          (double) paths[0].resizeNs / (double) paths[1].resizeNs);
+
+exit_error:
+  /* Frames were drained after every resize, nothing destroyed here is still pending */
+  bench_destroy_info(&bench, &appd);
+  appd.uvr_vk_graphics_pipeline_cnt = 1;
+  appd.uvr_vk_graphics_pipeline = &paths[0].gpipeline;
+  appd.uvr_vk_framebuffer_cnt = 1;
+  appd.uvr_vk_framebuffer = &paths[0].framebuffers;
+  appd.uvr_vk_render_pass_cnt = 1;
+  appd.uvr_vk_render_pass = &paths[0].rpass;
+  uvr_vk_destory(&appd);
+
+  memset(&appd, 0, sizeof(appd));
+  appd.uvr_vk_graphics_pipeline_cnt = 1;
+  appd.uvr_vk_graphics_pipeline = &paths[1].gpipeline;
+  uvr_vk_destory(&appd);
+  return 0;
+}
+
+
+/*
+ * Replaces the headless target of @bench with one of @extent2D. Everything that depends on the
+ * target images (the framebuffers of the render pass path) is rebuilt, timed into @path.
+ */
+int resize_target(struct bench *bench, struct resize_path *path, VkExtent2D extent2D) {
+  uint64_t start, fbStart;
+
+  start = bench_time_ns();
+
+  struct uvr_vk_destroy targetd;
+  memset(&targetd, 0, sizeof(targetd));
+  targetd.uvr_vk_framebuffer_cnt = 1;
+  targetd.uvr_vk_framebuffer = &path->framebuffers;
+  targetd.uvr_vk_headless_target_cnt = 1;
+  targetd.uvr_vk_headless_target = &bench->target;
+  uvr_vk_destory(&targetd);
+
+  memset(&path->framebuffers, 0, sizeof(path->framebuffers));
+  memset(&bench->target, 0, sizeof(bench->target));
+
+  struct uvr_vk_headless_target_create_info targetCreateInfo;
+  targetCreateInfo.allocator = &bench->allocator;
+  targetCreateInfo.vkQueue = bench->graphics_queue.vkQueue;
+  targetCreateInfo.queueFamilyIndex = bench->graphics_queue.familyIndex;
+  targetCreateInfo.format = bench->colorFormat;
+  targetCreateInfo.extent2D = extent2D;
+  targetCreateInfo.frameCount = FRAMES_IN_FLIGHT;
+  targetCreateInfo.imageUsage = 0;
+  targetCreateInfo.readbackInterval = 0;
+  targetCreateInfo.readbackLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+  targetCreateInfo.readback = NULL;
+  targetCreateInfo.readbackUserData = NULL;
+
+  bench->target = uvr_vk_headless_target_create(&targetCreateInfo);
+  if (!bench->target.vkSyncs.vkFences)
+    return -1;
+
+  if (path->rpass.renderPass) {
+    fbStart = bench_time_ns();
+
+    struct uvr_vk_framebuffer_create_info framebufferCreateInfo;
+    framebufferCreateInfo.vkDevice = bench->lgdev.vkDevice;
+    framebufferCreateInfo.frameBufferCount = bench->target.images.imageCount;
+    framebufferCreateInfo.vkImageViews = bench->target.images.vkImageViews;
+    framebufferCreateInfo.renderPass = path->rpass.renderPass;
+    framebufferCreateInfo.width = extent2D.width;
+    framebufferCreateInfo.height = extent2D.height;
+    framebufferCreateInfo.layers = 1;
+
+    path->framebuffers = uvr_vk_framebuffer_create(&framebufferCreateInfo);
+    if (!path->framebuffers.vkFrameBuffers)
+      return -1;
+
+    path->framebufferNs += bench_time_ns() - fbStart;
+  }
+
+  path->resizeNs += bench_time_ns() - start;
+  return 0;
+}
+
+
+/* Renders FRAMES_PER_RESIZE frames at the current target size, @path's frameNs receives the CPU time per frame */
+int run_frames(struct bench *bench, struct resize_path *path) {
+  const struct uvr_vk_device_dispatch *dispatch = bench->lgdev.dispatch;
+  struct uvr_vk_frame frame;
+  uint64_t f, start;
+  int ret = -1;
+
+  VkRect2D renderArea = {};
+  renderArea.extent = bench->target.extent2D;
+
+  VkViewport viewport = { 0.0f, 0.0f, (float) renderArea.extent.width, (float) renderArea.extent.height, 0.0f, 1.0f };
+
+  /* Black with 100% opacity */
+  VkClearValue clearColor[1];
+  memset(clearColor, 0, sizeof(clearColor));
+  clearColor[0].color.float32[3] = 1.0f;
+
+  for (f = 0; f < FRAMES_PER_RESIZE; f++) {
+    start = bench_time_ns();
+
+    if (uvr_vk_headless_target_acquire(&bench->target, &frame))
+      goto exit_run_frames;
+
+    struct uvr_vk_command_buffer_record_info commandBufferRecordInfo;
+    commandBufferRecordInfo.commandBufferCount = 1;
+    commandBufferRecordInfo.vkCommandbuffers = &bench->target.vkCommandbuffs.vkCommandbuffers[frame.frameIndex];
+    commandBufferRecordInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    commandBufferRecordInfo.pInheritanceInfo = NULL;
+    commandBufferRecordInfo.queryPool = NULL;
+    commandBufferRecordInfo.queryScopeName = NULL;
+
+    if (uvr_vk_command_buffer_record_begin(&commandBufferRecordInfo) == -1)
+      goto exit_run_frames;
+
+    if (path->rpass.renderPass) {
+      VkRenderPassBeginInfo renderPassInfo;
+      renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+      renderPassInfo.pNext = NULL;
+      renderPassInfo.renderPass = path->rpass.renderPass;
+      renderPassInfo.framebuffer = path->framebuffers.vkFrameBuffers[frame.imageIndex].fb;
+      renderPassInfo.renderArea = renderArea;
+      renderPassInfo.clearValueCount = 1;
+      renderPassInfo.pClearValues = clearColor;
+
+      dispatch->CmdBeginRenderPass(frame.vkCommandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+    } else {
+      bench_rendering_begin(bench, &frame, 0);
+    }
+
+    dispatch->CmdBindPipeline(frame.vkCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, path->gpipeline.graphicsPipeline);
+    dispatch->CmdSetViewport(frame.vkCommandBuffer, 0, 1, &viewport);
+    dispatch->CmdSetScissor(frame.vkCommandBuffer, 0, 1, &renderArea);
+    dispatch->CmdDraw(frame.vkCommandBuffer, 3, 1, 0, 0);
+
+    if (path->rpass.renderPass)
+      dispatch->CmdEndRenderPass(frame.vkCommandBuffer);
+    else
+      bench_rendering_end(bench, &frame);
+
+    if (uvr_vk_command_buffer_record_end(&commandBufferRecordInfo) == -1)
+      goto exit_run_frames;
+
+    if (uvr_vk_headless_target_submit(&bench->target) == -1)
+      goto exit_run_frames;
+
+    if (uvr_vk_headless_target_present(&bench->target))
+      goto exit_run_frames;
+
+    path->frameNs += bench_time_ns() - start;
+  }
+
+  ret = 0;
+
+exit_run_frames:
+  /* Next resize destroys the target and framebuffers, nothing may still reference them */
+  uvr_vk_headless_target_drain(&bench->target);
+  return ret;
+}
@@ -0,0 +1,425 @@
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "vulkan.h"
+#include "shader.h"
+
+#define ITERATIONS 8
+#define UPLOAD_RING_SIZE (64 * 1024 * 1024)
+#define HOST_COMMAND_ARENA_SIZE (64 * 1024)
+
+/* Level 0 sizes uploaded every iteration, one texture each */
+static const uint32_t texture_sizes[] = { 256, 512, 1024, 2048 };
+
+struct uvr_vk {
+  struct uvr_vk_host_allocator host_allocator;
+  VkInstance instance;
+  VkPhysicalDevice phdev;
+  struct uvr_vk_lgdev lgdev;
+  struct uvr_vk_queue upload_queue;
+
+#ifdef INCLUDE_SHADERC
+  struct uvr_shader_spirv downsample_shader;
+#else
+  struct uvr_shader_file downsample_shader;
+#endif
+  struct uvr_vk_shader_module shader_module;
+
+  struct uvr_vk_allocator allocator;
+  struct uvr_vk_format_cache format_cache;
+  struct uvr_vk_upload_ring upload;
+  struct uvr_vk_texture_downsampler downsampler;
+  struct uvr_vk_query_pool qpool;
+  uint32_t texture_count;
+  struct uvr_vk_texture *textures;
+};
+
+
+int create_vk_instance(struct uvr_vk *uvrvk);
+int create_vk_device(struct uvr_vk *app, uvr_vk_texture_mipmap_mode mode);
+int create_vk_upload_resources(struct uvr_vk *app, uvr_vk_texture_mipmap_mode mode, uint32_t iterations);
+int create_vk_downsampler(struct uvr_vk *app);
+int upload_vk_textures(struct uvr_vk *app, uvr_vk_texture_mipmap_mode mode, uint8_t *pixels, double *wallMs);
+
+
+static double elapsed_ms(struct timespec *start) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (double) (now.tv_sec - start->tv_sec) * 1e3 + (double) (now.tv_nsec - start->tv_nsec) / 1e6;
+}
+
+
+/*
+ * Benchmark reporting texture upload throughput and mip generation time.
+ *
+ * usage: underview-renderer-benchmark-texture-upload [blit|compute|host] [iterations]
+ *
+ * blit uploads on a graphics queue, compute on a dedicated compute queue with
+ * the downsample shader and host on that same queue without it. Devices with no
+ * dedicated compute queue fall back to blits, the mode actually used is reported.
+ */
+int main(int argc, char *argv[]) {
+  struct uvr_vk app;
+  struct uvr_vk_destroy appd;
+  memset(&app, 0, sizeof(app));
+  memset(&appd, 0, sizeof(appd));
+
+  struct uvr_shader_destroy shadercd;
+  memset(&shadercd, 0, sizeof(shadercd));
+
+  uint8_t *pixels = NULL;
+  uint32_t i, iterations, largest = texture_sizes[ARRAY_LEN(texture_sizes)-1];
+  double wallMs = 0.0, stageMs = 0.0, hostMipmapMs = 0.0;
+  uint64_t uploadBytes = 0;
+
+  uvr_vk_texture_mipmap_mode mode = UVR_VK_TEXTURE_MIPMAP_BLIT;
+  if (argc > 1 && !strcmp(argv[1], "compute"))
+    mode = UVR_VK_TEXTURE_MIPMAP_COMPUTE;
+  else if (argc > 1 && !strcmp(argv[1], "host"))
+    mode = UVR_VK_TEXTURE_MIPMAP_HOST;
+
+  iterations = (argc > 2) ? (uint32_t) strtoul(argv[2], NULL, 10) : ITERATIONS;
+  if (!iterations)
+    iterations = ITERATIONS;
+
+  /* Gradient so downsampled levels differ from level 0, every size reads a prefix of it */
+  pixels = calloc((size_t) largest * largest, 4);
+  if (!pixels)
+    goto exit_error;
+
+  for (i = 0; i < largest * largest; i++) {
+    pixels[i * 4 + 0] = (uint8_t) (i % largest);
+    pixels[i * 4 + 1] = (uint8_t) (i / largest);
+    pixels[i * 4 + 2] = (uint8_t) (i * 7);
+    pixels[i * 4 + 3] = 255;
+  }
+
+  struct uvr_vk_host_allocator_create_info hostAllocatorCreateInfo;
+  hostAllocatorCreateInfo.commandArenaSize = HOST_COMMAND_ARENA_SIZE;
+
+  if (uvr_vk_host_allocator_create(&app.host_allocator, &hostAllocatorCreateInfo) == -1)
+    goto exit_error;
+
+  uvr_vk_host_allocator_set(&app.host_allocator);
+
+  if (create_vk_instance(&app) == -1)
+    goto exit_error;
+
+  if (create_vk_device(&app, mode) == -1)
+    goto exit_error;
+
+  if (create_vk_upload_resources(&app, mode, iterations) == -1)
+    goto exit_error;
+
+  for (i = 0; i < iterations; i++) {
+    /* Previous iteration's batch completed, read back its mip generation timings */
+    if (app.qpool.vkTimestampPool)
+      uvr_vk_query_pool_next_frame(&app.qpool);
+
+    if (upload_vk_textures(&app, mode, pixels, &wallMs) == -1)
+      goto exit_error;
+  }
+
+  if (app.qpool.vkTimestampPool)
+    uvr_vk_query_pool_next_frame(&app.qpool);
+
+  for (i = 0; i < app.texture_count; i++) {
+    struct uvr_vk_texture_stats textureStats = uvr_vk_texture_get_stats(&app.textures[i]);
+    uploadBytes += textureStats.uploadBytes;
+    stageMs += textureStats.stageMs;
+    hostMipmapMs += textureStats.mipmapMs;
+  }
+
+  struct uvr_vk_texture_stats lastStats = uvr_vk_texture_get_stats(&app.textures[app.texture_count-1]);
+  struct uvr_vk_upload_ring_stats ringStats = uvr_vk_upload_ring_get_stats(&app.upload);
+
+  uvr_utils_log(UVR_INFO, "%u textures, %u mip levels each at %ux%u, mip generation: %s",
+                          app.texture_count, lastStats.mipLevels, largest, largest,
+                          (lastStats.mipmapMode == UVR_VK_TEXTURE_MIPMAP_BLIT) ? "blit" :
+                          (lastStats.mipmapMode == UVR_VK_TEXTURE_MIPMAP_COMPUTE) ? "compute" : "host");
+  uvr_utils_log(UVR_INFO, "upload: %.1f MB in %.3f ms (%.1f MB/s end to end, ring reports %.1f MB/s), staging %.3f ms",
+                          (double) uploadBytes / (1024.0 * 1024.0), wallMs,
+                          (double) uploadBytes / (1024.0 * 1024.0) / (wallMs / 1e3),
+                          ringStats.bytesPerSecond / (1024.0 * 1024.0), stageMs);
+  uvr_utils_log(UVR_INFO, "ring: %" PRIu64 " copies, %" PRIu64 " submits, %" PRIu64 " stalls (%.3f ms), peak %" PRIu64 " bytes",
+                          ringStats.copyCount, ringStats.submitCount, ringStats.stallCount,
+                          ringStats.stallMs, (uint64_t) ringStats.peakUsedBytes);
+
+  if (lastStats.mipmapMode == UVR_VK_TEXTURE_MIPMAP_HOST) {
+    uvr_utils_log(UVR_INFO, "mip generation (host): %.3f ms total, %.3f ms per texture",
+                            hostMipmapMs, hostMipmapMs / app.texture_count);
+  } else if (app.qpool.vkTimestampPool) {
+    struct uvr_vk_query_percentiles percentiles = uvr_vk_query_pool_get_percentiles(&app.qpool, "uvr_vk_texture_mipmaps");
+    uvr_utils_log(UVR_INFO, "mip generation (gpu): %u samples, min %.3f ms, p50 %.3f ms, p90 %.3f ms, max %.3f ms",
+                            percentiles.sampleCount, (double) percentiles.minNs / 1e6, (double) percentiles.p50Ns / 1e6,
+                            (double) percentiles.p90Ns / 1e6, (double) percentiles.maxNs / 1e6);
+  }
+
+exit_error:
+#ifdef INCLUDE_SHADERC
+  shadercd.uvr_shader_spirv = app.downsample_shader;
+#else
+  shadercd.uvr_shader_file = app.downsample_shader;
+#endif
+  uvr_shader_destroy(&shadercd);
+
+  /*
+   * Let the api know of what addresses to free and fd's to close
+   */
+  appd.vkinst = app.instance;
+  appd.uvr_vk_lgdev_cnt = 1;
+  appd.uvr_vk_lgdev = &app.lgdev;
+  appd.uvr_vk_shader_module_cnt = 1;
+  appd.uvr_vk_shader_module = &app.shader_module;
+  appd.uvr_vk_upload_ring_cnt = 1;
+  appd.uvr_vk_upload_ring = &app.upload;
+  appd.uvr_vk_texture_downsampler_cnt = 1;
+  appd.uvr_vk_texture_downsampler = &app.downsampler;
+  appd.uvr_vk_texture_cnt = app.texture_count;
+  appd.uvr_vk_texture = app.textures;
+  appd.uvr_vk_format_cache_cnt = 1;
+  appd.uvr_vk_format_cache = &app.format_cache;
+  appd.uvr_vk_query_pool_cnt = 1;
+  appd.uvr_vk_query_pool = &app.qpool;
+  appd.uvr_vk_allocator_cnt = 1;
+  appd.uvr_vk_allocator = &app.allocator;
+  uvr_vk_destory(&appd);
+
+  if (app.host_allocator.callbacks.pUserData) {
+    uvr_vk_host_allocator_set(NULL);
+    uvr_vk_host_allocator_destroy(&app.host_allocator);
+  }
+
+  free(app.textures);
+  free(pixels);
+  return 0;
+}
+
+
+int create_vk_instance(struct uvr_vk *app) {
+
+  struct uvr_vk_instance_create_info vkinst;
+  vkinst.appName = "Texture Upload Benchmark";
+  vkinst.engineName = "No Engine";
+  vkinst.enabledLayerCount = 0;
+  vkinst.ppEnabledLayerNames = NULL;
+  vkinst.enabledExtensionCount = 0;
+  vkinst.ppEnabledExtensionNames = NULL;
+
+  app->instance = uvr_vk_instance_create(&vkinst);
+  if (!app->instance) return -1;
+
+  return 0;
+}
+
+
+int create_vk_device(struct uvr_vk *app, uvr_vk_texture_mipmap_mode mode) {
+
+  struct uvr_vk_phdev_create_info vkphdev;
+  vkphdev.vkInst = app->instance;
+  vkphdev.vkPhdevType = VK_PHYSICAL_DEVICE_TYPE;
+  vkphdev.enabledExtensionCount = 0;
+  vkphdev.ppEnabledExtensionNames = NULL;
+  vkphdev.pRequiredFeatures = NULL;
+#ifdef INCLUDE_KMS
+  vkphdev.kmsFd = -1;
+#endif
+
+  app->phdev = uvr_vk_phdev_create(&vkphdev);
+  if (!app->phdev)
+    return -1;
+
+  /* Blits need a graphics queue, anything else runs where a dedicated compute queue would */
+  struct uvr_vk_queue_create_info vk_queue_info;
+  vk_queue_info.vkPhdev = app->phdev;
+  vk_queue_info.queueFlag = (mode == UVR_VK_TEXTURE_MIPMAP_BLIT) ? VK_QUEUE_GRAPHICS_BIT : VK_QUEUE_COMPUTE_BIT;
+  vk_queue_info.preferDedicated = (mode == UVR_VK_TEXTURE_MIPMAP_BLIT) ? VK_FALSE : VK_TRUE;
+
+  app->upload_queue = uvr_vk_queue_create(&vk_queue_info);
+  if (app->upload_queue.familyIndex == -1)
+    return -1;
+
+  VkPhysicalDeviceFeatures phdevfeats = uvr_vk_get_phdev_features(app->phdev);
+
+  struct uvr_vk_lgdev_create_info vk_lgdev_info;
+  vk_lgdev_info.vkInst = app->instance;
+  vk_lgdev_info.vkPhdev = app->phdev;
+  vk_lgdev_info.pNext = NULL;
+  vk_lgdev_info.pEnabledFeatures = &phdevfeats;
+  vk_lgdev_info.enableDescriptorIndexing = VK_FALSE;
+  vk_lgdev_info.enabledExtensionCount = 0;
+  vk_lgdev_info.ppEnabledExtensionNames = NULL;
+  vk_lgdev_info.queueCount = 1;
+  vk_lgdev_info.queues = &app->upload_queue;
+
+  app->lgdev = uvr_vk_lgdev_create(&vk_lgdev_info);
+  if (!app->lgdev.vkDevice)
+    return -1;
+
+  return 0;
+}
+
+
+int create_vk_upload_resources(struct uvr_vk *app, uvr_vk_texture_mipmap_mode mode, uint32_t iterations) {
+  struct uvr_vk_allocator_create_info allocatorCreateInfo;
+  allocatorCreateInfo.vkPhdev = app->phdev;
+  allocatorCreateInfo.vkDevice = app->lgdev.vkDevice;
+  allocatorCreateInfo.blockSize = 0;
+
+  app->allocator = uvr_vk_allocator_create(&allocatorCreateInfo);
+  if (!app->allocator.vkDevice)
+    return -1;
+
+  struct uvr_vk_format_cache_create_info formatCacheCreateInfo;
+  formatCacheCreateInfo.vkPhdev = app->phdev;
+
+  app->format_cache = uvr_vk_format_cache_create(&formatCacheCreateInfo);
+  if (!app->format_cache.entries)
+    return -1;
+
+  /* Textures are only uploaded here, never sampled, so no ownership transfer is needed */
+  struct uvr_vk_upload_ring_create_info uploadRingCreateInfo;
+  uploadRingCreateInfo.allocator = &app->allocator;
+  uploadRingCreateInfo.vkQueue = app->upload_queue.vkQueue;
+  uploadRingCreateInfo.srcQueueFamilyIndex = app->upload_queue.familyIndex;
+  uploadRingCreateInfo.dstQueueFamilyIndex = app->upload_queue.familyIndex;
+  uploadRingCreateInfo.size = UPLOAD_RING_SIZE;
+  uploadRingCreateInfo.alignment = 0;
+  uploadRingCreateInfo.batchCount = 0;
+  uploadRingCreateInfo.timeline = VK_FALSE;
+
+  app->upload = uvr_vk_upload_ring_create(&uploadRingCreateInfo);
+  if (!app->upload.pMapped)
+    return -1;
+
+  /* Each iteration's batch completes before the next begins, a single frame slot suffices */
+  struct uvr_vk_query_pool_create_info queryPoolCreateInfo;
+  queryPoolCreateInfo.vkPhdev = app->phdev;
+  queryPoolCreateInfo.vkDevice = app->lgdev.vkDevice;
+  queryPoolCreateInfo.queueFamilyIndex = app->upload_queue.familyIndex;
+  queryPoolCreateInfo.frameCount = 1;
+  queryPoolCreateInfo.maxScopes = ARRAY_LEN(texture_sizes);
+  queryPoolCreateInfo.pipelineStatistics = 0;
+  queryPoolCreateInfo.historyLength = iterations * ARRAY_LEN(texture_sizes);
+
+  app->qpool = uvr_vk_query_pool_create(&queryPoolCreateInfo);
+  if (!app->qpool.vkTimestampPool)
+    uvr_utils_log(UVR_WARNING, "queue family has no timestamps, GPU mip generation time isn't reported");
+
+  if (mode == UVR_VK_TEXTURE_MIPMAP_COMPUTE && create_vk_downsampler(app) == -1)
+    return -1;
+
+  /* Kept until exit, destroying a texture before its downsample resources are collected isn't allowed */
+  app->textures = calloc((size_t) iterations * ARRAY_LEN(texture_sizes), sizeof(struct uvr_vk_texture));
+  if (!app->textures)
+    return -1;
+
+  return 0;
+}
+
+
+int create_vk_downsampler(struct uvr_vk *app) {
+
+#ifdef INCLUDE_SHADERC
+  const char downsample_shader[] =
+    "#version 450\n"
+    "layout(local_size_x = 8, local_size_y = 8, local_size_z = 1) in;\n"
+    "layout(set = 0, binding = 0, rgba8) uniform readonly image2D srcLevel;\n"
+    "layout(set = 0, binding = 1, rgba8) uniform writeonly image2D dstLevel;\n"
+    "void main() {\n"
+    "  ivec2 dst = ivec2(gl_GlobalInvocationID.xy);\n"
+    "  ivec2 dstSize = imageSize(dstLevel);\n"
+    "  if (dst.x >= dstSize.x || dst.y >= dstSize.y) return;\n"
+    "  ivec2 srcMax = imageSize(srcLevel) - 1;\n"
+    "  ivec2 src = dst * 2;\n"
+    "  vec4 sum = imageLoad(srcLevel, min(src, srcMax)) + imageLoad(srcLevel, min(src + ivec2(1, 0), srcMax)) +\n"
+    "             imageLoad(srcLevel, min(src + ivec2(0, 1), srcMax)) + imageLoad(srcLevel, min(src + ivec2(1, 1), srcMax));\n"
+    "  imageStore(dstLevel, dst, sum * 0.25);\n"
+    "}";
+
+  struct uvr_shader_spirv_create_info comp_shader_create_info;
+  comp_shader_create_info.kind = VK_SHADER_STAGE_COMPUTE_BIT;
+  comp_shader_create_info.source = downsample_shader;
+  comp_shader_create_info.filename = "comp.spv";
+  comp_shader_create_info.entryPoint = "main";
+
+  app->downsample_shader = uvr_shader_compile_buffer_to_spirv(&comp_shader_create_info);
+  if (!app->downsample_shader.bytes)
+    return -1;
+#else
+  app->downsample_shader = uvr_shader_file_load(TEXTURE_DOWNSAMPLE_COMPUTE_SHADER_SPIRV);
+  if (!app->downsample_shader.bytes)
+    return -1;
+#endif
+
+  struct uvr_vk_shader_module_create_info comp_shader_module_create_info;
+  comp_shader_module_create_info.vkDevice = app->lgdev.vkDevice;
+  comp_shader_module_create_info.codeSize = app->downsample_shader.byteSize;
+  comp_shader_module_create_info.pCode = app->downsample_shader.bytes;
+  comp_shader_module_create_info.name = "downsample";
+
+  app->shader_module = uvr_vk_shader_module_create(&comp_shader_module_create_info);
+  if (!app->shader_module.shader)
+    return -1;
+
+  struct uvr_vk_texture_downsampler_create_info downsamplerCreateInfo;
+  downsamplerCreateInfo.vkPhdev = app->phdev;
+  downsamplerCreateInfo.vkDevice = app->lgdev.vkDevice;
+  downsamplerCreateInfo.shader = app->shader_module.shader;
+  downsamplerCreateInfo.localSize[0] = 8;
+  downsamplerCreateInfo.localSize[1] = 8;
+  downsamplerCreateInfo.localSize[2] = 1;
+  downsamplerCreateInfo.format = VK_FORMAT_R8G8B8A8_UNORM;
+  downsamplerCreateInfo.vkPipelineCache = VK_NULL_HANDLE;
+
+  app->downsampler = uvr_vk_texture_downsampler_create(&downsamplerCreateInfo);
+  if (!app->downsampler.pipeline.computePipeline)
+    return -1;
+
+  return 0;
+}
+
+
+int upload_vk_textures(struct uvr_vk *app, uvr_vk_texture_mipmap_mode mode, uint8_t *pixels, double *wallMs) {
+  uint64_t uploadId = 0;
+  struct timespec start;
+  uint32_t s;
+
+  const VkFormat formats[] = { VK_FORMAT_R8G8B8A8_UNORM };
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+
+  for (s = 0; s < ARRAY_LEN(texture_sizes); s++) {
+    struct uvr_vk_texture_create_info textureCreateInfo;
+    textureCreateInfo.allocator = &app->allocator;
+    textureCreateInfo.formatCache = &app->format_cache;
+    textureCreateInfo.uploadRing = &app->upload;
+    textureCreateInfo.pFormats = formats;
+    textureCreateInfo.formatCount = ARRAY_LEN(formats);
+    textureCreateInfo.extent2D = (VkExtent2D) { texture_sizes[s], texture_sizes[s] };
+    textureCreateInfo.mipLevels = 0;
+    textureCreateInfo.imageUsage = 0;
+    textureCreateInfo.pData = pixels;
+    textureCreateInfo.size = (VkDeviceSize) texture_sizes[s] * texture_sizes[s] * 4;
+    textureCreateInfo.downsampler = (mode == UVR_VK_TEXTURE_MIPMAP_COMPUTE) ? &app->downsampler : NULL;
+    textureCreateInfo.queryPool = (app->qpool.vkTimestampPool) ? &app->qpool : NULL;
+
+    app->textures[app->texture_count] = uvr_vk_texture_create(&textureCreateInfo);
+    if (!app->textures[app->texture_count].image.vkImages)
+      return -1;
+
+    uploadId = app->textures[app->texture_count++].uploadId;
+  }
+
+  if (uvr_vk_upload_ring_flush(&app->upload, NULL) == -1)
+    return -1;
+
+  while (!uvr_vk_upload_ring_poll(&app->upload, uploadId))
+    usleep(100);
+
+  *wallMs += elapsed_ms(&start);
+
+  return 0;
+}
@@ -0,0 +1,605 @@
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "vulkan.h"
+#include "shader.h"
+
+#define WIDTH 1920
+#define HEIGHT 1080
+#define FRAMES_IN_FLIGHT 2
+#define FRAME_COUNT 600
+#define READBACK_INTERVAL 1
+#define OUTPUT_PATH "headless-triangle.ppm"
+#define HOST_COMMAND_ARENA_SIZE (64 * 1024)
+
+struct uvr_vk {
+  struct uvr_vk_host_allocator host_allocator;
+  VkInstance instance;
+  VkPhysicalDevice phdev;
+  struct uvr_vk_lgdev lgdev;
+  struct uvr_vk_queue graphics_queue;
+
+#ifdef INCLUDE_SHADERC
+  struct uvr_shader_spirv vertex_shader;
+  struct uvr_shader_spirv fragment_shader;
+#else
+  struct uvr_shader_file vertex_shader;
+  struct uvr_shader_file fragment_shader;
+#endif
+  struct uvr_vk_shader_module shader_modules[2];
+
+  struct uvr_vk_pipeline_layout gplayout;
+  struct uvr_vk_graphics_pipeline gpipeline;
+  struct uvr_vk_dynamic_state dynstate;
+  struct uvr_vk_dynamic_state_tracker dyntracker;
+  struct uvr_vk_allocator allocator;
+  struct uvr_vk_memory_budget memory_budget;
+  struct uvr_vk_headless_target target;
+};
+
+
+/* Last frame read back, written out as a PPM once the loop exits */
+struct readback_frame {
+  uint64_t frameNumber;
+  uint8_t *pixels;
+  VkExtent2D extent2D;
+  uint32_t rowPitch;
+};
+
+
+int create_vk_instance(struct uvr_vk *uvrvk);
+int create_vk_device(struct uvr_vk *app);
+int create_vk_headless_target(struct uvr_vk *app, struct readback_frame *lastFrame);
+int create_vk_shader_modules(struct uvr_vk *app);
+int create_vk_graphics_pipeline(struct uvr_vk *app);
+int record_vk_draw_commands(struct uvr_vk *app, struct uvr_vk_frame *frame);
+int write_ppm(struct readback_frame *frame);
+
+
+/* Nothing here can be evicted, a long-running client would drop caches or lower resolution */
+void memory_pressure(void UNUSED *userData, uint32_t heapIndex, const struct uvr_vk_memory_budget_heap *heap) {
+  uvr_utils_log((heap->pressure) ? UVR_WARNING : UVR_INFO, "heap %u %s memory pressure",
+                heapIndex, (heap->pressure) ? "under" : "no longer under");
+}
+
+
+void readback(void *userData, uint64_t frameNumber, const void *pixels, VkExtent2D extent2D, uint32_t rowPitch) {
+  struct readback_frame *lastFrame = (struct readback_frame *) userData;
+
+  if (!lastFrame->pixels)
+    return;
+
+  lastFrame->frameNumber = frameNumber;
+  lastFrame->extent2D = extent2D;
+  lastFrame->rowPitch = rowPitch;
+  memcpy(lastFrame->pixels, pixels, (size_t) rowPitch * extent2D.height);
+}
+
+
+/*
+ * Example code demonstrating how to run the render loop without
+ * a display server and read rendered frames back to host memory
+ */
+int main(int argc, char *argv[]) {
+  struct uvr_vk app;
+  struct uvr_vk_destroy appd;
+  memset(&app, 0, sizeof(app));
+  memset(&appd, 0, sizeof(appd));
+
+  struct uvr_shader_destroy shadercd;
+  memset(&shadercd, 0, sizeof(shadercd));
+
+  struct readback_frame lastFrame;
+  memset(&lastFrame, 0, sizeof(lastFrame));
+
+  uint64_t frameCount = (argc > 1) ? strtoull(argv[1], NULL, 10) : FRAME_COUNT;
+
+  lastFrame.pixels = calloc((size_t) WIDTH * HEIGHT, 4);
+  if (!lastFrame.pixels)
+    goto exit_error;
+
+  /* Account the implementation's host allocations, must be set before the instance exists */
+  struct uvr_vk_host_allocator_create_info hostAllocatorCreateInfo;
+  hostAllocatorCreateInfo.commandArenaSize = HOST_COMMAND_ARENA_SIZE;
+
+  if (uvr_vk_host_allocator_create(&app.host_allocator, &hostAllocatorCreateInfo) == -1)
+    goto exit_error;
+
+  uvr_vk_host_allocator_set(&app.host_allocator);
+
+  if (create_vk_instance(&app) == -1)
+    goto exit_error;
+
+  if (create_vk_device(&app) == -1)
+    goto exit_error;
+
+  if (create_vk_headless_target(&app, &lastFrame) == -1)
+    goto exit_error;
+
+  if (create_vk_shader_modules(&app) == -1)
+    goto exit_error;
+
+  if (create_vk_graphics_pipeline(&app) == -1)
+    goto exit_error;
+
+  struct uvr_vk_frame frame;
+  while (app.target.frameNumber < frameCount) {
+    if (uvr_vk_headless_target_acquire(&app.target, &frame))
+      break;
+
+    uvr_vk_memory_budget_sample(&app.memory_budget);
+
+    if (record_vk_draw_commands(&app, &frame) == -1)
+      break;
+
+    if (uvr_vk_headless_target_submit(&app.target) == -1)
+      break;
+
+    if (uvr_vk_headless_target_present(&app.target))
+      break;
+  }
+
+  /* Frames still in flight haven't reached the readback callback yet */
+  uvr_vk_headless_target_drain(&app.target);
+
+  struct uvr_vk_headless_target_stats stats = uvr_vk_headless_target_get_stats(&app.target);
+  uvr_utils_log(UVR_INFO, "%" PRIu64 " frames at %.1f fps, %" PRIu64 " readbacks at %.1f MB/s, cpu wait %.3f ms",
+                          stats.frameCount, stats.framesPerSecond, stats.readbackCount,
+                          stats.readbackMBPerSecond, stats.cpuWaitMs);
+
+  if (stats.readbackCount)
+    write_ppm(&lastFrame);
+
+exit_error:
+#ifdef INCLUDE_SHADERC
+  shadercd.uvr_shader_spirv = app.vertex_shader;
+  shadercd.uvr_shader_spirv = app.fragment_shader;
+#else
+  shadercd.uvr_shader_file = app.vertex_shader;
+  shadercd.uvr_shader_file = app.fragment_shader;
+#endif
+  uvr_shader_destroy(&shadercd);
+
+  /*
+   * Let the api know of what addresses to free and fd's to close
+   */
+  appd.vkinst = app.instance;
+  appd.uvr_vk_lgdev_cnt = 1;
+  appd.uvr_vk_lgdev = &app.lgdev;
+  appd.uvr_vk_shader_module_cnt = ARRAY_LEN(app.shader_modules);
+  appd.uvr_vk_shader_module = app.shader_modules;
+  appd.uvr_vk_pipeline_layout_cnt = 1;
+  appd.uvr_vk_pipeline_layout = &app.gplayout;
+  appd.uvr_vk_graphics_pipeline_cnt = 1;
+  appd.uvr_vk_graphics_pipeline = &app.gpipeline;
+  appd.uvr_vk_headless_target_cnt = 1;
+  appd.uvr_vk_headless_target = &app.target;
+  appd.uvr_vk_allocator_cnt = 1;
+  appd.uvr_vk_allocator = &app.allocator;
+  uvr_vk_destory(&appd);
+
+  if (app.host_allocator.callbacks.pUserData) {
+    struct uvr_vk_host_allocator_stats hostStats = uvr_vk_host_allocator_get_stats(&app.host_allocator);
+    uvr_utils_log(UVR_INFO, "host allocations: %" PRIu64 " (%.1f/s), peak %zu bytes, command scope %" PRIu64 " (%" PRIu64 " arena, %" PRIu64 " fallback)",
+                            hostStats.allocationCount, hostStats.allocationsPerSecond, hostStats.peakBytes,
+                            hostStats.scopeAllocations[VK_SYSTEM_ALLOCATION_SCOPE_COMMAND],
+                            hostStats.arenaAllocations, hostStats.arenaFallbacks);
+    uvr_vk_host_allocator_set(NULL);
+    uvr_vk_host_allocator_destroy(&app.host_allocator);
+  }
+
+  free(lastFrame.pixels);
+  return 0;
+}
+
+
+int create_vk_instance(struct uvr_vk *app) {
+
+  /* No surface extensions, nothing here requires a display server */
+  struct uvr_vk_instance_create_info vkinst;
+  vkinst.appName = "Example App";
+  vkinst.engineName = "No Engine";
+  vkinst.enabledLayerCount = 0;
+  vkinst.ppEnabledLayerNames = NULL;
+  vkinst.enabledExtensionCount = 0;
+  vkinst.ppEnabledExtensionNames = NULL;
+
+  app->instance = uvr_vk_instance_create(&vkinst);
+  if (!app->instance) return -1;
+
+  return 0;
+}
+
+
+int create_vk_device(struct uvr_vk *app) {
+
+  /* Pass -Dgpu=cpu or set UVR_VK_PHDEV_TYPE=cpu at runtime to select lavapipe */
+  struct uvr_vk_phdev_create_info vkphdev;
+  vkphdev.vkInst = app->instance;
+  vkphdev.vkPhdevType = VK_PHYSICAL_DEVICE_TYPE;
+  vkphdev.enabledExtensionCount = 0;
+  vkphdev.ppEnabledExtensionNames = NULL;
+  vkphdev.pRequiredFeatures = NULL;
+#ifdef INCLUDE_KMS
+  vkphdev.kmsFd = -1;
+#endif
+
+  app->phdev = uvr_vk_phdev_create(&vkphdev);
+  if (!app->phdev)
+    return -1;
+
+  struct uvr_vk_queue_create_info vk_queue_info;
+  vk_queue_info.vkPhdev = app->phdev;
+  vk_queue_info.queueFlag = VK_QUEUE_GRAPHICS_BIT;
+  vk_queue_info.preferDedicated = VK_FALSE;
+
+  app->graphics_queue = uvr_vk_queue_create(&vk_queue_info);
+  if (app->graphics_queue.familyIndex == -1)
+    return -1;
+
+  VkPhysicalDeviceFeatures phdevfeats = uvr_vk_get_phdev_features(app->phdev);
+
+  /* Render targets are plain images, attachments are passed while recording */
+  VkPhysicalDeviceVulkan13Features vk13features = {};
+  vk13features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES;
+  vk13features.pNext = NULL;
+  vk13features.dynamicRendering = VK_TRUE;
+
+  struct uvr_vk_lgdev_create_info vk_lgdev_info;
+  vk_lgdev_info.vkInst = app->instance;
+  vk_lgdev_info.vkPhdev = app->phdev;
+  vk_lgdev_info.pNext = &vk13features;
+  vk_lgdev_info.pEnabledFeatures = &phdevfeats;
+  vk_lgdev_info.enableDescriptorIndexing = VK_FALSE;
+  vk_lgdev_info.enabledExtensionCount = 0;
+  vk_lgdev_info.ppEnabledExtensionNames = NULL;
+  vk_lgdev_info.queueCount = 1;
+  vk_lgdev_info.queues = &app->graphics_queue;
+
+  app->lgdev = uvr_vk_lgdev_create(&vk_lgdev_info);
+  if (!app->lgdev.vkDevice)
+    return -1;
+
+  return 0;
+}
+
+
+int create_vk_headless_target(struct uvr_vk *app, struct readback_frame *lastFrame) {
+  struct uvr_vk_allocator_create_info allocatorCreateInfo;
+  allocatorCreateInfo.vkPhdev = app->phdev;
+  allocatorCreateInfo.vkDevice = app->lgdev.vkDevice;
+  allocatorCreateInfo.blockSize = 0;
+
+  app->allocator = uvr_vk_allocator_create(&allocatorCreateInfo);
+  if (!app->allocator.vkDevice)
+    return -1;
+
+  /* VK_EXT_memory_budget isn't enabled, usage is what the allocator reserved */
+  struct uvr_vk_memory_budget_create_info memoryBudgetCreateInfo;
+  memoryBudgetCreateInfo.vkPhdev = app->phdev;
+  memoryBudgetCreateInfo.allocator = &app->allocator;
+  memoryBudgetCreateInfo.budgetExtensionEnabled = VK_FALSE;
+  memoryBudgetCreateInfo.highWaterMark = 0.9f;
+  memoryBudgetCreateInfo.lowWaterMark = 0.8f;
+  memoryBudgetCreateInfo.callback = memory_pressure;
+  memoryBudgetCreateInfo.userData = app;
+
+  app->memory_budget = uvr_vk_memory_budget_create(&memoryBudgetCreateInfo);
+  if (!app->memory_budget.vkPhdev)
+    return -1;
+
+  struct uvr_vk_headless_target_create_info targetCreateInfo;
+  targetCreateInfo.allocator = &app->allocator;
+  targetCreateInfo.vkQueue = app->graphics_queue.vkQueue;
+  targetCreateInfo.queueFamilyIndex = app->graphics_queue.familyIndex;
+  targetCreateInfo.format = VK_FORMAT_R8G8B8A8_UNORM;
+  targetCreateInfo.extent2D = (VkExtent2D) { WIDTH, HEIGHT };
+  targetCreateInfo.frameCount = FRAMES_IN_FLIGHT;
+  targetCreateInfo.imageUsage = 0;
+  targetCreateInfo.readbackInterval = READBACK_INTERVAL;
+  targetCreateInfo.readbackLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+  targetCreateInfo.readback = readback;
+  targetCreateInfo.readbackUserData = lastFrame;
+
+  app->target = uvr_vk_headless_target_create(&targetCreateInfo);
+  if (!app->target.vkSyncs.vkFences)
+    return -1;
+
+  return 0;
+}
+
+
+int create_vk_shader_modules(struct uvr_vk *app) {
+
+#ifdef INCLUDE_SHADERC
+  const char vertex_shader[] =
+    "#version 450\n"
+    "layout(location = 0) out vec3 v_Color;\n"
+    "vec2 positions[3] = vec2[](vec2(0.0, -0.5), vec2(0.5, 0.5), vec2(-0.5, 0.5));\n"
+    "vec3 colors[3] = vec3[](vec3(1.0, 0.0, 0.0), vec3(0.0, 1.0, 0.0), vec3(0.0, 0.0, 1.0));\n"
+    "void main() {\n"
+    "  gl_Position = vec4(positions[gl_VertexIndex], 0.0, 1.0);\n"
+    "  v_Color = colors[gl_VertexIndex];\n"
+    "}";
+
+  const char fragment_shader[] =
+    "#version 450\n"
+    "layout(location = 0) in vec3 v_Color;\n"
+    "layout(location = 0) out vec4 o_Color;\n"
+    "void main() { o_Color = vec4(v_Color, 1.0); }";
+
+  struct uvr_shader_spirv_create_info vert_shader_create_info;
+  vert_shader_create_info.kind = VK_SHADER_STAGE_VERTEX_BIT;
+  vert_shader_create_info.source = vertex_shader;
+  vert_shader_create_info.filename = "vert.spv";
+  vert_shader_create_info.entryPoint = "main";
+
+  struct uvr_shader_spirv_create_info frag_shader_create_info;
+  frag_shader_create_info.kind = VK_SHADER_STAGE_FRAGMENT_BIT;
+  frag_shader_create_info.source = fragment_shader;
+  frag_shader_create_info.filename = "frag.spv";
+  frag_shader_create_info.entryPoint = "main";
+
+  app->vertex_shader = uvr_shader_compile_buffer_to_spirv(&vert_shader_create_info);
+  if (!app->vertex_shader.bytes)
+    return -1;
+
+  app->fragment_shader = uvr_shader_compile_buffer_to_spirv(&frag_shader_create_info);
+  if (!app->fragment_shader.bytes)
+    return -1;
+
+#else
+  app->vertex_shader = uvr_shader_file_load(HEADLESS_TRIANGLE_VERTEX_SHADER_SPIRV);
+  if (!app->vertex_shader.bytes)
+    return -1;
+
+  app->fragment_shader = uvr_shader_file_load(TRIANGLE_FRAGMENT_SHADER_SPIRV);
+  if (!app->fragment_shader.bytes)
+    return -1;
+#endif
+
+  struct uvr_vk_shader_module_create_info vertex_shader_module_create_info;
+  vertex_shader_module_create_info.vkDevice = app->lgdev.vkDevice;
+  vertex_shader_module_create_info.codeSize = app->vertex_shader.byteSize;
+  vertex_shader_module_create_info.pCode = app->vertex_shader.bytes;
+  vertex_shader_module_create_info.name = "vertex";
+
+  app->shader_modules[0] = uvr_vk_shader_module_create(&vertex_shader_module_create_info);
+  if (!app->shader_modules[0].shader)
+    return -1;
+
+  struct uvr_vk_shader_module_create_info frag_shader_module_create_info;
+  frag_shader_module_create_info.vkDevice = app->lgdev.vkDevice;
+  frag_shader_module_create_info.codeSize = app->fragment_shader.byteSize;
+  frag_shader_module_create_info.pCode = app->fragment_shader.bytes;
+  frag_shader_module_create_info.name = "fragment";
+
+  app->shader_modules[1] = uvr_vk_shader_module_create(&frag_shader_module_create_info);
+  if (!app->shader_modules[1].shader)
+    return -1;
+
+  return 0;
+}
+
+
+int create_vk_graphics_pipeline(struct uvr_vk *app) {
+
+  VkPipelineShaderStageCreateInfo vertShaderStageInfo = {};
+  vertShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+  vertShaderStageInfo.stage = VK_SHADER_STAGE_VERTEX_BIT;
+  vertShaderStageInfo.module = app->shader_modules[0].shader;
+  vertShaderStageInfo.pName = "main";
+
+  VkPipelineShaderStageCreateInfo fragShaderStageInfo = {};
+  fragShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+  fragShaderStageInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+  fragShaderStageInfo.module = app->shader_modules[1].shader;
+  fragShaderStageInfo.pName = "main";
+
+  VkPipelineShaderStageCreateInfo shaderStages[2] = {vertShaderStageInfo, fragShaderStageInfo};
+
+  VkPipelineVertexInputStateCreateInfo vertexInputInfo = {};
+  vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+  vertexInputInfo.vertexBindingDescriptionCount = 0;
+  vertexInputInfo.pVertexBindingDescriptions = NULL;
+  vertexInputInfo.vertexAttributeDescriptionCount = 0;
+  vertexInputInfo.pVertexAttributeDescriptions = NULL;
+
+  VkPipelineInputAssemblyStateCreateInfo inputAssembly = {};
+  inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+  inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+  inputAssembly.primitiveRestartEnable = VK_FALSE;
+
+  VkPipelineViewportStateCreateInfo viewportState = {};
+  viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+  viewportState.viewportCount = 1;
+  viewportState.pViewports = NULL;
+  viewportState.scissorCount = 1;
+  viewportState.pScissors = NULL;
+
+  VkPipelineRasterizationStateCreateInfo rasterizer = {};
+  rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+  rasterizer.depthClampEnable = VK_FALSE;
+  rasterizer.rasterizerDiscardEnable = VK_FALSE;
+  rasterizer.polygonMode = VK_POLYGON_MODE_FILL;
+  rasterizer.lineWidth = 1.0f;
+  rasterizer.cullMode = VK_CULL_MODE_NONE;
+  rasterizer.frontFace = VK_FRONT_FACE_CLOCKWISE;
+  rasterizer.depthBiasEnable = VK_FALSE;
+
+  VkPipelineMultisampleStateCreateInfo multisampling = {};
+  multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+  multisampling.sampleShadingEnable = VK_FALSE;
+  multisampling.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+  multisampling.minSampleShading = 1.0f;
+
+  VkPipelineColorBlendAttachmentState colorBlendAttachment = {};
+  colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+  colorBlendAttachment.blendEnable = VK_FALSE;
+
+  VkPipelineColorBlendStateCreateInfo colorBlending = {};
+  colorBlending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+  colorBlending.logicOpEnable = VK_FALSE;
+  colorBlending.attachmentCount = 1;
+  colorBlending.pAttachments = &colorBlendAttachment;
+
+  struct uvr_vk_dynamic_state_create_info dynamicStateInfo;
+  dynamicStateInfo.vkPhdev = app->phdev;
+  dynamicStateInfo.vkDevice = app->lgdev.vkDevice;
+  dynamicStateInfo.flags = UVR_VK_DYNAMIC_STATE_VIEWPORT_SCISSOR;
+  dynamicStateInfo.extendedDynamicState3Enabled = VK_FALSE;
+
+  if (uvr_vk_dynamic_state_init(&app->dynstate, &dynamicStateInfo) == -1)
+    return -1;
+
+  struct uvr_vk_pipeline_layout_create_info gplayout_info;
+  gplayout_info.vkDevice = app->lgdev.vkDevice;
+  gplayout_info.setLayoutCount = 0;
+  gplayout_info.pSetLayouts = NULL;
+  gplayout_info.pushConstantRangeCount = 0;
+  gplayout_info.pPushConstantRanges = NULL;
+
+  app->gplayout = uvr_vk_pipeline_layout_create(&gplayout_info);
+  if (!app->gplayout.vkPipelineLayout)
+    return -1;
+
+  VkPipelineRenderingCreateInfo renderingInfo = {};
+  renderingInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO;
+  renderingInfo.pNext = NULL;
+  renderingInfo.viewMask = 0;
+  renderingInfo.colorAttachmentCount = 1;
+  renderingInfo.pColorAttachmentFormats = &app->target.format;
+  renderingInfo.depthAttachmentFormat = VK_FORMAT_UNDEFINED;
+  renderingInfo.stencilAttachmentFormat = VK_FORMAT_UNDEFINED;
+
+  struct uvr_vk_graphics_pipeline_create_info gpipeline_info;
+  gpipeline_info.vkDevice = app->lgdev.vkDevice;
+  gpipeline_info.stageCount = ARRAY_LEN(shaderStages);
+  gpipeline_info.pStages = shaderStages;
+  gpipeline_info.pVertexInputState = &vertexInputInfo;
+  gpipeline_info.pInputAssemblyState = &inputAssembly;
+  gpipeline_info.pTessellationState = NULL;
+  gpipeline_info.pViewportState = &viewportState;
+  gpipeline_info.pRasterizationState = &rasterizer;
+  gpipeline_info.pMultisampleState = &multisampling;
+  gpipeline_info.pDepthStencilState = NULL;
+  gpipeline_info.pColorBlendState = &colorBlending;
+  gpipeline_info.pDynamicState = &app->dynstate.createInfo;
+  gpipeline_info.vkPipelineLayout = app->gplayout.vkPipelineLayout;
+  gpipeline_info.renderPass = VK_NULL_HANDLE;
+  gpipeline_info.subpass = 0;
+  gpipeline_info.vkPipelineCache = VK_NULL_HANDLE;
+  gpipeline_info.pRenderingInfo = &renderingInfo;
+
+  app->gpipeline = uvr_vk_graphics_pipeline_create(&gpipeline_info);
+  if (!app->gpipeline.graphicsPipeline)
+    return -1;
+
+  return 0;
+}
+
+
+int record_vk_draw_commands(struct uvr_vk *app, struct uvr_vk_frame *frame) {
+  struct uvr_vk_command_buffer_record_info commandBufferRecordInfo;
+  commandBufferRecordInfo.commandBufferCount = 1;
+  commandBufferRecordInfo.vkCommandbuffers = &app->target.vkCommandbuffs.vkCommandbuffers[frame->frameIndex];
+  commandBufferRecordInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+  commandBufferRecordInfo.pInheritanceInfo = NULL;
+  commandBufferRecordInfo.queryPool = NULL;
+  commandBufferRecordInfo.queryScopeName = NULL;
+
+  if (uvr_vk_command_buffer_record_begin(&commandBufferRecordInfo) == -1)
+    return -1;
+
+  VkCommandBuffer cmdBuffer = frame->vkCommandBuffer;
+  VkExtent2D extent2D = app->target.extent2D;
+
+  VkRect2D renderArea = {};
+  renderArea.offset.x = 0;
+  renderArea.offset.y = 0;
+  renderArea.extent = extent2D;
+
+  VkViewport viewport = {};
+  viewport.x = 0.0f;
+  viewport.y = 0.0f;
+  viewport.width = (float) extent2D.width;
+  viewport.height = (float) extent2D.height;
+  viewport.minDepth = 0.0f;
+  viewport.maxDepth = 1.0f;
+
+  /* Black with 100% opacity */
+  VkClearValue clearColor[1];
+  memset(clearColor, 0, sizeof(clearColor));
+  clearColor[0].color.float32[3] = 1.0f;
+
+  VkImage image = app->target.images.vkImages[frame->imageIndex].image;
+  VkImageView imageView = app->target.images.vkImageViews[frame->imageIndex].view;
+
+  struct uvr_vk_rendering_begin_info renderingBeginInfo;
+  renderingBeginInfo.vkCommandBuffer = cmdBuffer;
+  renderingBeginInfo.renderArea = renderArea;
+  renderingBeginInfo.colorAttachmentCount = 1;
+  renderingBeginInfo.pColorImages = &image;
+  renderingBeginInfo.pColorImageViews = &imageView;
+  renderingBeginInfo.colorOldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+  renderingBeginInfo.colorLoadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+  renderingBeginInfo.colorStoreOp = VK_ATTACHMENT_STORE_OP_STORE;
+  renderingBeginInfo.pColorClearValues = clearColor;
+  renderingBeginInfo.depthImage = VK_NULL_HANDLE;
+  renderingBeginInfo.depthImageView = VK_NULL_HANDLE;
+  renderingBeginInfo.depthOldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+  renderingBeginInfo.depthLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+  renderingBeginInfo.depthStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+  renderingBeginInfo.depthClearValue = clearColor[0];
+  renderingBeginInfo.renderingFlags = 0;
+
+  /* Left as is, the target's readback copy transitions it from here */
+  struct uvr_vk_rendering_end_info renderingEndInfo;
+  renderingEndInfo.vkCommandBuffer = cmdBuffer;
+  renderingEndInfo.colorAttachmentCount = 1;
+  renderingEndInfo.pColorImages = &image;
+  renderingEndInfo.colorFinalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+  uvr_vk_rendering_begin(&renderingBeginInfo);
+  uvr_vk_dynamic_state_tracker_begin(&app->dyntracker, app->lgdev.dispatch, &app->dynstate, cmdBuffer);
+  uvr_vk_dynamic_state_tracker_bind_pipeline(&app->dyntracker, app->gpipeline.graphicsPipeline, app->dynstate.enabledFlags);
+  uvr_vk_dynamic_state_tracker_set_viewport(&app->dyntracker, &viewport);
+  uvr_vk_dynamic_state_tracker_set_scissor(&app->dyntracker, &renderArea);
+  app->lgdev.dispatch->CmdDraw(cmdBuffer, 3, 1, 0, 0);
+  uvr_vk_rendering_end(&renderingEndInfo);
+
+  if (uvr_vk_command_buffer_record_end(&commandBufferRecordInfo) == -1)
+    return -1;
+
+  return 0;
+}
+
+
+int write_ppm(struct readback_frame *frame) {
+  uint32_t x, y;
+  uint8_t *row = NULL;
+
+  FILE *file = fopen(OUTPUT_PATH, "wb");
+  if (!file) {
+    uvr_utils_log(UVR_DANGER, "[x] fopen: %s", strerror(errno));
+    return -1;
+  }
+
+  fprintf(file, "P6\n%u %u\n255\n", frame->extent2D.width, frame->extent2D.height);
+
+  /* RGBA -> RGB */
+  for (y = 0; y < frame->extent2D.height; y++) {
+    row = frame->pixels + ((size_t) y * frame->rowPitch);
+    for (x = 0; x < frame->extent2D.width; x++)
+      fwrite(&row[x * 4], 1, 3, file);
+  }
+
+  fclose(file);
+
+  uvr_utils_log(UVR_SUCCESS, "frame %" PRIu64 " written to %s", frame->frameNumber, OUTPUT_PATH);
+
+  return 0;
+}
@@ -184,6 +184,9 @@ int create_vk_device(struct uvr_vk *app, struct uvr_kms *kms) {
   struct uvr_vk_phdev_create_info vk_phdev_info;
   vk_phdev_info.vkInst = app->instance;
   vk_phdev_info.vkPhdevType = VK_PHYSICAL_DEVICE_TYPE;
+  vk_phdev_info.enabledExtensionCount = ARRAY_LEN(device_extensions);
+  vk_phdev_info.ppEnabledExtensionNames = device_extensions;
+  vk_phdev_info.pRequiredFeatures = NULL;
   vk_phdev_info.kmsFd = kms->kmsdev.kmsFd;
 
   app->phdev = uvr_vk_phdev_create(&vk_phdev_info);
@@ -193,6 +196,7 @@ int create_vk_device(struct uvr_vk *app, struct uvr_kms *kms) {
   struct uvr_vk_queue_create_info vk_queue_info;
   vk_queue_info.vkPhdev = app->phdev;
   vk_queue_info.queueFlag = VK_QUEUE_GRAPHICS_BIT;
+  vk_queue_info.preferDedicated = VK_FALSE;
 
   app->graphics_queue = uvr_vk_queue_create(&vk_queue_info);
   if (app->graphics_queue.familyIndex == -1)
@@ -203,7 +207,9 @@ int create_vk_device(struct uvr_vk *app, struct uvr_kms *kms) {
   struct uvr_vk_lgdev_create_info vk_lgdev_info;
   vk_lgdev_info.vkInst = app->instance;
   vk_lgdev_info.vkPhdev = app->phdev;
+  vk_lgdev_info.pNext = NULL;
   vk_lgdev_info.pEnabledFeatures = &phdevfeats;
+  vk_lgdev_info.enableDescriptorIndexing = VK_FALSE;
   vk_lgdev_info.enabledExtensionCount = ARRAY_LEN(device_extensions);
   vk_lgdev_info.ppEnabledExtensionNames = device_extensions;
   vk_lgdev_info.queueCount = 1;
@@ -0,0 +1,17 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+#extension GL_EXT_nonuniform_qualifier : require
+
+layout(set = 0, binding = 0) uniform sampler2D textures[];
+
+layout(push_constant) uniform PushConstants {
+  uint baseSlot;
+} pc;
+
+layout(location = 0) in vec2 v_TexCoord;
+layout(location = 1) flat in uint v_TextureIndex;
+layout(location = 0) out vec4 o_Color;
+
+void main() {
+  o_Color = texture(textures[nonuniformEXT(pc.baseSlot + v_TextureIndex)], v_TexCoord);
+}
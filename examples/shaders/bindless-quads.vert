@@ -0,0 +1,27 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+#define QUADS_PER_ROW 8
+
+out gl_PerVertex {
+  vec4 gl_Position;
+};
+
+layout(location = 0) out vec2 v_TexCoord;
+layout(location = 1) flat out uint v_TextureIndex;
+
+vec2 corners[6] = vec2[](
+  vec2(0.0, 0.0), vec2(1.0, 0.0), vec2(1.0, 1.0),
+  vec2(1.0, 1.0), vec2(0.0, 1.0), vec2(0.0, 0.0)
+);
+
+void main() {
+  vec2 corner = corners[gl_VertexIndex];
+  vec2 cell = vec2(gl_InstanceIndex % QUADS_PER_ROW, gl_InstanceIndex / QUADS_PER_ROW);
+  vec2 size = vec2(2.0 / QUADS_PER_ROW);
+
+  /* Leave a small gap between quads */
+  gl_Position = vec4(-1.0 + (cell + 0.05 + corner * 0.9) * size, 0.0, 1.0);
+  v_TexCoord = corner;
+  v_TextureIndex = gl_InstanceIndex;
+}
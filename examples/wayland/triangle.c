@@ -8,6 +8,9 @@
 
 #define WIDTH 1920
 #define HEIGHT 1080
+#define PIPELINE_CACHE_PATH "triangle-pipeline-cache.bin"
+#define FRAMES_IN_FLIGHT 2
+#define BENCHMARK_FRAMES 2000
 
 struct uvr_vk {
   VkInstance instance;
@@ -30,10 +33,15 @@ struct uvr_vk {
 
   struct uvr_vk_pipeline_layout gplayout;
   struct uvr_vk_render_pass rpass;
+  struct uvr_vk_pipeline_cache pcache;
   struct uvr_vk_graphics_pipeline gpipeline;
+  struct uvr_vk_dynamic_state dynstate;
+  struct uvr_vk_dynamic_state_tracker dyntracker;
   struct uvr_vk_framebuffer vkframebuffs;
-  struct uvr_vk_command_buffer vkcbuffs;
-  struct uvr_vk_sync_obj vksyncs;
+  struct uvr_vk_frame_ring frames;
+  struct uvr_vk_query_pool qpool;
+  struct uvr_vk_command_replay replay;
+  bool benchmark;
 };
 
 
@@ -55,76 +63,82 @@ int create_vk_device(struct uvr_vk *app);
 int create_vk_swapchain(struct uvr_vk *app, VkSurfaceFormatKHR *sformat, VkExtent2D extent2D);
 int create_vk_images(struct uvr_vk *app, VkSurfaceFormatKHR *sformat);
 int create_vk_shader_modules(struct uvr_vk *app);
-int create_vk_graphics_pipeline(struct uvr_vk *app, VkSurfaceFormatKHR *sformat, VkExtent2D extent2D);
+int create_vk_graphics_pipeline(struct uvr_vk *app, VkSurfaceFormatKHR *sformat);
 int create_vk_framebuffers(struct uvr_vk *app, VkExtent2D extent2D);
-int create_vk_command_buffers(struct uvr_vk *app);
-int create_vk_sync_objs(struct uvr_vk *app);
-int record_vk_draw_commands(struct uvr_vk *app, uint32_t vkSwapchainImageIndex, VkExtent2D extent2D);
+int create_vk_frame_ring(struct uvr_vk *app);
+int create_vk_query_pool(struct uvr_vk *app);
+int create_vk_command_replay(struct uvr_vk *app);
+int record_vk_draw_commands(struct uvr_vk *app, struct uvr_vk_command_replay_frame *frame, VkExtent2D extent2D);
 int submit_vk_draw_commands();
 
 
-void render(bool UNUSED *running, uint32_t *imageIndex, void *data) {
+void render(bool *running, uint32_t *imageIndex, void *data) {
   VkExtent2D extent2D = {WIDTH, HEIGHT};
   struct uvr_vk_wc *vkwc = data;
   struct uvr_wc UNUSED *wc = vkwc->uvr_wc;
   struct uvr_vk *app = vkwc->uvr_vk;
 
-  if (!app->vksyncs.vkFences || !app->vksyncs.vkSemaphores)
+  if (!app->frames.vkSyncs.vkFences)
     return;
 
-  VkFence imageFence = app->vksyncs.vkFences[0].fence;
-  VkSemaphore imageSemaphore = app->vksyncs.vkSemaphores[0].semaphore;
-  VkSemaphore renderSemaphore = app->vksyncs.vkSemaphores[1].semaphore;
+  struct uvr_vk_frame frame;
+  if (uvr_vk_frame_ring_acquire(&app->frames, &frame) < 0)
+    return;
 
-  vkWaitForFences(app->lgdev.vkDevice, 1, &imageFence, VK_TRUE, UINT64_MAX);
+  *imageIndex = frame.imageIndex;
 
-  vkAcquireNextImageKHR(app->lgdev.vkDevice, app->schain.vkSwapchain, UINT64_MAX, imageSemaphore, VK_NULL_HANDLE, imageIndex);
+  /* Frame slot's previous submission is done, read back its GPU timings */
+  uvr_vk_query_pool_next_frame(&app->qpool);
 
-  record_vk_draw_commands(app, *imageIndex, extent2D);
+  /* Every other frame re-records so both paths are measured under the same conditions */
+  if (app->benchmark && (app->frames.frameNumber & 1))
+    uvr_vk_command_replay_invalidate(&app->replay, frame.imageIndex);
 
-  VkSemaphore waitSemaphores[1] = { imageSemaphore };
-  VkSemaphore signalSemaphores[1] = { renderSemaphore };
-  VkPipelineStageFlags waitStages[1] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
+  struct uvr_vk_command_replay_deps deps;
+  deps.framebuffer = app->vkframebuffs.vkFrameBuffers[frame.imageIndex].fb;
+  deps.imageView = VK_NULL_HANDLE;
+  deps.pipeline = app->gpipeline.graphicsPipeline;
+  deps.extent = extent2D;
+  deps.resourceKey = 0;
 
-  VkSubmitInfo submitInfo;
-  submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-  submitInfo.pNext = NULL;
-  submitInfo.waitSemaphoreCount = ARRAY_LEN(waitSemaphores);
-  submitInfo.pWaitSemaphores = waitSemaphores;
-  submitInfo.pWaitDstStageMask = waitStages;
-  submitInfo.commandBufferCount = 1;
-  submitInfo.pCommandBuffers = &app->vkcbuffs.vkCommandbuffers[0].buffer;
-  submitInfo.signalSemaphoreCount = ARRAY_LEN(signalSemaphores);
-  submitInfo.pSignalSemaphores = signalSemaphores;
+  /* Scene is static, the image's command buffer is only re-recorded when one of its dependencies changed */
+  struct uvr_vk_command_replay_frame replayFrame;
+  if (uvr_vk_command_replay_acquire(&app->replay, &app->frames, &deps, &replayFrame) == -1) {
+    uvr_vk_frame_ring_abandon(&app->frames);
+    return;
+  }
 
-  vkResetFences(app->lgdev.vkDevice, 1, &imageFence);
+  /* Acquire's semaphore must still be waited on, abandon the frame rather than leaving it signaled */
+  if (replayFrame.changed && record_vk_draw_commands(app, &replayFrame, extent2D) == -1) {
+    uvr_vk_frame_ring_abandon(&app->frames);
+    return;
+  }
 
-  /* Submit draw command */
-  vkQueueSubmit(app->graphics_queue.vkQueue, 1, &submitInfo, imageFence);
+  /* Submit draw command, a failed submit already abandoned the frame */
+  if (uvr_vk_command_replay_submit(&app->replay, &app->frames, &replayFrame) == -1)
+    return;
 
-  VkPresentInfoKHR presentInfo;
-  presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
-  presentInfo.pNext = NULL;
-  presentInfo.waitSemaphoreCount = ARRAY_LEN(signalSemaphores);
-  presentInfo.pWaitSemaphores = signalSemaphores;
-  presentInfo.swapchainCount = 1;
-  presentInfo.pSwapchains = &app->schain.vkSwapchain;
-  presentInfo.pImageIndices = imageIndex;
-  presentInfo.pResults = NULL;
+  if (app->benchmark && app->frames.frameNumber + 1 >= BENCHMARK_FRAMES)
+    *running = false;
 
-  vkQueuePresentKHR(app->graphics_queue.vkQueue, &presentInfo);
+  uvr_vk_frame_ring_present(&app->frames);
 }
 
 
 /*
  * Example code demonstrating how use Vulkan with Wayland
+ *
+ * Passing "benchmark" re-records every other frame and exits after BENCHMARK_FRAMES,
+ * comparing the CPU time of replayed and re-recorded frames.
  */
-int main(void) {
+int main(int argc, char *argv[]) {
   struct uvr_vk app;
   struct uvr_vk_destroy appd;
   memset(&app, 0, sizeof(app));
   memset(&appd, 0, sizeof(appd));
 
+  app.benchmark = (argc > 1 && !strcmp(argv[1], "benchmark"));
+
   struct uvr_wc wc;
   struct uvr_wc_destroy wcd;
   memset(&wcd, 0, sizeof(wcd));
@@ -159,22 +173,43 @@ int main(void) {
   if (create_vk_shader_modules(&app) == -1)
     goto exit_error;
 
-  if (create_vk_graphics_pipeline(&app, &sformat, extent2D) == -1)
+  if (create_vk_graphics_pipeline(&app, &sformat) == -1)
     goto exit_error;
 
   if (create_vk_framebuffers(&app, extent2D) == -1)
     goto exit_error;
 
-  if (create_vk_command_buffers(&app) == -1)
+  if (create_vk_frame_ring(&app) == -1)
+    goto exit_error;
+
+  if (create_vk_query_pool(&app) == -1)
     goto exit_error;
 
-  if (create_vk_sync_objs(&app) == -1)
+  if (create_vk_command_replay(&app) == -1)
     goto exit_error;
 
   while (wl_display_dispatch(wc.wcinterfaces.wlDisplay) != -1 && running) {
     // Leave blank
   }
 
+  if (app.frames.frameNumber) {
+    uvr_utils_log(UVR_INFO, "%" PRIu64 " frames, cpu wait avg %.3f ms, max %.3f ms", app.frames.frameNumber,
+                            (double) app.frames.cpuWaitTotalNs / app.frames.frameNumber / 1000000.0,
+                            (double) app.frames.cpuWaitMaxNs / 1000000.0);
+
+    struct uvr_vk_command_replay_stats replayStats = uvr_vk_command_replay_get_stats(&app.replay);
+    uvr_utils_log(UVR_INFO, "%" PRIu64 " frames re-recorded, cpu avg %.3f ms, %" PRIu64 " replayed, cpu avg %.3f ms",
+                            replayStats.recordCount, replayStats.recordCpuMs, replayStats.replayCount, replayStats.replayCpuMs);
+
+    if (app.benchmark && replayStats.replayCpuMs > 0.0)
+      uvr_utils_log(UVR_INFO, "replay saves %.3f ms cpu per frame (%.2fx)", replayStats.recordCpuMs - replayStats.replayCpuMs,
+                              replayStats.recordCpuMs / replayStats.replayCpuMs);
+
+    struct uvr_vk_query_percentiles gpuTime = uvr_vk_query_pool_get_percentiles(&app.qpool, "triangle");
+    uvr_utils_log(UVR_INFO, "gpu time p50 %.3f ms, p90 %.3f ms, p99 %.3f ms", gpuTime.p50Ns / 1000000.0,
+                            gpuTime.p90Ns / 1000000.0, gpuTime.p99Ns / 1000000.0);
+  }
+
 exit_error:
 #ifdef INCLUDE_SHADERC
   shadercd.uvr_shader_spirv = app.vertex_shader;
@@ -204,12 +239,16 @@ exit_error:
   appd.uvr_vk_render_pass = &app.rpass;
   appd.uvr_vk_graphics_pipeline_cnt = 1;
   appd.uvr_vk_graphics_pipeline = &app.gpipeline;
+  appd.uvr_vk_pipeline_cache_cnt = 1;
+  appd.uvr_vk_pipeline_cache = &app.pcache;
   appd.uvr_vk_framebuffer_cnt = 1;
   appd.uvr_vk_framebuffer = &app.vkframebuffs;
-  appd.uvr_vk_command_buffer_cnt = 1;
-  appd.uvr_vk_command_buffer = &app.vkcbuffs;
-  appd.uvr_vk_sync_obj_cnt = 1;
-  appd.uvr_vk_sync_obj = &app.vksyncs;
+  appd.uvr_vk_frame_ring_cnt = 1;
+  appd.uvr_vk_frame_ring = &app.frames;
+  appd.uvr_vk_command_replay_cnt = 1;
+  appd.uvr_vk_command_replay = &app.replay;
+  appd.uvr_vk_query_pool_cnt = 1;
+  appd.uvr_vk_query_pool = &app.qpool;
   uvr_vk_destory(&appd);
 
   wcd.uvr_wc_core_interface = wc.wcinterfaces;
@@ -307,6 +346,9 @@ int create_vk_device(struct uvr_vk *app) {
   struct uvr_vk_phdev_create_info vkphdev;
   vkphdev.vkInst = app->instance;
   vkphdev.vkPhdevType = VK_PHYSICAL_DEVICE_TYPE;
+  vkphdev.enabledExtensionCount = ARRAY_LEN(device_extensions);
+  vkphdev.ppEnabledExtensionNames = device_extensions;
+  vkphdev.pRequiredFeatures = NULL;
 #ifdef INCLUDE_KMS
   vkphdev.kmsFd = -1;
 #endif
@@ -318,6 +360,7 @@ int create_vk_device(struct uvr_vk *app) {
   struct uvr_vk_queue_create_info vkqueueinfo;
   vkqueueinfo.vkPhdev = app->phdev;
   vkqueueinfo.queueFlag = VK_QUEUE_GRAPHICS_BIT;
+  vkqueueinfo.preferDedicated = VK_FALSE;
 
   app->graphics_queue = uvr_vk_queue_create(&vkqueueinfo);
   if (app->graphics_queue.familyIndex == -1)
@@ -328,7 +371,9 @@ int create_vk_device(struct uvr_vk *app) {
   struct uvr_vk_lgdev_create_info vklgdevinfo;
   vklgdevinfo.vkInst = app->instance;
   vklgdevinfo.vkPhdev = app->phdev;
+  vklgdevinfo.pNext = NULL;
   vklgdevinfo.pEnabledFeatures = &phdevfeats;
+  vklgdevinfo.enableDescriptorIndexing = VK_FALSE;
   vklgdevinfo.enabledExtensionCount = ARRAY_LEN(device_extensions);
   vklgdevinfo.ppEnabledExtensionNames = device_extensions;
   vklgdevinfo.queueCount = 1;
@@ -512,7 +557,7 @@ int create_vk_shader_modules(struct uvr_vk *app) {
 }
 
 
-int create_vk_graphics_pipeline(struct uvr_vk *app, VkSurfaceFormatKHR *sformat, VkExtent2D extent2D) {
+int create_vk_graphics_pipeline(struct uvr_vk *app, VkSurfaceFormatKHR *sformat) {
 
   /* Taken directly from https://vulkan-tutorial.com */
   VkPipelineShaderStageCreateInfo vertShaderStageInfo = {};
@@ -544,25 +589,12 @@ int create_vk_graphics_pipeline(struct uvr_vk *app, VkSurfaceFormatKHR *sformat,
   inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
   inputAssembly.primitiveRestartEnable = VK_FALSE;
 
-  VkViewport viewport = {};
-  viewport.x = 0.0f;
-  viewport.y = 0.0f;
-  viewport.width = (float) extent2D.width;
-  viewport.height = (float) extent2D.height;
-  viewport.minDepth = 0.0f;
-  viewport.maxDepth = 1.0f;
-
-  VkRect2D scissor = {};
-  scissor.offset.x = 0;
-  scissor.offset.y = 0;
-  scissor.extent = extent2D;
-
   VkPipelineViewportStateCreateInfo viewportState = {};
   viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
   viewportState.viewportCount = 1;
-  viewportState.pViewports = &viewport;
+  viewportState.pViewports = NULL;
   viewportState.scissorCount = 1;
-  viewportState.pScissors = &scissor;
+  viewportState.pScissors = NULL;
 
   VkPipelineRasterizationStateCreateInfo rasterizer = {};
   rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
@@ -607,14 +639,14 @@ int create_vk_graphics_pipeline(struct uvr_vk *app, VkSurfaceFormatKHR *sformat,
   colorBlending.blendConstants[2] = 0.0f;
   colorBlending.blendConstants[3] = 0.0f;
 
-  VkDynamicState dynamicStates[2];
-  dynamicStates[0] = VK_DYNAMIC_STATE_VIEWPORT;
-  dynamicStates[1] = VK_DYNAMIC_STATE_SCISSOR;
+  struct uvr_vk_dynamic_state_create_info dynamicStateInfo;
+  dynamicStateInfo.vkPhdev = app->phdev;
+  dynamicStateInfo.vkDevice = app->lgdev.vkDevice;
+  dynamicStateInfo.flags = UVR_VK_DYNAMIC_STATE_VIEWPORT_SCISSOR | UVR_VK_DYNAMIC_STATE_CULL_MODE | UVR_VK_DYNAMIC_STATE_TOPOLOGY;
+  dynamicStateInfo.extendedDynamicState3Enabled = VK_FALSE;
 
-  VkPipelineDynamicStateCreateInfo dynamicState = {};
-  dynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
-  dynamicState.dynamicStateCount = ARRAY_LEN(dynamicStates);
-  dynamicState.pDynamicStates = dynamicStates;
+  if (uvr_vk_dynamic_state_init(&app->dynstate, &dynamicStateInfo) == -1)
+    return -1;
 
   VkAttachmentDescription colorAttachment = {};
   colorAttachment.format = sformat->format;
@@ -668,6 +700,16 @@ int create_vk_graphics_pipeline(struct uvr_vk *app, VkSurfaceFormatKHR *sformat,
   if (!app->rpass.renderPass)
     return -1;
 
+  /* Second run of the example should show a noticeably lower pipeline creation time */
+  struct uvr_vk_pipeline_cache_create_info pcache_info;
+  pcache_info.vkPhdev = app->phdev;
+  pcache_info.vkDevice = app->lgdev.vkDevice;
+  pcache_info.filePath = PIPELINE_CACHE_PATH;
+
+  app->pcache = uvr_vk_pipeline_cache_create(&pcache_info);
+  if (!app->pcache.vkPipelineCache)
+    return -1;
+
   struct uvr_vk_graphics_pipeline_create_info gpipeline_info;
   gpipeline_info.vkDevice = app->lgdev.vkDevice;
   gpipeline_info.stageCount = ARRAY_LEN(shaderStages);
@@ -680,10 +722,12 @@ int create_vk_graphics_pipeline(struct uvr_vk *app, VkSurfaceFormatKHR *sformat,
   gpipeline_info.pMultisampleState = &multisampling;
   gpipeline_info.pDepthStencilState = NULL;
   gpipeline_info.pColorBlendState = &colorBlending;
-  gpipeline_info.pDynamicState = &dynamicState;
+  gpipeline_info.pDynamicState = &app->dynstate.createInfo;
   gpipeline_info.vkPipelineLayout = app->gplayout.vkPipelineLayout;
   gpipeline_info.renderPass = app->rpass.renderPass;
   gpipeline_info.subpass = 0;
+  gpipeline_info.vkPipelineCache = app->pcache.vkPipelineCache;
+  gpipeline_info.pRenderingInfo = NULL;
 
   app->gpipeline = uvr_vk_graphics_pipeline_create(&gpipeline_info);
   if (!app->gpipeline.graphicsPipeline)
@@ -712,44 +756,60 @@ int create_vk_framebuffers(struct uvr_vk *app, VkExtent2D extent2D) {
 }
 
 
-int create_vk_command_buffers(struct uvr_vk *app) {
-  struct uvr_vk_command_buffer_create_info commandBufferCreateInfo;
-  commandBufferCreateInfo.vkDevice = app->lgdev.vkDevice;
-  commandBufferCreateInfo.queueFamilyIndex = app->graphics_queue.familyIndex;
-  commandBufferCreateInfo.commandBufferCount = 1;
+int create_vk_frame_ring(struct uvr_vk *app) {
+  struct uvr_vk_frame_ring_create_info frameRingCreateInfo;
+  frameRingCreateInfo.vkDevice = app->lgdev.vkDevice;
+  frameRingCreateInfo.vkQueue = app->graphics_queue.vkQueue;
+  frameRingCreateInfo.queueFamilyIndex = app->graphics_queue.familyIndex;
+  frameRingCreateInfo.vkSwapchain = app->schain.vkSwapchain;
+  frameRingCreateInfo.frameCount = FRAMES_IN_FLIGHT;
 
-  app->vkcbuffs = uvr_vk_command_buffer_create(&commandBufferCreateInfo);
-  if (!app->vkcbuffs.vkCommandPool)
+  app->frames = uvr_vk_frame_ring_create(&frameRingCreateInfo);
+  if (!app->frames.vkSyncs.vkFences)
     return -1;
 
   return 0;
 }
 
 
-int create_vk_sync_objs(struct uvr_vk *app) {
-  struct uvr_vk_sync_obj_create_info syncObjsCreateInfo;
-  syncObjsCreateInfo.vkDevice = app->lgdev.vkDevice;
-  syncObjsCreateInfo.fenceCount = 1;
-  syncObjsCreateInfo.semaphoreCount = 2;
+int create_vk_query_pool(struct uvr_vk *app) {
+  struct uvr_vk_query_pool_create_info queryPoolCreateInfo;
+  queryPoolCreateInfo.vkPhdev = app->phdev;
+  queryPoolCreateInfo.vkDevice = app->lgdev.vkDevice;
+  queryPoolCreateInfo.queueFamilyIndex = app->graphics_queue.familyIndex;
+  queryPoolCreateInfo.frameCount = FRAMES_IN_FLIGHT;
+  queryPoolCreateInfo.maxScopes = 4;
+  queryPoolCreateInfo.pipelineStatistics = 0;
+  queryPoolCreateInfo.historyLength = 256;
 
-  app->vksyncs = uvr_vk_sync_obj_create(&syncObjsCreateInfo);
-  if (!app->vksyncs.vkFences[0].fence && !app->vksyncs.vkSemaphores[0].semaphore)
+  app->qpool = uvr_vk_query_pool_create(&queryPoolCreateInfo);
+  if (!app->qpool.vkTimestampPool)
     return -1;
 
   return 0;
 }
 
 
-int record_vk_draw_commands(struct uvr_vk *app, uint32_t vkSwapchainImageIndex, VkExtent2D extent2D) {
-  struct uvr_vk_command_buffer_record_info commandBufferRecordInfo;
-  commandBufferRecordInfo.commandBufferCount = app->vkcbuffs.commandBufferCount;
-  commandBufferRecordInfo.vkCommandbuffers = app->vkcbuffs.vkCommandbuffers;
-  commandBufferRecordInfo.flags = 0;
+/* Replayed buffers are per image, the replay times each frame with the query pool outside of them */
+int create_vk_command_replay(struct uvr_vk *app) {
+  struct uvr_vk_command_replay_create_info commandReplayCreateInfo;
+  commandReplayCreateInfo.vkDevice = app->lgdev.vkDevice;
+  commandReplayCreateInfo.queueFamilyIndex = app->graphics_queue.familyIndex;
+  commandReplayCreateInfo.imageCount = app->frames.imageCount;
+  commandReplayCreateInfo.queryPool = &app->qpool;
+  commandReplayCreateInfo.queryScopeName = "triangle";
 
-  if (uvr_vk_command_buffer_record_begin(&commandBufferRecordInfo) == -1)
+  app->replay = uvr_vk_command_replay_create(&commandReplayCreateInfo);
+  if (!app->replay.vkCommandPool)
     return -1;
 
-  VkCommandBuffer cmdBuffer = app->vkcbuffs.vkCommandbuffers[0].buffer;
+  return 0;
+}
+
+
+/* Command buffer was begun by uvr_vk_command_replay_acquire(3) and is ended on submit */
+int record_vk_draw_commands(struct uvr_vk *app, struct uvr_vk_command_replay_frame *frame, VkExtent2D extent2D) {
+  VkCommandBuffer cmdBuffer = frame->vkCommandBuffer;
 
   VkRect2D renderArea = {};
   renderArea.offset.x = 0;
@@ -783,20 +843,20 @@ int record_vk_draw_commands(struct uvr_vk *app, uint32_t vkSwapchainImageIndex,
   renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
   renderPassInfo.pNext = NULL;
   renderPassInfo.renderPass = app->rpass.renderPass;
-  renderPassInfo.framebuffer = app->vkframebuffs.vkFrameBuffers[vkSwapchainImageIndex].fb;
+  renderPassInfo.framebuffer = app->vkframebuffs.vkFrameBuffers[frame->imageIndex].fb;
   renderPassInfo.renderArea = renderArea;
   renderPassInfo.clearValueCount = 1;
   renderPassInfo.pClearValues = clearColor;
 
-  vkCmdBeginRenderPass(cmdBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
-  vkCmdBindPipeline(cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, app->gpipeline.graphicsPipeline);
-  vkCmdSetViewport(cmdBuffer, 0, 1, &viewport);
-  vkCmdSetScissor(cmdBuffer, 0, 1, &renderArea);
-  vkCmdDraw(cmdBuffer, 3, 1, 0, 0);
-  vkCmdEndRenderPass(cmdBuffer);
-
-  if (uvr_vk_command_buffer_record_end(&commandBufferRecordInfo) == -1)
-    return -1;
+  app->lgdev.dispatch->CmdBeginRenderPass(cmdBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+  uvr_vk_dynamic_state_tracker_begin(&app->dyntracker, app->lgdev.dispatch, &app->dynstate, cmdBuffer);
+  uvr_vk_dynamic_state_tracker_bind_pipeline(&app->dyntracker, app->gpipeline.graphicsPipeline, app->dynstate.enabledFlags);
+  uvr_vk_dynamic_state_tracker_set_viewport(&app->dyntracker, &viewport);
+  uvr_vk_dynamic_state_tracker_set_scissor(&app->dyntracker, &renderArea);
+  uvr_vk_dynamic_state_tracker_set_cull_mode(&app->dyntracker, VK_CULL_MODE_BACK_BIT, VK_FRONT_FACE_CLOCKWISE);
+  uvr_vk_dynamic_state_tracker_set_topology(&app->dyntracker, VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST);
+  app->lgdev.dispatch->CmdDraw(cmdBuffer, 3, 1, 0, 0);
+  app->lgdev.dispatch->CmdEndRenderPass(cmdBuffer);
 
   return 0;
 }
@@ -0,0 +1,939 @@
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "xclient.h"
+#include "vulkan.h"
+#include "shader.h"
+
+#define WIDTH 1920
+#define HEIGHT 1080
+//#define WIDTH 3840
+//#define HEIGHT 2160
+#define PIPELINE_CACHE_PATH "bindless-quads-pipeline-cache.bin"
+#define FRAMES_IN_FLIGHT 2
+#define QUAD_COUNT 64
+#define TEXTURE_SIZE 64
+#define BINDLESS_CAPACITY 1024
+
+struct uvr_vk {
+  VkInstance instance;
+  VkPhysicalDevice phdev;
+  struct uvr_vk_lgdev lgdev;
+  struct uvr_vk_queue graphics_queue;
+
+  VkSurfaceKHR surface;
+  struct uvr_vk_swapchain schain;
+
+  struct uvr_vk_image vkimages;
+#ifdef INCLUDE_SHADERC
+  struct uvr_shader_spirv vertex_shader;
+  struct uvr_shader_spirv fragment_shader;
+#else
+  struct uvr_shader_file vertex_shader;
+  struct uvr_shader_file fragment_shader;
+#endif
+  struct uvr_vk_shader_module shader_modules[2];
+
+  struct uvr_vk_pipeline_layout gplayout;
+  struct uvr_vk_pipeline_cache pcache;
+  struct uvr_vk_graphics_pipeline gpipeline;
+  struct uvr_vk_dynamic_state dynstate;
+  struct uvr_vk_dynamic_state_tracker dyntracker;
+  struct uvr_vk_frame_ring frames;
+  struct uvr_vk_query_pool qpool;
+
+  struct uvr_vk_allocator allocator;
+  struct uvr_vk_upload_ring upload;
+  struct uvr_vk_image textures;
+  VkSampler sampler;
+  struct uvr_vk_bindless_table bindless;
+  uint32_t slots[QUAD_COUNT];
+};
+
+
+struct uvr_vk_xcb {
+  struct uvr_xcb_window *uvr_xcb_window;
+  struct uvr_vk *uvr_vk;
+};
+
+
+int create_xcb_vk_surface(struct uvr_vk *app, struct uvr_xcb_window *xc);
+int create_vk_instance(struct uvr_vk *uvrvk);
+int create_vk_device(struct uvr_vk *app);
+int create_vk_swapchain(struct uvr_vk *app, VkSurfaceFormatKHR *sformat, VkExtent2D extent2D);
+int create_vk_images(struct uvr_vk *app, VkSurfaceFormatKHR *sformat);
+int create_vk_shader_modules(struct uvr_vk *app);
+int create_vk_graphics_pipeline(struct uvr_vk *app, VkSurfaceFormatKHR *sformat);
+int create_vk_frame_ring(struct uvr_vk *app);
+int create_vk_query_pool(struct uvr_vk *app);
+int create_vk_textures(struct uvr_vk *app);
+int create_vk_textures(struct uvr_vk *app) {
+  static uint8_t pixels[TEXTURE_SIZE * TEXTURE_SIZE * 4];
+  uint32_t t, x, y;
+  uint64_t uploadId = 0;
+
+  struct uvr_vk_allocator_create_info allocatorCreateInfo;
+  allocatorCreateInfo.vkPhdev = app->phdev;
+  allocatorCreateInfo.vkDevice = app->lgdev.vkDevice;
+  allocatorCreateInfo.blockSize = 0;
+
+  app->allocator = uvr_vk_allocator_create(&allocatorCreateInfo);
+  if (!app->allocator.vkDevice)
+    return -1;
+
+  struct uvr_vk_upload_ring_create_info uploadRingCreateInfo;
+  uploadRingCreateInfo.allocator = &app->allocator;
+  uploadRingCreateInfo.vkQueue = app->graphics_queue.vkQueue;
+  uploadRingCreateInfo.srcQueueFamilyIndex = app->graphics_queue.familyIndex;
+  uploadRingCreateInfo.dstQueueFamilyIndex = app->graphics_queue.familyIndex;
+  uploadRingCreateInfo.size = QUAD_COUNT * sizeof(pixels);
+  uploadRingCreateInfo.alignment = 0;
+  uploadRingCreateInfo.batchCount = 0;
+  uploadRingCreateInfo.timeline = VK_FALSE;
+
+  app->upload = uvr_vk_upload_ring_create(&uploadRingCreateInfo);
+  if (!app->upload.pMapped)
+    return -1;
+
+  struct uvr_vk_image_create2_info textureCreateInfo;
+  textureCreateInfo.allocator = &app->allocator;
+  textureCreateInfo.memoryPropertyFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+  textureCreateInfo.mode = UVR_VK_ALLOCATION_BUDDY;
+  textureCreateInfo.imageCount = QUAD_COUNT;
+  textureCreateInfo.imageFlags = 0;
+  textureCreateInfo.imageType = VK_IMAGE_TYPE_2D;
+  textureCreateInfo.imageFormat = VK_FORMAT_R8G8B8A8_SRGB;
+  textureCreateInfo.imageExtent3D = (VkExtent3D) { TEXTURE_SIZE, TEXTURE_SIZE, 1 };
+  textureCreateInfo.imageMipLevels = 1;
+  textureCreateInfo.imageArrayLayers = 1;
+  textureCreateInfo.imageSamples = VK_SAMPLE_COUNT_1_BIT;
+  textureCreateInfo.imageTiling = VK_IMAGE_TILING_OPTIMAL;
+  textureCreateInfo.imageUsage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+  textureCreateInfo.imageSharingMode = VK_SHARING_MODE_EXCLUSIVE;
+  textureCreateInfo.queueFamilyIndexCount = 0;
+  textureCreateInfo.pQueueFamilyIndices = NULL;
+  textureCreateInfo.imageInitialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+  textureCreateInfo.imageViewFlags = 0;
+  textureCreateInfo.imageViewType = VK_IMAGE_VIEW_TYPE_2D;
+  textureCreateInfo.imageViewComponents.r = VK_COMPONENT_SWIZZLE_IDENTITY;
+  textureCreateInfo.imageViewComponents.g = VK_COMPONENT_SWIZZLE_IDENTITY;
+  textureCreateInfo.imageViewComponents.b = VK_COMPONENT_SWIZZLE_IDENTITY;
+  textureCreateInfo.imageViewComponents.a = VK_COMPONENT_SWIZZLE_IDENTITY;
+  textureCreateInfo.imageViewSubresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+  textureCreateInfo.imageViewSubresourceRange.baseMipLevel = 0;
+  textureCreateInfo.imageViewSubresourceRange.levelCount = 1;
+  textureCreateInfo.imageViewSubresourceRange.baseArrayLayer = 0;
+  textureCreateInfo.imageViewSubresourceRange.layerCount = 1;
+
+  app->textures = uvr_vk_image_create2(&textureCreateInfo);
+  if (!app->textures.vkImages)
+    return -1;
+
+  VkSamplerCreateInfo samplerCreateInfo = {};
+  samplerCreateInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+  samplerCreateInfo.magFilter = VK_FILTER_NEAREST;
+  samplerCreateInfo.minFilter = VK_FILTER_NEAREST;
+  samplerCreateInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+  samplerCreateInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+  samplerCreateInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+  samplerCreateInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+  samplerCreateInfo.maxLod = 0.0f;
+
+  if (vkCreateSampler(app->lgdev.vkDevice, &samplerCreateInfo, uvr_vk_host_allocator_get_callbacks(), &app->sampler) != VK_SUCCESS)
+    return -1;
+
+  struct uvr_vk_bindless_table_create_info bindlessCreateInfo;
+  bindlessCreateInfo.vkPhdev = app->phdev;
+  bindlessCreateInfo.vkDevice = app->lgdev.vkDevice;
+  bindlessCreateInfo.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+  bindlessCreateInfo.capacity = BINDLESS_CAPACITY;
+  bindlessCreateInfo.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+  bindlessCreateInfo.framesInFlight = FRAMES_IN_FLIGHT;
+
+  app->bindless = uvr_vk_bindless_table_create(&bindlessCreateInfo);
+  if (!app->bindless.vkDescriptorSet)
+    return -1;
+
+  for (t = 0; t < QUAD_COUNT; t++) {
+    /* Checkerboard with a different tint per texture */
+    for (y = 0; y < TEXTURE_SIZE; y++) {
+      for (x = 0; x < TEXTURE_SIZE; x++) {
+        uint8_t *texel = &pixels[(y * TEXTURE_SIZE + x) * 4];
+        uint8_t on = ((x / 8) + (y / 8)) & 1;
+        texel[0] = on ? (uint8_t) (t * 37) : 32;
+        texel[1] = on ? (uint8_t) (t * 91) : 32;
+        texel[2] = on ? (uint8_t) (t * 13 + 128) : 32;
+        texel[3] = 255;
+      }
+    }
+
+    struct uvr_vk_upload_image_info uploadImageInfo;
+    uploadImageInfo.pData = pixels;
+    uploadImageInfo.size = sizeof(pixels);
+    uploadImageInfo.dstImage = app->textures.vkImages[t].image;
+    uploadImageInfo.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    uploadImageInfo.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    uploadImageInfo.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    uploadImageInfo.imageSubresource.mipLevel = 0;
+    uploadImageInfo.imageSubresource.baseArrayLayer = 0;
+    uploadImageInfo.imageSubresource.layerCount = 1;
+    uploadImageInfo.imageOffset = (VkOffset3D) { 0, 0, 0 };
+    uploadImageInfo.imageExtent = (VkExtent3D) { TEXTURE_SIZE, TEXTURE_SIZE, 1 };
+    uploadImageInfo.dstStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+    uploadImageInfo.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+    if (!uvr_vk_upload_ring_copy_image(&app->upload, &uploadImageInfo))
+      return -1;
+
+    /* Fresh table hands out consecutive slots, shaders index them from app->slots[0] */
+    app->slots[t] = uvr_vk_bindless_table_alloc(&app->bindless, app->textures.vkImageViews[t].view,
+                                                VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, app->sampler);
+    if (app->slots[t] == UVR_VK_BINDLESS_INVALID_SLOT)
+      return -1;
+  }
+
+  if (uvr_vk_upload_ring_flush(&app->upload, &uploadId) == -1)
+    return -1;
+
+  while (!uvr_vk_upload_ring_poll(&app->upload, uploadId))
+    usleep(1000);
+
+  return 0;
+}
+
+
+int record_vk_draw_commands(struct uvr_vk *app, struct uvr_vk_frame *frame, VkExtent2D extent2D);
+
+
+void render(bool UNUSED *running, uint32_t *imageIndex, void *data) {
+  VkExtent2D extent2D = {WIDTH, HEIGHT};
+  struct uvr_vk_xcb *vkxcb = (struct uvr_vk_xcb *) data;
+  struct uvr_xcb_window UNUSED *xc = vkxcb->uvr_xcb_window;
+  struct uvr_vk *app = vkxcb->uvr_vk;
+
+  if (!app->frames.vkSyncs.vkFences)
+    return;
+
+  struct uvr_vk_frame frame;
+  if (uvr_vk_frame_ring_acquire(&app->frames, &frame) < 0)
+    return;
+
+  *imageIndex = frame.imageIndex;
+
+  /* Frame slot's previous submission is done, read back its GPU timings */
+  uvr_vk_query_pool_next_frame(&app->qpool);
+
+  /* Slots freed FRAMES_IN_FLIGHT frames ago are no longer referenced by the GPU */
+  uvr_vk_bindless_table_next_frame(&app->bindless);
+
+  /* Acquire's semaphore must still be waited on, abandon the frame rather than leaving it signaled */
+  if (record_vk_draw_commands(app, &frame, extent2D) == -1) {
+    uvr_vk_frame_ring_abandon(&app->frames);
+    return;
+  }
+
+  /* Submit draw command, a failed submit already abandoned the frame */
+  if (uvr_vk_frame_ring_submit(&app->frames) == -1)
+    return;
+
+  uvr_vk_frame_ring_present(&app->frames);
+}
+
+
+/*
+ * Example code demonstrating how to draw many textured quads with a
+ * single bound descriptor set and one draw call
+ */
+int main(void) {
+  struct uvr_vk app;
+  struct uvr_vk_destroy appd;
+  memset(&app, 0, sizeof(app));
+  memset(&appd, 0, sizeof(appd));
+
+  struct uvr_xcb_window xc;
+  struct uvr_xcb_destroy xcd;
+  memset(&xc, 0, sizeof(xc));
+  memset(&xcd, 0, sizeof(xcd));
+
+  struct uvr_shader_destroy shadercd;
+  memset(&shadercd, 0, sizeof(shadercd));
+
+  if (create_vk_instance(&app) == -1)
+    goto exit_error;
+
+  if (create_xcb_vk_surface(&app, &xc) == -1)
+    goto exit_error;
+
+  /*
+   * Create Vulkan Physical Device Handle, After Window Surface
+   * so that it doesn't effect VkPhysicalDevice selection
+   */
+  if (create_vk_device(&app) == -1)
+    goto exit_error;
+
+  VkSurfaceFormatKHR sformat;
+  VkExtent2D extent2D = {WIDTH, HEIGHT};
+  if (create_vk_swapchain(&app, &sformat, extent2D) == -1)
+    goto exit_error;
+
+  if (create_vk_images(&app, &sformat) == -1)
+    goto exit_error;
+
+  if (create_vk_textures(&app) == -1)
+    goto exit_error;
+
+  if (create_vk_shader_modules(&app) == -1)
+    goto exit_error;
+
+  if (create_vk_graphics_pipeline(&app, &sformat) == -1)
+    goto exit_error;
+
+  if (create_vk_frame_ring(&app) == -1)
+    goto exit_error;
+
+  if (create_vk_query_pool(&app) == -1)
+    goto exit_error;
+
+  static uint32_t cbuf = 0;
+  static bool running = true;
+
+  static struct uvr_vk_xcb vkxc;
+  vkxc.uvr_xcb_window = &xc;
+  vkxc.uvr_vk = &app;
+
+  struct uvr_xcb_window_handle_event_info eventInfo;
+  eventInfo.uvrXcbWindow = &xc;
+  eventInfo.renderer = render;
+  eventInfo.rendererData = &vkxc;
+  eventInfo.rendererCbuf = &cbuf;
+  eventInfo.rendererRuning = &running;
+
+  while (uvr_xcb_window_handle_event(&eventInfo) && running) {
+    // Initentionally left blank
+  }
+
+  if (app.frames.frameNumber) {
+    uvr_utils_log(UVR_INFO, "%" PRIu64 " frames, cpu wait avg %.3f ms, max %.3f ms", app.frames.frameNumber,
+                            (double) app.frames.cpuWaitTotalNs / app.frames.frameNumber / 1000000.0,
+                            (double) app.frames.cpuWaitMaxNs / 1000000.0);
+
+    struct uvr_vk_query_percentiles gpuTime = uvr_vk_query_pool_get_percentiles(&app.qpool, "bindless-quads");
+    uvr_utils_log(UVR_INFO, "gpu time p50 %.3f ms, p90 %.3f ms, p99 %.3f ms", gpuTime.p50Ns / 1000000.0,
+                            gpuTime.p90Ns / 1000000.0, gpuTime.p99Ns / 1000000.0);
+
+    uvr_utils_log(UVR_INFO, "%d quads drawn per frame with 1 descriptor set bind, %u bindless slots peak",
+                            QUAD_COUNT, app.bindless.peakSlotsInUse);
+  }
+
+
+exit_error:
+#ifdef INCLUDE_SHADERC
+  shadercd.uvr_shader_spirv = app.vertex_shader;
+  shadercd.uvr_shader_spirv = app.fragment_shader;
+#else
+  shadercd.uvr_shader_file = app.vertex_shader;
+  shadercd.uvr_shader_file = app.fragment_shader;
+#endif
+  uvr_shader_destroy(&shadercd);
+
+  if (app.sampler)
+    vkDestroySampler(app.lgdev.vkDevice, app.sampler, uvr_vk_host_allocator_get_callbacks());
+
+  struct uvr_vk_image images[2] = { app.vkimages, app.textures };
+
+  /*
+   * Let the api know of what addresses to free and fd's to close
+   */
+  appd.vkinst = app.instance;
+  appd.vksurf = app.surface;
+  appd.uvr_vk_lgdev_cnt = 1;
+  appd.uvr_vk_lgdev = &app.lgdev;
+  appd.uvr_vk_swapchain_cnt = 1;
+  appd.uvr_vk_swapchain = &app.schain;
+  appd.uvr_vk_image_cnt = ARRAY_LEN(images);
+  appd.uvr_vk_image = images;
+  appd.uvr_vk_shader_module_cnt = ARRAY_LEN(app.shader_modules);
+  appd.uvr_vk_shader_module = app.shader_modules;
+  appd.uvr_vk_pipeline_layout_cnt = 1;
+  appd.uvr_vk_pipeline_layout = &app.gplayout;
+  appd.uvr_vk_graphics_pipeline_cnt = 1;
+  appd.uvr_vk_graphics_pipeline = &app.gpipeline;
+  appd.uvr_vk_pipeline_cache_cnt = 1;
+  appd.uvr_vk_pipeline_cache = &app.pcache;
+  appd.uvr_vk_frame_ring_cnt = 1;
+  appd.uvr_vk_frame_ring = &app.frames;
+  appd.uvr_vk_query_pool_cnt = 1;
+  appd.uvr_vk_query_pool = &app.qpool;
+  appd.uvr_vk_allocator_cnt = 1;
+  appd.uvr_vk_allocator = &app.allocator;
+  appd.uvr_vk_upload_ring_cnt = 1;
+  appd.uvr_vk_upload_ring = &app.upload;
+  appd.uvr_vk_bindless_table_cnt = 1;
+  appd.uvr_vk_bindless_table = &app.bindless;
+  uvr_vk_destory(&appd);
+
+  xcd.uvr_xcb_window = xc;
+  uvr_xcb_destory(&xcd);
+  return 0;
+}
+
+
+int create_xcb_vk_surface(struct uvr_vk *app, struct uvr_xcb_window *xc) {
+
+  /*
+   * Create xcb client
+   */
+  struct uvr_xcb_window_create_info xcb_win_info;
+  xcb_win_info.display = NULL;
+  xcb_win_info.screen = NULL;
+  xcb_win_info.appName = "Example App";
+  xcb_win_info.width = WIDTH;
+  xcb_win_info.height = HEIGHT;
+  xcb_win_info.fullscreen = false;
+  xcb_win_info.transparent = false;
+
+  *xc = uvr_xcb_window_create(&xcb_win_info);
+  if (!xc->conn)
+    return -1;
+
+  /*
+   * Create Vulkan Surface
+   */
+  struct uvr_vk_surface_create_info vk_surface_info;
+  vk_surface_info.vkInst = app->instance;
+  vk_surface_info.sType = XCB_CLIENT_SURFACE;
+  vk_surface_info.display = xc->conn;
+  vk_surface_info.window = xc->window;
+
+  app->surface = uvr_vk_surface_create(&vk_surface_info);
+  if (!app->surface)
+    return -1;
+
+  return 0;
+}
+
+
+int create_vk_instance(struct uvr_vk *app) {
+
+  /*
+   * "VK_LAYER_KHRONOS_validation"
+   * All of the useful standard validation is
+   * bundled into a layer included in the SDK
+   */
+  const char *validation_layers[] = {
+    "VK_LAYER_KHRONOS_validation"
+  };
+
+  const char *instance_extensions[] = {
+    "VK_KHR_xcb_surface",
+    "VK_KHR_surface",
+    "VK_KHR_display",
+    "VK_EXT_debug_utils"
+  };
+
+  struct uvr_vk_instance_create_info vkinst;
+  vkinst.appName = "Example App";
+  vkinst.engineName = "No Engine";
+  vkinst.enabledLayerCount = ARRAY_LEN(validation_layers);
+  vkinst.ppEnabledLayerNames = validation_layers;
+  vkinst.enabledExtensionCount = ARRAY_LEN(instance_extensions);
+  vkinst.ppEnabledExtensionNames = instance_extensions;
+
+  app->instance = uvr_vk_instance_create(&vkinst);
+  if (!app->instance) return -1;
+
+  return 0;
+}
+
+
+int create_vk_device(struct uvr_vk *app) {
+
+  const char *device_extensions[] = {
+    "VK_KHR_swapchain"
+  };
+
+  struct uvr_vk_phdev_create_info vkphdev;
+  vkphdev.vkInst = app->instance;
+  vkphdev.vkPhdevType = VK_PHYSICAL_DEVICE_TYPE;
+  vkphdev.enabledExtensionCount = ARRAY_LEN(device_extensions);
+  vkphdev.ppEnabledExtensionNames = device_extensions;
+  vkphdev.pRequiredFeatures = NULL;
+#ifdef INCLUDE_KMS
+  vkphdev.kmsFd = -1;
+#endif
+
+  app->phdev = uvr_vk_phdev_create(&vkphdev);
+  if (!app->phdev)
+    return -1;
+
+  struct uvr_vk_queue_create_info vkqueueinfo;
+  vkqueueinfo.vkPhdev = app->phdev;
+  vkqueueinfo.queueFlag = VK_QUEUE_GRAPHICS_BIT;
+  vkqueueinfo.preferDedicated = VK_FALSE;
+
+  app->graphics_queue = uvr_vk_queue_create(&vkqueueinfo);
+  if (app->graphics_queue.familyIndex == -1)
+    return -1;
+
+  VkPhysicalDeviceFeatures phdevfeats = uvr_vk_get_phdev_features(app->phdev);
+
+  /* No VkRenderPass/VkFramebuffer objects are created, attachments are passed while recording */
+  VkPhysicalDeviceVulkan13Features vk13features = {};
+  vk13features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES;
+  vk13features.pNext = NULL;
+  vk13features.dynamicRendering = VK_TRUE;
+
+  struct uvr_vk_lgdev_create_info vklgdevinfo;
+  vklgdevinfo.vkInst = app->instance;
+  vklgdevinfo.vkPhdev = app->phdev;
+  vklgdevinfo.pNext = &vk13features;
+  vklgdevinfo.pEnabledFeatures = &phdevfeats;
+  vklgdevinfo.enableDescriptorIndexing = VK_TRUE;
+  vklgdevinfo.enabledExtensionCount = ARRAY_LEN(device_extensions);
+  vklgdevinfo.ppEnabledExtensionNames = device_extensions;
+  vklgdevinfo.queueCount = 1;
+  vklgdevinfo.queues = &app->graphics_queue;
+
+  app->lgdev = uvr_vk_lgdev_create(&vklgdevinfo);
+  if (!app->lgdev.vkDevice)
+    return -1;
+
+  return 0;
+}
+
+
+/* choose swap chain surface format & present mode */
+int create_vk_swapchain(struct uvr_vk *app, VkSurfaceFormatKHR *sformat, VkExtent2D extent2D) {
+  VkPresentModeKHR presmode;
+
+  VkSurfaceCapabilitiesKHR surfcap = uvr_vk_get_surface_capabilities(app->phdev, app->surface);
+  struct uvr_vk_surface_format sformats = uvr_vk_get_surface_formats(app->phdev, app->surface);
+  struct uvr_vk_surface_present_mode spmodes = uvr_vk_get_surface_present_modes(app->phdev, app->surface);
+
+  /* Choose surface format based */
+  for (uint32_t s = 0; s < sformats.surfaceFormatCount; s++) {
+    if (sformats.surfaceFormats[s].format == VK_FORMAT_B8G8R8A8_SRGB && sformats.surfaceFormats[s].colorSpace == VK_COLOR_SPACE_SRGB_NONLINEAR_KHR) {
+      *sformat = sformats.surfaceFormats[s];
+    }
+  }
+
+  for (uint32_t p = 0; p < spmodes.presentModeCount; p++) {
+    if (spmodes.presentModes[p] == VK_PRESENT_MODE_MAILBOX_KHR) {
+      presmode = spmodes.presentModes[p];
+    }
+  }
+
+  free(sformats.surfaceFormats); sformats.surfaceFormats = NULL;
+  free(spmodes.presentModes); spmodes.presentModes = NULL;
+
+  struct uvr_vk_swapchain_create_info scinfo;
+  scinfo.vkDevice = app->lgdev.vkDevice;
+  scinfo.vkSurface = app->surface;
+  scinfo.surfaceCapabilities = surfcap;
+  scinfo.surfaceFormat = *sformat;
+  scinfo.extent2D = extent2D;
+  scinfo.imageArrayLayers = 1;
+  scinfo.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+  scinfo.imageSharingMode = VK_SHARING_MODE_EXCLUSIVE;
+  scinfo.queueFamilyIndexCount = 0;
+  scinfo.pQueueFamilyIndices = NULL;
+  scinfo.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
+  scinfo.presentMode = presmode;
+  scinfo.clipped = VK_TRUE;
+  scinfo.oldSwapchain = VK_NULL_HANDLE;
+
+  app->schain = uvr_vk_swapchain_create(&scinfo);
+  if (!app->schain.vkSwapchain)
+    return -1;
+
+  return 0;
+}
+
+
+int create_vk_images(struct uvr_vk *app, VkSurfaceFormatKHR *sformat) {
+
+  struct uvr_vk_image_create_info vkimage_create_info;
+  vkimage_create_info.vkDevice = app->lgdev.vkDevice;
+  vkimage_create_info.vkSwapchain = app->schain.vkSwapchain;
+  vkimage_create_info.flags = 0;
+  vkimage_create_info.viewType = VK_IMAGE_VIEW_TYPE_2D;
+  vkimage_create_info.format = sformat->format;
+  vkimage_create_info.components.r = VK_COMPONENT_SWIZZLE_IDENTITY;
+  vkimage_create_info.components.g = VK_COMPONENT_SWIZZLE_IDENTITY;
+  vkimage_create_info.components.b = VK_COMPONENT_SWIZZLE_IDENTITY;
+  vkimage_create_info.components.a = VK_COMPONENT_SWIZZLE_IDENTITY;
+  vkimage_create_info.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+  vkimage_create_info.subresourceRange.baseMipLevel = 0;
+  vkimage_create_info.subresourceRange.levelCount = 1;
+  vkimage_create_info.subresourceRange.baseArrayLayer = 0;
+  vkimage_create_info.subresourceRange.layerCount = 1;
+
+  app->vkimages = uvr_vk_image_create(&vkimage_create_info);
+  if (!app->vkimages.vkImageViews[0].view)
+    return -1;
+
+  return 0;
+}
+
+
+int create_vk_shader_modules(struct uvr_vk *app) {
+
+#ifdef INCLUDE_SHADERC
+  const char vertex_shader[] =
+    "#version 450\n"
+    "#define QUADS_PER_ROW 8\n"
+    "layout(location = 0) out vec2 v_TexCoord;\n"
+    "layout(location = 1) flat out uint v_TextureIndex;\n"
+    "vec2 corners[6] = vec2[](\n"
+    "  vec2(0.0, 0.0), vec2(1.0, 0.0), vec2(1.0, 1.0),\n"
+    "  vec2(1.0, 1.0), vec2(0.0, 1.0), vec2(0.0, 0.0)\n"
+    ");\n\n"
+    "void main() {\n"
+    "  vec2 corner = corners[gl_VertexIndex];\n"
+    "  vec2 cell = vec2(gl_InstanceIndex % QUADS_PER_ROW, gl_InstanceIndex / QUADS_PER_ROW);\n"
+    "  vec2 size = vec2(2.0 / QUADS_PER_ROW);\n"
+    "  gl_Position = vec4(-1.0 + (cell + 0.05 + corner * 0.9) * size, 0.0, 1.0);\n"
+    "  v_TexCoord = corner;\n"
+    "  v_TextureIndex = gl_InstanceIndex;\n"
+    "}";
+
+  const char fragment_shader[] =
+    "#version 450\n"
+    "#extension GL_EXT_nonuniform_qualifier : require\n"
+    "layout(set = 0, binding = 0) uniform sampler2D textures[];\n"
+    "layout(push_constant) uniform PushConstants { uint baseSlot; } pc;\n"
+    "layout(location = 0) in vec2 v_TexCoord;\n"
+    "layout(location = 1) flat in uint v_TextureIndex;\n"
+    "layout(location = 0) out vec4 o_Color;\n"
+    "void main() {\n"
+    "  o_Color = texture(textures[nonuniformEXT(pc.baseSlot + v_TextureIndex)], v_TexCoord);\n"
+    "}";
+
+  struct uvr_shader_spirv_create_info vert_shader_create_info;
+  vert_shader_create_info.kind = VK_SHADER_STAGE_VERTEX_BIT;
+  vert_shader_create_info.source = vertex_shader;
+  vert_shader_create_info.filename = "vert.spv";
+  vert_shader_create_info.entryPoint = "main";
+
+  struct uvr_shader_spirv_create_info frag_shader_create_info;
+  frag_shader_create_info.kind = VK_SHADER_STAGE_FRAGMENT_BIT;
+  frag_shader_create_info.source = fragment_shader;
+  frag_shader_create_info.filename = "frag.spv";
+  frag_shader_create_info.entryPoint = "main";
+
+  app->vertex_shader = uvr_shader_compile_buffer_to_spirv(&vert_shader_create_info);
+  if (!app->vertex_shader.bytes)
+    return -1;
+
+  app->fragment_shader = uvr_shader_compile_buffer_to_spirv(&frag_shader_create_info);
+  if (!app->fragment_shader.bytes)
+    return -1;
+
+#else
+  app->vertex_shader = uvr_shader_file_load(BINDLESS_QUADS_VERTEX_SHADER_SPIRV);
+  if (!app->vertex_shader.bytes)
+    return -1;
+
+  app->fragment_shader = uvr_shader_file_load(BINDLESS_QUADS_FRAGMENT_SHADER_SPIRV);
+  if (!app->fragment_shader.bytes)
+    return -1;
+#endif
+
+  struct uvr_vk_shader_module_create_info vertex_shader_module_create_info;
+  vertex_shader_module_create_info.vkDevice = app->lgdev.vkDevice;
+  vertex_shader_module_create_info.codeSize = app->vertex_shader.byteSize;
+  vertex_shader_module_create_info.pCode = app->vertex_shader.bytes;
+  vertex_shader_module_create_info.name = "vertex";
+
+  app->shader_modules[0] = uvr_vk_shader_module_create(&vertex_shader_module_create_info);
+  if (!app->shader_modules[0].shader)
+    return -1;
+
+  struct uvr_vk_shader_module_create_info frag_shader_module_create_info;
+  frag_shader_module_create_info.vkDevice = app->lgdev.vkDevice;
+  frag_shader_module_create_info.codeSize = app->fragment_shader.byteSize;
+  frag_shader_module_create_info.pCode = app->fragment_shader.bytes;
+  frag_shader_module_create_info.name = "fragment";
+
+  app->shader_modules[1] = uvr_vk_shader_module_create(&frag_shader_module_create_info);
+  if (!app->shader_modules[1].shader)
+    return -1;
+
+  return 0;
+}
+
+
+int create_vk_graphics_pipeline(struct uvr_vk *app, VkSurfaceFormatKHR *sformat) {
+
+  /* Taken directly from https://vulkan-tutorial.com */
+  VkPipelineShaderStageCreateInfo vertShaderStageInfo = {};
+  vertShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+  vertShaderStageInfo.stage = VK_SHADER_STAGE_VERTEX_BIT;
+  vertShaderStageInfo.module = app->shader_modules[0].shader;
+  vertShaderStageInfo.pName = "main";
+
+  VkPipelineShaderStageCreateInfo fragShaderStageInfo = {};
+  fragShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+  fragShaderStageInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+  fragShaderStageInfo.module = app->shader_modules[1].shader;
+  fragShaderStageInfo.pName = "main";
+
+  VkPipelineShaderStageCreateInfo shaderStages[2] = {vertShaderStageInfo, fragShaderStageInfo};
+
+  /*
+   * Provides details for loading vertex data
+   */
+  VkPipelineVertexInputStateCreateInfo vertexInputInfo = {};
+  vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+  vertexInputInfo.vertexBindingDescriptionCount = 0;
+  vertexInputInfo.pVertexBindingDescriptions = NULL;
+  vertexInputInfo.vertexAttributeDescriptionCount = 0;
+  vertexInputInfo.pVertexAttributeDescriptions = NULL;
+
+  VkPipelineInputAssemblyStateCreateInfo inputAssembly = {};
+  inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+  inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+  inputAssembly.primitiveRestartEnable = VK_FALSE;
+
+  VkPipelineViewportStateCreateInfo viewportState = {};
+  viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+  viewportState.viewportCount = 1;
+  viewportState.pViewports = NULL;
+  viewportState.scissorCount = 1;
+  viewportState.pScissors = NULL;
+
+  VkPipelineRasterizationStateCreateInfo rasterizer = {};
+  rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+  rasterizer.depthClampEnable = VK_FALSE;
+  rasterizer.rasterizerDiscardEnable = VK_FALSE;
+  rasterizer.polygonMode = VK_POLYGON_MODE_FILL;
+  rasterizer.lineWidth = 1.0f;
+  rasterizer.cullMode = VK_CULL_MODE_NONE;
+  rasterizer.frontFace = VK_FRONT_FACE_CLOCKWISE;
+  rasterizer.depthBiasEnable = VK_FALSE;
+  rasterizer.depthBiasConstantFactor = 0.0f;
+  rasterizer.depthBiasClamp = 0.0f;
+  rasterizer.depthBiasSlopeFactor = 0.0f;
+
+  VkPipelineMultisampleStateCreateInfo multisampling = {};
+  multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+  multisampling.sampleShadingEnable = VK_FALSE;
+  multisampling.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+  multisampling.minSampleShading = 1.0f;
+  multisampling.pSampleMask = NULL;
+  multisampling.alphaToCoverageEnable = VK_FALSE;
+  multisampling.alphaToOneEnable = VK_FALSE;
+
+  VkPipelineColorBlendAttachmentState colorBlendAttachment = {};
+  colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+  colorBlendAttachment.blendEnable = VK_FALSE;
+  colorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_ONE;
+  colorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ZERO;
+  colorBlendAttachment.colorBlendOp = VK_BLEND_OP_ADD;
+  colorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+  colorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
+  colorBlendAttachment.alphaBlendOp = VK_BLEND_OP_ADD;
+
+  VkPipelineColorBlendStateCreateInfo colorBlending = {};
+  colorBlending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+  colorBlending.logicOpEnable = VK_FALSE;
+  colorBlending.logicOp = VK_LOGIC_OP_COPY;
+  colorBlending.attachmentCount = 1;
+  colorBlending.pAttachments = &colorBlendAttachment;
+  colorBlending.blendConstants[0] = 0.0f;
+  colorBlending.blendConstants[1] = 0.0f;
+  colorBlending.blendConstants[2] = 0.0f;
+  colorBlending.blendConstants[3] = 0.0f;
+
+  struct uvr_vk_dynamic_state_create_info dynamicStateInfo;
+  dynamicStateInfo.vkPhdev = app->phdev;
+  dynamicStateInfo.vkDevice = app->lgdev.vkDevice;
+  dynamicStateInfo.flags = UVR_VK_DYNAMIC_STATE_VIEWPORT_SCISSOR;
+  dynamicStateInfo.extendedDynamicState3Enabled = VK_FALSE;
+
+  if (uvr_vk_dynamic_state_init(&app->dynstate, &dynamicStateInfo) == -1)
+    return -1;
+
+  /* Every quad samples through the same set, only the base slot is pushed */
+  VkPushConstantRange pushConstantRange;
+  pushConstantRange.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+  pushConstantRange.offset = 0;
+  pushConstantRange.size = sizeof(uint32_t);
+
+  struct uvr_vk_pipeline_layout_create_info gplayout_info;
+  gplayout_info.vkDevice = app->lgdev.vkDevice;
+  gplayout_info.setLayoutCount = 1;
+  gplayout_info.pSetLayouts = &app->bindless.vkDescriptorSetLayout;
+  gplayout_info.pushConstantRangeCount = 1;
+  gplayout_info.pPushConstantRanges = &pushConstantRange;
+
+  app->gplayout = uvr_vk_pipeline_layout_create(&gplayout_info);
+  if (!app->gplayout.vkPipelineLayout)
+    return -1;
+
+  /* Second run of the example should show a noticeably lower pipeline creation time */
+  struct uvr_vk_pipeline_cache_create_info pcache_info;
+  pcache_info.vkPhdev = app->phdev;
+  pcache_info.vkDevice = app->lgdev.vkDevice;
+  pcache_info.filePath = PIPELINE_CACHE_PATH;
+
+  app->pcache = uvr_vk_pipeline_cache_create(&pcache_info);
+  if (!app->pcache.vkPipelineCache)
+    return -1;
+
+  VkPipelineRenderingCreateInfo renderingInfo = {};
+  renderingInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO;
+  renderingInfo.pNext = NULL;
+  renderingInfo.viewMask = 0;
+  renderingInfo.colorAttachmentCount = 1;
+  renderingInfo.pColorAttachmentFormats = &sformat->format;
+  renderingInfo.depthAttachmentFormat = VK_FORMAT_UNDEFINED;
+  renderingInfo.stencilAttachmentFormat = VK_FORMAT_UNDEFINED;
+
+  struct uvr_vk_graphics_pipeline_create_info gpipeline_info;
+  gpipeline_info.vkDevice = app->lgdev.vkDevice;
+  gpipeline_info.stageCount = ARRAY_LEN(shaderStages);
+  gpipeline_info.pStages = shaderStages;
+  gpipeline_info.pVertexInputState = &vertexInputInfo;
+  gpipeline_info.pInputAssemblyState = &inputAssembly;
+  gpipeline_info.pTessellationState = NULL;
+  gpipeline_info.pViewportState = &viewportState;
+  gpipeline_info.pRasterizationState = &rasterizer;
+  gpipeline_info.pMultisampleState = &multisampling;
+  gpipeline_info.pDepthStencilState = NULL;
+  gpipeline_info.pColorBlendState = &colorBlending;
+  gpipeline_info.pDynamicState = &app->dynstate.createInfo;
+  gpipeline_info.vkPipelineLayout = app->gplayout.vkPipelineLayout;
+  gpipeline_info.renderPass = VK_NULL_HANDLE;
+  gpipeline_info.subpass = 0;
+  gpipeline_info.vkPipelineCache = app->pcache.vkPipelineCache;
+  gpipeline_info.pRenderingInfo = &renderingInfo;
+
+  app->gpipeline = uvr_vk_graphics_pipeline_create(&gpipeline_info);
+  if (!app->gpipeline.graphicsPipeline)
+    return -1;
+
+  return 0;
+}
+
+
+int create_vk_frame_ring(struct uvr_vk *app) {
+  struct uvr_vk_frame_ring_create_info frameRingCreateInfo;
+  frameRingCreateInfo.vkDevice = app->lgdev.vkDevice;
+  frameRingCreateInfo.vkQueue = app->graphics_queue.vkQueue;
+  frameRingCreateInfo.queueFamilyIndex = app->graphics_queue.familyIndex;
+  frameRingCreateInfo.vkSwapchain = app->schain.vkSwapchain;
+  frameRingCreateInfo.frameCount = FRAMES_IN_FLIGHT;
+
+  app->frames = uvr_vk_frame_ring_create(&frameRingCreateInfo);
+  if (!app->frames.vkSyncs.vkFences)
+    return -1;
+
+  return 0;
+}
+
+
+int create_vk_query_pool(struct uvr_vk *app) {
+  struct uvr_vk_query_pool_create_info queryPoolCreateInfo;
+  queryPoolCreateInfo.vkPhdev = app->phdev;
+  queryPoolCreateInfo.vkDevice = app->lgdev.vkDevice;
+  queryPoolCreateInfo.queueFamilyIndex = app->graphics_queue.familyIndex;
+  queryPoolCreateInfo.frameCount = FRAMES_IN_FLIGHT;
+  queryPoolCreateInfo.maxScopes = 4;
+  queryPoolCreateInfo.pipelineStatistics = 0;
+  queryPoolCreateInfo.historyLength = 256;
+
+  app->qpool = uvr_vk_query_pool_create(&queryPoolCreateInfo);
+  if (!app->qpool.vkTimestampPool)
+    return -1;
+
+  return 0;
+}
+
+
+int record_vk_draw_commands(struct uvr_vk *app, struct uvr_vk_frame *frame, VkExtent2D extent2D) {
+  struct uvr_vk_command_buffer_record_info commandBufferRecordInfo;
+  commandBufferRecordInfo.commandBufferCount = 1;
+  commandBufferRecordInfo.vkCommandbuffers = &app->frames.vkCommandbuffs.vkCommandbuffers[frame->frameIndex];
+  commandBufferRecordInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+  commandBufferRecordInfo.pInheritanceInfo = NULL;
+  commandBufferRecordInfo.queryPool = &app->qpool;
+  commandBufferRecordInfo.queryScopeName = "bindless-quads";
+
+  if (uvr_vk_command_buffer_record_begin(&commandBufferRecordInfo) == -1)
+    return -1;
+
+  VkCommandBuffer cmdBuffer = frame->vkCommandBuffer;
+
+  VkRect2D renderArea = {};
+  renderArea.offset.x = 0;
+  renderArea.offset.y = 0;
+  renderArea.extent = extent2D;
+
+  VkViewport viewport = {};
+  viewport.x = 0.0f;
+  viewport.y = 0.0f;
+  viewport.width = (float) extent2D.width;
+  viewport.height = (float) extent2D.height;
+  viewport.minDepth = 0.0f;
+  viewport.maxDepth = 1.0f;
+
+  /*
+   * Values used by VK_ATTACHMENT_LOAD_OP_CLEAR
+   * Black with 100% opacity
+   */
+  float float32[4] = {0.0f, 0.0f, 0.0f, 1.0f};
+  int32_t int32[4] = {0.0f, 0.0f, 0.0f, 1.0f};
+  uint32_t uint32[4] = {0.0f, 0.0f, 0.0f, 1.0f};
+
+  VkClearValue clearColor[1];
+  memcpy(clearColor[0].color.float32, float32, ARRAY_LEN(float32));
+  memcpy(clearColor[0].color.int32, int32, ARRAY_LEN(int32));
+  memcpy(clearColor[0].color.int32, uint32, ARRAY_LEN(uint32));
+  clearColor[0].depthStencil.depth = 0.0f;
+  clearColor[0].depthStencil.stencil = 0;
+
+  VkImage swapchainImage = app->vkimages.vkImages[frame->imageIndex].image;
+  VkImageView swapchainImageView = app->vkimages.vkImageViews[frame->imageIndex].view;
+
+  struct uvr_vk_rendering_begin_info renderingBeginInfo;
+  renderingBeginInfo.vkCommandBuffer = cmdBuffer;
+  renderingBeginInfo.renderArea = renderArea;
+  renderingBeginInfo.colorAttachmentCount = 1;
+  renderingBeginInfo.pColorImages = &swapchainImage;
+  renderingBeginInfo.pColorImageViews = &swapchainImageView;
+  renderingBeginInfo.colorOldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+  renderingBeginInfo.colorLoadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+  renderingBeginInfo.colorStoreOp = VK_ATTACHMENT_STORE_OP_STORE;
+  renderingBeginInfo.pColorClearValues = clearColor;
+  renderingBeginInfo.depthImage = VK_NULL_HANDLE;
+  renderingBeginInfo.depthImageView = VK_NULL_HANDLE;
+  renderingBeginInfo.depthOldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+  renderingBeginInfo.depthLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+  renderingBeginInfo.depthStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+  renderingBeginInfo.depthClearValue = clearColor[0];
+  renderingBeginInfo.renderingFlags = 0;
+
+  struct uvr_vk_rendering_end_info renderingEndInfo;
+  renderingEndInfo.vkCommandBuffer = cmdBuffer;
+  renderingEndInfo.colorAttachmentCount = 1;
+  renderingEndInfo.pColorImages = &swapchainImage;
+  renderingEndInfo.colorFinalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+
+  uvr_vk_rendering_begin(&renderingBeginInfo);
+  uvr_vk_dynamic_state_tracker_begin(&app->dyntracker, app->lgdev.dispatch, &app->dynstate, cmdBuffer);
+  uvr_vk_dynamic_state_tracker_bind_pipeline(&app->dyntracker, app->gpipeline.graphicsPipeline, app->dynstate.enabledFlags);
+  uvr_vk_dynamic_state_tracker_set_viewport(&app->dyntracker, &viewport);
+  uvr_vk_dynamic_state_tracker_set_scissor(&app->dyntracker, &renderArea);
+  app->lgdev.dispatch->CmdBindDescriptorSets(cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, app->gplayout.vkPipelineLayout, 0, 1,
+                                             &app->bindless.vkDescriptorSet, 0, NULL);
+  app->lgdev.dispatch->CmdPushConstants(cmdBuffer, app->gplayout.vkPipelineLayout, VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(uint32_t), &app->slots[0]);
+  app->lgdev.dispatch->CmdDraw(cmdBuffer, 6, QUAD_COUNT, 0, 0);
+  uvr_vk_rendering_end(&renderingEndInfo);
+
+  if (uvr_vk_command_buffer_record_end(&commandBufferRecordInfo) == -1)
+    return -1;
+
+  return 0;
+}
@@ -2,7 +2,9 @@
 #define UVR_UTILS_H
 
 #include <stdio.h>
+#include <stdbool.h>
 #include <inttypes.h>
+#include <pthread.h>
 
 #define UNUSED __attribute__((unused))
 #define ARRAY_LEN(_arr) (sizeof(_arr) / sizeof(_arr[0]))
@@ -19,6 +21,85 @@ enum uvr_utils_log_type {
 };
 
 int allocate_shm_file(size_t size);
+
+
+/* Opaque, queued work item of a struct uvr_utils_thread_pool */
+struct uvr_utils_thread_pool_job;
+
+
+/*
+ * struct uvr_utils_thread_pool (Underview Renderer Utils Thread Pool)
+ *
+ * members:
+ * @threadCount - Amount of worker threads in @threads
+ * @threads     - Pointer to an array of pthread_t worker handles
+ * @lock        - Guards every member bellow
+ * @jobCond     - Signaled when a job is queued or the pool is shutting down
+ * @idleCond    - Signaled when @pending drops to zero
+ * @head        - First job in the FIFO queue
+ * @tail        - Last job in the FIFO queue
+ * @pending     - Amount of jobs queued or currently executing
+ * @shutdown    - Set once uvr_utils_thread_pool_destroy(3) is called
+ */
+struct uvr_utils_thread_pool {
+  uint32_t                         threadCount;
+  pthread_t                        *threads;
+  pthread_mutex_t                  lock;
+  pthread_cond_t                   jobCond;
+  pthread_cond_t                   idleCond;
+  struct uvr_utils_thread_pool_job *head;
+  struct uvr_utils_thread_pool_job *tail;
+  uint32_t                         pending;
+  bool                             shutdown;
+};
+
+
+/*
+ * uvr_utils_thread_pool_create: Initializes @pool in place and spawns @threadCount worker threads.
+ *                               @pool must not be moved/copied while workers are running.
+ *
+ * args:
+ * @pool        - pointer to a struct uvr_utils_thread_pool
+ * @threadCount - Amount of worker threads to spawn
+ * return:
+ *    on success 0
+ *    on failure -1
+ */
+int uvr_utils_thread_pool_create(struct uvr_utils_thread_pool *pool, uint32_t threadCount);
+
+
+/*
+ * uvr_utils_thread_pool_submit: Queues @func to be executed with @arg on the next free worker thread.
+ *
+ * args:
+ * @pool - pointer to a struct uvr_utils_thread_pool
+ * @func - Function to execute
+ * @arg  - Argument passed to @func
+ * return:
+ *    on success 0
+ *    on failure -1
+ */
+int uvr_utils_thread_pool_submit(struct uvr_utils_thread_pool *pool, void (*func)(void *), void *arg);
+
+
+/*
+ * uvr_utils_thread_pool_wait: Blocks the calling thread until every submitted job has finished executing.
+ *
+ * args:
+ * @pool - pointer to a struct uvr_utils_thread_pool
+ */
+void uvr_utils_thread_pool_wait(struct uvr_utils_thread_pool *pool);
+
+
+/*
+ * uvr_utils_thread_pool_destroy: Waits for queued jobs to finish, joins all worker threads then frees resources.
+ *
+ * args:
+ * @pool - pointer to a struct uvr_utils_thread_pool
+ */
+void uvr_utils_thread_pool_destroy(struct uvr_utils_thread_pool *pool);
+
+
 void _uvr_utils_log(enum uvr_utils_log_type type, FILE *stream, const char *fmt, ...);
 const char *_uvr_utils_strip_path(const char *filepath);
 
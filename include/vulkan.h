@@ -36,6 +36,190 @@
   } while(0);
 
 
+/*
+ * Device-level entry points the renderer calls on its hot paths (command buffer
+ * recording, queue submission, presentation and CPU/GPU synchronization).
+ * Expanded via an X-macro to generate struct uvr_vk_device_dispatch and the code
+ * that populates it with vkGetDeviceProcAddr. Calling through the returned pointers
+ * skips the loader's per-call trampoline.
+ */
+#define UVR_VK_DEVICE_DISPATCH_FUNCS(X) \
+  X(BeginCommandBuffer) \
+  X(EndCommandBuffer) \
+  X(ResetCommandBuffer) \
+  X(CmdBindPipeline) \
+  X(CmdBindDescriptorSets) \
+  X(CmdBindVertexBuffers) \
+  X(CmdBindIndexBuffer) \
+  X(CmdPushConstants) \
+  X(CmdSetViewport) \
+  X(CmdSetScissor) \
+  X(CmdSetCullMode) \
+  X(CmdSetFrontFace) \
+  X(CmdSetPrimitiveTopology) \
+  X(CmdSetDepthTestEnable) \
+  X(CmdSetDepthWriteEnable) \
+  X(CmdSetDepthCompareOp) \
+  X(CmdDraw) \
+  X(CmdDrawIndexed) \
+  X(CmdDispatch) \
+  X(CmdDispatchBase) \
+  X(CmdPipelineBarrier) \
+  X(CmdCopyBuffer) \
+  X(CmdCopyBufferToImage) \
+  X(CmdCopyImageToBuffer) \
+  X(CmdBlitImage) \
+  X(CmdBeginRenderPass) \
+  X(CmdEndRenderPass) \
+  X(CmdBeginRendering) \
+  X(CmdEndRendering) \
+  X(CmdExecuteCommands) \
+  X(CmdResetQueryPool) \
+  X(CmdWriteTimestamp) \
+  X(CmdBeginQuery) \
+  X(CmdEndQuery) \
+  X(QueueSubmit) \
+  X(QueuePresentKHR) \
+  X(AcquireNextImageKHR) \
+  X(WaitForFences) \
+  X(ResetFences) \
+  X(GetFenceStatus) \
+  X(WaitSemaphores) \
+  X(SignalSemaphore) \
+  X(GetSemaphoreCounterValue)
+
+
+#ifdef INCLUDE_VULKAN_DLOPEN
+/*
+ * When built with -Dvulkan-loader=dlopen the library is compiled with VK_NO_PROTOTYPES
+ * and libvulkan.so.1 is opened at runtime by uvr_vk_instance_create(3). Every Vulkan
+ * function the library and examples call is then a global function pointer of the
+ * same name, resolved after the loader is opened (global), after the VkInstance is
+ * created (instance and device). Device-level pointers resolved this way are still
+ * loader trampolines, use uvr_vk_device_dispatch_get(3) on hot paths.
+ */
+#define UVR_VK_LOADER_GLOBAL_FUNCS(X) \
+  X(CreateInstance) \
+  X(EnumerateInstanceExtensionProperties) \
+  X(EnumerateInstanceLayerProperties)
+
+#ifdef INCLUDE_WAYLAND
+#define UVR_VK_LOADER_WAYLAND_FUNCS(X) X(CreateWaylandSurfaceKHR)
+#else
+#define UVR_VK_LOADER_WAYLAND_FUNCS(X)
+#endif
+
+#ifdef INCLUDE_XCB
+#define UVR_VK_LOADER_XCB_FUNCS(X) X(CreateXcbSurfaceKHR)
+#else
+#define UVR_VK_LOADER_XCB_FUNCS(X)
+#endif
+
+#define UVR_VK_LOADER_INSTANCE_FUNCS(X) \
+  X(DestroyInstance) \
+  X(EnumeratePhysicalDevices) \
+  X(EnumerateDeviceExtensionProperties) \
+  X(GetPhysicalDeviceProperties) \
+  X(GetPhysicalDeviceProperties2) \
+  X(GetPhysicalDeviceFeatures) \
+  X(GetPhysicalDeviceFeatures2) \
+  X(GetPhysicalDeviceFormatProperties) \
+  X(GetPhysicalDeviceMemoryProperties) \
+  X(GetPhysicalDeviceMemoryProperties2) \
+  X(GetPhysicalDeviceQueueFamilyProperties) \
+  X(GetPhysicalDeviceSurfaceCapabilitiesKHR) \
+  X(GetPhysicalDeviceSurfaceFormatsKHR) \
+  X(GetPhysicalDeviceSurfacePresentModesKHR) \
+  X(DestroySurfaceKHR) \
+  X(CreateDevice) \
+  X(GetDeviceProcAddr) \
+  UVR_VK_LOADER_WAYLAND_FUNCS(X) \
+  UVR_VK_LOADER_XCB_FUNCS(X)
+
+#define UVR_VK_LOADER_DEVICE_FUNCS(X) \
+  X(DestroyDevice) \
+  X(DeviceWaitIdle) \
+  X(GetDeviceQueue) \
+  X(CreateSwapchainKHR) \
+  X(DestroySwapchainKHR) \
+  X(GetSwapchainImagesKHR) \
+  X(AllocateMemory) \
+  X(FreeMemory) \
+  X(MapMemory) \
+  X(UnmapMemory) \
+  X(CreateBuffer) \
+  X(DestroyBuffer) \
+  X(GetBufferMemoryRequirements) \
+  X(BindBufferMemory) \
+  X(CreateImage) \
+  X(DestroyImage) \
+  X(GetImageMemoryRequirements) \
+  X(BindImageMemory) \
+  X(CreateImageView) \
+  X(DestroyImageView) \
+  X(CreateSampler) \
+  X(DestroySampler) \
+  X(CreateShaderModule) \
+  X(DestroyShaderModule) \
+  X(CreateRenderPass) \
+  X(DestroyRenderPass) \
+  X(CreateFramebuffer) \
+  X(DestroyFramebuffer) \
+  X(CreatePipelineLayout) \
+  X(DestroyPipelineLayout) \
+  X(CreatePipelineCache) \
+  X(DestroyPipelineCache) \
+  X(GetPipelineCacheData) \
+  X(MergePipelineCaches) \
+  X(CreateGraphicsPipelines) \
+  X(CreateComputePipelines) \
+  X(DestroyPipeline) \
+  X(CreateDescriptorSetLayout) \
+  X(DestroyDescriptorSetLayout) \
+  X(CreateDescriptorPool) \
+  X(DestroyDescriptorPool) \
+  X(ResetDescriptorPool) \
+  X(AllocateDescriptorSets) \
+  X(FreeDescriptorSets) \
+  X(UpdateDescriptorSets) \
+  X(CreateCommandPool) \
+  X(DestroyCommandPool) \
+  X(AllocateCommandBuffers) \
+  X(CreateFence) \
+  X(DestroyFence) \
+  X(CreateSemaphore) \
+  X(DestroySemaphore) \
+  X(CreateQueryPool) \
+  X(DestroyQueryPool) \
+  X(GetQueryPoolResults) \
+  UVR_VK_DEVICE_DISPATCH_FUNCS(X)
+
+#define UVR_VK_LOADER_DECLARE(func) extern PFN_vk##func vk##func;
+extern PFN_vkGetInstanceProcAddr vkGetInstanceProcAddr;
+UVR_VK_LOADER_GLOBAL_FUNCS(UVR_VK_LOADER_DECLARE)
+UVR_VK_LOADER_INSTANCE_FUNCS(UVR_VK_LOADER_DECLARE)
+UVR_VK_LOADER_DEVICE_FUNCS(UVR_VK_LOADER_DECLARE)
+#undef UVR_VK_LOADER_DECLARE
+#endif
+
+
+/*
+ * struct uvr_vk_device_dispatch (Underview Renderer Vulkan Device Dispatch)
+ *
+ * members:
+ * @vkDevice - VkDevice handle the function pointers were queried from. VK_NULL_HANDLE for the
+ *             fallback table which holds loader entry points usable with any VkDevice.
+ * @<func>   - One PFN_vk<func> member per entry in UVR_VK_DEVICE_DISPATCH_FUNCS (i.e. @CmdDraw
+ *             holds the driver's vkCmdDraw). Only call the members with objects owned by @vkDevice.
+ */
+struct uvr_vk_device_dispatch {
+  VkDevice vkDevice;
+#define UVR_VK_DEVICE_DISPATCH_MEMBER(func) PFN_vk##func func;
+  UVR_VK_DEVICE_DISPATCH_FUNCS(UVR_VK_DEVICE_DISPATCH_MEMBER)
+#undef UVR_VK_DEVICE_DISPATCH_MEMBER
+};
+
+
 /*
  * struct uvr_vk_instance_create_info (Underview Renderer Vulkan Instance Create Information)
  *
@@ -111,7 +295,8 @@ struct uvr_vk_surface_create_info {
 
 
 /*
- * uvr_vk_surface_create: Creates a VkSurfaceKHR object based upon platform specific information about the given surface
+ * uvr_vk_surface_create: Creates a VkSurfaceKHR object based upon platform specific information about the given surface.
+ *                        Rendering without a display server needs no surface, see uvr_vk_headless_target_create(3).
  *
  * args:
  * @uvrvk - pointer to a struct uvr_vk_surface_create_info
@@ -126,23 +311,93 @@ VkSurfaceKHR uvr_vk_surface_create(struct uvr_vk_surface_create_info *uvrvk);
  * struct uvr_vk_phdev_create_info (Underview Renderer Vulkan Physical Device Create Information)
  *
  * members:
- * @vkInst      - Must pass a valid VkInstance handle which to find VkPhysicalDevice with
- * @vkPhdevType - Must pass one of the supported VkPhysicalDeviceType's.
- *                https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkPhysicalDeviceType.html
- * @kmsFd       - Must pass a valid kms file descriptor for which a VkPhysicalDevice will be created
- *                if corresponding DRM properties match.
+ * @vkInst                  - Must pass a valid VkInstance handle which to find VkPhysicalDevice with
+ * @vkPhdevType             - Preferred VkPhysicalDeviceType. Weighs heaviest in a device's score but no longer
+ *                            excludes other types. Pass VK_PHYSICAL_DEVICE_TYPE_MAX_ENUM for no preference.
+ *                            Overridden at runtime by the UVR_VK_PHDEV_TYPE environment variable
+ *                            (discrete, integrated, virtual, cpu, other).
+ *                            https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkPhysicalDeviceType.html
+ * @enabledExtensionCount   - Amount of elements in @ppEnabledExtensionNames
+ * @ppEnabledExtensionNames - Device extensions a physical device must support to be selected
+ * @pRequiredFeatures       - Optional pointer to VkPhysicalDeviceFeatures a physical device must support to be
+ *                            selected. Every VK_TRUE member is required.
+ * @kmsFd                   - Must pass a valid kms file descriptor or -1. Physical devices whose DRM primary or
+ *                            render node matches the fd are ranked above every other device.
  */
 struct uvr_vk_phdev_create_info {
-  VkInstance           vkInst;
-  VkPhysicalDeviceType vkPhdevType;
+  VkInstance                     vkInst;
+  VkPhysicalDeviceType           vkPhdevType;
+  uint32_t                       enabledExtensionCount;
+  const char *const              *ppEnabledExtensionNames;
+  const VkPhysicalDeviceFeatures *pRequiredFeatures;
 #ifdef INCLUDE_KMS
-  int                  kmsFd;
+  int                            kmsFd;
 #endif
 };
 
 
 /*
- * uvr_vk_phdev_create: Creates a VkPhysicalDevice handle if certain characteristics of a physical device are meet
+ * struct uvr_vk_phdev_candidate (Underview Renderer Vulkan Physical Device Candidate)
+ *
+ * members:
+ * @vkPhdev           - VkPhysicalDevice handle
+ * @deviceName        - Name reported by the driver
+ * @deviceType        - VkPhysicalDeviceType of @vkPhdev
+ * @apiVersion        - Vulkan version supported by @vkPhdev
+ * @suitable          - false if a required extension or feature is missing. Unsuitable devices are never selected.
+ * @score             - Weighted sum of the criteria bellow. Higher is better.
+ * @deviceLocalBytes  - Size in bytes of the largest device local memory heap
+ * @dedicatedCompute  - true if a queue family supports compute but not graphics
+ * @dedicatedTransfer - true if a queue family supports transfer but neither graphics nor compute
+ * @drmMatch          - true if the device's DRM primary/render node matches struct uvr_vk_phdev_create_info { kmsFd }
+ * @reasons           - Human readable breakdown of @score and why a device is unsuitable
+ */
+struct uvr_vk_phdev_candidate {
+  VkPhysicalDevice     vkPhdev;
+  char                 deviceName[VK_MAX_PHYSICAL_DEVICE_NAME_SIZE];
+  VkPhysicalDeviceType deviceType;
+  uint32_t             apiVersion;
+  bool                 suitable;
+  uint64_t             score;
+  VkDeviceSize         deviceLocalBytes;
+  bool                 dedicatedCompute;
+  bool                 dedicatedTransfer;
+  bool                 drmMatch;
+  char                 reasons[512];
+};
+
+
+/*
+ * struct uvr_vk_phdev_ranking (Underview Renderer Vulkan Physical Device Ranking)
+ *
+ * members:
+ * @candidateCount - Amount of elements in @candidates
+ * @candidates     - Pointer to an array of every physical device sorted best first. Suitable devices always
+ *                   precede unsuitable ones. Caller must free(3).
+ */
+struct uvr_vk_phdev_ranking {
+  uint32_t                      candidateCount;
+  struct uvr_vk_phdev_candidate *candidates;
+};
+
+
+/*
+ * uvr_vk_phdev_rank: Scores every physical device on preferred type, largest device local heap, dedicated
+ *                    compute/transfer queue families and DRM node match. Devices missing a required extension
+ *                    or feature are marked unsuitable.
+ *
+ * args:
+ * @uvrvk - pointer to a struct uvr_vk_phdev_create_info
+ * return:
+ *    on success struct uvr_vk_phdev_ranking
+ *    on failure struct uvr_vk_phdev_ranking { with member nulled }
+ */
+struct uvr_vk_phdev_ranking uvr_vk_phdev_rank(struct uvr_vk_phdev_create_info *uvrvk);
+
+
+/*
+ * uvr_vk_phdev_create: Ranks physical devices via uvr_vk_phdev_rank(3), logs the ranking then selects the
+ *                      highest scoring suitable device.
  *
  * args:
  * @uvrvk - pointer to a struct uvr_vk_phdev_create_info
@@ -173,12 +428,18 @@ VkPhysicalDeviceFeatures uvr_vk_get_phdev_features(VkPhysicalDevice phdev);
  *                in uvr_vk_lgdev_create after VkDevice handle creation.
  * @familyIndex - VkQueue family index
  * @queueCount  - Count of queues in a given VkQueue family
+ * @queueIndex  - Index of the queue within @familyIndex to retrieve. Must be less than @queueCount.
+ * @priority    - Queue priority in the range [0.0, 1.0]. Higher priority queues may be given more processing time.
+ * @familyFlags - VkQueueFlags supported by @familyIndex
  */
 struct uvr_vk_queue {
-  char    name[20];
-  VkQueue vkQueue;
-  int     familyIndex;
-  int     queueCount;
+  char         name[20];
+  VkQueue      vkQueue;
+  int          familyIndex;
+  int          queueCount;
+  uint32_t     queueIndex;
+  float        priority;
+  VkQueueFlags familyFlags;
 };
 
 
@@ -187,17 +448,22 @@ struct uvr_vk_queue {
  *
  * members:
  * @phdev      - Must pass a valid VkPhysicalDevice handle
- * @queueFlags - Must pass one VkQueueFlagBits, if multiple flags are or'd function will fail to return VkQueue family index (struct uvr_vk_queue).
- *               https://www.khronos.org/registry/vulkan/specs/1.3-extensions/man/html/VkQueueFlagBits.html
+ * @queueFlags      - Must pass one VkQueueFlagBits, if multiple flags are or'd function will fail to return VkQueue family index (struct uvr_vk_queue).
+ *                    https://www.khronos.org/registry/vulkan/specs/1.3-extensions/man/html/VkQueueFlagBits.html
+ * @preferDedicated - If VK_TRUE out of all families supporting @queueFlag choose the one supporting the least amount of
+ *                    other graphics/compute/transfer capabilities. i.e. a transfer only family for VK_QUEUE_TRANSFER_BIT
+ *                    so uploads don't contend with graphics. If VK_FALSE the first family supporting @queueFlag is chosen.
  */
 struct uvr_vk_queue_create_info {
   VkPhysicalDevice vkPhdev;
   VkQueueFlags     queueFlag;
+  VkBool32         preferDedicated;
 };
 
 
 /*
  * uvr_vk_queue_create: Retrieves queue family index and queue count at said index given a single VkQueueFlagBits.
+ *                      Returned queue defaults to queue index 0 with a priority of 1.0.
  *
  * args:
  * @uvrvk - pointer to a struct uvr_vk_queue_create_info. Contains information on which queue family
@@ -209,6 +475,34 @@ struct uvr_vk_queue_create_info {
 struct uvr_vk_queue uvr_vk_queue_create(struct uvr_vk_queue_create_info *uvrvk);
 
 
+/*
+ * uvr_vk_queue_family_split: Populates @queues with up to @count queues of the family @queue belongs to. Each queue
+ *                            is assigned a distinct queue index so work submitted to them may execute concurrently.
+ *                            Pass populated array to struct uvr_vk_lgdev_create_info { member: queues }.
+ *
+ * args:
+ * @queue       - pointer to a struct uvr_vk_queue returned from uvr_vk_queue_create(3)
+ * @count       - Amount of queues requested. Clamped to @queue->queueCount.
+ * @pPriorities - Optional pointer to an array of @count priorities. If NULL every queue gets @queue->priority.
+ * @queues      - pointer to an array of at least @count struct uvr_vk_queue
+ * return:
+ *    Amount of queues populated
+ */
+uint32_t uvr_vk_queue_family_split(struct uvr_vk_queue *queue, uint32_t count, const float *pPriorities, struct uvr_vk_queue *queues);
+
+
+/*
+ * uvr_vk_queue_overlap_report: Logs, for every pair of queues, whether work submitted to them can overlap.
+ *                              Distinct families run asynchronously, distinct queues of the same family may
+ *                              overlap, the same queue index is fully serialized.
+ *
+ * args:
+ * @queueCount - Amount of elements in @queues
+ * @queues     - pointer to an array of struct uvr_vk_queue
+ */
+void uvr_vk_queue_overlap_report(uint32_t queueCount, struct uvr_vk_queue *queues);
+
+
 /*
  * struct uvr_vk_lgdev (Underview Renderer Vulkan Logical Device)
  *
@@ -220,11 +514,14 @@ struct uvr_vk_queue uvr_vk_queue_create(struct uvr_vk_queue_create_info *uvrvk);
  *               data pass through struct uvr_vk_lgdev_create_info { member: queues }
  *
  *               @queueCount & @queues are strictly for struct uvr_vk_lgdev to have extra information amount VkQueue's
+ * @dispatch   - Device function table populated with vkGetDeviceProcAddr. Owned by the library and
+ *               released when @vkDevice is destroyed via uvr_vk_destory(3).
  */
 struct uvr_vk_lgdev {
-  VkDevice            vkDevice;
-  uint32_t            queueCount;
-  struct uvr_vk_queue *queues;
+  VkDevice                            vkDevice;
+  uint32_t                            queueCount;
+  struct uvr_vk_queue                 *queues;
+  const struct uvr_vk_device_dispatch *dispatch;
 };
 
 
@@ -232,20 +529,32 @@ struct uvr_vk_lgdev {
  * struct uvr_vk_lgdev_create_info (Underview Renderer Vulkan Logical Device Create Information)
  *
  * members:
- * @vkInst                  - Must pass a valid VkInstance handle to create VkDevice handle from.
- * @vkPhdev                 - Must pass a valid VkPhysicalDevice handle to associate VkDevice handle with.
- * @pEnabledFeatures        - Must pass a valid pointer to a VkPhysicalDeviceFeatures with X features enabled
- * @enabledExtensionCount   - Must pass the amount of Vulkan Device extensions to enable.
- * @ppEnabledExtensionNames - Must pass an array of strings containing Vulkan Device extension to enable.
- * @queueCount              - Must pass the amount of struct uvr_vk_queue (VkQueue,VkQueueFamily indicies) to
- *                            create along with a given logical device
- * @queues                  - Must pass a pointer to an array of struct uvr_vk_queue (VkQueue,VkQueueFamily indicies) to
- *                            create along with a given logical device
+ * @vkInst                   - Must pass a valid VkInstance handle to create VkDevice handle from.
+ * @vkPhdev                  - Must pass a valid VkPhysicalDevice handle to associate VkDevice handle with.
+ * @pNext                    - Optional pointer to a chain of feature structures (VkPhysicalDeviceVulkan12Features,
+ *                             VkPhysicalDeviceVulkan13Features, ...) passed to VkDeviceCreateInfo { member: pNext }.
+ *                             i.e. VkPhysicalDeviceVulkan12Features { member: timelineSemaphore } must be enabled
+ *                             to create timeline semaphores. May be NULL.
+ * @pEnabledFeatures         - Must pass a valid pointer to a VkPhysicalDeviceFeatures with X features enabled
+ * @enableDescriptorIndexing - If VK_TRUE enables the descriptor indexing features required by struct uvr_vk_bindless_table
+ *                             (runtime sized, partially bound, update after bind, non-uniformly indexed sampled image arrays).
+ *                             Fails if the physical device doesn't support them. A VkPhysicalDeviceVulkan12Features
+ *                             or VkPhysicalDeviceDescriptorIndexingFeatures already in @pNext is modified in place
+ *                             to enable them, otherwise a VkPhysicalDeviceDescriptorIndexingFeatures is chained.
+ * @enabledExtensionCount    - Must pass the amount of Vulkan Device extensions to enable.
+ * @ppEnabledExtensionNames  - Must pass an array of strings containing Vulkan Device extension to enable.
+ * @queueCount               - Must pass the amount of struct uvr_vk_queue (VkQueue,VkQueueFamily indicies) to
+ *                             create along with a given logical device
+ * @queues                   - Must pass a pointer to an array of struct uvr_vk_queue (VkQueue,VkQueueFamily indicies) to
+ *                             create along with a given logical device. Queues sharing a family are grouped into one
+ *                             VkDeviceQueueCreateInfo, each retrieves its own @queueIndex with its own @priority.
  */
 struct uvr_vk_lgdev_create_info {
   VkInstance               vkInst;
   VkPhysicalDevice         vkPhdev;
+  const void               *pNext;
   VkPhysicalDeviceFeatures *pEnabledFeatures;
+  VkBool32                 enableDescriptorIndexing;
   uint32_t                 enabledExtensionCount;
   const char *const        *ppEnabledExtensionNames;
   uint32_t                 queueCount;
@@ -275,6 +584,21 @@ struct uvr_vk_lgdev_create_info {
 struct uvr_vk_lgdev uvr_vk_lgdev_create(struct uvr_vk_lgdev_create_info *uvrvk);
 
 
+/*
+ * uvr_vk_device_dispatch_get: Returns the device function table populated by uvr_vk_lgdev_create(3) for @vkDevice.
+ *                             Objects that record or submit work on a hot path cache the returned pointer at creation.
+ *                             If @vkDevice is VK_NULL_HANDLE and exactly one logical device is alive its table is
+ *                             returned. Otherwise (unknown device or several devices) a table holding loader entry points
+ *                             valid for any device is returned.
+ *
+ * args:
+ * @vkDevice - VkDevice handle returned from uvr_vk_lgdev_create(3) or VK_NULL_HANDLE
+ * return:
+ *    pointer to a struct uvr_vk_device_dispatch (never NULL)
+ */
+const struct uvr_vk_device_dispatch *uvr_vk_device_dispatch_get(VkDevice vkDevice);
+
+
 /*
  * uvr_vk_get_surface_capabilities: Populates the VkSurfaceCapabilitiesKHR struct with supported GPU device surface capabilities.
  *
@@ -347,12 +671,16 @@ struct uvr_vk_surface_present_mode uvr_vk_get_surface_present_modes(VkPhysicalDe
  * struct uvr_vk_swapchain (Underview Renderer Vulkan Swapchain)
  *
  * members:
- * @vkDevice    - Logical device used when swapchain was created
- * @vkSwapchain - Vulkan handle/object representing the swapchain itself
+ * @vkDevice      - Logical device used when swapchain was created
+ * @vkSwapchain   - Vulkan handle/object representing the swapchain itself
+ * @extent2D      - Extent images in the swapchain were created with
+ * @surfaceFormat - Pixel format & colorSpace images in the swapchain were created with
  */
 struct uvr_vk_swapchain {
-  VkDevice       vkDevice;
-  VkSwapchainKHR vkSwapchain;
+  VkDevice           vkDevice;
+  VkSwapchainKHR     vkSwapchain;
+  VkExtent2D         extent2D;
+  VkSurfaceFormatKHR surfaceFormat;
 };
 
 
@@ -408,6 +736,278 @@ struct uvr_vk_swapchain_create_info {
 struct uvr_vk_swapchain uvr_vk_swapchain_create(struct uvr_vk_swapchain_create_info *uvrvk);
 
 
+/*
+ * enum uvr_vk_allocation_mode (Underview Renderer Vulkan Allocation Mode)
+ *
+ * Strategies struct uvr_vk_allocator uses to hand out ranges of VkDeviceMemory.
+ *
+ * UVR_VK_ALLOCATION_BUDDY     - Range is sub-allocated from a large per memory type block with a buddy allocator.
+ *                               Ranges are returned to the block via uvr_vk_allocator_free(3).
+ * UVR_VK_ALLOCATION_LINEAR    - Range is bump allocated from a large per memory type block. Ranges are never freed
+ *                               individually, all linear blocks are recycled at once via uvr_vk_allocator_reset_linear(3).
+ *                               Intended for per-frame data.
+ * UVR_VK_ALLOCATION_DEDICATED - Range gets its own VkDeviceMemory object. Automatically used for requests larger
+ *                               than half of struct uvr_vk_allocator { member: blockSize }.
+ */
+typedef enum uvr_vk_allocation_mode {
+  UVR_VK_ALLOCATION_BUDDY     = 0,
+  UVR_VK_ALLOCATION_LINEAR    = 1,
+  UVR_VK_ALLOCATION_DEDICATED = 2,
+} uvr_vk_allocation_mode;
+
+
+/*
+ * struct uvr_vk_allocator_block (Underview Renderer Vulkan Allocator Block)
+ *
+ * Opaque structure representing one VkDeviceMemory object owned by struct uvr_vk_allocator
+ */
+struct uvr_vk_allocator_block;
+
+
+/*
+ * struct uvr_vk_allocator (Underview Renderer Vulkan Allocator)
+ *
+ * Never copy or move a struct uvr_vk_allocator once created. Buffers, images and headless targets keep a
+ * pointer to it, and a copy would share @blocks with the original so the two go out of sync on the next
+ * block allocation or free. Assign the return value of uvr_vk_allocator_create(3) to its final location
+ * and pass pointers to it around.
+ *
+ * members:
+ * @vkDevice                - Logical device used to allocate VkDeviceMemory objects
+ * @vkMemoryProperties      - Memory types and heaps supported by the physical device the allocator was created with
+ * @blockSize               - Size in bytes of each VkDeviceMemory block sub-allocations are carved from
+ * @maxMemoryAllocationCount - VkPhysicalDeviceLimits::maxMemoryAllocationCount of the physical device
+ * @blockCount              - Amount of elements in @blocks array
+ * @blocks                  - Pointer to an array of pointers to blocks (including dedicated allocations)
+ * @vkAllocateMemoryCount   - Amount of times vkAllocateMemory was called during the allocators lifetime
+ * @allocationCount         - Amount of live sub-allocations (linear allocations included until reset)
+ */
+struct uvr_vk_allocator {
+  VkDevice                         vkDevice;
+  VkPhysicalDeviceMemoryProperties vkMemoryProperties;
+  VkDeviceSize                     blockSize;
+  uint32_t                         maxMemoryAllocationCount;
+  uint32_t                         blockCount;
+  struct uvr_vk_allocator_block    **blocks;
+  uint64_t                         vkAllocateMemoryCount;
+  uint64_t                         allocationCount;
+};
+
+
+/*
+ * struct uvr_vk_allocator_create_info (Underview Renderer Vulkan Allocator Create Information)
+ *
+ * members:
+ * @vkPhdev   - Must pass a valid VkPhysicalDevice handle to query memory types/heaps from
+ * @vkDevice  - Must pass a valid active logical device
+ * @blockSize - Size in bytes of each VkDeviceMemory block. Rounded up to a power of two.
+ *              If zero a default of 64MiB is used.
+ */
+struct uvr_vk_allocator_create_info {
+  VkPhysicalDevice vkPhdev;
+  VkDevice         vkDevice;
+  VkDeviceSize     blockSize;
+};
+
+
+/*
+ * uvr_vk_allocator_create: Creates a device memory sub-allocator. Instead of calling vkAllocateMemory once per
+ *                          resource the allocator allocates large per memory type blocks and hands out ranges of
+ *                          them. Blocks holding buffers/linear images are kept separate from blocks holding optimal
+ *                          tiling images so bufferImageGranularity never has to be padded for. Host visible blocks
+ *                          stay persistently mapped. Allocator isn't thread safe, access must be externally synchronized.
+ *                          Address of the returned struct is stored in struct uvr_vk_buffer/uvr_vk_image so it
+ *                          must never be copied or moved after it's assigned (see struct uvr_vk_allocator).
+ *
+ * args:
+ * @uvrvk - pointer to a struct uvr_vk_allocator_create_info
+ * return:
+ *    on success struct uvr_vk_allocator
+ *    on failure struct uvr_vk_allocator { with member nulled }
+ */
+struct uvr_vk_allocator uvr_vk_allocator_create(struct uvr_vk_allocator_create_info *uvrvk);
+
+
+/*
+ * struct uvr_vk_allocation (Underview Renderer Vulkan Allocation)
+ *
+ * members:
+ * @vkDeviceMemory  - VkDeviceMemory object the range lives in. Pass to vkBind{Buffer,Image}Memory.
+ * @offset          - Offset in bytes of the range inside @vkDeviceMemory
+ * @size            - Size in bytes of the range. May be larger than the requested size.
+ * @requestedSize   - Size in bytes the caller asked for
+ * @pMapped         - Host address of the range if allocated from host visible memory, NULL otherwise
+ * @memoryTypeIndex - Index of the memory type the range was allocated from
+ * @mode            - Strategy used to allocate the range
+ * @block           - Block the range was carved from
+ */
+struct uvr_vk_allocation {
+  VkDeviceMemory                vkDeviceMemory;
+  VkDeviceSize                  offset;
+  VkDeviceSize                  size;
+  VkDeviceSize                  requestedSize;
+  void                          *pMapped;
+  uint32_t                      memoryTypeIndex;
+  uvr_vk_allocation_mode        mode;
+  struct uvr_vk_allocator_block *block;
+};
+
+
+/*
+ * struct uvr_vk_allocator_alloc_info (Underview Renderer Vulkan Allocator Allocate Information)
+ *
+ * members:
+ * @allocator           - Must pass a pointer to a valid struct uvr_vk_allocator
+ * @memoryRequirements  - Must pass the VkMemoryRequirements of the resource the range is for
+ * @memoryPropertyFlags - Must pass the VkMemoryPropertyFlags the chosen memory type must have
+ * @mode                - Allocation strategy to use
+ * @optimalTiling       - Must pass VK_TRUE if range is for a VK_IMAGE_TILING_OPTIMAL image
+ * @requestedSize       - Size the caller actually needs (for statistics). If zero @memoryRequirements.size is used.
+ */
+struct uvr_vk_allocator_alloc_info {
+  struct uvr_vk_allocator *allocator;
+  VkMemoryRequirements    memoryRequirements;
+  VkMemoryPropertyFlags   memoryPropertyFlags;
+  uvr_vk_allocation_mode  mode;
+  VkBool32                optimalTiling;
+  VkDeviceSize            requestedSize;
+};
+
+
+/*
+ * uvr_vk_allocator_alloc: Sub-allocates a range of VkDeviceMemory that satisfies the size, alignment and memory
+ *                         type bits of the passed VkMemoryRequirements. A new block is only allocated if no
+ *                         existing block has room.
+ *
+ * args:
+ * @uvrvk - pointer to a struct uvr_vk_allocator_alloc_info
+ * return:
+ *    on success struct uvr_vk_allocation
+ *    on failure struct uvr_vk_allocation { with member nulled }
+ */
+struct uvr_vk_allocation uvr_vk_allocator_alloc(struct uvr_vk_allocator_alloc_info *uvrvk);
+
+
+/*
+ * uvr_vk_allocator_free: Returns a range to the block it was allocated from. Linear ranges are ignored as they
+ *                        are reclaimed by uvr_vk_allocator_reset_linear(3). Dedicated allocations are freed.
+ *                        Empty buddy blocks are released if another block of the same kind exists.
+ *
+ * args:
+ * @allocator  - pointer to the struct uvr_vk_allocator @allocation was allocated from
+ * @allocation - pointer to a struct uvr_vk_allocation { members nulled after call }
+ */
+void uvr_vk_allocator_free(struct uvr_vk_allocator *allocator, struct uvr_vk_allocation *allocation);
+
+
+/*
+ * uvr_vk_allocator_reset_linear: Rewinds every linear block to offset zero. All ranges allocated with
+ *                                UVR_VK_ALLOCATION_LINEAR become invalid. Caller must ensure GPU
+ *                                no longer accesses them (i.e. frame fence signaled).
+ *
+ * args:
+ * @allocator - pointer to a struct uvr_vk_allocator
+ */
+void uvr_vk_allocator_reset_linear(struct uvr_vk_allocator *allocator);
+
+
+/*
+ * struct uvr_vk_allocator_stats (Underview Renderer Vulkan Allocator Statistics)
+ *
+ * members:
+ * @blockCount            - Amount of VkDeviceMemory blocks (dedicated included) currently owned by the allocator
+ * @dedicatedCount        - Amount of dedicated allocations
+ * @allocationCount       - Amount of live sub-allocations
+ * @vkAllocateMemoryCount - Amount of times vkAllocateMemory was called during the allocators lifetime
+ * @reservedBytes         - Sum of the sizes of all VkDeviceMemory objects owned by the allocator
+ * @usedBytes             - Bytes handed out to callers (after alignment/rounding)
+ * @requestedBytes        - Bytes callers asked for. (@usedBytes - @requestedBytes) is internal fragmentation.
+ * @largestFreeRange      - Largest single range that can be sub-allocated without allocating a new block
+ * @fragmentation         - External fragmentation of free space [0,1]. 1 - (@largestFreeRange / free bytes)
+ * @heapUsage             - Bytes reserved from each memory heap
+ */
+struct uvr_vk_allocator_stats {
+  uint32_t     blockCount;
+  uint32_t     dedicatedCount;
+  uint64_t     allocationCount;
+  uint64_t     vkAllocateMemoryCount;
+  VkDeviceSize reservedBytes;
+  VkDeviceSize usedBytes;
+  VkDeviceSize requestedBytes;
+  VkDeviceSize largestFreeRange;
+  float        fragmentation;
+  VkDeviceSize heapUsage[VK_MAX_MEMORY_HEAPS];
+};
+
+
+/*
+ * uvr_vk_allocator_get_stats: Walks all blocks owned by the allocator and reports usage and fragmentation statistics
+ *
+ * args:
+ * @allocator - pointer to a struct uvr_vk_allocator
+ * return:
+ *    populated struct uvr_vk_allocator_stats
+ */
+struct uvr_vk_allocator_stats uvr_vk_allocator_get_stats(struct uvr_vk_allocator *allocator);
+
+
+/*
+ * struct uvr_vk_buffer (Underview Renderer Vulkan Buffer)
+ *
+ * members:
+ * @vkDevice   - Logical device used when buffer was created
+ * @vkBuffer   - Vulkan handle/object representing the buffer itself
+ * @allocation - Range of device memory bound to @vkBuffer
+ * @allocator  - Allocator @allocation belongs to
+ */
+struct uvr_vk_buffer {
+  VkDevice                 vkDevice;
+  VkBuffer                 vkBuffer;
+  struct uvr_vk_allocation allocation;
+  struct uvr_vk_allocator  *allocator;
+};
+
+
+/*
+ * struct uvr_vk_buffer_create_info (Underview Renderer Vulkan Buffer Create Information)
+ *
+ * members:
+ * @allocator           - Must pass a pointer to a valid struct uvr_vk_allocator
+ * @memoryPropertyFlags - Must pass the VkMemoryPropertyFlags memory backing buffer must have
+ * @mode                - Allocation strategy used for backing memory
+ * See: https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkBufferCreateInfo.html for bellow members
+ * @bufferFlags
+ * @bufferSize
+ * @bufferUsage
+ * @bufferSharingMode
+ * @queueFamilyIndexCount
+ * @pQueueFamilyIndices
+ */
+struct uvr_vk_buffer_create_info {
+  struct uvr_vk_allocator *allocator;
+  VkMemoryPropertyFlags   memoryPropertyFlags;
+  uvr_vk_allocation_mode  mode;
+  VkBufferCreateFlags     bufferFlags;
+  VkDeviceSize            bufferSize;
+  VkBufferUsageFlags      bufferUsage;
+  VkSharingMode           bufferSharingMode;
+  uint32_t                queueFamilyIndexCount;
+  const uint32_t          *pQueueFamilyIndices;
+};
+
+
+/*
+ * uvr_vk_buffer_create: Creates a VkBuffer and binds it to a range of device memory sub-allocated from @allocator
+ *
+ * args:
+ * @uvrvk - pointer to a struct uvr_vk_buffer_create_info
+ * return:
+ *    on success struct uvr_vk_buffer
+ *    on failure struct uvr_vk_buffer { with member nulled }
+ */
+struct uvr_vk_buffer uvr_vk_buffer_create(struct uvr_vk_buffer_create_info *uvrvk);
+
+
 /*
  * struct uvr_vk_image_handle (Underview Renderer Vulkan Image Handle)
  *
@@ -440,6 +1040,9 @@ struct uvr_vk_image_view_handle {
  * @vkSwapchain  - Member not required, but used for storage purposes. A valid VkSwapchainKHR
  *                 reference to the VkSwapchainKHR passed to uvr_vk_image_create. Represents
  *                 the swapchain that created VkImage's.
+ * @allocations  - Pointer to an array of device memory ranges bound to @vkImages. Only set by uvr_vk_image_create2(3),
+ *                 NULL for swapchain images as the swapchain owns their memory.
+ * @allocator    - Allocator @allocations belong to
  */
 struct uvr_vk_image {
   VkDevice                         vkDevice;
@@ -447,6 +1050,8 @@ struct uvr_vk_image {
   struct uvr_vk_image_handle       *vkImages;
   struct uvr_vk_image_view_handle  *vkImageViews;
   VkSwapchainKHR                   vkSwapchain;
+  struct uvr_vk_allocation         *allocations;
+  struct uvr_vk_allocator          *allocator;
 };
 
 
@@ -491,6 +1096,73 @@ struct uvr_vk_image_create_info {
 struct uvr_vk_image uvr_vk_image_create(struct uvr_vk_image_create_info *uvrvk);
 
 
+/*
+ * struct uvr_vk_image_create2_info (Underview Renderer Vulkan Image Create Information 2)
+ *
+ * members:
+ * @allocator           - Must pass a pointer to a valid struct uvr_vk_allocator
+ * @memoryPropertyFlags - Must pass the VkMemoryPropertyFlags memory backing images must have
+ * @mode                - Allocation strategy used for backing memory
+ * @imageCount          - Amount of VkImage/VkImageView's to create
+ * See: https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkImageCreateInfo.html for bellow members
+ * @imageFlags
+ * @imageType
+ * @imageFormat
+ * @imageExtent3D
+ * @imageMipLevels
+ * @imageArrayLayers
+ * @imageSamples
+ * @imageTiling
+ * @imageUsage
+ * @imageSharingMode
+ * @queueFamilyIndexCount
+ * @pQueueFamilyIndices
+ * @imageInitialLayout
+ * See: https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkImageViewCreateInfo.html for bellow members
+ * @imageViewFlags
+ * @imageViewType
+ * @imageViewComponents
+ * @imageViewSubresourceRange
+ */
+struct uvr_vk_image_create2_info {
+  struct uvr_vk_allocator *allocator;
+  VkMemoryPropertyFlags   memoryPropertyFlags;
+  uvr_vk_allocation_mode  mode;
+  uint32_t                imageCount;
+  VkImageCreateFlags      imageFlags;
+  VkImageType             imageType;
+  VkFormat                imageFormat;
+  VkExtent3D              imageExtent3D;
+  uint32_t                imageMipLevels;
+  uint32_t                imageArrayLayers;
+  VkSampleCountFlagBits   imageSamples;
+  VkImageTiling           imageTiling;
+  VkImageUsageFlags       imageUsage;
+  VkSharingMode           imageSharingMode;
+  uint32_t                queueFamilyIndexCount;
+  const uint32_t          *pQueueFamilyIndices;
+  VkImageLayout           imageInitialLayout;
+  VkImageViewCreateFlags  imageViewFlags;
+  VkImageViewType         imageViewType;
+  VkComponentMapping      imageViewComponents;
+  VkImageSubresourceRange imageViewSubresourceRange;
+};
+
+
+/*
+ * uvr_vk_image_create2: Function creates @imageCount VkImage's, binds each one to a range of device memory
+ *                       sub-allocated from @allocator and associates a VkImageView with each image.
+ *                       Unlike uvr_vk_image_create(3) images aren't tied to a swapchain.
+ *
+ * args:
+ * @uvrvk - pointer to a struct uvr_vk_image_create2_info
+ * return:
+ *    on success struct uvr_vk_image
+ *    on failure struct uvr_vk_image { with member nulled }
+ */
+struct uvr_vk_image uvr_vk_image_create2(struct uvr_vk_image_create2_info *uvrvk);
+
+
 /*
  * struct uvr_vk_shader_module (Underview Renderer Vulkan Shader Module)
  *
@@ -636,6 +1308,79 @@ struct uvr_vk_render_pass_create_info {
 struct uvr_vk_render_pass uvr_vk_render_pass_create(struct uvr_vk_render_pass_create_info *uvrvk);
 
 
+/*
+ * struct uvr_vk_pipeline_cache (Underview Renderer Vulkan Pipeline Cache)
+ *
+ * members:
+ * @vkDevice          - Logical device used when creating VkPipelineCache handle
+ * @vkPipelineCache   - Handle to a pipeline cache object. Pass to struct uvr_vk_graphics_pipeline_create_info
+ * @filePath          - Path of the on-disk blob the cache was loaded from and is written back to. May be NULL
+ *                      in which case the cache only lives in memory.
+ * @vendorID          - VkPhysicalDeviceProperties::vendorID the blob is keyed with
+ * @deviceID          - VkPhysicalDeviceProperties::deviceID the blob is keyed with
+ * @driverVersion     - VkPhysicalDeviceProperties::driverVersion the blob is keyed with
+ * @pipelineCacheUUID - VkPhysicalDeviceProperties::pipelineCacheUUID the blob is keyed with
+ * @loadedSize        - Size in bytes of the blob the cache was seeded with. Zero on a cold start.
+ */
+struct uvr_vk_pipeline_cache {
+  VkDevice        vkDevice;
+  VkPipelineCache vkPipelineCache;
+  const char      *filePath;
+  uint32_t        vendorID;
+  uint32_t        deviceID;
+  uint32_t        driverVersion;
+  uint8_t         pipelineCacheUUID[VK_UUID_SIZE];
+  size_t          loadedSize;
+};
+
+
+/*
+ * struct uvr_vk_pipeline_cache_create_info (Underview Renderer Vulkan Pipeline Cache Create Information)
+ *
+ * members:
+ * @vkPhdev  - Must pass a valid VkPhysicalDevice handle. Used to key the on-disk blob.
+ * @vkDevice - Must pass a valid active logical device
+ * @filePath - Path to load the on-disk blob from. File need not exist. NULL for an in memory only cache.
+ *             String must stay valid for the lifetime of the cache.
+ */
+struct uvr_vk_pipeline_cache_create_info {
+  VkPhysicalDevice vkPhdev;
+  VkDevice         vkDevice;
+  const char       *filePath;
+};
+
+
+/*
+ * uvr_vk_pipeline_cache_create: Function creates a VkPipelineCache handle. If @filePath exists and the blob stored
+ *                               in it was written for the same pipelineCacheUUID, vendorID, deviceID and driver
+ *                               version and passes its checksum the cache is seeded with it. Stale or corrupt
+ *                               blobs are ignored and an empty cache is created.
+ *
+ * args:
+ * @uvrvk - pointer to a struct uvr_vk_pipeline_cache_create_info
+ * return:
+ *    on success struct uvr_vk_pipeline_cache
+ *    on failure struct uvr_vk_pipeline_cache { with member nulled }
+ */
+struct uvr_vk_pipeline_cache uvr_vk_pipeline_cache_create(struct uvr_vk_pipeline_cache_create_info *uvrvk);
+
+
+/*
+ * uvr_vk_pipeline_cache_store: Retrieves the contents of the VkPipelineCache and atomically writes them to @filePath.
+ *                              Blob is written to a temporary file in the same directory, synced to disk then renamed
+ *                              over @filePath so readers never observe a partially written blob. The directory is
+ *                              synced after the rename so the new blob survives a crash. Called automatically
+ *                              by uvr_vk_destory(3).
+ *
+ * args:
+ * @uvrvk - pointer to a struct uvr_vk_pipeline_cache
+ * return:
+ *    on success 0
+ *    on failure -1
+ */
+int uvr_vk_pipeline_cache_store(struct uvr_vk_pipeline_cache *uvrvk);
+
+
 /*
  * struct uvr_vk_graphics_pipeline (Underview Renderer Vulkan Graphics Pipeline)
  *
@@ -669,6 +1414,11 @@ struct uvr_vk_graphics_pipeline {
  * @layout
  * @renderPass
  * @subpass
+ * @vkPipelineCache - Optional VkPipelineCache handle (struct uvr_vk_pipeline_cache { member: vkPipelineCache })
+ *                    used to speed up pipeline creation. May be VK_NULL_HANDLE.
+ * @pRenderingInfo  - Optional attachment formats for dynamic rendering (uvr_vk_rendering_begin(3)). If not NULL
+ *                    @renderPass must be VK_NULL_HANDLE and the logical device must be created with
+ *                    VkPhysicalDeviceVulkan13Features { member: dynamicRendering } enabled.
  */
 struct uvr_vk_graphics_pipeline_create_info {
   VkDevice                                      vkDevice;
@@ -686,6 +1436,8 @@ struct uvr_vk_graphics_pipeline_create_info {
   VkPipelineLayout                              vkPipelineLayout;
   VkRenderPass                                  renderPass;
   uint32_t                                      subpass;
+  VkPipelineCache                               vkPipelineCache;
+  const VkPipelineRenderingCreateInfo           *pRenderingInfo;
 };
 
 
@@ -706,47 +1458,807 @@ struct uvr_vk_graphics_pipeline uvr_vk_graphics_pipeline_create(struct uvr_vk_gr
 
 
 /*
- * struct uvr_vk_framebuffer_handle (Underview Renderer Vulkan Framebuffer Handle)
+ * struct uvr_vk_graphics_pipeline_batch_info (Underview Renderer Vulkan Graphics Pipeline Batch Information)
  *
- * @fb - Framebuffers represent a collection of specific memory attachments that a render pass instance uses.
+ * members:
+ * @vkDevice      - Must pass a valid active logical device. Every element of @pCreateInfos must use it.
+ * @pipelineCount - Amount of elements in @pCreateInfos and @pPipelines
+ * @pCreateInfos  - Pointer to an array of pipeline descriptions
+ * @pPipelines    - Pointer to an array populated with the created pipelines. Failed elements are nulled.
+ * @threadCount   - Amount of worker threads compiling pipelines. If zero @threadPool's thread count is used,
+ *                  without @threadPool one per online CPU.
+ * @threadPool    - Optional caller owned struct uvr_utils_thread_pool workers are queued on. Lets repeated batches
+ *                  reuse threads, as struct uvr_vk_command_recorder does. The call waits for every job queued on it,
+ *                  so it must not be called from one of its workers. If NULL a transient pool of @threadCount threads
+ *                  is spawned and joined per call.
+ * @pipelineCache - Optional shared cache. If set every worker compiles against a private externally synchronized
+ *                  VkPipelineCache seeded with its contents, worker caches are merged back into it once the batch
+ *                  completes. struct uvr_vk_graphics_pipeline_create_info { member: vkPipelineCache } is ignored.
+ *                  If NULL each description's own vkPipelineCache is used as is.
  */
-struct uvr_vk_framebuffer_handle {
-  VkFramebuffer fb;
+struct uvr_vk_graphics_pipeline_batch_info {
+  VkDevice                                          vkDevice;
+  uint32_t                                          pipelineCount;
+  const struct uvr_vk_graphics_pipeline_create_info *pCreateInfos;
+  struct uvr_vk_graphics_pipeline                   *pPipelines;
+  uint32_t                                          threadCount;
+  struct uvr_utils_thread_pool                      *threadPool;
+  struct uvr_vk_pipeline_cache                      *pipelineCache;
 };
 
 
 /*
- * struct uvr_vk_framebuffer (Underview Renderer Vulkan Framebuffer)
+ * struct uvr_vk_graphics_pipeline_batch_stats (Underview Renderer Vulkan Graphics Pipeline Batch Statistics)
  *
  * members:
- * @vkDevice         - Logical device used when VkFramebuffer handle was created.
- * @frameBufferCount - Amount of VkFramebuffer handles created
- * @vkFrameBuffers   - Pointer to an array of VkFramebuffer handles
+ * @createdCount - Amount of pipelines successfully created
+ * @failedCount  - Amount of pipelines that failed to compile
+ * @threadCount  - Amount of worker threads used
+ * @wallMs       - Milliseconds from the first submission until every worker finished, cache merge included
+ * @compileMs    - Sum of the milliseconds each vkCreateGraphicsPipelines call took
+ * @speedup      - @compileMs divided by @wallMs. Ideally close to @threadCount.
  */
-struct uvr_vk_framebuffer {
-  VkDevice                          vkDevice;
-  uint32_t                          frameBufferCount;
-  struct uvr_vk_framebuffer_handle  *vkFrameBuffers;
+struct uvr_vk_graphics_pipeline_batch_stats {
+  uint32_t createdCount;
+  uint32_t failedCount;
+  uint32_t threadCount;
+  double   wallMs;
+  double   compileMs;
+  double   speedup;
 };
 
 
 /*
- * struct uvr_vk_framebuffer_create_info (Underview Renderer Vulkan Framebuffer Create Information)
+ * uvr_vk_graphics_pipeline_create_batch: Compiles @pipelineCount graphics pipelines in parallel. Workers pull descriptions
+ *                                        off a shared counter so long compiles don't stall the others. Returned
+ *                                        statistics allow comparing startup time across thread counts.
  *
- * members:
- * @vkDevice         - Must pass a valid active logical device
- * @frameBufferCount - Amount of VkFramebuffer handles to create
- * @vkImageViews     - Pointer to an array of VkImageView handles which will be used in a render pass instance.
- * @renderPass       - Defines the render pass a given framebuffer is compatible with
- * @width            - Framebuffer width in pixels
- * @height           - Framebuffer height in pixels
- * See: https://www.khronos.org/registry/vulkan/specs/1.3-extensions/man/html/VkFramebufferCreateInfo.html for bellow members
- * @layers
+ * args:
+ * @uvrvk - pointer to a struct uvr_vk_graphics_pipeline_batch_info
+ * return:
+ *    populated struct uvr_vk_graphics_pipeline_batch_stats
  */
-struct uvr_vk_framebuffer_create_info {
-  VkDevice                         vkDevice;
-  uint32_t                         frameBufferCount;
-  struct uvr_vk_image_view_handle  *vkImageViews;
+struct uvr_vk_graphics_pipeline_batch_stats uvr_vk_graphics_pipeline_create_batch(struct uvr_vk_graphics_pipeline_batch_info *uvrvk);
+
+
+/* Opaque fragment output interface linked against a struct uvr_vk_pipeline_library */
+struct uvr_vk_pipeline_library_variant;
+
+
+/*
+ * struct uvr_vk_pipeline_library (Underview Renderer Vulkan Pipeline Library)
+ *
+ * members:
+ * @vkDevice         - Logical device used to create the libraries and every linked variant
+ * @libraryEnabled   - VK_TRUE if variants are fast-linked from VK_EXT_graphics_pipeline_library parts. If VK_FALSE
+ *                     each variant is a monolithic pipeline compiled from @desc.
+ * @desc             - Copy of the description shared by every variant
+ * @vertexInput      - Vertex input interface library. VK_NULL_HANDLE if @libraryEnabled is VK_FALSE.
+ * @preRasterization - Pre-rasterization shaders library (vertex/tessellation/geometry stages, viewport, rasterization)
+ * @fragmentShader   - Fragment shader library (fragment stage, depth/stencil state)
+ * @threadPool       - Pointer to a struct uvr_utils_thread_pool running link time optimized links in the background
+ * @variantCount     - Amount of variants linked
+ * @variants         - Pointer to a singly linked list of every linked variant, newest first
+ */
+struct uvr_vk_pipeline_library {
+  VkDevice                                    vkDevice;
+  VkBool32                                    libraryEnabled;
+  struct uvr_vk_graphics_pipeline_create_info desc;
+  VkPipeline                                  vertexInput;
+  VkPipeline                                  preRasterization;
+  VkPipeline                                  fragmentShader;
+  struct uvr_utils_thread_pool                *threadPool;
+  uint32_t                                    variantCount;
+  struct uvr_vk_pipeline_library_variant      *variants;
+};
+
+
+/*
+ * struct uvr_vk_pipeline_library_create_info (Underview Renderer Vulkan Pipeline Library Create Information)
+ *
+ * members:
+ * @vkPhdev                        - Must pass a valid VkPhysicalDevice handle
+ * @graphicsPipelineLibraryEnabled - VK_TRUE if the logical device was created with VK_KHR_pipeline_library and
+ *                                   VK_EXT_graphics_pipeline_library in ppEnabledExtensionNames and
+ *                                   VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT { member: graphicsPipelineLibrary }
+ *                                   chained in pNext. See uvr_vk_pipeline_library_supported(3).
+ * @desc                           - State shared by every variant. Its @pColorBlendState, @pMultisampleState and
+ *                                   @pRenderingInfo attachment formats serve as defaults for variants that don't
+ *                                   override them. Everything @desc points to must remain valid until the library
+ *                                   is destroyed, monolithic fallback compiles read it on every link.
+ */
+struct uvr_vk_pipeline_library_create_info {
+  VkPhysicalDevice                            vkPhdev;
+  VkBool32                                    graphicsPipelineLibraryEnabled;
+  struct uvr_vk_graphics_pipeline_create_info desc;
+};
+
+
+/*
+ * uvr_vk_pipeline_library_supported: Queries whether @vkPhdev supports VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT
+ *                                    { member: graphicsPipelineLibrary }
+ *
+ * args:
+ * @vkPhdev - Must pass a valid VkPhysicalDevice handle
+ * return:
+ *    VK_TRUE if the extension and feature are available
+ *    VK_FALSE otherwise
+ */
+VkBool32 uvr_vk_pipeline_library_supported(VkPhysicalDevice vkPhdev);
+
+
+/*
+ * uvr_vk_pipeline_library_create: Precompiles the vertex input interface, pre-rasterization shaders and fragment
+ *                                 shader parts of a graphics pipeline once. Variants differing only in their
+ *                                 fragment output interface (blend mode, attachment formats, sample count) are then
+ *                                 fast-linked by uvr_vk_pipeline_library_link(3) instead of compiled from scratch.
+ *                                 Falls back to monolithic pipelines if the extension is unavailable or a part fails
+ *                                 to compile.
+ *
+ * args:
+ * @uvrvk - pointer to a struct uvr_vk_pipeline_library_create_info
+ * return:
+ *    on success struct uvr_vk_pipeline_library
+ *    on failure struct uvr_vk_pipeline_library { with member nulled }
+ */
+struct uvr_vk_pipeline_library uvr_vk_pipeline_library_create(struct uvr_vk_pipeline_library_create_info *uvrvk);
+
+
+/*
+ * struct uvr_vk_pipeline_library_link_info (Underview Renderer Vulkan Pipeline Library Link Information)
+ *
+ * members:
+ * @pColorBlendState  - Optional blend state of the variant. If NULL @desc's is used.
+ * @pMultisampleState - Optional multisample state of the variant. If NULL @desc's is used. The fragment shader part
+ *                      is compiled against @desc's, so when library parts are in use it must match it.
+ * @pRenderingInfo    - Optional attachment formats of the variant. If NULL @desc's is used. When library parts are
+ *                      in use only color attachment formats may differ from @desc's.
+ * @optimize          - If VK_TRUE a link time optimized pipeline is compiled in the background and returned by
+ *                      uvr_vk_pipeline_library_variant_get(3) once ready. Ignored for monolithic fallback pipelines.
+ */
+struct uvr_vk_pipeline_library_link_info {
+  const VkPipelineColorBlendStateCreateInfo  *pColorBlendState;
+  const VkPipelineMultisampleStateCreateInfo *pMultisampleState;
+  const VkPipelineRenderingCreateInfo        *pRenderingInfo;
+  VkBool32                                   optimize;
+};
+
+
+/*
+ * uvr_vk_pipeline_library_link: Creates a fragment output interface library for the variant and links it with the
+ *                               precompiled parts. Linking without link time optimization takes a fraction of a full
+ *                               compile, making it usable the frame a new client format shows up. The library owns
+ *                               the returned variant. Must be externally synchronized.
+ *
+ * args:
+ * @library - pointer to a struct uvr_vk_pipeline_library
+ * @uvrvk   - pointer to a struct uvr_vk_pipeline_library_link_info
+ * return:
+ *    on success pointer to a struct uvr_vk_pipeline_library_variant
+ *    on failure NULL
+ */
+struct uvr_vk_pipeline_library_variant *uvr_vk_pipeline_library_link(struct uvr_vk_pipeline_library *library,
+                                                                     struct uvr_vk_pipeline_library_link_info *uvrvk);
+
+
+/*
+ * uvr_vk_pipeline_library_variant_get: Returns the pipeline to bind for @variant. The optimized pipeline is swapped
+ *                                      in as soon as the background link finished, until then the fast-linked one
+ *                                      is returned. Both stay alive until the library is destroyed so command
+ *                                      buffers still in flight remain valid. Call when recording every frame.
+ *
+ * args:
+ * @variant - pointer to a struct uvr_vk_pipeline_library_variant
+ * return:
+ *    VkPipeline handle
+ */
+VkPipeline uvr_vk_pipeline_library_variant_get(struct uvr_vk_pipeline_library_variant *variant);
+
+
+/*
+ * struct uvr_vk_pipeline_library_stats (Underview Renderer Vulkan Pipeline Library Statistics)
+ *
+ * members:
+ * @variantCount   - Amount of variants linked
+ * @optimizedCount - Amount of variants whose link time optimized pipeline was swapped in or is ready to be
+ * @pendingCount   - Amount of variants still being optimized in the background
+ * @linkMs         - Average milliseconds uvr_vk_pipeline_library_link(3) blocked the calling thread per variant.
+ *                   Compare against a monolithic library (graphicsPipelineLibraryEnabled VK_FALSE) to measure the
+ *                   hitch a new variant causes.
+ * @optimizeMs     - Average milliseconds a background link time optimized link took
+ */
+struct uvr_vk_pipeline_library_stats {
+  uint32_t variantCount;
+  uint32_t optimizedCount;
+  uint32_t pendingCount;
+  double   linkMs;
+  double   optimizeMs;
+};
+
+
+/*
+ * uvr_vk_pipeline_library_get_stats: Gathers link timings of every variant linked so far
+ *
+ * args:
+ * @library - pointer to a struct uvr_vk_pipeline_library
+ * return:
+ *    populated struct uvr_vk_pipeline_library_stats
+ */
+struct uvr_vk_pipeline_library_stats uvr_vk_pipeline_library_get_stats(struct uvr_vk_pipeline_library *library);
+
+
+/*
+ * uvr_vk_graphics_pipeline_hash: Computes the canonical hash of a pipeline description. Descriptions producing the
+ *                                same pipeline hash equal no matter where their state structures live in memory.
+ *                                Shader modules, the pipeline layout and render pass are keyed by handle, so render
+ *                                passes should come from uvr_vk_object_cache_render_pass_get(3) for compatible ones
+ *                                to share pipelines. With dynamic rendering the attachment formats and view mask of
+ *                                @pRenderingInfo are keyed instead. @vkPipelineCache and the pNext chains of the
+ *                                state structures and shader stages are not part of the key.
+ *
+ * args:
+ * @uvrvk - pointer to a struct uvr_vk_graphics_pipeline_create_info
+ * return:
+ *    on success 64-bit hash
+ *    on failure 0
+ */
+uint64_t uvr_vk_graphics_pipeline_hash(const struct uvr_vk_graphics_pipeline_create_info *uvrvk);
+
+
+/* Opaque, mutex protected hash tables of a struct uvr_vk_object_cache */
+struct uvr_vk_object_cache_tables;
+
+
+/*
+ * struct uvr_vk_object_cache (Underview Renderer Vulkan Object Cache)
+ *
+ * members:
+ * @vkDevice - Logical device cached VkPipeline, VkRenderPass and VkSampler handles are created with
+ * @tables   - Canonical descriptions and handles of every cached object. Safe to share between threads.
+ */
+struct uvr_vk_object_cache {
+  VkDevice                          vkDevice;
+  struct uvr_vk_object_cache_tables *tables;
+};
+
+
+/*
+ * struct uvr_vk_object_cache_create_info (Underview Renderer Vulkan Object Cache Create Information)
+ *
+ * members:
+ * @vkDevice - Must pass a valid active logical device
+ */
+struct uvr_vk_object_cache_create_info {
+  VkDevice vkDevice;
+};
+
+
+/*
+ * uvr_vk_object_cache_create: Creates a cache deduplicating driver objects by description. Equal descriptions
+ *                             return the same handle, so large scenes never pay for compiling a pipeline or creating
+ *                             a render pass or sampler twice. The cache owns every handle it returns.
+ *
+ * args:
+ * @uvrvk - pointer to a struct uvr_vk_object_cache_create_info
+ * return:
+ *    on success struct uvr_vk_object_cache
+ *    on failure struct uvr_vk_object_cache { with member nulled }
+ */
+struct uvr_vk_object_cache uvr_vk_object_cache_create(struct uvr_vk_object_cache_create_info *uvrvk);
+
+
+/*
+ * uvr_vk_object_cache_graphics_pipeline_get: Returns the cached pipeline matching @uvrvk or compiles one with
+ *                                            uvr_vk_graphics_pipeline_create(3) on miss. Compilation happens
+ *                                            outside the lock, other threads keep hitting meanwhile.
+ *                                            See uvr_vk_graphics_pipeline_hash(3) for what is keyed.
+ *
+ * args:
+ * @cache - pointer to a struct uvr_vk_object_cache
+ * @uvrvk - pointer to a struct uvr_vk_graphics_pipeline_create_info { member: vkDevice } must match @cache's.
+ *          The shader stages and state create infos must not chain any pNext structures.
+ * return:
+ *    on success VkPipeline handle
+ *    on failure VK_NULL_HANDLE
+ */
+VkPipeline uvr_vk_object_cache_graphics_pipeline_get(struct uvr_vk_object_cache *cache, struct uvr_vk_graphics_pipeline_create_info *uvrvk);
+
+
+/*
+ * uvr_vk_object_cache_render_pass_get: Returns the cached render pass whose attachments, subpasses and dependencies
+ *                                      match @uvrvk or creates one with uvr_vk_render_pass_create(3) on miss
+ *
+ * args:
+ * @cache - pointer to a struct uvr_vk_object_cache
+ * @uvrvk - pointer to a struct uvr_vk_render_pass_create_info { member: vkDevice } must match @cache's
+ * return:
+ *    on success VkRenderPass handle
+ *    on failure VK_NULL_HANDLE
+ */
+VkRenderPass uvr_vk_object_cache_render_pass_get(struct uvr_vk_object_cache *cache, struct uvr_vk_render_pass_create_info *uvrvk);
+
+
+/*
+ * uvr_vk_object_cache_sampler_get: Returns the cached sampler matching @pCreateInfo or creates one on miss
+ *
+ * args:
+ * @cache       - pointer to a struct uvr_vk_object_cache
+ * @pCreateInfo - pointer to a VkSamplerCreateInfo. pNext must be NULL, chained structures can't be keyed.
+ * return:
+ *    on success VkSampler handle
+ *    on failure VK_NULL_HANDLE
+ */
+VkSampler uvr_vk_object_cache_sampler_get(struct uvr_vk_object_cache *cache, const VkSamplerCreateInfo *pCreateInfo);
+
+
+/*
+ * struct uvr_vk_object_cache_stats (Underview Renderer Vulkan Object Cache Statistics)
+ *
+ * members:
+ * @pipelineCount    - Amount of unique VkPipeline handles cached
+ * @pipelineHits     - Lookups that returned an existing VkPipeline
+ * @pipelineMisses   - Lookups that compiled a VkPipeline
+ * @renderPassCount  - Amount of unique VkRenderPass handles cached
+ * @renderPassHits   - Lookups that returned an existing VkRenderPass
+ * @renderPassMisses - Lookups that created a VkRenderPass
+ * @samplerCount     - Amount of unique VkSampler handles cached
+ * @samplerHits      - Lookups that returned an existing VkSampler
+ * @samplerMisses    - Lookups that created a VkSampler
+ */
+struct uvr_vk_object_cache_stats {
+  uint32_t pipelineCount;
+  uint64_t pipelineHits;
+  uint64_t pipelineMisses;
+  uint32_t renderPassCount;
+  uint64_t renderPassHits;
+  uint64_t renderPassMisses;
+  uint32_t samplerCount;
+  uint64_t samplerHits;
+  uint64_t samplerMisses;
+};
+
+
+/*
+ * uvr_vk_object_cache_get_stats: Returns hit/miss counters of every object kind
+ *
+ * args:
+ * @cache - pointer to a struct uvr_vk_object_cache
+ * return:
+ *    populated struct uvr_vk_object_cache_stats
+ */
+struct uvr_vk_object_cache_stats uvr_vk_object_cache_get_stats(struct uvr_vk_object_cache *cache);
+
+
+/*
+ * enum uvr_vk_dynamic_state_flags (Underview Renderer Vulkan Dynamic State Flags)
+ *
+ * Groups of pipeline state uvr_vk_dynamic_state_init(3) may turn dynamic. One pipeline built with a group dynamic
+ * covers every value of it, values are set while recording through a struct uvr_vk_dynamic_state_tracker.
+ *
+ * UVR_VK_DYNAMIC_STATE_VIEWPORT_SCISSOR - Viewport and scissor (Vulkan 1.0). Pipelines survive window resizes.
+ * UVR_VK_DYNAMIC_STATE_CULL_MODE        - Cull mode and front face (Vulkan 1.3)
+ * UVR_VK_DYNAMIC_STATE_TOPOLOGY         - Primitive topology within the topology class of pInputAssemblyState (Vulkan 1.3)
+ * UVR_VK_DYNAMIC_STATE_DEPTH            - Depth test enable, depth write enable and depth compare op (Vulkan 1.3)
+ * UVR_VK_DYNAMIC_STATE_BLEND_ENABLE     - Per attachment blend enable (VK_EXT_extended_dynamic_state3)
+ * UVR_VK_DYNAMIC_STATE_WRITE_MASK       - Per attachment color write mask (VK_EXT_extended_dynamic_state3)
+ */
+typedef enum uvr_vk_dynamic_state_flags {
+  UVR_VK_DYNAMIC_STATE_VIEWPORT_SCISSOR = (1 << 0),
+  UVR_VK_DYNAMIC_STATE_CULL_MODE        = (1 << 1),
+  UVR_VK_DYNAMIC_STATE_TOPOLOGY         = (1 << 2),
+  UVR_VK_DYNAMIC_STATE_DEPTH            = (1 << 3),
+  UVR_VK_DYNAMIC_STATE_BLEND_ENABLE     = (1 << 4),
+  UVR_VK_DYNAMIC_STATE_WRITE_MASK       = (1 << 5),
+} uvr_vk_dynamic_state_flags;
+
+
+#define UVR_VK_DYNAMIC_STATE_MAX_STATES 10
+#define UVR_VK_DYNAMIC_STATE_MAX_ATTACHMENTS 8
+
+/*
+ * struct uvr_vk_dynamic_state (Underview Renderer Vulkan Dynamic State)
+ *
+ * members:
+ * @vkDevice                  - Logical device pipelines using @createInfo are created with
+ * @enabledFlags              - Bitmask of enum uvr_vk_dynamic_state_flags that are dynamic. Requested groups the
+ *                              device doesn't support are left out, their state stays baked into the pipeline.
+ * @dynamicStateCount         - Amount of elements used in @dynamicStates
+ * @dynamicStates             - VkDynamicState's of @enabledFlags
+ * @createInfo                - Points to @dynamicStates. Pass as struct uvr_vk_graphics_pipeline_create_info
+ *                              { member: pDynamicState }.
+ * @CmdSetColorBlendEnableEXT - Resolved with vkGetDeviceProcAddr if UVR_VK_DYNAMIC_STATE_BLEND_ENABLE is enabled
+ * @CmdSetColorWriteMaskEXT   - Resolved with vkGetDeviceProcAddr if UVR_VK_DYNAMIC_STATE_WRITE_MASK is enabled
+ */
+struct uvr_vk_dynamic_state {
+  VkDevice                         vkDevice;
+  uint32_t                         enabledFlags;
+  uint32_t                         dynamicStateCount;
+  VkDynamicState                   dynamicStates[UVR_VK_DYNAMIC_STATE_MAX_STATES];
+  VkPipelineDynamicStateCreateInfo createInfo;
+  PFN_vkCmdSetColorBlendEnableEXT  CmdSetColorBlendEnableEXT;
+  PFN_vkCmdSetColorWriteMaskEXT    CmdSetColorWriteMaskEXT;
+};
+
+
+/*
+ * struct uvr_vk_dynamic_state_create_info (Underview Renderer Vulkan Dynamic State Create Information)
+ *
+ * members:
+ * @vkPhdev                      - Must pass a valid VkPhysicalDevice handle
+ * @vkDevice                     - Must pass a valid active logical device
+ * @flags                        - Bitmask of enum uvr_vk_dynamic_state_flags to make dynamic
+ * @extendedDynamicState3Enabled - VK_TRUE if the logical device was created with VK_EXT_extended_dynamic_state3 in
+ *                                 ppEnabledExtensionNames and VkPhysicalDeviceExtendedDynamicState3FeaturesEXT
+ *                                 { members: extendedDynamicState3ColorBlendEnable, extendedDynamicState3ColorWriteMask }
+ *                                 chained in pNext. If VK_FALSE blend enable and write mask stay baked.
+ */
+struct uvr_vk_dynamic_state_create_info {
+  VkPhysicalDevice vkPhdev;
+  VkDevice         vkDevice;
+  uint32_t         flags;
+  VkBool32         extendedDynamicState3Enabled;
+};
+
+
+/*
+ * uvr_vk_dynamic_state_init: Initializes @state in place with every requested group the device supports. Opt-in,
+ *                            pipelines not passing @state->createInfo are unaffected. @state must not be moved
+ *                            afterwards as @createInfo points into it.
+ *
+ * args:
+ * @state - pointer to a struct uvr_vk_dynamic_state
+ * @uvrvk - pointer to a struct uvr_vk_dynamic_state_create_info
+ * return:
+ *    on success 0
+ *    on failure -1
+ */
+int uvr_vk_dynamic_state_init(struct uvr_vk_dynamic_state *state, struct uvr_vk_dynamic_state_create_info *uvrvk);
+
+
+/*
+ * struct uvr_vk_dynamic_state_tracker (Underview Renderer Vulkan Dynamic State Tracker)
+ *
+ * Shadow of the dynamic state recorded into a single command buffer. Setters only record a vkCmdSet* call if the
+ * value differs from what the command buffer already holds. Zero initialize once, counters accumulate across
+ * uvr_vk_dynamic_state_tracker_begin(3) calls.
+ *
+ * members:
+ * @dispatch         - Device function table commands are recorded through
+ * @dynamicState     - Groups that are dynamic. Setters of other groups are ignored, their value is baked.
+ * @commandBuffer    - Command buffer being recorded
+ * @pipeline         - Graphics pipeline currently bound to @commandBuffer
+ * @validMask        - Bitmask of values known to be set on @commandBuffer
+ * @blendEnableValid - Bitmask of attachments whose @blendEnable is known to be set on @commandBuffer
+ * @writeMaskValid   - Bitmask of attachments whose @writeMask is known to be set on @commandBuffer
+ * @viewport         - Last viewport 0 set
+ * @scissor          - Last scissor 0 set
+ * @cullMode         - Last cull mode set
+ * @frontFace        - Last front face set
+ * @topology         - Last primitive topology set
+ * @depthTestEnable  - Last depth test enable set
+ * @depthWriteEnable - Last depth write enable set
+ * @depthCompareOp   - Last depth compare op set
+ * @blendEnable      - Last blend enable set per attachment
+ * @writeMask        - Last color write mask set per attachment
+ * @setCount         - Amount of vkCmdSet* and vkCmdBindPipeline calls recorded
+ * @skipCount        - Amount of redundant calls filtered out
+ */
+struct uvr_vk_dynamic_state_tracker {
+  const struct uvr_vk_device_dispatch *dispatch;
+  const struct uvr_vk_dynamic_state   *dynamicState;
+  VkCommandBuffer                     commandBuffer;
+  VkPipeline                          pipeline;
+  uint32_t                            validMask;
+  uint32_t                            blendEnableValid;
+  uint32_t                            writeMaskValid;
+  VkViewport                          viewport;
+  VkRect2D                            scissor;
+  VkCullModeFlags                     cullMode;
+  VkFrontFace                         frontFace;
+  VkPrimitiveTopology                 topology;
+  VkBool32                            depthTestEnable;
+  VkBool32                            depthWriteEnable;
+  VkCompareOp                         depthCompareOp;
+  VkBool32                            blendEnable[UVR_VK_DYNAMIC_STATE_MAX_ATTACHMENTS];
+  VkColorComponentFlags               writeMask[UVR_VK_DYNAMIC_STATE_MAX_ATTACHMENTS];
+  uint64_t                            setCount;
+  uint64_t                            skipCount;
+};
+
+
+/*
+ * uvr_vk_dynamic_state_tracker_begin: Points @tracker at @commandBuffer and forgets every value, a command buffer
+ *                                     starts recording with undefined dynamic state. Call right after
+ *                                     vkBeginCommandBuffer.
+ *
+ * args:
+ * @tracker       - pointer to a struct uvr_vk_dynamic_state_tracker
+ * @dispatch      - Device function table from uvr_vk_device_dispatch_get(3)
+ * @dynamicState  - pointer to the struct uvr_vk_dynamic_state pipelines bound through @tracker were created with
+ * @commandBuffer - Command buffer in the recording state
+ */
+void uvr_vk_dynamic_state_tracker_begin(struct uvr_vk_dynamic_state_tracker *tracker, const struct uvr_vk_device_dispatch *dispatch,
+                                        const struct uvr_vk_dynamic_state *dynamicState, VkCommandBuffer commandBuffer);
+
+
+/*
+ * uvr_vk_dynamic_state_tracker_bind_pipeline: Binds @pipeline unless already bound. Values of groups @pipeline
+ *                                             bakes are overwritten by the bind and forgotten.
+ *
+ * args:
+ * @tracker      - pointer to a struct uvr_vk_dynamic_state_tracker
+ * @pipeline     - Graphics pipeline to bind
+ * @dynamicFlags - Bitmask of enum uvr_vk_dynamic_state_flags @pipeline was created with. Typically
+ *                 struct uvr_vk_dynamic_state { member: enabledFlags }, zero for pipelines without dynamic state.
+ */
+void uvr_vk_dynamic_state_tracker_bind_pipeline(struct uvr_vk_dynamic_state_tracker *tracker, VkPipeline pipeline, uint32_t dynamicFlags);
+
+
+/*
+ * uvr_vk_dynamic_state_tracker_set_viewport: Sets viewport 0 (UVR_VK_DYNAMIC_STATE_VIEWPORT_SCISSOR)
+ *
+ * args:
+ * @tracker  - pointer to a struct uvr_vk_dynamic_state_tracker
+ * @viewport - pointer to a VkViewport
+ */
+void uvr_vk_dynamic_state_tracker_set_viewport(struct uvr_vk_dynamic_state_tracker *tracker, const VkViewport *viewport);
+
+
+/*
+ * uvr_vk_dynamic_state_tracker_set_scissor: Sets scissor 0 (UVR_VK_DYNAMIC_STATE_VIEWPORT_SCISSOR)
+ *
+ * args:
+ * @tracker - pointer to a struct uvr_vk_dynamic_state_tracker
+ * @scissor - pointer to a VkRect2D
+ */
+void uvr_vk_dynamic_state_tracker_set_scissor(struct uvr_vk_dynamic_state_tracker *tracker, const VkRect2D *scissor);
+
+
+/*
+ * uvr_vk_dynamic_state_tracker_set_cull_mode: Sets cull mode and front face (UVR_VK_DYNAMIC_STATE_CULL_MODE)
+ *
+ * args:
+ * @tracker   - pointer to a struct uvr_vk_dynamic_state_tracker
+ * @cullMode  - VkCullModeFlags
+ * @frontFace - VkFrontFace
+ */
+void uvr_vk_dynamic_state_tracker_set_cull_mode(struct uvr_vk_dynamic_state_tracker *tracker, VkCullModeFlags cullMode, VkFrontFace frontFace);
+
+
+/*
+ * uvr_vk_dynamic_state_tracker_set_topology: Sets primitive topology (UVR_VK_DYNAMIC_STATE_TOPOLOGY)
+ *
+ * args:
+ * @tracker  - pointer to a struct uvr_vk_dynamic_state_tracker
+ * @topology - VkPrimitiveTopology of the same topology class the bound pipeline was created with
+ */
+void uvr_vk_dynamic_state_tracker_set_topology(struct uvr_vk_dynamic_state_tracker *tracker, VkPrimitiveTopology topology);
+
+
+/*
+ * uvr_vk_dynamic_state_tracker_set_depth: Sets depth test, depth write and compare op (UVR_VK_DYNAMIC_STATE_DEPTH)
+ *
+ * args:
+ * @tracker     - pointer to a struct uvr_vk_dynamic_state_tracker
+ * @testEnable  - VK_TRUE to enable depth testing
+ * @writeEnable - VK_TRUE to enable depth writes
+ * @compareOp   - VkCompareOp used by the depth test
+ */
+void uvr_vk_dynamic_state_tracker_set_depth(struct uvr_vk_dynamic_state_tracker *tracker, VkBool32 testEnable,
+                                            VkBool32 writeEnable, VkCompareOp compareOp);
+
+
+/*
+ * uvr_vk_dynamic_state_tracker_set_blend: Sets blend enable (UVR_VK_DYNAMIC_STATE_BLEND_ENABLE) and color write
+ *                                         mask (UVR_VK_DYNAMIC_STATE_WRITE_MASK) of a color attachment. Lets one
+ *                                         pipeline draw both opaque and translucent surfaces.
+ *
+ * args:
+ * @tracker     - pointer to a struct uvr_vk_dynamic_state_tracker
+ * @attachment  - Color attachment index. Must be less than UVR_VK_DYNAMIC_STATE_MAX_ATTACHMENTS.
+ * @blendEnable - VK_TRUE to blend with the blend equation the pipeline was created with
+ * @writeMask   - VkColorComponentFlags written
+ */
+void uvr_vk_dynamic_state_tracker_set_blend(struct uvr_vk_dynamic_state_tracker *tracker, uint32_t attachment,
+                                            VkBool32 blendEnable, VkColorComponentFlags writeMask);
+
+
+/*
+ * struct uvr_vk_compute_pipeline (Underview Renderer Vulkan Compute Pipeline)
+ *
+ * members:
+ * @vkDevice          - Logical device used when creating VkPipeline handle
+ * @dispatch          - Device function table dispatches are recorded through
+ * @computePipeline   - Handle to a pipeline object
+ * @localSize         - Workgroup size of the compute shader (local_size_{x,y,z})
+ * @maxWorkGroupCount - VkPhysicalDeviceLimits::maxComputeWorkGroupCount. Larger dispatches are split.
+ */
+struct uvr_vk_compute_pipeline {
+  VkDevice                            vkDevice;
+  const struct uvr_vk_device_dispatch *dispatch;
+  VkPipeline                          computePipeline;
+  uint32_t                            localSize[3];
+  uint32_t                            maxWorkGroupCount[3];
+};
+
+
+/*
+ * struct uvr_vk_compute_pipeline_create_info (Underview Renderer Vulkan Compute Pipeline Create Information)
+ *
+ * members:
+ * @vkPhdev             - Must pass a valid VkPhysicalDevice handle. Used to query compute workgroup limits.
+ * @vkDevice            - Must pass a valid active logical device
+ * @shader              - Must pass a valid compute VkShaderModule handle (struct uvr_vk_shader_module { member: shader })
+ * @pEntryPoint         - Name of the shader entry point. If NULL "main" is used.
+ * @pSpecializationInfo - Optional specialization constants. May be NULL.
+ * @localSize           - Workgroup size the shader was compiled or specialized with. Zero components are treated as 1.
+ * @vkPipelineLayout    - Must pass a valid VkPipelineLayout handle
+ * @vkPipelineCache     - Optional VkPipelineCache handle (struct uvr_vk_pipeline_cache { member: vkPipelineCache })
+ *                        used to speed up pipeline creation. May be VK_NULL_HANDLE.
+ */
+struct uvr_vk_compute_pipeline_create_info {
+  VkPhysicalDevice           vkPhdev;
+  VkDevice                   vkDevice;
+  VkShaderModule             shader;
+  const char                 *pEntryPoint;
+  const VkSpecializationInfo *pSpecializationInfo;
+  uint32_t                   localSize[3];
+  VkPipelineLayout           vkPipelineLayout;
+  VkPipelineCache            vkPipelineCache;
+};
+
+
+/*
+ * uvr_vk_compute_pipeline_create: Function creates a compute VkPipeline handle. Pipeline is created with
+ *                                 VK_PIPELINE_CREATE_DISPATCH_BASE_BIT so uvr_vk_compute_pipeline_dispatch(3)
+ *                                 may split dispatches exceeding the device's workgroup count limits.
+ *
+ * args:
+ * @uvrvk - pointer to a struct uvr_vk_compute_pipeline_create_info
+ * return:
+ *    on success struct uvr_vk_compute_pipeline
+ *    on failure struct uvr_vk_compute_pipeline { with member nulled }
+ */
+struct uvr_vk_compute_pipeline uvr_vk_compute_pipeline_create(struct uvr_vk_compute_pipeline_create_info *uvrvk);
+
+
+/*
+ * struct uvr_vk_compute_dispatch_info (Underview Renderer Vulkan Compute Dispatch Information)
+ *
+ * members:
+ * @commandBuffer - Command buffer in the recording state with the compute pipeline and its descriptor sets bound
+ * @extent3D      - Amount of invocations required, typically the extent of the image being processed. Rounded up
+ *                  to whole workgroups so shaders must discard invocations outside the image.
+ */
+struct uvr_vk_compute_dispatch_info {
+  VkCommandBuffer commandBuffer;
+  VkExtent3D      extent3D;
+};
+
+
+/*
+ * uvr_vk_compute_pipeline_dispatch: Records dispatches covering @extent3D. Workgroup counts are computed from
+ *                                   struct uvr_vk_compute_pipeline { member: localSize }. If a count exceeds
+ *                                   maxComputeWorkGroupCount the grid is split into several vkCmdDispatchBase
+ *                                   calls, gl_WorkGroupID stays continuous across them.
+ *
+ * args:
+ * @pipeline - pointer to a struct uvr_vk_compute_pipeline
+ * @uvrvk    - pointer to a struct uvr_vk_compute_dispatch_info
+ * return:
+ *    Amount of dispatch commands recorded
+ */
+uint32_t uvr_vk_compute_pipeline_dispatch(struct uvr_vk_compute_pipeline *pipeline, struct uvr_vk_compute_dispatch_info *uvrvk);
+
+
+/*
+ * enum uvr_vk_storage_image_access (Underview Renderer Vulkan Storage Image Access)
+ *
+ * How a storage image is used on either side of a uvr_vk_storage_image_barrier(3). Each value maps to a
+ * pipeline stage, access mask and image layout.
+ *
+ * UVR_VK_STORAGE_IMAGE_UNDEFINED          - Contents are discarded. Only valid as source.
+ * UVR_VK_STORAGE_IMAGE_COMPUTE_READ       - imageLoad from a compute shader (VK_IMAGE_LAYOUT_GENERAL)
+ * UVR_VK_STORAGE_IMAGE_COMPUTE_WRITE      - imageStore from a compute shader (VK_IMAGE_LAYOUT_GENERAL)
+ * UVR_VK_STORAGE_IMAGE_COMPUTE_READ_WRITE - imageLoad and imageStore from a compute shader (VK_IMAGE_LAYOUT_GENERAL)
+ * UVR_VK_STORAGE_IMAGE_FRAGMENT_SAMPLED   - Sampled from a fragment shader (VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL)
+ * UVR_VK_STORAGE_IMAGE_COLOR_ATTACHMENT   - Rendered to (VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL)
+ * UVR_VK_STORAGE_IMAGE_TRANSFER_SRC       - Copy or blit source (VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL)
+ * UVR_VK_STORAGE_IMAGE_TRANSFER_DST       - Copy or blit destination (VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL)
+ * UVR_VK_STORAGE_IMAGE_PRESENT            - Handed to the presentation engine (VK_IMAGE_LAYOUT_PRESENT_SRC_KHR)
+ */
+typedef enum uvr_vk_storage_image_access {
+  UVR_VK_STORAGE_IMAGE_UNDEFINED          = 0,
+  UVR_VK_STORAGE_IMAGE_COMPUTE_READ       = 1,
+  UVR_VK_STORAGE_IMAGE_COMPUTE_WRITE      = 2,
+  UVR_VK_STORAGE_IMAGE_COMPUTE_READ_WRITE = 3,
+  UVR_VK_STORAGE_IMAGE_FRAGMENT_SAMPLED   = 4,
+  UVR_VK_STORAGE_IMAGE_COLOR_ATTACHMENT   = 5,
+  UVR_VK_STORAGE_IMAGE_TRANSFER_SRC       = 6,
+  UVR_VK_STORAGE_IMAGE_TRANSFER_DST       = 7,
+  UVR_VK_STORAGE_IMAGE_PRESENT            = 8,
+} uvr_vk_storage_image_access;
+
+
+/*
+ * struct uvr_vk_storage_image_barrier_info (Underview Renderer Vulkan Storage Image Barrier Information)
+ *
+ * members:
+ * @commandBuffer       - Command buffer in the recording state
+ * @image               - Image the barrier applies to
+ * @subresourceRange    - Subresources of @image the barrier applies to
+ * @srcAccess           - How @image was used before the barrier
+ * @dstAccess           - How @image is used after the barrier
+ * @srcQueueFamilyIndex - Queue family releasing @image, VK_QUEUE_FAMILY_IGNORED if ownership isn't transferred.
+ *                        When handing images between the graphics queue and an async compute queue the same
+ *                        barrier must be recorded on both queues (release then acquire).
+ * @dstQueueFamilyIndex - Queue family acquiring @image, VK_QUEUE_FAMILY_IGNORED if ownership isn't transferred
+ */
+struct uvr_vk_storage_image_barrier_info {
+  VkCommandBuffer             commandBuffer;
+  VkImage                     image;
+  VkImageSubresourceRange     subresourceRange;
+  uvr_vk_storage_image_access srcAccess;
+  uvr_vk_storage_image_access dstAccess;
+  uint32_t                    srcQueueFamilyIndex;
+  uint32_t                    dstQueueFamilyIndex;
+};
+
+
+/*
+ * uvr_vk_storage_image_barrier: Records a single image memory barrier transitioning @image between two accesses.
+ *                               Compute write to compute read (and vice versa) keeps VK_IMAGE_LAYOUT_GENERAL and
+ *                               only makes the writes visible.
+ *
+ * args:
+ * @dispatch - Device function table the barrier is recorded through (struct uvr_vk_lgdev { member: dispatch })
+ * @uvrvk    - pointer to a struct uvr_vk_storage_image_barrier_info
+ */
+void uvr_vk_storage_image_barrier(const struct uvr_vk_device_dispatch *dispatch, struct uvr_vk_storage_image_barrier_info *uvrvk);
+
+
+/*
+ * struct uvr_vk_framebuffer_handle (Underview Renderer Vulkan Framebuffer Handle)
+ *
+ * @fb - Framebuffers represent a collection of specific memory attachments that a render pass instance uses.
+ */
+struct uvr_vk_framebuffer_handle {
+  VkFramebuffer fb;
+};
+
+
+/*
+ * struct uvr_vk_framebuffer (Underview Renderer Vulkan Framebuffer)
+ *
+ * members:
+ * @vkDevice         - Logical device used when VkFramebuffer handle was created.
+ * @frameBufferCount - Amount of VkFramebuffer handles created
+ * @vkFrameBuffers   - Pointer to an array of VkFramebuffer handles
+ */
+struct uvr_vk_framebuffer {
+  VkDevice                          vkDevice;
+  uint32_t                          frameBufferCount;
+  struct uvr_vk_framebuffer_handle  *vkFrameBuffers;
+};
+
+
+/*
+ * struct uvr_vk_framebuffer_create_info (Underview Renderer Vulkan Framebuffer Create Information)
+ *
+ * members:
+ * @vkDevice         - Must pass a valid active logical device
+ * @frameBufferCount - Amount of VkFramebuffer handles to create
+ * @vkImageViews     - Pointer to an array of VkImageView handles which will be used in a render pass instance.
+ * @renderPass       - Defines the render pass a given framebuffer is compatible with
+ * @width            - Framebuffer width in pixels
+ * @height           - Framebuffer height in pixels
+ * See: https://www.khronos.org/registry/vulkan/specs/1.3-extensions/man/html/VkFramebufferCreateInfo.html for bellow members
+ * @layers
+ */
+struct uvr_vk_framebuffer_create_info {
+  VkDevice                         vkDevice;
+  uint32_t                         frameBufferCount;
+  struct uvr_vk_image_view_handle  *vkImageViews;
   VkRenderPass                     renderPass;
   uint32_t                         width;
   uint32_t                         height;
@@ -755,186 +2267,2737 @@ struct uvr_vk_framebuffer_create_info {
 
 
 /*
- * uvr_vk_framebuffer_create: Creates @frameBufferCount amount of VkFramebuffer handles. For simplicity each VkFramebuffer
- *                            handle created only has one VkImageView attached.
+ * uvr_vk_framebuffer_create: Creates @frameBufferCount amount of VkFramebuffer handles. For simplicity each VkFramebuffer
+ *                            handle created only has one VkImageView attached.
+ *
+ * args:
+ * @uvrvk - pointer to a struct uvr_vk_framebuffer_create_info
+ * return:
+ *    on success struct uvr_vk_framebuffer
+ *    on failure struct uvr_vk_framebuffer { with member nulled }
+ */
+struct uvr_vk_framebuffer uvr_vk_framebuffer_create(struct uvr_vk_framebuffer_create_info *uvrvk);
+
+
+#define UVR_VK_RENDERING_MAX_COLOR_ATTACHMENTS 8
+
+/*
+ * struct uvr_vk_rendering_begin_info (Underview Renderer Vulkan Rendering Begin Information)
+ *
+ * members:
+ * @vkCommandBuffer      - Command buffer in the recording state
+ * @renderArea           - Area of the attachments rendered to
+ * @colorAttachmentCount - Amount of elements in @pColorImages, @pColorImageViews and @pColorClearValues.
+ *                         At most UVR_VK_RENDERING_MAX_COLOR_ATTACHMENTS, zero for a depth only pass.
+ * @pColorImages         - Pointer to an array of VkImage handles rendered to. Used to transition them to
+ *                         VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL.
+ * @pColorImageViews     - Pointer to an array of VkImageView handles of @pColorImages
+ * @colorOldLayout       - Layout @pColorImages are in before rendering. VK_IMAGE_LAYOUT_UNDEFINED discards contents,
+ *                         i.e. for freshly acquired swapchain images.
+ * @colorLoadOp          - How color attachments are initialized
+ * @colorStoreOp         - Whether color attachments are written out
+ * @pColorClearValues    - Pointer to an array of clear values used if @colorLoadOp is VK_ATTACHMENT_LOAD_OP_CLEAR
+ * @depthImage           - Optional depth image. If VK_NULL_HANDLE no depth attachment is used and below members are ignored.
+ * @depthImageView       - VkImageView handle of @depthImage
+ * @depthOldLayout       - Layout @depthImage is in before rendering
+ * @depthLoadOp          - How the depth attachment is initialized
+ * @depthStoreOp         - Whether the depth attachment is written out
+ * @depthClearValue      - Clear value used if @depthLoadOp is VK_ATTACHMENT_LOAD_OP_CLEAR
+ * @renderingFlags       - VkRenderingFlags of the instance. Pass VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT
+ *                         when draws are recorded by uvr_vk_command_recorder_record(3), zero when recorded inline.
+ */
+struct uvr_vk_rendering_begin_info {
+  VkCommandBuffer     vkCommandBuffer;
+  VkRect2D            renderArea;
+  uint32_t            colorAttachmentCount;
+  const VkImage       *pColorImages;
+  const VkImageView   *pColorImageViews;
+  VkImageLayout       colorOldLayout;
+  VkAttachmentLoadOp  colorLoadOp;
+  VkAttachmentStoreOp colorStoreOp;
+  const VkClearValue  *pColorClearValues;
+  VkImage             depthImage;
+  VkImageView         depthImageView;
+  VkImageLayout       depthOldLayout;
+  VkAttachmentLoadOp  depthLoadOp;
+  VkAttachmentStoreOp depthStoreOp;
+  VkClearValue        depthClearValue;
+  VkRenderingFlags    renderingFlags;
+};
+
+
+/*
+ * uvr_vk_rendering_begin: Records layout transitions of every attachment into its attachment optimal layout then begins
+ *                         a dynamic rendering instance (vkCmdBeginRendering). Unlike uvr_vk_render_pass_create(3) plus
+ *                         uvr_vk_framebuffer_create(3) image views are passed directly, so new render targets or a
+ *                         recreated swapchain don't require any VkRenderPass/VkFramebuffer objects to be rebuilt.
+ *                         Graphics pipelines bound inside must be created with
+ *                         struct uvr_vk_graphics_pipeline_create_info { member: pRenderingInfo }.
+ *
+ * args:
+ * @uvrvk - pointer to a struct uvr_vk_rendering_begin_info
+ * return:
+ *    on success 0
+ *    on failure -1 (more than UVR_VK_RENDERING_MAX_COLOR_ATTACHMENTS color attachments, nothing is recorded)
+ */
+int uvr_vk_rendering_begin(struct uvr_vk_rendering_begin_info *uvrvk);
+
+
+/*
+ * struct uvr_vk_rendering_end_info (Underview Renderer Vulkan Rendering End Information)
+ *
+ * members:
+ * @vkCommandBuffer      - Command buffer passed to uvr_vk_rendering_begin(3)
+ * @colorAttachmentCount - Amount of elements in @pColorImages. At most UVR_VK_RENDERING_MAX_COLOR_ATTACHMENTS.
+ * @pColorImages         - Pointer to an array of VkImage handles passed to uvr_vk_rendering_begin(3)
+ * @colorFinalLayout     - Layout @pColorImages are transitioned to after rendering.
+ *                         i.e. VK_IMAGE_LAYOUT_PRESENT_SRC_KHR for swapchain images or
+ *                         VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL for render targets sampled later.
+ *                         VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL skips the transition.
+ */
+struct uvr_vk_rendering_end_info {
+  VkCommandBuffer vkCommandBuffer;
+  uint32_t        colorAttachmentCount;
+  const VkImage   *pColorImages;
+  VkImageLayout   colorFinalLayout;
+};
+
+
+/*
+ * uvr_vk_rendering_end: Ends a dynamic rendering instance (vkCmdEndRendering) and records layout transitions of
+ *                       color attachments into their final layout.
+ *
+ * args:
+ * @uvrvk - pointer to a struct uvr_vk_rendering_end_info
+ * return:
+ *    on success 0
+ *    on failure -1 (more than UVR_VK_RENDERING_MAX_COLOR_ATTACHMENTS color attachments, nothing is recorded)
+ */
+int uvr_vk_rendering_end(struct uvr_vk_rendering_end_info *uvrvk);
+
+
+/*
+ * struct uvr_vk_command_buffer_handle (Underview Renderer Vulkan Command Buffer Handle)
+ *
+ * @buffer - Handle used to prerecord commands before they are submitted to a device queue and sent off to the GPU.
+ */
+struct uvr_vk_command_buffer_handle {
+  VkCommandBuffer buffer;
+};
+
+
+/*
+ * struct uvr_vk_command_buffer (Underview Renderer Vulkan Command Buffer)
+ *
+ * members:
+ * @vkDevice            - Logical device used to create command pool/buffers
+ * @vkCommandPool       - The command pool which the buffers where allocated from.
+ * @commandBufferCount  - Amount of VkCommandBuffer's alloocated
+ * @vkCommandbuffers    - Pointer to an array of VkCommandBuffer handles
+ */
+struct uvr_vk_command_buffer {
+  VkDevice                            vkDevice;
+  VkCommandPool                       vkCommandPool;
+  uint32_t                            commandBufferCount;
+  struct uvr_vk_command_buffer_handle *vkCommandbuffers;
+};
+
+
+/*
+ * struct uvr_vk_command_buffer_create_info (Underview Renderer Vulkan Command Buffer Create Information)
+ *
+ * members:
+ * @vkDevice           - Must pass a valid active logical device
+ * @queueFamilyIndex   - Designates a queue family with VkCommandPool. All command buffers allocated from VkCommandPool
+ *                       must used same queue.
+ * @commandBufferCount - The amount of command buffers to allocate from a given pool
+ * @level              - VK_COMMAND_BUFFER_LEVEL_PRIMARY or VK_COMMAND_BUFFER_LEVEL_SECONDARY. Secondary command buffers
+ *                       are executed from a primary via vkCmdExecuteCommands and may be recorded on other threads.
+ */
+struct uvr_vk_command_buffer_create_info {
+  VkDevice             vkDevice;
+  uint32_t             queueFamilyIndex;
+  uint32_t             commandBufferCount;
+  VkCommandBufferLevel level;
+};
+
+
+/*
+ * uvr_vk_command_buffer_create: Function creates a VkCommandPool handle then allocates VkCommandBuffer handles from
+ *                               that pool. The amount of VkCommandBuffer's allocated is based upon @commandBufferCount.
+ *                               Command buffer level is based upon @level. VkCommandPool flags set
+ *                               VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT
+ *
+ * args:
+ * @uvrvk - pointer to a struct uvr_vk_command_buffer_create_info
+ * return:
+ *    on success struct uvr_vk_command_buffer
+ *    on failure struct uvr_vk_command_buffer { with member nulled }
+ */
+struct uvr_vk_command_buffer uvr_vk_command_buffer_create(struct uvr_vk_command_buffer_create_info *uvrvk);
+
+
+/*
+ * struct uvr_vk_command_buffer_record_info (Underview Renderer Vulkan Command Buffer Record Information)
+ *
+ * members:
+ * @commandBufferCount - Amount of VkCommandBuffer handles allocated
+ * @vkCommandbuffers   - Pointer to an array of struct uvr_vk_command_buffer_handle which contains your actual VkCommandBuffer handles to start writing commands to.
+ * @flags              - https://www.khronos.org/registry/vulkan/specs/1.3-extensions/man/html/VkCommandBufferUsageFlagBits.html
+ * @pInheritanceInfo   - Must be NULL for primary command buffers. For secondary command buffers state inherited from the
+ *                       primary (render pass, subpass, framebuffer). Chain VkCommandBufferInheritanceRenderingInfo in
+ *                       pNext when the primary uses dynamic rendering.
+ * @queryPool          - Optional pointer to a struct uvr_vk_query_pool. If set the frame slot's queries are reset and
+ *                       each command buffer is wrapped in a GPU timing scope named @queryScopeName, begun on record
+ *                       begin and ended on record end. Scopes still open in a command buffer on record end are
+ *                       ended with it. Must be NULL when @pInheritanceInfo is set. May be NULL.
+ * @queryScopeName     - Name of the scope. See uvr_vk_query_pool_scope_begin(3).
+ */
+struct uvr_vk_command_buffer_record_info {
+  uint32_t                             commandBufferCount;
+  struct uvr_vk_command_buffer_handle  *vkCommandbuffers;
+  VkCommandBufferUsageFlagBits         flags;
+  const VkCommandBufferInheritanceInfo *pInheritanceInfo;
+  struct uvr_vk_query_pool             *queryPool;
+  const char                           *queryScopeName;
+};
+
+
+/*
+ * uvr_vk_command_buffer_record_begin: Function starts command buffer recording. Thus, allowing each command buffer to become writeable.
+ *                                     Allowing for the application to write commands into it. Theses commands are later put into a queue
+ *                                     to be sent off to the GPU.
+ *
+ * args:
+ * @uvrvk - pointer to a struct uvr_vk_command_buffer_record_info
+ * return:
+ *    on success 0
+ *    on failure -1
+ */
+int uvr_vk_command_buffer_record_begin(struct uvr_vk_command_buffer_record_info *uvrvk);
+
+
+/*
+ * uvr_vk_command_buffer_record_end: Function stops command buffer to recording. Thus, ending each command buffers ability to accept commands.
+ *
+ * args:
+ * @uvrvk - pointer to a struct uvr_vk_command_buffer_record_info
+ * return:
+ *    on success 0
+ *    on failure -1
+ */
+int uvr_vk_command_buffer_record_end(struct uvr_vk_command_buffer_record_info *uvrvk);
+
+
+/*
+ * struct uvr_vk_command_recorder (Underview Renderer Vulkan Command Recorder)
+ *
+ * members:
+ * @vkDevice           - Logical device used to create command pools/buffers
+ * @dispatch           - Device function table from uvr_vk_device_dispatch_get(3) used on hot paths
+ * @threadCount        - Amount of worker threads recording in parallel
+ * @bufferCount        - Amount of secondary command buffers per worker. Typically one per frame in flight.
+ * @threadCommandbuffs - Pointer to an array of @threadCount struct uvr_vk_command_buffer. Each worker owns its own
+ *                       VkCommandPool as command pools must be externally synchronized.
+ * @threadPool         - Pointer to a struct uvr_utils_thread_pool the workers run on
+ * @recordNs           - Wall time in nanoseconds of the last call to uvr_vk_command_recorder_record(3),
+ *                       from job dispatch through vkCmdExecuteCommands.
+ */
+struct uvr_vk_command_recorder {
+  VkDevice                            vkDevice;
+  const struct uvr_vk_device_dispatch *dispatch;
+  uint32_t                            threadCount;
+  uint32_t                            bufferCount;
+  struct uvr_vk_command_buffer        *threadCommandbuffs;
+  struct uvr_utils_thread_pool        *threadPool;
+  uint64_t                            recordNs;
+};
+
+
+/*
+ * struct uvr_vk_command_recorder_create_info (Underview Renderer Vulkan Command Recorder Create Information)
+ *
+ * members:
+ * @vkDevice         - Must pass a valid active logical device
+ * @queueFamilyIndex - Queue family the primary command buffers are submitted to
+ * @threadCount      - Amount of worker threads to record with
+ * @bufferCount      - Amount of secondary command buffers to allocate per worker
+ */
+struct uvr_vk_command_recorder_create_info {
+  VkDevice vkDevice;
+  uint32_t queueFamilyIndex;
+  uint32_t threadCount;
+  uint32_t bufferCount;
+};
+
+
+/*
+ * uvr_vk_command_recorder_create: Function spawns @threadCount worker threads and creates a VkCommandPool per worker
+ *                                 with @bufferCount secondary command buffers allocated from each.
+ *
+ * args:
+ * @uvrvk - pointer to a struct uvr_vk_command_recorder_create_info
+ * return:
+ *    on success struct uvr_vk_command_recorder
+ *    on failure struct uvr_vk_command_recorder { with member nulled }
+ */
+struct uvr_vk_command_recorder uvr_vk_command_recorder_create(struct uvr_vk_command_recorder_create_info *uvrvk);
+
+
+/*
+ * struct uvr_vk_command_recorder_record_info (Underview Renderer Vulkan Command Recorder Record Information)
+ *
+ * members:
+ * @recorder                  - Pointer to a valid struct uvr_vk_command_recorder
+ * @bufferIndex               - Which of the per worker secondary command buffers to record into [0, @bufferCount)
+ * @vkPrimaryCommandBuffer    - Primary command buffer secondaries are executed from. Must be inside a render pass begun
+ *                              with VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS or a dynamic render pass begun with
+ *                              VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT, i.e. uvr_vk_rendering_begin(3)
+ *                              with struct uvr_vk_rendering_begin_info { member: renderingFlags } set to it.
+ * @renderPass                - Render pass secondaries are recorded for. VK_NULL_HANDLE when using dynamic rendering.
+ * @subpass                   - Subpass index within @renderPass
+ * @framebuffer               - Optional framebuffer secondaries will be executed with. May be VK_NULL_HANDLE.
+ * @pInheritanceRenderingInfo - Attachment formats of the dynamic render pass. Only used if @renderPass is VK_NULL_HANDLE.
+ * @itemCount                 - Amount of work items (i.e. draws) split evenly across workers
+ * @recordFunc                - Called once per worker with a begun secondary command buffer and the worker's
+ *                              [@first, @first + @count) slice of @itemCount. Must not touch another worker's buffer.
+ * @data                      - Passed to @recordFunc
+ */
+struct uvr_vk_command_recorder_record_info {
+  struct uvr_vk_command_recorder                *recorder;
+  uint32_t                                      bufferIndex;
+  VkCommandBuffer                               vkPrimaryCommandBuffer;
+  VkRenderPass                                  renderPass;
+  uint32_t                                      subpass;
+  VkFramebuffer                                 framebuffer;
+  const VkCommandBufferInheritanceRenderingInfo *pInheritanceRenderingInfo;
+  uint32_t                                      itemCount;
+  void                                          (*recordFunc)(VkCommandBuffer cmdBuffer, uint32_t threadIndex,
+                                                              uint32_t first, uint32_t count, void *data);
+  void                                          *data;
+};
+
+
+/*
+ * uvr_vk_command_recorder_record: Function splits @itemCount across worker threads. Each worker begins its secondary
+ *                                 command buffer with inheritance info for the current render pass or dynamic rendering,
+ *                                 calls @recordFunc then ends the buffer. Once all workers join, recorded secondaries are
+ *                                 executed from @vkPrimaryCommandBuffer in worker order via vkCmdExecuteCommands.
+ *
+ * args:
+ * @uvrvk - pointer to a struct uvr_vk_command_recorder_record_info
+ * return:
+ *    on success 0
+ *    on failure -1
+ */
+int uvr_vk_command_recorder_record(struct uvr_vk_command_recorder_record_info *uvrvk);
+
+
+#define UVR_VK_QUERY_MAX_STATISTICS 11
+
+/* Opaque, per frame slot query bookkeeping */
+struct uvr_vk_query_frame;
+struct uvr_vk_query_scope;
+
+/*
+ * struct uvr_vk_query_result (Underview Renderer Vulkan Query Result)
+ *
+ * members:
+ * @name               - Name the scope was opened with
+ * @gpuNs              - GPU time in nanoseconds between scope begin and end
+ * @pipelineStatistics - Counter values for each bit set in struct uvr_vk_query_pool { member: pipelineStatistics }
+ *                       in ascending bit order. Only the first @statisticCount elements are valid.
+ */
+struct uvr_vk_query_result {
+  const char *name;
+  uint64_t   gpuNs;
+  uint64_t   pipelineStatistics[UVR_VK_QUERY_MAX_STATISTICS];
+};
+
+
+/*
+ * struct uvr_vk_query_pool (Underview Renderer Vulkan Query Pool)
+ *
+ * members:
+ * @vkDevice           - Logical device used to create query pools
+ * @dispatch           - Device function table from uvr_vk_device_dispatch_get(3) used on hot paths
+ * @vkTimestampPool    - VkQueryPool of type VK_QUERY_TYPE_TIMESTAMP. Two queries per scope per frame slot.
+ * @vkStatisticsPool   - VkQueryPool of type VK_QUERY_TYPE_PIPELINE_STATISTICS. One query per scope per frame slot.
+ *                       VK_NULL_HANDLE if @pipelineStatistics is zero. Only outermost scopes of a command buffer begin
+ *                       a statistics query, Vulkan forbids two being active at once.
+ * @pipelineStatistics - VkQueryPipelineStatisticFlags gathered per scope
+ * @statisticCount     - Amount of bits set in @pipelineStatistics
+ * @timestampPeriod    - VkPhysicalDeviceLimits::timestampPeriod. Nanoseconds per timestamp tick.
+ * @timestampMask      - Mask of valid timestamp bits for the queue family
+ * @frameCount         - Amount of frame slots. Should match the amount of frames in flight so results are
+ *                       read back @frameCount frames later without stalling.
+ * @maxScopes          - Maximum amount of scopes per frame
+ * @frameIndex         - Frame slot scopes are currently written to
+ * @frameNumber        - Amount of calls to uvr_vk_query_pool_next_frame(3)
+ * @frames             - Pointer to an array of @frameCount per frame slot bookkeeping
+ * @scopes             - Pointer to an array of @frameCount * @maxScopes scopes
+ * @nameCount          - Amount of distinct scope names seen
+ * @names              - Pointer to an array of @maxScopes distinct scope names
+ * @historyLength      - Amount of samples kept per scope name for rolling percentiles
+ * @historyCount       - Pointer to an array of @maxScopes. Total samples written per scope name.
+ * @history            - Pointer to an array of @maxScopes * @historyLength GPU times in nanoseconds
+ * @resultFrameNumber  - @frameNumber the current @results table was recorded in
+ * @resultCount        - Amount of valid elements in @results
+ * @results            - Pointer to an array of @maxScopes. Per frame table of the most recently read back frame.
+ * @nestedLogged       - Set once a nested scope was first opened without a statistics query, so it's only logged once
+ */
+struct uvr_vk_query_pool {
+  VkDevice                            vkDevice;
+  const struct uvr_vk_device_dispatch *dispatch;
+  VkQueryPool                         vkTimestampPool;
+  VkQueryPool                         vkStatisticsPool;
+  VkQueryPipelineStatisticFlags       pipelineStatistics;
+  uint32_t                            statisticCount;
+  float                               timestampPeriod;
+  uint64_t                            timestampMask;
+  uint32_t                            frameCount;
+  uint32_t                            maxScopes;
+  uint32_t                            frameIndex;
+  uint64_t                            frameNumber;
+  struct uvr_vk_query_frame           *frames;
+  struct uvr_vk_query_scope           *scopes;
+  uint32_t                            nameCount;
+  const char                          **names;
+  uint32_t                            historyLength;
+  uint64_t                            *historyCount;
+  uint64_t                            *history;
+  uint64_t                            resultFrameNumber;
+  uint32_t                            resultCount;
+  struct uvr_vk_query_result          *results;
+  bool                                nestedLogged;
+};
+
+
+/*
+ * struct uvr_vk_query_pool_create_info (Underview Renderer Vulkan Query Pool Create Information)
+ *
+ * members:
+ * @vkPhdev            - Must pass a valid VkPhysicalDevice handle. Used to query timestampPeriod.
+ * @vkDevice           - Must pass a valid active logical device
+ * @queueFamilyIndex   - Queue family command buffers containing scopes are submitted to. Used to query timestampValidBits.
+ * @frameCount         - Amount of frame slots. Typically the amount of frames in flight.
+ * @maxScopes          - Maximum amount of scopes recorded per frame
+ * @pipelineStatistics - VkQueryPipelineStatisticFlags to gather per scope. Zero to only gather timestamps.
+ *                       Requires VkPhysicalDeviceFeatures { member: pipelineStatisticsQuery }.
+ * @historyLength      - Amount of samples kept per scope name for rolling percentiles
+ */
+struct uvr_vk_query_pool_create_info {
+  VkPhysicalDevice              vkPhdev;
+  VkDevice                      vkDevice;
+  uint32_t                      queueFamilyIndex;
+  uint32_t                      frameCount;
+  uint32_t                      maxScopes;
+  VkQueryPipelineStatisticFlags pipelineStatistics;
+  uint32_t                      historyLength;
+};
+
+
+/*
+ * uvr_vk_query_pool_create: Function creates timestamp and optionally pipeline statistics VkQueryPool's sized
+ *                           @frameCount * @maxScopes so queries of a frame are only read back once the frame slot
+ *                           comes around again, by which point the GPU has finished with it.
+ *
+ * args:
+ * @uvrvk - pointer to a struct uvr_vk_query_pool_create_info
+ * return:
+ *    on success struct uvr_vk_query_pool
+ *    on failure struct uvr_vk_query_pool { with member nulled }
+ */
+struct uvr_vk_query_pool uvr_vk_query_pool_create(struct uvr_vk_query_pool_create_info *uvrvk);
+
+
+/*
+ * uvr_vk_query_pool_next_frame: Function advances to the next frame slot. Results previously written to that slot are
+ *                               read back without waiting into @results and the per name history. Must be called once
+ *                               per frame after the slot's previous submission has completed (i.e. after
+ *                               uvr_vk_frame_ring_acquire(3)) and before any scopes are opened for the frame.
+ *                               Scopes of the slot that were never ended are logged and left out of @results.
+ *
+ * args:
+ * @uvrvk - pointer to a struct uvr_vk_query_pool
+ * return:
+ *    on success 0
+ *    on failure -1 (results of the slot are unavailable and dropped)
+ */
+int uvr_vk_query_pool_next_frame(struct uvr_vk_query_pool *uvrvk);
+
+
+/*
+ * uvr_vk_query_pool_reset: Function records the reset of the current frame slot's queries into @cmdBuffer. Must be
+ *                          recorded outside of a render pass/dynamic rendering instance into the first command buffer
+ *                          submitted that frame, before any scope is opened. Only the first call per frame records
+ *                          anything. Called by uvr_vk_command_buffer_record_begin(3) when a query pool is passed.
+ *
+ * args:
+ * @uvrvk     - pointer to a struct uvr_vk_query_pool
+ * @cmdBuffer - Command buffer in the recording state
+ */
+void uvr_vk_query_pool_reset(struct uvr_vk_query_pool *uvrvk, VkCommandBuffer cmdBuffer);
+
+
+/*
+ * uvr_vk_query_pool_scope_begin: Function writes a begin timestamp and begins a pipeline statistics query in @cmdBuffer.
+ *                                Scopes nested inside another open scope of @cmdBuffer only gather timestamps, their
+ *                                statistics read back as zero. Statistics queries must begin and end in the same render
+ *                                pass instance/subpass or both outside of one.
+ *
+ * args:
+ * @uvrvk     - pointer to a struct uvr_vk_query_pool
+ * @cmdBuffer - Command buffer in the recording state
+ * @name      - Name of the scope. Pointer is stored, must stay valid for the lifetime of the pool (i.e. string literal)
+ * return:
+ *    on success scope id
+ *    on failure -1 (no scopes left this frame or uvr_vk_query_pool_reset(3) not yet recorded this frame)
+ */
+int uvr_vk_query_pool_scope_begin(struct uvr_vk_query_pool *uvrvk, VkCommandBuffer cmdBuffer, const char *name);
+
+
+/*
+ * uvr_vk_query_pool_scope_end: Function ends a pipeline statistics query and writes an end timestamp in @cmdBuffer.
+ *
+ * args:
+ * @uvrvk     - pointer to a struct uvr_vk_query_pool
+ * @cmdBuffer - Command buffer the scope was begun in
+ * @scopeId   - Id returned by uvr_vk_query_pool_scope_begin(3). -1 ends the most recently begun open scope in @cmdBuffer.
+ * return:
+ *    on success the id of the scope ended
+ *    on failure -1 (no such open scope)
+ */
+int uvr_vk_query_pool_scope_end(struct uvr_vk_query_pool *uvrvk, VkCommandBuffer cmdBuffer, int scopeId);
+
+
+/*
+ * struct uvr_vk_query_percentiles (Underview Renderer Vulkan Query Percentiles)
+ *
+ * members:
+ * @sampleCount - Amount of samples the percentiles were computed over
+ * @minNs       - Smallest GPU time in nanoseconds
+ * @p50Ns       - 50th percentile GPU time in nanoseconds
+ * @p90Ns       - 90th percentile GPU time in nanoseconds
+ * @p99Ns       - 99th percentile GPU time in nanoseconds
+ * @maxNs       - Largest GPU time in nanoseconds
+ */
+struct uvr_vk_query_percentiles {
+  uint32_t sampleCount;
+  uint64_t minNs;
+  uint64_t p50Ns;
+  uint64_t p90Ns;
+  uint64_t p99Ns;
+  uint64_t maxNs;
+};
+
+
+/*
+ * uvr_vk_query_pool_get_percentiles: Function computes rolling percentiles over the last @historyLength samples of a scope.
+ *
+ * args:
+ * @uvrvk - pointer to a struct uvr_vk_query_pool
+ * @name  - Name of the scope
+ * return:
+ *    on success struct uvr_vk_query_percentiles
+ *    on failure struct uvr_vk_query_percentiles { with member zeroed }
+ */
+struct uvr_vk_query_percentiles uvr_vk_query_pool_get_percentiles(struct uvr_vk_query_pool *uvrvk, const char *name);
+
+
+/*
+ * struct uvr_vk_fence_handle (Underview Renderer Vulkan Fence Handle)
+ *
+ * @fence - May be used to insert a dependency from a queue to the host. Used to block host (CPU) operations
+ *          until commands in a command buffer are finished. Keeps CPU and GPU in sync.
+ */
+struct uvr_vk_fence_handle {
+  VkFence fence;
+};
+
+
+/*
+ * struct uvr_vk_semaphore_handle (Underview Renderer Vulkan Semaphore Handle)
+ *
+ * @semaphore - May be used to insert a dependency between queue operations or between a queue operation
+ *              and the host. Used to block queue operations until commands in a command buffer are finished.
+ */
+struct uvr_vk_semaphore_handle {
+  VkSemaphore semaphore;
+};
+
+
+/*
+ * struct uvr_vk_sync_obj (Underview Renderer Vulkan Synchronization Objects)
+ *
+ * members:
+ * @vkDevice       - Logical device used to create command pool/buffers
+ * @fenceCount     - Amount of handles in @vkFence array
+ * @vkFences       - Pointer to an array of VkFence handles
+ * @semaphoreCount - Amount of handles in @vkSemaphore array
+ * @vkSemaphores   - Pointer to an array of VkSemaphore handles
+ * @semaphoreType  - Type of every semaphore in @vkSemaphores (VK_SEMAPHORE_TYPE_BINARY or VK_SEMAPHORE_TYPE_TIMELINE)
+ */
+struct uvr_vk_sync_obj {
+  VkDevice vkDevice;
+  uint32_t fenceCount;
+  struct uvr_vk_fence_handle *vkFences;
+  uint32_t semaphoreCount;
+  struct uvr_vk_semaphore_handle *vkSemaphores;
+  VkSemaphoreType semaphoreType;
+};
+
+
+/*
+ * struct uvr_vk_sync_obj_create_info (Underview Renderer Vulkan Command Buffer Create Information)
+ *
+ * members:
+ * @vkDevice       - Must pass a valid active logical device
+ * @fenceCount     - Amount of VkFence objects to allocate.
+ * @semaphoreCount - Amount of VkSemaphore objects to allocate.
+ * @semaphoreType  - VK_SEMAPHORE_TYPE_BINARY or VK_SEMAPHORE_TYPE_TIMELINE. Timeline semaphores hold a monotonically
+ *                   increasing 64-bit counter that can be waited on/signaled from both host and device. A single timeline
+ *                   semaphore per queue can replace an array of per submission fences. Requires
+ *                   VkPhysicalDeviceVulkan12Features { member: timelineSemaphore } to be enabled on the logical device.
+ * @initialValue   - Starting counter value of timeline semaphores. Ignored for binary semaphores.
+ */
+struct uvr_vk_sync_obj_create_info {
+  VkDevice        vkDevice;
+  uint32_t        fenceCount;
+  uint32_t        semaphoreCount;
+  VkSemaphoreType semaphoreType;
+  uint64_t        initialValue;
+};
+
+
+/*
+ * uvr_vk_sync_obj_create: Creates VkFence and VkSemaphore synchronization objects. Vulkan API calls that execute work
+ *                         on the GPU happen asynchronously. Vulkan API function calls return before operations are fully finished.
+ *                         So we need synchronization objects to make sure operations that require other operations to finish can
+ *                         happen after.
+ *
+ *
+ * args:
+ * @uvrvk - pointer to a struct uvr_vk_sync_obj_create_info
+ * return:
+ *    on success struct uvr_vk_sync_obj
+ *    on failure struct uvr_vk_sync_obj { with member nulled }
+ */
+struct uvr_vk_sync_obj uvr_vk_sync_obj_create(struct uvr_vk_sync_obj_create_info *uvrvk);
+
+
+/*
+ * struct uvr_vk_timeline_semaphore_wait_info (Underview Renderer Vulkan Timeline Semaphore Wait Information)
+ *
+ * members:
+ * @vkDevice       - Logical device used to create the semaphores
+ * @semaphoreCount - Amount of elements in @pSemaphores and @pValues
+ * @pSemaphores    - Pointer to an array of timeline VkSemaphore handles
+ * @pValues        - Pointer to an array of counter values to wait for. Element i is paired with @pSemaphores[i].
+ * @waitAny        - If VK_TRUE return once any semaphore reaches its value, otherwise wait for all of them.
+ * @timeout        - Timeout in nanoseconds. UINT64_MAX waits forever, 0 polls.
+ */
+struct uvr_vk_timeline_semaphore_wait_info {
+  VkDevice          vkDevice;
+  uint32_t          semaphoreCount;
+  const VkSemaphore *pSemaphores;
+  const uint64_t    *pValues;
+  VkBool32          waitAny;
+  uint64_t          timeout;
+};
+
+
+/*
+ * uvr_vk_timeline_semaphore_wait: Function blocks the host until timeline semaphores reach given counter values.
+ *
+ * args:
+ * @uvrvk - pointer to a struct uvr_vk_timeline_semaphore_wait_info
+ * return:
+ *    VkResult returned by vkWaitSemaphores. VK_SUCCESS or VK_TIMEOUT on a valid call.
+ */
+VkResult uvr_vk_timeline_semaphore_wait(struct uvr_vk_timeline_semaphore_wait_info *uvrvk);
+
+
+/*
+ * uvr_vk_timeline_semaphore_signal: Function sets the counter of a timeline semaphore from the host.
+ *                                   @value must be greater than the semaphore's current value.
+ *
+ * args:
+ * @vkDevice    - Logical device used to create @vkSemaphore
+ * @vkSemaphore - Timeline VkSemaphore handle
+ * @value       - Value to set the counter to
+ * return:
+ *    on success 0
+ *    on failure -1
+ */
+int uvr_vk_timeline_semaphore_signal(VkDevice vkDevice, VkSemaphore vkSemaphore, uint64_t value);
+
+
+/*
+ * uvr_vk_timeline_semaphore_get_value: Function queries the current counter of a timeline semaphore.
+ *
+ * args:
+ * @vkDevice    - Logical device used to create @vkSemaphore
+ * @vkSemaphore - Timeline VkSemaphore handle
+ * @value       - Pointer to a uint64_t populated with the current counter value
+ * return:
+ *    on success 0
+ *    on failure -1
+ */
+int uvr_vk_timeline_semaphore_get_value(VkDevice vkDevice, VkSemaphore vkSemaphore, uint64_t *value);
+
+
+/*
+ * struct uvr_vk_semaphore_submit (Underview Renderer Vulkan Semaphore Submit)
+ *
+ * members:
+ * @semaphore - VkSemaphore handle to wait on or signal. May be binary or timeline.
+ * @value     - Counter value to wait for/signal. Ignored for binary semaphores.
+ * @stageMask - Pipeline stages that wait on @semaphore. Ignored for signal operations.
+ */
+struct uvr_vk_semaphore_submit {
+  VkSemaphore          semaphore;
+  uint64_t             value;
+  VkPipelineStageFlags stageMask;
+};
+
+
+/*
+ * struct uvr_vk_queue_submit_info (Underview Renderer Vulkan Queue Submit Information)
+ *
+ * members:
+ * @vkQueue              - Queue to submit command buffers to
+ * @commandBufferCount   - Amount of elements in @pCommandBuffers
+ * @pCommandBuffers      - Pointer to an array of VkCommandBuffer handles to execute
+ * @waitSemaphoreCount   - Amount of elements in @pWaitSemaphores
+ * @pWaitSemaphores      - Pointer to an array of (semaphore, value) pairs to wait on before execution
+ * @signalSemaphoreCount - Amount of elements in @pSignalSemaphores
+ * @pSignalSemaphores    - Pointer to an array of (semaphore, value) pairs signaled once execution completes
+ * @vkFence              - Optional VkFence signaled once execution completes. May be VK_NULL_HANDLE.
+ */
+struct uvr_vk_queue_submit_info {
+  VkQueue                              vkQueue;
+  uint32_t                             commandBufferCount;
+  const VkCommandBuffer                *pCommandBuffers;
+  uint32_t                             waitSemaphoreCount;
+  const struct uvr_vk_semaphore_submit *pWaitSemaphores;
+  uint32_t                             signalSemaphoreCount;
+  const struct uvr_vk_semaphore_submit *pSignalSemaphores;
+  VkFence                              vkFence;
+};
+
+
+/*
+ * uvr_vk_queue_submit: Function submits command buffers to a queue. Binary and timeline semaphores may be mixed,
+ *                      timeline values are passed through VkTimelineSemaphoreSubmitInfo.
+ *
+ * args:
+ * @uvrvk - pointer to a struct uvr_vk_queue_submit_info
+ * return:
+ *    on success 0
+ *    on failure -1
+ */
+int uvr_vk_queue_submit(struct uvr_vk_queue_submit_info *uvrvk);
+
+
+/* Opaque swapchain (plus dependent objects) awaiting destruction after uvr_vk_swapchain_recreate(3) */
+struct uvr_vk_swapchain_retired;
+
+
+/*
+ * struct uvr_vk_frame_ring (Underview Renderer Vulkan Frame Ring)
+ *
+ * members:
+ * @vkDevice           - Logical device used to create the ring's command pool/buffers and synchronization objects
+ * @dispatch           - Device function table from uvr_vk_device_dispatch_get(3) used on hot paths
+ * @vkQueue            - Queue frames are submitted and presented on
+ * @vkSwapchain        - Swapchain images are acquired from
+ * @frameCount         - Amount of frames that may be in flight at once
+ * @imageCount         - Amount of images in @vkSwapchain
+ * @frameIndex         - Frame slot [0, @frameCount) currently being recorded
+ * @imageIndex         - Swapchain image acquired by the last successful call to uvr_vk_frame_ring_acquire(3)
+ * @frameNumber        - Amount of frames presented since ring creation
+ * @vkCommandbuffs     - Stores @frameCount primary command buffers. One per frame slot.
+ * @vkSyncs            - Stores @frameCount VkFence's followed by @frameCount VkSemaphore's signaled on image
+ *                       acquisition per frame slot.
+ * @vkPresentSyncs     - Stores @imageCount VkSemaphore's signaled on render completion per swapchain image and
+ *                       waited on by the presentation engine. Replaced by uvr_vk_swapchain_recreate(3).
+ * @imageFences        - Pointer to an array of @imageCount VkFence handles. Stores fence of the frame that last
+ *                       rendered to a given swapchain image. Prevents an image being reused while in flight when
+ *                       @frameCount is greater than @imageCount or images are acquired out of order.
+ * @cpuWaitNs          - Time in nanoseconds the CPU spent blocked in the last uvr_vk_frame_ring_acquire(3)
+ * @cpuWaitTotalNs     - Accumulated time in nanoseconds the CPU spent blocked on frame/image fences
+ * @cpuWaitMaxNs       - Largest single frame CPU wait in nanoseconds
+ * @retiredCount       - Amount of elements in @retired
+ * @retired            - Swapchains replaced by uvr_vk_swapchain_recreate(3) along with their image views, framebuffers
+ *                       and present semaphores. Destroyed once every frame submitted before the replacement retired.
+ * @resizePending      - Set by uvr_vk_swapchain_recreate(3), cleared by the first successful present afterwards
+ * @resizeStart        - Time the resize that's pending was requested
+ * @resizeCount        - Amount of swapchain recreations
+ * @resizeLatencyNs    - Time in nanoseconds from the last resize request to the first frame presented afterwards
+ * @resizeLatencyMaxNs - Largest @resizeLatencyNs observed
+ */
+struct uvr_vk_frame_ring {
+  VkDevice                            vkDevice;
+  const struct uvr_vk_device_dispatch *dispatch;
+  VkQueue                             vkQueue;
+  VkSwapchainKHR                      vkSwapchain;
+  uint32_t                            frameCount;
+  uint32_t                            imageCount;
+  uint32_t                            frameIndex;
+  uint32_t                            imageIndex;
+  uint64_t                            frameNumber;
+  struct uvr_vk_command_buffer        vkCommandbuffs;
+  struct uvr_vk_sync_obj              vkSyncs;
+  struct uvr_vk_sync_obj              vkPresentSyncs;
+  VkFence                             *imageFences;
+  uint64_t                            cpuWaitNs;
+  uint64_t                            cpuWaitTotalNs;
+  uint64_t                            cpuWaitMaxNs;
+  uint32_t                            retiredCount;
+  struct uvr_vk_swapchain_retired     *retired;
+  bool                                resizePending;
+  struct timespec                     resizeStart;
+  uint64_t                            resizeCount;
+  uint64_t                            resizeLatencyNs;
+  uint64_t                            resizeLatencyMaxNs;
+};
+
+
+/*
+ * struct uvr_vk_frame_ring_create_info (Underview Renderer Vulkan Frame Ring Create Information)
+ *
+ * members:
+ * @vkDevice         - Must pass a valid active logical device
+ * @vkQueue          - Must pass a valid VkQueue handle that supports graphics and presentation
+ * @queueFamilyIndex - Queue family @vkQueue belongs to. Command pool is created for this family.
+ * @vkSwapchain      - Must pass a valid VkSwapchainKHR handle
+ * @frameCount       - Amount of frames allowed in flight. Typically 2 or 3. A value of 1 serializes CPU and GPU.
+ */
+struct uvr_vk_frame_ring_create_info {
+  VkDevice       vkDevice;
+  VkQueue        vkQueue;
+  uint32_t       queueFamilyIndex;
+  VkSwapchainKHR vkSwapchain;
+  uint32_t       frameCount;
+};
+
+
+/*
+ * uvr_vk_frame_ring_create: Function creates per frame command buffers, fences and image acquisition semaphores
+ *                           along with per swapchain image render completion semaphores. Allows the CPU to record
+ *                           frame N + 1 while the GPU is still executing frame N.
+ *
+ * args:
+ * @uvrvk - pointer to a struct uvr_vk_frame_ring_create_info
+ * return:
+ *    on success struct uvr_vk_frame_ring
+ *    on failure struct uvr_vk_frame_ring { with member nulled }
+ */
+struct uvr_vk_frame_ring uvr_vk_frame_ring_create(struct uvr_vk_frame_ring_create_info *uvrvk);
+
+
+/*
+ * struct uvr_vk_frame (Underview Renderer Vulkan Frame)
+ *
+ * members:
+ * @frameIndex      - Frame slot the command buffer belongs to
+ * @imageIndex      - Index of the acquired swapchain image. Use to select framebuffer/image view.
+ * @vkCommandBuffer - Command buffer owned by the frame slot. Safe to reset/re-record, previous use has completed.
+ */
+struct uvr_vk_frame {
+  uint32_t        frameIndex;
+  uint32_t        imageIndex;
+  VkCommandBuffer vkCommandBuffer;
+};
+
+
+/*
+ * uvr_vk_frame_ring_acquire: Function waits for the current frame slot's previous submission to finish,
+ *                            acquires the next swapchain image then waits for any other frame still
+ *                            rendering to that image. Time blocked is recorded in @cpuWaitNs.
+ *                            Retired swapchains no frame in flight references anymore are destroyed.
+ *
+ * args:
+ * @ring  - pointer to a struct uvr_vk_frame_ring
+ * @frame - pointer to a struct uvr_vk_frame populated with the frame to record
+ * return:
+ *    VkResult returned by vkAcquireNextImageKHR. VK_SUCCESS and VK_SUBOPTIMAL_KHR populate @frame.
+ *    VK_ERROR_OUT_OF_DATE_KHR signals the swapchain must be recreated before rendering.
+ */
+VkResult uvr_vk_frame_ring_acquire(struct uvr_vk_frame_ring *ring, struct uvr_vk_frame *frame);
+
+
+/*
+ * uvr_vk_frame_ring_submit: Function submits the current frame slot's command buffer. Submission waits on
+ *                           image acquisition at VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, signals the
+ *                           acquired image's render completion semaphore and the frame slot's fence.
+ *                           On failure the frame was already abandoned via uvr_vk_frame_ring_abandon(3).
+ *
+ * args:
+ * @ring - pointer to a struct uvr_vk_frame_ring
+ * return:
+ *    on success 0
+ *    on failure -1
+ */
+int uvr_vk_frame_ring_submit(struct uvr_vk_frame_ring *ring);
+
+
+/*
+ * uvr_vk_frame_ring_abandon: Function gives up on the frame acquired by the last uvr_vk_frame_ring_acquire(3)
+ *                            when it can't be recorded or submitted. An empty submission waits on the slot's
+ *                            acquire semaphore and signals its fence, so the next acquire of the slot is valid.
+ *                            uvr_vk_frame_ring_submit(3) does this itself when it fails. Don't call
+ *                            uvr_vk_frame_ring_present(3) for an abandoned frame. Its image stays acquired until
+ *                            the swapchain is recreated, so frames abandoned repeatedly exhaust the swapchain.
+ *
+ * args:
+ * @ring - pointer to a struct uvr_vk_frame_ring
+ * return:
+ *    on success 0
+ *    on failure -1
+ */
+int uvr_vk_frame_ring_abandon(struct uvr_vk_frame_ring *ring);
+
+
+/*
+ * uvr_vk_frame_ring_present: Function queues the acquired image for presentation then advances the ring
+ *                            to the next frame slot.
+ *
+ * args:
+ * @ring - pointer to a struct uvr_vk_frame_ring
+ * return:
+ *    VkResult returned by vkQueuePresentKHR
+ */
+VkResult uvr_vk_frame_ring_present(struct uvr_vk_frame_ring *ring);
+
+
+/*
+ * enum uvr_vk_swapchain_change (Underview Renderer Vulkan Swapchain Change)
+ *
+ * Bitmask returned by uvr_vk_swapchain_recreate(3) describing which swapchain properties changed.
+ * Objects depending on a property that didn't change may be kept as is.
+ *
+ * UVR_VK_SWAPCHAIN_EXTENT_CHANGED - Image extent changed. Rebuild size dependent render targets, static viewports.
+ * UVR_VK_SWAPCHAIN_FORMAT_CHANGED - Image format/colorSpace changed. Rebuild VkRenderPass's and graphics pipelines
+ *                                   created against the old format.
+ * UVR_VK_SWAPCHAIN_COUNT_CHANGED  - Amount of swapchain images changed
+ */
+typedef enum uvr_vk_swapchain_change {
+  UVR_VK_SWAPCHAIN_EXTENT_CHANGED = (1 << 0),
+  UVR_VK_SWAPCHAIN_FORMAT_CHANGED = (1 << 1),
+  UVR_VK_SWAPCHAIN_COUNT_CHANGED  = (1 << 2),
+} uvr_vk_swapchain_change;
+
+
+/*
+ * struct uvr_vk_swapchain_recreate_info (Underview Renderer Vulkan Swapchain Recreate Information)
+ *
+ * members:
+ * @frameRing           - Must pass a pointer to the struct uvr_vk_frame_ring presenting to @swapchain.
+ *                        Retargeted to the new swapchain.
+ * @swapchain           - Must pass a pointer to the current struct uvr_vk_swapchain. Populated with the new swapchain.
+ * @images              - Must pass a pointer to the struct uvr_vk_image of @swapchain. Populated with the new
+ *                        swapchain's images and views.
+ * @framebuffer         - Optional pointer to a struct uvr_vk_framebuffer created from @images. If not NULL populated
+ *                        with framebuffers created against the new image views. NULL when dynamic rendering is used.
+ * @renderPass          - VkRenderPass new framebuffers are compatible with. Ignored if @framebuffer is NULL.
+ * @swapchainCreateInfo - Must pass a pointer to a struct uvr_vk_swapchain_create_info with freshly queried surface
+ *                        capabilities. Member oldSwapchain is set by the function.
+ * @imageCreateInfo     - Must pass a pointer to the struct uvr_vk_image_create_info @images was created with.
+ *                        Members vkSwapchain and format are set by the function.
+ * @pConfigureTime      - Optional time (CLOCK_MONOTONIC) the window system reported the resize. Used as the start of
+ *                        struct uvr_vk_frame_ring { member: resizeLatencyNs }. If NULL the time of the call is used.
+ */
+struct uvr_vk_swapchain_recreate_info {
+  struct uvr_vk_frame_ring            *frameRing;
+  struct uvr_vk_swapchain             *swapchain;
+  struct uvr_vk_image                 *images;
+  struct uvr_vk_framebuffer           *framebuffer;
+  VkRenderPass                        renderPass;
+  struct uvr_vk_swapchain_create_info *swapchainCreateInfo;
+  struct uvr_vk_image_create_info     *imageCreateInfo;
+  const struct timespec               *pConfigureTime;
+};
+
+
+/*
+ * uvr_vk_swapchain_recreate: Creates a new swapchain passing the current one as oldSwapchain so the presentation
+ *                            engine may hand over images without a gap. Old swapchain, image views, framebuffers and
+ *                            present semaphores are retired into struct uvr_vk_frame_ring { member: retired } instead
+ *                            of idling the device, they're destroyed by uvr_vk_frame_ring_acquire(3) once the last
+ *                            frame referencing them completed. Call after uvr_vk_frame_ring_acquire(3) returned
+ *                            VK_ERROR_OUT_OF_DATE_KHR or after uvr_vk_frame_ring_present(3), never between an acquire
+ *                            that succeeded and its present.
+ *
+ * args:
+ * @uvrvk - pointer to a struct uvr_vk_swapchain_recreate_info
+ * return:
+ *    on success bitmask of enum uvr_vk_swapchain_change (0 if nothing but the handles changed)
+ *    on failure -1
+ */
+int uvr_vk_swapchain_recreate(struct uvr_vk_swapchain_recreate_info *uvrvk);
+
+
+/* Opaque, per swapchain image recorded command buffer and the dependencies it was recorded against */
+struct uvr_vk_command_replay_image;
+
+
+#define UVR_VK_COMMAND_REPLAY_ALL_IMAGES UINT32_MAX
+#define UVR_VK_COMMAND_REPLAY_DEP_COUNT 5
+
+/*
+ * enum uvr_vk_command_replay_dep (Underview Renderer Vulkan Command Replay Dependency)
+ *
+ * Bitmask describing why a swapchain image's command buffer must be re-recorded.
+ *
+ * UVR_VK_COMMAND_REPLAY_DEP_FRAMEBUFFER - Framebuffer or dynamic rendering image view rendered to changed
+ * UVR_VK_COMMAND_REPLAY_DEP_PIPELINE    - Bound graphics pipeline changed
+ * UVR_VK_COMMAND_REPLAY_DEP_EXTENT      - Render area extent changed
+ * UVR_VK_COMMAND_REPLAY_DEP_RESOURCES   - Application defined resource key changed
+ * UVR_VK_COMMAND_REPLAY_DEP_INVALIDATED - Image was never recorded, its last recording failed or it was invalidated
+ *                                         via uvr_vk_command_replay_invalidate(3)
+ */
+typedef enum uvr_vk_command_replay_dep {
+  UVR_VK_COMMAND_REPLAY_DEP_FRAMEBUFFER = (1 << 0),
+  UVR_VK_COMMAND_REPLAY_DEP_PIPELINE    = (1 << 1),
+  UVR_VK_COMMAND_REPLAY_DEP_EXTENT      = (1 << 2),
+  UVR_VK_COMMAND_REPLAY_DEP_RESOURCES   = (1 << 3),
+  UVR_VK_COMMAND_REPLAY_DEP_INVALIDATED = (1 << 4),
+} uvr_vk_command_replay_dep;
+
+
+/*
+ * struct uvr_vk_command_replay (Underview Renderer Vulkan Command Replay)
+ *
+ * Keeps one primary command buffer per swapchain image recorded once and resubmitted every frame the image
+ * is acquired, until a dependency it was recorded against changes.
+ *
+ * members:
+ * @vkDevice         - Logical device used to create the command pool
+ * @dispatch         - Device function table from uvr_vk_device_dispatch_get(3) used on hot paths
+ * @vkCommandPool    - Pool per image command buffers are allocated from
+ * @imageCount       - Amount of elements in @images. Grows if the swapchain is recreated with more images.
+ * @images           - Per swapchain image command buffer and dependency snapshot
+ * @frameStart       - Time of the last call to uvr_vk_command_replay_acquire(3)
+ * @frameCount       - Amount of frames submitted through uvr_vk_command_replay_submit(3)
+ * @recordCount      - Amount of frames that re-recorded their command buffer
+ * @invalidateCount  - Amount of command buffers marked for re-recording by uvr_vk_command_replay_invalidate(3)
+ * @changeCounts     - Amount of re-recordings caused by each enum uvr_vk_command_replay_dep bit, in ascending bit order
+ * @recordCpuNs      - Accumulated CPU time in nanoseconds from acquire through submit of frames that re-recorded
+ * @replayCpuNs      - Accumulated CPU time in nanoseconds from acquire through submit of frames that replayed
+ * @cpuMaxNs         - Largest single frame CPU time in nanoseconds from acquire through submit
+ * @queryPool        - Optional struct uvr_vk_query_pool replayed frames are timed with. May be NULL.
+ * @queryScopeName   - Name of the scope wrapping each submitted frame
+ * @queryBufferCount - Amount of elements in @vkQueryBuffers. Two per frame slot.
+ * @vkQueryBuffers   - Per frame slot command buffers submitted before and after the image's buffer.
+ *                     The first resets the slot's queries and begins the scope, the second ends it.
+ */
+struct uvr_vk_command_replay {
+  VkDevice                            vkDevice;
+  const struct uvr_vk_device_dispatch *dispatch;
+  VkCommandPool                       vkCommandPool;
+  uint32_t                            imageCount;
+  struct uvr_vk_command_replay_image  *images;
+  struct timespec                     frameStart;
+  uint64_t                            frameCount;
+  uint64_t                            recordCount;
+  uint64_t                            invalidateCount;
+  uint64_t                            changeCounts[UVR_VK_COMMAND_REPLAY_DEP_COUNT];
+  uint64_t                            recordCpuNs;
+  uint64_t                            replayCpuNs;
+  uint64_t                            cpuMaxNs;
+  struct uvr_vk_query_pool            *queryPool;
+  const char                          *queryScopeName;
+  uint32_t                            queryBufferCount;
+  VkCommandBuffer                     *vkQueryBuffers;
+};
+
+
+/*
+ * struct uvr_vk_command_replay_create_info (Underview Renderer Vulkan Command Replay Create Information)
+ *
+ * members:
+ * @vkDevice         - Must pass a valid active logical device
+ * @queueFamilyIndex - Queue family the frame ring submits to. Command pool is created for this family.
+ * @imageCount       - Amount of swapchain images. See struct uvr_vk_frame_ring { member: imageCount }.
+ * @queryPool        - Optional pointer to a struct uvr_vk_query_pool created without pipeline statistics, which
+ *                     can't span command buffers. If set every submitted frame is wrapped in a GPU timing scope
+ *                     named @queryScopeName recorded outside the replayed buffer. May be NULL.
+ * @queryScopeName   - Name of the scope. See uvr_vk_query_pool_scope_begin(3).
+ */
+struct uvr_vk_command_replay_create_info {
+  VkDevice                 vkDevice;
+  uint32_t                 queueFamilyIndex;
+  uint32_t                 imageCount;
+  struct uvr_vk_query_pool *queryPool;
+  const char               *queryScopeName;
+};
+
+
+/*
+ * uvr_vk_command_replay_create: Function creates a VkCommandPool per swapchain image command buffers are allocated
+ *                               from the first time their image gets recorded.
+ *
+ * args:
+ * @uvrvk - pointer to a struct uvr_vk_command_replay_create_info
+ * return:
+ *    on success struct uvr_vk_command_replay
+ *    on failure struct uvr_vk_command_replay { with member nulled }
+ */
+struct uvr_vk_command_replay uvr_vk_command_replay_create(struct uvr_vk_command_replay_create_info *uvrvk);
+
+
+/*
+ * struct uvr_vk_command_replay_deps (Underview Renderer Vulkan Command Replay Dependencies)
+ *
+ * Everything a recorded command buffer baked in. Compared against the snapshot taken when the acquired image
+ * was last recorded.
+ *
+ * members:
+ * @framebuffer - VkFramebuffer rendered to. VK_NULL_HANDLE when dynamic rendering is used.
+ * @imageView   - Color attachment rendered to with dynamic rendering. VK_NULL_HANDLE when @framebuffer is used.
+ * @pipeline    - Graphics pipeline bound by the recorded commands
+ * @extent      - Render area, viewport and scissor extent
+ * @resourceKey - Application defined value identifying bound resources (descriptor sets, vertex/index buffers,
+ *                push constant contents). i.e. a generation counter bumped whenever one of them is replaced.
+ */
+struct uvr_vk_command_replay_deps {
+  VkFramebuffer framebuffer;
+  VkImageView   imageView;
+  VkPipeline    pipeline;
+  VkExtent2D    extent;
+  uint64_t      resourceKey;
+};
+
+
+/*
+ * struct uvr_vk_command_replay_frame (Underview Renderer Vulkan Command Replay Frame)
+ *
+ * members:
+ * @imageIndex      - Swapchain image the command buffer renders to
+ * @vkCommandBuffer - Command buffer submitted for @imageIndex
+ * @changed         - Bitmask of enum uvr_vk_command_replay_dep. If zero @vkCommandBuffer is replayed as is.
+ *                    Otherwise it's begun and the application must record the frame's commands into it.
+ */
+struct uvr_vk_command_replay_frame {
+  uint32_t        imageIndex;
+  VkCommandBuffer vkCommandBuffer;
+  uint32_t        changed;
+};
+
+
+/*
+ * uvr_vk_command_replay_acquire: Function compares @deps against the dependencies the image acquired by
+ *                                uvr_vk_frame_ring_acquire(3) was last recorded with. On a match the recorded
+ *                                command buffer is handed back for replay. On a mismatch the function waits for
+ *                                the buffer's last submission, if still pending, then begins it for re-recording.
+ *                                Recorded commands must not open struct uvr_vk_query_pool scopes, as query slots
+ *                                are per frame slot not per image. Pass one at creation to time frames instead.
+ *
+ * args:
+ * @replay - pointer to a struct uvr_vk_command_replay
+ * @ring   - pointer to the struct uvr_vk_frame_ring the image was acquired from
+ * @deps   - pointer to a struct uvr_vk_command_replay_deps describing what the image's commands depend on
+ * @frame  - pointer to a struct uvr_vk_command_replay_frame populated with the command buffer to submit
+ * return:
+ *    on success 0
+ *    on failure -1
+ */
+int uvr_vk_command_replay_acquire(struct uvr_vk_command_replay *replay, struct uvr_vk_frame_ring *ring,
+                                  const struct uvr_vk_command_replay_deps *deps,
+                                  struct uvr_vk_command_replay_frame *frame);
+
+
+/*
+ * uvr_vk_command_replay_submit: Function ends recording if @frame was re-recorded, storing the dependency
+ *                               snapshot, then submits @frame's command buffer in place of the frame slot's
+ *                               one with the same synchronization as uvr_vk_frame_ring_submit(3). With a query
+ *                               pool it's submitted between the frame slot's scope begin and end buffers,
+ *                               uvr_vk_query_pool_next_frame(3) must have been called after the ring's acquire.
+ *                               On failure the frame was already abandoned via uvr_vk_frame_ring_abandon(3).
+ *
+ * args:
+ * @replay - pointer to a struct uvr_vk_command_replay
+ * @ring   - pointer to the struct uvr_vk_frame_ring passed to uvr_vk_command_replay_acquire(3)
+ * @frame  - pointer to the struct uvr_vk_command_replay_frame populated by uvr_vk_command_replay_acquire(3)
+ * return:
+ *    on success 0
+ *    on failure -1
+ */
+int uvr_vk_command_replay_submit(struct uvr_vk_command_replay *replay, struct uvr_vk_frame_ring *ring,
+                                 struct uvr_vk_command_replay_frame *frame);
+
+
+/*
+ * uvr_vk_command_replay_invalidate: Function marks a swapchain image's command buffer for re-recording the next
+ *                                   time it's acquired. Use when recorded state changed in a way not captured by
+ *                                   struct uvr_vk_command_replay_deps.
+ *
+ * args:
+ * @replay     - pointer to a struct uvr_vk_command_replay
+ * @imageIndex - Swapchain image to invalidate or UVR_VK_COMMAND_REPLAY_ALL_IMAGES
+ */
+void uvr_vk_command_replay_invalidate(struct uvr_vk_command_replay *replay, uint32_t imageIndex);
+
+
+/*
+ * struct uvr_vk_command_replay_stats (Underview Renderer Vulkan Command Replay Statistics)
+ *
+ * members:
+ * @frameCount       - Amount of frames submitted
+ * @recordCount      - Amount of frames that re-recorded their command buffer
+ * @replayCount      - Amount of frames that replayed a recorded command buffer
+ * @framebufferCount - Amount of re-recordings caused by UVR_VK_COMMAND_REPLAY_DEP_FRAMEBUFFER
+ * @pipelineCount    - Amount of re-recordings caused by UVR_VK_COMMAND_REPLAY_DEP_PIPELINE
+ * @extentCount      - Amount of re-recordings caused by UVR_VK_COMMAND_REPLAY_DEP_EXTENT
+ * @resourceCount    - Amount of re-recordings caused by UVR_VK_COMMAND_REPLAY_DEP_RESOURCES
+ * @invalidateCount  - Amount of command buffers marked by uvr_vk_command_replay_invalidate(3)
+ * @recordCpuMs      - Average CPU time in milliseconds per frame that re-recorded, acquire through submit
+ * @replayCpuMs      - Average CPU time in milliseconds per frame that replayed, acquire through submit
+ * @cpuMaxMs         - Largest single frame CPU time in milliseconds
+ */
+struct uvr_vk_command_replay_stats {
+  uint64_t frameCount;
+  uint64_t recordCount;
+  uint64_t replayCount;
+  uint64_t framebufferCount;
+  uint64_t pipelineCount;
+  uint64_t extentCount;
+  uint64_t resourceCount;
+  uint64_t invalidateCount;
+  double   recordCpuMs;
+  double   replayCpuMs;
+  double   cpuMaxMs;
+};
+
+
+/*
+ * uvr_vk_command_replay_get_stats: Function returns re-record/replay counts along with the CPU time per frame of
+ *                                  frames that re-recorded versus frames that replayed
+ *
+ * args:
+ * @replay - pointer to a struct uvr_vk_command_replay
+ * return:
+ *    struct uvr_vk_command_replay_stats
+ */
+struct uvr_vk_command_replay_stats uvr_vk_command_replay_get_stats(struct uvr_vk_command_replay *replay);
+
+
+/*
+ * uvr_vk_headless_readback_cb: Invoked with the pixels of a frame read back by a struct uvr_vk_headless_target
+ *
+ * args:
+ * @userData    - Pointer passed as struct uvr_vk_headless_target_create_info { member: readbackUserData }
+ * @frameNumber - Frame the pixels belong to (value of struct uvr_vk_headless_target { member: frameNumber } at present)
+ * @pixels      - Host address of tightly packed rows. Only valid until the callback returns.
+ * @extent2D    - Width and height of the frame in pixels
+ * @rowPitch    - Size in bytes of one row of @pixels
+ */
+typedef void (*uvr_vk_headless_readback_cb)(void *userData, uint64_t frameNumber, const void *pixels,
+                                            VkExtent2D extent2D, uint32_t rowPitch);
+
+
+/*
+ * struct uvr_vk_headless_target (Underview Renderer Vulkan Headless Target)
+ *
+ * Offscreen stand-in for a VkSurfaceKHR + struct uvr_vk_frame_ring pair. Renders into device local VkImage's,
+ * no display server, window system integration or surface extension is needed.
+ *
+ * members:
+ * @vkDevice         - Logical device used to create the target's images, buffer, command pool and fences
+ * @dispatch         - Device function table from uvr_vk_device_dispatch_get(3) used on hot paths
+ * @vkQueue          - Queue frames and readback copies are submitted to
+ * @format           - Format of @images
+ * @extent2D         - Width and height of @images
+ * @frameCount       - Amount of frames that may be in flight at once. Equals amount of images.
+ * @frameIndex       - Frame slot [0, @frameCount) currently being recorded. Also the index of its image.
+ * @frameNumber      - Amount of frames presented since target creation
+ * @images           - @frameCount color images (plus views). Each frame slot owns one image so image index always
+ *                     equals @frameIndex.
+ * @vkCommandbuffs   - Stores @frameCount primary command buffers handed out by uvr_vk_headless_target_acquire(3)
+ *                     followed by @frameCount command buffers recording readback copies
+ * @vkSyncs          - Stores @frameCount VkFence's. One per frame slot.
+ * @readbackBuffer   - Host visible buffer with one @readbackSize region per frame slot. Mapped for the lifetime
+ *                     of the target. Host cached memory is preferred.
+ * @readbackSize     - Size in bytes of one frame's pixels
+ * @rowPitch         - Size in bytes of one row of pixels
+ * @readbackInterval - Copy every Nth presented frame back to host memory. Zero disables readback.
+ * @readbackLayout   - Layout images are in when the frame's command buffer finished executing
+ * @readback         - Callback pixels are delivered to
+ * @readbackUserData - Passed to @readback
+ * @pendingFrames    - Pointer to an array of @frameCount values. Non-zero if the slot's last submission included a
+ *                     readback. Stores frame number + 1.
+ * @startTime        - CLOCK_MONOTONIC time of the first acquire
+ * @cpuWaitNs        - Accumulated time in nanoseconds the CPU spent blocked on frame fences
+ * @readbackCount    - Amount of frames delivered to @readback
+ * @readbackBytes    - Total bytes delivered to @readback
+ */
+struct uvr_vk_headless_target {
+  VkDevice                            vkDevice;
+  const struct uvr_vk_device_dispatch *dispatch;
+  VkQueue                             vkQueue;
+  VkFormat                            format;
+  VkExtent2D                          extent2D;
+  uint32_t                            frameCount;
+  uint32_t                            frameIndex;
+  uint64_t                            frameNumber;
+  struct uvr_vk_image                 images;
+  struct uvr_vk_command_buffer        vkCommandbuffs;
+  struct uvr_vk_sync_obj              vkSyncs;
+  struct uvr_vk_buffer                readbackBuffer;
+  VkDeviceSize                        readbackSize;
+  uint32_t                            rowPitch;
+  uint32_t                            readbackInterval;
+  VkImageLayout                       readbackLayout;
+  uvr_vk_headless_readback_cb         readback;
+  void                                *readbackUserData;
+  uint64_t                            *pendingFrames;
+  struct timespec                     startTime;
+  uint64_t                            cpuWaitNs;
+  uint64_t                            readbackCount;
+  uint64_t                            readbackBytes;
+};
+
+
+/*
+ * struct uvr_vk_headless_target_create_info (Underview Renderer Vulkan Headless Target Create Information)
+ *
+ * members:
+ * @allocator        - Must pass a pointer to a valid struct uvr_vk_allocator. Images and readback buffer are
+ *                     allocated from it.
+ * @vkQueue          - Must pass a valid VkQueue handle that supports graphics and transfer operations
+ * @queueFamilyIndex - Queue family @vkQueue belongs to. Command pool is created for this family.
+ * @format           - Color format of the render targets. Must be an uncompressed 8, 16 or 32 bit per channel
+ *                     format when readback is enabled.
+ * @extent2D         - Width and height of the render targets
+ * @frameCount       - Amount of frames allowed in flight. Typically 2 or 3.
+ * @imageUsage       - Additional VkImageUsageFlags. COLOR_ATTACHMENT and TRANSFER_SRC are always set.
+ * @readbackInterval - Copy every Nth presented frame back to host memory. 1 reads back every frame, 0 never.
+ * @readbackLayout   - Layout the application leaves images in at the end of the frame's command buffer
+ *                     (i.e. VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL). Transitioned to TRANSFER_SRC_OPTIMAL
+ *                     by the readback copy, so begin rendering with an oldLayout of VK_IMAGE_LAYOUT_UNDEFINED.
+ * @readback         - Callback read back pixels are delivered to. Required if @readbackInterval isn't zero.
+ * @readbackUserData - Passed to @readback
+ */
+struct uvr_vk_headless_target_create_info {
+  struct uvr_vk_allocator     *allocator;
+  VkQueue                     vkQueue;
+  uint32_t                    queueFamilyIndex;
+  VkFormat                    format;
+  VkExtent2D                  extent2D;
+  uint32_t                    frameCount;
+  VkImageUsageFlags           imageUsage;
+  uint32_t                    readbackInterval;
+  VkImageLayout               readbackLayout;
+  uvr_vk_headless_readback_cb readback;
+  void                        *readbackUserData;
+};
+
+
+/*
+ * uvr_vk_headless_target_create: Function creates device local render targets, per frame command buffers and
+ *                                fences along with a persistently mapped readback buffer. Allows running the render
+ *                                loop on hosts without a display server (CI, render farm nodes, lavapipe).
+ *
+ * args:
+ * @uvrvk - pointer to a struct uvr_vk_headless_target_create_info
+ * return:
+ *    on success struct uvr_vk_headless_target
+ *    on failure struct uvr_vk_headless_target { with member nulled }
+ */
+struct uvr_vk_headless_target uvr_vk_headless_target_create(struct uvr_vk_headless_target_create_info *uvrvk);
+
+
+/*
+ * uvr_vk_headless_target_acquire: Counterpart of uvr_vk_frame_ring_acquire(3). Waits for the current frame slot's
+ *                                 previous submission to finish, delivers its pixels to the readback callback if
+ *                                 one was copied then hands out the slot's image and command buffer.
+ *
+ * args:
+ * @target - pointer to a struct uvr_vk_headless_target
+ * @frame  - pointer to a struct uvr_vk_frame populated with the frame to record. Member imageIndex selects
+ *           the image/view of @images to render to.
+ * return:
+ *    VkResult returned by vkWaitForFences
+ */
+VkResult uvr_vk_headless_target_acquire(struct uvr_vk_headless_target *target, struct uvr_vk_frame *frame);
+
+
+/*
+ * uvr_vk_headless_target_submit: Counterpart of uvr_vk_frame_ring_submit(3). Submits the current frame slot's
+ *                                command buffer. No semaphores are involved.
+ *
+ * args:
+ * @target - pointer to a struct uvr_vk_headless_target
+ * return:
+ *    on success 0
+ *    on failure -1
+ */
+int uvr_vk_headless_target_submit(struct uvr_vk_headless_target *target);
+
+
+/*
+ * uvr_vk_headless_target_present: Counterpart of uvr_vk_frame_ring_present(3). If the frame is due a readback
+ *                                 submits a copy of its image into the readback buffer. Signals the frame slot's
+ *                                 fence then advances to the next frame slot. Never blocks, pixels are delivered
+ *                                 @frameCount frames later by uvr_vk_headless_target_acquire(3).
+ *
+ * args:
+ * @target - pointer to a struct uvr_vk_headless_target
+ * return:
+ *    VkResult returned by vkQueueSubmit
+ */
+VkResult uvr_vk_headless_target_present(struct uvr_vk_headless_target *target);
+
+
+/*
+ * uvr_vk_headless_target_drain: Waits for every frame in flight and delivers any outstanding readbacks.
+ *                               Call once the render loop exits so the last @frameCount frames aren't lost.
+ *
+ * args:
+ * @target - pointer to a struct uvr_vk_headless_target
+ */
+void uvr_vk_headless_target_drain(struct uvr_vk_headless_target *target);
+
+
+/*
+ * struct uvr_vk_headless_target_stats (Underview Renderer Vulkan Headless Target Statistics)
+ *
+ * members:
+ * @frameCount          - Amount of frames presented
+ * @framesPerSecond     - @frameCount divided by time elapsed since the first acquire
+ * @readbackCount       - Amount of frames delivered to the readback callback
+ * @readbackBytes       - Total bytes delivered to the readback callback
+ * @readbackMBPerSecond - @readbackBytes in megabytes (10^6) divided by time elapsed since the first acquire
+ * @cpuWaitMs           - Total time in milliseconds the CPU spent blocked on frame fences
+ */
+struct uvr_vk_headless_target_stats {
+  uint64_t frameCount;
+  double   framesPerSecond;
+  uint64_t readbackCount;
+  uint64_t readbackBytes;
+  double   readbackMBPerSecond;
+  double   cpuWaitMs;
+};
+
+
+/*
+ * uvr_vk_headless_target_get_stats: Reports frame and readback throughput of a headless target
+ *
+ * args:
+ * @target - pointer to a struct uvr_vk_headless_target
+ * return:
+ *    populated struct uvr_vk_headless_target_stats
+ */
+struct uvr_vk_headless_target_stats uvr_vk_headless_target_get_stats(struct uvr_vk_headless_target *target);
+
+
+/*
+ * Opaque per submission state of a struct uvr_vk_upload_ring. Tracks the ring range, fence and
+ * ownership transfer barriers of one batch of copies.
+ */
+struct uvr_vk_upload_batch;
+
+
+/*
+ * struct uvr_vk_upload_ring (Underview Renderer Vulkan Upload Ring)
+ *
+ * members:
+ * @vkDevice            - Logical device used to create the ring's buffer, command pool and synchronization objects
+ * @dispatch            - Device function table from uvr_vk_device_dispatch_get(3) used on hot paths
+ * @vkQueue             - Queue copies are submitted to. Ideally a dedicated transfer queue.
+ * @srcQueueFamilyIndex - Queue family @vkQueue belongs to
+ * @dstQueueFamilyIndex - Queue family destination resources are used on. If different from @srcQueueFamilyIndex
+ *                        ownership of every destination is released after the copy and must be acquired with
+ *                        uvr_vk_upload_ring_record_acquire(3).
+ * @buffer              - Host visible/coherent staging buffer. Mapped for the lifetime of the ring.
+ * @pMapped             - Host address of @buffer
+ * @size                - Size in bytes of @buffer
+ * @alignment           - Alignment of every range handed out from @buffer
+ * @head                - Offset next range is allocated from
+ * @usedBytes           - Bytes between the oldest in flight batch and @head (wrap padding included)
+ * @vkCommandbuffs      - One command buffer per batch
+ * @vkSyncs             - One VkFence per batch, plus a single timeline semaphore if @timeline
+ * @timeline            - VK_TRUE if a timeline semaphore is signaled with the upload ID of every batch
+ * @batchCount          - Amount of batches that may be in flight at once
+ * @batches             - Pointer to an array of @batchCount batches
+ * @batchIndex          - Batch currently being recorded
+ * @nextUploadId        - Upload ID the batch currently being recorded will be assigned
+ * @retiredUploadId     - Latest upload ID the GPU is known to have completed
+ * @bytesUploaded       - Total bytes copied to the ring
+ * @bytesRetired        - Total bytes of batches the GPU completed
+ * @copyCount           - Total amount of copy commands recorded
+ * @submitCount         - Total amount of batch submissions
+ * @stallCount          - Amount of times the host blocked waiting for ring space or a free batch
+ * @stallNs             - Total time in nanoseconds spent in said stalls
+ * @peakUsedBytes       - High-water mark of @usedBytes
+ * @firstSubmitTime     - CLOCK_MONOTONIC time of the first submission
+ */
+struct uvr_vk_upload_ring {
+  VkDevice                            vkDevice;
+  const struct uvr_vk_device_dispatch *dispatch;
+  VkQueue                             vkQueue;
+  uint32_t                            srcQueueFamilyIndex;
+  uint32_t                            dstQueueFamilyIndex;
+  struct uvr_vk_buffer                buffer;
+  void                                *pMapped;
+  VkDeviceSize                        size;
+  VkDeviceSize                        alignment;
+  VkDeviceSize                        head;
+  VkDeviceSize                        usedBytes;
+  struct uvr_vk_command_buffer        vkCommandbuffs;
+  struct uvr_vk_sync_obj              vkSyncs;
+  VkBool32                            timeline;
+  uint32_t                            batchCount;
+  struct uvr_vk_upload_batch          *batches;
+  uint32_t                            batchIndex;
+  uint64_t                            nextUploadId;
+  uint64_t                            retiredUploadId;
+  uint64_t                            bytesUploaded;
+  uint64_t                            bytesRetired;
+  uint64_t                            copyCount;
+  uint64_t                            submitCount;
+  uint64_t                            stallCount;
+  uint64_t                            stallNs;
+  VkDeviceSize                        peakUsedBytes;
+  struct timespec                     firstSubmitTime;
+};
+
+
+/*
+ * struct uvr_vk_upload_ring_create_info (Underview Renderer Vulkan Upload Ring Create Information)
+ *
+ * members:
+ * @allocator           - Must pass a pointer to a valid struct uvr_vk_allocator. Staging buffer is allocated from it.
+ * @vkQueue             - Must pass a valid VkQueue handle copies are submitted to
+ * @srcQueueFamilyIndex - Must pass the queue family index of @vkQueue
+ * @dstQueueFamilyIndex - Must pass the queue family index destination resources are consumed on
+ * @size                - Size in bytes of the staging ring
+ * @alignment           - Alignment of every staging range. If zero 16 is used. Image uploads require a multiple
+ *                        of the texel block size and 4.
+ * @batchCount          - Amount of batches that may be in flight at once. If zero 2 is used.
+ * @timeline            - If VK_TRUE a timeline semaphore is signaled with every batch's upload ID so GPU work on other
+ *                        queues may wait on it. Requires timelineSemaphore to be enabled on the logical device.
+ */
+struct uvr_vk_upload_ring_create_info {
+  struct uvr_vk_allocator *allocator;
+  VkQueue                 vkQueue;
+  uint32_t                srcQueueFamilyIndex;
+  uint32_t                dstQueueFamilyIndex;
+  VkDeviceSize            size;
+  VkDeviceSize            alignment;
+  uint32_t                batchCount;
+  VkBool32                timeline;
+};
+
+
+/*
+ * uvr_vk_upload_ring_create: Creates a persistently mapped staging ring. Small copies are accumulated into a single
+ *                            command buffer and submitted together with uvr_vk_upload_ring_flush(3). Ring space is
+ *                            reclaimed as soon as the batch that used it completes on the GPU.
+ *
+ * args:
+ * @uvrvk - pointer to a struct uvr_vk_upload_ring_create_info
+ * return:
+ *    on success struct uvr_vk_upload_ring
+ *    on failure struct uvr_vk_upload_ring { with member nulled }
+ */
+struct uvr_vk_upload_ring uvr_vk_upload_ring_create(struct uvr_vk_upload_ring_create_info *uvrvk);
+
+
+/*
+ * struct uvr_vk_upload_buffer_info (Underview Renderer Vulkan Upload Buffer Information)
+ *
+ * members:
+ * @pData         - Pointer to host data to upload
+ * @size          - Size in bytes of @pData
+ * @dstBuffer     - Buffer to copy data into
+ * @dstOffset     - Byte offset into @dstBuffer
+ * @dstStageMask  - Pipeline stages that consume @dstBuffer after the upload
+ * @dstAccessMask - Access types that consume @dstBuffer after the upload
+ */
+struct uvr_vk_upload_buffer_info {
+  const void           *pData;
+  VkDeviceSize         size;
+  VkBuffer             dstBuffer;
+  VkDeviceSize         dstOffset;
+  VkPipelineStageFlags dstStageMask;
+  VkAccessFlags        dstAccessMask;
+};
+
+
+/*
+ * uvr_vk_upload_ring_copy_buffer: Copies host data into the ring and records a copy to @dstBuffer in the current batch.
+ *                                 Blocks only if the ring is full and every batch is still in flight.
+ *
+ * args:
+ * @ring  - pointer to a struct uvr_vk_upload_ring
+ * @uvrvk - pointer to a struct uvr_vk_upload_buffer_info
+ * return:
+ *    on success upload ID of the batch the copy belongs to
+ *    on failure 0
+ */
+uint64_t uvr_vk_upload_ring_copy_buffer(struct uvr_vk_upload_ring *ring, struct uvr_vk_upload_buffer_info *uvrvk);
+
+
+/*
+ * struct uvr_vk_upload_image_info (Underview Renderer Vulkan Upload Image Information)
+ *
+ * members:
+ * @pData             - Pointer to tightly packed host texel data
+ * @size              - Size in bytes of @pData
+ * @dstImage          - Image to copy data into
+ * @oldLayout         - Layout @dstImage is in before the upload. VK_IMAGE_LAYOUT_UNDEFINED discards previous contents.
+ *                     Any other layout requires @dstImage to not be owned by another queue family.
+ * @newLayout         - Layout @dstImage is transitioned to after the upload
+ * @imageSubresource  - Subresource of @dstImage written
+ * @imageOffset       - Texel offset into @imageSubresource
+ * @imageExtent       - Size in texels of the region written
+ * @dstStageMask      - Pipeline stages that consume @dstImage after the upload
+ * @dstAccessMask     - Access types that consume @dstImage after the upload
+ */
+struct uvr_vk_upload_image_info {
+  const void               *pData;
+  VkDeviceSize             size;
+  VkImage                  dstImage;
+  VkImageLayout            oldLayout;
+  VkImageLayout            newLayout;
+  VkImageSubresourceLayers imageSubresource;
+  VkOffset3D               imageOffset;
+  VkExtent3D               imageExtent;
+  VkPipelineStageFlags     dstStageMask;
+  VkAccessFlags            dstAccessMask;
+};
+
+
+/*
+ * uvr_vk_upload_ring_copy_image: Copies host texel data into the ring and records a layout transition plus
+ *                                copy to @dstImage in the current batch.
+ *
+ * args:
+ * @ring  - pointer to a struct uvr_vk_upload_ring
+ * @uvrvk - pointer to a struct uvr_vk_upload_image_info
+ * return:
+ *    on success upload ID of the batch the copy belongs to
+ *    on failure 0
+ */
+uint64_t uvr_vk_upload_ring_copy_image(struct uvr_vk_upload_ring *ring, struct uvr_vk_upload_image_info *uvrvk);
+
+
+/*
+ * uvr_vk_upload_ring_flush: Records release barriers for every destination in the current batch and submits
+ *                           the batch in a single vkQueueSubmit. Does nothing if no copies were recorded.
+ *                           If the batch can't be ended or submitted its copies are discarded and must be
+ *                           issued again, the next copy starts a new batch.
+ *
+ * args:
+ * @ring     - pointer to a struct uvr_vk_upload_ring
+ * @uploadId - Optional pointer populated with the upload ID of the submitted batch. Zero if nothing was submitted.
+ * return:
+ *    on success 0
+ *    on failure -1
+ */
+int uvr_vk_upload_ring_flush(struct uvr_vk_upload_ring *ring, uint64_t *uploadId);
+
+
+/*
+ * uvr_vk_upload_ring_poll: Non-blocking check of whether a batch completed on the GPU. Reclaims ring space
+ *                          of every completed batch.
+ *
+ * args:
+ * @ring     - pointer to a struct uvr_vk_upload_ring
+ * @uploadId - Upload ID returned from a copy or flush
+ * return:
+ *    1 if the batch completed
+ *    0 if the batch is still in flight or not yet flushed
+ */
+int uvr_vk_upload_ring_poll(struct uvr_vk_upload_ring *ring, uint64_t uploadId);
+
+
+/*
+ * uvr_vk_upload_ring_record_acquire: Records queue family ownership acquire barriers (and image layout transitions)
+ *                                    matching the release barriers of batch @uploadId into @cmdBuffer. @cmdBuffer must
+ *                                    be submitted to a queue of struct uvr_vk_upload_ring { member: dstQueueFamilyIndex }
+ *                                    that waits on the batch (timeline semaphore or uvr_vk_upload_ring_poll(3)).
+ *                                    Nothing is recorded if source and destination queue families match.
+ *
+ * args:
+ * @ring      - pointer to a struct uvr_vk_upload_ring
+ * @cmdBuffer - Command buffer in the recording state
+ * @uploadId  - Upload ID of a flushed batch
+ */
+void uvr_vk_upload_ring_record_acquire(struct uvr_vk_upload_ring *ring, VkCommandBuffer cmdBuffer, uint64_t uploadId);
+
+
+/*
+ * struct uvr_vk_upload_ring_stats (Underview Renderer Vulkan Upload Ring Statistics)
+ *
+ * members:
+ * @bytesUploaded  - Total bytes copied to the ring
+ * @bytesPerSecond - Bytes the GPU completed divided by time elapsed since the first submission
+ * @copyCount      - Total amount of copy commands recorded
+ * @submitCount    - Total amount of batch submissions
+ * @stallCount     - Amount of times the host blocked waiting for ring space
+ * @stallMs        - Total time in milliseconds spent in said stalls
+ * @usedBytes      - Bytes of the ring currently in use
+ * @peakUsedBytes  - High-water mark of @usedBytes
+ */
+struct uvr_vk_upload_ring_stats {
+  uint64_t     bytesUploaded;
+  double       bytesPerSecond;
+  uint64_t     copyCount;
+  uint64_t     submitCount;
+  uint64_t     stallCount;
+  double       stallMs;
+  VkDeviceSize usedBytes;
+  VkDeviceSize peakUsedBytes;
+};
+
+
+/*
+ * uvr_vk_upload_ring_get_stats: Reports throughput and stall statistics of an upload ring
+ *
+ * args:
+ * @ring - pointer to a struct uvr_vk_upload_ring
+ * return:
+ *    populated struct uvr_vk_upload_ring_stats
+ */
+struct uvr_vk_upload_ring_stats uvr_vk_upload_ring_get_stats(struct uvr_vk_upload_ring *ring);
+
+
+/*
+ * Opaque descriptor pool bookkeeping of a struct uvr_vk_descriptor_allocator.
+ * uvr_vk_descriptor_thread        - Per thread free pool list and counters
+ * uvr_vk_descriptor_frame_pools   - Pools a thread allocated sets from during a frame
+ * uvr_vk_descriptor_layout_cache  - Mutex protected VkDescriptorSetLayout cache
+ */
+struct uvr_vk_descriptor_thread;
+struct uvr_vk_descriptor_frame_pools;
+struct uvr_vk_descriptor_layout_cache;
+
+
+/*
+ * struct uvr_vk_descriptor_allocator (Underview Renderer Vulkan Descriptor Allocator)
+ *
+ * members:
+ * @vkDevice        - Logical device used to create descriptor pools and set layouts
+ * @frameCount      - Amount of frames in flight. Pools used during a frame are reset in bulk when the frame is reused.
+ * @threadCount     - Amount of threads that may allocate sets concurrently. Each thread owns its pools.
+ * @frameIndex      - Frame sets are currently allocated for
+ * @setsPerPool     - maxSets of the first pool a thread creates. Following pools double in size up to @maxSetsPerPool.
+ * @maxSetsPerPool  - Upper bound of a single pool's maxSets
+ * @poolSizeCount   - Amount of elements in @poolSizes
+ * @poolSizes       - Descriptors of each type reserved per set. Multiplied by a pool's maxSets on creation.
+ * @poolFlags       - VkDescriptorPoolCreateFlags every pool is created with
+ * @threads         - Pointer to an array of @threadCount per thread state
+ * @framePools      - Pointer to an array of @frameCount * @threadCount per frame, per thread pool lists
+ * @layoutCache     - VkDescriptorSetLayout cache shared by all threads
+ */
+struct uvr_vk_descriptor_allocator {
+  VkDevice                              vkDevice;
+  uint32_t                              frameCount;
+  uint32_t                              threadCount;
+  uint32_t                              frameIndex;
+  uint32_t                              setsPerPool;
+  uint32_t                              maxSetsPerPool;
+  uint32_t                              poolSizeCount;
+  VkDescriptorPoolSize                  *poolSizes;
+  VkDescriptorPoolCreateFlags           poolFlags;
+  struct uvr_vk_descriptor_thread       *threads;
+  struct uvr_vk_descriptor_frame_pools  *framePools;
+  struct uvr_vk_descriptor_layout_cache *layoutCache;
+};
+
+
+/*
+ * struct uvr_vk_descriptor_allocator_create_info (Underview Renderer Vulkan Descriptor Allocator Create Information)
+ *
+ * members:
+ * @vkDevice       - Must pass a valid active logical device
+ * @frameCount     - Amount of frames in flight. If zero 1 is used.
+ * @threadCount    - Amount of threads allocating sets. If zero 1 is used.
+ * @setsPerPool    - maxSets of the first pool created per thread. If zero 64 is used.
+ * @maxSetsPerPool - Upper bound of a pool's maxSets. If zero 4096 is used.
+ * @poolSizeCount  - Amount of elements in @pPoolSizes
+ * @pPoolSizes     - Average amount of descriptors of each type a single set uses
+ * @poolFlags      - Flags pools are created with. VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT is unnecessary
+ *                   as sets are never freed individually.
+ */
+struct uvr_vk_descriptor_allocator_create_info {
+  VkDevice                    vkDevice;
+  uint32_t                    frameCount;
+  uint32_t                    threadCount;
+  uint32_t                    setsPerPool;
+  uint32_t                    maxSetsPerPool;
+  uint32_t                    poolSizeCount;
+  const VkDescriptorPoolSize  *pPoolSizes;
+  VkDescriptorPoolCreateFlags poolFlags;
+};
+
+
+/*
+ * uvr_vk_descriptor_allocator_create: Creates a growable descriptor set allocator. Pools are created lazily per thread
+ *                                     and recycled every frame, so once warmed up allocating a set never creates a pool.
+ *
+ * args:
+ * @uvrvk - pointer to a struct uvr_vk_descriptor_allocator_create_info
+ * return:
+ *    on success struct uvr_vk_descriptor_allocator
+ *    on failure struct uvr_vk_descriptor_allocator { with member nulled }
+ */
+struct uvr_vk_descriptor_allocator uvr_vk_descriptor_allocator_create(struct uvr_vk_descriptor_allocator_create_info *uvrvk);
+
+
+/*
+ * uvr_vk_descriptor_allocator_next_frame: Advances to the next frame and resets every pool used the last time that frame
+ *                                         was active with a single vkResetDescriptorPool per pool. All sets allocated
+ *                                         for that frame become invalid. Must be called after the frame's fence signaled
+ *                                         and while no thread is allocating.
+ *
+ * args:
+ * @allocator - pointer to a struct uvr_vk_descriptor_allocator
+ * return:
+ *    on success 0
+ *    on failure -1
+ */
+int uvr_vk_descriptor_allocator_next_frame(struct uvr_vk_descriptor_allocator *allocator);
+
+
+/*
+ * struct uvr_vk_descriptor_set_alloc_info (Underview Renderer Vulkan Descriptor Set Allocate Information)
+ *
+ * members:
+ * @allocator          - Must pass a pointer to a valid struct uvr_vk_descriptor_allocator
+ * @threadIndex        - Index of the calling thread [0, struct uvr_vk_descriptor_allocator { member: threadCount })
+ * @setCount           - Amount of descriptor sets to allocate
+ * @pSetLayouts        - Pointer to an array of @setCount layouts
+ * @pDescriptorCounts  - Optional pointer to an array of @setCount variable descriptor counts. Only required for layouts
+ *                       with a VK_DESCRIPTOR_BINDING_VARIABLE_DESCRIPTOR_COUNT_BIT binding.
+ */
+struct uvr_vk_descriptor_set_alloc_info {
+  struct uvr_vk_descriptor_allocator *allocator;
+  uint32_t                           threadIndex;
+  uint32_t                           setCount;
+  const VkDescriptorSetLayout        *pSetLayouts;
+  const uint32_t                     *pDescriptorCounts;
+};
+
+
+/*
+ * uvr_vk_descriptor_set_alloc: Allocates descriptor sets valid for the current frame. If the thread's current pool is
+ *                              exhausted (VK_ERROR_OUT_OF_POOL_MEMORY/VK_ERROR_FRAGMENTED_POOL) allocation is retried
+ *                              once from a recycled or newly created pool. If that pool is too small for the request
+ *                              as well a pool sized to the request's sets and descriptors is created for a last retry.
+ *
+ * args:
+ * @uvrvk           - pointer to a struct uvr_vk_descriptor_set_alloc_info
+ * @pDescriptorSets - Pointer to an array of @uvrvk->setCount VkDescriptorSet handles populated on success
+ * return:
+ *    on success 0
+ *    on failure -1
+ */
+int uvr_vk_descriptor_set_alloc(struct uvr_vk_descriptor_set_alloc_info *uvrvk, VkDescriptorSet *pDescriptorSets);
+
+
+/*
+ * struct uvr_vk_descriptor_set_layout_info (Underview Renderer Vulkan Descriptor Set Layout Information)
+ *
+ * members:
+ * @flags         - VkDescriptorSetLayoutCreateFlags
+ * @bindingCount  - Amount of elements in @pBindings
+ * @pBindings     - Pointer to an array of VkDescriptorSetLayoutBinding. Order does not affect the cache lookup.
+ * @pBindingFlags - Optional pointer to an array of @bindingCount VkDescriptorBindingFlags. Element i is paired
+ *                  with @pBindings[i]. Chained as VkDescriptorSetLayoutBindingFlagsCreateInfo if not NULL.
+ */
+struct uvr_vk_descriptor_set_layout_info {
+  VkDescriptorSetLayoutCreateFlags   flags;
+  uint32_t                           bindingCount;
+  const VkDescriptorSetLayoutBinding *pBindings;
+  const VkDescriptorBindingFlags     *pBindingFlags;
+};
+
+
+/*
+ * uvr_vk_descriptor_set_layout_get: Returns a VkDescriptorSetLayout matching the binding signature described by @uvrvk.
+ *                                   Layouts are created once and shared, callers must not destroy them. Thread safe.
+ *
+ * args:
+ * @allocator - pointer to a struct uvr_vk_descriptor_allocator owning the layout cache
+ * @uvrvk     - pointer to a struct uvr_vk_descriptor_set_layout_info
+ * return:
+ *    on success VkDescriptorSetLayout handle
+ *    on failure VK_NULL_HANDLE
+ */
+VkDescriptorSetLayout uvr_vk_descriptor_set_layout_get(struct uvr_vk_descriptor_allocator *allocator,
+                                                       struct uvr_vk_descriptor_set_layout_info *uvrvk);
+
+
+/*
+ * struct uvr_vk_descriptor_allocator_stats (Underview Renderer Vulkan Descriptor Allocator Statistics)
+ *
+ * members:
+ * @poolCount       - Amount of descriptor pools owned by the allocator
+ * @freePoolCount   - Amount of reset pools waiting to be reused
+ * @poolCreateCount - Amount of times vkCreateDescriptorPool was called
+ * @setCount        - Total amount of descriptor sets allocated
+ * @retryCount      - Amount of allocations retried because a pool ran out of memory or was fragmented
+ * @resetCount      - Amount of times vkResetDescriptorPool was called
+ * @layoutCount     - Amount of cached VkDescriptorSetLayout objects
+ * @layoutHits      - Amount of layout lookups served from the cache
+ * @layoutMisses    - Amount of layout lookups that created a new VkDescriptorSetLayout
+ */
+struct uvr_vk_descriptor_allocator_stats {
+  uint32_t poolCount;
+  uint32_t freePoolCount;
+  uint64_t poolCreateCount;
+  uint64_t setCount;
+  uint64_t retryCount;
+  uint64_t resetCount;
+  uint32_t layoutCount;
+  uint64_t layoutHits;
+  uint64_t layoutMisses;
+};
+
+
+/*
+ * uvr_vk_descriptor_allocator_get_stats: Reports pool usage and layout cache statistics. Must not be called while
+ *                                        threads are allocating.
+ *
+ * args:
+ * @allocator - pointer to a struct uvr_vk_descriptor_allocator
+ * return:
+ *    populated struct uvr_vk_descriptor_allocator_stats
+ */
+struct uvr_vk_descriptor_allocator_stats uvr_vk_descriptor_allocator_get_stats(struct uvr_vk_descriptor_allocator *allocator);
+
+
+#define UVR_VK_BINDLESS_INVALID_SLOT UINT32_MAX
+
+
+/* Opaque (slot, frame freed on) pair waiting for the GPU to retire the frame */
+struct uvr_vk_bindless_retired;
+
+
+/*
+ * struct uvr_vk_bindless_table (Underview Renderer Vulkan Bindless Table)
+ *
+ * members:
+ * @vkDevice              - Logical device used to create the table
+ * @vkDescriptorSetLayout - Layout with a single runtime sized, partially bound, update after bind array at binding 0.
+ *                          Pass to struct uvr_vk_pipeline_layout_create_info { member: pSetLayouts }.
+ * @vkDescriptorPool      - Update after bind pool @vkDescriptorSet is allocated from
+ * @vkDescriptorSet       - The one descriptor set bound for every draw. Slots may be written while it's bound.
+ * @descriptorType        - VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER or VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE
+ * @capacity              - Amount of array elements (slots) in the table
+ * @highWater             - Slots [0, @highWater) were handed out at least once
+ * @freeCount             - Amount of elements in @freeSlots
+ * @freeSlots             - Slots that may be reused immediately
+ * @liveSlots             - Bitmask of @capacity bits, set while a slot is allocated and not yet freed
+ * @framesInFlight        - Amount of frames a freed slot must wait before being reused
+ * @frameNumber           - Incremented by uvr_vk_bindless_table_next_frame(3)
+ * @retiredHead           - Index of the oldest entry in @retired
+ * @retiredCount          - Amount of freed slots waiting on the GPU
+ * @retired               - Ring of @capacity freed slots
+ * @slotsInUse            - Amount of slots currently allocated
+ * @peakSlotsInUse        - High-water mark of @slotsInUse
+ */
+struct uvr_vk_bindless_table {
+  VkDevice                       vkDevice;
+  VkDescriptorSetLayout          vkDescriptorSetLayout;
+  VkDescriptorPool               vkDescriptorPool;
+  VkDescriptorSet                vkDescriptorSet;
+  VkDescriptorType               descriptorType;
+  uint32_t                       capacity;
+  uint32_t                       highWater;
+  uint32_t                       freeCount;
+  uint32_t                       *freeSlots;
+  uint32_t                       *liveSlots;
+  uint32_t                       framesInFlight;
+  uint64_t                       frameNumber;
+  uint32_t                       retiredHead;
+  uint32_t                       retiredCount;
+  struct uvr_vk_bindless_retired *retired;
+  uint32_t                       slotsInUse;
+  uint32_t                       peakSlotsInUse;
+};
+
+
+/*
+ * struct uvr_vk_bindless_table_create_info (Underview Renderer Vulkan Bindless Table Create Information)
+ *
+ * members:
+ * @vkPhdev        - Must pass a valid VkPhysicalDevice handle. Used to clamp @capacity to device limits.
+ * @vkDevice       - Must pass a valid active logical device created with
+ *                   struct uvr_vk_lgdev_create_info { member: enableDescriptorIndexing } set to VK_TRUE
+ * @descriptorType - VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER or VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE
+ * @capacity       - Amount of slots in the table
+ * @stageFlags     - Shader stages that index the table
+ * @framesInFlight - Amount of frames the GPU may be behind the host. Freed slots are reused after this many frames.
+ *                   Must be greater than zero.
+ */
+struct uvr_vk_bindless_table_create_info {
+  VkPhysicalDevice   vkPhdev;
+  VkDevice           vkDevice;
+  VkDescriptorType   descriptorType;
+  uint32_t           capacity;
+  VkShaderStageFlags stageFlags;
+  uint32_t           framesInFlight;
+};
+
+
+/*
+ * uvr_vk_bindless_table_create: Creates a single descriptor set containing one large array of sampled images. Shaders index
+ *                               the array (i.e. with a push constant or per instance value) so any amount of textured
+ *                               surfaces may be drawn without binding a descriptor set per surface.
+ *
+ * args:
+ * @uvrvk - pointer to a struct uvr_vk_bindless_table_create_info
+ * return:
+ *    on success struct uvr_vk_bindless_table
+ *    on failure struct uvr_vk_bindless_table { with member nulled }
+ */
+struct uvr_vk_bindless_table uvr_vk_bindless_table_create(struct uvr_vk_bindless_table_create_info *uvrvk);
+
+
+/*
+ * uvr_vk_bindless_table_alloc: Allocates a slot and writes @imageView into it
+ *
+ * args:
+ * @table       - pointer to a struct uvr_vk_bindless_table
+ * @imageView   - Image view to write into the slot
+ * @imageLayout - Layout @imageView is in when sampled
+ * @sampler     - Sampler for VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER tables. Ignored otherwise.
+ * return:
+ *    on success slot index to pass to shaders
+ *    on failure UVR_VK_BINDLESS_INVALID_SLOT
+ */
+uint32_t uvr_vk_bindless_table_alloc(struct uvr_vk_bindless_table *table, VkImageView imageView, VkImageLayout imageLayout, VkSampler sampler);
+
+
+/*
+ * uvr_vk_bindless_table_update: Replaces the image view written into an allocated slot. The slot must not be
+ *                               accessed by command buffers still executing.
+ *
+ * args:
+ * @table       - pointer to a struct uvr_vk_bindless_table
+ * @slot        - Slot returned from uvr_vk_bindless_table_alloc(3)
+ * @imageView   - Image view to write into the slot
+ * @imageLayout - Layout @imageView is in when sampled
+ * @sampler     - Sampler for VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER tables. Ignored otherwise.
+ */
+void uvr_vk_bindless_table_update(struct uvr_vk_bindless_table *table, uint32_t slot, VkImageView imageView,
+                                  VkImageLayout imageLayout, VkSampler sampler);
+
+
+/*
+ * uvr_vk_bindless_table_free: Releases a slot. Slot isn't reused until struct uvr_vk_bindless_table { member: framesInFlight }
+ *                             frames passed so command buffers already submitted may keep sampling it. Freeing a slot
+ *                             that isn't allocated is rejected with a warning.
+ *
+ * args:
+ * @table - pointer to a struct uvr_vk_bindless_table
+ * @slot  - Slot returned from uvr_vk_bindless_table_alloc(3)
+ */
+void uvr_vk_bindless_table_free(struct uvr_vk_bindless_table *table, uint32_t slot);
+
+
+/*
+ * uvr_vk_bindless_table_next_frame: Advances the table's frame counter and returns slots freed long enough ago to
+ *                                   the free list. Call once per frame after waiting on the frame's fence.
+ *
+ * args:
+ * @table - pointer to a struct uvr_vk_bindless_table
+ */
+void uvr_vk_bindless_table_next_frame(struct uvr_vk_bindless_table *table);
+
+
+/* Opaque resource awaiting destruction in a struct uvr_vk_deletion_queue */
+struct uvr_vk_deletion_entry;
+
+
+/*
+ * struct uvr_vk_deletion_queue (Underview Renderer Vulkan Deletion Queue)
+ *
+ * members:
+ * @vkDevice         - Logical device resources in the queue were created with
+ * @entryCount       - Amount of pushes awaiting destruction
+ * @entryCapacity    - Amount of elements allocated for @entries
+ * @entries          - Pointer to an array of pushed resources in push order
+ * @pendingBytes     - Device memory in bytes held by buffers/images in the queue
+ * @peakPendingBytes - High-water mark of @pendingBytes
+ * @destroyedCount   - Total amount of resources destroyed by the queue
+ * @collectCount     - Amount of uvr_vk_deletion_queue_collect(3) calls that destroyed at least one resource
+ */
+struct uvr_vk_deletion_queue {
+  VkDevice                     vkDevice;
+  uint32_t                     entryCount;
+  uint32_t                     entryCapacity;
+  struct uvr_vk_deletion_entry *entries;
+  VkDeviceSize                 pendingBytes;
+  VkDeviceSize                 peakPendingBytes;
+  uint64_t                     destroyedCount;
+  uint64_t                     collectCount;
+};
+
+
+/*
+ * struct uvr_vk_deletion_queue_create_info (Underview Renderer Vulkan Deletion Queue Create Information)
+ *
+ * members:
+ * @vkDevice        - Must pass a valid active logical device
+ * @initialCapacity - Amount of entries to allocate upfront. Grows as needed. If zero 64 is used.
+ */
+struct uvr_vk_deletion_queue_create_info {
+  VkDevice vkDevice;
+  uint32_t initialCapacity;
+};
+
+
+/*
+ * uvr_vk_deletion_queue_create: Creates a queue of resources whose destruction is deferred until the GPU work
+ *                               last using them retired. Allows freeing resources at runtime without a
+ *                               vkDeviceWaitIdle or vkQueueWaitIdle stall.
+ *
+ * args:
+ * @uvrvk - pointer to a struct uvr_vk_deletion_queue_create_info
+ * return:
+ *    on success struct uvr_vk_deletion_queue
+ *    on failure struct uvr_vk_deletion_queue { with member nulled }
+ */
+struct uvr_vk_deletion_queue uvr_vk_deletion_queue_create(struct uvr_vk_deletion_queue_create_info *uvrvk);
+
+
+/*
+ * struct uvr_vk_deletion_queue_push_info (Underview Renderer Vulkan Deletion Queue Push Information)
+ *
+ * Every non NULL/VK_NULL_HANDLE resource member is queued. All of them share the same completion condition.
+ *
+ * members:
+ * @timelineSemaphore  - Timeline semaphore signaled by the last submission using the resources. If VK_NULL_HANDLE
+ *                       @fence is used instead.
+ * @timelineValue      - Value @timelineSemaphore reaches once the last submission using the resources completed
+ * @fence              - Fence signaled by the last submission using the resources. A fence reset and resubmitted
+ *                       before resources are collected only delays their destruction.
+ * @buffer             - Optional pointer to a struct uvr_vk_buffer. Queue takes ownership, members nulled after call.
+ * @image              - Optional pointer to a struct uvr_vk_image. Views are destroyed, images and memory only if
+ *                       created by uvr_vk_image_create2(3). Queue takes ownership, members nulled after call.
+ * @imageView          - Optional standalone VkImageView handle
+ * @pipeline           - Optional VkPipeline handle
+ * @framebuffer        - Optional VkFramebuffer handle
+ * @descriptorPool     - VkDescriptorPool @pDescriptorSets were allocated from. Must be created with
+ *                       VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT.
+ * @descriptorSetCount - Amount of elements in @pDescriptorSets
+ * @pDescriptorSets    - Optional pointer to an array of VkDescriptorSet handles. Copied by the queue.
+ */
+struct uvr_vk_deletion_queue_push_info {
+  VkSemaphore           timelineSemaphore;
+  uint64_t              timelineValue;
+  VkFence               fence;
+  struct uvr_vk_buffer  *buffer;
+  struct uvr_vk_image   *image;
+  VkImageView           imageView;
+  VkPipeline            pipeline;
+  VkFramebuffer         framebuffer;
+  VkDescriptorPool      descriptorPool;
+  uint32_t              descriptorSetCount;
+  const VkDescriptorSet *pDescriptorSets;
+};
+
+
+/*
+ * uvr_vk_deletion_queue_push: Queues resources for destruction once the GPU work described by @uvrvk retired
  *
  * args:
- * @uvrvk - pointer to a struct uvr_vk_framebuffer_create_info
+ * @queue - pointer to a struct uvr_vk_deletion_queue
+ * @uvrvk - pointer to a struct uvr_vk_deletion_queue_push_info
  * return:
- *    on success struct uvr_vk_framebuffer
- *    on failure struct uvr_vk_framebuffer { with member nulled }
+ *    on success 0
+ *    on failure -1 (nothing was queued, caller still owns the resources)
  */
-struct uvr_vk_framebuffer uvr_vk_framebuffer_create(struct uvr_vk_framebuffer_create_info *uvrvk);
+int uvr_vk_deletion_queue_push(struct uvr_vk_deletion_queue *queue, struct uvr_vk_deletion_queue_push_info *uvrvk);
+
 
 /*
- * struct uvr_vk_command_buffer_handle (Underview Renderer Vulkan Command Buffer Handle)
+ * uvr_vk_deletion_queue_collect: Non-blocking. Destroys, in one batch, every queued resource whose timeline value
+ *                                was reached or fence signaled. Each timeline semaphore's counter is queried once
+ *                                per call. Call once per frame, i.e. after uvr_vk_frame_ring_acquire(3).
  *
- * @buffer - Handle used to prerecord commands before they are submitted to a device queue and sent off to the GPU.
+ * args:
+ * @queue - pointer to a struct uvr_vk_deletion_queue
+ * return:
+ *    Amount of resources destroyed
  */
-struct uvr_vk_command_buffer_handle {
-  VkCommandBuffer buffer;
+uint32_t uvr_vk_deletion_queue_collect(struct uvr_vk_deletion_queue *queue);
+
+
+/*
+ * uvr_vk_deletion_queue_flush: Blocks until every queued resource's completion condition is met then destroys
+ *                              them all. Only waits on the fences/timeline values pushed, never idles the device.
+ *
+ * args:
+ * @queue - pointer to a struct uvr_vk_deletion_queue
+ */
+void uvr_vk_deletion_queue_flush(struct uvr_vk_deletion_queue *queue);
+
+
+/* Amount of VkSystemAllocationScope values, COMMAND through INSTANCE */
+#define UVR_VK_HOST_ALLOCATOR_SCOPE_COUNT (VK_SYSTEM_ALLOCATION_SCOPE_INSTANCE + 1)
+
+
+/*
+ * struct uvr_vk_host_allocator (Underview Renderer Vulkan Host Allocator)
+ *
+ * VkAllocationCallbacks implementation that accounts every host allocation the implementation makes on the
+ * library's behalf. Allocations with VK_SYSTEM_ALLOCATION_SCOPE_COMMAND only live for the duration of the
+ * Vulkan command that made them and are served from a bump arena, reset each time it holds no live allocation.
+ *
+ * members:
+ * @callbacks           - VkAllocationCallbacks passed to every vkCreate* and vkDestroy* call once set via
+ *                        uvr_vk_host_allocator_set(3). @callbacks.pUserData points back to this struct.
+ * @lock                - Guards every member bellow
+ * @scopeBytes          - Live bytes per VkSystemAllocationScope
+ * @scopeAllocations    - Total allocations made per VkSystemAllocationScope
+ * @currentBytes        - Live bytes across all scopes
+ * @peakBytes           - High-water mark of @currentBytes
+ * @internalBytes       - Live bytes the implementation reported via pfnInternalAllocation
+ * @allocationCount     - Total pfnAllocation calls (and pfnReallocation calls with a NULL pOriginal)
+ * @reallocationCount   - Total pfnReallocation calls resizing an existing allocation
+ * @freeCount           - Total allocations released
+ * @arena               - Pointer to @arenaSize bytes backing COMMAND scope allocations. NULL if disabled.
+ * @arenaSize           - Size in bytes of @arena
+ * @arenaOffset         - Bump offset of the next @arena allocation
+ * @arenaLive           - Amount of live allocations in @arena. @arenaOffset is rewound when it reaches zero.
+ * @arenaPeakBytes      - High-water mark of @arenaOffset
+ * @arenaAllocations    - Total allocations served from @arena
+ * @arenaFallbacks      - COMMAND scope allocations that did not fit in @arena and were malloc'd instead
+ * @arenaResets         - Amount of times @arenaOffset was rewound
+ * @startTime           - CLOCK_MONOTONIC time the allocator was created
+ */
+struct uvr_vk_host_allocator {
+  VkAllocationCallbacks callbacks;
+  pthread_mutex_t       lock;
+  size_t                scopeBytes[UVR_VK_HOST_ALLOCATOR_SCOPE_COUNT];
+  uint64_t              scopeAllocations[UVR_VK_HOST_ALLOCATOR_SCOPE_COUNT];
+  size_t                currentBytes;
+  size_t                peakBytes;
+  size_t                internalBytes;
+  uint64_t              allocationCount;
+  uint64_t              reallocationCount;
+  uint64_t              freeCount;
+  unsigned char         *arena;
+  size_t                arenaSize;
+  size_t                arenaOffset;
+  uint32_t              arenaLive;
+  size_t                arenaPeakBytes;
+  uint64_t              arenaAllocations;
+  uint64_t              arenaFallbacks;
+  uint64_t              arenaResets;
+  struct timespec       startTime;
 };
 
 
 /*
- * struct uvr_vk_command_buffer (Underview Renderer Vulkan Command Buffer)
+ * struct uvr_vk_host_allocator_create_info (Underview Renderer Vulkan Host Allocator Create Information)
  *
  * members:
- * @vkDevice            - Logical device used to create command pool/buffers
- * @vkCommandPool       - The command pool which the buffers where allocated from.
- * @commandBufferCount  - Amount of VkCommandBuffer's alloocated
- * @vkCommandbuffers    - Pointer to an array of VkCommandBuffer handles
+ * @commandArenaSize - Size in bytes of the bump arena serving VK_SYSTEM_ALLOCATION_SCOPE_COMMAND allocations.
+ *                     If zero the arena is disabled and every allocation is malloc'd and only tracked.
  */
-struct uvr_vk_command_buffer {
-  VkDevice                            vkDevice;
-  VkCommandPool                       vkCommandPool;
-  uint32_t                            commandBufferCount;
-  struct uvr_vk_command_buffer_handle *vkCommandbuffers;
+struct uvr_vk_host_allocator_create_info {
+  size_t commandArenaSize;
 };
 
 
 /*
- * struct uvr_vk_command_buffer_create_info (Underview Renderer Vulkan Command Buffer Create Information)
+ * uvr_vk_host_allocator_create: Initializes @allocator in place. @allocator must not be moved/copied and must
+ *                               outlive every Vulkan object created while it's set.
+ *
+ * args:
+ * @allocator - pointer to a struct uvr_vk_host_allocator
+ * @uvrvk     - pointer to a struct uvr_vk_host_allocator_create_info
+ * return:
+ *    on success 0
+ *    on failure -1
+ */
+int uvr_vk_host_allocator_create(struct uvr_vk_host_allocator *allocator, struct uvr_vk_host_allocator_create_info *uvrvk);
+
+
+/*
+ * uvr_vk_host_allocator_set: Makes the library pass @allocator's VkAllocationCallbacks to every create, allocate,
+ *                            free and destroy call. Vulkan requires an object be destroyed with callbacks compatible
+ *                            with the ones it was created with, so call before uvr_vk_instance_create(3) and reset
+ *                            only after uvr_vk_destory(3).
+ *
+ * args:
+ * @allocator - pointer to a struct uvr_vk_host_allocator or NULL to restore the implementation's allocator
+ */
+void uvr_vk_host_allocator_set(struct uvr_vk_host_allocator *allocator);
+
+
+/*
+ * uvr_vk_host_allocator_get_callbacks: Returns the VkAllocationCallbacks the library currently passes to Vulkan.
+ *                                      Objects the application creates/destroys with direct Vulkan calls should
+ *                                      use them so every host allocation is accounted the same way.
+ *
+ * return:
+ *    pointer to the VkAllocationCallbacks of the struct uvr_vk_host_allocator set via uvr_vk_host_allocator_set(3)
+ *    NULL if none is set
+ */
+const VkAllocationCallbacks *uvr_vk_host_allocator_get_callbacks(void);
+
+
+/*
+ * struct uvr_vk_host_allocator_stats (Underview Renderer Vulkan Host Allocator Statistics)
  *
  * members:
- * @vkDevice           - Must pass a valid active logical device
- * @queueFamilyIndex   - Designates a queue family with VkCommandPool. All command buffers allocated from VkCommandPool
- *                       must used same queue.
- * @commandBufferCount - The amount of command buffers to allocate from a given pool
+ * @scopeBytes           - Live bytes per VkSystemAllocationScope
+ * @scopeAllocations     - Total allocations made per VkSystemAllocationScope. A growing COMMAND count
+ *                         while rendering means a per-frame Vulkan call allocates.
+ * @currentBytes         - Live bytes across all scopes
+ * @peakBytes            - High-water mark of @currentBytes
+ * @internalBytes        - Live bytes the implementation allocated itself and reported
+ * @allocationCount      - Total allocations
+ * @reallocationCount    - Total reallocations
+ * @freeCount            - Total frees
+ * @allocationsPerSecond - @allocationCount + @reallocationCount over the allocator's lifetime
+ * @arenaPeakBytes       - High-water mark of the COMMAND scope arena
+ * @arenaAllocations     - Allocations served from the arena rather than malloc
+ * @arenaFallbacks       - COMMAND scope allocations that did not fit in the arena
+ * @arenaResets          - Amount of times the arena was rewound
  */
-struct uvr_vk_command_buffer_create_info {
-  VkDevice vkDevice;
-  uint32_t queueFamilyIndex;
-  uint32_t commandBufferCount;
+struct uvr_vk_host_allocator_stats {
+  size_t   scopeBytes[UVR_VK_HOST_ALLOCATOR_SCOPE_COUNT];
+  uint64_t scopeAllocations[UVR_VK_HOST_ALLOCATOR_SCOPE_COUNT];
+  size_t   currentBytes;
+  size_t   peakBytes;
+  size_t   internalBytes;
+  uint64_t allocationCount;
+  uint64_t reallocationCount;
+  uint64_t freeCount;
+  double   allocationsPerSecond;
+  size_t   arenaPeakBytes;
+  uint64_t arenaAllocations;
+  uint64_t arenaFallbacks;
+  uint64_t arenaResets;
 };
 
 
 /*
- * uvr_vk_command_buffer_create: Function creates a VkCommandPool handle then allocates VkCommandBuffer handles from
- *                               that pool. The amount of VkCommandBuffer's allocated is based upon @commandBufferCount.
- *                               Function only allocates primary command buffers. VkCommandPool flags set
- *                               VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT
+ * uvr_vk_host_allocator_get_stats: Returns a consistent snapshot of @allocator's accounting
  *
  * args:
- * @uvrvk - pointer to a struct uvr_vk_command_buffer_create_info
+ * @allocator - pointer to a struct uvr_vk_host_allocator
  * return:
- *    on success struct uvr_vk_command_buffer
- *    on failure struct uvr_vk_command_buffer { with member nulled }
+ *    struct uvr_vk_host_allocator_stats
  */
-struct uvr_vk_command_buffer uvr_vk_command_buffer_create(struct uvr_vk_command_buffer_create_info *uvrvk);
+struct uvr_vk_host_allocator_stats uvr_vk_host_allocator_get_stats(struct uvr_vk_host_allocator *allocator);
 
 
 /*
- * struct uvr_vk_command_buffer_record_info (Underview Renderer Vulkan Command Buffer Record Information)
+ * uvr_vk_host_allocator_destroy: Frees @allocator's arena. Logs a warning if allocations are still live.
+ *                                Call after uvr_vk_destory(3).
+ *
+ * args:
+ * @allocator - pointer to a struct uvr_vk_host_allocator
+ */
+void uvr_vk_host_allocator_destroy(struct uvr_vk_host_allocator *allocator);
+
+
+/*
+ * struct uvr_vk_memory_budget_heap (Underview Renderer Vulkan Memory Budget Heap)
  *
  * members:
- * @commandBufferCount - Amount of VkCommandBuffer handles allocated
- * @vkCommandbuffers   - Pointer to an array of struct uvr_vk_command_buffer_handle which contains your actual VkCommandBuffer handles to start writing commands to.
- * @flags              - https://www.khronos.org/registry/vulkan/specs/1.3-extensions/man/html/VkCommandBufferUsageFlagBits.html
+ * @size     - VkMemoryHeap::size
+ * @flags    - VkMemoryHeap::flags
+ * @budget   - Bytes the process may allocate from the heap before allocations are likely to fail or degrade.
+ *             VkPhysicalDeviceMemoryBudgetPropertiesEXT::heapBudget or @size when falling back.
+ * @usage    - Bytes the process currently has allocated from the heap. VkPhysicalDeviceMemoryBudgetPropertiesEXT::heapUsage
+ *             (all allocations made by the process) or bytes reserved by struct uvr_vk_memory_budget { member: allocator }
+ *             when falling back.
+ * @ratio    - @usage / @budget
+ * @pressure - Set once @ratio reaches the high-water mark, cleared once it drops to the low-water mark
  */
-struct uvr_vk_command_buffer_record_info {
-  uint32_t commandBufferCount;
-  struct uvr_vk_command_buffer_handle *vkCommandbuffers;
-  VkCommandBufferUsageFlagBits flags;
+struct uvr_vk_memory_budget_heap {
+  VkDeviceSize      size;
+  VkMemoryHeapFlags flags;
+  VkDeviceSize      budget;
+  VkDeviceSize      usage;
+  float             ratio;
+  bool              pressure;
 };
 
 
 /*
- * uvr_vk_command_buffer_record_begin: Function starts command buffer recording. Thus, allowing each command buffer to become writeable.
- *                                     Allowing for the application to write commands into it. Theses commands are later put into a queue
- *                                     to be sent off to the GPU.
+ * Invoked by uvr_vk_memory_budget_sample(3) each time a heap crosses the high-water mark (@heap->pressure set)
+ * or drops back to the low-water mark (@heap->pressure cleared). Typical reactions to pressure: evict caches,
+ * reduce swapchain image count, lower render resolution.
+ */
+typedef void (*uvr_vk_memory_budget_cb)(void *userData, uint32_t heapIndex, const struct uvr_vk_memory_budget_heap *heap);
+
+
+/*
+ * struct uvr_vk_memory_budget (Underview Renderer Vulkan Memory Budget)
+ *
+ * members:
+ * @vkPhdev         - Physical device heaps are queried from
+ * @allocator       - Allocator whose reserved bytes serve as heap usage when VK_EXT_memory_budget is unavailable
+ * @budgetExtension - VK_TRUE if budget and usage come from VK_EXT_memory_budget
+ * @highWaterMark   - Ratio of usage to budget at which a heap enters pressure
+ * @lowWaterMark    - Ratio of usage to budget at which a heap leaves pressure
+ * @callback        - Function invoked on pressure transitions. May be NULL.
+ * @userData        - Passed to @callback
+ * @heapCount       - Amount of valid elements in @heaps
+ * @heaps           - Per heap budget, usage and pressure state as of the last sample
+ * @sampleCount     - Amount of calls to uvr_vk_memory_budget_sample(3)
+ * @pressureEvents  - Amount of times any heap entered pressure
+ */
+struct uvr_vk_memory_budget {
+  VkPhysicalDevice                 vkPhdev;
+  struct uvr_vk_allocator          *allocator;
+  VkBool32                         budgetExtension;
+  float                            highWaterMark;
+  float                            lowWaterMark;
+  uvr_vk_memory_budget_cb          callback;
+  void                             *userData;
+  uint32_t                         heapCount;
+  struct uvr_vk_memory_budget_heap heaps[VK_MAX_MEMORY_HEAPS];
+  uint64_t                         sampleCount;
+  uint64_t                         pressureEvents;
+};
+
+
+/*
+ * struct uvr_vk_memory_budget_create_info (Underview Renderer Vulkan Memory Budget Create Information)
+ *
+ * members:
+ * @vkPhdev                - Must pass a valid VkPhysicalDevice handle
+ * @allocator              - Optional pointer to a struct uvr_vk_allocator. Used as the usage source when
+ *                           VK_EXT_memory_budget is unavailable. If NULL the fallback reports zero usage.
+ * @budgetExtensionEnabled - VK_TRUE if VK_EXT_memory_budget was enabled via
+ *                           struct uvr_vk_lgdev_create_info { member: ppEnabledExtensionNames }
+ * @highWaterMark          - Ratio of usage to budget (0,1] at which @callback fires. If zero 0.9 is used.
+ * @lowWaterMark           - Ratio a heap under pressure must drop to before @callback fires again. Must be lower
+ *                           than @highWaterMark. If zero @highWaterMark - 0.1 is used.
+ * @callback               - Optional function invoked on pressure transitions
+ * @userData               - Passed to @callback
+ */
+struct uvr_vk_memory_budget_create_info {
+  VkPhysicalDevice        vkPhdev;
+  struct uvr_vk_allocator *allocator;
+  VkBool32                budgetExtensionEnabled;
+  float                   highWaterMark;
+  float                   lowWaterMark;
+  uvr_vk_memory_budget_cb callback;
+  void                    *userData;
+};
+
+
+/*
+ * uvr_vk_memory_budget_create: Sets up per heap budget tracking and takes an initial sample. Nothing is allocated,
+ *                              struct uvr_vk_memory_budget needs no destruction.
  *
  * args:
- * @uvrvk - pointer to a struct uvr_vk_command_buffer_record_info
+ * @uvrvk - pointer to a struct uvr_vk_memory_budget_create_info
  * return:
- *    on success 0
- *    on failure -1
+ *    on success struct uvr_vk_memory_budget
+ *    on failure struct uvr_vk_memory_budget { with members nulled }
  */
-int uvr_vk_command_buffer_record_begin(struct uvr_vk_command_buffer_record_info *uvrvk);
+struct uvr_vk_memory_budget uvr_vk_memory_budget_create(struct uvr_vk_memory_budget_create_info *uvrvk);
 
 
 /*
- * uvr_vk_command_buffer_record_end: Function stops command buffer to recording. Thus, ending each command buffers ability to accept commands.
+ * uvr_vk_memory_budget_sample: Refreshes every heap's budget and usage, updates pressure state and invokes
+ *                              struct uvr_vk_memory_budget { member: callback } for heaps that crossed a mark.
+ *                              Cheap enough to call once per frame.
  *
  * args:
- * @uvrvk - pointer to a struct uvr_vk_command_buffer_record_info
+ * @budget - pointer to a struct uvr_vk_memory_budget
  * return:
- *    on success 0
- *    on failure -1
+ *    Amount of heaps currently under pressure
  */
-int uvr_vk_command_buffer_record_end(struct uvr_vk_command_buffer_record_info *uvrvk);
+uint32_t uvr_vk_memory_budget_sample(struct uvr_vk_memory_budget *budget);
 
 
 /*
- * struct uvr_vk_fence_handle (Underview Renderer Vulkan Fence Handle)
+ * Opaque VkFormatProperties storage of a struct uvr_vk_format_cache.
+ * uvr_vk_format_cache_entries - Mutex protected properties of every core format plus hit/miss counters
+ */
+struct uvr_vk_format_cache_entries;
+
+
+/*
+ * struct uvr_vk_format_cache (Underview Renderer Vulkan Format Cache)
  *
- * @fence - May be used to insert a dependency from a queue to the host. Used to block host (CPU) operations
- *          until commands in a command buffer are finished. Keeps CPU and GPU in sync.
+ * members:
+ * @vkPhdev - Physical device format capabilities are queried from
+ * @entries - Lazily populated VkFormatProperties of every core VkFormat. Safe to share between threads.
  */
-struct uvr_vk_fence_handle {
-  VkFence fence;
+struct uvr_vk_format_cache {
+  VkPhysicalDevice                   vkPhdev;
+  struct uvr_vk_format_cache_entries *entries;
 };
 
 
 /*
- * struct uvr_vk_semaphore_handle (Underview Renderer Vulkan Semaphore Handle)
+ * struct uvr_vk_format_cache_create_info (Underview Renderer Vulkan Format Cache Create Information)
  *
- * @semaphore - May be used to insert a dependency between queue operations or between a queue operation
- *              and the host. Used to block queue operations until commands in a command buffer are finished.
+ * members:
+ * @vkPhdev - Must pass a valid VkPhysicalDevice handle
  */
-struct uvr_vk_semaphore_handle {
-  VkSemaphore semaphore;
+struct uvr_vk_format_cache_create_info {
+  VkPhysicalDevice vkPhdev;
 };
 
 
 /*
- * struct uvr_vk_sync_obj (Underview Renderer Vulkan Synchronization Objects)
+ * uvr_vk_format_cache_create: Creates a VkFormatProperties cache. vkGetPhysicalDeviceFormatProperties is only
+ *                             called the first time a format is looked up, every following lookup is a table read.
+ *
+ * args:
+ * @uvrvk - pointer to a struct uvr_vk_format_cache_create_info
+ * return:
+ *    on success struct uvr_vk_format_cache
+ *    on failure struct uvr_vk_format_cache { with member nulled }
+ */
+struct uvr_vk_format_cache uvr_vk_format_cache_create(struct uvr_vk_format_cache_create_info *uvrvk);
+
+
+/*
+ * uvr_vk_format_cache_get: Returns the VkFormatProperties of @format. Extension formats outside the core
+ *                          range aren't cached and are queried on every call.
+ *
+ * args:
+ * @cache  - pointer to a struct uvr_vk_format_cache
+ * @format - VkFormat to look up
+ * return:
+ *    VkFormatProperties of @format
+ */
+VkFormatProperties uvr_vk_format_cache_get(struct uvr_vk_format_cache *cache, VkFormat format);
+
+
+/*
+ * uvr_vk_format_cache_select: Picks the first format in @pFormats whose @tiling features contain every bit in @features
+ *
+ * args:
+ * @cache       - pointer to a struct uvr_vk_format_cache
+ * @pFormats    - Pointer to an array of candidate formats in order of preference
+ * @formatCount - Amount of elements in @pFormats
+ * @tiling      - VK_IMAGE_TILING_LINEAR or VK_IMAGE_TILING_OPTIMAL
+ * @features    - Format features the selected format must support
+ * return:
+ *    on success selected VkFormat
+ *    on failure VK_FORMAT_UNDEFINED
+ */
+VkFormat uvr_vk_format_cache_select(struct uvr_vk_format_cache *cache, const VkFormat *pFormats, uint32_t formatCount,
+                                    VkImageTiling tiling, VkFormatFeatureFlags features);
+
+
+/* Opaque level views and descriptor pool of a texture downsampled by a struct uvr_vk_texture_downsampler */
+struct uvr_vk_texture_downsample_pending;
+
+
+/*
+ * struct uvr_vk_texture_downsampler (Underview Renderer Vulkan Texture Downsampler)
  *
  * members:
- * @vkDevice       - Logical device used to create command pool/buffers
- * @fenceCount     - Amount of handles in @vkFence array
- * @vkFences       - Pointer to an array of VkFence handles
- * @semaphoreCount - Amount of handles in @vkSemaphore array
- * @vkSemaphores   - Pointer to an array of VkSemaphore handles
+ * @vkDevice              - Logical device used to create the pipeline and layouts
+ * @format                - Format the compute shader's storage images are declared with
+ * @pipeline              - Compute pipeline running the downsample shader
+ * @vkDescriptorSetLayout - Set 0. Binding 0 is the source level, binding 1 the destination level, both storage images.
+ * @vkPipelineLayout      - Pipeline layout containing @vkDescriptorSetLayout
+ * @pendingCount          - Amount of textures whose level views and descriptor pool await their upload
+ * @pendingCapacity       - Amount of elements allocated for @pending
+ * @pending               - Pointer to an array of said per texture resources. Destroyed by uvr_vk_texture_create(3)
+ *                          once the upload ring retired their batch.
  */
-struct uvr_vk_sync_obj {
-  VkDevice vkDevice;
-  uint32_t fenceCount;
-  struct uvr_vk_fence_handle *vkFences;
-  uint32_t semaphoreCount;
-  struct uvr_vk_semaphore_handle *vkSemaphores;
+struct uvr_vk_texture_downsampler {
+  VkDevice                                 vkDevice;
+  VkFormat                                 format;
+  struct uvr_vk_compute_pipeline           pipeline;
+  VkDescriptorSetLayout                    vkDescriptorSetLayout;
+  VkPipelineLayout                         vkPipelineLayout;
+  uint32_t                                 pendingCount;
+  uint32_t                                 pendingCapacity;
+  struct uvr_vk_texture_downsample_pending *pending;
 };
 
 
 /*
- * struct uvr_vk_sync_obj_create_info (Underview Renderer Vulkan Command Buffer Create Information)
+ * struct uvr_vk_texture_downsampler_create_info (Underview Renderer Vulkan Texture Downsampler Create Information)
  *
  * members:
- * @vkDevice       - Must pass a valid active logical device
- * @fenceCount     - Amount of VkFence objects to allocate.
- * @semaphoreCount - Amount of VkSemaphore objects to allocate.
+ * @vkPhdev         - Must pass a valid VkPhysicalDevice handle. Used to query compute workgroup limits.
+ * @vkDevice        - Must pass a valid active logical device
+ * @shader          - Must pass a valid compute VkShaderModule handle. One invocation per destination texel reads
+ *                    the 2x2 source texels from set 0 binding 0 and writes their average to set 0 binding 1.
+ *                    Invocations outside the destination level must return early.
+ * @localSize       - Workgroup size the shader was compiled with
+ * @format          - Format the shader's storage images are declared with. i.e. VK_FORMAT_R8G8B8A8_UNORM for rgba8.
+ *                    Textures created in any other format aren't downsampled with it.
+ * @vkPipelineCache - Optional VkPipelineCache handle. May be VK_NULL_HANDLE.
  */
-struct uvr_vk_sync_obj_create_info {
-  VkDevice vkDevice;
-  uint32_t fenceCount;
-  uint32_t semaphoreCount;
+struct uvr_vk_texture_downsampler_create_info {
+  VkPhysicalDevice vkPhdev;
+  VkDevice         vkDevice;
+  VkShaderModule   shader;
+  uint32_t         localSize[3];
+  VkFormat         format;
+  VkPipelineCache  vkPipelineCache;
 };
 
 
 /*
- * uvr_vk_sync_obj_create: Creates VkFence and VkSemaphore synchronization objects. Vulkan API calls that execute work
- *                         on the GPU happen asynchronously. Vulkan API function calls return before operations are fully finished.
- *                         So we need synchronization objects to make sure operations that require other operations to finish can
- *                         happen after.
+ * uvr_vk_texture_downsampler_create: Creates the compute pipeline uvr_vk_texture_create(3) generates mip levels with
+ *                                    when blits aren't available, i.e. on an async compute queue. A downsampler
+ *                                    must only be used with a single struct uvr_vk_upload_ring.
+ *
+ * args:
+ * @uvrvk - pointer to a struct uvr_vk_texture_downsampler_create_info
+ * return:
+ *    on success struct uvr_vk_texture_downsampler
+ *    on failure struct uvr_vk_texture_downsampler { with member nulled }
+ */
+struct uvr_vk_texture_downsampler uvr_vk_texture_downsampler_create(struct uvr_vk_texture_downsampler_create_info *uvrvk);
+
+
+/*
+ * enum uvr_vk_texture_mipmap_mode (Underview Renderer Vulkan Texture Mipmap Mode)
+ *
+ * How the mip chain of a struct uvr_vk_texture is generated
+ *
+ * UVR_VK_TEXTURE_MIPMAP_NONE    - Single level texture
+ * UVR_VK_TEXTURE_MIPMAP_BLIT    - vkCmdBlitImage in the upload ring's batch
+ * UVR_VK_TEXTURE_MIPMAP_COMPUTE - struct uvr_vk_texture_downsampler dispatches in the upload ring's batch
+ * UVR_VK_TEXTURE_MIPMAP_HOST    - Box filtered on the host and staged along with level 0
+ */
+typedef enum uvr_vk_texture_mipmap_mode {
+  UVR_VK_TEXTURE_MIPMAP_NONE    = 0,
+  UVR_VK_TEXTURE_MIPMAP_BLIT    = 1,
+  UVR_VK_TEXTURE_MIPMAP_COMPUTE = 2,
+  UVR_VK_TEXTURE_MIPMAP_HOST    = 3,
+} uvr_vk_texture_mipmap_mode;
+
+
+/*
+ * struct uvr_vk_texture (Underview Renderer Vulkan Texture)
+ *
+ * members:
+ * @vkDevice    - Logical device used when texture was created
+ * @image       - Single optimal tiling image plus a VkImageView covering every mip level. Left in
+ *                VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL once the upload completes.
+ * @format      - VkFormat selected from struct uvr_vk_texture_create_info { member: pFormats }
+ * @extent3D    - Size in texels of mip level 0
+ * @mipLevels   - Amount of mip levels in @image
+ * @mipmapMode  - How the mip levels are generated
+ * @uploadId    - Upload ID of the struct uvr_vk_upload_ring batch every level was recorded into
+ * @uploadBytes - Bytes staged in the upload ring
+ * @stageNs     - Nanoseconds spent writing level 0 into the upload ring
+ * @mipmapNs    - Nanoseconds spent downsampling on the host. Zero for blits and dispatches, time those with
+ *                struct uvr_vk_texture_create_info { member: queryPool }.
+ */
+struct uvr_vk_texture {
+  VkDevice                   vkDevice;
+  struct uvr_vk_image        image;
+  VkFormat                   format;
+  VkExtent3D                 extent3D;
+  uint32_t                   mipLevels;
+  uvr_vk_texture_mipmap_mode mipmapMode;
+  uint64_t                   uploadId;
+  uint64_t                   uploadBytes;
+  uint64_t                   stageNs;
+  uint64_t                   mipmapNs;
+};
+
+
+/*
+ * struct uvr_vk_texture_create_info (Underview Renderer Vulkan Texture Create Information)
  *
+ * members:
+ * @allocator   - Must pass a pointer to a valid struct uvr_vk_allocator. Image is allocated from it.
+ * @formatCache - Must pass a pointer to a valid struct uvr_vk_format_cache created for the allocator's physical device
+ * @uploadRing  - Must pass a pointer to a valid struct uvr_vk_upload_ring created from the same logical device. Texels
+ *                are staged in it and mip levels are blitted in its current batch if the ring's source queue family
+ *                supports graphics. Its alignment must be a multiple of the texel size and 4.
+ * @pFormats    - Candidate formats in order of preference. @pData is laid out in @pFormats[0]. Other candidates
+ *                must be the sRGB/UNORM twin or the R/B swapped 8-bit twin of @pFormats[0], the latter is
+ *                swizzled while staging.
+ * @formatCount - Amount of elements in @pFormats
+ * @extent2D    - Size in texels of mip level 0
+ * @mipLevels   - Amount of mip levels. If zero the full chain down to 1x1 is created.
+ * @imageUsage  - Usage on top of VK_IMAGE_USAGE_SAMPLED_BIT and the transfer bits uploads require
+ * @pData       - Pointer to tightly packed texel data of mip level 0
+ * @size        - Size in bytes of @pData
+ * @downsampler - Optional pointer to a struct uvr_vk_texture_downsampler used when mip levels can't be blitted and
+ *                its format is one of @pFormats. Requires the ring's source queue family to support compute.
+ *                May be NULL.
+ * @queryPool   - Optional pointer to a struct uvr_vk_query_pool. If set blits/dispatches are wrapped in a GPU timing scope
+ *                named "uvr_vk_texture_mipmaps". Its frame slot is reset in the upload ring's command buffer,
+ *                so the pool should be dedicated to uploads. May be NULL.
+ */
+struct uvr_vk_texture_create_info {
+  struct uvr_vk_allocator           *allocator;
+  struct uvr_vk_format_cache        *formatCache;
+  struct uvr_vk_upload_ring         *uploadRing;
+  const VkFormat                    *pFormats;
+  uint32_t                          formatCount;
+  VkExtent2D                        extent2D;
+  uint32_t                          mipLevels;
+  VkImageUsageFlags                 imageUsage;
+  const void                        *pData;
+  VkDeviceSize                      size;
+  struct uvr_vk_texture_downsampler *downsampler;
+  struct uvr_vk_query_pool          *queryPool;
+};
+
+
+/*
+ * uvr_vk_texture_create: Creates a sampled 2D texture. Level 0 is staged in the upload ring and copied, then
+ *                        mip levels are generated in the same batch with vkCmdBlitImage. Formats without
+ *                        linear blit support, or rings without a graphics queue, are downsampled with the
+ *                        struct uvr_vk_texture_create_info { member: downsampler } compute pipeline if possible,
+ *                        otherwise fall back to a host box filter whose levels are staged together with level 0.
+ *                        Nothing is submitted or waited on, flush the ring with uvr_vk_upload_ring_flush(3) and
+ *                        wait for struct uvr_vk_texture { member: uploadId } with uvr_vk_upload_ring_poll(3) (plus
+ *                        uvr_vk_upload_ring_record_acquire(3) if the ring's queue families differ) before sampling it.
  *
  * args:
- * @uvrvk - pointer to a struct uvr_vk_sync_obj_create_info
+ * @uvrvk - pointer to a struct uvr_vk_texture_create_info
  * return:
- *    on success struct uvr_vk_sync_obj
- *    on failure struct uvr_vk_sync_obj { with member nulled }
+ *    on success struct uvr_vk_texture
+ *    on failure struct uvr_vk_texture { with member nulled }
  */
-struct uvr_vk_sync_obj uvr_vk_sync_obj_create(struct uvr_vk_sync_obj_create_info *uvrvk);
+struct uvr_vk_texture uvr_vk_texture_create(struct uvr_vk_texture_create_info *uvrvk);
+
+
+/*
+ * struct uvr_vk_texture_stats (Underview Renderer Vulkan Texture Statistics)
+ *
+ * members:
+ * @uploadBytes - Bytes staged in the upload ring. GPU throughput is reported by uvr_vk_upload_ring_get_stats(3).
+ * @stageMs     - Milliseconds spent writing level 0 into the upload ring
+ * @mipmapMs    - Milliseconds spent downsampling on the host
+ * @mipLevels   - Amount of mip levels in the texture
+ * @mipmapMode  - How the mip levels are generated
+ */
+struct uvr_vk_texture_stats {
+  uint64_t                   uploadBytes;
+  double                     stageMs;
+  double                     mipmapMs;
+  uint32_t                   mipLevels;
+  uvr_vk_texture_mipmap_mode mipmapMode;
+};
+
+
+/*
+ * uvr_vk_texture_get_stats: Reports staging and host mip generation time of a texture
+ *
+ * args:
+ * @texture - pointer to a struct uvr_vk_texture
+ * return:
+ *    populated struct uvr_vk_texture_stats
+ */
+struct uvr_vk_texture_stats uvr_vk_texture_get_stats(struct uvr_vk_texture *texture);
 
 
 /*
@@ -957,12 +5020,52 @@ struct uvr_vk_sync_obj uvr_vk_sync_obj_create(struct uvr_vk_sync_obj_create_info
  * @uvr_vk_pipeline_layout       - Must pass a pointer to an array of valid struct uvr_vk_pipeline_layout { free'd members: VkPipelineLayout handle }
  * @uvr_vk_graphics_pipeline_cnt - Must pass the amount of elements in struct uvr_vk_graphics_pipeline array
  * @uvr_vk_graphics_pipeline     - Must pass a pointer to an array of valid struct uvr_vk_graphics_pipeline { free'd members: VkPipeline handle }
+ * @uvr_vk_compute_pipeline_cnt  - Must pass the amount of elements in struct uvr_vk_compute_pipeline array
+ * @uvr_vk_compute_pipeline      - Must pass a pointer to an array of valid struct uvr_vk_compute_pipeline { free'd members: VkPipeline handle }
+ * @uvr_vk_pipeline_library_cnt  - Must pass the amount of elements in struct uvr_vk_pipeline_library array
+ * @uvr_vk_pipeline_library      - Must pass a pointer to an array of valid struct uvr_vk_pipeline_library { free'd members: VkPipeline handles, *threadPool, *variants }
+ * @uvr_vk_object_cache_cnt      - Must pass the amount of elements in struct uvr_vk_object_cache array
+ * @uvr_vk_object_cache          - Must pass a pointer to an array of valid struct uvr_vk_object_cache { free'd members: cached VkPipeline, VkRenderPass and VkSampler handles, *tables }
  * @uvr_vk_framebuffer_cnt       - Must pass the amount of elements in struct uvr_vk_framebuffer array
  * @uvr_vk_framebuffer           - Must pass a pointer to an array of valid struct uvr_vk_framebuffer { free'd members: VkFramebuffer handle, *vkfbs }
  * @uvr_vk_command_buffer_cnt    - Must pass the amount of elements in struct uvr_vk_command_buffer array
  * @uvr_vk_command_buffer        - Must pass a pointer to an array of valid struct uvr_vk_command_buffer { free'd members: VkCommandPool handle, *vkCommandbuffers }
  * @uvr_vk_sync_obj_cnt          - Must pass the amount of elements in struct uvr_vk_sync_obj array
  * @uvr_vk_sync_obj              - Must pass a pointer to an array of valid struct uvr_vk_sync_obj { free'd members: VkFence handle, VkSemaphore handle, *vkFences, *vkSemaphores }
+ *                                 All fences are waited on in a single call. Device is idled before timeline semaphores are destroyed.
+ * @uvr_vk_buffer_cnt            - Must pass the amount of elements in struct uvr_vk_buffer array
+ * @uvr_vk_buffer                - Must pass a pointer to an array of valid struct uvr_vk_buffer { free'd members: VkBuffer handle, allocation }
+ * @uvr_vk_allocator_cnt         - Must pass the amount of elements in struct uvr_vk_allocator array
+ * @uvr_vk_allocator             - Must pass a pointer to an array of valid struct uvr_vk_allocator { free'd members: VkDeviceMemory handles, *blocks }
+ * @uvr_vk_pipeline_cache_cnt    - Must pass the amount of elements in struct uvr_vk_pipeline_cache array
+ * @uvr_vk_pipeline_cache        - Must pass a pointer to an array of valid struct uvr_vk_pipeline_cache { stored to @filePath, free'd members: VkPipelineCache handle }
+ * @uvr_vk_frame_ring_cnt        - Must pass the amount of elements in struct uvr_vk_frame_ring array
+ * @uvr_vk_frame_ring            - Must pass a pointer to an array of valid struct uvr_vk_frame_ring { free'd members: VkCommandPool handle, VkFence handles, VkSemaphore handles, *imageFences, retired swapchains, *retired }
+ * @uvr_vk_command_recorder_cnt  - Must pass the amount of elements in struct uvr_vk_command_recorder array
+ * @uvr_vk_command_recorder      - Must pass a pointer to an array of valid struct uvr_vk_command_recorder { joined: worker threads, free'd members: VkCommandPool handles, *threadCommandbuffs, *threadPool }
+ * @uvr_vk_command_replay_cnt    - Must pass the amount of elements in struct uvr_vk_command_replay array
+ * @uvr_vk_command_replay        - Must pass a pointer to an array of valid struct uvr_vk_command_replay { free'd members: VkCommandPool handle, *images }
+ *                                 Destroyed after struct uvr_vk_frame_ring fences were waited on.
+ * @uvr_vk_query_pool_cnt        - Must pass the amount of elements in struct uvr_vk_query_pool array
+ * @uvr_vk_query_pool            - Must pass a pointer to an array of valid struct uvr_vk_query_pool { free'd members: VkQueryPool handles, *frames, *scopes, *names, *history, *results }
+ * @uvr_vk_upload_ring_cnt       - Must pass the amount of elements in struct uvr_vk_upload_ring array
+ * @uvr_vk_upload_ring           - Must pass a pointer to an array of valid struct uvr_vk_upload_ring { waited on, free'd members: buffer, VkCommandPool handle, VkFence handles, VkSemaphore handle, *batches }
+ * @uvr_vk_descriptor_allocator_cnt - Must pass the amount of elements in struct uvr_vk_descriptor_allocator array
+ * @uvr_vk_descriptor_allocator     - Must pass a pointer to an array of valid struct uvr_vk_descriptor_allocator { free'd members: VkDescriptorPool handles, cached VkDescriptorSetLayout handles, *threads, *framePools, *layoutCache }
+ * @uvr_vk_bindless_table_cnt       - Must pass the amount of elements in struct uvr_vk_bindless_table array
+ * @uvr_vk_bindless_table           - Must pass a pointer to an array of valid struct uvr_vk_bindless_table { free'd members: VkDescriptorPool handle, VkDescriptorSetLayout handle, *freeSlots, *liveSlots, *retired }
+ * @uvr_vk_deletion_queue_cnt       - Must pass the amount of elements in struct uvr_vk_deletion_queue array
+ * @uvr_vk_deletion_queue           - Must pass a pointer to an array of valid struct uvr_vk_deletion_queue { flushed: every queued resource, free'd members: *entries }
+ * @uvr_vk_headless_target_cnt      - Must pass the amount of elements in struct uvr_vk_headless_target array
+ * @uvr_vk_headless_target          - Must pass a pointer to an array of valid struct uvr_vk_headless_target { waited on, free'd members: images, readbackBuffer, VkCommandPool handle, VkFence handles, *pendingFrames }
+ * @uvr_vk_format_cache_cnt         - Must pass the amount of elements in struct uvr_vk_format_cache array
+ * @uvr_vk_format_cache             - Must pass a pointer to an array of valid struct uvr_vk_format_cache { free'd members: *entries }
+ * @uvr_vk_texture_cnt              - Must pass the amount of elements in struct uvr_vk_texture array
+ * @uvr_vk_texture                  - Must pass a pointer to an array of valid struct uvr_vk_texture { free'd members: VkImageView handle, VkImage handle, image allocation }
+ *                                    Destroyed after struct uvr_vk_upload_ring fences were waited on.
+ * @uvr_vk_texture_downsampler_cnt  - Must pass the amount of elements in struct uvr_vk_texture_downsampler array
+ * @uvr_vk_texture_downsampler      - Must pass a pointer to an array of valid struct uvr_vk_texture_downsampler { free'd members: pipeline, VkPipelineLayout handle, VkDescriptorSetLayout handle, *pending }
+ *                                    Destroyed after struct uvr_vk_upload_ring fences were waited on.
  */
 struct uvr_vk_destroy {
   VkInstance vkinst;
@@ -989,6 +5092,15 @@ struct uvr_vk_destroy {
   uint32_t uvr_vk_graphics_pipeline_cnt;
   struct uvr_vk_graphics_pipeline *uvr_vk_graphics_pipeline;
 
+  uint32_t uvr_vk_compute_pipeline_cnt;
+  struct uvr_vk_compute_pipeline *uvr_vk_compute_pipeline;
+
+  uint32_t uvr_vk_pipeline_library_cnt;
+  struct uvr_vk_pipeline_library *uvr_vk_pipeline_library;
+
+  uint32_t uvr_vk_object_cache_cnt;
+  struct uvr_vk_object_cache *uvr_vk_object_cache;
+
   uint32_t uvr_vk_framebuffer_cnt;
   struct uvr_vk_framebuffer *uvr_vk_framebuffer;
 
@@ -997,6 +5109,51 @@ struct uvr_vk_destroy {
 
   uint32_t uvr_vk_sync_obj_cnt;
   struct uvr_vk_sync_obj *uvr_vk_sync_obj;
+
+  uint32_t uvr_vk_buffer_cnt;
+  struct uvr_vk_buffer *uvr_vk_buffer;
+
+  uint32_t uvr_vk_allocator_cnt;
+  struct uvr_vk_allocator *uvr_vk_allocator;
+
+  uint32_t uvr_vk_pipeline_cache_cnt;
+  struct uvr_vk_pipeline_cache *uvr_vk_pipeline_cache;
+
+  uint32_t uvr_vk_frame_ring_cnt;
+  struct uvr_vk_frame_ring *uvr_vk_frame_ring;
+
+  uint32_t uvr_vk_command_recorder_cnt;
+  struct uvr_vk_command_recorder *uvr_vk_command_recorder;
+
+  uint32_t uvr_vk_command_replay_cnt;
+  struct uvr_vk_command_replay *uvr_vk_command_replay;
+
+  uint32_t uvr_vk_query_pool_cnt;
+  struct uvr_vk_query_pool *uvr_vk_query_pool;
+
+  uint32_t uvr_vk_upload_ring_cnt;
+  struct uvr_vk_upload_ring *uvr_vk_upload_ring;
+
+  uint32_t uvr_vk_descriptor_allocator_cnt;
+  struct uvr_vk_descriptor_allocator *uvr_vk_descriptor_allocator;
+
+  uint32_t uvr_vk_bindless_table_cnt;
+  struct uvr_vk_bindless_table *uvr_vk_bindless_table;
+
+  uint32_t uvr_vk_deletion_queue_cnt;
+  struct uvr_vk_deletion_queue *uvr_vk_deletion_queue;
+
+  uint32_t uvr_vk_headless_target_cnt;
+  struct uvr_vk_headless_target *uvr_vk_headless_target;
+
+  uint32_t uvr_vk_format_cache_cnt;
+  struct uvr_vk_format_cache *uvr_vk_format_cache;
+
+  uint32_t uvr_vk_texture_cnt;
+  struct uvr_vk_texture *uvr_vk_texture;
+
+  uint32_t uvr_vk_texture_downsampler_cnt;
+  struct uvr_vk_texture_downsampler *uvr_vk_texture_downsampler;
 };
 
 
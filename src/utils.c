@@ -1,3 +1,5 @@
+#include <stdlib.h>
+#include <string.h>
 #include <errno.h>
 #include <unistd.h>
 #include <fcntl.h>
@@ -97,3 +99,129 @@ int allocate_shm_file(size_t size) {
 
   return fd;
 }
+
+
+struct uvr_utils_thread_pool_job {
+  void (*func)(void *);
+  void *arg;
+  struct uvr_utils_thread_pool_job *next;
+};
+
+
+static void *thread_pool_worker(void *data) {
+  struct uvr_utils_thread_pool *pool = data;
+  struct uvr_utils_thread_pool_job *job = NULL;
+
+  pthread_mutex_lock(&pool->lock);
+  while (1) {
+    while (!pool->head && !pool->shutdown)
+      pthread_cond_wait(&pool->jobCond, &pool->lock);
+
+    if (!pool->head && pool->shutdown)
+      break;
+
+    job = pool->head;
+    pool->head = job->next;
+    if (!pool->head)
+      pool->tail = NULL;
+
+    pthread_mutex_unlock(&pool->lock);
+    job->func(job->arg);
+    free(job);
+    pthread_mutex_lock(&pool->lock);
+
+    if (--pool->pending == 0)
+      pthread_cond_broadcast(&pool->idleCond);
+  }
+  pthread_mutex_unlock(&pool->lock);
+
+  return NULL;
+}
+
+
+int uvr_utils_thread_pool_create(struct uvr_utils_thread_pool *pool, uint32_t threadCount) {
+  uint32_t t;
+  int err;
+
+  memset(pool, 0, sizeof(struct uvr_utils_thread_pool));
+
+  pool->threads = calloc(threadCount, sizeof(pthread_t));
+  if (!pool->threads) {
+    uvr_utils_log(UVR_DANGER, "[x] calloc: %s", strerror(errno));
+    return -1;
+  }
+
+  pthread_mutex_init(&pool->lock, NULL);
+  pthread_cond_init(&pool->jobCond, NULL);
+  pthread_cond_init(&pool->idleCond, NULL);
+
+  for (t = 0; t < threadCount; t++) {
+    err = pthread_create(&pool->threads[t], NULL, thread_pool_worker, pool);
+    if (err) {
+      uvr_utils_log(UVR_DANGER, "[x] pthread_create: %s", strerror(err));
+      pool->threadCount = t;
+      uvr_utils_thread_pool_destroy(pool);
+      return -1;
+    }
+  }
+
+  pool->threadCount = threadCount;
+  return 0;
+}
+
+
+int uvr_utils_thread_pool_submit(struct uvr_utils_thread_pool *pool, void (*func)(void *), void *arg) {
+  struct uvr_utils_thread_pool_job *job = NULL;
+
+  job = calloc(1, sizeof(struct uvr_utils_thread_pool_job));
+  if (!job) {
+    uvr_utils_log(UVR_DANGER, "[x] calloc: %s", strerror(errno));
+    return -1;
+  }
+
+  job->func = func;
+  job->arg = arg;
+
+  pthread_mutex_lock(&pool->lock);
+  if (pool->tail)
+    pool->tail->next = job;
+  else
+    pool->head = job;
+  pool->tail = job;
+  pool->pending++;
+  pthread_cond_signal(&pool->jobCond);
+  pthread_mutex_unlock(&pool->lock);
+
+  return 0;
+}
+
+
+void uvr_utils_thread_pool_wait(struct uvr_utils_thread_pool *pool) {
+  pthread_mutex_lock(&pool->lock);
+  while (pool->pending)
+    pthread_cond_wait(&pool->idleCond, &pool->lock);
+  pthread_mutex_unlock(&pool->lock);
+}
+
+
+void uvr_utils_thread_pool_destroy(struct uvr_utils_thread_pool *pool) {
+  uint32_t t;
+
+  if (!pool->threads)
+    return;
+
+  pthread_mutex_lock(&pool->lock);
+  pool->shutdown = true;
+  pthread_cond_broadcast(&pool->jobCond);
+  pthread_mutex_unlock(&pool->lock);
+
+  for (t = 0; t < pool->threadCount; t++)
+    pthread_join(pool->threads[t], NULL);
+
+  pthread_cond_destroy(&pool->idleCond);
+  pthread_cond_destroy(&pool->jobCond);
+  pthread_mutex_destroy(&pool->lock);
+  free(pool->threads);
+  pool->threads = NULL;
+  pool->threadCount = 0;
+}
@@ -2,10 +2,16 @@
 #include <stdio.h>
 #include <errno.h>
 #include <string.h>
+#include <stdarg.h>
 #include <math.h>
+#include <time.h>
+#include <unistd.h>
 #include <fcntl.h>
 #include <sys/stat.h>
 #include <sys/sysmacros.h>
+#ifdef INCLUDE_VULKAN_DLOPEN
+#include <dlfcn.h>
+#endif
 #include "vulkan.h"
 
 
@@ -94,10 +100,175 @@ static const char *vkres_msg(int err) {
 }
 
 
+/*
+ * Loader entry points for the hot path device functions. Valid for any VkDevice,
+ * used whenever a per-device table can't be picked (see uvr_vk_device_dispatch_get).
+ * With INCLUDE_VULKAN_DLOPEN populated once the VkInstance exists.
+ */
+#ifdef INCLUDE_VULKAN_DLOPEN
+static struct uvr_vk_device_dispatch loaderDispatch = { .vkDevice = VK_NULL_HANDLE };
+#else
+#define UVR_VK_DISPATCH_LOADER_INIT(func) .func = vk##func,
+static struct uvr_vk_device_dispatch loaderDispatch = {
+  .vkDevice = VK_NULL_HANDLE,
+  UVR_VK_DEVICE_DISPATCH_FUNCS(UVR_VK_DISPATCH_LOADER_INIT)
+};
+#undef UVR_VK_DISPATCH_LOADER_INIT
+#endif
+
+
+#ifdef INCLUDE_VULKAN_DLOPEN
+static void *vulkanLibrary = NULL;
+
+PFN_vkGetInstanceProcAddr vkGetInstanceProcAddr = NULL;
+#define UVR_VK_LOADER_DEFINE(func) PFN_vk##func vk##func = NULL;
+UVR_VK_LOADER_GLOBAL_FUNCS(UVR_VK_LOADER_DEFINE)
+UVR_VK_LOADER_INSTANCE_FUNCS(UVR_VK_LOADER_DEFINE)
+UVR_VK_LOADER_DEVICE_FUNCS(UVR_VK_LOADER_DEFINE)
+#undef UVR_VK_LOADER_DEFINE
+
+
+/* Opens the Vulkan loader and resolves functions callable without a VkInstance */
+static int loader_open(void) {
+  if (vulkanLibrary)
+    return 0;
+
+  vulkanLibrary = dlopen("libvulkan.so.1", RTLD_NOW | RTLD_LOCAL);
+  if (!vulkanLibrary)
+    vulkanLibrary = dlopen("libvulkan.so", RTLD_NOW | RTLD_LOCAL);
+
+  if (!vulkanLibrary) {
+    uvr_utils_log(UVR_DANGER, "[x] dlopen: %s", dlerror());
+    return -1;
+  }
+
+  *(void **) &vkGetInstanceProcAddr = dlsym(vulkanLibrary, "vkGetInstanceProcAddr");
+  if (!vkGetInstanceProcAddr) {
+    uvr_utils_log(UVR_DANGER, "[x] dlsym: %s", dlerror());
+    dlclose(vulkanLibrary);
+    vulkanLibrary = NULL;
+    return -1;
+  }
+
+#define UVR_VK_LOADER_GLOBAL(func) UVR_VK_INSTANCE_PROC_ADDR(VK_NULL_HANDLE, vk##func, func)
+  UVR_VK_LOADER_GLOBAL_FUNCS(UVR_VK_LOADER_GLOBAL)
+#undef UVR_VK_LOADER_GLOBAL
+
+  return 0;
+}
+
+
+static void loader_close(void) {
+  if (!vulkanLibrary)
+    return;
+
+  dlclose(vulkanLibrary);
+  vulkanLibrary = NULL;
+  vkGetInstanceProcAddr = NULL;
+
+#define UVR_VK_LOADER_RESET(func) vk##func = NULL;
+  UVR_VK_LOADER_GLOBAL_FUNCS(UVR_VK_LOADER_RESET)
+  UVR_VK_LOADER_INSTANCE_FUNCS(UVR_VK_LOADER_RESET)
+  UVR_VK_LOADER_DEVICE_FUNCS(UVR_VK_LOADER_RESET)
+#undef UVR_VK_LOADER_RESET
+
+  memset(&loaderDispatch, 0, sizeof(loaderDispatch));
+}
+#endif
+
+
+/*
+ * Tables populated by uvr_vk_lgdev_create(3). @defaultDispatch is read without
+ * holding @dispatchLock so command buffer level calls (which have no VkDevice at
+ * hand) never contend on it. It points at the only live device's table or at
+ * @loaderDispatch when zero or several devices exist.
+ */
+#define UVR_VK_DISPATCH_MAX_DEVICES 8
+static pthread_mutex_t dispatchLock = PTHREAD_MUTEX_INITIALIZER;
+static struct uvr_vk_device_dispatch *dispatchTables[UVR_VK_DISPATCH_MAX_DEVICES];
+static uint32_t dispatchTableCount = 0;
+static const struct uvr_vk_device_dispatch *defaultDispatch = &loaderDispatch;
+
+
+/* Must be called with @dispatchLock held */
+static void dispatch_default_update(void) {
+  const struct uvr_vk_device_dispatch *dispatch = (dispatchTableCount == 1) ? dispatchTables[0] : &loaderDispatch;
+  __atomic_store_n(&defaultDispatch, dispatch, __ATOMIC_RELEASE);
+}
+
+
+static struct uvr_vk_device_dispatch *dispatch_create(VkDevice device) {
+  struct uvr_vk_device_dispatch *dispatch = NULL;
+
+  dispatch = (struct uvr_vk_device_dispatch *) calloc(1, sizeof(struct uvr_vk_device_dispatch));
+  if (!dispatch) {
+    uvr_utils_log(UVR_DANGER, "[x] calloc: %s", strerror(errno));
+    return NULL;
+  }
+
+  /*
+   * Entry points of extensions the device was created without (i.e. VK_KHR_swapchain
+   * on a headless device) resolve to NULL, keep the loader's so members are never NULL.
+   */
+  dispatch->vkDevice = device;
+#define UVR_VK_DISPATCH_LOAD(func) \
+  UVR_VK_DEVICE_PROC_ADDR(device, dispatch->func, func) \
+  if (!dispatch->func) \
+    dispatch->func = loaderDispatch.func;
+  UVR_VK_DEVICE_DISPATCH_FUNCS(UVR_VK_DISPATCH_LOAD)
+#undef UVR_VK_DISPATCH_LOAD
+
+  pthread_mutex_lock(&dispatchLock);
+  if (dispatchTableCount < UVR_VK_DISPATCH_MAX_DEVICES) {
+    dispatchTables[dispatchTableCount++] = dispatch;
+    dispatch_default_update();
+  } else {
+    uvr_utils_log(UVR_WARNING, "uvr_vk_lgdev_create: more than %u logical devices, VkDevice(%p) lookups fall back to the loader",
+                               UVR_VK_DISPATCH_MAX_DEVICES, device);
+  }
+  pthread_mutex_unlock(&dispatchLock);
+
+  return dispatch;
+}
+
+
+static void dispatch_destroy(const struct uvr_vk_device_dispatch *dispatch) {
+  uint32_t i;
+
+  if (!dispatch)
+    return;
+
+  pthread_mutex_lock(&dispatchLock);
+  for (i = 0; i < dispatchTableCount; i++) {
+    if (dispatchTables[i] != dispatch)
+      continue;
+
+    dispatchTables[i] = dispatchTables[--dispatchTableCount];
+    dispatch_default_update();
+    break;
+  }
+  pthread_mutex_unlock(&dispatchLock);
+
+  free((void *) dispatch);
+}
+
+
+/*
+ * VkAllocationCallbacks passed to every vkCreate*, vkAllocateMemory, vkFreeMemory
+ * and vkDestroy* call the library makes. Set via uvr_vk_host_allocator_set(3).
+ */
+static const VkAllocationCallbacks *hostCallbacks = NULL;
+
+
 VkInstance uvr_vk_instance_create(struct uvr_vk_instance_create_info *uvrvk) {
   VkResult res = VK_RESULT_MAX_ENUM;
   VkInstance instance = VK_NULL_HANDLE;
 
+#ifdef INCLUDE_VULKAN_DLOPEN
+  if (loader_open() == -1)
+    return VK_NULL_HANDLE;
+#endif
+
   /* initialize the VkApplicationInfo structure */
   VkApplicationInfo app_info = {};
   app_info.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
@@ -130,12 +301,23 @@ VkInstance uvr_vk_instance_create(struct uvr_vk_instance_create_info *uvrvk) {
   create_info.ppEnabledExtensionNames = uvrvk->ppEnabledExtensionNames;
 
   /* Create the instance */
-  res = vkCreateInstance(&create_info, NULL, &instance);
+  res = vkCreateInstance(&create_info, hostCallbacks, &instance);
   if (res) {
     uvr_utils_log(UVR_DANGER, "[x] vkCreateInstance: %s", vkres_msg(res));
     return VK_NULL_HANDLE;
   }
 
+#ifdef INCLUDE_VULKAN_DLOPEN
+#define UVR_VK_LOADER_INSTANCE(func) UVR_VK_INSTANCE_PROC_ADDR(instance, vk##func, func)
+  UVR_VK_LOADER_INSTANCE_FUNCS(UVR_VK_LOADER_INSTANCE)
+  UVR_VK_LOADER_DEVICE_FUNCS(UVR_VK_LOADER_INSTANCE)
+#undef UVR_VK_LOADER_INSTANCE
+
+#define UVR_VK_DISPATCH_LOADER_INIT(func) loaderDispatch.func = vk##func;
+  UVR_VK_DEVICE_DISPATCH_FUNCS(UVR_VK_DISPATCH_LOADER_INIT)
+#undef UVR_VK_DISPATCH_LOADER_INIT
+#endif
+
   uvr_utils_log(UVR_SUCCESS, "uvr_vk_instance_create: VkInstance created retval(%p)", instance);
 
   return instance;
@@ -166,7 +348,7 @@ VkSurfaceKHR uvr_vk_surface_create(struct uvr_vk_surface_create_info *uvrvk) {
     create_info.display = uvrvk->display;
     create_info.surface = uvrvk->surface;
 
-    res = vkCreateWaylandSurfaceKHR(uvrvk->vkInst, &create_info, NULL, &surface);
+    res = vkCreateWaylandSurfaceKHR(uvrvk->vkInst, &create_info, hostCallbacks, &surface);
     if (res) {
       uvr_utils_log(UVR_DANGER, "[x] vkCreateWaylandSurfaceKHR: %s", vkres_msg(res));
       return VK_NULL_HANDLE;
@@ -183,7 +365,7 @@ VkSurfaceKHR uvr_vk_surface_create(struct uvr_vk_surface_create_info *uvrvk) {
     create_info.connection = uvrvk->display;
     create_info.window = uvrvk->window;
 
-    res = vkCreateXcbSurfaceKHR(uvrvk->vkInst, &create_info, NULL, &surface);
+    res = vkCreateXcbSurfaceKHR(uvrvk->vkInst, &create_info, hostCallbacks, &surface);
     if (res) {
       uvr_utils_log(UVR_DANGER, "[x] vkCreateXcbSurfaceKHR: %s", vkres_msg(res));
       return VK_NULL_HANDLE;
@@ -199,27 +381,276 @@ VkSurfaceKHR uvr_vk_surface_create(struct uvr_vk_surface_create_info *uvrvk) {
 }
 
 
-VkPhysicalDevice uvr_vk_phdev_create(struct uvr_vk_phdev_create_info *uvrvk) {
+/* Score weights. Preferred type and DRM node match outweigh any amount of memory or queue bonuses. */
+#define UVR_VK_PHDEV_SCORE_DRM_MATCH          1000000
+#define UVR_VK_PHDEV_SCORE_PREFERRED_TYPE     100000
+#define UVR_VK_PHDEV_SCORE_DEDICATED_QUEUE    500
+#define UVR_VK_PHDEV_SCORE_PER_GIB            100
+
+
+static uint64_t phdev_type_score(VkPhysicalDeviceType type) {
+  switch (type) {
+    case VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU:
+      return 4000;
+    case VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU:
+      return 3000;
+    case VK_PHYSICAL_DEVICE_TYPE_VIRTUAL_GPU:
+      return 2000;
+    case VK_PHYSICAL_DEVICE_TYPE_CPU:
+      return 1000;
+    default:
+      return 0;
+  }
+}
+
+
+static VkPhysicalDeviceType phdev_type_from_env(VkPhysicalDeviceType fallback) {
+  const char *name = getenv("UVR_VK_PHDEV_TYPE");
+
+  if (!name)
+    return fallback;
+
+  if (!strcmp(name, "discrete"))
+    return VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU;
+  if (!strcmp(name, "integrated"))
+    return VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU;
+  if (!strcmp(name, "virtual"))
+    return VK_PHYSICAL_DEVICE_TYPE_VIRTUAL_GPU;
+  if (!strcmp(name, "cpu"))
+    return VK_PHYSICAL_DEVICE_TYPE_CPU;
+  if (!strcmp(name, "other"))
+    return VK_PHYSICAL_DEVICE_TYPE_OTHER;
+
+  uvr_utils_log(UVR_WARNING, "uvr_vk_phdev_rank: UVR_VK_PHDEV_TYPE='%s' unknown, ignoring", name);
+  return fallback;
+}
+
+
+/* Appends to a candidate's reasons string, silently truncating once full */
+static void phdev_reason(struct uvr_vk_phdev_candidate *candidate, const char *fmt, ...) {
+  size_t len = strnlen(candidate->reasons, sizeof(candidate->reasons));
+  va_list args;
+
+  if (len + 1 >= sizeof(candidate->reasons))
+    return;
+
+  va_start(args, fmt);
+  vsnprintf(candidate->reasons + len, sizeof(candidate->reasons) - len, fmt, args);
+  va_end(args);
+}
+
+
+static int phdev_candidate_cmp(const void *a, const void *b) {
+  const struct uvr_vk_phdev_candidate *ca = a, *cb = b;
+
+  if (ca->suitable != cb->suitable)
+    return (ca->suitable) ? -1 : 1;
+
+  if (ca->score != cb->score)
+    return (ca->score > cb->score) ? -1 : 1;
+
+  return 0;
+}
+
+
+/* VkPhysicalDeviceFeatures member names in declaration order, indexed like the VkBool32 array phdev_score walks */
+static const char *phdev_feature_names[] = {
+  "robustBufferAccess", "fullDrawIndexUint32", "imageCubeArray", "independentBlend", "geometryShader",
+  "tessellationShader", "sampleRateShading", "dualSrcBlend", "logicOp", "multiDrawIndirect",
+  "drawIndirectFirstInstance", "depthClamp", "depthBiasClamp", "fillModeNonSolid", "depthBounds", "wideLines",
+  "largePoints", "alphaToOne", "multiViewport", "samplerAnisotropy", "textureCompressionETC2",
+  "textureCompressionASTC_LDR", "textureCompressionBC", "occlusionQueryPrecise", "pipelineStatisticsQuery",
+  "vertexPipelineStoresAndAtomics", "fragmentStoresAndAtomics", "shaderTessellationAndGeometryPointSize",
+  "shaderImageGatherExtended", "shaderStorageImageExtendedFormats", "shaderStorageImageMultisample",
+  "shaderStorageImageReadWithoutFormat", "shaderStorageImageWriteWithoutFormat",
+  "shaderUniformBufferArrayDynamicIndexing", "shaderSampledImageArrayDynamicIndexing",
+  "shaderStorageBufferArrayDynamicIndexing", "shaderStorageImageArrayDynamicIndexing", "shaderClipDistance",
+  "shaderCullDistance", "shaderFloat64", "shaderInt64", "shaderInt16", "shaderResourceResidency",
+  "shaderResourceMinLod", "sparseBinding", "sparseResidencyBuffer", "sparseResidencyImage2D", "sparseResidencyImage3D",
+  "sparseResidency2Samples", "sparseResidency4Samples", "sparseResidency8Samples", "sparseResidency16Samples",
+  "sparseResidencyAliased", "variableMultisampleRate", "inheritedQueries"
+};
+
+
+static void phdev_score(struct uvr_vk_phdev_create_info *uvrvk, VkPhysicalDeviceType preferredType,
+                        struct uvr_vk_phdev_candidate *candidate, struct stat UNUSED *drmStat) {
+  VkResult res = VK_RESULT_MAX_ENUM;
+  VkPhysicalDeviceProperties devprops;
+  VkPhysicalDeviceFeatures devfeats;
+  VkPhysicalDeviceMemoryProperties memprops;
+  VkQueueFamilyProperties *families = NULL;
+  VkExtensionProperties *extensions = NULL;
+  uint32_t i, e, familyCount = 0, extensionCount = 0;
+  bool hasDrmExtension = false;
+
+  vkGetPhysicalDeviceProperties(candidate->vkPhdev, &devprops);
+  vkGetPhysicalDeviceFeatures(candidate->vkPhdev, &devfeats);
+  vkGetPhysicalDeviceMemoryProperties(candidate->vkPhdev, &memprops);
+
+  memcpy(candidate->deviceName, devprops.deviceName, sizeof(candidate->deviceName));
+  candidate->deviceType = devprops.deviceType;
+  candidate->apiVersion = devprops.apiVersion;
+  candidate->suitable = true;
+
+  /* Required extensions */
+  res = vkEnumerateDeviceExtensionProperties(candidate->vkPhdev, NULL, &extensionCount, NULL);
+  if (!res && extensionCount) {
+    extensions = calloc(extensionCount, sizeof(VkExtensionProperties));
+    if (extensions)
+      res = vkEnumerateDeviceExtensionProperties(candidate->vkPhdev, NULL, &extensionCount, extensions);
+  }
+
+  if (res || (extensionCount && !extensions))
+    extensionCount = 0;
+
+  for (e = 0; e < extensionCount; e++) {
+    if (!strcmp(extensions[e].extensionName, "VK_EXT_physical_device_drm"))
+      hasDrmExtension = true;
+  }
+
+  for (i = 0; i < uvrvk->enabledExtensionCount; i++) {
+    for (e = 0; e < extensionCount; e++) {
+      if (!strcmp(extensions[e].extensionName, uvrvk->ppEnabledExtensionNames[i]))
+        break;
+    }
+
+    if (e == extensionCount) {
+      candidate->suitable = false;
+      phdev_reason(candidate, "missing %s; ", uvrvk->ppEnabledExtensionNames[i]);
+    }
+  }
+
+  free(extensions);
+
+  /* Required features, VkPhysicalDeviceFeatures is nothing but VkBool32's */
+  if (uvrvk->pRequiredFeatures) {
+    const VkBool32 *required = (const VkBool32 *) uvrvk->pRequiredFeatures;
+    const VkBool32 *supported = (const VkBool32 *) &devfeats;
+
+    for (i = 0; i < sizeof(VkPhysicalDeviceFeatures) / sizeof(VkBool32); i++) {
+      if (required[i] && !supported[i]) {
+        candidate->suitable = false;
+        if (i < ARRAY_LEN(phdev_feature_names))
+          phdev_reason(candidate, "missing %s; ", phdev_feature_names[i]);
+        else
+          phdev_reason(candidate, "missing feature #%u; ", i);
+      }
+    }
+  }
+
+  /* Device type */
+  if (devprops.deviceType == preferredType) {
+    candidate->score += UVR_VK_PHDEV_SCORE_PREFERRED_TYPE;
+    phdev_reason(candidate, "preferred type +%u; ", UVR_VK_PHDEV_SCORE_PREFERRED_TYPE);
+  }
+
+  candidate->score += phdev_type_score(devprops.deviceType);
+  phdev_reason(candidate, "type +%" PRIu64 "; ", phdev_type_score(devprops.deviceType));
+
+  /* Largest device local heap */
+  for (i = 0; i < memprops.memoryHeapCount; i++) {
+    if ((memprops.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) &&
+         memprops.memoryHeaps[i].size > candidate->deviceLocalBytes)
+      candidate->deviceLocalBytes = memprops.memoryHeaps[i].size;
+  }
+
+  candidate->score += (candidate->deviceLocalBytes >> 30) * UVR_VK_PHDEV_SCORE_PER_GIB;
+  phdev_reason(candidate, "%" PRIu64 " MiB device local +%" PRIu64 "; ", (uint64_t) (candidate->deviceLocalBytes >> 20),
+               (uint64_t) (candidate->deviceLocalBytes >> 30) * UVR_VK_PHDEV_SCORE_PER_GIB);
+
+  /* Dedicated queue families allow async compute/transfer */
+  vkGetPhysicalDeviceQueueFamilyProperties(candidate->vkPhdev, &familyCount, NULL);
+  families = calloc(familyCount, sizeof(VkQueueFamilyProperties));
+  if (families) {
+    vkGetPhysicalDeviceQueueFamilyProperties(candidate->vkPhdev, &familyCount, families);
+
+    for (i = 0; i < familyCount; i++) {
+      VkQueueFlags flags = families[i].queueFlags;
+      if ((flags & VK_QUEUE_COMPUTE_BIT) && !(flags & VK_QUEUE_GRAPHICS_BIT))
+        candidate->dedicatedCompute = true;
+      if ((flags & VK_QUEUE_TRANSFER_BIT) && !(flags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT)))
+        candidate->dedicatedTransfer = true;
+    }
+
+    free(families);
+  }
+
+  if (candidate->dedicatedCompute) {
+    candidate->score += UVR_VK_PHDEV_SCORE_DEDICATED_QUEUE;
+    phdev_reason(candidate, "dedicated compute +%u; ", UVR_VK_PHDEV_SCORE_DEDICATED_QUEUE);
+  }
+
+  if (candidate->dedicatedTransfer) {
+    candidate->score += UVR_VK_PHDEV_SCORE_DEDICATED_QUEUE;
+    phdev_reason(candidate, "dedicated transfer +%u; ", UVR_VK_PHDEV_SCORE_DEDICATED_QUEUE);
+  }
+
+#ifdef INCLUDE_KMS
+  if (uvrvk->kmsFd != -1) {
+    if (hasDrmExtension) {
+      VkPhysicalDeviceProperties2 devprops2;
+      VkPhysicalDeviceDrmPropertiesEXT drm_props;
+      memset(&devprops2, 0, sizeof(devprops2));
+      memset(&drm_props, 0, sizeof(drm_props));
+
+      drm_props.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DRM_PROPERTIES_EXT;
+      devprops2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+      devprops2.pNext = &drm_props;
+      vkGetPhysicalDeviceProperties2(candidate->vkPhdev, &devprops2);
+
+      dev_t primary_devid = makedev(drm_props.primaryMajor, drm_props.primaryMinor);
+      dev_t render_devid = makedev(drm_props.renderMajor, drm_props.renderMinor);
+
+      candidate->drmMatch = (drm_props.hasPrimary && primary_devid == drmStat->st_rdev) ||
+                            (drm_props.hasRender && render_devid == drmStat->st_rdev);
+    }
+
+    if (candidate->drmMatch) {
+      candidate->score += UVR_VK_PHDEV_SCORE_DRM_MATCH;
+      phdev_reason(candidate, "drm node match +%u; ", UVR_VK_PHDEV_SCORE_DRM_MATCH);
+    } else {
+      phdev_reason(candidate, (hasDrmExtension) ? "drm node mismatch; " : "no VK_EXT_physical_device_drm; ");
+    }
+  }
+#else
+  (void) hasDrmExtension;
+#endif
+}
+
+
+struct uvr_vk_phdev_ranking uvr_vk_phdev_rank(struct uvr_vk_phdev_create_info *uvrvk) {
   VkResult res = VK_RESULT_MAX_ENUM;
-  VkPhysicalDevice device = VK_NULL_HANDLE;
-  uint32_t device_count = 0;
   VkPhysicalDevice *devices = NULL;
+  struct uvr_vk_phdev_candidate *candidates = NULL;
+  VkPhysicalDeviceType preferredType;
+  struct stat drm_stat = {0};
+  uint32_t i, device_count = 0;
 
   if (!uvrvk->vkInst) {
-    uvr_utils_log(UVR_DANGER, "[x] uvr_vk_create_phdev: VkInstance not instantiated");
+    uvr_utils_log(UVR_DANGER, "[x] uvr_vk_phdev_rank: VkInstance not instantiated");
     uvr_utils_log(UVR_DANGER, "[x] Make a call to uvr_vk_create_instance");
-    return VK_NULL_HANDLE;
+    goto exit_vk_phdev_rank;
+  }
+
+#ifdef INCLUDE_KMS
+  /* Get KMS fd stats */
+  if (uvrvk->kmsFd != -1) {
+    if (fstat(uvrvk->kmsFd, &drm_stat) == -1) {
+      uvr_utils_log(UVR_DANGER, "[x] fstat('%d'): %s", uvrvk->kmsFd, strerror(errno));
+      goto exit_vk_phdev_rank;
+    }
   }
+#endif
 
   res = vkEnumeratePhysicalDevices(uvrvk->vkInst, &device_count, NULL);
   if (res) {
     uvr_utils_log(UVR_DANGER, "[x] vkEnumeratePhysicalDevices: %s", vkres_msg(res));
-    return VK_NULL_HANDLE;
+    goto exit_vk_phdev_rank;
   }
 
   if (device_count == 0) {
     uvr_utils_log(UVR_DANGER, "[x] failed to find GPU with Vulkan support!!!");
-    return VK_NULL_HANDLE;
+    goto exit_vk_phdev_rank;
   }
 
   devices = (VkPhysicalDevice *) alloca((device_count * sizeof(VkPhysicalDevice)) + 1);
@@ -227,71 +658,55 @@ VkPhysicalDevice uvr_vk_phdev_create(struct uvr_vk_phdev_create_info *uvrvk) {
   res = vkEnumeratePhysicalDevices(uvrvk->vkInst, &device_count, devices);
   if (res) {
     uvr_utils_log(UVR_DANGER, "[x] vkEnumeratePhysicalDevices: %s", vkres_msg(res));
-    return VK_NULL_HANDLE;
+    goto exit_vk_phdev_rank;
   }
 
-#ifdef INCLUDE_KMS
-  /* Get KMS fd stats */
-  struct stat drm_stat = {0};
-  if (uvrvk->kmsFd != -1) {
-    if (fstat(uvrvk->kmsFd, &drm_stat) == -1) {
-      uvr_utils_log(UVR_DANGER, "[x] fstat('%d'): %s", uvrvk->kmsFd, strerror(errno));
-      return VK_NULL_HANDLE;
-    }
+  candidates = calloc(device_count, sizeof(struct uvr_vk_phdev_candidate));
+  if (!candidates) {
+    uvr_utils_log(UVR_DANGER, "[x] calloc: %s", strerror(errno));
+    goto exit_vk_phdev_rank;
   }
 
-  VkPhysicalDeviceProperties2 devprops2;
-  VkPhysicalDeviceDrmPropertiesEXT drm_props;
-  memset(&devprops2, 0, sizeof(devprops2));
-  memset(&drm_props, 0, sizeof(drm_props));
+  preferredType = phdev_type_from_env(uvrvk->vkPhdevType);
 
-  drm_props.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DRM_PROPERTIES_EXT;
-  devprops2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
-#endif
+  for (i = 0; i < device_count; i++) {
+    candidates[i].vkPhdev = devices[i];
+    phdev_score(uvrvk, preferredType, &candidates[i], &drm_stat);
+  }
 
-  int enter = 0;
-  VkPhysicalDeviceFeatures devfeats;
-  VkPhysicalDeviceProperties devprops;
+  qsort(candidates, device_count, sizeof(struct uvr_vk_phdev_candidate), phdev_candidate_cmp);
 
-  /*
-   * get a physical device that is suitable
-   * to do the graphics related task that we need
-   */
-  for (uint32_t i = 0; i < device_count; i++) {
-    vkGetPhysicalDeviceFeatures(devices[i], &devfeats); /* Query device features */
-    vkGetPhysicalDeviceProperties(devices[i], &devprops); /* Query device properties */
+  return (struct uvr_vk_phdev_ranking) { .candidateCount = device_count, .candidates = candidates };
 
-#ifdef INCLUDE_KMS
-    if (uvrvk->kmsFd) {
-      devprops2.pNext = &drm_props;
-      vkGetPhysicalDeviceProperties2(devices[i], &devprops2);
+exit_vk_phdev_rank:
+  return (struct uvr_vk_phdev_ranking) { .candidateCount = 0, .candidates = NULL };
+}
 
-      drm_props.pNext = devprops2.pNext;
-      dev_t primary_devid = makedev(drm_props.primaryMajor, drm_props.primaryMinor);
-      dev_t render_devid = makedev(drm_props.renderMajor, drm_props.renderMinor);
 
-      /*
-       * Enter will be one if condition succeeds
-       * Enter will be zero if condition fails
-       * Need to make sure even if we have a valid DRI device node fd.
-       * That the customer choosen device type is the same as the DRI device node.
-       */
-      enter |= ((primary_devid == drm_stat.st_rdev || render_devid == drm_stat.st_rdev) && devprops.deviceType == uvrvk->vkPhdevType);
-    }
-#endif
+VkPhysicalDevice uvr_vk_phdev_create(struct uvr_vk_phdev_create_info *uvrvk) {
+  VkPhysicalDevice device = VK_NULL_HANDLE;
+  struct uvr_vk_phdev_ranking ranking;
+  uint32_t i;
 
-    /* Enter will be one if condition succeeds */
-    enter |= (devprops.deviceType == uvrvk->vkPhdevType);
-    if (enter) {
-      memmove(&device, &devices[i], sizeof(devices[i]));
-      uvr_utils_log(UVR_SUCCESS, "Suitable GPU Found: %s, api version: %u", devprops.deviceName, devprops.apiVersion);
-      break;
-    }
+  ranking = uvr_vk_phdev_rank(uvrvk);
+  if (!ranking.candidates)
+    return VK_NULL_HANDLE;
+
+  for (i = 0; i < ranking.candidateCount; i++) {
+    uvr_utils_log(UVR_INFO, "uvr_vk_phdev_create: #%u %s%s score %" PRIu64 " (%s)", i, ranking.candidates[i].deviceName,
+                            (ranking.candidates[i].suitable) ? "" : " [unsuitable]", ranking.candidates[i].score,
+                            ranking.candidates[i].reasons);
   }
 
-  if (device == VK_NULL_HANDLE)
+  if (ranking.candidates[0].suitable) {
+    device = ranking.candidates[0].vkPhdev;
+    uvr_utils_log(UVR_SUCCESS, "Suitable GPU Found: %s, api version: %u", ranking.candidates[0].deviceName,
+                               ranking.candidates[0].apiVersion);
+  } else {
     uvr_utils_log(UVR_DANGER, "Suitable GPU not found!");
+  }
 
+  free(ranking.candidates);
   return device;
 }
 
@@ -303,10 +718,31 @@ VkPhysicalDeviceFeatures uvr_vk_get_phdev_features(VkPhysicalDevice phdev) {
 }
 
 
+static const char *queue_flag_name(VkQueueFlags flag) {
+  switch (flag) {
+    case VK_QUEUE_GRAPHICS_BIT:
+      return "graphics";
+    case VK_QUEUE_COMPUTE_BIT:
+      return "compute";
+    case VK_QUEUE_TRANSFER_BIT:
+      return "transfer";
+    case VK_QUEUE_SPARSE_BINDING_BIT:
+      return "sparse_binding";
+    case VK_QUEUE_PROTECTED_BIT:
+      return "protected";
+    default:
+      break;
+  }
+
+  return "unknown";
+}
+
+
 struct uvr_vk_queue uvr_vk_queue_create(struct uvr_vk_queue_create_info *uvrvk) {
-  uint32_t queue_count = 0, flagcnt = 0;
+  uint32_t queue_count = 0, flagcnt = 0, extraCaps, bestExtraCaps = UINT32_MAX;
   VkQueueFamilyProperties *queue_families = NULL;
   struct uvr_vk_queue queue;
+  int familyIndex = -1;
 
   flagcnt += (uvrvk->queueFlag & VK_QUEUE_GRAPHICS_BIT) ? 1 : 0;
   flagcnt += (uvrvk->queueFlag & VK_QUEUE_COMPUTE_BIT) ? 1 : 0;
@@ -328,33 +764,40 @@ struct uvr_vk_queue uvr_vk_queue_create(struct uvr_vk_queue_create_info *uvrvk)
   vkGetPhysicalDeviceQueueFamilyProperties(uvrvk->vkPhdev, &queue_count, queue_families);
 
   for (uint32_t i = 0; i < queue_count; i++) {
-    queue.queueCount = queue_families[i].queueCount;
-    if (queue_families[i].queueFlags & uvrvk->queueFlag & VK_QUEUE_GRAPHICS_BIT) {
-      strncpy(queue.name, "graphics", sizeof(queue.name));
-      queue.familyIndex = i; break;
-    }
-
-    if (queue_families[i].queueFlags & uvrvk->queueFlag & VK_QUEUE_COMPUTE_BIT) {
-      strncpy(queue.name, "compute", sizeof(queue.name));
-      queue.familyIndex = i; break;
-    }
+    if (!(queue_families[i].queueFlags & uvrvk->queueFlag) || !queue_families[i].queueCount)
+      continue;
 
-    if (queue_families[i].queueFlags & uvrvk->queueFlag & VK_QUEUE_TRANSFER_BIT) {
-      strncpy(queue.name, "transfer", sizeof(queue.name));
-      queue.familyIndex = i; break;
+    if (!uvrvk->preferDedicated) {
+      familyIndex = i; break;
     }
 
-    if (queue_families[i].queueFlags & uvrvk->queueFlag & VK_QUEUE_SPARSE_BINDING_BIT) {
-      strncpy(queue.name, "sparse_binding", sizeof(queue.name));
-      queue.familyIndex = i; break;
+    /* Fewer other capabilities means less contention with work submitted elsewhere */
+    extraCaps = __builtin_popcount(queue_families[i].queueFlags & ~uvrvk->queueFlag &
+                                   (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT | VK_QUEUE_TRANSFER_BIT));
+    if (extraCaps < bestExtraCaps) {
+      bestExtraCaps = extraCaps;
+      familyIndex = i;
     }
+  }
 
-    if (queue_families[i].queueFlags & uvrvk->queueFlag & VK_QUEUE_PROTECTED_BIT) {
-      strncpy(queue.name, "protected", sizeof(queue.name));
-      queue.familyIndex = i; break;
-    }
+  if (familyIndex == -1) {
+    uvr_utils_log(UVR_DANGER, "[x] uvr_vk_queue_create: No queue family supports %s", queue_flag_name(uvrvk->queueFlag));
+    goto err_vk_queue_create;
   }
 
+  memset(&queue, 0, sizeof(queue));
+  strncpy(queue.name, queue_flag_name(uvrvk->queueFlag), sizeof(queue.name) - 1);
+  queue.vkQueue = VK_NULL_HANDLE;
+  queue.familyIndex = familyIndex;
+  queue.queueCount = queue_families[familyIndex].queueCount;
+  queue.queueIndex = 0;
+  queue.priority = 1.f;
+  queue.familyFlags = queue_families[familyIndex].queueFlags;
+
+  uvr_utils_log(UVR_INFO, "uvr_vk_queue_create: '%s' queue family %d (%d queues, %s%s%s)", queue.name, queue.familyIndex, queue.queueCount,
+                          (queue.familyFlags & VK_QUEUE_GRAPHICS_BIT) ? "G" : "", (queue.familyFlags & VK_QUEUE_COMPUTE_BIT) ? "C" : "",
+                          (queue.familyFlags & VK_QUEUE_TRANSFER_BIT) ? "T" : "");
+
   return queue;
 
 err_vk_queue_create:
@@ -362,9 +805,122 @@ err_vk_queue_create:
 }
 
 
+uint32_t uvr_vk_queue_family_split(struct uvr_vk_queue *queue, uint32_t count, const float *pPriorities, struct uvr_vk_queue *queues) {
+  uint32_t q;
+
+  if (queue->queueCount <= 0)
+    return 0;
+
+  if (count > (uint32_t) queue->queueCount)
+    count = queue->queueCount;
+
+  for (q = 0; q < count; q++) {
+    queues[q] = *queue;
+    queues[q].vkQueue = VK_NULL_HANDLE;
+    queues[q].queueIndex = q;
+    queues[q].priority = (pPriorities) ? pPriorities[q] : queue->priority;
+    snprintf(queues[q].name, sizeof(queues[q].name), "%.*s%u", (int) sizeof(queues[q].name) - 4, queue->name, q);
+  }
+
+  return count;
+}
+
+
+void uvr_vk_queue_overlap_report(uint32_t queueCount, struct uvr_vk_queue *queues) {
+  uint32_t a, b;
+
+  for (a = 0; a < queueCount; a++) {
+    for (b = a + 1; b < queueCount; b++) {
+      if (queues[a].familyIndex != queues[b].familyIndex) {
+        uvr_utils_log(UVR_INFO, "'%s' <-> '%s': separate families (%d, %d), fully asynchronous", queues[a].name, queues[b].name,
+                                queues[a].familyIndex, queues[b].familyIndex);
+      } else if (queues[a].queueIndex != queues[b].queueIndex) {
+        uvr_utils_log(UVR_INFO, "'%s' <-> '%s': same family %d, distinct queues (%u, %u), may overlap", queues[a].name, queues[b].name,
+                                queues[a].familyIndex, queues[a].queueIndex, queues[b].queueIndex);
+      } else {
+        uvr_utils_log(UVR_WARNING, "'%s' <-> '%s': same queue (family %d, index %u), serialized", queues[a].name, queues[b].name,
+                                   queues[a].familyIndex, queues[a].queueIndex);
+      }
+    }
+  }
+}
+
+
+/*
+ * Enables every feature struct uvr_vk_bindless_table relies on. A VkPhysicalDeviceVulkan12Features or
+ * VkPhysicalDeviceDescriptorIndexingFeatures already in the caller's chain is patched in place, otherwise
+ * @indexing is prepended to it. Returns the pNext chain to pass to VkDeviceCreateInfo or NULL if the
+ * features can't be enabled.
+ */
+static const void *lgdev_descriptor_indexing(struct uvr_vk_lgdev_create_info *uvrvk, VkPhysicalDeviceDescriptorIndexingFeatures *indexing) {
+  VkBaseOutStructure *next = NULL;
+
+  VkPhysicalDeviceDescriptorIndexingFeatures supported = {};
+  supported.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES;
+  supported.pNext = NULL;
+
+  VkPhysicalDeviceFeatures2 features2 = {};
+  features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+  features2.pNext = &supported;
+
+  vkGetPhysicalDeviceFeatures2(uvrvk->vkPhdev, &features2);
+
+  if (!supported.runtimeDescriptorArray || !supported.descriptorBindingPartiallyBound ||
+      !supported.descriptorBindingSampledImageUpdateAfterBind || !supported.descriptorBindingUpdateUnusedWhilePending ||
+      !supported.shaderSampledImageArrayNonUniformIndexing) {
+    uvr_utils_log(UVR_DANGER, "[x] uvr_vk_lgdev_create: physical device lacks descriptor indexing support");
+    return NULL;
+  }
+
+  /*
+   * A second struct with the same sType is invalid usage and Vulkan 1.2 forbids chaining
+   * VkPhysicalDeviceDescriptorIndexingFeatures alongside VkPhysicalDeviceVulkan12Features.
+   * Features the caller enabled are never cleared.
+   */
+  for (next = (VkBaseOutStructure *) uvrvk->pNext; next; next = next->pNext) {
+    if (next->sType == VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES) {
+      VkPhysicalDeviceVulkan12Features *vk12 = (VkPhysicalDeviceVulkan12Features *) next;
+      vk12->shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
+      vk12->descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+      vk12->descriptorBindingUpdateUnusedWhilePending = VK_TRUE;
+      vk12->descriptorBindingPartiallyBound = VK_TRUE;
+      vk12->descriptorBindingVariableDescriptorCount |= supported.descriptorBindingVariableDescriptorCount;
+      vk12->runtimeDescriptorArray = VK_TRUE;
+      return uvrvk->pNext;
+    }
+
+    if (next->sType == VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES) {
+      VkPhysicalDeviceDescriptorIndexingFeatures *chained = (VkPhysicalDeviceDescriptorIndexingFeatures *) next;
+      chained->shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
+      chained->descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+      chained->descriptorBindingUpdateUnusedWhilePending = VK_TRUE;
+      chained->descriptorBindingPartiallyBound = VK_TRUE;
+      chained->descriptorBindingVariableDescriptorCount |= supported.descriptorBindingVariableDescriptorCount;
+      chained->runtimeDescriptorArray = VK_TRUE;
+      return uvrvk->pNext;
+    }
+  }
+
+  memset(indexing, 0, sizeof(VkPhysicalDeviceDescriptorIndexingFeatures));
+  indexing->sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES;
+  indexing->pNext = (void *) uvrvk->pNext;
+  indexing->shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
+  indexing->descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+  indexing->descriptorBindingUpdateUnusedWhilePending = VK_TRUE;
+  indexing->descriptorBindingPartiallyBound = VK_TRUE;
+  indexing->descriptorBindingVariableDescriptorCount = supported.descriptorBindingVariableDescriptorCount;
+  indexing->runtimeDescriptorArray = VK_TRUE;
+
+  return indexing;
+}
+
+
 struct uvr_vk_lgdev uvr_vk_lgdev_create(struct uvr_vk_lgdev_create_info *uvrvk) {
   VkDevice device = VK_NULL_HANDLE;
+  struct uvr_vk_device_dispatch *dispatch = NULL;
   VkResult res = VK_RESULT_MAX_ENUM;
+  uint32_t qc, fc, familyCount = 0;
+  float *pQueuePriorities = NULL;
 
   VkDeviceQueueCreateInfo *pQueueCreateInfo = (VkDeviceQueueCreateInfo *) calloc(uvrvk->queueCount, sizeof(VkDeviceQueueCreateInfo));
   if (!pQueueCreateInfo) {
@@ -372,24 +928,83 @@ struct uvr_vk_lgdev uvr_vk_lgdev_create(struct uvr_vk_lgdev_create_info *uvrvk)
     goto err_vk_lgdev_create;
   }
 
+  /* One priority slot per requested queue, sliced per family below */
+  pQueuePriorities = (float *) calloc(uvrvk->queueCount, sizeof(float));
+  if (!pQueuePriorities) {
+    uvr_utils_log(UVR_DANGER, "[x] calloc: %s", strerror(errno));
+    goto err_vk_lgdev_free_pQueueCreateInfo;
+  }
+
   /*
    * https://www.khronos.org/registry/vulkan/specs/1.3-extensions/html/vkspec.html#devsandqueues-priority
-   * set the default priority of all queues to be the highest
+   * A family may only appear once in VkDeviceCreateInfo. Group requested queues by family
+   * and create queueIndex + 1 queues with each queue's own priority.
    */
-  const float pQueuePriorities = 1.f;
-  for (uint32_t qc = 0; qc < uvrvk->queueCount; qc++) {
-    pQueueCreateInfo[qc].flags = 0;
-    pQueueCreateInfo[qc].sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
-    pQueueCreateInfo[qc].queueFamilyIndex = uvrvk->queues[qc].familyIndex;
-    pQueueCreateInfo[qc].queueCount = uvrvk->queues[qc].queueCount;
-    pQueueCreateInfo[qc].pQueuePriorities = &pQueuePriorities;
+  for (qc = 0; qc < uvrvk->queueCount; qc++) {
+    if (uvrvk->queues[qc].queueIndex >= (uint32_t) uvrvk->queues[qc].queueCount) {
+      uvr_utils_log(UVR_DANGER, "[x] uvr_vk_lgdev_create: '%s' queue index %u out of range (family has %d queues)",
+                                uvrvk->queues[qc].name, uvrvk->queues[qc].queueIndex, uvrvk->queues[qc].queueCount);
+      goto err_vk_lgdev_free_pQueuePriorities;
+    }
+
+    for (fc = 0; fc < familyCount; fc++)
+      if (pQueueCreateInfo[fc].queueFamilyIndex == (uint32_t) uvrvk->queues[qc].familyIndex)
+        break;
+
+    if (fc == familyCount) {
+      pQueueCreateInfo[fc].sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+      pQueueCreateInfo[fc].pNext = NULL;
+      pQueueCreateInfo[fc].flags = 0;
+      pQueueCreateInfo[fc].queueFamilyIndex = uvrvk->queues[qc].familyIndex;
+      pQueueCreateInfo[fc].queueCount = 0;
+      familyCount++;
+    }
+
+    if (uvrvk->queues[qc].queueIndex + 1 > pQueueCreateInfo[fc].queueCount)
+      pQueueCreateInfo[fc].queueCount = uvrvk->queues[qc].queueIndex + 1;
+  }
+
+  /* Assign each family a contiguous slice of priorities, unrequested indices default to 1.0 */
+  float *priorities = NULL;
+  uint32_t prioritiesCount = 0;
+  for (fc = 0; fc < familyCount; fc++)
+    prioritiesCount += pQueueCreateInfo[fc].queueCount;
+
+  if (prioritiesCount > uvrvk->queueCount) {
+    free(pQueuePriorities);
+    pQueuePriorities = (float *) calloc(prioritiesCount, sizeof(float));
+    if (!pQueuePriorities) {
+      uvr_utils_log(UVR_DANGER, "[x] calloc: %s", strerror(errno));
+      goto err_vk_lgdev_free_pQueueCreateInfo;
+    }
+  }
+
+  priorities = pQueuePriorities;
+  for (fc = 0; fc < familyCount; fc++) {
+    for (qc = 0; qc < pQueueCreateInfo[fc].queueCount; qc++)
+      priorities[qc] = 1.f;
+
+    for (qc = 0; qc < uvrvk->queueCount; qc++)
+      if ((uint32_t) uvrvk->queues[qc].familyIndex == pQueueCreateInfo[fc].queueFamilyIndex)
+        priorities[uvrvk->queues[qc].queueIndex] = uvrvk->queues[qc].priority;
+
+    pQueueCreateInfo[fc].pQueuePriorities = priorities;
+    priorities += pQueueCreateInfo[fc].queueCount;
+  }
+
+  VkPhysicalDeviceDescriptorIndexingFeatures indexing_features;
+  const void *pNext = uvrvk->pNext;
+  if (uvrvk->enableDescriptorIndexing) {
+    pNext = lgdev_descriptor_indexing(uvrvk, &indexing_features);
+    if (!pNext)
+      goto err_vk_lgdev_free_pQueuePriorities;
   }
 
   VkDeviceCreateInfo create_info = {};
   create_info.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
-  create_info.pNext = NULL;
+  create_info.pNext = pNext;
   create_info.flags = 0;
-  create_info.queueCreateInfoCount = uvrvk->queueCount;
+  create_info.queueCreateInfoCount = familyCount;
   create_info.pQueueCreateInfos = pQueueCreateInfo;
   create_info.enabledLayerCount = 0; // Deprecated and ignored
   create_info.ppEnabledLayerNames = NULL; // Deprecated and ignored
@@ -398,46 +1013,76 @@ struct uvr_vk_lgdev uvr_vk_lgdev_create(struct uvr_vk_lgdev_create_info *uvrvk)
   create_info.pEnabledFeatures = uvrvk->pEnabledFeatures;
 
   /* Create logic device */
-  res = vkCreateDevice(uvrvk->vkPhdev, &create_info, NULL, &device);
+  res = vkCreateDevice(uvrvk->vkPhdev, &create_info, hostCallbacks, &device);
   if (res) {
     uvr_utils_log(UVR_DANGER, "[x] vkCreateDevice: %s", vkres_msg(res));
-    goto err_vk_lgdev_free_pQueueCreateInfo;
+    goto err_vk_lgdev_free_pQueuePriorities;
   }
 
-  for (uint32_t qc = 0; qc < uvrvk->queueCount; qc++) {
-    vkGetDeviceQueue(device, uvrvk->queues[qc].familyIndex, 0, &uvrvk->queues[qc].vkQueue);
+  for (qc = 0; qc < uvrvk->queueCount; qc++) {
+    vkGetDeviceQueue(device, uvrvk->queues[qc].familyIndex, uvrvk->queues[qc].queueIndex, &uvrvk->queues[qc].vkQueue);
     if (!uvrvk->queues[qc].vkQueue)  {
       uvr_utils_log(UVR_DANGER, "[x] vkGetDeviceQueue: Failed to get %s queue handle", uvrvk->queues[qc].name);
       goto err_vk_lgdev_destroy;
     }
 
-    uvr_utils_log(UVR_SUCCESS, "uvr_vk_lgdev_create: '%s' VkQueue successfully created retval(%p)", uvrvk->queues[qc].name, uvrvk->queues[qc].vkQueue);
+    uvr_utils_log(UVR_SUCCESS, "uvr_vk_lgdev_create: '%s' VkQueue successfully created retval(%p) family %d index %u priority %.2f",
+                               uvrvk->queues[qc].name, uvrvk->queues[qc].vkQueue, uvrvk->queues[qc].familyIndex,
+                               uvrvk->queues[qc].queueIndex, uvrvk->queues[qc].priority);
   }
 
+  dispatch = dispatch_create(device);
+  if (!dispatch)
+    goto err_vk_lgdev_destroy;
+
   uvr_utils_log(UVR_SUCCESS, "uvr_vk_lgdev_create: VkDevice created retval(%p)", device);
 
+  free(pQueuePriorities);
   free(pQueueCreateInfo);
-  return (struct uvr_vk_lgdev) { .vkDevice = device, .queueCount = uvrvk->queueCount, .queues = uvrvk->queues };
+  return (struct uvr_vk_lgdev) { .vkDevice = device, .queueCount = uvrvk->queueCount, .queues = uvrvk->queues, .dispatch = dispatch };
 
 err_vk_lgdev_destroy:
   if (device)
-    vkDestroyDevice(device, NULL);
+    vkDestroyDevice(device, hostCallbacks);
+err_vk_lgdev_free_pQueuePriorities:
+  free(pQueuePriorities);
 err_vk_lgdev_free_pQueueCreateInfo:
   free(pQueueCreateInfo);
 err_vk_lgdev_create:
-  return (struct uvr_vk_lgdev) { .vkDevice = VK_NULL_HANDLE, .queueCount = -1, .queues = NULL };
+  return (struct uvr_vk_lgdev) { .vkDevice = VK_NULL_HANDLE, .queueCount = -1, .queues = NULL, .dispatch = NULL };
 }
 
 
-VkSurfaceCapabilitiesKHR uvr_vk_get_surface_capabilities(VkPhysicalDevice phdev, VkSurfaceKHR surface) {
-  VkSurfaceCapabilitiesKHR cap;
-  vkGetPhysicalDeviceSurfaceCapabilitiesKHR(phdev, surface, &cap);
-  return cap;
-}
+const struct uvr_vk_device_dispatch *uvr_vk_device_dispatch_get(VkDevice vkDevice) {
+  const struct uvr_vk_device_dispatch *dispatch = __atomic_load_n(&defaultDispatch, __ATOMIC_ACQUIRE);
+  uint32_t i;
 
+  if (!vkDevice || dispatch->vkDevice == vkDevice)
+    return dispatch;
 
-struct uvr_vk_surface_format uvr_vk_get_surface_formats(VkPhysicalDevice phdev, VkSurfaceKHR surface) {
-  VkResult res = VK_RESULT_MAX_ENUM;
+  dispatch = &loaderDispatch;
+  pthread_mutex_lock(&dispatchLock);
+  for (i = 0; i < dispatchTableCount; i++) {
+    if (dispatchTables[i]->vkDevice == vkDevice) {
+      dispatch = dispatchTables[i];
+      break;
+    }
+  }
+  pthread_mutex_unlock(&dispatchLock);
+
+  return dispatch;
+}
+
+
+VkSurfaceCapabilitiesKHR uvr_vk_get_surface_capabilities(VkPhysicalDevice phdev, VkSurfaceKHR surface) {
+  VkSurfaceCapabilitiesKHR cap;
+  vkGetPhysicalDeviceSurfaceCapabilitiesKHR(phdev, surface, &cap);
+  return cap;
+}
+
+
+struct uvr_vk_surface_format uvr_vk_get_surface_formats(VkPhysicalDevice phdev, VkSurfaceKHR surface) {
+  VkResult res = VK_RESULT_MAX_ENUM;
   VkSurfaceFormatKHR *formats = NULL;
   uint32_t fcount = 0;
 
@@ -534,7 +1179,7 @@ struct uvr_vk_swapchain uvr_vk_swapchain_create(struct uvr_vk_swapchain_create_i
   create_info.clipped = uvrvk->clipped;
   create_info.oldSwapchain = uvrvk->oldSwapchain;
 
-  res = vkCreateSwapchainKHR(uvrvk->vkDevice, &create_info, NULL, &swapchain);
+  res = vkCreateSwapchainKHR(uvrvk->vkDevice, &create_info, hostCallbacks, &swapchain);
   if (res) {
     uvr_utils_log(UVR_DANGER, "[x] vkCreateSwapchainKHR: %s", vkres_msg(res));
     goto exit_vk_swapchain;
@@ -542,13 +1187,523 @@ struct uvr_vk_swapchain uvr_vk_swapchain_create(struct uvr_vk_swapchain_create_i
 
   uvr_utils_log(UVR_SUCCESS, "uvr_vk_swapchain_create: VkSwapchainKHR successfully created retval(%p)", swapchain);
 
-  return (struct uvr_vk_swapchain) { .vkDevice = uvrvk->vkDevice, .vkSwapchain = swapchain };
+  return (struct uvr_vk_swapchain) { .vkDevice = uvrvk->vkDevice, .vkSwapchain = swapchain, .extent2D = uvrvk->extent2D,
+                                     .surfaceFormat = uvrvk->surfaceFormat };
 
 exit_vk_swapchain:
   return (struct uvr_vk_swapchain) { .vkDevice = VK_NULL_HANDLE, .vkSwapchain = VK_NULL_HANDLE };
 }
 
 
+/*
+ * Smallest range the buddy allocator hands out. Every node in the
+ * buddy tree is (UVR_VK_BUDDY_MIN_NODE << order) bytes in size.
+ */
+#define UVR_VK_BUDDY_MIN_NODE 256
+#define UVR_VK_ALLOCATOR_DEFAULT_BLOCK_SIZE (64 * 1024 * 1024)
+
+
+/*
+ * struct uvr_vk_allocator_block (Underview Renderer Vulkan Allocator Block)
+ *
+ * members:
+ * @vkDeviceMemory  - VkDeviceMemory object ranges are carved from
+ * @size            - Size of @vkDeviceMemory in bytes
+ * @pMapped         - Host address of @vkDeviceMemory if memory type is host visible
+ * @memoryTypeIndex - Memory type @vkDeviceMemory was allocated from
+ * @mode            - Strategy used to hand out ranges of this block
+ * @optimalTiling   - VK_TRUE if block only holds optimal tiling images
+ * @usedBytes       - Bytes currently handed out from the block
+ * @requestedBytes  - Bytes callers asked for from the block
+ * @allocationCount - Amount of live ranges carved from the block
+ * @maxOrder        - Order of the root node (@size == UVR_VK_BUDDY_MIN_NODE << @maxOrder)
+ * @longest         - Buddy tree. Each node stores (order + 1) of the largest free node in its subtree, 0 if none free.
+ * @linearOffset    - Next free offset for UVR_VK_ALLOCATION_LINEAR blocks
+ */
+struct uvr_vk_allocator_block {
+  VkDeviceMemory         vkDeviceMemory;
+  VkDeviceSize           size;
+  void                   *pMapped;
+  uint32_t               memoryTypeIndex;
+  uvr_vk_allocation_mode mode;
+  VkBool32               optimalTiling;
+  VkDeviceSize           usedBytes;
+  VkDeviceSize           requestedBytes;
+  uint32_t               allocationCount;
+  uint32_t               maxOrder;
+  uint8_t                *longest;
+  VkDeviceSize           linearOffset;
+};
+
+
+static VkDeviceSize next_pow2(VkDeviceSize size) {
+  VkDeviceSize p = 1;
+  while (p < size)
+    p <<= 1;
+  return p;
+}
+
+
+static uint32_t size_to_order(VkDeviceSize size) {
+  uint32_t order = 0;
+  while (((VkDeviceSize) UVR_VK_BUDDY_MIN_NODE << order) < size)
+    order++;
+  return order;
+}
+
+
+static int find_memory_type(struct uvr_vk_allocator *allocator, uint32_t memoryTypeBits, VkMemoryPropertyFlags flags) {
+  for (uint32_t i = 0; i < allocator->vkMemoryProperties.memoryTypeCount; i++) {
+    if ((memoryTypeBits & (1u << i)) &&
+        (allocator->vkMemoryProperties.memoryTypes[i].propertyFlags & flags) == flags)
+      return i;
+  }
+
+  return -1;
+}
+
+
+static void block_destroy(struct uvr_vk_allocator *allocator, struct uvr_vk_allocator_block *block) {
+  if (block->pMapped)
+    vkUnmapMemory(allocator->vkDevice, block->vkDeviceMemory);
+  vkFreeMemory(allocator->vkDevice, block->vkDeviceMemory, hostCallbacks);
+  free(block->longest);
+  free(block);
+}
+
+
+static struct uvr_vk_allocator_block *block_create(struct uvr_vk_allocator *allocator, VkDeviceSize size,
+                                                   uint32_t memoryTypeIndex, uvr_vk_allocation_mode mode,
+                                                   VkBool32 optimalTiling) {
+  VkResult res = VK_RESULT_MAX_ENUM;
+  struct uvr_vk_allocator_block *block = NULL, **blocks = NULL;
+
+  /* Exceeding the limit is invalid usage, fail here rather than relying on the driver to reject it */
+  if (allocator->blockCount >= allocator->maxMemoryAllocationCount) {
+    uvr_utils_log(UVR_DANGER, "[x] uvr_vk_allocator: maxMemoryAllocationCount (%u) reached", allocator->maxMemoryAllocationCount);
+    return NULL;
+  }
+
+  block = calloc(1, sizeof(struct uvr_vk_allocator_block));
+  if (!block) {
+    uvr_utils_log(UVR_DANGER, "[x] calloc: %s", strerror(errno));
+    return NULL;
+  }
+
+  block->size = size;
+  block->memoryTypeIndex = memoryTypeIndex;
+  block->mode = mode;
+  block->optimalTiling = optimalTiling;
+
+  if (mode == UVR_VK_ALLOCATION_BUDDY) {
+    block->maxOrder = size_to_order(size);
+
+    /* Complete binary tree with (1 << maxOrder) leaves */
+    block->longest = calloc((2ull << block->maxOrder) - 1, sizeof(uint8_t));
+    if (!block->longest) {
+      uvr_utils_log(UVR_DANGER, "[x] calloc: %s", strerror(errno));
+      goto exit_vk_allocator_block_free_block;
+    }
+
+    for (uint32_t depth = 0; depth <= block->maxOrder; depth++) {
+      memset(block->longest + ((1ull << depth) - 1), block->maxOrder - depth + 1, 1ull << depth);
+    }
+  }
+
+  VkMemoryAllocateInfo alloc_info = {};
+  alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+  alloc_info.pNext = NULL;
+  alloc_info.allocationSize = size;
+  alloc_info.memoryTypeIndex = memoryTypeIndex;
+
+  res = vkAllocateMemory(allocator->vkDevice, &alloc_info, hostCallbacks, &block->vkDeviceMemory);
+  if (res) {
+    uvr_utils_log(UVR_DANGER, "[x] vkAllocateMemory: %s", vkres_msg(res));
+    if (res == VK_ERROR_OUT_OF_DEVICE_MEMORY || res == VK_ERROR_OUT_OF_HOST_MEMORY) {
+      uint32_t heapIndex = allocator->vkMemoryProperties.memoryTypes[memoryTypeIndex].heapIndex;
+      VkDeviceSize reserved = 0;
+      for (uint32_t b = 0; b < allocator->blockCount; b++)
+        if (allocator->vkMemoryProperties.memoryTypes[allocator->blocks[b]->memoryTypeIndex].heapIndex == heapIndex)
+          reserved += allocator->blocks[b]->size;
+      uvr_utils_log(UVR_DANGER, "[x] vkAllocateMemory: %" PRIu64 " bytes requested from heap %u (%" PRIu64 " bytes), "
+                                "allocator already holds %" PRIu64 " bytes of it",
+                                size, heapIndex, allocator->vkMemoryProperties.memoryHeaps[heapIndex].size, reserved);
+    }
+    goto exit_vk_allocator_block_free_longest;
+  }
+
+  allocator->vkAllocateMemoryCount++;
+
+  if (allocator->vkMemoryProperties.memoryTypes[memoryTypeIndex].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) {
+    res = vkMapMemory(allocator->vkDevice, block->vkDeviceMemory, 0, VK_WHOLE_SIZE, 0, &block->pMapped);
+    if (res) {
+      uvr_utils_log(UVR_DANGER, "[x] vkMapMemory: %s", vkres_msg(res));
+      goto exit_vk_allocator_block_free_memory;
+    }
+  }
+
+  blocks = realloc(allocator->blocks, (allocator->blockCount + 1) * sizeof(struct uvr_vk_allocator_block *));
+  if (!blocks) {
+    uvr_utils_log(UVR_DANGER, "[x] realloc: %s", strerror(errno));
+    goto exit_vk_allocator_block_unmap_memory;
+  }
+
+  allocator->blocks = blocks;
+  allocator->blocks[allocator->blockCount++] = block;
+
+  uvr_utils_log(UVR_SUCCESS, "uvr_vk_allocator: VkDeviceMemory block successfully created retval(%p) size(%" PRIu64 ") type(%u)",
+                block->vkDeviceMemory, block->size, memoryTypeIndex);
+
+  return block;
+
+exit_vk_allocator_block_unmap_memory:
+  if (block->pMapped)
+    vkUnmapMemory(allocator->vkDevice, block->vkDeviceMemory);
+exit_vk_allocator_block_free_memory:
+  vkFreeMemory(allocator->vkDevice, block->vkDeviceMemory, hostCallbacks);
+exit_vk_allocator_block_free_longest:
+  free(block->longest);
+exit_vk_allocator_block_free_block:
+  free(block);
+  return NULL;
+}
+
+
+static void block_remove(struct uvr_vk_allocator *allocator, struct uvr_vk_allocator_block *block) {
+  for (uint32_t b = 0; b < allocator->blockCount; b++) {
+    if (allocator->blocks[b] == block) {
+      allocator->blocks[b] = allocator->blocks[--allocator->blockCount];
+      break;
+    }
+  }
+
+  block_destroy(allocator, block);
+}
+
+
+static void buddy_fixup(struct uvr_vk_allocator_block *block, uint64_t parent) {
+  uint8_t left = block->longest[2 * parent + 1];
+  uint8_t right = block->longest[2 * parent + 2];
+
+  /* Largest possible value of a child node is a fully free child (order + 1) */
+  uint8_t full = 0;
+  uint64_t depth = 0;
+  for (uint64_t n = parent + 1; n > 1; n >>= 1)
+    depth++;
+  full = block->maxOrder - depth;
+
+  if (left == full && right == full)
+    block->longest[parent] = full + 1;
+  else
+    block->longest[parent] = (left > right) ? left : right;
+}
+
+
+static int buddy_alloc(struct uvr_vk_allocator_block *block, VkDeviceSize size, VkDeviceSize *offset) {
+  uint32_t order = size_to_order(size), node_order = block->maxOrder;
+  uint64_t node = 0;
+
+  if (order > block->maxOrder || block->longest[0] < order + 1)
+    return -1;
+
+  /* Descend to the first node of the wanted order that is free */
+  while (node_order != order) {
+    node = (block->longest[2 * node + 1] >= order + 1) ? 2 * node + 1 : 2 * node + 2;
+    node_order--;
+  }
+
+  block->longest[node] = 0;
+  *offset = (node - ((1ull << (block->maxOrder - order)) - 1)) * ((VkDeviceSize) UVR_VK_BUDDY_MIN_NODE << order);
+
+  while (node) {
+    node = (node - 1) / 2;
+    buddy_fixup(block, node);
+  }
+
+  block->usedBytes += (VkDeviceSize) UVR_VK_BUDDY_MIN_NODE << order;
+  return 0;
+}
+
+
+static void buddy_free(struct uvr_vk_allocator_block *block, VkDeviceSize offset, VkDeviceSize size) {
+  uint32_t order = size_to_order(size);
+  uint64_t node = ((1ull << (block->maxOrder - order)) - 1) + (offset / ((VkDeviceSize) UVR_VK_BUDDY_MIN_NODE << order));
+
+  block->longest[node] = order + 1;
+  while (node) {
+    node = (node - 1) / 2;
+    buddy_fixup(block, node);
+  }
+
+  block->usedBytes -= (VkDeviceSize) UVR_VK_BUDDY_MIN_NODE << order;
+}
+
+
+static int linear_alloc(struct uvr_vk_allocator_block *block, VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize *offset) {
+  VkDeviceSize start = (block->linearOffset + alignment - 1) & ~(alignment - 1);
+  if (start + size > block->size)
+    return -1;
+
+  *offset = start;
+  block->usedBytes += (start + size) - block->linearOffset;
+  block->linearOffset = start + size;
+  return 0;
+}
+
+
+struct uvr_vk_allocator uvr_vk_allocator_create(struct uvr_vk_allocator_create_info *uvrvk) {
+  struct uvr_vk_allocator allocator;
+  VkPhysicalDeviceProperties devprops;
+
+  if (!uvrvk->vkPhdev || !uvrvk->vkDevice) {
+    uvr_utils_log(UVR_DANGER, "[x] uvr_vk_allocator_create: VkPhysicalDevice/VkDevice not instantiated");
+    goto exit_vk_allocator;
+  }
+
+  memset(&allocator, 0, sizeof(allocator));
+  vkGetPhysicalDeviceMemoryProperties(uvrvk->vkPhdev, &allocator.vkMemoryProperties);
+  vkGetPhysicalDeviceProperties(uvrvk->vkPhdev, &devprops);
+
+  allocator.vkDevice = uvrvk->vkDevice;
+  allocator.blockSize = next_pow2((uvrvk->blockSize) ? uvrvk->blockSize : UVR_VK_ALLOCATOR_DEFAULT_BLOCK_SIZE);
+  if (allocator.blockSize < UVR_VK_BUDDY_MIN_NODE)
+    allocator.blockSize = UVR_VK_BUDDY_MIN_NODE;
+  allocator.maxMemoryAllocationCount = devprops.limits.maxMemoryAllocationCount;
+
+  uvr_utils_log(UVR_SUCCESS, "uvr_vk_allocator_create: Allocator successfully created block size(%" PRIu64 ")", allocator.blockSize);
+
+  return allocator;
+
+exit_vk_allocator:
+  return (struct uvr_vk_allocator) { .vkDevice = VK_NULL_HANDLE, .blockSize = 0, .blockCount = 0, .blocks = NULL };
+}
+
+
+struct uvr_vk_allocation uvr_vk_allocator_alloc(struct uvr_vk_allocator_alloc_info *uvrvk) {
+  struct uvr_vk_allocator *allocator = uvrvk->allocator;
+  struct uvr_vk_allocator_block *block = NULL;
+  uvr_vk_allocation_mode mode = uvrvk->mode;
+  VkDeviceSize size = uvrvk->memoryRequirements.size, alignment = uvrvk->memoryRequirements.alignment;
+  VkDeviceSize offset = 0, requested = (uvrvk->requestedSize) ? uvrvk->requestedSize : uvrvk->memoryRequirements.size;
+  int type = -1;
+
+  type = find_memory_type(allocator, uvrvk->memoryRequirements.memoryTypeBits, uvrvk->memoryPropertyFlags);
+  if (type == -1) {
+    uvr_utils_log(UVR_DANGER, "[x] uvr_vk_allocator_alloc: No memory type with property flags (0x%x) supported by resource",
+                  uvrvk->memoryPropertyFlags);
+    goto exit_vk_allocator_alloc;
+  }
+
+  if (alignment == 0)
+    alignment = 1;
+
+  if (mode != UVR_VK_ALLOCATION_DEDICATED && size > (allocator->blockSize / 2))
+    mode = UVR_VK_ALLOCATION_DEDICATED;
+
+  /* Buddy nodes are naturally aligned to their size */
+  if (mode == UVR_VK_ALLOCATION_BUDDY) {
+    size = next_pow2((size > alignment) ? size : alignment);
+    if (size < UVR_VK_BUDDY_MIN_NODE)
+      size = UVR_VK_BUDDY_MIN_NODE;
+  }
+
+  if (mode != UVR_VK_ALLOCATION_DEDICATED) {
+    for (uint32_t b = 0; b < allocator->blockCount; b++) {
+      block = allocator->blocks[b];
+      if (block->mode != mode || block->memoryTypeIndex != (uint32_t) type || block->optimalTiling != uvrvk->optimalTiling)
+        continue;
+
+      if (mode == UVR_VK_ALLOCATION_BUDDY && !buddy_alloc(block, size, &offset))
+        goto exit_vk_allocator_alloc_found;
+
+      if (mode == UVR_VK_ALLOCATION_LINEAR && !linear_alloc(block, size, alignment, &offset))
+        goto exit_vk_allocator_alloc_found;
+    }
+  }
+
+  block = block_create(allocator, (mode == UVR_VK_ALLOCATION_DEDICATED) ? size : allocator->blockSize,
+                       type, mode, uvrvk->optimalTiling);
+  if (!block)
+    goto exit_vk_allocator_alloc;
+
+  if (mode == UVR_VK_ALLOCATION_BUDDY)
+    buddy_alloc(block, size, &offset);
+  else if (mode == UVR_VK_ALLOCATION_LINEAR)
+    linear_alloc(block, size, alignment, &offset);
+  else
+    block->usedBytes = size;
+
+exit_vk_allocator_alloc_found:
+  block->allocationCount++;
+  block->requestedBytes += requested;
+  allocator->allocationCount++;
+
+  return (struct uvr_vk_allocation) { .vkDeviceMemory = block->vkDeviceMemory, .offset = offset, .size = size, .requestedSize = requested,
+                                      .pMapped = (block->pMapped) ? (char *) block->pMapped + offset : NULL,
+                                      .memoryTypeIndex = type, .mode = mode, .block = block };
+
+exit_vk_allocator_alloc:
+  return (struct uvr_vk_allocation) { .vkDeviceMemory = VK_NULL_HANDLE, .offset = 0, .size = 0, .requestedSize = 0, .pMapped = NULL,
+                                      .memoryTypeIndex = 0, .mode = uvrvk->mode, .block = NULL };
+}
+
+
+void uvr_vk_allocator_free(struct uvr_vk_allocator *allocator, struct uvr_vk_allocation *allocation) {
+  struct uvr_vk_allocator_block *block = allocation->block;
+
+  if (!allocator || !block)
+    return;
+
+  switch (allocation->mode) {
+    case UVR_VK_ALLOCATION_DEDICATED:
+      allocator->allocationCount--;
+      block_remove(allocator, block);
+      break;
+    case UVR_VK_ALLOCATION_LINEAR:
+      /* Reclaimed by uvr_vk_allocator_reset_linear */
+      break;
+    case UVR_VK_ALLOCATION_BUDDY:
+      buddy_free(block, allocation->offset, allocation->size);
+      allocator->allocationCount--;
+      block->allocationCount--;
+      block->requestedBytes -= allocation->requestedSize;
+
+      /* Keep one empty block around per kind to avoid vkAllocateMemory churn */
+      if (block->allocationCount == 0) {
+        for (uint32_t b = 0; b < allocator->blockCount; b++) {
+          if (allocator->blocks[b] != block && allocator->blocks[b]->mode == block->mode &&
+              allocator->blocks[b]->memoryTypeIndex == block->memoryTypeIndex &&
+              allocator->blocks[b]->optimalTiling == block->optimalTiling)
+          {
+            block_remove(allocator, block);
+            break;
+          }
+        }
+      }
+      break;
+  }
+
+  memset(allocation, 0, sizeof(struct uvr_vk_allocation));
+}
+
+
+void uvr_vk_allocator_reset_linear(struct uvr_vk_allocator *allocator) {
+  for (uint32_t b = 0; b < allocator->blockCount; b++) {
+    if (allocator->blocks[b]->mode != UVR_VK_ALLOCATION_LINEAR)
+      continue;
+    allocator->allocationCount -= allocator->blocks[b]->allocationCount;
+    allocator->blocks[b]->allocationCount = 0;
+    allocator->blocks[b]->usedBytes = 0;
+    allocator->blocks[b]->requestedBytes = 0;
+    allocator->blocks[b]->linearOffset = 0;
+  }
+}
+
+
+struct uvr_vk_allocator_stats uvr_vk_allocator_get_stats(struct uvr_vk_allocator *allocator) {
+  struct uvr_vk_allocator_stats stats;
+  struct uvr_vk_allocator_block *block = NULL;
+  VkDeviceSize free_bytes = 0, largest = 0;
+  uint32_t heap;
+
+  memset(&stats, 0, sizeof(stats));
+
+  for (uint32_t b = 0; b < allocator->blockCount; b++) {
+    block = allocator->blocks[b];
+    heap = allocator->vkMemoryProperties.memoryTypes[block->memoryTypeIndex].heapIndex;
+
+    stats.blockCount++;
+    stats.reservedBytes += block->size;
+    stats.usedBytes += block->usedBytes;
+    stats.requestedBytes += block->requestedBytes;
+    stats.heapUsage[heap] += block->size;
+
+    switch (block->mode) {
+      case UVR_VK_ALLOCATION_DEDICATED:
+        stats.dedicatedCount++;
+        continue;
+      case UVR_VK_ALLOCATION_LINEAR:
+        largest = block->size - block->linearOffset;
+        break;
+      case UVR_VK_ALLOCATION_BUDDY:
+        largest = (block->longest[0]) ? (VkDeviceSize) UVR_VK_BUDDY_MIN_NODE << (block->longest[0] - 1) : 0;
+        break;
+    }
+
+    free_bytes += block->size - block->usedBytes;
+    if (largest > stats.largestFreeRange)
+      stats.largestFreeRange = largest;
+  }
+
+  stats.allocationCount = allocator->allocationCount;
+  stats.vkAllocateMemoryCount = allocator->vkAllocateMemoryCount;
+  stats.fragmentation = (free_bytes) ? 1.f - ((float) stats.largestFreeRange / (float) free_bytes) : 0.f;
+
+  return stats;
+}
+
+
+struct uvr_vk_buffer uvr_vk_buffer_create(struct uvr_vk_buffer_create_info *uvrvk) {
+  VkResult res = VK_RESULT_MAX_ENUM;
+  VkBuffer buffer = VK_NULL_HANDLE;
+  VkMemoryRequirements memreqs;
+  struct uvr_vk_allocation allocation;
+  VkDevice device = (uvrvk->allocator) ? uvrvk->allocator->vkDevice : VK_NULL_HANDLE;
+
+  if (!device) {
+    uvr_utils_log(UVR_DANGER, "[x] uvr_vk_buffer_create: struct uvr_vk_allocator not instantiated");
+    goto exit_vk_buffer;
+  }
+
+  VkBufferCreateInfo create_info = {};
+  create_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+  create_info.pNext = NULL;
+  create_info.flags = uvrvk->bufferFlags;
+  create_info.size = uvrvk->bufferSize;
+  create_info.usage = uvrvk->bufferUsage;
+  create_info.sharingMode = uvrvk->bufferSharingMode;
+  create_info.queueFamilyIndexCount = uvrvk->queueFamilyIndexCount;
+  create_info.pQueueFamilyIndices = uvrvk->pQueueFamilyIndices;
+
+  res = vkCreateBuffer(device, &create_info, hostCallbacks, &buffer);
+  if (res) {
+    uvr_utils_log(UVR_DANGER, "[x] vkCreateBuffer: %s", vkres_msg(res));
+    goto exit_vk_buffer;
+  }
+
+  vkGetBufferMemoryRequirements(device, buffer, &memreqs);
+
+  struct uvr_vk_allocator_alloc_info alloc_info;
+  alloc_info.allocator = uvrvk->allocator;
+  alloc_info.memoryRequirements = memreqs;
+  alloc_info.memoryPropertyFlags = uvrvk->memoryPropertyFlags;
+  alloc_info.mode = uvrvk->mode;
+  alloc_info.optimalTiling = VK_FALSE;
+  alloc_info.requestedSize = uvrvk->bufferSize;
+
+  allocation = uvr_vk_allocator_alloc(&alloc_info);
+  if (!allocation.vkDeviceMemory)
+    goto exit_vk_buffer_destroy_buffer;
+
+  res = vkBindBufferMemory(device, buffer, allocation.vkDeviceMemory, allocation.offset);
+  if (res) {
+    uvr_utils_log(UVR_DANGER, "[x] vkBindBufferMemory: %s", vkres_msg(res));
+    goto exit_vk_buffer_free_allocation;
+  }
+
+  uvr_utils_log(UVR_SUCCESS, "uvr_vk_buffer_create: VkBuffer successfully created retval(%p)", buffer);
+
+  return (struct uvr_vk_buffer) { .vkDevice = device, .vkBuffer = buffer, .allocation = allocation, .allocator = uvrvk->allocator };
+
+exit_vk_buffer_free_allocation:
+  uvr_vk_allocator_free(uvrvk->allocator, &allocation);
+exit_vk_buffer_destroy_buffer:
+  vkDestroyBuffer(device, buffer, hostCallbacks);
+exit_vk_buffer:
+  return (struct uvr_vk_buffer) { .vkDevice = VK_NULL_HANDLE, .vkBuffer = VK_NULL_HANDLE, .allocation = {}, .allocator = NULL };
+}
+
+
 struct uvr_vk_image uvr_vk_image_create(struct uvr_vk_image_create_info *uvrvk) {
   VkResult res = VK_RESULT_MAX_ENUM;
   struct uvr_vk_image_handle *images = NULL;
@@ -597,7 +1752,7 @@ struct uvr_vk_image uvr_vk_image_create(struct uvr_vk_image_create_info *uvrvk)
   for (i = 0; i < icount; i++) {
     create_info.image = images[i].image = vkimages[i];
 
-    res = vkCreateImageView(uvrvk->vkDevice, &create_info, NULL, &views[i].view);
+    res = vkCreateImageView(uvrvk->vkDevice, &create_info, hostCallbacks, &views[i].view);
     if (res) {
       uvr_utils_log(UVR_DANGER, "[x] vkCreateImageView: %s", vkres_msg(res));
       goto exit_vk_image_free_image_view;
@@ -615,7 +1770,7 @@ exit_vk_image_free_image_view:
   if (views) {
     for (i = 0; i < icount; i++) {
       if (views[i].view)
-        vkDestroyImageView(uvrvk->vkDevice, views[i].view, NULL);
+        vkDestroyImageView(uvrvk->vkDevice, views[i].view, hostCallbacks);
     }
   }
 //exit_vk_image_free_image_views:
@@ -628,6 +1783,127 @@ exit_vk_image:
 }
 
 
+struct uvr_vk_image uvr_vk_image_create2(struct uvr_vk_image_create2_info *uvrvk) {
+  VkResult res = VK_RESULT_MAX_ENUM;
+  struct uvr_vk_image_handle *images = NULL;
+  struct uvr_vk_image_view_handle *views = NULL;
+  struct uvr_vk_allocation *allocations = NULL;
+  VkDevice device = (uvrvk->allocator) ? uvrvk->allocator->vkDevice : VK_NULL_HANDLE;
+  VkMemoryRequirements memreqs;
+  uint32_t i;
+
+  if (!device) {
+    uvr_utils_log(UVR_DANGER, "[x] uvr_vk_image_create2: struct uvr_vk_allocator not instantiated");
+    goto exit_vk_image2;
+  }
+
+  images = calloc(uvrvk->imageCount, sizeof(struct uvr_vk_image_handle));
+  if (!images) {
+    uvr_utils_log(UVR_DANGER, "[x] calloc: %s", strerror(errno));
+    goto exit_vk_image2;
+  }
+
+  views = calloc(uvrvk->imageCount, sizeof(struct uvr_vk_image_view_handle));
+  if (!views) {
+    uvr_utils_log(UVR_DANGER, "[x] calloc: %s", strerror(errno));
+    goto exit_vk_image2_free_images;
+  }
+
+  allocations = calloc(uvrvk->imageCount, sizeof(struct uvr_vk_allocation));
+  if (!allocations) {
+    uvr_utils_log(UVR_DANGER, "[x] calloc: %s", strerror(errno));
+    goto exit_vk_image2_free_views;
+  }
+
+  VkImageCreateInfo create_info = {};
+  create_info.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+  create_info.pNext = NULL;
+  create_info.flags = uvrvk->imageFlags;
+  create_info.imageType = uvrvk->imageType;
+  create_info.format = uvrvk->imageFormat;
+  create_info.extent = uvrvk->imageExtent3D;
+  create_info.mipLevels = uvrvk->imageMipLevels;
+  create_info.arrayLayers = uvrvk->imageArrayLayers;
+  create_info.samples = uvrvk->imageSamples;
+  create_info.tiling = uvrvk->imageTiling;
+  create_info.usage = uvrvk->imageUsage;
+  create_info.sharingMode = uvrvk->imageSharingMode;
+  create_info.queueFamilyIndexCount = uvrvk->queueFamilyIndexCount;
+  create_info.pQueueFamilyIndices = uvrvk->pQueueFamilyIndices;
+  create_info.initialLayout = uvrvk->imageInitialLayout;
+
+  VkImageViewCreateInfo view_create_info = {};
+  view_create_info.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+  view_create_info.pNext = NULL;
+  view_create_info.flags = uvrvk->imageViewFlags;
+  view_create_info.viewType = uvrvk->imageViewType;
+  view_create_info.format = uvrvk->imageFormat;
+  view_create_info.components = uvrvk->imageViewComponents;
+  view_create_info.subresourceRange = uvrvk->imageViewSubresourceRange;
+
+  struct uvr_vk_allocator_alloc_info alloc_info;
+  alloc_info.allocator = uvrvk->allocator;
+  alloc_info.memoryPropertyFlags = uvrvk->memoryPropertyFlags;
+  alloc_info.mode = uvrvk->mode;
+  alloc_info.optimalTiling = (uvrvk->imageTiling == VK_IMAGE_TILING_OPTIMAL);
+  alloc_info.requestedSize = 0;
+
+  for (i = 0; i < uvrvk->imageCount; i++) {
+    res = vkCreateImage(device, &create_info, hostCallbacks, &images[i].image);
+    if (res) {
+      uvr_utils_log(UVR_DANGER, "[x] vkCreateImage: %s", vkres_msg(res));
+      goto exit_vk_image2_destroy_images;
+    }
+
+    vkGetImageMemoryRequirements(device, images[i].image, &memreqs);
+    alloc_info.memoryRequirements = memreqs;
+
+    allocations[i] = uvr_vk_allocator_alloc(&alloc_info);
+    if (!allocations[i].vkDeviceMemory)
+      goto exit_vk_image2_destroy_images;
+
+    res = vkBindImageMemory(device, images[i].image, allocations[i].vkDeviceMemory, allocations[i].offset);
+    if (res) {
+      uvr_utils_log(UVR_DANGER, "[x] vkBindImageMemory: %s", vkres_msg(res));
+      goto exit_vk_image2_destroy_images;
+    }
+
+    view_create_info.image = images[i].image;
+    res = vkCreateImageView(device, &view_create_info, hostCallbacks, &views[i].view);
+    if (res) {
+      uvr_utils_log(UVR_DANGER, "[x] vkCreateImageView: %s", vkres_msg(res));
+      goto exit_vk_image2_destroy_images;
+    }
+
+    uvr_utils_log(UVR_SUCCESS, "uvr_vk_image_create2: VkImage successfully created retval(%p)", images[i].image);
+    uvr_utils_log(UVR_SUCCESS, "uvr_vk_image_create2: VkImageView successfully created retval(%p)", views[i].view);
+  }
+
+  return (struct uvr_vk_image) { .vkDevice = device, .imageCount = uvrvk->imageCount, .vkImages = images,
+                                 .vkImageViews = views, .vkSwapchain = VK_NULL_HANDLE, .allocations = allocations,
+                                 .allocator = uvrvk->allocator };
+
+exit_vk_image2_destroy_images:
+  for (i = 0; i < uvrvk->imageCount; i++) {
+    if (views[i].view)
+      vkDestroyImageView(device, views[i].view, hostCallbacks);
+    if (images[i].image)
+      vkDestroyImage(device, images[i].image, hostCallbacks);
+    uvr_vk_allocator_free(uvrvk->allocator, &allocations[i]);
+  }
+//exit_vk_image2_free_allocations:
+  free(allocations);
+exit_vk_image2_free_views:
+  free(views);
+exit_vk_image2_free_images:
+  free(images);
+exit_vk_image2:
+  return (struct uvr_vk_image) { .vkDevice = VK_NULL_HANDLE, .imageCount = 0, .vkImages = NULL,
+                                 .vkImageViews = NULL, .vkSwapchain = VK_NULL_HANDLE, .allocations = NULL,
+                                 .allocator = NULL };
+}
+
+
 struct uvr_vk_shader_module uvr_vk_shader_module_create(struct uvr_vk_shader_module_create_info *uvrvk) {
   VkResult res = VK_RESULT_MAX_ENUM;
   VkShaderModule shader = VK_NULL_HANDLE;
@@ -639,7 +1915,7 @@ struct uvr_vk_shader_module uvr_vk_shader_module_create(struct uvr_vk_shader_mod
   create_info.codeSize = uvrvk->codeSize;
   create_info.pCode = (const uint32_t *) uvrvk->pCode;
 
-  res = vkCreateShaderModule(uvrvk->vkDevice, &create_info, NULL, &shader);
+  res = vkCreateShaderModule(uvrvk->vkDevice, &create_info, hostCallbacks, &shader);
   if (res) {
     uvr_utils_log(UVR_DANGER, "[x] vkCreateShaderModule: %s", vkres_msg(res));
     goto exit_vk_shader_module;
@@ -667,7 +1943,7 @@ struct uvr_vk_pipeline_layout uvr_vk_pipeline_layout_create(struct uvr_vk_pipeli
   create_info.pushConstantRangeCount = uvrvk->pushConstantRangeCount;
   create_info.pPushConstantRanges = uvrvk->pPushConstantRanges;
 
-  res = vkCreatePipelineLayout(uvrvk->vkDevice, &create_info, NULL, &playout);
+  res = vkCreatePipelineLayout(uvrvk->vkDevice, &create_info, hostCallbacks, &playout);
   if (res) {
     uvr_utils_log(UVR_DANGER, "[x] vkCreatePipelineLayout: %s", vkres_msg(res));
     goto exit_vk_pipeline_layout;
@@ -697,7 +1973,7 @@ struct uvr_vk_render_pass uvr_vk_render_pass_create(struct uvr_vk_render_pass_cr
   create_info.dependencyCount = uvrvk->dependencyCount;
   create_info.pDependencies = uvrvk->pDependencies;
 
-  res = vkCreateRenderPass(uvrvk->vkDevice, &create_info, NULL, &renderpass);
+  res = vkCreateRenderPass(uvrvk->vkDevice, &create_info, hostCallbacks, &renderpass);
   if (res) {
     uvr_utils_log(UVR_DANGER, "[x] vkCreateRenderPass: %s", vkres_msg(res));
     goto exit_vk_render_pass;
@@ -712,278 +1988,7479 @@ exit_vk_render_pass:
 }
 
 
-struct uvr_vk_graphics_pipeline uvr_vk_graphics_pipeline_create(struct uvr_vk_graphics_pipeline_create_info *uvrvk) {
-  VkResult res = VK_RESULT_MAX_ENUM;
-  VkPipeline pipeline = VK_NULL_HANDLE;
+/*
+ * On-disk pipeline cache blob header. Written in front of the data returned
+ * by vkGetPipelineCacheData so stale blobs (driver update, different GPU)
+ * and torn/corrupt files can be rejected before handing them to the driver.
+ */
+#define UVR_VK_PIPELINE_CACHE_MAGIC 0x43505655 /* "UVPC" */
+#define UVR_VK_PIPELINE_CACHE_VERSION 1
+
+struct uvr_vk_pipeline_cache_header {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t vendorID;
+  uint32_t deviceID;
+  uint32_t driverVersion;
+  uint8_t  pipelineCacheUUID[VK_UUID_SIZE];
+  uint64_t dataSize;
+  uint64_t checksum;
+};
 
-  VkGraphicsPipelineCreateInfo create_info = {};
-  create_info.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-  create_info.pNext = NULL;
-  create_info.flags = 0;
-  create_info.stageCount = uvrvk->stageCount;
-  create_info.pStages = uvrvk->pStages;
-  create_info.pVertexInputState = uvrvk->pVertexInputState;
-  create_info.pInputAssemblyState = uvrvk->pInputAssemblyState;
-  create_info.pTessellationState = uvrvk->pTessellationState;
-  create_info.pViewportState = uvrvk->pViewportState;
-  create_info.pRasterizationState = uvrvk->pRasterizationState;
-  create_info.pMultisampleState = uvrvk->pMultisampleState;
-  create_info.pDepthStencilState = uvrvk->pDepthStencilState;
-  create_info.pColorBlendState = uvrvk->pColorBlendState;
-  create_info.pDynamicState = uvrvk->pDynamicState;
-  create_info.layout = uvrvk->vkPipelineLayout;
-  create_info.renderPass = uvrvk->renderPass;
-  create_info.subpass = uvrvk->subpass;
-  // Won't be supporting
-  create_info.basePipelineHandle = VK_NULL_HANDLE;
-  create_info.basePipelineIndex = -1;
 
-  res = vkCreateGraphicsPipelines(uvrvk->vkDevice, NULL, 1, &create_info, NULL, &pipeline);
-  if (res) {
-    uvr_utils_log(UVR_DANGER, "[x] vkCreateGraphicsPipelines: %s", vkres_msg(res));
-    goto exit_vk_graphics_pipeline;
+/* 64-bit FNV-1a. Pass the previous return value as @hash to hash non-contiguous data. */
+static uint64_t fnv1a64_update(uint64_t hash, const void *data, size_t size) {
+  const uint8_t *bytes = data;
+  size_t i;
+
+  for (i = 0; i < size; i++) {
+    hash ^= bytes[i];
+    hash *= 0x100000001b3ULL;
   }
 
-  uvr_utils_log(UVR_SUCCESS, "uvr_vk_graphics_pipeline_create: VkPipeline successfully created retval(%p)", pipeline);
+  return hash;
+}
 
-  return (struct uvr_vk_graphics_pipeline) { .vkDevice = uvrvk->vkDevice, .graphicsPipeline = pipeline };
 
-exit_vk_graphics_pipeline:
-  return (struct uvr_vk_graphics_pipeline) { .vkDevice = VK_NULL_HANDLE, .graphicsPipeline = VK_NULL_HANDLE };
+static uint64_t fnv1a64(const void *data, size_t size) {
+  return fnv1a64_update(0xcbf29ce484222325ULL, data, size);
 }
 
 
-struct uvr_vk_framebuffer uvr_vk_framebuffer_create(struct uvr_vk_framebuffer_create_info *uvrvk) {
-  VkResult res = VK_RESULT_MAX_ENUM;
-  struct uvr_vk_framebuffer_handle *vkfbs = NULL;
-  uint32_t fbc;
+static double elapsed_ms(struct timespec *start, struct timespec *end) {
+  return (double) (end->tv_sec - start->tv_sec) * 1000.0 + (double) (end->tv_nsec - start->tv_nsec) / 1000000.0;
+}
 
-  vkfbs = (struct uvr_vk_framebuffer_handle *) calloc(uvrvk->frameBufferCount, sizeof(vkfbs));
-  if (!vkfbs) {
-    uvr_utils_log(UVR_DANGER, "[x] calloc: %s", strerror(errno));
-    goto exit_vk_framebuffer;
-  }
 
-  VkFramebufferCreateInfo create_info = {};
-  create_info.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+static uint64_t timespec_diff_ns(struct timespec *start, struct timespec *end) {
+  return (uint64_t) (end->tv_sec - start->tv_sec) * 1000000000ULL + (uint64_t) end->tv_nsec - (uint64_t) start->tv_nsec;
+}
+
+
+/*
+ * Loads @filePath and validates both our header and the header the driver embeds
+ * at the start of the pipeline cache data. Returns a pointer to calloc'd memory
+ * holding only the driver data on success, NULL if the blob can't be used.
+ */
+static void *pipeline_cache_load(struct uvr_vk_pipeline_cache *pcache, size_t *dataSize) {
+  struct uvr_vk_pipeline_cache_header header;
+  VkPipelineCacheHeaderVersionOne vkheader;
+  void *data = NULL;
+  FILE *stream = NULL;
+
+  *dataSize = 0;
+
+  stream = fopen(pcache->filePath, "rb");
+  if (!stream) {
+    if (errno != ENOENT)
+      uvr_utils_log(UVR_WARNING, "[x] fopen('%s'): %s", pcache->filePath, strerror(errno));
+    return NULL;
+  }
+
+  if (fread(&header, sizeof(header), 1, stream) != 1) {
+    uvr_utils_log(UVR_WARNING, "uvr_vk_pipeline_cache_create: '%s' truncated header, ignoring", pcache->filePath);
+    goto exit_pipeline_cache_load_fclose;
+  }
+
+  if (header.magic != UVR_VK_PIPELINE_CACHE_MAGIC || header.version != UVR_VK_PIPELINE_CACHE_VERSION) {
+    uvr_utils_log(UVR_WARNING, "uvr_vk_pipeline_cache_create: '%s' unknown blob format, ignoring", pcache->filePath);
+    goto exit_pipeline_cache_load_fclose;
+  }
+
+  if (header.vendorID != pcache->vendorID || header.deviceID != pcache->deviceID ||
+      header.driverVersion != pcache->driverVersion ||
+      memcmp(header.pipelineCacheUUID, pcache->pipelineCacheUUID, VK_UUID_SIZE))
+  {
+    uvr_utils_log(UVR_WARNING, "uvr_vk_pipeline_cache_create: '%s' written for a different device/driver, ignoring", pcache->filePath);
+    goto exit_pipeline_cache_load_fclose;
+  }
+
+  if (header.dataSize < sizeof(vkheader) || header.dataSize > SIZE_MAX) {
+    uvr_utils_log(UVR_WARNING, "uvr_vk_pipeline_cache_create: '%s' invalid data size, ignoring", pcache->filePath);
+    goto exit_pipeline_cache_load_fclose;
+  }
+
+  data = calloc(1, header.dataSize);
+  if (!data) {
+    uvr_utils_log(UVR_DANGER, "[x] calloc: %s", strerror(errno));
+    goto exit_pipeline_cache_load_fclose;
+  }
+
+  if (fread(data, header.dataSize, 1, stream) != 1) {
+    uvr_utils_log(UVR_WARNING, "uvr_vk_pipeline_cache_create: '%s' truncated data, ignoring", pcache->filePath);
+    goto exit_pipeline_cache_load_free;
+  }
+
+  if (fnv1a64(data, header.dataSize) != header.checksum) {
+    uvr_utils_log(UVR_WARNING, "uvr_vk_pipeline_cache_create: '%s' checksum mismatch, ignoring", pcache->filePath);
+    goto exit_pipeline_cache_load_free;
+  }
+
+  /* Driver embedded header must agree with ours, otherwise the driver would silently discard it */
+  memcpy(&vkheader, data, sizeof(vkheader));
+  if (vkheader.headerSize < sizeof(vkheader) || vkheader.headerVersion != VK_PIPELINE_CACHE_HEADER_VERSION_ONE ||
+      vkheader.vendorID != pcache->vendorID || vkheader.deviceID != pcache->deviceID ||
+      memcmp(vkheader.pipelineCacheUUID, pcache->pipelineCacheUUID, VK_UUID_SIZE))
+  {
+    uvr_utils_log(UVR_WARNING, "uvr_vk_pipeline_cache_create: '%s' driver header mismatch, ignoring", pcache->filePath);
+    goto exit_pipeline_cache_load_free;
+  }
+
+  fclose(stream);
+  *dataSize = header.dataSize;
+  return data;
+
+exit_pipeline_cache_load_free:
+  free(data);
+exit_pipeline_cache_load_fclose:
+  fclose(stream);
+  return NULL;
+}
+
+
+struct uvr_vk_pipeline_cache uvr_vk_pipeline_cache_create(struct uvr_vk_pipeline_cache_create_info *uvrvk) {
+  VkResult res = VK_RESULT_MAX_ENUM;
+  VkPhysicalDeviceProperties phdevProps;
+  struct uvr_vk_pipeline_cache pcache;
+  size_t dataSize = 0;
+  void *data = NULL;
+
+  memset(&pcache, 0, sizeof(pcache));
+
+  vkGetPhysicalDeviceProperties(uvrvk->vkPhdev, &phdevProps);
+  pcache.vkDevice = uvrvk->vkDevice;
+  pcache.filePath = uvrvk->filePath;
+  pcache.vendorID = phdevProps.vendorID;
+  pcache.deviceID = phdevProps.deviceID;
+  pcache.driverVersion = phdevProps.driverVersion;
+  memcpy(pcache.pipelineCacheUUID, phdevProps.pipelineCacheUUID, VK_UUID_SIZE);
+
+  if (pcache.filePath)
+    data = pipeline_cache_load(&pcache, &dataSize);
+
+  VkPipelineCacheCreateInfo create_info = {};
+  create_info.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
   create_info.pNext = NULL;
   create_info.flags = 0;
-  create_info.renderPass = uvrvk->renderPass;
-  create_info.width = uvrvk->width;
-  create_info.height = uvrvk->height;
-  create_info.layers = uvrvk->layers;
+  create_info.initialDataSize = dataSize;
+  create_info.pInitialData = data;
+
+  res = vkCreatePipelineCache(uvrvk->vkDevice, &create_info, hostCallbacks, &pcache.vkPipelineCache);
+  if (res && data) {
+    /* Driver rejected the blob, start cold rather than fail */
+    uvr_utils_log(UVR_WARNING, "[x] vkCreatePipelineCache: %s, retrying with empty cache", vkres_msg(res));
+    create_info.initialDataSize = dataSize = 0;
+    create_info.pInitialData = NULL;
+    res = vkCreatePipelineCache(uvrvk->vkDevice, &create_info, hostCallbacks, &pcache.vkPipelineCache);
+  }
+
+  free(data);
+
+  if (res) {
+    uvr_utils_log(UVR_DANGER, "[x] vkCreatePipelineCache: %s", vkres_msg(res));
+    goto exit_vk_pipeline_cache;
+  }
+
+  pcache.loadedSize = dataSize;
+
+  uvr_utils_log(UVR_SUCCESS, "uvr_vk_pipeline_cache_create: VkPipelineCache successfully created retval(%p) seeded with %zu bytes",
+                             pcache.vkPipelineCache, pcache.loadedSize);
+
+  return pcache;
+
+exit_vk_pipeline_cache:
+  return (struct uvr_vk_pipeline_cache) { .vkDevice = VK_NULL_HANDLE, .vkPipelineCache = VK_NULL_HANDLE, .filePath = NULL };
+}
+
+
+static int write_all(int fd, const void *data, size_t size) {
+  const uint8_t *bytes = data;
+  ssize_t ret;
+
+  while (size) {
+    ret = write(fd, bytes, size);
+    if (ret == -1) {
+      if (errno == EINTR)
+        continue;
+      return -1;
+    }
+
+    bytes += ret;
+    size -= ret;
+  }
+
+  return 0;
+}
+
+
+int uvr_vk_pipeline_cache_store(struct uvr_vk_pipeline_cache *uvrvk) {
+  VkResult res = VK_RESULT_MAX_ENUM;
+  struct uvr_vk_pipeline_cache_header header;
+  char *tmpPath = NULL, *dirSep = NULL;
+  void *data = NULL;
+  size_t dataSize = 0;
+  int fd = -1, ret = -1;
+
+  if (!uvrvk->vkDevice || !uvrvk->vkPipelineCache || !uvrvk->filePath)
+    return -1;
+
+  res = vkGetPipelineCacheData(uvrvk->vkDevice, uvrvk->vkPipelineCache, &dataSize, NULL);
+  if (res) {
+    uvr_utils_log(UVR_DANGER, "[x] vkGetPipelineCacheData: %s", vkres_msg(res));
+    return -1;
+  }
+
+  data = calloc(1, dataSize);
+  if (!data) {
+    uvr_utils_log(UVR_DANGER, "[x] calloc: %s", strerror(errno));
+    return -1;
+  }
+
+  res = vkGetPipelineCacheData(uvrvk->vkDevice, uvrvk->vkPipelineCache, &dataSize, data);
+  if (res) {
+    uvr_utils_log(UVR_DANGER, "[x] vkGetPipelineCacheData: %s", vkres_msg(res));
+    goto exit_vk_pipeline_cache_store_free_data;
+  }
+
+  memset(&header, 0, sizeof(header));
+  header.magic = UVR_VK_PIPELINE_CACHE_MAGIC;
+  header.version = UVR_VK_PIPELINE_CACHE_VERSION;
+  header.vendorID = uvrvk->vendorID;
+  header.deviceID = uvrvk->deviceID;
+  header.driverVersion = uvrvk->driverVersion;
+  memcpy(header.pipelineCacheUUID, uvrvk->pipelineCacheUUID, VK_UUID_SIZE);
+  header.dataSize = dataSize;
+  header.checksum = fnv1a64(data, dataSize);
+
+  tmpPath = calloc(1, strlen(uvrvk->filePath) + sizeof(".XXXXXX"));
+  if (!tmpPath) {
+    uvr_utils_log(UVR_DANGER, "[x] calloc: %s", strerror(errno));
+    goto exit_vk_pipeline_cache_store_free_data;
+  }
+
+  strcpy(tmpPath, uvrvk->filePath);
+  strcat(tmpPath, ".XXXXXX");
+
+  /* Write to a sibling temp file then rename so a crash never leaves a torn blob at @filePath */
+  fd = mkstemp(tmpPath);
+  if (fd == -1) {
+    uvr_utils_log(UVR_DANGER, "[x] mkstemp('%s'): %s", tmpPath, strerror(errno));
+    goto exit_vk_pipeline_cache_store_free_path;
+  }
+
+  if (write_all(fd, &header, sizeof(header)) == -1 || write_all(fd, data, dataSize) == -1) {
+    uvr_utils_log(UVR_DANGER, "[x] write('%s'): %s", tmpPath, strerror(errno));
+    goto exit_vk_pipeline_cache_store_unlink;
+  }
+
+  if (fsync(fd) == -1) {
+    uvr_utils_log(UVR_DANGER, "[x] fsync('%s'): %s", tmpPath, strerror(errno));
+    goto exit_vk_pipeline_cache_store_unlink;
+  }
+
+  close(fd); fd = -1;
+
+  if (rename(tmpPath, uvrvk->filePath) == -1) {
+    uvr_utils_log(UVR_DANGER, "[x] rename('%s', '%s'): %s", tmpPath, uvrvk->filePath, strerror(errno));
+    goto exit_vk_pipeline_cache_store_unlink;
+  }
+
+  /* The rename only survives a crash once the parent directory entry is on disk, @tmpPath is reused for its name */
+  strcpy(tmpPath, uvrvk->filePath);
+  dirSep = strrchr(tmpPath, '/');
+  if (!dirSep)
+    strcpy(tmpPath, ".");
+  else
+    *((dirSep == tmpPath) ? dirSep + 1 : dirSep) = '\0';
+
+  fd = open(tmpPath, O_RDONLY | O_DIRECTORY);
+  if (fd == -1 || fsync(fd) == -1)
+    uvr_utils_log(UVR_WARNING, "[x] fsync('%s'): %s, '%s' may revert to its previous contents after a crash",
+                               tmpPath, strerror(errno), uvrvk->filePath);
+
+  if (fd != -1) {
+    close(fd); fd = -1;
+  }
+
+  uvr_utils_log(UVR_SUCCESS, "uvr_vk_pipeline_cache_store: wrote %zu bytes to '%s'", dataSize, uvrvk->filePath);
+  ret = 0;
+  goto exit_vk_pipeline_cache_store_free_path;
+
+exit_vk_pipeline_cache_store_unlink:
+  if (fd != -1)
+    close(fd);
+  unlink(tmpPath);
+exit_vk_pipeline_cache_store_free_path:
+  free(tmpPath);
+exit_vk_pipeline_cache_store_free_data:
+  free(data);
+  return ret;
+}
+
+
+/* Translates a struct uvr_vk_graphics_pipeline_create_info, shared by single and batched pipeline creation */
+static void graphics_pipeline_create_info(const struct uvr_vk_graphics_pipeline_create_info *uvrvk, VkGraphicsPipelineCreateInfo *create_info) {
+  memset(create_info, 0, sizeof(*create_info));
+  create_info->sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+  create_info->pNext = uvrvk->pRenderingInfo;
+  create_info->flags = 0;
+  create_info->stageCount = uvrvk->stageCount;
+  create_info->pStages = uvrvk->pStages;
+  create_info->pVertexInputState = uvrvk->pVertexInputState;
+  create_info->pInputAssemblyState = uvrvk->pInputAssemblyState;
+  create_info->pTessellationState = uvrvk->pTessellationState;
+  create_info->pViewportState = uvrvk->pViewportState;
+  create_info->pRasterizationState = uvrvk->pRasterizationState;
+  create_info->pMultisampleState = uvrvk->pMultisampleState;
+  create_info->pDepthStencilState = uvrvk->pDepthStencilState;
+  create_info->pColorBlendState = uvrvk->pColorBlendState;
+  create_info->pDynamicState = uvrvk->pDynamicState;
+  create_info->layout = uvrvk->vkPipelineLayout;
+  create_info->renderPass = uvrvk->renderPass;
+  create_info->subpass = uvrvk->subpass;
+  // Won't be supporting
+  create_info->basePipelineHandle = VK_NULL_HANDLE;
+  create_info->basePipelineIndex = -1;
+}
+
+
+struct uvr_vk_graphics_pipeline uvr_vk_graphics_pipeline_create(struct uvr_vk_graphics_pipeline_create_info *uvrvk) {
+  VkResult res = VK_RESULT_MAX_ENUM;
+  VkPipeline pipeline = VK_NULL_HANDLE;
+  struct timespec start, end;
+
+  if (uvrvk->pRenderingInfo && uvrvk->renderPass) {
+    uvr_utils_log(UVR_DANGER, "[x] uvr_vk_graphics_pipeline_create: pRenderingInfo requires renderPass to be VK_NULL_HANDLE");
+    goto exit_vk_graphics_pipeline;
+  }
+
+  VkGraphicsPipelineCreateInfo create_info;
+  graphics_pipeline_create_info(uvrvk, &create_info);
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  res = vkCreateGraphicsPipelines(uvrvk->vkDevice, uvrvk->vkPipelineCache, 1, &create_info, hostCallbacks, &pipeline);
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  if (res) {
+    uvr_utils_log(UVR_DANGER, "[x] vkCreateGraphicsPipelines: %s", vkres_msg(res));
+    goto exit_vk_graphics_pipeline;
+  }
+
+  uvr_utils_log(UVR_SUCCESS, "uvr_vk_graphics_pipeline_create: VkPipeline successfully created retval(%p) in %.3f ms (cache: %p)",
+                             pipeline, elapsed_ms(&start, &end), uvrvk->vkPipelineCache);
+
+  return (struct uvr_vk_graphics_pipeline) { .vkDevice = uvrvk->vkDevice, .graphicsPipeline = pipeline };
+
+exit_vk_graphics_pipeline:
+  return (struct uvr_vk_graphics_pipeline) { .vkDevice = VK_NULL_HANDLE, .graphicsPipeline = VK_NULL_HANDLE };
+}
+
+
+/* State shared by every worker of a uvr_vk_graphics_pipeline_create_batch(3) call */
+struct graphics_pipeline_batch {
+  struct uvr_vk_graphics_pipeline_batch_info *info;
+  uint32_t                                   next;
+  uint32_t                                   failed;
+  uint64_t                                   compileNs;
+};
+
+
+struct graphics_pipeline_worker {
+  struct graphics_pipeline_batch *batch;
+  VkPipelineCache                vkPipelineCache;
+};
+
+
+/* Pulls descriptions off the shared counter until none are left. Only this worker touches its cache. */
+static void graphics_pipeline_batch_job(void *data) {
+  struct graphics_pipeline_worker *worker = data;
+  struct graphics_pipeline_batch *batch = worker->batch;
+  struct uvr_vk_graphics_pipeline_batch_info *info = batch->info;
+  const struct uvr_vk_graphics_pipeline_create_info *desc;
+  VkGraphicsPipelineCreateInfo create_info;
+  VkPipelineCache cache;
+  VkPipeline pipeline;
+  struct timespec start, end;
+  VkResult res;
+  uint32_t i;
+
+  while ((i = __atomic_fetch_add(&batch->next, 1, __ATOMIC_RELAXED)) < info->pipelineCount) {
+    desc = &info->pCreateInfos[i];
+    info->pPipelines[i] = (struct uvr_vk_graphics_pipeline) { .vkDevice = VK_NULL_HANDLE, .graphicsPipeline = VK_NULL_HANDLE };
+
+    if (desc->pRenderingInfo && desc->renderPass) {
+      uvr_utils_log(UVR_DANGER, "[x] uvr_vk_graphics_pipeline_create_batch: pipeline %u pRenderingInfo requires renderPass to be VK_NULL_HANDLE", i);
+      __atomic_fetch_add(&batch->failed, 1, __ATOMIC_RELAXED);
+      continue;
+    }
+
+    graphics_pipeline_create_info(desc, &create_info);
+    cache = (info->pipelineCache) ? worker->vkPipelineCache : desc->vkPipelineCache;
+    pipeline = VK_NULL_HANDLE;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    res = vkCreateGraphicsPipelines(info->vkDevice, cache, 1, &create_info, hostCallbacks, &pipeline);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    __atomic_fetch_add(&batch->compileNs, timespec_diff_ns(&start, &end), __ATOMIC_RELAXED);
+
+    if (res) {
+      uvr_utils_log(UVR_DANGER, "[x] vkCreateGraphicsPipelines: pipeline %u %s", i, vkres_msg(res));
+      __atomic_fetch_add(&batch->failed, 1, __ATOMIC_RELAXED);
+      continue;
+    }
+
+    info->pPipelines[i] = (struct uvr_vk_graphics_pipeline) { .vkDevice = info->vkDevice, .graphicsPipeline = pipeline };
+  }
+}
+
+
+struct uvr_vk_graphics_pipeline_batch_stats uvr_vk_graphics_pipeline_create_batch(struct uvr_vk_graphics_pipeline_batch_info *uvrvk) {
+  struct uvr_vk_graphics_pipeline_batch_stats stats;
+  struct graphics_pipeline_worker *workers = NULL;
+  struct graphics_pipeline_batch batch;
+  struct uvr_utils_thread_pool transientPool, *pool = NULL;
+  VkPipelineCache *workerCaches = NULL;
+  struct timespec start, end;
+  uint32_t t, threadCount, workerCount, cacheCount = 0;
+  void *seedData = NULL;
+  size_t seedSize = 0;
+  VkResult res;
+
+  memset(&stats, 0, sizeof(stats));
+
+  if (!uvrvk->pipelineCount)
+    return stats;
+
+  threadCount = (uvrvk->threadCount) ? uvrvk->threadCount :
+                (uvrvk->threadPool) ? uvrvk->threadPool->threadCount : (uint32_t) sysconf(_SC_NPROCESSORS_ONLN);
+  threadCount = (!threadCount) ? 1 : (threadCount > uvrvk->pipelineCount) ? uvrvk->pipelineCount : threadCount;
+  workerCount = threadCount;
+
+  batch.info = uvrvk;
+  batch.next = 0;
+  batch.failed = 0;
+  batch.compileNs = 0;
+
+  workers = calloc(workerCount, sizeof(struct graphics_pipeline_worker));
+  workerCaches = calloc(workerCount, sizeof(VkPipelineCache));
+  if (!workers || !workerCaches) {
+    uvr_utils_log(UVR_DANGER, "[x] calloc: %s", strerror(errno));
+    free(workers);
+    free(workerCaches);
+    stats.failedCount = uvrvk->pipelineCount;
+    return stats;
+  }
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+
+  /* Seed every private cache with what the shared cache already knows so warm starts still hit */
+  if (uvrvk->pipelineCache && uvrvk->pipelineCache->vkPipelineCache) {
+    res = vkGetPipelineCacheData(uvrvk->vkDevice, uvrvk->pipelineCache->vkPipelineCache, &seedSize, NULL);
+    if (!res && seedSize) {
+      seedData = malloc(seedSize);
+      if (seedData)
+        res = vkGetPipelineCacheData(uvrvk->vkDevice, uvrvk->pipelineCache->vkPipelineCache, &seedSize, seedData);
+      if (!seedData || res) {
+        free(seedData);
+        seedData = NULL;
+        seedSize = 0;
+      }
+    }
+
+    VkPipelineCacheCreateInfo cache_info = {};
+    cache_info.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    cache_info.pNext = NULL;
+    cache_info.flags = VK_PIPELINE_CACHE_CREATE_EXTERNALLY_SYNCHRONIZED_BIT;
+    cache_info.initialDataSize = seedSize;
+    cache_info.pInitialData = seedData;
+
+    for (t = 0; t < workerCount; t++) {
+      res = vkCreatePipelineCache(uvrvk->vkDevice, &cache_info, hostCallbacks, &workerCaches[t]);
+      if (res) {
+        uvr_utils_log(UVR_WARNING, "[x] vkCreatePipelineCache: %s, worker %u compiles uncached", vkres_msg(res), t);
+        workerCaches[t] = VK_NULL_HANDLE;
+      } else {
+        cacheCount++;
+      }
+    }
+
+    free(seedData);
+  }
+
+  for (t = 0; t < workerCount; t++) {
+    workers[t].batch = &batch;
+    workers[t].vkPipelineCache = workerCaches[t];
+  }
+
+  /* Spawning threads per batch costs more than small batches take to compile, only do so without a caller pool */
+  if (threadCount > 1) {
+    if (uvrvk->threadPool)
+      pool = uvrvk->threadPool;
+    else if (uvr_utils_thread_pool_create(&transientPool, threadCount) == 0)
+      pool = &transientPool;
+  }
+
+  if (pool) {
+    for (t = 0; t < threadCount; t++) {
+      if (uvr_utils_thread_pool_submit(pool, graphics_pipeline_batch_job, &workers[t]) == -1)
+        break;
+    }
+
+    uvr_utils_thread_pool_wait(pool);
+    if (pool == &transientPool)
+      uvr_utils_thread_pool_destroy(pool);
+
+    /* Workers that never got queued leave their share to the ones that did, anything left runs here */
+    graphics_pipeline_batch_job(&workers[0]);
+  } else {
+    /* No worker threads, compile everything on the calling thread against the first cache */
+    threadCount = 1;
+    graphics_pipeline_batch_job(&workers[0]);
+  }
+
+  if (cacheCount) {
+    /* vkMergePipelineCaches rejects VK_NULL_HANDLE sources, compact the valid ones first */
+    for (t = 0, cacheCount = 0; t < workerCount; t++) {
+      if (workerCaches[t])
+        workerCaches[cacheCount++] = workerCaches[t];
+    }
+
+    res = vkMergePipelineCaches(uvrvk->vkDevice, uvrvk->pipelineCache->vkPipelineCache, cacheCount, workerCaches);
+    if (res)
+      uvr_utils_log(UVR_WARNING, "[x] vkMergePipelineCaches: %s", vkres_msg(res));
+
+    for (t = 0; t < cacheCount; t++)
+      vkDestroyPipelineCache(uvrvk->vkDevice, workerCaches[t], hostCallbacks);
+  }
+
+  clock_gettime(CLOCK_MONOTONIC, &end);
+
+  free(workerCaches);
+  free(workers);
+
+  stats.failedCount = batch.failed;
+  stats.createdCount = uvrvk->pipelineCount - batch.failed;
+  stats.threadCount = threadCount;
+  stats.wallMs = elapsed_ms(&start, &end);
+  stats.compileMs = (double) batch.compileNs / 1000000.0;
+  stats.speedup = (stats.wallMs > 0.0) ? stats.compileMs / stats.wallMs : 0.0;
+
+  uvr_utils_log(UVR_SUCCESS, "uvr_vk_graphics_pipeline_create_batch: %u/%u pipelines on %u thread(s) in %.3f ms (compile %.3f ms, %.2fx)",
+                             stats.createdCount, uvrvk->pipelineCount, stats.threadCount, stats.wallMs, stats.compileMs, stats.speedup);
+
+  return stats;
+}
+
+
+enum pipeline_library_optimize_state {
+  PIPELINE_LIBRARY_OPTIMIZE_NONE = 0,
+  PIPELINE_LIBRARY_OPTIMIZE_PENDING = 1,
+  PIPELINE_LIBRARY_OPTIMIZE_READY = 2,
+  PIPELINE_LIBRARY_OPTIMIZE_FAILED = 3,
+};
+
+
+/*
+ * Everything a background link needs is copied in so jobs never touch the
+ * struct uvr_vk_pipeline_library the caller may move around.
+ */
+struct uvr_vk_pipeline_library_variant {
+  VkDevice                               vkDevice;
+  VkPipelineLayout                       vkPipelineLayout;
+  VkPipelineCache                        vkPipelineCache;
+  VkPipeline                             libraries[4];
+  VkPipeline                             fastPipeline;
+  VkPipeline                             optimizedPipeline;
+  uint32_t                               optimizeState;
+  uint64_t                               linkNs;
+  uint64_t                               optimizeNs;
+  struct uvr_vk_pipeline_library_variant *next;
+};
+
+
+VkBool32 uvr_vk_pipeline_library_supported(VkPhysicalDevice vkPhdev) {
+  VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT gpl = {};
+  gpl.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_FEATURES_EXT;
+  gpl.pNext = NULL;
+
+  VkPhysicalDeviceFeatures2 features2 = {};
+  features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+  features2.pNext = &gpl;
+
+  /* Drivers leave unknown structures untouched, graphicsPipelineLibrary stays VK_FALSE without the extension */
+  vkGetPhysicalDeviceFeatures2(vkPhdev, &features2);
+
+  return gpl.graphicsPipelineLibrary;
+}
+
+
+/* Compiles one VK_EXT_graphics_pipeline_library part. Retains link time optimization info for background links. */
+static VkPipeline pipeline_library_part_create(VkDevice vkDevice, VkPipelineCache vkPipelineCache, VkGraphicsPipelineLibraryFlagsEXT flags,
+                                               VkGraphicsPipelineCreateInfo *create_info, const char *partName) {
+  VkResult res = VK_RESULT_MAX_ENUM;
+  VkPipeline pipeline = VK_NULL_HANDLE;
+
+  VkGraphicsPipelineLibraryCreateInfoEXT library_info = {};
+  library_info.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_LIBRARY_CREATE_INFO_EXT;
+  library_info.pNext = create_info->pNext;
+  library_info.flags = flags;
+
+  create_info->sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+  create_info->pNext = &library_info;
+  create_info->flags = VK_PIPELINE_CREATE_LIBRARY_BIT_KHR | VK_PIPELINE_CREATE_RETAIN_LINK_TIME_OPTIMIZATION_INFO_BIT_EXT;
+  create_info->basePipelineHandle = VK_NULL_HANDLE;
+  create_info->basePipelineIndex = -1;
+
+  res = vkCreateGraphicsPipelines(vkDevice, vkPipelineCache, 1, create_info, hostCallbacks, &pipeline);
+  if (res) {
+    uvr_utils_log(UVR_DANGER, "[x] vkCreateGraphicsPipelines: %s library %s", partName, vkres_msg(res));
+    return VK_NULL_HANDLE;
+  }
+
+  return pipeline;
+}
+
+
+/* Creates the vertex input, pre-rasterization and fragment shader parts shared by every variant */
+static int pipeline_library_parts_create(VkDevice vkDevice, const struct uvr_vk_graphics_pipeline_create_info *desc, VkPipeline *parts) {
+  VkPipelineShaderStageCreateInfo preRasterStages[8], fragmentStages[1];
+  VkGraphicsPipelineCreateInfo create_info;
+  uint32_t s, preRasterCount = 0, fragmentCount = 0;
+
+  for (s = 0; s < desc->stageCount; s++) {
+    if (desc->pStages[s].stage == VK_SHADER_STAGE_FRAGMENT_BIT && fragmentCount < ARRAY_LEN(fragmentStages)) {
+      fragmentStages[fragmentCount++] = desc->pStages[s];
+    } else if (desc->pStages[s].stage != VK_SHADER_STAGE_FRAGMENT_BIT && preRasterCount < ARRAY_LEN(preRasterStages)) {
+      preRasterStages[preRasterCount++] = desc->pStages[s];
+    } else {
+      uvr_utils_log(UVR_WARNING, "uvr_vk_pipeline_library_create: unsupported shader stage layout");
+      return -1;
+    }
+  }
+
+  memset(&create_info, 0, sizeof(create_info));
+  create_info.pVertexInputState = desc->pVertexInputState;
+  create_info.pInputAssemblyState = desc->pInputAssemblyState;
+  create_info.pDynamicState = desc->pDynamicState;
+  parts[0] = pipeline_library_part_create(vkDevice, desc->vkPipelineCache, VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT,
+                                          &create_info, "vertex input");
+  if (!parts[0])
+    goto exit_pipeline_library_parts;
+
+  memset(&create_info, 0, sizeof(create_info));
+  create_info.pNext = desc->pRenderingInfo;
+  create_info.stageCount = preRasterCount;
+  create_info.pStages = preRasterStages;
+  create_info.pTessellationState = desc->pTessellationState;
+  create_info.pViewportState = desc->pViewportState;
+  create_info.pRasterizationState = desc->pRasterizationState;
+  create_info.pDynamicState = desc->pDynamicState;
+  create_info.layout = desc->vkPipelineLayout;
+  create_info.renderPass = desc->renderPass;
+  create_info.subpass = desc->subpass;
+  parts[1] = pipeline_library_part_create(vkDevice, desc->vkPipelineCache, VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT,
+                                          &create_info, "pre-rasterization");
+  if (!parts[1])
+    goto exit_pipeline_library_parts_destroy_vertex_input;
+
+  memset(&create_info, 0, sizeof(create_info));
+  create_info.pNext = desc->pRenderingInfo;
+  create_info.stageCount = fragmentCount;
+  create_info.pStages = fragmentStages;
+  create_info.pMultisampleState = desc->pMultisampleState;
+  create_info.pDepthStencilState = desc->pDepthStencilState;
+  create_info.pDynamicState = desc->pDynamicState;
+  create_info.layout = desc->vkPipelineLayout;
+  create_info.renderPass = desc->renderPass;
+  create_info.subpass = desc->subpass;
+  parts[2] = pipeline_library_part_create(vkDevice, desc->vkPipelineCache, VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT,
+                                          &create_info, "fragment shader");
+  if (!parts[2])
+    goto exit_pipeline_library_parts_destroy_pre_rasterization;
+
+  return 0;
+
+exit_pipeline_library_parts_destroy_pre_rasterization:
+  vkDestroyPipeline(vkDevice, parts[1], hostCallbacks);
+  parts[1] = VK_NULL_HANDLE;
+exit_pipeline_library_parts_destroy_vertex_input:
+  vkDestroyPipeline(vkDevice, parts[0], hostCallbacks);
+  parts[0] = VK_NULL_HANDLE;
+exit_pipeline_library_parts:
+  return -1;
+}
+
+
+struct uvr_vk_pipeline_library uvr_vk_pipeline_library_create(struct uvr_vk_pipeline_library_create_info *uvrvk) {
+  struct uvr_vk_graphics_pipeline_create_info *desc = &uvrvk->desc;
+  struct uvr_utils_thread_pool *threadPool = NULL;
+  VkPipeline parts[3] = { VK_NULL_HANDLE, VK_NULL_HANDLE, VK_NULL_HANDLE };
+  VkBool32 libraryEnabled = VK_FALSE;
+  struct timespec start, end;
+
+  if (desc->pRenderingInfo && desc->renderPass) {
+    uvr_utils_log(UVR_DANGER, "[x] uvr_vk_pipeline_library_create: pRenderingInfo requires renderPass to be VK_NULL_HANDLE");
+    goto exit_vk_pipeline_library;
+  }
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+
+  if (uvrvk->graphicsPipelineLibraryEnabled && uvr_vk_pipeline_library_supported(uvrvk->vkPhdev))
+    libraryEnabled = (pipeline_library_parts_create(desc->vkDevice, desc, parts) == 0) ? VK_TRUE : VK_FALSE;
+
+  clock_gettime(CLOCK_MONOTONIC, &end);
+
+  if (!libraryEnabled) {
+    uvr_utils_log(UVR_WARNING, "uvr_vk_pipeline_library_create: VK_EXT_graphics_pipeline_library unavailable, variants compile monolithic pipelines");
+    goto exit_vk_pipeline_library_success;
+  }
+
+  /* A single worker keeps optimized links from competing with the render thread for CPU time */
+  threadPool = calloc(1, sizeof(struct uvr_utils_thread_pool));
+  if (!threadPool) {
+    uvr_utils_log(UVR_WARNING, "[x] calloc: %s, variants won't be optimized", strerror(errno));
+  } else if (uvr_utils_thread_pool_create(threadPool, 1) == -1) {
+    uvr_utils_log(UVR_WARNING, "uvr_vk_pipeline_library_create: failed to spawn worker, variants won't be optimized");
+    free(threadPool);
+    threadPool = NULL;
+  }
+
+  uvr_utils_log(UVR_SUCCESS, "uvr_vk_pipeline_library_create: library parts successfully created in %.3f ms", elapsed_ms(&start, &end));
+
+exit_vk_pipeline_library_success:
+  return (struct uvr_vk_pipeline_library) { .vkDevice = desc->vkDevice, .libraryEnabled = libraryEnabled, .desc = *desc,
+                                            .vertexInput = parts[0], .preRasterization = parts[1], .fragmentShader = parts[2],
+                                            .threadPool = threadPool, .variantCount = 0, .variants = NULL };
+
+exit_vk_pipeline_library:
+  return (struct uvr_vk_pipeline_library) { .vkDevice = VK_NULL_HANDLE, .libraryEnabled = VK_FALSE, .desc = {},
+                                            .vertexInput = VK_NULL_HANDLE, .preRasterization = VK_NULL_HANDLE,
+                                            .fragmentShader = VK_NULL_HANDLE, .threadPool = NULL, .variantCount = 0,
+                                            .variants = NULL };
+}
+
+
+/* Links every part of @variant. Without VK_PIPELINE_CREATE_LINK_TIME_OPTIMIZATION_BIT_EXT this is the fast path. */
+static VkResult pipeline_library_variant_link(struct uvr_vk_pipeline_library_variant *variant, VkPipelineCreateFlags flags, VkPipeline *pipeline) {
+  VkPipelineLibraryCreateInfoKHR library_info = {};
+  library_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LIBRARY_CREATE_INFO_KHR;
+  library_info.pNext = NULL;
+  library_info.libraryCount = ARRAY_LEN(variant->libraries);
+  library_info.pLibraries = variant->libraries;
+
+  VkGraphicsPipelineCreateInfo create_info = {};
+  create_info.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+  create_info.pNext = &library_info;
+  create_info.flags = flags;
+  create_info.layout = variant->vkPipelineLayout;
+  create_info.basePipelineHandle = VK_NULL_HANDLE;
+  create_info.basePipelineIndex = -1;
+
+  return vkCreateGraphicsPipelines(variant->vkDevice, variant->vkPipelineCache, 1, &create_info, hostCallbacks, pipeline);
+}
+
+
+/* Background job, publishes the optimized pipeline for uvr_vk_pipeline_library_variant_get(3) to swap in */
+static void pipeline_library_optimize_job(void *data) {
+  struct uvr_vk_pipeline_library_variant *variant = data;
+  VkPipeline pipeline = VK_NULL_HANDLE;
+  struct timespec start, end;
+  VkResult res;
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  res = pipeline_library_variant_link(variant, VK_PIPELINE_CREATE_LINK_TIME_OPTIMIZATION_BIT_EXT, &pipeline);
+  clock_gettime(CLOCK_MONOTONIC, &end);
+
+  variant->optimizeNs = timespec_diff_ns(&start, &end);
+
+  if (res) {
+    uvr_utils_log(UVR_WARNING, "[x] vkCreateGraphicsPipelines: optimized link %s, keeping fast-linked pipeline", vkres_msg(res));
+    __atomic_store_n(&variant->optimizeState, PIPELINE_LIBRARY_OPTIMIZE_FAILED, __ATOMIC_RELEASE);
+    return;
+  }
+
+  __atomic_store_n(&variant->optimizedPipeline, pipeline, __ATOMIC_RELEASE);
+  __atomic_store_n(&variant->optimizeState, PIPELINE_LIBRARY_OPTIMIZE_READY, __ATOMIC_RELEASE);
+}
+
+
+/*
+ * The fragment shader part is compiled against @shared's multisample state and every part against its view mask and
+ * depth/stencil formats. A fragment output interface built from anything else can't legally link with them.
+ */
+static int pipeline_library_variant_compatible(const struct uvr_vk_graphics_pipeline_create_info *shared,
+                                               const struct uvr_vk_graphics_pipeline_create_info *variant) {
+  const VkPipelineMultisampleStateCreateInfo *sms = shared->pMultisampleState, *vms = variant->pMultisampleState;
+  const VkPipelineRenderingCreateInfo *sri = shared->pRenderingInfo, *vri = variant->pRenderingInfo;
+  VkPipelineRenderingCreateInfo none = {};
+
+  if (sms != vms && (!sms || !vms)) {
+    uvr_utils_log(UVR_DANGER, "[x] uvr_vk_pipeline_library_link: variant must keep multisample state %s as the shared parts",
+                              (sms) ? "set" : "unset");
+    return -1;
+  }
+
+  if (sms && vms && (sms->rasterizationSamples != vms->rasterizationSamples ||
+                     sms->sampleShadingEnable != vms->sampleShadingEnable ||
+                     sms->minSampleShading != vms->minSampleShading ||
+                     sms->alphaToCoverageEnable != vms->alphaToCoverageEnable ||
+                     sms->alphaToOneEnable != vms->alphaToOneEnable))
+  {
+    uvr_utils_log(UVR_DANGER, "[x] uvr_vk_pipeline_library_link: variant sample count %u incompatible with shared parts sample count %u",
+                              vms->rasterizationSamples, sms->rasterizationSamples);
+    return -1;
+  }
+
+  /* Parts created without VkPipelineRenderingCreateInfo behave as if every member were zero */
+  sri = (sri) ? sri : &none;
+  vri = (vri) ? vri : &none;
+
+  if (sri->viewMask != vri->viewMask || sri->colorAttachmentCount != vri->colorAttachmentCount ||
+      sri->depthAttachmentFormat != vri->depthAttachmentFormat || sri->stencilAttachmentFormat != vri->stencilAttachmentFormat)
+  {
+    uvr_utils_log(UVR_DANGER, "[x] uvr_vk_pipeline_library_link: variant pRenderingInfo incompatible with shared parts, "
+                              "only color attachment formats may differ");
+    return -1;
+  }
+
+  return 0;
+}
+
+
+struct uvr_vk_pipeline_library_variant *uvr_vk_pipeline_library_link(struct uvr_vk_pipeline_library *library,
+                                                                     struct uvr_vk_pipeline_library_link_info *uvrvk) {
+  struct uvr_vk_graphics_pipeline_create_info desc = library->desc;
+  struct uvr_vk_pipeline_library_variant *variant = NULL;
+  VkGraphicsPipelineCreateInfo create_info;
+  struct timespec start, end;
+  VkResult res = VK_RESULT_MAX_ENUM;
+
+  if (uvrvk->pColorBlendState)
+    desc.pColorBlendState = uvrvk->pColorBlendState;
+  if (uvrvk->pMultisampleState)
+    desc.pMultisampleState = uvrvk->pMultisampleState;
+  if (uvrvk->pRenderingInfo)
+    desc.pRenderingInfo = uvrvk->pRenderingInfo;
+
+  if (desc.pRenderingInfo && desc.renderPass) {
+    uvr_utils_log(UVR_DANGER, "[x] uvr_vk_pipeline_library_link: pRenderingInfo requires renderPass to be VK_NULL_HANDLE");
+    goto exit_vk_pipeline_library_link;
+  }
+
+  if (library->libraryEnabled && pipeline_library_variant_compatible(&library->desc, &desc) == -1)
+    goto exit_vk_pipeline_library_link;
+
+  variant = calloc(1, sizeof(struct uvr_vk_pipeline_library_variant));
+  if (!variant) {
+    uvr_utils_log(UVR_DANGER, "[x] calloc: %s", strerror(errno));
+    goto exit_vk_pipeline_library_link;
+  }
+
+  variant->vkDevice = library->vkDevice;
+  variant->vkPipelineLayout = desc.vkPipelineLayout;
+  variant->vkPipelineCache = desc.vkPipelineCache;
+  variant->optimizeState = PIPELINE_LIBRARY_OPTIMIZE_NONE;
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+
+  if (!library->libraryEnabled) {
+    graphics_pipeline_create_info(&desc, &create_info);
+    res = vkCreateGraphicsPipelines(variant->vkDevice, variant->vkPipelineCache, 1, &create_info, hostCallbacks, &variant->fastPipeline);
+    if (res) {
+      uvr_utils_log(UVR_DANGER, "[x] vkCreateGraphicsPipelines: %s", vkres_msg(res));
+      goto exit_vk_pipeline_library_link_free_variant;
+    }
+
+    goto exit_vk_pipeline_library_link_success;
+  }
+
+  memset(&create_info, 0, sizeof(create_info));
+  create_info.pNext = desc.pRenderingInfo;
+  create_info.pMultisampleState = desc.pMultisampleState;
+  create_info.pColorBlendState = desc.pColorBlendState;
+  create_info.pDynamicState = desc.pDynamicState;
+  create_info.layout = desc.vkPipelineLayout;
+  create_info.renderPass = desc.renderPass;
+  create_info.subpass = desc.subpass;
+
+  variant->libraries[0] = library->vertexInput;
+  variant->libraries[1] = library->preRasterization;
+  variant->libraries[2] = library->fragmentShader;
+  variant->libraries[3] = pipeline_library_part_create(variant->vkDevice, variant->vkPipelineCache,
+                                                       VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT,
+                                                       &create_info, "fragment output");
+  if (!variant->libraries[3])
+    goto exit_vk_pipeline_library_link_free_variant;
+
+  res = pipeline_library_variant_link(variant, 0, &variant->fastPipeline);
+  if (res) {
+    uvr_utils_log(UVR_DANGER, "[x] vkCreateGraphicsPipelines: fast link %s", vkres_msg(res));
+    goto exit_vk_pipeline_library_link_destroy_output;
+  }
+
+exit_vk_pipeline_library_link_success:
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  variant->linkNs = timespec_diff_ns(&start, &end);
+
+  variant->next = library->variants;
+  library->variants = variant;
+  library->variantCount++;
+
+  if (library->libraryEnabled && uvrvk->optimize && library->threadPool) {
+    variant->optimizeState = PIPELINE_LIBRARY_OPTIMIZE_PENDING;
+    if (uvr_utils_thread_pool_submit(library->threadPool, pipeline_library_optimize_job, variant) == -1) {
+      uvr_utils_log(UVR_WARNING, "uvr_vk_pipeline_library_link: failed to queue optimized link, keeping fast-linked pipeline");
+      variant->optimizeState = PIPELINE_LIBRARY_OPTIMIZE_FAILED;
+    }
+  }
+
+  uvr_utils_log(UVR_SUCCESS, "uvr_vk_pipeline_library_link: %s VkPipeline successfully created retval(%p) in %.3f ms",
+                             (library->libraryEnabled) ? "Fast-linked" : "Monolithic", variant->fastPipeline, elapsed_ms(&start, &end));
+
+  return variant;
+
+exit_vk_pipeline_library_link_destroy_output:
+  vkDestroyPipeline(variant->vkDevice, variant->libraries[3], hostCallbacks);
+exit_vk_pipeline_library_link_free_variant:
+  free(variant);
+exit_vk_pipeline_library_link:
+  return NULL;
+}
+
+
+VkPipeline uvr_vk_pipeline_library_variant_get(struct uvr_vk_pipeline_library_variant *variant) {
+  VkPipeline optimized = __atomic_load_n(&variant->optimizedPipeline, __ATOMIC_ACQUIRE);
+  return (optimized) ? optimized : variant->fastPipeline;
+}
+
+
+struct uvr_vk_pipeline_library_stats uvr_vk_pipeline_library_get_stats(struct uvr_vk_pipeline_library *library) {
+  struct uvr_vk_pipeline_library_stats stats;
+  struct uvr_vk_pipeline_library_variant *variant;
+  uint64_t linkNs = 0, optimizeNs = 0;
+  uint32_t state;
+
+  memset(&stats, 0, sizeof(stats));
+
+  for (variant = library->variants; variant; variant = variant->next) {
+    stats.variantCount++;
+    linkNs += variant->linkNs;
+
+    state = __atomic_load_n(&variant->optimizeState, __ATOMIC_ACQUIRE);
+    if (state == PIPELINE_LIBRARY_OPTIMIZE_READY) {
+      stats.optimizedCount++;
+      optimizeNs += variant->optimizeNs;
+    } else if (state == PIPELINE_LIBRARY_OPTIMIZE_PENDING) {
+      stats.pendingCount++;
+    }
+  }
+
+  stats.linkMs = (stats.variantCount) ? (double) linkNs / stats.variantCount / 1000000.0 : 0.0;
+  stats.optimizeMs = (stats.optimizedCount) ? (double) optimizeNs / stats.optimizedCount / 1000000.0 : 0.0;
+
+  return stats;
+}
+
+
+/*
+ * Canonical description of a cached object. State is appended field by field in
+ * a fixed order, pointers are replaced by a presence tag followed by what they
+ * point to, so equal descriptions serialize to equal bytes wherever they live.
+ */
+struct object_cache_key {
+  uint8_t *data;
+  size_t  size;
+  size_t  cap;
+  bool    failed;
+};
+
+
+static void object_cache_key_put(struct object_cache_key *key, const void *data, size_t size) {
+  uint8_t *newData = NULL;
+  size_t newCap;
+
+  if (key->failed || !size)
+    return;
+
+  if (key->size + size > key->cap) {
+    newCap = (key->cap) ? key->cap * 2 : 256;
+    while (newCap < key->size + size)
+      newCap *= 2;
+
+    newData = realloc(key->data, newCap);
+    if (!newData) {
+      uvr_utils_log(UVR_DANGER, "[x] realloc: %s", strerror(errno));
+      key->failed = true;
+      return;
+    }
+
+    key->data = newData;
+    key->cap = newCap;
+  }
+
+  memcpy(key->data + key->size, data, size);
+  key->size += size;
+}
+
+
+#define OBJECT_CACHE_KEY_PUT(key, value) object_cache_key_put(key, &(value), sizeof(value))
+
+
+/* Appends whether @ptr is set, then @count elements of @size bytes it points to */
+static void object_cache_key_put_array(struct object_cache_key *key, uint32_t count, const void *ptr, size_t size) {
+  uint8_t present = (ptr) ? 1 : 0;
+
+  OBJECT_CACHE_KEY_PUT(key, count);
+  OBJECT_CACHE_KEY_PUT(key, present);
+  if (ptr)
+    object_cache_key_put(key, ptr, count * size);
+}
+
+
+static void graphics_pipeline_key(struct object_cache_key *key, const struct uvr_vk_graphics_pipeline_create_info *uvrvk) {
+  const VkSpecializationInfo *spec;
+  uint32_t s, sampleMaskCount;
+  uint8_t present;
+
+  OBJECT_CACHE_KEY_PUT(key, uvrvk->stageCount);
+  for (s = 0; s < uvrvk->stageCount; s++) {
+    OBJECT_CACHE_KEY_PUT(key, uvrvk->pStages[s].flags);
+    OBJECT_CACHE_KEY_PUT(key, uvrvk->pStages[s].stage);
+    OBJECT_CACHE_KEY_PUT(key, uvrvk->pStages[s].module);
+    object_cache_key_put(key, uvrvk->pStages[s].pName, strlen(uvrvk->pStages[s].pName) + 1);
+
+    spec = uvrvk->pStages[s].pSpecializationInfo;
+    present = (spec) ? 1 : 0;
+    OBJECT_CACHE_KEY_PUT(key, present);
+    if (spec) {
+      object_cache_key_put_array(key, spec->mapEntryCount, spec->pMapEntries, sizeof(VkSpecializationMapEntry));
+      OBJECT_CACHE_KEY_PUT(key, spec->dataSize);
+      object_cache_key_put(key, spec->pData, spec->dataSize);
+    }
+  }
+
+  present = (uvrvk->pVertexInputState) ? 1 : 0;
+  OBJECT_CACHE_KEY_PUT(key, present);
+  if (uvrvk->pVertexInputState) {
+    const VkPipelineVertexInputStateCreateInfo *state = uvrvk->pVertexInputState;
+    OBJECT_CACHE_KEY_PUT(key, state->flags);
+    object_cache_key_put_array(key, state->vertexBindingDescriptionCount, state->pVertexBindingDescriptions,
+                               sizeof(VkVertexInputBindingDescription));
+    object_cache_key_put_array(key, state->vertexAttributeDescriptionCount, state->pVertexAttributeDescriptions,
+                               sizeof(VkVertexInputAttributeDescription));
+  }
+
+  present = (uvrvk->pInputAssemblyState) ? 1 : 0;
+  OBJECT_CACHE_KEY_PUT(key, present);
+  if (uvrvk->pInputAssemblyState) {
+    OBJECT_CACHE_KEY_PUT(key, uvrvk->pInputAssemblyState->flags);
+    OBJECT_CACHE_KEY_PUT(key, uvrvk->pInputAssemblyState->topology);
+    OBJECT_CACHE_KEY_PUT(key, uvrvk->pInputAssemblyState->primitiveRestartEnable);
+  }
+
+  present = (uvrvk->pTessellationState) ? 1 : 0;
+  OBJECT_CACHE_KEY_PUT(key, present);
+  if (uvrvk->pTessellationState) {
+    OBJECT_CACHE_KEY_PUT(key, uvrvk->pTessellationState->flags);
+    OBJECT_CACHE_KEY_PUT(key, uvrvk->pTessellationState->patchControlPoints);
+  }
+
+  present = (uvrvk->pViewportState) ? 1 : 0;
+  OBJECT_CACHE_KEY_PUT(key, present);
+  if (uvrvk->pViewportState) {
+    OBJECT_CACHE_KEY_PUT(key, uvrvk->pViewportState->flags);
+    object_cache_key_put_array(key, uvrvk->pViewportState->viewportCount, uvrvk->pViewportState->pViewports, sizeof(VkViewport));
+    object_cache_key_put_array(key, uvrvk->pViewportState->scissorCount, uvrvk->pViewportState->pScissors, sizeof(VkRect2D));
+  }
+
+  present = (uvrvk->pRasterizationState) ? 1 : 0;
+  OBJECT_CACHE_KEY_PUT(key, present);
+  if (uvrvk->pRasterizationState) {
+    const VkPipelineRasterizationStateCreateInfo *state = uvrvk->pRasterizationState;
+    OBJECT_CACHE_KEY_PUT(key, state->flags);
+    OBJECT_CACHE_KEY_PUT(key, state->depthClampEnable);
+    OBJECT_CACHE_KEY_PUT(key, state->rasterizerDiscardEnable);
+    OBJECT_CACHE_KEY_PUT(key, state->polygonMode);
+    OBJECT_CACHE_KEY_PUT(key, state->cullMode);
+    OBJECT_CACHE_KEY_PUT(key, state->frontFace);
+    OBJECT_CACHE_KEY_PUT(key, state->depthBiasEnable);
+    OBJECT_CACHE_KEY_PUT(key, state->depthBiasConstantFactor);
+    OBJECT_CACHE_KEY_PUT(key, state->depthBiasClamp);
+    OBJECT_CACHE_KEY_PUT(key, state->depthBiasSlopeFactor);
+    OBJECT_CACHE_KEY_PUT(key, state->lineWidth);
+  }
+
+  present = (uvrvk->pMultisampleState) ? 1 : 0;
+  OBJECT_CACHE_KEY_PUT(key, present);
+  if (uvrvk->pMultisampleState) {
+    const VkPipelineMultisampleStateCreateInfo *state = uvrvk->pMultisampleState;
+    sampleMaskCount = ((uint32_t) state->rasterizationSamples + 31) / 32;
+    OBJECT_CACHE_KEY_PUT(key, state->flags);
+    OBJECT_CACHE_KEY_PUT(key, state->rasterizationSamples);
+    OBJECT_CACHE_KEY_PUT(key, state->sampleShadingEnable);
+    OBJECT_CACHE_KEY_PUT(key, state->minSampleShading);
+    object_cache_key_put_array(key, sampleMaskCount, state->pSampleMask, sizeof(VkSampleMask));
+    OBJECT_CACHE_KEY_PUT(key, state->alphaToCoverageEnable);
+    OBJECT_CACHE_KEY_PUT(key, state->alphaToOneEnable);
+  }
+
+  present = (uvrvk->pDepthStencilState) ? 1 : 0;
+  OBJECT_CACHE_KEY_PUT(key, present);
+  if (uvrvk->pDepthStencilState) {
+    const VkPipelineDepthStencilStateCreateInfo *state = uvrvk->pDepthStencilState;
+    OBJECT_CACHE_KEY_PUT(key, state->flags);
+    OBJECT_CACHE_KEY_PUT(key, state->depthTestEnable);
+    OBJECT_CACHE_KEY_PUT(key, state->depthWriteEnable);
+    OBJECT_CACHE_KEY_PUT(key, state->depthCompareOp);
+    OBJECT_CACHE_KEY_PUT(key, state->depthBoundsTestEnable);
+    OBJECT_CACHE_KEY_PUT(key, state->stencilTestEnable);
+    OBJECT_CACHE_KEY_PUT(key, state->front);
+    OBJECT_CACHE_KEY_PUT(key, state->back);
+    OBJECT_CACHE_KEY_PUT(key, state->minDepthBounds);
+    OBJECT_CACHE_KEY_PUT(key, state->maxDepthBounds);
+  }
+
+  present = (uvrvk->pColorBlendState) ? 1 : 0;
+  OBJECT_CACHE_KEY_PUT(key, present);
+  if (uvrvk->pColorBlendState) {
+    const VkPipelineColorBlendStateCreateInfo *state = uvrvk->pColorBlendState;
+    OBJECT_CACHE_KEY_PUT(key, state->flags);
+    OBJECT_CACHE_KEY_PUT(key, state->logicOpEnable);
+    OBJECT_CACHE_KEY_PUT(key, state->logicOp);
+    object_cache_key_put_array(key, state->attachmentCount, state->pAttachments, sizeof(VkPipelineColorBlendAttachmentState));
+    OBJECT_CACHE_KEY_PUT(key, state->blendConstants);
+  }
+
+  present = (uvrvk->pDynamicState) ? 1 : 0;
+  OBJECT_CACHE_KEY_PUT(key, present);
+  if (uvrvk->pDynamicState) {
+    OBJECT_CACHE_KEY_PUT(key, uvrvk->pDynamicState->flags);
+    object_cache_key_put_array(key, uvrvk->pDynamicState->dynamicStateCount, uvrvk->pDynamicState->pDynamicStates, sizeof(VkDynamicState));
+  }
+
+  OBJECT_CACHE_KEY_PUT(key, uvrvk->vkPipelineLayout);
+  OBJECT_CACHE_KEY_PUT(key, uvrvk->renderPass);
+  OBJECT_CACHE_KEY_PUT(key, uvrvk->subpass);
+
+  /* Attachment formats decide compatibility with dynamic rendering instances */
+  present = (uvrvk->pRenderingInfo) ? 1 : 0;
+  OBJECT_CACHE_KEY_PUT(key, present);
+  if (uvrvk->pRenderingInfo) {
+    OBJECT_CACHE_KEY_PUT(key, uvrvk->pRenderingInfo->viewMask);
+    object_cache_key_put_array(key, uvrvk->pRenderingInfo->colorAttachmentCount, uvrvk->pRenderingInfo->pColorAttachmentFormats, sizeof(VkFormat));
+    OBJECT_CACHE_KEY_PUT(key, uvrvk->pRenderingInfo->depthAttachmentFormat);
+    OBJECT_CACHE_KEY_PUT(key, uvrvk->pRenderingInfo->stencilAttachmentFormat);
+  }
+}
+
+
+static void render_pass_key(struct object_cache_key *key, const struct uvr_vk_render_pass_create_info *uvrvk) {
+  const VkSubpassDescription *subpass;
+  uint32_t s;
+
+  object_cache_key_put_array(key, uvrvk->attachmentCount, uvrvk->pAttachments, sizeof(VkAttachmentDescription));
+
+  OBJECT_CACHE_KEY_PUT(key, uvrvk->subpassCount);
+  for (s = 0; s < uvrvk->subpassCount; s++) {
+    subpass = &uvrvk->pSubpasses[s];
+    OBJECT_CACHE_KEY_PUT(key, subpass->flags);
+    OBJECT_CACHE_KEY_PUT(key, subpass->pipelineBindPoint);
+    object_cache_key_put_array(key, subpass->inputAttachmentCount, subpass->pInputAttachments, sizeof(VkAttachmentReference));
+    object_cache_key_put_array(key, subpass->colorAttachmentCount, subpass->pColorAttachments, sizeof(VkAttachmentReference));
+    object_cache_key_put_array(key, (subpass->pResolveAttachments) ? subpass->colorAttachmentCount : 0,
+                               subpass->pResolveAttachments, sizeof(VkAttachmentReference));
+    object_cache_key_put_array(key, (subpass->pDepthStencilAttachment) ? 1 : 0, subpass->pDepthStencilAttachment, sizeof(VkAttachmentReference));
+    object_cache_key_put_array(key, subpass->preserveAttachmentCount, subpass->pPreserveAttachments, sizeof(uint32_t));
+  }
+
+  object_cache_key_put_array(key, uvrvk->dependencyCount, uvrvk->pDependencies, sizeof(VkSubpassDependency));
+}
+
+
+static void sampler_key(struct object_cache_key *key, const VkSamplerCreateInfo *info) {
+  OBJECT_CACHE_KEY_PUT(key, info->flags);
+  OBJECT_CACHE_KEY_PUT(key, info->magFilter);
+  OBJECT_CACHE_KEY_PUT(key, info->minFilter);
+  OBJECT_CACHE_KEY_PUT(key, info->mipmapMode);
+  OBJECT_CACHE_KEY_PUT(key, info->addressModeU);
+  OBJECT_CACHE_KEY_PUT(key, info->addressModeV);
+  OBJECT_CACHE_KEY_PUT(key, info->addressModeW);
+  OBJECT_CACHE_KEY_PUT(key, info->mipLodBias);
+  OBJECT_CACHE_KEY_PUT(key, info->anisotropyEnable);
+  OBJECT_CACHE_KEY_PUT(key, info->maxAnisotropy);
+  OBJECT_CACHE_KEY_PUT(key, info->compareEnable);
+  OBJECT_CACHE_KEY_PUT(key, info->compareOp);
+  OBJECT_CACHE_KEY_PUT(key, info->minLod);
+  OBJECT_CACHE_KEY_PUT(key, info->maxLod);
+  OBJECT_CACHE_KEY_PUT(key, info->borderColor);
+  OBJECT_CACHE_KEY_PUT(key, info->unnormalizedCoordinates);
+}
+
+
+uint64_t uvr_vk_graphics_pipeline_hash(const struct uvr_vk_graphics_pipeline_create_info *uvrvk) {
+  struct object_cache_key key;
+  uint64_t hash = 0;
+
+  memset(&key, 0, sizeof(key));
+  graphics_pipeline_key(&key, uvrvk);
+  if (!key.failed)
+    hash = fnv1a64(key.data, key.size);
+
+  free(key.data);
+  return hash;
+}
+
+
+union object_cache_handle {
+  VkPipeline   pipeline;
+  VkRenderPass renderPass;
+  VkSampler    sampler;
+};
+
+
+struct object_cache_entry {
+  uint64_t                  hash;
+  uint8_t                   *key;
+  size_t                    keySize;
+  union object_cache_handle handle;
+  uint32_t                  next;
+};
+
+
+/*
+ * Chained hash table. @buckets hold entry index + 1 of a chain's head, zero
+ * marks an empty bucket. Buckets are rebuilt whenever @entries grows.
+ */
+struct object_cache_table {
+  uint32_t                  entryCount;
+  uint32_t                  entryCap;
+  struct object_cache_entry *entries;
+  uint32_t                  *buckets;
+  uint64_t                  hits;
+  uint64_t                  misses;
+};
+
+
+struct uvr_vk_object_cache_tables {
+  pthread_mutex_t           lock;
+  struct object_cache_table pipelines;
+  struct object_cache_table renderPasses;
+  struct object_cache_table samplers;
+};
+
+
+/* Creates the object described by @info, -1 on failure */
+typedef int (*object_cache_create_func)(VkDevice vkDevice, void *info, union object_cache_handle *handle);
+typedef void (*object_cache_destroy_func)(VkDevice vkDevice, union object_cache_handle *handle);
+
+
+static struct object_cache_entry *object_cache_find(struct object_cache_table *table, uint64_t hash, struct object_cache_key *key) {
+  struct object_cache_entry *entry;
+  uint32_t e;
+
+  if (!table->entryCap)
+    return NULL;
+
+  for (e = table->buckets[hash & (table->entryCap - 1)]; e; e = entry->next) {
+    entry = &table->entries[e - 1];
+    if (entry->hash == hash && entry->keySize == key->size && !memcmp(entry->key, key->data, key->size))
+      return entry;
+  }
+
+  return NULL;
+}
+
+
+/* Takes ownership of @key's data on success */
+static int object_cache_insert(struct object_cache_table *table, uint64_t hash, struct object_cache_key *key, union object_cache_handle handle) {
+  struct object_cache_entry *newEntries = NULL, *entry = NULL;
+  uint32_t *newBuckets = NULL, newCap, e, bucket;
+
+  if (table->entryCount == table->entryCap) {
+    newCap = (table->entryCap) ? table->entryCap * 2 : 64;
+
+    newEntries = realloc(table->entries, newCap * sizeof(struct object_cache_entry));
+    if (!newEntries) {
+      uvr_utils_log(UVR_DANGER, "[x] realloc: %s", strerror(errno));
+      return -1;
+    }
+
+    table->entries = newEntries;
+
+    newBuckets = calloc(newCap, sizeof(uint32_t));
+    if (!newBuckets) {
+      uvr_utils_log(UVR_DANGER, "[x] calloc: %s", strerror(errno));
+      return -1;
+    }
+
+    /* Capacity stays a power of two, rehash existing chains into the larger bucket array */
+    for (e = 0; e < table->entryCount; e++) {
+      bucket = table->entries[e].hash & (newCap - 1);
+      table->entries[e].next = newBuckets[bucket];
+      newBuckets[bucket] = e + 1;
+    }
+
+    free(table->buckets);
+    table->buckets = newBuckets;
+    table->entryCap = newCap;
+  }
+
+  bucket = hash & (table->entryCap - 1);
+  entry = &table->entries[table->entryCount];
+  entry->hash = hash;
+  entry->key = key->data;
+  entry->keySize = key->size;
+  entry->handle = handle;
+  entry->next = table->buckets[bucket];
+  table->buckets[bucket] = ++table->entryCount;
+
+  key->data = NULL;
+  return 0;
+}
+
+
+/*
+ * Lookups take the lock only around table access. On miss the object is created
+ * unlocked. If another thread inserted the same description meanwhile its handle
+ * wins and ours is destroyed.
+ */
+static union object_cache_handle object_cache_get(struct uvr_vk_object_cache *cache, struct object_cache_table *table,
+                                                  struct object_cache_key *key, object_cache_create_func create,
+                                                  object_cache_destroy_func destroy, void *info) {
+  struct uvr_vk_object_cache_tables *tables = cache->tables;
+  union object_cache_handle handle, created;
+  struct object_cache_entry *entry = NULL;
+  uint64_t hash;
+
+  memset(&handle, 0, sizeof(handle));
+  memset(&created, 0, sizeof(created));
+
+  if (key->failed)
+    goto exit_object_cache_get_free_key;
+
+  hash = fnv1a64(key->data, key->size);
+
+  pthread_mutex_lock(&tables->lock);
+  entry = object_cache_find(table, hash, key);
+  if (entry) {
+    table->hits++;
+    handle = entry->handle;
+  }
+  pthread_mutex_unlock(&tables->lock);
+
+  if (entry)
+    goto exit_object_cache_get_free_key;
+
+  if (create(cache->vkDevice, info, &created) == -1)
+    goto exit_object_cache_get_free_key;
+
+  pthread_mutex_lock(&tables->lock);
+  table->misses++;
+  entry = object_cache_find(table, hash, key);
+  if (entry) {
+    handle = entry->handle;
+  } else if (object_cache_insert(table, hash, key, created) == 0) {
+    handle = created;
+  }
+  pthread_mutex_unlock(&tables->lock);
+
+  if (memcmp(&handle, &created, sizeof(handle)))
+    destroy(cache->vkDevice, &created);
+
+exit_object_cache_get_free_key:
+  free(key->data);
+  return handle;
+}
+
+
+static int object_cache_pipeline_create(VkDevice UNUSED vkDevice, void *info, union object_cache_handle *handle) {
+  struct uvr_vk_graphics_pipeline pipeline = uvr_vk_graphics_pipeline_create(info);
+  handle->pipeline = pipeline.graphicsPipeline;
+  return (pipeline.graphicsPipeline) ? 0 : -1;
+}
+
+
+static void object_cache_pipeline_destroy(VkDevice vkDevice, union object_cache_handle *handle) {
+  vkDestroyPipeline(vkDevice, handle->pipeline, hostCallbacks);
+}
+
+
+static int object_cache_render_pass_create(VkDevice UNUSED vkDevice, void *info, union object_cache_handle *handle) {
+  struct uvr_vk_render_pass renderPass = uvr_vk_render_pass_create(info);
+  handle->renderPass = renderPass.renderPass;
+  return (renderPass.renderPass) ? 0 : -1;
+}
+
+
+static void object_cache_render_pass_destroy(VkDevice vkDevice, union object_cache_handle *handle) {
+  vkDestroyRenderPass(vkDevice, handle->renderPass, hostCallbacks);
+}
+
+
+static int object_cache_sampler_create(VkDevice vkDevice, void *info, union object_cache_handle *handle) {
+  VkResult res = vkCreateSampler(vkDevice, info, hostCallbacks, &handle->sampler);
+  if (res) {
+    uvr_utils_log(UVR_DANGER, "[x] vkCreateSampler: %s", vkres_msg(res));
+    return -1;
+  }
+
+  uvr_utils_log(UVR_SUCCESS, "uvr_vk_object_cache_sampler_get: VkSampler successfully created retval(%p)", handle->sampler);
+  return 0;
+}
+
+
+static void object_cache_sampler_destroy(VkDevice vkDevice, union object_cache_handle *handle) {
+  vkDestroySampler(vkDevice, handle->sampler, hostCallbacks);
+}
+
+
+struct uvr_vk_object_cache uvr_vk_object_cache_create(struct uvr_vk_object_cache_create_info *uvrvk) {
+  struct uvr_vk_object_cache_tables *tables = NULL;
+
+  if (!uvrvk->vkDevice) {
+    uvr_utils_log(UVR_DANGER, "[x] uvr_vk_object_cache_create: VkDevice not instantiated");
+    goto exit_vk_object_cache;
+  }
+
+  tables = calloc(1, sizeof(struct uvr_vk_object_cache_tables));
+  if (!tables) {
+    uvr_utils_log(UVR_DANGER, "[x] calloc: %s", strerror(errno));
+    goto exit_vk_object_cache;
+  }
+
+  if (pthread_mutex_init(&tables->lock, NULL)) {
+    uvr_utils_log(UVR_DANGER, "[x] pthread_mutex_init: %s", strerror(errno));
+    goto exit_vk_object_cache_free_tables;
+  }
+
+  return (struct uvr_vk_object_cache) { .vkDevice = uvrvk->vkDevice, .tables = tables };
+
+exit_vk_object_cache_free_tables:
+  free(tables);
+exit_vk_object_cache:
+  return (struct uvr_vk_object_cache) { .vkDevice = VK_NULL_HANDLE, .tables = NULL };
+}
+
+
+/* graphics_pipeline_key() hashes none of the pNext chains, two pipelines differing only in them would collide */
+static bool graphics_pipeline_chained(const struct uvr_vk_graphics_pipeline_create_info *uvrvk) {
+  for (uint32_t s = 0; s < uvrvk->stageCount; s++)
+    if (uvrvk->pStages[s].pNext)
+      return true;
+
+  return (uvrvk->pVertexInputState && uvrvk->pVertexInputState->pNext) ||
+         (uvrvk->pInputAssemblyState && uvrvk->pInputAssemblyState->pNext) ||
+         (uvrvk->pTessellationState && uvrvk->pTessellationState->pNext) ||
+         (uvrvk->pViewportState && uvrvk->pViewportState->pNext) ||
+         (uvrvk->pRasterizationState && uvrvk->pRasterizationState->pNext) ||
+         (uvrvk->pMultisampleState && uvrvk->pMultisampleState->pNext) ||
+         (uvrvk->pDepthStencilState && uvrvk->pDepthStencilState->pNext) ||
+         (uvrvk->pColorBlendState && uvrvk->pColorBlendState->pNext) ||
+         (uvrvk->pDynamicState && uvrvk->pDynamicState->pNext) ||
+         (uvrvk->pRenderingInfo && uvrvk->pRenderingInfo->pNext);
+}
+
+
+VkPipeline uvr_vk_object_cache_graphics_pipeline_get(struct uvr_vk_object_cache *cache, struct uvr_vk_graphics_pipeline_create_info *uvrvk) {
+  struct object_cache_key key;
+
+  if (uvrvk->vkDevice != cache->vkDevice) {
+    uvr_utils_log(UVR_DANGER, "[x] uvr_vk_object_cache_graphics_pipeline_get: VkDevice doesn't match the cache's");
+    return VK_NULL_HANDLE;
+  }
+
+  if (graphics_pipeline_chained(uvrvk)) {
+    uvr_utils_log(UVR_DANGER, "[x] uvr_vk_object_cache_graphics_pipeline_get: pNext chains can't be cached");
+    return VK_NULL_HANDLE;
+  }
+
+  memset(&key, 0, sizeof(key));
+  graphics_pipeline_key(&key, uvrvk);
+
+  return object_cache_get(cache, &cache->tables->pipelines, &key, object_cache_pipeline_create,
+                          object_cache_pipeline_destroy, uvrvk).pipeline;
+}
+
+
+VkRenderPass uvr_vk_object_cache_render_pass_get(struct uvr_vk_object_cache *cache, struct uvr_vk_render_pass_create_info *uvrvk) {
+  struct object_cache_key key;
+
+  if (uvrvk->vkDevice != cache->vkDevice) {
+    uvr_utils_log(UVR_DANGER, "[x] uvr_vk_object_cache_render_pass_get: VkDevice doesn't match the cache's");
+    return VK_NULL_HANDLE;
+  }
+
+  memset(&key, 0, sizeof(key));
+  render_pass_key(&key, uvrvk);
+
+  return object_cache_get(cache, &cache->tables->renderPasses, &key, object_cache_render_pass_create,
+                          object_cache_render_pass_destroy, uvrvk).renderPass;
+}
+
+
+VkSampler uvr_vk_object_cache_sampler_get(struct uvr_vk_object_cache *cache, const VkSamplerCreateInfo *pCreateInfo) {
+  struct object_cache_key key;
+
+  if (pCreateInfo->pNext) {
+    uvr_utils_log(UVR_DANGER, "[x] uvr_vk_object_cache_sampler_get: pNext chains can't be cached");
+    return VK_NULL_HANDLE;
+  }
+
+  memset(&key, 0, sizeof(key));
+  sampler_key(&key, pCreateInfo);
+
+  return object_cache_get(cache, &cache->tables->samplers, &key, object_cache_sampler_create,
+                          object_cache_sampler_destroy, (void *) pCreateInfo).sampler;
+}
+
+
+struct uvr_vk_object_cache_stats uvr_vk_object_cache_get_stats(struct uvr_vk_object_cache *cache) {
+  struct uvr_vk_object_cache_tables *tables = cache->tables;
+  struct uvr_vk_object_cache_stats stats;
+
+  memset(&stats, 0, sizeof(stats));
+
+  pthread_mutex_lock(&tables->lock);
+  stats.pipelineCount = tables->pipelines.entryCount;
+  stats.pipelineHits = tables->pipelines.hits;
+  stats.pipelineMisses = tables->pipelines.misses;
+  stats.renderPassCount = tables->renderPasses.entryCount;
+  stats.renderPassHits = tables->renderPasses.hits;
+  stats.renderPassMisses = tables->renderPasses.misses;
+  stats.samplerCount = tables->samplers.entryCount;
+  stats.samplerHits = tables->samplers.hits;
+  stats.samplerMisses = tables->samplers.misses;
+  pthread_mutex_unlock(&tables->lock);
+
+  return stats;
+}
+
+
+int uvr_vk_dynamic_state_init(struct uvr_vk_dynamic_state *state, struct uvr_vk_dynamic_state_create_info *uvrvk) {
+  VkPhysicalDeviceProperties phdevProps;
+  uint32_t flags = uvrvk->flags;
+
+  memset(state, 0, sizeof(struct uvr_vk_dynamic_state));
+
+  if (!uvrvk->vkPhdev || !uvrvk->vkDevice) {
+    uvr_utils_log(UVR_DANGER, "[x] uvr_vk_dynamic_state_init: VkPhysicalDevice or VkDevice not instantiated");
+    return -1;
+  }
+
+  vkGetPhysicalDeviceProperties(uvrvk->vkPhdev, &phdevProps);
+  if (phdevProps.apiVersion < VK_API_VERSION_1_3)
+    flags &= ~(UVR_VK_DYNAMIC_STATE_CULL_MODE | UVR_VK_DYNAMIC_STATE_TOPOLOGY | UVR_VK_DYNAMIC_STATE_DEPTH);
+
+  if (flags & (UVR_VK_DYNAMIC_STATE_BLEND_ENABLE | UVR_VK_DYNAMIC_STATE_WRITE_MASK)) {
+    VkPhysicalDeviceExtendedDynamicState3FeaturesEXT eds3 = {};
+    eds3.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_3_FEATURES_EXT;
+    eds3.pNext = NULL;
+
+    VkPhysicalDeviceFeatures2 features2 = {};
+    features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    features2.pNext = &eds3;
+
+    if (uvrvk->extendedDynamicState3Enabled)
+      vkGetPhysicalDeviceFeatures2(uvrvk->vkPhdev, &features2);
+
+    if (eds3.extendedDynamicState3ColorBlendEnable)
+      UVR_VK_DEVICE_PROC_ADDR(uvrvk->vkDevice, state->CmdSetColorBlendEnableEXT, CmdSetColorBlendEnableEXT);
+    if (eds3.extendedDynamicState3ColorWriteMask)
+      UVR_VK_DEVICE_PROC_ADDR(uvrvk->vkDevice, state->CmdSetColorWriteMaskEXT, CmdSetColorWriteMaskEXT);
+
+    if (!state->CmdSetColorBlendEnableEXT)
+      flags &= ~UVR_VK_DYNAMIC_STATE_BLEND_ENABLE;
+    if (!state->CmdSetColorWriteMaskEXT)
+      flags &= ~UVR_VK_DYNAMIC_STATE_WRITE_MASK;
+  }
+
+  if (flags & UVR_VK_DYNAMIC_STATE_VIEWPORT_SCISSOR) {
+    state->dynamicStates[state->dynamicStateCount++] = VK_DYNAMIC_STATE_VIEWPORT;
+    state->dynamicStates[state->dynamicStateCount++] = VK_DYNAMIC_STATE_SCISSOR;
+  }
+
+  if (flags & UVR_VK_DYNAMIC_STATE_CULL_MODE) {
+    state->dynamicStates[state->dynamicStateCount++] = VK_DYNAMIC_STATE_CULL_MODE;
+    state->dynamicStates[state->dynamicStateCount++] = VK_DYNAMIC_STATE_FRONT_FACE;
+  }
+
+  if (flags & UVR_VK_DYNAMIC_STATE_TOPOLOGY)
+    state->dynamicStates[state->dynamicStateCount++] = VK_DYNAMIC_STATE_PRIMITIVE_TOPOLOGY;
+
+  if (flags & UVR_VK_DYNAMIC_STATE_DEPTH) {
+    state->dynamicStates[state->dynamicStateCount++] = VK_DYNAMIC_STATE_DEPTH_TEST_ENABLE;
+    state->dynamicStates[state->dynamicStateCount++] = VK_DYNAMIC_STATE_DEPTH_WRITE_ENABLE;
+    state->dynamicStates[state->dynamicStateCount++] = VK_DYNAMIC_STATE_DEPTH_COMPARE_OP;
+  }
+
+  if (flags & UVR_VK_DYNAMIC_STATE_BLEND_ENABLE)
+    state->dynamicStates[state->dynamicStateCount++] = VK_DYNAMIC_STATE_COLOR_BLEND_ENABLE_EXT;
+
+  if (flags & UVR_VK_DYNAMIC_STATE_WRITE_MASK)
+    state->dynamicStates[state->dynamicStateCount++] = VK_DYNAMIC_STATE_COLOR_WRITE_MASK_EXT;
+
+  state->vkDevice = uvrvk->vkDevice;
+  state->enabledFlags = flags;
+  state->createInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+  state->createInfo.pNext = NULL;
+  state->createInfo.flags = 0;
+  state->createInfo.dynamicStateCount = state->dynamicStateCount;
+  state->createInfo.pDynamicStates = state->dynamicStates;
+
+  if (flags != uvrvk->flags)
+    uvr_utils_log(UVR_WARNING, "uvr_vk_dynamic_state_init: dynamic state groups 0x%x unsupported, keep them baked", uvrvk->flags & ~flags);
+
+  uvr_utils_log(UVR_SUCCESS, "uvr_vk_dynamic_state_init: %u dynamic state(s) enabled (groups 0x%x)", state->dynamicStateCount, flags);
+
+  return 0;
+}
+
+
+/* Individually tracked values of struct uvr_vk_dynamic_state_tracker { member: validMask } */
+enum dynamic_state_tracked {
+  DYNAMIC_STATE_TRACKED_VIEWPORT      = (1 << 0),
+  DYNAMIC_STATE_TRACKED_SCISSOR       = (1 << 1),
+  DYNAMIC_STATE_TRACKED_CULL_MODE     = (1 << 2),
+  DYNAMIC_STATE_TRACKED_FRONT_FACE    = (1 << 3),
+  DYNAMIC_STATE_TRACKED_TOPOLOGY      = (1 << 4),
+  DYNAMIC_STATE_TRACKED_DEPTH_TEST    = (1 << 5),
+  DYNAMIC_STATE_TRACKED_DEPTH_WRITE   = (1 << 6),
+  DYNAMIC_STATE_TRACKED_DEPTH_COMPARE = (1 << 7),
+};
+
+
+void uvr_vk_dynamic_state_tracker_begin(struct uvr_vk_dynamic_state_tracker *tracker, const struct uvr_vk_device_dispatch *dispatch,
+                                        const struct uvr_vk_dynamic_state *dynamicState, VkCommandBuffer commandBuffer) {
+  tracker->dispatch = dispatch;
+  tracker->dynamicState = dynamicState;
+  tracker->commandBuffer = commandBuffer;
+  tracker->pipeline = VK_NULL_HANDLE;
+  tracker->validMask = 0;
+  tracker->blendEnableValid = 0;
+  tracker->writeMaskValid = 0;
+}
+
+
+void uvr_vk_dynamic_state_tracker_bind_pipeline(struct uvr_vk_dynamic_state_tracker *tracker, VkPipeline pipeline, uint32_t dynamicFlags) {
+  if (tracker->pipeline == pipeline) {
+    tracker->skipCount++;
+    return;
+  }
+
+  tracker->dispatch->CmdBindPipeline(tracker->commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+  tracker->pipeline = pipeline;
+  tracker->setCount++;
+
+  /* Binding a pipeline overwrites the command buffer's value of every state it bakes */
+  if (!(dynamicFlags & UVR_VK_DYNAMIC_STATE_VIEWPORT_SCISSOR))
+    tracker->validMask &= ~(DYNAMIC_STATE_TRACKED_VIEWPORT | DYNAMIC_STATE_TRACKED_SCISSOR);
+  if (!(dynamicFlags & UVR_VK_DYNAMIC_STATE_CULL_MODE))
+    tracker->validMask &= ~(DYNAMIC_STATE_TRACKED_CULL_MODE | DYNAMIC_STATE_TRACKED_FRONT_FACE);
+  if (!(dynamicFlags & UVR_VK_DYNAMIC_STATE_TOPOLOGY))
+    tracker->validMask &= ~DYNAMIC_STATE_TRACKED_TOPOLOGY;
+  if (!(dynamicFlags & UVR_VK_DYNAMIC_STATE_DEPTH))
+    tracker->validMask &= ~(DYNAMIC_STATE_TRACKED_DEPTH_TEST | DYNAMIC_STATE_TRACKED_DEPTH_WRITE | DYNAMIC_STATE_TRACKED_DEPTH_COMPARE);
+  if (!(dynamicFlags & UVR_VK_DYNAMIC_STATE_BLEND_ENABLE))
+    tracker->blendEnableValid = 0;
+  if (!(dynamicFlags & UVR_VK_DYNAMIC_STATE_WRITE_MASK))
+    tracker->writeMaskValid = 0;
+}
+
+
+void uvr_vk_dynamic_state_tracker_set_viewport(struct uvr_vk_dynamic_state_tracker *tracker, const VkViewport *viewport) {
+  /* Groups left out by uvr_vk_dynamic_state_init(3) are baked into the pipeline, nothing to record */
+  if (!(tracker->dynamicState->enabledFlags & UVR_VK_DYNAMIC_STATE_VIEWPORT_SCISSOR))
+    return;
+
+  if ((tracker->validMask & DYNAMIC_STATE_TRACKED_VIEWPORT) && !memcmp(&tracker->viewport, viewport, sizeof(VkViewport))) {
+    tracker->skipCount++;
+    return;
+  }
+
+  tracker->dispatch->CmdSetViewport(tracker->commandBuffer, 0, 1, viewport);
+  tracker->viewport = *viewport;
+  tracker->validMask |= DYNAMIC_STATE_TRACKED_VIEWPORT;
+  tracker->setCount++;
+}
+
+
+void uvr_vk_dynamic_state_tracker_set_scissor(struct uvr_vk_dynamic_state_tracker *tracker, const VkRect2D *scissor) {
+  if (!(tracker->dynamicState->enabledFlags & UVR_VK_DYNAMIC_STATE_VIEWPORT_SCISSOR))
+    return;
+
+  if ((tracker->validMask & DYNAMIC_STATE_TRACKED_SCISSOR) && !memcmp(&tracker->scissor, scissor, sizeof(VkRect2D))) {
+    tracker->skipCount++;
+    return;
+  }
+
+  tracker->dispatch->CmdSetScissor(tracker->commandBuffer, 0, 1, scissor);
+  tracker->scissor = *scissor;
+  tracker->validMask |= DYNAMIC_STATE_TRACKED_SCISSOR;
+  tracker->setCount++;
+}
+
+
+void uvr_vk_dynamic_state_tracker_set_cull_mode(struct uvr_vk_dynamic_state_tracker *tracker, VkCullModeFlags cullMode, VkFrontFace frontFace) {
+  if (!(tracker->dynamicState->enabledFlags & UVR_VK_DYNAMIC_STATE_CULL_MODE))
+    return;
+
+  if ((tracker->validMask & DYNAMIC_STATE_TRACKED_CULL_MODE) && tracker->cullMode == cullMode) {
+    tracker->skipCount++;
+  } else {
+    tracker->dispatch->CmdSetCullMode(tracker->commandBuffer, cullMode);
+    tracker->cullMode = cullMode;
+    tracker->validMask |= DYNAMIC_STATE_TRACKED_CULL_MODE;
+    tracker->setCount++;
+  }
+
+  if ((tracker->validMask & DYNAMIC_STATE_TRACKED_FRONT_FACE) && tracker->frontFace == frontFace) {
+    tracker->skipCount++;
+  } else {
+    tracker->dispatch->CmdSetFrontFace(tracker->commandBuffer, frontFace);
+    tracker->frontFace = frontFace;
+    tracker->validMask |= DYNAMIC_STATE_TRACKED_FRONT_FACE;
+    tracker->setCount++;
+  }
+}
+
+
+void uvr_vk_dynamic_state_tracker_set_topology(struct uvr_vk_dynamic_state_tracker *tracker, VkPrimitiveTopology topology) {
+  if (!(tracker->dynamicState->enabledFlags & UVR_VK_DYNAMIC_STATE_TOPOLOGY))
+    return;
+
+  if ((tracker->validMask & DYNAMIC_STATE_TRACKED_TOPOLOGY) && tracker->topology == topology) {
+    tracker->skipCount++;
+    return;
+  }
+
+  tracker->dispatch->CmdSetPrimitiveTopology(tracker->commandBuffer, topology);
+  tracker->topology = topology;
+  tracker->validMask |= DYNAMIC_STATE_TRACKED_TOPOLOGY;
+  tracker->setCount++;
+}
+
+
+void uvr_vk_dynamic_state_tracker_set_depth(struct uvr_vk_dynamic_state_tracker *tracker, VkBool32 testEnable,
+                                            VkBool32 writeEnable, VkCompareOp compareOp) {
+  if (!(tracker->dynamicState->enabledFlags & UVR_VK_DYNAMIC_STATE_DEPTH))
+    return;
+
+  if ((tracker->validMask & DYNAMIC_STATE_TRACKED_DEPTH_TEST) && tracker->depthTestEnable == testEnable) {
+    tracker->skipCount++;
+  } else {
+    tracker->dispatch->CmdSetDepthTestEnable(tracker->commandBuffer, testEnable);
+    tracker->depthTestEnable = testEnable;
+    tracker->validMask |= DYNAMIC_STATE_TRACKED_DEPTH_TEST;
+    tracker->setCount++;
+  }
+
+  if ((tracker->validMask & DYNAMIC_STATE_TRACKED_DEPTH_WRITE) && tracker->depthWriteEnable == writeEnable) {
+    tracker->skipCount++;
+  } else {
+    tracker->dispatch->CmdSetDepthWriteEnable(tracker->commandBuffer, writeEnable);
+    tracker->depthWriteEnable = writeEnable;
+    tracker->validMask |= DYNAMIC_STATE_TRACKED_DEPTH_WRITE;
+    tracker->setCount++;
+  }
+
+  if ((tracker->validMask & DYNAMIC_STATE_TRACKED_DEPTH_COMPARE) && tracker->depthCompareOp == compareOp) {
+    tracker->skipCount++;
+  } else {
+    tracker->dispatch->CmdSetDepthCompareOp(tracker->commandBuffer, compareOp);
+    tracker->depthCompareOp = compareOp;
+    tracker->validMask |= DYNAMIC_STATE_TRACKED_DEPTH_COMPARE;
+    tracker->setCount++;
+  }
+}
+
+
+void uvr_vk_dynamic_state_tracker_set_blend(struct uvr_vk_dynamic_state_tracker *tracker, uint32_t attachment,
+                                            VkBool32 blendEnable, VkColorComponentFlags writeMask) {
+  const struct uvr_vk_dynamic_state *state = tracker->dynamicState;
+  uint32_t bit;
+
+  if (attachment >= UVR_VK_DYNAMIC_STATE_MAX_ATTACHMENTS) {
+    uvr_utils_log(UVR_DANGER, "[x] uvr_vk_dynamic_state_tracker_set_blend: attachment %u out of range", attachment);
+    return;
+  }
+
+  bit = 1u << attachment;
+
+  if (state->enabledFlags & UVR_VK_DYNAMIC_STATE_BLEND_ENABLE) {
+    if ((tracker->blendEnableValid & bit) && tracker->blendEnable[attachment] == blendEnable) {
+      tracker->skipCount++;
+    } else {
+      state->CmdSetColorBlendEnableEXT(tracker->commandBuffer, attachment, 1, &blendEnable);
+      tracker->blendEnable[attachment] = blendEnable;
+      tracker->blendEnableValid |= bit;
+      tracker->setCount++;
+    }
+  }
+
+  if (state->enabledFlags & UVR_VK_DYNAMIC_STATE_WRITE_MASK) {
+    if ((tracker->writeMaskValid & bit) && tracker->writeMask[attachment] == writeMask) {
+      tracker->skipCount++;
+    } else {
+      state->CmdSetColorWriteMaskEXT(tracker->commandBuffer, attachment, 1, &writeMask);
+      tracker->writeMask[attachment] = writeMask;
+      tracker->writeMaskValid |= bit;
+      tracker->setCount++;
+    }
+  }
+}
+
+
+struct uvr_vk_compute_pipeline uvr_vk_compute_pipeline_create(struct uvr_vk_compute_pipeline_create_info *uvrvk) {
+  VkResult res = VK_RESULT_MAX_ENUM;
+  VkPipeline pipeline = VK_NULL_HANDLE;
+  VkPhysicalDeviceProperties phdevProps;
+  struct uvr_vk_compute_pipeline compute;
+  struct timespec start, end;
+  uint32_t d;
+
+  memset(&compute, 0, sizeof(compute));
+
+  if (!uvrvk->vkPhdev || !uvrvk->vkDevice || !uvrvk->shader) {
+    uvr_utils_log(UVR_DANGER, "[x] uvr_vk_compute_pipeline_create: vkPhdev, vkDevice and shader must be valid handles");
+    goto exit_vk_compute_pipeline;
+  }
+
+  vkGetPhysicalDeviceProperties(uvrvk->vkPhdev, &phdevProps);
+
+  for (d = 0; d < 3; d++) {
+    compute.localSize[d] = (uvrvk->localSize[d]) ? uvrvk->localSize[d] : 1;
+    compute.maxWorkGroupCount[d] = phdevProps.limits.maxComputeWorkGroupCount[d];
+
+    if (compute.localSize[d] > phdevProps.limits.maxComputeWorkGroupSize[d]) {
+      uvr_utils_log(UVR_DANGER, "[x] uvr_vk_compute_pipeline_create: localSize[%u] %u exceeds maxComputeWorkGroupSize %u",
+                                d, compute.localSize[d], phdevProps.limits.maxComputeWorkGroupSize[d]);
+      goto exit_vk_compute_pipeline;
+    }
+  }
+
+  if (compute.localSize[0] * compute.localSize[1] * compute.localSize[2] > phdevProps.limits.maxComputeWorkGroupInvocations) {
+    uvr_utils_log(UVR_DANGER, "[x] uvr_vk_compute_pipeline_create: workgroup exceeds maxComputeWorkGroupInvocations %u",
+                              phdevProps.limits.maxComputeWorkGroupInvocations);
+    goto exit_vk_compute_pipeline;
+  }
+
+  VkComputePipelineCreateInfo create_info = {};
+  create_info.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+  create_info.pNext = NULL;
+  create_info.flags = VK_PIPELINE_CREATE_DISPATCH_BASE_BIT;
+  create_info.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+  create_info.stage.pNext = NULL;
+  create_info.stage.flags = 0;
+  create_info.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+  create_info.stage.module = uvrvk->shader;
+  create_info.stage.pName = (uvrvk->pEntryPoint) ? uvrvk->pEntryPoint : "main";
+  create_info.stage.pSpecializationInfo = uvrvk->pSpecializationInfo;
+  create_info.layout = uvrvk->vkPipelineLayout;
+  // Won't be supporting
+  create_info.basePipelineHandle = VK_NULL_HANDLE;
+  create_info.basePipelineIndex = -1;
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  res = vkCreateComputePipelines(uvrvk->vkDevice, uvrvk->vkPipelineCache, 1, &create_info, hostCallbacks, &pipeline);
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  if (res) {
+    uvr_utils_log(UVR_DANGER, "[x] vkCreateComputePipelines: %s", vkres_msg(res));
+    goto exit_vk_compute_pipeline;
+  }
+
+  compute.vkDevice = uvrvk->vkDevice;
+  compute.dispatch = uvr_vk_device_dispatch_get(uvrvk->vkDevice);
+  compute.computePipeline = pipeline;
+
+  uvr_utils_log(UVR_SUCCESS, "uvr_vk_compute_pipeline_create: VkPipeline successfully created retval(%p) local size %ux%ux%u in %.3f ms (cache: %p)",
+                             pipeline, compute.localSize[0], compute.localSize[1], compute.localSize[2],
+                             elapsed_ms(&start, &end), uvrvk->vkPipelineCache);
+
+  return compute;
+
+exit_vk_compute_pipeline:
+  return (struct uvr_vk_compute_pipeline) { .vkDevice = VK_NULL_HANDLE, .dispatch = NULL, .computePipeline = VK_NULL_HANDLE };
+}
+
+
+uint32_t uvr_vk_compute_pipeline_dispatch(struct uvr_vk_compute_pipeline *pipeline, struct uvr_vk_compute_dispatch_info *uvrvk) {
+  uint32_t groups[3], base[3], count[3], extent[3], d, dispatchCount = 0;
+
+  extent[0] = uvrvk->extent3D.width;
+  extent[1] = uvrvk->extent3D.height;
+  extent[2] = uvrvk->extent3D.depth;
+
+  for (d = 0; d < 3; d++) {
+    if (!extent[d])
+      return 0;
+    /* Rounding up via extent + localSize - 1 wraps for extents near UINT32_MAX */
+    groups[d] = extent[d] / pipeline->localSize[d] + (extent[d] % pipeline->localSize[d] != 0);
+  }
+
+  /* Common case, single dispatch within the device's limits */
+  if (groups[0] <= pipeline->maxWorkGroupCount[0] && groups[1] <= pipeline->maxWorkGroupCount[1] &&
+      groups[2] <= pipeline->maxWorkGroupCount[2])
+  {
+    pipeline->dispatch->CmdDispatch(uvrvk->commandBuffer, groups[0], groups[1], groups[2]);
+    return 1;
+  }
+
+  for (base[2] = 0; base[2] < groups[2]; base[2] += count[2]) {
+    count[2] = (groups[2] - base[2] < pipeline->maxWorkGroupCount[2]) ? groups[2] - base[2] : pipeline->maxWorkGroupCount[2];
+    for (base[1] = 0; base[1] < groups[1]; base[1] += count[1]) {
+      count[1] = (groups[1] - base[1] < pipeline->maxWorkGroupCount[1]) ? groups[1] - base[1] : pipeline->maxWorkGroupCount[1];
+      for (base[0] = 0; base[0] < groups[0]; base[0] += count[0]) {
+        count[0] = (groups[0] - base[0] < pipeline->maxWorkGroupCount[0]) ? groups[0] - base[0] : pipeline->maxWorkGroupCount[0];
+        pipeline->dispatch->CmdDispatchBase(uvrvk->commandBuffer, base[0], base[1], base[2], count[0], count[1], count[2]);
+        dispatchCount++;
+      }
+    }
+  }
+
+  return dispatchCount;
+}
+
+
+struct storage_image_access_info {
+  VkPipelineStageFlags stageMask;
+  VkAccessFlags        accessMask;
+  VkImageLayout        layout;
+};
+
+
+/* Indexed by uvr_vk_storage_image_access */
+static const struct storage_image_access_info storageImageAccess[] = {
+  { VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, 0, VK_IMAGE_LAYOUT_UNDEFINED },
+  { VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_LAYOUT_GENERAL },
+  { VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT, VK_IMAGE_LAYOUT_GENERAL },
+  { VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT, VK_IMAGE_LAYOUT_GENERAL },
+  { VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL },
+  { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+    VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL },
+  { VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL },
+  { VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL },
+  { VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR },
+};
+
+
+void uvr_vk_storage_image_barrier(const struct uvr_vk_device_dispatch *dispatch, struct uvr_vk_storage_image_barrier_info *uvrvk) {
+  const struct storage_image_access_info *src, *dst;
+
+  if (uvrvk->srcAccess >= ARRAY_LEN(storageImageAccess) || uvrvk->dstAccess >= ARRAY_LEN(storageImageAccess) ||
+      uvrvk->dstAccess == UVR_VK_STORAGE_IMAGE_UNDEFINED)
+  {
+    uvr_utils_log(UVR_DANGER, "[x] uvr_vk_storage_image_barrier: invalid access transition %d -> %d", uvrvk->srcAccess, uvrvk->dstAccess);
+    return;
+  }
+
+  src = &storageImageAccess[uvrvk->srcAccess];
+  dst = &storageImageAccess[uvrvk->dstAccess];
+
+  VkImageMemoryBarrier barrier = {};
+  barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+  barrier.pNext = NULL;
+  barrier.srcAccessMask = src->accessMask;
+  barrier.dstAccessMask = dst->accessMask;
+  barrier.oldLayout = src->layout;
+  barrier.newLayout = dst->layout;
+  barrier.srcQueueFamilyIndex = uvrvk->srcQueueFamilyIndex;
+  barrier.dstQueueFamilyIndex = uvrvk->dstQueueFamilyIndex;
+  barrier.image = uvrvk->image;
+  barrier.subresourceRange = uvrvk->subresourceRange;
+
+  dispatch->CmdPipelineBarrier(uvrvk->commandBuffer, src->stageMask, dst->stageMask, 0, 0, NULL, 0, NULL, 1, &barrier);
+}
+
+
+struct uvr_vk_framebuffer uvr_vk_framebuffer_create(struct uvr_vk_framebuffer_create_info *uvrvk) {
+  VkResult res = VK_RESULT_MAX_ENUM;
+  struct uvr_vk_framebuffer_handle *vkfbs = NULL;
+  uint32_t fbc;
+
+  vkfbs = (struct uvr_vk_framebuffer_handle *) calloc(uvrvk->frameBufferCount, sizeof(vkfbs));
+  if (!vkfbs) {
+    uvr_utils_log(UVR_DANGER, "[x] calloc: %s", strerror(errno));
+    goto exit_vk_framebuffer;
+  }
+
+  VkFramebufferCreateInfo create_info = {};
+  create_info.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+  create_info.pNext = NULL;
+  create_info.flags = 0;
+  create_info.renderPass = uvrvk->renderPass;
+  create_info.width = uvrvk->width;
+  create_info.height = uvrvk->height;
+  create_info.layers = uvrvk->layers;
+
+  for (fbc = 0; fbc < uvrvk->frameBufferCount; fbc++) {
+    create_info.attachmentCount = 1;
+    create_info.pAttachments = &uvrvk->vkImageViews[fbc].view;
+
+    res = vkCreateFramebuffer(uvrvk->vkDevice, &create_info, hostCallbacks, &vkfbs[fbc].fb);
+    if (res) {
+      uvr_utils_log(UVR_DANGER, "[x] vkCreateFramebuffer: %s", vkres_msg(res));
+      goto exit_vk_framebuffer_vk_framebuffer_destroy;
+    }
+
+    uvr_utils_log(UVR_SUCCESS, "uvr_vk_framebuffer_create: VkFramebuffer successfully created retval(%p)", vkfbs[fbc].fb);
+  }
+
+  return (struct uvr_vk_framebuffer) { .vkDevice = uvrvk->vkDevice, .frameBufferCount = uvrvk->frameBufferCount, .vkFrameBuffers = vkfbs };
+
+exit_vk_framebuffer_vk_framebuffer_destroy:
+  for (fbc = 0; fbc < uvrvk->frameBufferCount; fbc++) {
+    if (vkfbs[fbc].fb)
+      vkDestroyFramebuffer(uvrvk->vkDevice, vkfbs[fbc].fb, hostCallbacks);
+  }
+//exit_vk_framebuffer_free_vkfbs:
+  free(vkfbs);
+exit_vk_framebuffer:
+  return (struct uvr_vk_framebuffer) { .vkDevice = VK_NULL_HANDLE, .frameBufferCount = 0, .vkFrameBuffers = NULL };
+}
+
+
+int uvr_vk_rendering_begin(struct uvr_vk_rendering_begin_info *uvrvk) {
+  const struct uvr_vk_device_dispatch *dispatch = uvr_vk_device_dispatch_get(VK_NULL_HANDLE);
+  VkImageMemoryBarrier barriers[UVR_VK_RENDERING_MAX_COLOR_ATTACHMENTS + 1];
+  VkRenderingAttachmentInfo colorAttachments[UVR_VK_RENDERING_MAX_COLOR_ATTACHMENTS];
+  VkRenderingAttachmentInfo depthAttachment;
+  VkPipelineStageFlags dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+  uint32_t c, barrierCount = 0;
+
+  if (uvrvk->colorAttachmentCount > UVR_VK_RENDERING_MAX_COLOR_ATTACHMENTS) {
+    uvr_utils_log(UVR_DANGER, "[x] uvr_vk_rendering_begin: %u color attachments exceeds the maximum of %u",
+                              uvrvk->colorAttachmentCount, UVR_VK_RENDERING_MAX_COLOR_ATTACHMENTS);
+    return -1;
+  }
+
+  for (c = 0; c < uvrvk->colorAttachmentCount; c++) {
+    barriers[barrierCount].sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barriers[barrierCount].pNext = NULL;
+    barriers[barrierCount].srcAccessMask = 0;
+    barriers[barrierCount].dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    barriers[barrierCount].oldLayout = uvrvk->colorOldLayout;
+    barriers[barrierCount].newLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    barriers[barrierCount].srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barriers[barrierCount].dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barriers[barrierCount].image = uvrvk->pColorImages[c];
+    barriers[barrierCount].subresourceRange = (VkImageSubresourceRange) { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+    barrierCount++;
+
+    colorAttachments[c].sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
+    colorAttachments[c].pNext = NULL;
+    colorAttachments[c].imageView = uvrvk->pColorImageViews[c];
+    colorAttachments[c].imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    colorAttachments[c].resolveMode = VK_RESOLVE_MODE_NONE;
+    colorAttachments[c].resolveImageView = VK_NULL_HANDLE;
+    colorAttachments[c].resolveImageLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    colorAttachments[c].loadOp = uvrvk->colorLoadOp;
+    colorAttachments[c].storeOp = uvrvk->colorStoreOp;
+    if (uvrvk->pColorClearValues)
+      colorAttachments[c].clearValue = uvrvk->pColorClearValues[c];
+    else
+      memset(&colorAttachments[c].clearValue, 0, sizeof(VkClearValue));
+  }
+
+  if (uvrvk->depthImage) {
+    barriers[barrierCount].sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barriers[barrierCount].pNext = NULL;
+    barriers[barrierCount].srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+    barriers[barrierCount].dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+    barriers[barrierCount].oldLayout = uvrvk->depthOldLayout;
+    barriers[barrierCount].newLayout = VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL;
+    barriers[barrierCount].srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barriers[barrierCount].dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barriers[barrierCount].image = uvrvk->depthImage;
+    barriers[barrierCount].subresourceRange = (VkImageSubresourceRange) { VK_IMAGE_ASPECT_DEPTH_BIT, 0, 1, 0, 1 };
+    barrierCount++;
+
+    depthAttachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
+    depthAttachment.pNext = NULL;
+    depthAttachment.imageView = uvrvk->depthImageView;
+    depthAttachment.imageLayout = VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL;
+    depthAttachment.resolveMode = VK_RESOLVE_MODE_NONE;
+    depthAttachment.resolveImageView = VK_NULL_HANDLE;
+    depthAttachment.resolveImageLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    depthAttachment.loadOp = uvrvk->depthLoadOp;
+    depthAttachment.storeOp = uvrvk->depthStoreOp;
+    depthAttachment.clearValue = uvrvk->depthClearValue;
+
+    dstStageMask |= VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+  }
+
+  /*
+   * Source stage matches the stage a swapchain acquire semaphore is waited on at, so
+   * the transition happens after the presentation engine is done reading the image.
+   */
+  dispatch->CmdPipelineBarrier(uvrvk->vkCommandBuffer, dstStageMask, dstStageMask, 0, 0, NULL, 0, NULL, barrierCount, barriers);
+
+  VkRenderingInfo rendering_info = {};
+  rendering_info.sType = VK_STRUCTURE_TYPE_RENDERING_INFO;
+  rendering_info.pNext = NULL;
+  rendering_info.flags = uvrvk->renderingFlags;
+  rendering_info.renderArea = uvrvk->renderArea;
+  rendering_info.layerCount = 1;
+  rendering_info.viewMask = 0;
+  rendering_info.colorAttachmentCount = uvrvk->colorAttachmentCount;
+  rendering_info.pColorAttachments = colorAttachments;
+  rendering_info.pDepthAttachment = (uvrvk->depthImage) ? &depthAttachment : NULL;
+  rendering_info.pStencilAttachment = NULL;
+
+  dispatch->CmdBeginRendering(uvrvk->vkCommandBuffer, &rendering_info);
+
+  return 0;
+}
+
+
+int uvr_vk_rendering_end(struct uvr_vk_rendering_end_info *uvrvk) {
+  const struct uvr_vk_device_dispatch *dispatch = uvr_vk_device_dispatch_get(VK_NULL_HANDLE);
+  VkImageMemoryBarrier barriers[UVR_VK_RENDERING_MAX_COLOR_ATTACHMENTS];
+  uint32_t c;
+
+  if (uvrvk->colorAttachmentCount > UVR_VK_RENDERING_MAX_COLOR_ATTACHMENTS) {
+    uvr_utils_log(UVR_DANGER, "[x] uvr_vk_rendering_end: %u color attachments exceeds the maximum of %u",
+                              uvrvk->colorAttachmentCount, UVR_VK_RENDERING_MAX_COLOR_ATTACHMENTS);
+    return -1;
+  }
+
+  dispatch->CmdEndRendering(uvrvk->vkCommandBuffer);
+
+  if (uvrvk->colorFinalLayout == VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL || !uvrvk->colorAttachmentCount)
+    return 0;
+
+  for (c = 0; c < uvrvk->colorAttachmentCount; c++) {
+    barriers[c].sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barriers[c].pNext = NULL;
+    barriers[c].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    barriers[c].dstAccessMask = (uvrvk->colorFinalLayout == VK_IMAGE_LAYOUT_PRESENT_SRC_KHR) ? 0 : VK_ACCESS_SHADER_READ_BIT;
+    barriers[c].oldLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    barriers[c].newLayout = uvrvk->colorFinalLayout;
+    barriers[c].srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barriers[c].dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barriers[c].image = uvrvk->pColorImages[c];
+    barriers[c].subresourceRange = (VkImageSubresourceRange) { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+  }
+
+  /* Presentation waits on a semaphore so no later stage needs to be blocked */
+  dispatch->CmdPipelineBarrier(uvrvk->vkCommandBuffer, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                               (uvrvk->colorFinalLayout == VK_IMAGE_LAYOUT_PRESENT_SRC_KHR) ? VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT :
+                                                                                             VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                               0, 0, NULL, 0, NULL, uvrvk->colorAttachmentCount, barriers);
+
+  return 0;
+}
+
+
+struct uvr_vk_command_buffer uvr_vk_command_buffer_create(struct uvr_vk_command_buffer_create_info *uvrvk) {
+  VkResult res = VK_RESULT_MAX_ENUM;
+  VkCommandPool cmdpool = VK_NULL_HANDLE;
+  VkCommandBuffer *cmdbuffs = VK_NULL_HANDLE;
+  struct uvr_vk_command_buffer_handle *cbuffs = NULL;
+
+  VkCommandPoolCreateInfo create_info = {};
+  create_info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+  create_info.pNext = NULL;
+  create_info.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+  create_info.queueFamilyIndex = uvrvk->queueFamilyIndex;
+
+  res = vkCreateCommandPool(uvrvk->vkDevice, &create_info, hostCallbacks, &cmdpool);
+  if (res) {
+    uvr_utils_log(UVR_DANGER, "[x] vkCreateCommandPool: %s", vkres_msg(res));
+    goto exit_vk_command_buffer;
+  }
+
+  uvr_utils_log(UVR_SUCCESS, "uvr_vk_command_buffer_create: VkCommandPool successfully created retval(%p)", cmdpool);
+
+  cmdbuffs = alloca(uvrvk->commandBufferCount * sizeof(VkCommandBuffer));
+
+  VkCommandBufferAllocateInfo alloc_info = {};
+  alloc_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+  alloc_info.commandPool = cmdpool;
+  alloc_info.level = uvrvk->level;
+  alloc_info.commandBufferCount = uvrvk->commandBufferCount;
+
+  res = vkAllocateCommandBuffers(uvrvk->vkDevice, &alloc_info, cmdbuffs);
+  if (res) {
+    uvr_utils_log(UVR_DANGER, "[x] vkAllocateCommandBuffers: %s", vkres_msg(res));
+    goto exit_vk_command_buffer_destroy_cmd_pool;
+  }
+
+  cbuffs = calloc(uvrvk->commandBufferCount, sizeof(struct uvr_vk_command_buffer_handle));
+  if (!cbuffs) {
+    uvr_utils_log(UVR_DANGER, "[x] calloc: %s", strerror(errno));
+    goto exit_vk_command_buffer_destroy_cmd_pool;
+  }
+
+  for (uint32_t i = 0; i < uvrvk->commandBufferCount; i++) {
+    cbuffs[i].buffer = cmdbuffs[i];
+    uvr_utils_log(UVR_WARNING, "uvr_vk_command_buffer_create: VkCommandBuffer successfully created retval(%p)", cbuffs[i].buffer);
+  }
+
+  return (struct uvr_vk_command_buffer) { .vkDevice = uvrvk->vkDevice, .vkCommandPool = cmdpool,
+                                          .commandBufferCount = uvrvk->commandBufferCount, .vkCommandbuffers = cbuffs };
+
+exit_vk_command_buffer_destroy_cmd_pool:
+  vkDestroyCommandPool(uvrvk->vkDevice, cmdpool, hostCallbacks);
+exit_vk_command_buffer:
+  return (struct uvr_vk_command_buffer) { .vkDevice = VK_NULL_HANDLE, .vkCommandPool = VK_NULL_HANDLE,
+                                          .commandBufferCount = 0, .vkCommandbuffers = NULL };
+}
+
+
+int uvr_vk_command_buffer_record_begin(struct uvr_vk_command_buffer_record_info *uvrvk) {
+  const struct uvr_vk_device_dispatch *dispatch = uvr_vk_device_dispatch_get(VK_NULL_HANDLE);
+  VkResult res = VK_RESULT_MAX_ENUM;
+
+  VkCommandBufferBeginInfo begin_info = {};
+  begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+  begin_info.pNext = NULL;
+  begin_info.flags = uvrvk->flags;
+  begin_info.pInheritanceInfo = uvrvk->pInheritanceInfo;
+
+  /* A secondary continuing a render pass can't record the query pool reset */
+  if (uvrvk->queryPool && uvrvk->pInheritanceInfo) {
+    uvr_utils_log(UVR_DANGER, "[x] uvr_vk_command_buffer_record_begin: queryPool can't be used with pInheritanceInfo");
+    return -1;
+  }
+
+  for (uint32_t i = 0; i < uvrvk->commandBufferCount; i++) {
+    res = dispatch->BeginCommandBuffer(uvrvk->vkCommandbuffers[i].buffer, &begin_info);
+    if (res) {
+      uvr_utils_log(UVR_DANGER, "[x] vkBeginCommandBuffer: %s", vkres_msg(res));
+      return -1;
+    }
+
+    if (uvrvk->queryPool) {
+      uvr_vk_query_pool_reset(uvrvk->queryPool, uvrvk->vkCommandbuffers[i].buffer);
+      uvr_vk_query_pool_scope_begin(uvrvk->queryPool, uvrvk->vkCommandbuffers[i].buffer, uvrvk->queryScopeName);
+    }
+  }
+
+  return 0;
+}
+
+
+int uvr_vk_command_buffer_record_end(struct uvr_vk_command_buffer_record_info *uvrvk) {
+  const struct uvr_vk_device_dispatch *dispatch = uvr_vk_device_dispatch_get(VK_NULL_HANDLE);
+  VkResult res = VK_RESULT_MAX_ENUM;
+
+  for (uint32_t i = 0; i < uvrvk->commandBufferCount; i++) {
+    /* End scopes left open innermost first, the last one is the scope record_begin opened */
+    for (uint32_t open = 0; uvrvk->queryPool; open++) {
+      if (uvr_vk_query_pool_scope_end(uvrvk->queryPool, uvrvk->vkCommandbuffers[i].buffer, -1) == -1) {
+        if (open > 1)
+          uvr_utils_log(UVR_WARNING, "uvr_vk_command_buffer_record_end: %u scope(s) left open, ended with the command buffer", open - 1);
+        break;
+      }
+    }
+
+    res = dispatch->EndCommandBuffer(uvrvk->vkCommandbuffers[i].buffer);
+    if (res) {
+      uvr_utils_log(UVR_DANGER, "[x] vkEndCommandBuffer: %s", vkres_msg(res));
+      return -1;
+    }
+  }
+
+  return 0;
+}
+
+
+struct uvr_vk_sync_obj uvr_vk_sync_obj_create(struct uvr_vk_sync_obj_create_info *uvrvk) {
+  VkResult res = VK_RESULT_MAX_ENUM;
+  struct uvr_vk_fence_handle *vkFences = NULL;
+  struct uvr_vk_semaphore_handle *vkSemaphores = NULL;
+  uint32_t s;
+
+  vkFences = calloc(uvrvk->fenceCount, sizeof(struct uvr_vk_fence_handle));
+  if (!vkFences) {
+    uvr_utils_log(UVR_DANGER, "[x] calloc: %s", strerror(errno));
+    goto exit_vk_sync_obj;
+  }
+
+  vkSemaphores = calloc(uvrvk->semaphoreCount, sizeof(struct uvr_vk_semaphore_handle));
+  if (!vkSemaphores) {
+    uvr_utils_log(UVR_DANGER, "[x] calloc: %s", strerror(errno));
+    goto exit_vk_sync_obj_free_vk_fence;
+  }
+
+  VkFenceCreateInfo fence_create_info = {};
+  fence_create_info.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+  fence_create_info.pNext = NULL;
+  fence_create_info.flags = VK_FENCE_CREATE_SIGNALED_BIT;
+
+  VkSemaphoreTypeCreateInfo semphore_type_create_info = {};
+  semphore_type_create_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+  semphore_type_create_info.pNext = NULL;
+  semphore_type_create_info.semaphoreType = uvrvk->semaphoreType;
+  semphore_type_create_info.initialValue = uvrvk->initialValue;
+
+  VkSemaphoreCreateInfo semphore_create_info = {};
+  semphore_create_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+  semphore_create_info.pNext = (uvrvk->semaphoreType == VK_SEMAPHORE_TYPE_TIMELINE) ? &semphore_type_create_info : NULL;
+  semphore_create_info.flags = 0;
+
+  for (s = 0; s < uvrvk->fenceCount; s++) {
+    res = vkCreateFence(uvrvk->vkDevice, &fence_create_info, hostCallbacks, &vkFences[s].fence);
+    if (res) {
+      uvr_utils_log(UVR_DANGER, "[x] vkCreateFence: %s", vkres_msg(res));
+      goto exit_vk_sync_obj_destroy_vk_fence;
+    }
+  }
+
+  for (s = 0; s < uvrvk->semaphoreCount; s++) {
+    res = vkCreateSemaphore(uvrvk->vkDevice, &semphore_create_info, hostCallbacks, &vkSemaphores[s].semaphore);
+    if (res) {
+      uvr_utils_log(UVR_DANGER, "[x] vkCreateSemaphore: %s", vkres_msg(res));
+      goto exit_vk_sync_obj_destroy_vk_semaphore;
+    }
+  }
+
+  return (struct uvr_vk_sync_obj) { .vkDevice = uvrvk->vkDevice, .fenceCount = uvrvk->fenceCount, .vkFences = vkFences,
+                                    .semaphoreCount = uvrvk->semaphoreCount, .vkSemaphores = vkSemaphores,
+                                    .semaphoreType = uvrvk->semaphoreType };
+
+
+exit_vk_sync_obj_destroy_vk_semaphore:
+  for (s = 0; s < uvrvk->semaphoreCount; s++)
+    if (vkSemaphores[s].semaphore)
+      vkDestroySemaphore(uvrvk->vkDevice, vkSemaphores[s].semaphore, hostCallbacks);
+exit_vk_sync_obj_destroy_vk_fence:
+  for (s = 0; s < uvrvk->fenceCount; s++)
+    if (vkFences[s].fence)
+      vkDestroyFence(uvrvk->vkDevice, vkFences[s].fence, hostCallbacks);
+//exit_vk_sync_obj_free_vk_semaphore:
+  free(vkSemaphores);
+exit_vk_sync_obj_free_vk_fence:
+  free(vkFences);
+exit_vk_sync_obj:
+  return (struct uvr_vk_sync_obj) { .vkDevice = VK_NULL_HANDLE, .fenceCount = 0, .vkFences = NULL, .semaphoreCount = 0, .vkSemaphores = NULL };
+};
+
+
+VkResult uvr_vk_timeline_semaphore_wait(struct uvr_vk_timeline_semaphore_wait_info *uvrvk) {
+  VkResult res = VK_RESULT_MAX_ENUM;
+
+  VkSemaphoreWaitInfo wait_info = {};
+  wait_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+  wait_info.pNext = NULL;
+  wait_info.flags = (uvrvk->waitAny) ? VK_SEMAPHORE_WAIT_ANY_BIT : 0;
+  wait_info.semaphoreCount = uvrvk->semaphoreCount;
+  wait_info.pSemaphores = uvrvk->pSemaphores;
+  wait_info.pValues = uvrvk->pValues;
+
+  res = vkWaitSemaphores(uvrvk->vkDevice, &wait_info, uvrvk->timeout);
+  if (res != VK_SUCCESS && res != VK_TIMEOUT)
+    uvr_utils_log(UVR_DANGER, "[x] vkWaitSemaphores: %s", vkres_msg(res));
+
+  return res;
+}
+
+
+int uvr_vk_timeline_semaphore_signal(VkDevice vkDevice, VkSemaphore vkSemaphore, uint64_t value) {
+  VkResult res = VK_RESULT_MAX_ENUM;
+
+  VkSemaphoreSignalInfo signal_info = {};
+  signal_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SIGNAL_INFO;
+  signal_info.pNext = NULL;
+  signal_info.semaphore = vkSemaphore;
+  signal_info.value = value;
+
+  res = uvr_vk_device_dispatch_get(vkDevice)->SignalSemaphore(vkDevice, &signal_info);
+  if (res) {
+    uvr_utils_log(UVR_DANGER, "[x] vkSignalSemaphore: %s", vkres_msg(res));
+    return -1;
+  }
+
+  return 0;
+}
+
+
+int uvr_vk_timeline_semaphore_get_value(VkDevice vkDevice, VkSemaphore vkSemaphore, uint64_t *value) {
+  VkResult res = VK_RESULT_MAX_ENUM;
+
+  res = uvr_vk_device_dispatch_get(vkDevice)->GetSemaphoreCounterValue(vkDevice, vkSemaphore, value);
+  if (res) {
+    uvr_utils_log(UVR_DANGER, "[x] vkGetSemaphoreCounterValue: %s", vkres_msg(res));
+    return -1;
+  }
+
+  return 0;
+}
+
+
+int uvr_vk_queue_submit(struct uvr_vk_queue_submit_info *uvrvk) {
+  const struct uvr_vk_device_dispatch *dispatch = uvr_vk_device_dispatch_get(VK_NULL_HANDLE);
+  VkResult res = VK_RESULT_MAX_ENUM;
+  VkSemaphore *waitSemaphores = NULL, *signalSemaphores = NULL;
+  uint64_t *waitValues = NULL, *signalValues = NULL;
+  VkPipelineStageFlags *waitStages = NULL;
+  uint32_t s;
+  int ret = -1;
+
+  /* Single allocation split into the parallel arrays VkSubmitInfo expects */
+  size_t waitSize = uvrvk->waitSemaphoreCount * (sizeof(VkSemaphore) + sizeof(uint64_t) + sizeof(VkPipelineStageFlags));
+  size_t signalSize = uvrvk->signalSemaphoreCount * (sizeof(VkSemaphore) + sizeof(uint64_t));
+  void *arrays = NULL;
+
+  if (waitSize + signalSize) {
+    arrays = calloc(1, waitSize + signalSize);
+    if (!arrays) {
+      uvr_utils_log(UVR_DANGER, "[x] calloc: %s", strerror(errno));
+      return -1;
+    }
+  }
+
+  waitValues = (uint64_t *) arrays;
+  signalValues = waitValues + uvrvk->waitSemaphoreCount;
+  waitSemaphores = (VkSemaphore *) (signalValues + uvrvk->signalSemaphoreCount);
+  signalSemaphores = waitSemaphores + uvrvk->waitSemaphoreCount;
+  waitStages = (VkPipelineStageFlags *) (signalSemaphores + uvrvk->signalSemaphoreCount);
+
+  for (s = 0; s < uvrvk->waitSemaphoreCount; s++) {
+    waitSemaphores[s] = uvrvk->pWaitSemaphores[s].semaphore;
+    waitValues[s] = uvrvk->pWaitSemaphores[s].value;
+    waitStages[s] = uvrvk->pWaitSemaphores[s].stageMask;
+  }
+
+  for (s = 0; s < uvrvk->signalSemaphoreCount; s++) {
+    signalSemaphores[s] = uvrvk->pSignalSemaphores[s].semaphore;
+    signalValues[s] = uvrvk->pSignalSemaphores[s].value;
+  }
+
+  VkTimelineSemaphoreSubmitInfo timeline_submit_info = {};
+  timeline_submit_info.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+  timeline_submit_info.pNext = NULL;
+  timeline_submit_info.waitSemaphoreValueCount = uvrvk->waitSemaphoreCount;
+  timeline_submit_info.pWaitSemaphoreValues = waitValues;
+  timeline_submit_info.signalSemaphoreValueCount = uvrvk->signalSemaphoreCount;
+  timeline_submit_info.pSignalSemaphoreValues = signalValues;
+
+  VkSubmitInfo submit_info = {};
+  submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+  submit_info.pNext = &timeline_submit_info;
+  submit_info.waitSemaphoreCount = uvrvk->waitSemaphoreCount;
+  submit_info.pWaitSemaphores = waitSemaphores;
+  submit_info.pWaitDstStageMask = waitStages;
+  submit_info.commandBufferCount = uvrvk->commandBufferCount;
+  submit_info.pCommandBuffers = uvrvk->pCommandBuffers;
+  submit_info.signalSemaphoreCount = uvrvk->signalSemaphoreCount;
+  submit_info.pSignalSemaphores = signalSemaphores;
+
+  res = dispatch->QueueSubmit(uvrvk->vkQueue, 1, &submit_info, uvrvk->vkFence);
+  if (res) {
+    uvr_utils_log(UVR_DANGER, "[x] vkQueueSubmit: %s", vkres_msg(res));
+    goto exit_vk_queue_submit;
+  }
+
+  ret = 0;
+
+exit_vk_queue_submit:
+  free(arrays);
+  return ret;
+}
+
+
+static void sync_obj_destroy(struct uvr_vk_sync_obj *syncs) {
+  VkFence *fences = NULL;
+  uint32_t s, fenceCount = 0;
+
+  /* struct uvr_vk_fence_handle only wraps a VkFence, gather the valid ones so they can be waited on at once */
+  if (syncs->fenceCount)
+    fences = calloc(syncs->fenceCount, sizeof(VkFence));
+
+  for (s = 0; s < syncs->fenceCount; s++) {
+    if (syncs->vkFences[s].fence) {
+      if (fences)
+        fences[fenceCount++] = syncs->vkFences[s].fence;
+      else
+        vkWaitForFences(syncs->vkDevice, 1, &syncs->vkFences[s].fence, VK_TRUE, UINT64_MAX);
+    }
+  }
+
+  if (fenceCount)
+    vkWaitForFences(syncs->vkDevice, fenceCount, fences, VK_TRUE, UINT64_MAX);
+
+  for (s = 0; s < syncs->fenceCount; s++) {
+    if (syncs->vkFences[s].fence)
+      vkDestroyFence(syncs->vkDevice, syncs->vkFences[s].fence, hostCallbacks);
+  }
+
+  free(fences);
+
+  /*
+   * Pending timeline signal values aren't tracked, there's no value to wait on.
+   * Idle the device so no queued work still references the semaphores.
+   */
+  if (syncs->semaphoreType == VK_SEMAPHORE_TYPE_TIMELINE && syncs->semaphoreCount && syncs->vkDevice)
+    vkDeviceWaitIdle(syncs->vkDevice);
+
+  for (s = 0; s < syncs->semaphoreCount; s++) {
+    if (syncs->vkSemaphores[s].semaphore) {
+      vkDestroySemaphore(syncs->vkDevice, syncs->vkSemaphores[s].semaphore, hostCallbacks);
+    }
+  }
+
+  free(syncs->vkFences);
+  free(syncs->vkSemaphores);
+}
+
+
+static void command_buffer_destroy(struct uvr_vk_command_buffer *cmdbuffs) {
+  if (cmdbuffs->vkDevice && cmdbuffs->vkCommandPool)
+    vkDestroyCommandPool(cmdbuffs->vkDevice, cmdbuffs->vkCommandPool, hostCallbacks);
+  free(cmdbuffs->vkCommandbuffers);
+}
+
+
+struct uvr_vk_swapchain_retired {
+  uint64_t                  frameNumber;
+  struct uvr_vk_swapchain   swapchain;
+  struct uvr_vk_image       images;
+  struct uvr_vk_framebuffer framebuffer;
+  struct uvr_vk_sync_obj    presentSyncs;
+};
+
+
+static void swapchain_retired_destroy(struct uvr_vk_swapchain_retired *retired) {
+  uint32_t i;
+
+  for (i = 0; i < retired->framebuffer.frameBufferCount; i++) {
+    if (retired->framebuffer.vkFrameBuffers[i].fb)
+      vkDestroyFramebuffer(retired->framebuffer.vkDevice, retired->framebuffer.vkFrameBuffers[i].fb, hostCallbacks);
+  }
+
+  for (i = 0; i < retired->images.imageCount; i++) {
+    if (retired->images.vkImageViews[i].view)
+      vkDestroyImageView(retired->images.vkDevice, retired->images.vkImageViews[i].view, hostCallbacks);
+  }
+
+  sync_obj_destroy(&retired->presentSyncs);
+
+  if (retired->swapchain.vkSwapchain)
+    vkDestroySwapchainKHR(retired->swapchain.vkDevice, retired->swapchain.vkSwapchain, hostCallbacks);
+
+  free(retired->framebuffer.vkFrameBuffers);
+  free(retired->images.vkImageViews);
+  free(retired->images.vkImages);
+}
+
+
+/*
+ * Destroys retired swapchains whose last frame completed. Acquire waits on the fence of the frame
+ * submitted @frameCount frames ago, so once @frameCount frames were presented after a swapchain
+ * got retired every frame that referenced it has signaled its fence.
+ */
+static void frame_ring_release_retired(struct uvr_vk_frame_ring *ring) {
+  uint32_t r = 0, kept = 0;
+
+  for (r = 0; r < ring->retiredCount; r++) {
+    if (ring->frameNumber >= ring->retired[r].frameNumber + ring->frameCount) {
+      swapchain_retired_destroy(&ring->retired[r]);
+      continue;
+    }
+
+    ring->retired[kept++] = ring->retired[r];
+  }
+
+  ring->retiredCount = kept;
+}
+
+
+struct uvr_vk_frame_ring uvr_vk_frame_ring_create(struct uvr_vk_frame_ring_create_info *uvrvk) {
+  VkResult res = VK_RESULT_MAX_ENUM;
+  struct uvr_vk_frame_ring ring;
+  uint32_t imageCount = 0;
+
+  memset(&ring, 0, sizeof(ring));
+
+  if (!uvrvk->frameCount) {
+    uvr_utils_log(UVR_DANGER, "[x] uvr_vk_frame_ring_create: frameCount must be greater than zero");
+    goto exit_vk_frame_ring;
+  }
+
+  res = vkGetSwapchainImagesKHR(uvrvk->vkDevice, uvrvk->vkSwapchain, &imageCount, NULL);
+  if (res) {
+    uvr_utils_log(UVR_DANGER, "[x] vkGetSwapchainImagesKHR: %s", vkres_msg(res));
+    goto exit_vk_frame_ring;
+  }
+
+  ring.imageFences = calloc(imageCount, sizeof(VkFence));
+  if (!ring.imageFences) {
+    uvr_utils_log(UVR_DANGER, "[x] calloc: %s", strerror(errno));
+    goto exit_vk_frame_ring;
+  }
+
+  struct uvr_vk_command_buffer_create_info cmdbuff_info;
+  cmdbuff_info.vkDevice = uvrvk->vkDevice;
+  cmdbuff_info.queueFamilyIndex = uvrvk->queueFamilyIndex;
+  cmdbuff_info.commandBufferCount = uvrvk->frameCount;
+  cmdbuff_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+
+  ring.vkCommandbuffs = uvr_vk_command_buffer_create(&cmdbuff_info);
+  if (!ring.vkCommandbuffs.vkCommandPool)
+    goto exit_vk_frame_ring_free_image_fences;
+
+  struct uvr_vk_sync_obj_create_info sync_info;
+  sync_info.vkDevice = uvrvk->vkDevice;
+  sync_info.fenceCount = uvrvk->frameCount;
+  sync_info.semaphoreCount = uvrvk->frameCount;
+  sync_info.semaphoreType = VK_SEMAPHORE_TYPE_BINARY;
+  sync_info.initialValue = 0;
+
+  ring.vkSyncs = uvr_vk_sync_obj_create(&sync_info);
+  if (!ring.vkSyncs.vkFences)
+    goto exit_vk_frame_ring_destroy_command_buffer;
+
+  sync_info.fenceCount = 0;
+  sync_info.semaphoreCount = imageCount;
+
+  ring.vkPresentSyncs = uvr_vk_sync_obj_create(&sync_info);
+  if (!ring.vkPresentSyncs.vkSemaphores)
+    goto exit_vk_frame_ring_destroy_sync_obj;
+
+  ring.vkDevice = uvrvk->vkDevice;
+  ring.dispatch = uvr_vk_device_dispatch_get(ring.vkDevice);
+  ring.vkQueue = uvrvk->vkQueue;
+  ring.vkSwapchain = uvrvk->vkSwapchain;
+  ring.frameCount = uvrvk->frameCount;
+  ring.imageCount = imageCount;
+
+  uvr_utils_log(UVR_SUCCESS, "uvr_vk_frame_ring_create: %u frames in flight across %u swapchain images", ring.frameCount, ring.imageCount);
+
+  return ring;
+
+exit_vk_frame_ring_destroy_sync_obj:
+  sync_obj_destroy(&ring.vkSyncs);
+exit_vk_frame_ring_destroy_command_buffer:
+  command_buffer_destroy(&ring.vkCommandbuffs);
+exit_vk_frame_ring_free_image_fences:
+  free(ring.imageFences);
+exit_vk_frame_ring:
+  return (struct uvr_vk_frame_ring) { .vkDevice = VK_NULL_HANDLE, .vkQueue = VK_NULL_HANDLE, .vkSwapchain = VK_NULL_HANDLE,
+                                      .imageFences = NULL };
+}
+
+
+VkResult uvr_vk_frame_ring_acquire(struct uvr_vk_frame_ring *ring, struct uvr_vk_frame *frame) {
+  VkResult res = VK_RESULT_MAX_ENUM;
+  struct timespec start, end;
+  uint64_t waitNs = 0;
+
+  VkFence frameFence = ring->vkSyncs.vkFences[ring->frameIndex].fence;
+  VkSemaphore acquireSemaphore = ring->vkSyncs.vkSemaphores[ring->frameIndex].semaphore;
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  ring->dispatch->WaitForFences(ring->vkDevice, 1, &frameFence, VK_TRUE, UINT64_MAX);
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  waitNs += timespec_diff_ns(&start, &end);
+
+  if (ring->retiredCount)
+    frame_ring_release_retired(ring);
+
+  res = ring->dispatch->AcquireNextImageKHR(ring->vkDevice, ring->vkSwapchain, UINT64_MAX, acquireSemaphore, VK_NULL_HANDLE, &ring->imageIndex);
+  if (res != VK_SUCCESS && res != VK_SUBOPTIMAL_KHR) {
+    if (res != VK_ERROR_OUT_OF_DATE_KHR)
+      uvr_utils_log(UVR_DANGER, "[x] vkAcquireNextImageKHR: %s", vkres_msg(res));
+    return res;
+  }
+
+  /* Another frame slot may still be rendering to this image */
+  if (ring->imageFences[ring->imageIndex] && ring->imageFences[ring->imageIndex] != frameFence) {
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    ring->dispatch->WaitForFences(ring->vkDevice, 1, &ring->imageFences[ring->imageIndex], VK_TRUE, UINT64_MAX);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    waitNs += timespec_diff_ns(&start, &end);
+  }
+
+  ring->imageFences[ring->imageIndex] = frameFence;
+
+  ring->cpuWaitNs = waitNs;
+  ring->cpuWaitTotalNs += waitNs;
+  if (waitNs > ring->cpuWaitMaxNs)
+    ring->cpuWaitMaxNs = waitNs;
+
+  frame->frameIndex = ring->frameIndex;
+  frame->imageIndex = ring->imageIndex;
+  frame->vkCommandBuffer = ring->vkCommandbuffs.vkCommandbuffers[ring->frameIndex].buffer;
+
+  return res;
+}
+
+
+/*
+ * A fence reset for a submission that then failed would never signal and the next wait on it would
+ * block forever. An empty submit signals it again once prior work on @vkQueue completed.
+ */
+static void fence_resignal(const struct uvr_vk_device_dispatch *dispatch, VkQueue vkQueue, VkFence vkFence) {
+  VkResult res = VK_RESULT_MAX_ENUM;
+
+  res = dispatch->QueueSubmit(vkQueue, 0, NULL, vkFence);
+  if (res)
+    uvr_utils_log(UVR_DANGER, "[x] vkQueueSubmit: %s", vkres_msg(res));
+}
+
+
+/*
+ * Consumes the current slot's acquire semaphore with an empty submit that also signals @frameFence, pass the slot's
+ * fence if it was reset or VK_NULL_HANDLE. Leaving the semaphore signaled would make the next vkAcquireNextImageKHR
+ * on this slot invalid.
+ */
+static void frame_ring_abandon(struct uvr_vk_frame_ring *ring, VkFence frameFence) {
+  VkResult res = VK_RESULT_MAX_ENUM;
+
+  VkSemaphore waitSemaphores[1] = { ring->vkSyncs.vkSemaphores[ring->frameIndex].semaphore };
+  VkPipelineStageFlags waitStages[1] = { VK_PIPELINE_STAGE_ALL_COMMANDS_BIT };
+
+  VkSubmitInfo submit_info = {};
+  submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+  submit_info.pNext = NULL;
+  submit_info.waitSemaphoreCount = ARRAY_LEN(waitSemaphores);
+  submit_info.pWaitSemaphores = waitSemaphores;
+  submit_info.pWaitDstStageMask = waitStages;
+  submit_info.commandBufferCount = 0;
+  submit_info.pCommandBuffers = NULL;
+  submit_info.signalSemaphoreCount = 0;
+  submit_info.pSignalSemaphores = NULL;
+
+  res = ring->dispatch->QueueSubmit(ring->vkQueue, 1, &submit_info, frameFence);
+  if (res) {
+    uvr_utils_log(UVR_DANGER, "[x] vkQueueSubmit: %s", vkres_msg(res));
+    if (frameFence)
+      fence_resignal(ring->dispatch, ring->vkQueue, frameFence);
+  }
+}
+
+
+/* Submits @pCommandBuffers in order for the current frame slot/acquired image */
+static int frame_ring_submit(struct uvr_vk_frame_ring *ring, uint32_t commandBufferCount, const VkCommandBuffer *pCommandBuffers) {
+  VkResult res = VK_RESULT_MAX_ENUM;
+
+  VkFence frameFence = ring->vkSyncs.vkFences[ring->frameIndex].fence;
+  VkSemaphore waitSemaphores[1] = { ring->vkSyncs.vkSemaphores[ring->frameIndex].semaphore };
+  VkSemaphore signalSemaphores[1] = { ring->vkPresentSyncs.vkSemaphores[ring->imageIndex].semaphore };
+  VkPipelineStageFlags waitStages[1] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
+
+  VkSubmitInfo submit_info = {};
+  submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+  submit_info.pNext = NULL;
+  submit_info.waitSemaphoreCount = ARRAY_LEN(waitSemaphores);
+  submit_info.pWaitSemaphores = waitSemaphores;
+  submit_info.pWaitDstStageMask = waitStages;
+  submit_info.commandBufferCount = commandBufferCount;
+  submit_info.pCommandBuffers = pCommandBuffers;
+  submit_info.signalSemaphoreCount = ARRAY_LEN(signalSemaphores);
+  submit_info.pSignalSemaphores = signalSemaphores;
+
+  res = ring->dispatch->ResetFences(ring->vkDevice, 1, &frameFence);
+  if (res) {
+    uvr_utils_log(UVR_DANGER, "[x] vkResetFences: %s", vkres_msg(res));
+    frame_ring_abandon(ring, VK_NULL_HANDLE);
+    return -1;
+  }
+
+  /* Fence was reset, leaving it unsignaled on failure would deadlock the next acquire of this slot */
+  res = ring->dispatch->QueueSubmit(ring->vkQueue, 1, &submit_info, frameFence);
+  if (res) {
+    uvr_utils_log(UVR_DANGER, "[x] vkQueueSubmit: %s", vkres_msg(res));
+    frame_ring_abandon(ring, frameFence);
+    return -1;
+  }
+
+  return 0;
+}
+
+
+int uvr_vk_frame_ring_submit(struct uvr_vk_frame_ring *ring) {
+  return frame_ring_submit(ring, 1, &ring->vkCommandbuffs.vkCommandbuffers[ring->frameIndex].buffer);
+}
+
+
+int uvr_vk_frame_ring_abandon(struct uvr_vk_frame_ring *ring) {
+  VkResult res = VK_RESULT_MAX_ENUM;
+
+  VkFence frameFence = ring->vkSyncs.vkFences[ring->frameIndex].fence;
+
+  res = ring->dispatch->ResetFences(ring->vkDevice, 1, &frameFence);
+  if (res) {
+    uvr_utils_log(UVR_DANGER, "[x] vkResetFences: %s", vkres_msg(res));
+    frame_ring_abandon(ring, VK_NULL_HANDLE);
+    return -1;
+  }
+
+  frame_ring_abandon(ring, frameFence);
+
+  return 0;
+}
+
+
+VkResult uvr_vk_frame_ring_present(struct uvr_vk_frame_ring *ring) {
+  VkResult res = VK_RESULT_MAX_ENUM;
+
+  VkSemaphore waitSemaphores[1] = { ring->vkPresentSyncs.vkSemaphores[ring->imageIndex].semaphore };
+
+  VkPresentInfoKHR present_info = {};
+  present_info.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+  present_info.pNext = NULL;
+  present_info.waitSemaphoreCount = ARRAY_LEN(waitSemaphores);
+  present_info.pWaitSemaphores = waitSemaphores;
+  present_info.swapchainCount = 1;
+  present_info.pSwapchains = &ring->vkSwapchain;
+  present_info.pImageIndices = &ring->imageIndex;
+  present_info.pResults = NULL;
+
+  res = ring->dispatch->QueuePresentKHR(ring->vkQueue, &present_info);
+  if (res != VK_SUCCESS && res != VK_SUBOPTIMAL_KHR && res != VK_ERROR_OUT_OF_DATE_KHR)
+    uvr_utils_log(UVR_DANGER, "[x] vkQueuePresentKHR: %s", vkres_msg(res));
+
+  if (ring->resizePending && (res == VK_SUCCESS || res == VK_SUBOPTIMAL_KHR)) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    ring->resizePending = false;
+    ring->resizeLatencyNs = timespec_diff_ns(&ring->resizeStart, &now);
+    if (ring->resizeLatencyNs > ring->resizeLatencyMaxNs)
+      ring->resizeLatencyMaxNs = ring->resizeLatencyNs;
+
+    uvr_utils_log(UVR_INFO, "uvr_vk_frame_ring_present: first frame after resize presented in %.3f ms",
+                            ring->resizeLatencyNs / 1000000.0);
+  }
+
+  ring->frameIndex = (ring->frameIndex + 1) % ring->frameCount;
+  ring->frameNumber++;
+
+  return res;
+}
+
+
+int uvr_vk_swapchain_recreate(struct uvr_vk_swapchain_recreate_info *uvrvk) {
+  struct uvr_vk_frame_ring *ring = uvrvk->frameRing;
+  struct uvr_vk_swapchain_retired *retired = NULL;
+  struct uvr_vk_swapchain swapchain;
+  struct uvr_vk_image images;
+  struct uvr_vk_framebuffer framebuffer;
+  struct uvr_vk_sync_obj presentSyncs;
+  VkFence *imageFences = NULL;
+  int changes = 0;
+  uint32_t i;
+
+  memset(&framebuffer, 0, sizeof(framebuffer));
+
+  if (uvrvk->pConfigureTime)
+    ring->resizeStart = *uvrvk->pConfigureTime;
+  else
+    clock_gettime(CLOCK_MONOTONIC, &ring->resizeStart);
+
+  retired = realloc(ring->retired, (ring->retiredCount + 1) * sizeof(struct uvr_vk_swapchain_retired));
+  if (!retired) {
+    uvr_utils_log(UVR_DANGER, "[x] realloc: %s", strerror(errno));
+    return -1;
+  }
+
+  ring->retired = retired;
+
+  uvrvk->swapchainCreateInfo->oldSwapchain = uvrvk->swapchain->vkSwapchain;
+  swapchain = uvr_vk_swapchain_create(uvrvk->swapchainCreateInfo);
+  if (!swapchain.vkSwapchain)
+    return -1;
+
+  uvrvk->imageCreateInfo->vkSwapchain = swapchain.vkSwapchain;
+  uvrvk->imageCreateInfo->format = swapchain.surfaceFormat.format;
+  images = uvr_vk_image_create(uvrvk->imageCreateInfo);
+  if (!images.vkImageViews)
+    goto exit_vk_swapchain_recreate_destroy_swapchain;
+
+  if (uvrvk->framebuffer) {
+    struct uvr_vk_framebuffer_create_info framebuffer_info;
+    framebuffer_info.vkDevice = swapchain.vkDevice;
+    framebuffer_info.frameBufferCount = images.imageCount;
+    framebuffer_info.vkImageViews = images.vkImageViews;
+    framebuffer_info.renderPass = uvrvk->renderPass;
+    framebuffer_info.width = swapchain.extent2D.width;
+    framebuffer_info.height = swapchain.extent2D.height;
+    framebuffer_info.layers = 1;
+
+    framebuffer = uvr_vk_framebuffer_create(&framebuffer_info);
+    if (!framebuffer.vkFrameBuffers)
+      goto exit_vk_swapchain_recreate_destroy_images;
+  }
+
+  /* Old present semaphores may still be waited on by the presentation engine, never reuse them */
+  struct uvr_vk_sync_obj_create_info sync_info;
+  sync_info.vkDevice = swapchain.vkDevice;
+  sync_info.fenceCount = 0;
+  sync_info.semaphoreCount = images.imageCount;
+  sync_info.semaphoreType = VK_SEMAPHORE_TYPE_BINARY;
+  sync_info.initialValue = 0;
+
+  presentSyncs = uvr_vk_sync_obj_create(&sync_info);
+  if (!presentSyncs.vkSemaphores)
+    goto exit_vk_swapchain_recreate_destroy_framebuffer;
+
+  imageFences = calloc(images.imageCount, sizeof(VkFence));
+  if (!imageFences) {
+    uvr_utils_log(UVR_DANGER, "[x] calloc: %s", strerror(errno));
+    goto exit_vk_swapchain_recreate_destroy_present_syncs;
+  }
+
+  if (swapchain.extent2D.width != uvrvk->swapchain->extent2D.width || swapchain.extent2D.height != uvrvk->swapchain->extent2D.height)
+    changes |= UVR_VK_SWAPCHAIN_EXTENT_CHANGED;
+  if (swapchain.surfaceFormat.format != uvrvk->swapchain->surfaceFormat.format ||
+      swapchain.surfaceFormat.colorSpace != uvrvk->swapchain->surfaceFormat.colorSpace)
+    changes |= UVR_VK_SWAPCHAIN_FORMAT_CHANGED;
+  if (images.imageCount != uvrvk->images->imageCount)
+    changes |= UVR_VK_SWAPCHAIN_COUNT_CHANGED;
+
+  retired = &ring->retired[ring->retiredCount++];
+  retired->frameNumber = ring->frameNumber;
+  retired->swapchain = *uvrvk->swapchain;
+  retired->images = *uvrvk->images;
+  retired->presentSyncs = ring->vkPresentSyncs;
+  if (uvrvk->framebuffer)
+    retired->framebuffer = *uvrvk->framebuffer;
+  else
+    memset(&retired->framebuffer, 0, sizeof(retired->framebuffer));
+
+  *uvrvk->swapchain = swapchain;
+  *uvrvk->images = images;
+  if (uvrvk->framebuffer)
+    *uvrvk->framebuffer = framebuffer;
+
+  free(ring->imageFences);
+  ring->imageFences = imageFences;
+  ring->vkPresentSyncs = presentSyncs;
+  ring->vkSwapchain = swapchain.vkSwapchain;
+  ring->imageCount = images.imageCount;
+  ring->resizePending = true;
+  ring->resizeCount++;
+
+  uvr_utils_log(UVR_SUCCESS, "uvr_vk_swapchain_recreate: %ux%u, %u images, %u swapchains awaiting retirement",
+                             swapchain.extent2D.width, swapchain.extent2D.height, images.imageCount, ring->retiredCount);
+
+  return changes;
+
+exit_vk_swapchain_recreate_destroy_present_syncs:
+  sync_obj_destroy(&presentSyncs);
+exit_vk_swapchain_recreate_destroy_framebuffer:
+  if (framebuffer.vkFrameBuffers) {
+    for (i = 0; i < framebuffer.frameBufferCount; i++)
+      vkDestroyFramebuffer(framebuffer.vkDevice, framebuffer.vkFrameBuffers[i].fb, hostCallbacks);
+    free(framebuffer.vkFrameBuffers);
+  }
+exit_vk_swapchain_recreate_destroy_images:
+  for (i = 0; i < images.imageCount; i++)
+    vkDestroyImageView(images.vkDevice, images.vkImageViews[i].view, hostCallbacks);
+  free(images.vkImageViews);
+  free(images.vkImages);
+exit_vk_swapchain_recreate_destroy_swapchain:
+  /* Old swapchain was retired by vkCreateSwapchainKHR, it can't be presented to anymore either way */
+  vkDestroySwapchainKHR(swapchain.vkDevice, swapchain.vkSwapchain, hostCallbacks);
+  return -1;
+}
+
+
+/*
+ * Per swapchain image command buffer. @deps is what the buffer was begun against, only trusted once
+ * @recorded is set by a successful vkEndCommandBuffer. @frameIndex/@frameNumber identify the last
+ * frame that submitted the buffer.
+ */
+struct uvr_vk_command_replay_image {
+  VkCommandBuffer                   vkCommandBuffer;
+  bool                              recording;
+  bool                              recorded;
+  bool                              submitted;
+  uint32_t                          frameIndex;
+  uint64_t                          frameNumber;
+  struct uvr_vk_command_replay_deps deps;
+};
+
+
+struct uvr_vk_command_replay uvr_vk_command_replay_create(struct uvr_vk_command_replay_create_info *uvrvk) {
+  VkResult res = VK_RESULT_MAX_ENUM;
+  struct uvr_vk_command_replay replay;
+
+  memset(&replay, 0, sizeof(replay));
+
+  if (!uvrvk->imageCount) {
+    uvr_utils_log(UVR_DANGER, "[x] uvr_vk_command_replay_create: imageCount must be greater than zero");
+    goto exit_vk_command_replay;
+  }
+
+  /* Scope begins and ends in different command buffers, only timestamps may do that */
+  if (uvrvk->queryPool && uvrvk->queryPool->vkStatisticsPool) {
+    uvr_utils_log(UVR_DANGER, "[x] uvr_vk_command_replay_create: queryPool must be created without pipeline statistics");
+    goto exit_vk_command_replay;
+  }
+
+  replay.images = calloc(uvrvk->imageCount, sizeof(struct uvr_vk_command_replay_image));
+  if (!replay.images) {
+    uvr_utils_log(UVR_DANGER, "[x] calloc: %s", strerror(errno));
+    goto exit_vk_command_replay;
+  }
+
+  /* Buffers are long lived, vkBeginCommandBuffer implicitly resets one when it's re-recorded */
+  VkCommandPoolCreateInfo create_info = {};
+  create_info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+  create_info.pNext = NULL;
+  create_info.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+  create_info.queueFamilyIndex = uvrvk->queueFamilyIndex;
+
+  res = vkCreateCommandPool(uvrvk->vkDevice, &create_info, hostCallbacks, &replay.vkCommandPool);
+  if (res) {
+    uvr_utils_log(UVR_DANGER, "[x] vkCreateCommandPool: %s", vkres_msg(res));
+    goto exit_vk_command_replay_free_images;
+  }
+
+  replay.vkDevice = uvrvk->vkDevice;
+  replay.dispatch = uvr_vk_device_dispatch_get(replay.vkDevice);
+  replay.imageCount = uvrvk->imageCount;
+  replay.queryPool = uvrvk->queryPool;
+  replay.queryScopeName = uvrvk->queryScopeName;
+
+  uvr_utils_log(UVR_SUCCESS, "uvr_vk_command_replay_create: VkCommandPool successfully created retval(%p)", replay.vkCommandPool);
+
+  return replay;
+
+exit_vk_command_replay_free_images:
+  free(replay.images);
+exit_vk_command_replay:
+  return (struct uvr_vk_command_replay) { .vkDevice = VK_NULL_HANDLE, .vkCommandPool = VK_NULL_HANDLE, .images = NULL };
+}
+
+
+/* Swapchain was recreated with more images than the replay was created for */
+static int command_replay_grow(struct uvr_vk_command_replay *replay, uint32_t imageCount) {
+  struct uvr_vk_command_replay_image *images = NULL;
+
+  images = realloc(replay->images, imageCount * sizeof(struct uvr_vk_command_replay_image));
+  if (!images) {
+    uvr_utils_log(UVR_DANGER, "[x] realloc: %s", strerror(errno));
+    return -1;
+  }
+
+  memset(&images[replay->imageCount], 0, (imageCount - replay->imageCount) * sizeof(struct uvr_vk_command_replay_image));
+
+  replay->images = images;
+  replay->imageCount = imageCount;
+
+  return 0;
+}
+
+
+static uint32_t command_replay_deps_changed(struct uvr_vk_command_replay_image *image,
+                                            const struct uvr_vk_command_replay_deps *deps) {
+  uint32_t changed = 0;
+
+  if (!image->recorded)
+    return UVR_VK_COMMAND_REPLAY_DEP_INVALIDATED;
+
+  if (image->deps.framebuffer != deps->framebuffer || image->deps.imageView != deps->imageView)
+    changed |= UVR_VK_COMMAND_REPLAY_DEP_FRAMEBUFFER;
+
+  if (image->deps.pipeline != deps->pipeline)
+    changed |= UVR_VK_COMMAND_REPLAY_DEP_PIPELINE;
+
+  if (image->deps.extent.width != deps->extent.width || image->deps.extent.height != deps->extent.height)
+    changed |= UVR_VK_COMMAND_REPLAY_DEP_EXTENT;
+
+  if (image->deps.resourceKey != deps->resourceKey)
+    changed |= UVR_VK_COMMAND_REPLAY_DEP_RESOURCES;
+
+  return changed;
+}
+
+
+int uvr_vk_command_replay_acquire(struct uvr_vk_command_replay *replay, struct uvr_vk_frame_ring *ring,
+                                  const struct uvr_vk_command_replay_deps *deps,
+                                  struct uvr_vk_command_replay_frame *frame) {
+  struct uvr_vk_command_replay_image *image = NULL;
+  VkResult res = VK_RESULT_MAX_ENUM;
+  uint32_t changed = 0, d;
+
+  clock_gettime(CLOCK_MONOTONIC, &replay->frameStart);
+
+  if (ring->imageIndex >= replay->imageCount) {
+    if (command_replay_grow(replay, (ring->imageCount > ring->imageIndex) ? ring->imageCount : ring->imageIndex + 1) == -1)
+      return -1;
+  }
+
+  image = &replay->images[ring->imageIndex];
+
+  /*
+   * Acquire waited on the fence of the frame submitted @frameCount frames ago, anything older completed.
+   * A newer submission of this buffer is only left pending if a swapchain recreation reset the ring's
+   * image fences, wait on the frame slot fence it was submitted with. That slot hasn't been reused since.
+   */
+  if (image->submitted && ring->frameNumber < image->frameNumber + ring->frameCount) {
+    ring->dispatch->WaitForFences(ring->vkDevice, 1, &ring->vkSyncs.vkFences[image->frameIndex].fence, VK_TRUE, UINT64_MAX);
+    image->submitted = false;
+  }
+
+  changed = command_replay_deps_changed(image, deps);
+
+  frame->imageIndex = ring->imageIndex;
+  frame->vkCommandBuffer = image->vkCommandBuffer;
+  frame->changed = changed;
+
+  if (!changed)
+    return 0;
+
+  if (!image->vkCommandBuffer) {
+    VkCommandBufferAllocateInfo alloc_info = {};
+    alloc_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    alloc_info.commandPool = replay->vkCommandPool;
+    alloc_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    alloc_info.commandBufferCount = 1;
+
+    res = vkAllocateCommandBuffers(replay->vkDevice, &alloc_info, &image->vkCommandBuffer);
+    if (res) {
+      uvr_utils_log(UVR_DANGER, "[x] vkAllocateCommandBuffers: %s", vkres_msg(res));
+      image->vkCommandBuffer = VK_NULL_HANDLE;
+      return -1;
+    }
+
+    frame->vkCommandBuffer = image->vkCommandBuffer;
+  }
+
+  /* Previous recording was abandoned without a submit, vkBeginCommandBuffer requires the initial state */
+  if (image->recording)
+    replay->dispatch->ResetCommandBuffer(image->vkCommandBuffer, 0);
+
+  image->recorded = false;
+
+  /* No VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT, the buffer is resubmitted until its dependencies change */
+  VkCommandBufferBeginInfo begin_info = {};
+  begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+  begin_info.pNext = NULL;
+  begin_info.flags = 0;
+  begin_info.pInheritanceInfo = NULL;
+
+  res = replay->dispatch->BeginCommandBuffer(image->vkCommandBuffer, &begin_info);
+  if (res) {
+    uvr_utils_log(UVR_DANGER, "[x] vkBeginCommandBuffer: %s", vkres_msg(res));
+    return -1;
+  }
+
+  image->recording = true;
+  image->deps = *deps;
+
+  for (d = 0; d < UVR_VK_COMMAND_REPLAY_DEP_COUNT; d++) {
+    if (changed & (1u << d))
+      replay->changeCounts[d]++;
+  }
+
+  return 0;
+}
+
+
+/*
+ * Records the current frame slot's pair of query buffers. The first resets the pool's frame slot and begins
+ * the scope, the second ends it, so the replayed buffer in between never references a query. Acquire waited
+ * on the slot's fence, the pair's last submission completed.
+ */
+static int command_replay_query_record(struct uvr_vk_command_replay *replay, struct uvr_vk_frame_ring *ring) {
+  VkCommandBuffer *buffers = NULL;
+  VkResult res = VK_RESULT_MAX_ENUM;
+  uint32_t b;
+  int scopeId = -1;
+
+  if (replay->queryBufferCount < 2 * ring->frameCount) {
+    buffers = realloc(replay->vkQueryBuffers, 2 * ring->frameCount * sizeof(VkCommandBuffer));
+    if (!buffers) {
+      uvr_utils_log(UVR_DANGER, "[x] realloc: %s", strerror(errno));
+      return -1;
+    }
+
+    replay->vkQueryBuffers = buffers;
+
+    VkCommandBufferAllocateInfo alloc_info = {};
+    alloc_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    alloc_info.commandPool = replay->vkCommandPool;
+    alloc_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    alloc_info.commandBufferCount = 2 * ring->frameCount - replay->queryBufferCount;
+
+    res = vkAllocateCommandBuffers(replay->vkDevice, &alloc_info, &replay->vkQueryBuffers[replay->queryBufferCount]);
+    if (res) {
+      uvr_utils_log(UVR_DANGER, "[x] vkAllocateCommandBuffers: %s", vkres_msg(res));
+      return -1;
+    }
+
+    replay->queryBufferCount = 2 * ring->frameCount;
+  }
+
+  VkCommandBufferBeginInfo begin_info = {};
+  begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+  begin_info.pNext = NULL;
+  begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+  begin_info.pInheritanceInfo = NULL;
+
+  buffers = &replay->vkQueryBuffers[2 * ring->frameIndex];
+
+  for (b = 0; b < 2; b++) {
+    res = replay->dispatch->BeginCommandBuffer(buffers[b], &begin_info);
+    if (res) {
+      uvr_utils_log(UVR_DANGER, "[x] vkBeginCommandBuffer: %s", vkres_msg(res));
+      goto exit_command_replay_query_record_reset;
+    }
+  }
+
+  uvr_vk_query_pool_reset(replay->queryPool, buffers[0]);
+  scopeId = uvr_vk_query_pool_scope_begin(replay->queryPool, buffers[0], replay->queryScopeName);
+  if (scopeId != -1)
+    uvr_vk_query_pool_scope_end(replay->queryPool, buffers[1], scopeId);
+
+  for (b = 0; b < 2; b++) {
+    res = replay->dispatch->EndCommandBuffer(buffers[b]);
+    if (res) {
+      uvr_utils_log(UVR_DANGER, "[x] vkEndCommandBuffer: %s", vkres_msg(res));
+      goto exit_command_replay_query_record_reset;
+    }
+  }
+
+  return 0;
+
+exit_command_replay_query_record_reset:
+  /* Next frame on this slot begins them again, they must not be left recording */
+  for (b = 0; b < 2; b++)
+    replay->dispatch->ResetCommandBuffer(buffers[b], 0);
+  return -1;
+}
+
+
+int uvr_vk_command_replay_submit(struct uvr_vk_command_replay *replay, struct uvr_vk_frame_ring *ring,
+                                 struct uvr_vk_command_replay_frame *frame) {
+  struct uvr_vk_command_replay_image *image = &replay->images[frame->imageIndex];
+  VkResult res = VK_RESULT_MAX_ENUM;
+  VkCommandBuffer buffers[3];
+  uint32_t bufferCount = 0;
+  struct timespec end;
+  uint64_t cpuNs = 0;
+
+  if (frame->changed) {
+    image->recording = false;
+
+    res = replay->dispatch->EndCommandBuffer(frame->vkCommandBuffer);
+    if (res) {
+      uvr_utils_log(UVR_DANGER, "[x] vkEndCommandBuffer: %s", vkres_msg(res));
+      uvr_vk_frame_ring_abandon(ring);
+      return -1;
+    }
+
+    image->recorded = true;
+  }
+
+  /* A timing failure shouldn't cost the frame, submit it untimed */
+  if (replay->queryPool && command_replay_query_record(replay, ring) == 0) {
+    buffers[bufferCount++] = replay->vkQueryBuffers[2 * ring->frameIndex];
+    buffers[bufferCount++] = frame->vkCommandBuffer;
+    buffers[bufferCount++] = replay->vkQueryBuffers[2 * ring->frameIndex + 1];
+  } else {
+    buffers[bufferCount++] = frame->vkCommandBuffer;
+  }
+
+  if (frame_ring_submit(ring, bufferCount, buffers) == -1)
+    return -1;
+
+  image->submitted = true;
+  image->frameIndex = ring->frameIndex;
+  image->frameNumber = ring->frameNumber;
+
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  cpuNs = timespec_diff_ns(&replay->frameStart, &end);
+
+  replay->frameCount++;
+  if (frame->changed) {
+    replay->recordCount++;
+    replay->recordCpuNs += cpuNs;
+  } else {
+    replay->replayCpuNs += cpuNs;
+  }
+
+  if (cpuNs > replay->cpuMaxNs)
+    replay->cpuMaxNs = cpuNs;
+
+  return 0;
+}
+
+
+void uvr_vk_command_replay_invalidate(struct uvr_vk_command_replay *replay, uint32_t imageIndex) {
+  uint32_t i;
+
+  for (i = 0; i < replay->imageCount; i++) {
+    if (imageIndex != UVR_VK_COMMAND_REPLAY_ALL_IMAGES && i != imageIndex)
+      continue;
+
+    if (replay->images[i].recorded)
+      replay->invalidateCount++;
+    replay->images[i].recorded = false;
+  }
+}
+
+
+struct uvr_vk_command_replay_stats uvr_vk_command_replay_get_stats(struct uvr_vk_command_replay *replay) {
+  struct uvr_vk_command_replay_stats stats;
+
+  memset(&stats, 0, sizeof(stats));
+
+  stats.frameCount = replay->frameCount;
+  stats.recordCount = replay->recordCount;
+  stats.replayCount = replay->frameCount - replay->recordCount;
+  stats.framebufferCount = replay->changeCounts[0];
+  stats.pipelineCount = replay->changeCounts[1];
+  stats.extentCount = replay->changeCounts[2];
+  stats.resourceCount = replay->changeCounts[3];
+  stats.invalidateCount = replay->invalidateCount;
+  stats.cpuMaxMs = (double) replay->cpuMaxNs / 1000000.0;
+  if (stats.recordCount)
+    stats.recordCpuMs = (double) replay->recordCpuNs / stats.recordCount / 1000000.0;
+  if (stats.replayCount)
+    stats.replayCpuMs = (double) replay->replayCpuNs / stats.replayCount / 1000000.0;
+
+  return stats;
+}
+
+
+/* Size in bytes of one texel of the uncompressed color formats headless targets read back and textures upload */
+static uint32_t format_texel_size(VkFormat format) {
+  switch (format) {
+    case VK_FORMAT_R8_UNORM:
+    case VK_FORMAT_R8_SRGB:
+      return 1;
+    case VK_FORMAT_R8G8_UNORM:
+    case VK_FORMAT_R16_SFLOAT:
+      return 2;
+    case VK_FORMAT_R8G8B8A8_UNORM:
+    case VK_FORMAT_R8G8B8A8_SRGB:
+    case VK_FORMAT_B8G8R8A8_UNORM:
+    case VK_FORMAT_B8G8R8A8_SRGB:
+    case VK_FORMAT_A2R10G10B10_UNORM_PACK32:
+    case VK_FORMAT_A2B10G10R10_UNORM_PACK32:
+    case VK_FORMAT_R32_SFLOAT:
+      return 4;
+    case VK_FORMAT_R16G16B16A16_UNORM:
+    case VK_FORMAT_R16G16B16A16_SFLOAT:
+      return 8;
+    case VK_FORMAT_R32G32B32A32_SFLOAT:
+      return 16;
+    default:
+      return 0;
+  }
+}
+
+
+struct uvr_vk_headless_target uvr_vk_headless_target_create(struct uvr_vk_headless_target_create_info *uvrvk) {
+  struct uvr_vk_headless_target target;
+  VkMemoryPropertyFlags readbackFlags;
+  uint32_t i, texelSize = 0;
+
+  memset(&target, 0, sizeof(target));
+
+  if (!uvrvk->allocator || !uvrvk->allocator->vkDevice) {
+    uvr_utils_log(UVR_DANGER, "[x] uvr_vk_headless_target_create: struct uvr_vk_allocator not instantiated");
+    goto exit_vk_headless_target;
+  }
+
+  if (!uvrvk->frameCount || !uvrvk->extent2D.width || !uvrvk->extent2D.height) {
+    uvr_utils_log(UVR_DANGER, "[x] uvr_vk_headless_target_create: frameCount and extent2D must be greater than zero");
+    goto exit_vk_headless_target;
+  }
+
+  if (uvrvk->readbackInterval) {
+    texelSize = format_texel_size(uvrvk->format);
+    if (!texelSize) {
+      uvr_utils_log(UVR_DANGER, "[x] uvr_vk_headless_target_create: VkFormat %d can't be read back", uvrvk->format);
+      goto exit_vk_headless_target;
+    }
+
+    if (!uvrvk->readback) {
+      uvr_utils_log(UVR_DANGER, "[x] uvr_vk_headless_target_create: readbackInterval set without a readback callback");
+      goto exit_vk_headless_target;
+    }
+  }
+
+  target.vkDevice = uvrvk->allocator->vkDevice;
+  target.dispatch = uvr_vk_device_dispatch_get(target.vkDevice);
+
+  struct uvr_vk_image_create2_info image_info;
+  image_info.allocator = uvrvk->allocator;
+  image_info.memoryPropertyFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+  image_info.mode = UVR_VK_ALLOCATION_DEDICATED;
+  image_info.imageCount = uvrvk->frameCount;
+  image_info.imageFlags = 0;
+  image_info.imageType = VK_IMAGE_TYPE_2D;
+  image_info.imageFormat = uvrvk->format;
+  image_info.imageExtent3D = (VkExtent3D) { uvrvk->extent2D.width, uvrvk->extent2D.height, 1 };
+  image_info.imageMipLevels = 1;
+  image_info.imageArrayLayers = 1;
+  image_info.imageSamples = VK_SAMPLE_COUNT_1_BIT;
+  image_info.imageTiling = VK_IMAGE_TILING_OPTIMAL;
+  image_info.imageUsage = uvrvk->imageUsage | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+  image_info.imageSharingMode = VK_SHARING_MODE_EXCLUSIVE;
+  image_info.queueFamilyIndexCount = 0;
+  image_info.pQueueFamilyIndices = NULL;
+  image_info.imageInitialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+  image_info.imageViewFlags = 0;
+  image_info.imageViewType = VK_IMAGE_VIEW_TYPE_2D;
+  image_info.imageViewComponents.r = VK_COMPONENT_SWIZZLE_IDENTITY;
+  image_info.imageViewComponents.g = VK_COMPONENT_SWIZZLE_IDENTITY;
+  image_info.imageViewComponents.b = VK_COMPONENT_SWIZZLE_IDENTITY;
+  image_info.imageViewComponents.a = VK_COMPONENT_SWIZZLE_IDENTITY;
+  image_info.imageViewSubresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+  image_info.imageViewSubresourceRange.baseMipLevel = 0;
+  image_info.imageViewSubresourceRange.levelCount = 1;
+  image_info.imageViewSubresourceRange.baseArrayLayer = 0;
+  image_info.imageViewSubresourceRange.layerCount = 1;
+
+  target.images = uvr_vk_image_create2(&image_info);
+  if (!target.images.vkImages)
+    goto exit_vk_headless_target;
+
+  if (uvrvk->readbackInterval) {
+    target.rowPitch = uvrvk->extent2D.width * texelSize;
+    target.readbackSize = (VkDeviceSize) target.rowPitch * uvrvk->extent2D.height;
+
+    /* Host reads of uncached memory are painfully slow, use cached memory whenever the device exposes it */
+    readbackFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+    if (find_memory_type(uvrvk->allocator, UINT32_MAX, readbackFlags | VK_MEMORY_PROPERTY_HOST_CACHED_BIT) != -1)
+      readbackFlags |= VK_MEMORY_PROPERTY_HOST_CACHED_BIT;
+
+    struct uvr_vk_buffer_create_info buffer_info;
+    buffer_info.allocator = uvrvk->allocator;
+    buffer_info.memoryPropertyFlags = readbackFlags;
+    buffer_info.mode = UVR_VK_ALLOCATION_DEDICATED;
+    buffer_info.bufferFlags = 0;
+    buffer_info.bufferSize = target.readbackSize * uvrvk->frameCount;
+    buffer_info.bufferUsage = VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+    buffer_info.bufferSharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    buffer_info.queueFamilyIndexCount = 0;
+    buffer_info.pQueueFamilyIndices = NULL;
+
+    target.readbackBuffer = uvr_vk_buffer_create(&buffer_info);
+    if (!target.readbackBuffer.vkBuffer)
+      goto exit_vk_headless_target_destroy_images;
+
+    if (!target.readbackBuffer.allocation.pMapped) {
+      uvr_utils_log(UVR_DANGER, "[x] uvr_vk_headless_target_create: readback memory is not host mappable");
+      goto exit_vk_headless_target_destroy_buffer;
+    }
+  }
+
+  target.pendingFrames = calloc(uvrvk->frameCount, sizeof(uint64_t));
+  if (!target.pendingFrames) {
+    uvr_utils_log(UVR_DANGER, "[x] calloc: %s", strerror(errno));
+    goto exit_vk_headless_target_destroy_buffer;
+  }
+
+  struct uvr_vk_command_buffer_create_info cmdbuff_info;
+  cmdbuff_info.vkDevice = target.vkDevice;
+  cmdbuff_info.queueFamilyIndex = uvrvk->queueFamilyIndex;
+  cmdbuff_info.commandBufferCount = uvrvk->frameCount * 2;
+  cmdbuff_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+
+  target.vkCommandbuffs = uvr_vk_command_buffer_create(&cmdbuff_info);
+  if (!target.vkCommandbuffs.vkCommandPool)
+    goto exit_vk_headless_target_free_pending;
+
+  struct uvr_vk_sync_obj_create_info sync_info;
+  sync_info.vkDevice = target.vkDevice;
+  sync_info.fenceCount = uvrvk->frameCount;
+  sync_info.semaphoreCount = 0;
+  sync_info.semaphoreType = VK_SEMAPHORE_TYPE_BINARY;
+  sync_info.initialValue = 0;
+
+  target.vkSyncs = uvr_vk_sync_obj_create(&sync_info);
+  if (!target.vkSyncs.vkFences)
+    goto exit_vk_headless_target_destroy_command_buffer;
+
+  target.vkQueue = uvrvk->vkQueue;
+  target.format = uvrvk->format;
+  target.extent2D = uvrvk->extent2D;
+  target.frameCount = uvrvk->frameCount;
+  target.readbackInterval = uvrvk->readbackInterval;
+  target.readbackLayout = uvrvk->readbackLayout;
+  target.readback = uvrvk->readback;
+  target.readbackUserData = uvrvk->readbackUserData;
+
+  uvr_utils_log(UVR_SUCCESS, "uvr_vk_headless_target_create: %u %ux%u render targets, readback every %u frame(s)",
+                             target.frameCount, target.extent2D.width, target.extent2D.height, target.readbackInterval);
+
+  return target;
+
+exit_vk_headless_target_destroy_command_buffer:
+  command_buffer_destroy(&target.vkCommandbuffs);
+exit_vk_headless_target_free_pending:
+  free(target.pendingFrames);
+exit_vk_headless_target_destroy_buffer:
+  if (target.readbackBuffer.vkBuffer) {
+    vkDestroyBuffer(target.vkDevice, target.readbackBuffer.vkBuffer, hostCallbacks);
+    uvr_vk_allocator_free(target.readbackBuffer.allocator, &target.readbackBuffer.allocation);
+  }
+exit_vk_headless_target_destroy_images:
+  for (i = 0; i < target.images.imageCount; i++) {
+    vkDestroyImageView(target.vkDevice, target.images.vkImageViews[i].view, hostCallbacks);
+    vkDestroyImage(target.vkDevice, target.images.vkImages[i].image, hostCallbacks);
+    uvr_vk_allocator_free(target.images.allocator, &target.images.allocations[i]);
+  }
+  free(target.images.vkImages);
+  free(target.images.vkImageViews);
+  free(target.images.allocations);
+exit_vk_headless_target:
+  return (struct uvr_vk_headless_target) { .vkDevice = VK_NULL_HANDLE, .vkQueue = VK_NULL_HANDLE, .pendingFrames = NULL };
+}
+
+
+/* Hands the pixels copied by the frame slot's last submission to the readback callback. Slot's fence must be signaled. */
+static void headless_target_deliver(struct uvr_vk_headless_target *target, uint32_t slot) {
+  if (!target->pendingFrames[slot])
+    return;
+
+  target->readback(target->readbackUserData, target->pendingFrames[slot] - 1,
+                   (char *) target->readbackBuffer.allocation.pMapped + (target->readbackSize * slot),
+                   target->extent2D, target->rowPitch);
+
+  target->pendingFrames[slot] = 0;
+  target->readbackCount++;
+  target->readbackBytes += target->readbackSize;
+}
+
+
+VkResult uvr_vk_headless_target_acquire(struct uvr_vk_headless_target *target, struct uvr_vk_frame *frame) {
+  VkResult res = VK_RESULT_MAX_ENUM;
+  struct timespec start, end;
+
+  VkFence frameFence = target->vkSyncs.vkFences[target->frameIndex].fence;
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  res = target->dispatch->WaitForFences(target->vkDevice, 1, &frameFence, VK_TRUE, UINT64_MAX);
+  if (res) {
+    uvr_utils_log(UVR_DANGER, "[x] vkWaitForFences: %s", vkres_msg(res));
+    return res;
+  }
+  clock_gettime(CLOCK_MONOTONIC, &end);
+
+  if (!target->frameNumber)
+    target->startTime = end;
+  target->cpuWaitNs += timespec_diff_ns(&start, &end);
+
+  headless_target_deliver(target, target->frameIndex);
+
+  frame->frameIndex = target->frameIndex;
+  frame->imageIndex = target->frameIndex;
+  frame->vkCommandBuffer = target->vkCommandbuffs.vkCommandbuffers[target->frameIndex].buffer;
+
+  return res;
+}
+
+
+int uvr_vk_headless_target_submit(struct uvr_vk_headless_target *target) {
+  VkResult res = VK_RESULT_MAX_ENUM;
+
+  VkSubmitInfo submit_info = {};
+  submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+  submit_info.pNext = NULL;
+  submit_info.waitSemaphoreCount = 0;
+  submit_info.pWaitSemaphores = NULL;
+  submit_info.pWaitDstStageMask = NULL;
+  submit_info.commandBufferCount = 1;
+  submit_info.pCommandBuffers = &target->vkCommandbuffs.vkCommandbuffers[target->frameIndex].buffer;
+  submit_info.signalSemaphoreCount = 0;
+  submit_info.pSignalSemaphores = NULL;
+
+  /* Fence is signaled by present, it covers this submission as it's earlier in submission order */
+  res = target->dispatch->QueueSubmit(target->vkQueue, 1, &submit_info, VK_NULL_HANDLE);
+  if (res) {
+    uvr_utils_log(UVR_DANGER, "[x] vkQueueSubmit: %s", vkres_msg(res));
+    return -1;
+  }
+
+  return 0;
+}
+
+
+static int headless_target_record_readback(struct uvr_vk_headless_target *target, VkCommandBuffer cmdBuffer) {
+  VkResult res = VK_RESULT_MAX_ENUM;
+
+  VkCommandBufferBeginInfo begin_info = {};
+  begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+  begin_info.pNext = NULL;
+  begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+  begin_info.pInheritanceInfo = NULL;
+
+  res = target->dispatch->BeginCommandBuffer(cmdBuffer, &begin_info);
+  if (res) {
+    uvr_utils_log(UVR_DANGER, "[x] vkBeginCommandBuffer: %s", vkres_msg(res));
+    return -1;
+  }
+
+  /* Scope covers the frame's command buffer, submitted earlier on the same queue */
+  VkImageMemoryBarrier imageBarrier = {};
+  imageBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+  imageBarrier.pNext = NULL;
+  imageBarrier.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+  imageBarrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+  imageBarrier.oldLayout = target->readbackLayout;
+  imageBarrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+  imageBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  imageBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  imageBarrier.image = target->images.vkImages[target->frameIndex].image;
+  imageBarrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+  imageBarrier.subresourceRange.baseMipLevel = 0;
+  imageBarrier.subresourceRange.levelCount = 1;
+  imageBarrier.subresourceRange.baseArrayLayer = 0;
+  imageBarrier.subresourceRange.layerCount = 1;
+
+  target->dispatch->CmdPipelineBarrier(cmdBuffer, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                       0, 0, NULL, 0, NULL, 1, &imageBarrier);
+
+  VkBufferImageCopy region = {};
+  region.bufferOffset = target->readbackSize * target->frameIndex;
+  region.bufferRowLength = 0;
+  region.bufferImageHeight = 0;
+  region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+  region.imageSubresource.mipLevel = 0;
+  region.imageSubresource.baseArrayLayer = 0;
+  region.imageSubresource.layerCount = 1;
+  region.imageOffset = (VkOffset3D) { 0, 0, 0 };
+  region.imageExtent = (VkExtent3D) { target->extent2D.width, target->extent2D.height, 1 };
+
+  target->dispatch->CmdCopyImageToBuffer(cmdBuffer, imageBarrier.image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                                         target->readbackBuffer.vkBuffer, 1, &region);
+
+  VkBufferMemoryBarrier bufferBarrier = {};
+  bufferBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+  bufferBarrier.pNext = NULL;
+  bufferBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+  bufferBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+  bufferBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  bufferBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  bufferBarrier.buffer = target->readbackBuffer.vkBuffer;
+  bufferBarrier.offset = region.bufferOffset;
+  bufferBarrier.size = target->readbackSize;
+
+  target->dispatch->CmdPipelineBarrier(cmdBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT,
+                                       0, 0, NULL, 1, &bufferBarrier, 0, NULL);
+
+  res = target->dispatch->EndCommandBuffer(cmdBuffer);
+  if (res) {
+    uvr_utils_log(UVR_DANGER, "[x] vkEndCommandBuffer: %s", vkres_msg(res));
+    return -1;
+  }
+
+  return 0;
+}
+
+
+VkResult uvr_vk_headless_target_present(struct uvr_vk_headless_target *target) {
+  VkResult res = VK_RESULT_MAX_ENUM;
+  uint32_t submitCount = 0;
+
+  VkFence frameFence = target->vkSyncs.vkFences[target->frameIndex].fence;
+  VkCommandBuffer cmdBuffer = target->vkCommandbuffs.vkCommandbuffers[target->frameCount + target->frameIndex].buffer;
+
+  VkSubmitInfo submit_info = {};
+  submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+  submit_info.pNext = NULL;
+  submit_info.commandBufferCount = 1;
+  submit_info.pCommandBuffers = &cmdBuffer;
+
+  if (target->readbackInterval && (target->frameNumber % target->readbackInterval) == 0) {
+    if (headless_target_record_readback(target, cmdBuffer) == 0) {
+      target->pendingFrames[target->frameIndex] = target->frameNumber + 1;
+      submitCount = 1;
+    }
+  }
+
+  res = target->dispatch->ResetFences(target->vkDevice, 1, &frameFence);
+  if (res) {
+    uvr_utils_log(UVR_DANGER, "[x] vkResetFences: %s", vkres_msg(res));
+    target->pendingFrames[target->frameIndex] = 0;
+    goto exit_vk_headless_target_present;
+  }
+
+  /* Fence signal operations cover every command earlier in submission order, an empty submit suffices */
+  res = target->dispatch->QueueSubmit(target->vkQueue, submitCount, &submit_info, frameFence);
+  if (res) {
+    uvr_utils_log(UVR_DANGER, "[x] vkQueueSubmit: %s", vkres_msg(res));
+    target->pendingFrames[target->frameIndex] = 0;
+    fence_resignal(target->dispatch, target->vkQueue, frameFence);
+  }
+
+exit_vk_headless_target_present:
+  target->frameIndex = (target->frameIndex + 1) % target->frameCount;
+  target->frameNumber++;
+
+  return res;
+}
+
+
+void uvr_vk_headless_target_drain(struct uvr_vk_headless_target *target) {
+  uint32_t i, slot;
+
+  if (!target->vkSyncs.vkFences)
+    return;
+
+  /* Oldest frame first so the callback sees frames in presentation order */
+  for (i = 0; i < target->frameCount; i++) {
+    slot = (target->frameIndex + i) % target->frameCount;
+    if (!target->pendingFrames[slot])
+      continue;
+
+    target->dispatch->WaitForFences(target->vkDevice, 1, &target->vkSyncs.vkFences[slot].fence, VK_TRUE, UINT64_MAX);
+    headless_target_deliver(target, slot);
+  }
+}
+
+
+struct uvr_vk_headless_target_stats uvr_vk_headless_target_get_stats(struct uvr_vk_headless_target *target) {
+  struct uvr_vk_headless_target_stats stats;
+  struct timespec now;
+  double elapsedSec = 0;
+
+  memset(&stats, 0, sizeof(stats));
+
+  stats.frameCount = target->frameNumber;
+  stats.readbackCount = target->readbackCount;
+  stats.readbackBytes = target->readbackBytes;
+  stats.cpuWaitMs = target->cpuWaitNs / 1e6;
+
+  if (target->frameNumber) {
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    elapsedSec = timespec_diff_ns(&target->startTime, &now) / 1e9;
+  }
+
+  if (elapsedSec > 0) {
+    stats.framesPerSecond = target->frameNumber / elapsedSec;
+    stats.readbackMBPerSecond = (target->readbackBytes / 1e6) / elapsedSec;
+  }
+
+  return stats;
+}
+
+
+struct uvr_vk_command_recorder_job {
+  struct uvr_vk_command_recorder_record_info *info;
+  const struct uvr_vk_device_dispatch *dispatch;
+  VkCommandBuffer cmdBuffer;
+  uint32_t threadIndex;
+  uint32_t first;
+  uint32_t count;
+  int ret;
+};
+
+
+static void command_recorder_job(void *data) {
+  struct uvr_vk_command_recorder_job *job = data;
+  struct uvr_vk_command_recorder_record_info *info = job->info;
+  VkResult res = VK_RESULT_MAX_ENUM;
+
+  VkCommandBufferInheritanceInfo inheritance_info = {};
+  inheritance_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+  inheritance_info.pNext = (info->renderPass) ? NULL : info->pInheritanceRenderingInfo;
+  inheritance_info.renderPass = info->renderPass;
+  inheritance_info.subpass = info->subpass;
+  inheritance_info.framebuffer = info->framebuffer;
+  inheritance_info.occlusionQueryEnable = VK_FALSE;
+  inheritance_info.queryFlags = 0;
+  inheritance_info.pipelineStatistics = 0;
+
+  VkCommandBufferBeginInfo begin_info = {};
+  begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+  begin_info.pNext = NULL;
+  begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+  begin_info.pInheritanceInfo = &inheritance_info;
+
+  job->ret = -1;
+
+  res = job->dispatch->BeginCommandBuffer(job->cmdBuffer, &begin_info);
+  if (res) {
+    uvr_utils_log(UVR_DANGER, "[x] vkBeginCommandBuffer: %s", vkres_msg(res));
+    return;
+  }
+
+  info->recordFunc(job->cmdBuffer, job->threadIndex, job->first, job->count, info->data);
+
+  res = job->dispatch->EndCommandBuffer(job->cmdBuffer);
+  if (res) {
+    uvr_utils_log(UVR_DANGER, "[x] vkEndCommandBuffer: %s", vkres_msg(res));
+    return;
+  }
+
+  job->ret = 0;
+}
+
+
+struct uvr_vk_command_recorder uvr_vk_command_recorder_create(struct uvr_vk_command_recorder_create_info *uvrvk) {
+  struct uvr_vk_command_buffer *threadCommandbuffs = NULL;
+  struct uvr_utils_thread_pool *threadPool = NULL;
+  uint32_t t;
+
+  if (!uvrvk->threadCount || !uvrvk->bufferCount) {
+    uvr_utils_log(UVR_DANGER, "[x] uvr_vk_command_recorder_create: threadCount and bufferCount must be greater than zero");
+    goto exit_vk_command_recorder;
+  }
+
+  threadCommandbuffs = calloc(uvrvk->threadCount, sizeof(struct uvr_vk_command_buffer));
+  if (!threadCommandbuffs) {
+    uvr_utils_log(UVR_DANGER, "[x] calloc: %s", strerror(errno));
+    goto exit_vk_command_recorder;
+  }
+
+  struct uvr_vk_command_buffer_create_info cmdbuff_info;
+  cmdbuff_info.vkDevice = uvrvk->vkDevice;
+  cmdbuff_info.queueFamilyIndex = uvrvk->queueFamilyIndex;
+  cmdbuff_info.commandBufferCount = uvrvk->bufferCount;
+  cmdbuff_info.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+
+  for (t = 0; t < uvrvk->threadCount; t++) {
+    threadCommandbuffs[t] = uvr_vk_command_buffer_create(&cmdbuff_info);
+    if (!threadCommandbuffs[t].vkCommandPool)
+      goto exit_vk_command_recorder_destroy_command_buffers;
+  }
+
+  threadPool = calloc(1, sizeof(struct uvr_utils_thread_pool));
+  if (!threadPool) {
+    uvr_utils_log(UVR_DANGER, "[x] calloc: %s", strerror(errno));
+    goto exit_vk_command_recorder_destroy_command_buffers;
+  }
+
+  if (uvr_utils_thread_pool_create(threadPool, uvrvk->threadCount) == -1)
+    goto exit_vk_command_recorder_free_thread_pool;
+
+  uvr_utils_log(UVR_SUCCESS, "uvr_vk_command_recorder_create: %u recording threads, %u secondary command buffers each",
+                             uvrvk->threadCount, uvrvk->bufferCount);
+
+  return (struct uvr_vk_command_recorder) { .vkDevice = uvrvk->vkDevice, .dispatch = uvr_vk_device_dispatch_get(uvrvk->vkDevice),
+                                            .threadCount = uvrvk->threadCount,
+                                            .bufferCount = uvrvk->bufferCount, .threadCommandbuffs = threadCommandbuffs,
+                                            .threadPool = threadPool, .recordNs = 0 };
+
+exit_vk_command_recorder_free_thread_pool:
+  free(threadPool);
+exit_vk_command_recorder_destroy_command_buffers:
+  for (t = 0; t < uvrvk->threadCount; t++)
+    command_buffer_destroy(&threadCommandbuffs[t]);
+  free(threadCommandbuffs);
+exit_vk_command_recorder:
+  return (struct uvr_vk_command_recorder) { .vkDevice = VK_NULL_HANDLE, .dispatch = NULL, .threadCount = 0, .bufferCount = 0,
+                                            .threadCommandbuffs = NULL, .threadPool = NULL, .recordNs = 0 };
+}
+
+
+int uvr_vk_command_recorder_record(struct uvr_vk_command_recorder_record_info *uvrvk) {
+  struct uvr_vk_command_recorder *recorder = uvrvk->recorder;
+  struct uvr_vk_command_recorder_job *jobs = NULL;
+  VkCommandBuffer *secondaries = NULL;
+  uint32_t t, first = 0, count, executeCount = 0;
+  struct timespec start, end;
+  int ret = -1;
+
+  if (uvrvk->bufferIndex >= recorder->bufferCount) {
+    uvr_utils_log(UVR_DANGER, "[x] uvr_vk_command_recorder_record: bufferIndex %u out of range", uvrvk->bufferIndex);
+    return -1;
+  }
+
+  jobs = calloc(recorder->threadCount, sizeof(struct uvr_vk_command_recorder_job));
+  if (!jobs) {
+    uvr_utils_log(UVR_DANGER, "[x] calloc: %s", strerror(errno));
+    return -1;
+  }
+
+  secondaries = calloc(recorder->threadCount, sizeof(VkCommandBuffer));
+  if (!secondaries) {
+    uvr_utils_log(UVR_DANGER, "[x] calloc: %s", strerror(errno));
+    goto exit_vk_command_recorder_record_free_jobs;
+  }
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+
+  /* Even split, the first (itemCount % threadCount) workers take one extra item */
+  for (t = 0; t < recorder->threadCount; t++) {
+    count = uvrvk->itemCount / recorder->threadCount + ((t < uvrvk->itemCount % recorder->threadCount) ? 1 : 0);
+    jobs[t].info = uvrvk;
+    jobs[t].dispatch = recorder->dispatch;
+    jobs[t].cmdBuffer = recorder->threadCommandbuffs[t].vkCommandbuffers[uvrvk->bufferIndex].buffer;
+    jobs[t].threadIndex = t;
+    jobs[t].first = first;
+    jobs[t].count = count;
+    jobs[t].ret = 0;
+    first += count;
+
+    if (!count)
+      continue;
+
+    if (uvr_utils_thread_pool_submit(recorder->threadPool, command_recorder_job, &jobs[t]) == -1) {
+      /* Record inline rather than drop the slice */
+      command_recorder_job(&jobs[t]);
+    }
+  }
+
+  uvr_utils_thread_pool_wait(recorder->threadPool);
+
+  for (t = 0; t < recorder->threadCount; t++) {
+    if (!jobs[t].count)
+      continue;
+    if (jobs[t].ret == -1)
+      goto exit_vk_command_recorder_record_free_secondaries;
+    secondaries[executeCount++] = jobs[t].cmdBuffer;
+  }
+
+  if (executeCount)
+    recorder->dispatch->CmdExecuteCommands(uvrvk->vkPrimaryCommandBuffer, executeCount, secondaries);
+
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  recorder->recordNs = timespec_diff_ns(&start, &end);
+
+  ret = 0;
+
+exit_vk_command_recorder_record_free_secondaries:
+  free(secondaries);
+exit_vk_command_recorder_record_free_jobs:
+  free(jobs);
+  return ret;
+}
+
+
+struct uvr_vk_query_frame {
+  uint32_t scopeCount;
+  bool     reset;
+};
+
+
+struct uvr_vk_query_scope {
+  uint32_t        nameIndex;
+  VkCommandBuffer cmdBuffer;
+  bool            open;
+  bool            statistics;
+};
+
+
+struct uvr_vk_query_pool uvr_vk_query_pool_create(struct uvr_vk_query_pool_create_info *uvrvk) {
+  VkResult res = VK_RESULT_MAX_ENUM;
+  VkPhysicalDeviceProperties phdevProps;
+  VkQueueFamilyProperties *queueProps = NULL;
+  struct uvr_vk_query_pool qpool;
+  uint32_t queueFamilyCount = 0;
+
+  memset(&qpool, 0, sizeof(qpool));
+
+  if (!uvrvk->frameCount || !uvrvk->maxScopes || !uvrvk->historyLength) {
+    uvr_utils_log(UVR_DANGER, "[x] uvr_vk_query_pool_create: frameCount, maxScopes and historyLength must be greater than zero");
+    goto exit_vk_query_pool;
+  }
+
+  vkGetPhysicalDeviceProperties(uvrvk->vkPhdev, &phdevProps);
+
+  vkGetPhysicalDeviceQueueFamilyProperties(uvrvk->vkPhdev, &queueFamilyCount, NULL);
+  if (uvrvk->queueFamilyIndex >= queueFamilyCount) {
+    uvr_utils_log(UVR_DANGER, "[x] uvr_vk_query_pool_create: invalid queue family index %u", uvrvk->queueFamilyIndex);
+    goto exit_vk_query_pool;
+  }
+
+  queueProps = calloc(queueFamilyCount, sizeof(VkQueueFamilyProperties));
+  if (!queueProps) {
+    uvr_utils_log(UVR_DANGER, "[x] calloc: %s", strerror(errno));
+    goto exit_vk_query_pool;
+  }
+
+  vkGetPhysicalDeviceQueueFamilyProperties(uvrvk->vkPhdev, &queueFamilyCount, queueProps);
+  uint32_t validBits = queueProps[uvrvk->queueFamilyIndex].timestampValidBits;
+  free(queueProps);
+
+  if (!validBits) {
+    uvr_utils_log(UVR_DANGER, "[x] uvr_vk_query_pool_create: queue family %u doesn't support timestamps", uvrvk->queueFamilyIndex);
+    goto exit_vk_query_pool;
+  }
+
+  qpool.vkDevice = uvrvk->vkDevice;
+  qpool.dispatch = uvr_vk_device_dispatch_get(qpool.vkDevice);
+  qpool.pipelineStatistics = uvrvk->pipelineStatistics;
+  qpool.statisticCount = __builtin_popcount(uvrvk->pipelineStatistics);
+  qpool.timestampPeriod = phdevProps.limits.timestampPeriod;
+  qpool.timestampMask = (validBits >= 64) ? UINT64_MAX : ((1ULL << validBits) - 1);
+  qpool.frameCount = uvrvk->frameCount;
+  qpool.maxScopes = uvrvk->maxScopes;
+  qpool.historyLength = uvrvk->historyLength;
+
+  if (qpool.statisticCount > UVR_VK_QUERY_MAX_STATISTICS) {
+    uvr_utils_log(UVR_DANGER, "[x] uvr_vk_query_pool_create: unsupported pipeline statistic bits set");
+    goto exit_vk_query_pool;
+  }
+
+  qpool.frames = calloc(qpool.frameCount, sizeof(struct uvr_vk_query_frame));
+  qpool.scopes = calloc(qpool.frameCount * qpool.maxScopes, sizeof(struct uvr_vk_query_scope));
+  qpool.names = calloc(qpool.maxScopes, sizeof(const char *));
+  qpool.historyCount = calloc(qpool.maxScopes, sizeof(uint64_t));
+  qpool.history = calloc(qpool.maxScopes * qpool.historyLength, sizeof(uint64_t));
+  qpool.results = calloc(qpool.maxScopes, sizeof(struct uvr_vk_query_result));
+  if (!qpool.frames || !qpool.scopes || !qpool.names || !qpool.historyCount || !qpool.history || !qpool.results) {
+    uvr_utils_log(UVR_DANGER, "[x] calloc: %s", strerror(errno));
+    goto exit_vk_query_pool_free;
+  }
+
+  VkQueryPoolCreateInfo create_info = {};
+  create_info.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+  create_info.pNext = NULL;
+  create_info.flags = 0;
+  create_info.queryType = VK_QUERY_TYPE_TIMESTAMP;
+  create_info.queryCount = 2 * qpool.frameCount * qpool.maxScopes;
+  create_info.pipelineStatistics = 0;
+
+  res = vkCreateQueryPool(uvrvk->vkDevice, &create_info, hostCallbacks, &qpool.vkTimestampPool);
+  if (res) {
+    uvr_utils_log(UVR_DANGER, "[x] vkCreateQueryPool: %s", vkres_msg(res));
+    goto exit_vk_query_pool_free;
+  }
+
+  if (qpool.pipelineStatistics) {
+    create_info.queryType = VK_QUERY_TYPE_PIPELINE_STATISTICS;
+    create_info.queryCount = qpool.frameCount * qpool.maxScopes;
+    create_info.pipelineStatistics = qpool.pipelineStatistics;
+
+    res = vkCreateQueryPool(uvrvk->vkDevice, &create_info, hostCallbacks, &qpool.vkStatisticsPool);
+    if (res) {
+      uvr_utils_log(UVR_DANGER, "[x] vkCreateQueryPool: %s", vkres_msg(res));
+      goto exit_vk_query_pool_destroy_timestamp_pool;
+    }
+  }
+
+  uvr_utils_log(UVR_SUCCESS, "uvr_vk_query_pool_create: VkQueryPool successfully created retval(%p) timestamp period %f ns",
+                             qpool.vkTimestampPool, qpool.timestampPeriod);
+
+  return qpool;
+
+exit_vk_query_pool_destroy_timestamp_pool:
+  vkDestroyQueryPool(uvrvk->vkDevice, qpool.vkTimestampPool, hostCallbacks);
+exit_vk_query_pool_free:
+  free(qpool.frames);
+  free(qpool.scopes);
+  free(qpool.names);
+  free(qpool.historyCount);
+  free(qpool.history);
+  free(qpool.results);
+exit_vk_query_pool:
+  return (struct uvr_vk_query_pool) { .vkDevice = VK_NULL_HANDLE, .vkTimestampPool = VK_NULL_HANDLE, .vkStatisticsPool = VK_NULL_HANDLE,
+                                      .frames = NULL, .scopes = NULL, .names = NULL, .historyCount = NULL, .history = NULL,
+                                      .results = NULL };
+}
+
+
+int uvr_vk_query_pool_next_frame(struct uvr_vk_query_pool *uvrvk) {
+  VkResult res = VK_RESULT_MAX_ENUM;
+  struct uvr_vk_query_frame *frame = NULL;
+  struct uvr_vk_query_scope *scopes = NULL;
+  uint64_t *timestamps = NULL, *statistics = NULL;
+  uint32_t s, q, r, nameIndex, openCount = 0;
+  int ret = 0;
+
+  uvrvk->frameIndex = (uvrvk->frameIndex + 1) % uvrvk->frameCount;
+  uvrvk->frameNumber++;
+
+  frame = &uvrvk->frames[uvrvk->frameIndex];
+  scopes = &uvrvk->scopes[uvrvk->frameIndex * uvrvk->maxScopes];
+
+  if (!frame->scopeCount)
+    goto exit_vk_query_pool_next_frame;
+
+  timestamps = calloc(2 * frame->scopeCount + frame->scopeCount * uvrvk->statisticCount, sizeof(uint64_t));
+  if (!timestamps) {
+    uvr_utils_log(UVR_DANGER, "[x] calloc: %s", strerror(errno));
+    ret = -1;
+    goto exit_vk_query_pool_next_frame;
+  }
+
+  statistics = timestamps + 2 * frame->scopeCount;
+
+  /* A scope never ended has no end timestamp, its slot would stay unavailable forever */
+  for (s = 0; s < frame->scopeCount; s++) {
+    if (!scopes[s].open)
+      continue;
+    uvr_utils_log(UVR_WARNING, "uvr_vk_query_pool_next_frame: scope '%s' was never ended, dropping its results",
+                               uvrvk->names[scopes[s].nameIndex]);
+    openCount++;
+  }
+
+  /* No VK_QUERY_RESULT_WAIT_BIT, the frame slot's previous submission is expected to be done */
+  for (s = 0; s < frame->scopeCount; s++) {
+    if (scopes[s].open)
+      continue;
+
+    /* Read the whole range at once when every scope was ended */
+    q = (openCount) ? 2 : 2 * frame->scopeCount;
+    res = vkGetQueryPoolResults(uvrvk->vkDevice, uvrvk->vkTimestampPool, 2 * (uvrvk->frameIndex * uvrvk->maxScopes + s),
+                                q, q * sizeof(uint64_t), &timestamps[2 * s], sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+    if (res) {
+      if (res != VK_NOT_READY)
+        uvr_utils_log(UVR_DANGER, "[x] vkGetQueryPoolResults: %s", vkres_msg(res));
+      ret = -1;
+      goto exit_vk_query_pool_next_frame_free;
+    }
+
+    if (!openCount)
+      break;
+  }
+
+  /* Nested scopes never began a statistics query, reading one back would never become available */
+  for (s = 0; uvrvk->vkStatisticsPool && s < frame->scopeCount; s++) {
+    if (!scopes[s].statistics || scopes[s].open)
+      continue;
+
+    res = vkGetQueryPoolResults(uvrvk->vkDevice, uvrvk->vkStatisticsPool, uvrvk->frameIndex * uvrvk->maxScopes + s, 1,
+                                uvrvk->statisticCount * sizeof(uint64_t), &statistics[s * uvrvk->statisticCount],
+                                uvrvk->statisticCount * sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+    if (res) {
+      if (res != VK_NOT_READY)
+        uvr_utils_log(UVR_DANGER, "[x] vkGetQueryPoolResults: %s", vkres_msg(res));
+      ret = -1;
+      goto exit_vk_query_pool_next_frame_free;
+    }
+  }
+
+  for (s = 0, r = 0; s < frame->scopeCount; s++) {
+    if (scopes[s].open)
+      continue;
+
+    nameIndex = scopes[s].nameIndex;
+
+    uint64_t ticks = (timestamps[2 * s + 1] - timestamps[2 * s]) & uvrvk->timestampMask;
+    uint64_t gpuNs = (uint64_t) ((double) ticks * uvrvk->timestampPeriod);
+
+    uvrvk->results[r].name = uvrvk->names[nameIndex];
+    uvrvk->results[r].gpuNs = gpuNs;
+    memset(uvrvk->results[r].pipelineStatistics, 0, sizeof(uvrvk->results[r].pipelineStatistics));
+    for (q = 0; q < uvrvk->statisticCount; q++)
+      uvrvk->results[r].pipelineStatistics[q] = statistics[s * uvrvk->statisticCount + q];
+
+    uvrvk->history[nameIndex * uvrvk->historyLength + (uvrvk->historyCount[nameIndex] % uvrvk->historyLength)] = gpuNs;
+    uvrvk->historyCount[nameIndex]++;
+    r++;
+  }
+
+  uvrvk->resultCount = r;
+  uvrvk->resultFrameNumber = uvrvk->frameNumber - uvrvk->frameCount;
+
+exit_vk_query_pool_next_frame_free:
+  free(timestamps);
+exit_vk_query_pool_next_frame:
+  frame->scopeCount = 0;
+  frame->reset = false;
+  return ret;
+}
+
+
+void uvr_vk_query_pool_reset(struct uvr_vk_query_pool *uvrvk, VkCommandBuffer cmdBuffer) {
+  struct uvr_vk_query_frame *frame = &uvrvk->frames[uvrvk->frameIndex];
+
+  if (frame->reset)
+    return;
+
+  uvrvk->dispatch->CmdResetQueryPool(cmdBuffer, uvrvk->vkTimestampPool, 2 * uvrvk->frameIndex * uvrvk->maxScopes, 2 * uvrvk->maxScopes);
+  if (uvrvk->vkStatisticsPool)
+    uvrvk->dispatch->CmdResetQueryPool(cmdBuffer, uvrvk->vkStatisticsPool, uvrvk->frameIndex * uvrvk->maxScopes, uvrvk->maxScopes);
+  frame->reset = true;
+}
+
+
+int uvr_vk_query_pool_scope_begin(struct uvr_vk_query_pool *uvrvk, VkCommandBuffer cmdBuffer, const char *name) {
+  struct uvr_vk_query_frame *frame = &uvrvk->frames[uvrvk->frameIndex];
+  struct uvr_vk_query_scope *scopes = &uvrvk->scopes[uvrvk->frameIndex * uvrvk->maxScopes];
+  struct uvr_vk_query_scope *scope = NULL;
+  uint32_t nameIndex, scopeId, s;
+  bool nested = false;
+
+  /* A reset recorded lazily here could land inside a render pass */
+  if (!frame->reset) {
+    uvr_utils_log(UVR_WARNING, "uvr_vk_query_pool_scope_begin: scope '%s' rejected, uvr_vk_query_pool_reset(3) not recorded this frame", name);
+    return -1;
+  }
+
+  if (frame->scopeCount >= uvrvk->maxScopes)
+    return -1;
+
+  for (nameIndex = 0; nameIndex < uvrvk->nameCount; nameIndex++)
+    if (uvrvk->names[nameIndex] == name || !strcmp(uvrvk->names[nameIndex], name))
+      break;
+
+  if (nameIndex == uvrvk->nameCount) {
+    if (uvrvk->nameCount >= uvrvk->maxScopes)
+      return -1;
+    uvrvk->names[uvrvk->nameCount++] = name;
+  }
+
+  for (s = 0; s < frame->scopeCount; s++)
+    if (scopes[s].open && scopes[s].statistics && scopes[s].cmdBuffer == cmdBuffer)
+      nested = true;
+
+  if (nested && !uvrvk->nestedLogged) {
+    uvr_utils_log(UVR_WARNING, "uvr_vk_query_pool_scope_begin: scope '%s' is nested, only timestamps are gathered", name);
+    uvrvk->nestedLogged = true;
+  }
+
+  scopeId = frame->scopeCount++;
+  scope = &scopes[scopeId];
+  scope->nameIndex = nameIndex;
+  scope->cmdBuffer = cmdBuffer;
+  scope->open = true;
+  scope->statistics = uvrvk->vkStatisticsPool && !nested;
+
+  uvrvk->dispatch->CmdWriteTimestamp(cmdBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, uvrvk->vkTimestampPool,
+                                     2 * (uvrvk->frameIndex * uvrvk->maxScopes + scopeId));
+
+  if (scope->statistics)
+    uvrvk->dispatch->CmdBeginQuery(cmdBuffer, uvrvk->vkStatisticsPool, uvrvk->frameIndex * uvrvk->maxScopes + scopeId, 0);
+
+  return scopeId;
+}
+
+
+int uvr_vk_query_pool_scope_end(struct uvr_vk_query_pool *uvrvk, VkCommandBuffer cmdBuffer, int scopeId) {
+  struct uvr_vk_query_frame *frame = &uvrvk->frames[uvrvk->frameIndex];
+  struct uvr_vk_query_scope *scopes = &uvrvk->scopes[uvrvk->frameIndex * uvrvk->maxScopes];
+  int s;
+
+  if (scopeId < 0) {
+    for (s = (int) frame->scopeCount - 1; s >= 0; s--)
+      if (scopes[s].open && scopes[s].cmdBuffer == cmdBuffer)
+        break;
+    scopeId = s;
+  }
+
+  if (scopeId < 0 || (uint32_t) scopeId >= frame->scopeCount || !scopes[scopeId].open)
+    return -1;
+
+  if (scopes[scopeId].statistics)
+    uvrvk->dispatch->CmdEndQuery(cmdBuffer, uvrvk->vkStatisticsPool, uvrvk->frameIndex * uvrvk->maxScopes + scopeId);
+
+  uvrvk->dispatch->CmdWriteTimestamp(cmdBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, uvrvk->vkTimestampPool,
+                                     2 * (uvrvk->frameIndex * uvrvk->maxScopes + scopeId) + 1);
+
+  scopes[scopeId].open = false;
+
+  return scopeId;
+}
+
+
+static int u64_cmp(const void *a, const void *b) {
+  uint64_t x = *(const uint64_t *) a, y = *(const uint64_t *) b;
+  return (x > y) - (x < y);
+}
+
+
+struct uvr_vk_query_percentiles uvr_vk_query_pool_get_percentiles(struct uvr_vk_query_pool *uvrvk, const char *name) {
+  struct uvr_vk_query_percentiles percentiles;
+  uint64_t *samples = NULL;
+  uint32_t nameIndex, count;
+
+  memset(&percentiles, 0, sizeof(percentiles));
+
+  for (nameIndex = 0; nameIndex < uvrvk->nameCount; nameIndex++)
+    if (!strcmp(uvrvk->names[nameIndex], name))
+      break;
+
+  if (nameIndex == uvrvk->nameCount || !uvrvk->historyCount[nameIndex])
+    return percentiles;
+
+  count = (uvrvk->historyCount[nameIndex] < uvrvk->historyLength) ? uvrvk->historyCount[nameIndex] : uvrvk->historyLength;
+
+  samples = calloc(count, sizeof(uint64_t));
+  if (!samples) {
+    uvr_utils_log(UVR_DANGER, "[x] calloc: %s", strerror(errno));
+    return percentiles;
+  }
+
+  memcpy(samples, &uvrvk->history[nameIndex * uvrvk->historyLength], count * sizeof(uint64_t));
+  qsort(samples, count, sizeof(uint64_t), u64_cmp);
+
+  percentiles.sampleCount = count;
+  percentiles.minNs = samples[0];
+  percentiles.p50Ns = samples[(count - 1) * 50 / 100];
+  percentiles.p90Ns = samples[(count - 1) * 90 / 100];
+  percentiles.p99Ns = samples[(count - 1) * 99 / 100];
+  percentiles.maxNs = samples[count - 1];
+
+  free(samples);
+  return percentiles;
+}
+
+
+struct uvr_vk_upload_batch {
+  uint64_t              uploadId;
+  VkBool32              recording;
+  VkBool32              submitted;
+  VkDeviceSize          ringBytes;
+  VkDeviceSize          bytes;
+  VkPipelineStageFlags  dstStageMask;
+  uint32_t              bufferBarrierCount;
+  uint32_t              bufferBarrierCap;
+  VkBufferMemoryBarrier *bufferBarriers;
+  VkAccessFlags         *bufferAccessMasks;
+  uint32_t              imageBarrierCount;
+  uint32_t              imageBarrierCap;
+  VkImageMemoryBarrier  *imageBarriers;
+  VkAccessFlags         *imageAccessMasks;
+};
+
+
+static void upload_batch_free(struct uvr_vk_upload_batch *batch) {
+  free(batch->bufferBarriers);
+  free(batch->bufferAccessMasks);
+  free(batch->imageBarriers);
+  free(batch->imageAccessMasks);
+}
+
+
+/* Retire completed batches in submission order. If @wait block on the oldest in flight batch first. */
+static void upload_ring_retire(struct uvr_vk_upload_ring *ring, VkBool32 wait) {
+  struct uvr_vk_upload_batch *batch = NULL;
+  struct timespec start, end;
+  VkFence fence;
+
+  while (ring->retiredUploadId + 1 < ring->nextUploadId) {
+    batch = &ring->batches[ring->retiredUploadId % ring->batchCount];
+    if (!batch->submitted)
+      break;
+
+    fence = ring->vkSyncs.vkFences[ring->retiredUploadId % ring->batchCount].fence;
+    if (ring->dispatch->GetFenceStatus(ring->vkDevice, fence) != VK_SUCCESS) {
+      if (!wait)
+        break;
+
+      clock_gettime(CLOCK_MONOTONIC, &start);
+      ring->dispatch->WaitForFences(ring->vkDevice, 1, &fence, VK_TRUE, UINT64_MAX);
+      clock_gettime(CLOCK_MONOTONIC, &end);
+      ring->stallNs += timespec_diff_ns(&start, &end);
+      ring->stallCount++;
+      wait = VK_FALSE;
+    }
+
+    ring->usedBytes -= batch->ringBytes;
+    ring->bytesRetired += batch->bytes;
+    ring->retiredUploadId = batch->uploadId;
+    batch->submitted = VK_FALSE;
+  }
+}
+
+
+/* Begin recording the current batch if it isn't already. Waits for the batch slot to be retired. */
+static struct uvr_vk_upload_batch *upload_batch_begin(struct uvr_vk_upload_ring *ring) {
+  struct uvr_vk_upload_batch *batch = &ring->batches[ring->batchIndex];
+  VkResult res = VK_RESULT_MAX_ENUM;
+
+  if (batch->recording)
+    return batch;
+
+  while (batch->submitted)
+    upload_ring_retire(ring, VK_TRUE);
+
+  VkCommandBufferBeginInfo begin_info = {};
+  begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+  begin_info.pNext = NULL;
+  begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+  begin_info.pInheritanceInfo = NULL;
+
+  res = ring->dispatch->BeginCommandBuffer(ring->vkCommandbuffs.vkCommandbuffers[ring->batchIndex].buffer, &begin_info);
+  if (res) {
+    uvr_utils_log(UVR_DANGER, "[x] vkBeginCommandBuffer: %s", vkres_msg(res));
+    return NULL;
+  }
+
+  batch->uploadId = ring->nextUploadId;
+  batch->recording = VK_TRUE;
+  batch->ringBytes = batch->bytes = 0;
+  batch->dstStageMask = 0;
+  batch->bufferBarrierCount = batch->imageBarrierCount = 0;
+
+  return batch;
+}
+
+
+/* Reserve a range of the ring. Flushes/stalls if the ring is full. Returns bytes consumed (padding included) or 0. */
+static VkDeviceSize upload_ring_alloc(struct uvr_vk_upload_ring *ring, VkDeviceSize size, VkDeviceSize *offset) {
+  VkDeviceSize off, pad;
+
+  if (!size || size > ring->size) {
+    uvr_utils_log(UVR_DANGER, "[x] uvr_vk_upload_ring: upload of %" PRIu64 " bytes does not fit ring of %" PRIu64 " bytes",
+                              (uint64_t) size, (uint64_t) ring->size);
+    return 0;
+  }
+
+  for (;;) {
+    if (!ring->usedBytes)
+      ring->head = 0;
+
+    off = ((ring->head + ring->alignment - 1) / ring->alignment) * ring->alignment;
+    pad = off - ring->head;
+    if (off + size > ring->size) {
+      pad = ring->size - ring->head;
+      off = 0;
+    }
+
+    if (ring->usedBytes + pad + size <= ring->size)
+      break;
+
+    upload_ring_retire(ring, VK_FALSE);
+    if (ring->usedBytes + pad + size <= ring->size || !ring->usedBytes)
+      continue;
+
+    /* Everything left in the ring belongs to the batch being recorded, submit it before stalling */
+    if (ring->retiredUploadId + 1 == ring->nextUploadId) {
+      if (uvr_vk_upload_ring_flush(ring, NULL) == -1)
+        return 0;
+    }
+
+    upload_ring_retire(ring, VK_TRUE);
+  }
+
+  ring->head = off + size;
+  ring->usedBytes += pad + size;
+  if (ring->usedBytes > ring->peakUsedBytes)
+    ring->peakUsedBytes = ring->usedBytes;
+
+  *offset = off;
+  return pad + size;
+}
+
+
+/* Undo the latest upload_ring_alloc(). Only valid before anything else was allocated from @ring. */
+static void upload_ring_unalloc(struct uvr_vk_upload_ring *ring, VkDeviceSize ringBytes) {
+  /* Padding either directly precedes the range or, if it wrapped, runs up to the end of the ring */
+  ring->head = (ring->head + ring->size - ringBytes) % ring->size;
+  ring->usedBytes -= ringBytes;
+}
+
+
+static int upload_batch_grow(void **barriers, VkAccessFlags **accessMasks, uint32_t *cap, size_t barrierSize) {
+  uint32_t newCap = (*cap) ? (*cap) * 2 : 16;
+  void *newBarriers = NULL, *newAccessMasks = NULL;
+
+  newBarriers = realloc(*barriers, newCap * barrierSize);
+  if (!newBarriers) {
+    uvr_utils_log(UVR_DANGER, "[x] realloc: %s", strerror(errno));
+    return -1;
+  }
+
+  *barriers = newBarriers;
+
+  newAccessMasks = realloc(*accessMasks, newCap * sizeof(VkAccessFlags));
+  if (!newAccessMasks) {
+    uvr_utils_log(UVR_DANGER, "[x] realloc: %s", strerror(errno));
+    return -1;
+  }
+
+  *accessMasks = newAccessMasks;
+  *cap = newCap;
+
+  return 0;
+}
+
+
+struct uvr_vk_upload_ring uvr_vk_upload_ring_create(struct uvr_vk_upload_ring_create_info *uvrvk) {
+  struct uvr_vk_upload_ring ring;
+
+  memset(&ring, 0, sizeof(ring));
+
+  if (!uvrvk->allocator || !uvrvk->allocator->vkDevice) {
+    uvr_utils_log(UVR_DANGER, "[x] uvr_vk_upload_ring_create: struct uvr_vk_allocator not instantiated");
+    goto exit_vk_upload_ring;
+  }
+
+  ring.vkDevice = uvrvk->allocator->vkDevice;
+  ring.dispatch = uvr_vk_device_dispatch_get(ring.vkDevice);
+  ring.batchCount = (uvrvk->batchCount) ? uvrvk->batchCount : 2;
+  ring.alignment = (uvrvk->alignment) ? uvrvk->alignment : 16;
+
+  struct uvr_vk_buffer_create_info buffer_info;
+  buffer_info.allocator = uvrvk->allocator;
+  buffer_info.memoryPropertyFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+  buffer_info.mode = UVR_VK_ALLOCATION_DEDICATED;
+  buffer_info.bufferFlags = 0;
+  buffer_info.bufferSize = uvrvk->size;
+  buffer_info.bufferUsage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+  buffer_info.bufferSharingMode = VK_SHARING_MODE_EXCLUSIVE;
+  buffer_info.queueFamilyIndexCount = 0;
+  buffer_info.pQueueFamilyIndices = NULL;
+
+  ring.buffer = uvr_vk_buffer_create(&buffer_info);
+  if (!ring.buffer.vkBuffer)
+    goto exit_vk_upload_ring;
+
+  if (!ring.buffer.allocation.pMapped) {
+    uvr_utils_log(UVR_DANGER, "[x] uvr_vk_upload_ring_create: staging memory is not host mappable");
+    goto exit_vk_upload_ring_destroy_buffer;
+  }
+
+  struct uvr_vk_command_buffer_create_info cmdbuff_info;
+  cmdbuff_info.vkDevice = ring.vkDevice;
+  cmdbuff_info.queueFamilyIndex = uvrvk->srcQueueFamilyIndex;
+  cmdbuff_info.commandBufferCount = ring.batchCount;
+  cmdbuff_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+
+  ring.vkCommandbuffs = uvr_vk_command_buffer_create(&cmdbuff_info);
+  if (!ring.vkCommandbuffs.vkCommandPool)
+    goto exit_vk_upload_ring_destroy_buffer;
+
+  struct uvr_vk_sync_obj_create_info sync_info;
+  sync_info.vkDevice = ring.vkDevice;
+  sync_info.fenceCount = ring.batchCount;
+  sync_info.semaphoreCount = (uvrvk->timeline) ? 1 : 0;
+  sync_info.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+  sync_info.initialValue = 0;
+
+  ring.vkSyncs = uvr_vk_sync_obj_create(&sync_info);
+  if (!ring.vkSyncs.vkFences)
+    goto exit_vk_upload_ring_destroy_command_buffer;
+
+  ring.batches = calloc(ring.batchCount, sizeof(struct uvr_vk_upload_batch));
+  if (!ring.batches) {
+    uvr_utils_log(UVR_DANGER, "[x] calloc: %s", strerror(errno));
+    goto exit_vk_upload_ring_destroy_sync_obj;
+  }
+
+  ring.vkQueue = uvrvk->vkQueue;
+  ring.srcQueueFamilyIndex = uvrvk->srcQueueFamilyIndex;
+  ring.dstQueueFamilyIndex = uvrvk->dstQueueFamilyIndex;
+  ring.pMapped = ring.buffer.allocation.pMapped;
+  ring.size = uvrvk->size;
+  ring.timeline = uvrvk->timeline;
+  ring.nextUploadId = 1;
+
+  uvr_utils_log(UVR_SUCCESS, "uvr_vk_upload_ring_create: %" PRIu64 " byte ring, %u batches, queue family %u -> %u",
+                             (uint64_t) ring.size, ring.batchCount, ring.srcQueueFamilyIndex, ring.dstQueueFamilyIndex);
+
+  return ring;
+
+exit_vk_upload_ring_destroy_sync_obj:
+  sync_obj_destroy(&ring.vkSyncs);
+exit_vk_upload_ring_destroy_command_buffer:
+  command_buffer_destroy(&ring.vkCommandbuffs);
+exit_vk_upload_ring_destroy_buffer:
+  vkDestroyBuffer(ring.vkDevice, ring.buffer.vkBuffer, hostCallbacks);
+  uvr_vk_allocator_free(ring.buffer.allocator, &ring.buffer.allocation);
+exit_vk_upload_ring:
+  return (struct uvr_vk_upload_ring) { .vkDevice = VK_NULL_HANDLE, .vkQueue = VK_NULL_HANDLE, .pMapped = NULL, .batches = NULL };
+}
+
+
+uint64_t uvr_vk_upload_ring_copy_buffer(struct uvr_vk_upload_ring *ring, struct uvr_vk_upload_buffer_info *uvrvk) {
+  struct uvr_vk_upload_batch *batch = NULL;
+  VkDeviceSize offset = 0, ringBytes = 0;
+  VkCommandBuffer cmdBuffer;
+
+  ringBytes = upload_ring_alloc(ring, uvrvk->size, &offset);
+  if (!ringBytes)
+    return 0;
+
+  batch = upload_batch_begin(ring);
+  if (!batch) {
+    upload_ring_unalloc(ring, ringBytes);
+    return 0;
+  }
+
+  /* Account ring space to the batch first so it's reclaimed even if recording fails below */
+  batch->ringBytes += ringBytes;
+
+  if (batch->bufferBarrierCount == batch->bufferBarrierCap) {
+    if (upload_batch_grow((void **) &batch->bufferBarriers, &batch->bufferAccessMasks,
+                          &batch->bufferBarrierCap, sizeof(VkBufferMemoryBarrier)) == -1)
+      return 0;
+  }
+
+  memcpy((char *) ring->pMapped + offset, uvrvk->pData, uvrvk->size);
+
+  VkBufferCopy region;
+  region.srcOffset = offset;
+  region.dstOffset = uvrvk->dstOffset;
+  region.size = uvrvk->size;
+
+  cmdBuffer = ring->vkCommandbuffs.vkCommandbuffers[ring->batchIndex].buffer;
+  ring->dispatch->CmdCopyBuffer(cmdBuffer, ring->buffer.vkBuffer, uvrvk->dstBuffer, 1, &region);
+
+  VkBufferMemoryBarrier *barrier = &batch->bufferBarriers[batch->bufferBarrierCount];
+  barrier->sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+  barrier->pNext = NULL;
+  barrier->srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+  barrier->dstAccessMask = uvrvk->dstAccessMask;
+  barrier->srcQueueFamilyIndex = ring->srcQueueFamilyIndex;
+  barrier->dstQueueFamilyIndex = ring->dstQueueFamilyIndex;
+  barrier->buffer = uvrvk->dstBuffer;
+  barrier->offset = uvrvk->dstOffset;
+  barrier->size = uvrvk->size;
+
+  batch->bufferAccessMasks[batch->bufferBarrierCount++] = uvrvk->dstAccessMask;
+  batch->dstStageMask |= uvrvk->dstStageMask;
+  batch->bytes += uvrvk->size;
+  ring->bytesUploaded += uvrvk->size;
+  ring->copyCount++;
+
+  return batch->uploadId;
+}
+
+
+/*
+ * Reserves ring space for @uvrvk and records a transition of @levelCount levels plus a copy of @regionCount regions,
+ * whose bufferOffset are relative to the reserved range, into the current batch. The release barrier covers the
+ * same levels. The caller writes the texels through the returned address before the batch is flushed.
+ */
+static uint8_t *upload_ring_image_reserve(struct uvr_vk_upload_ring *ring, struct uvr_vk_upload_image_info *uvrvk, uint32_t levelCount,
+                                          uint32_t regionCount, VkBufferImageCopy *regions, uint64_t *uploadId) {
+  struct uvr_vk_upload_batch *batch = NULL;
+  VkDeviceSize offset = 0, ringBytes = 0;
+  VkCommandBuffer cmdBuffer;
+  uint32_t r;
+
+  ringBytes = upload_ring_alloc(ring, uvrvk->size, &offset);
+  if (!ringBytes)
+    return NULL;
+
+  batch = upload_batch_begin(ring);
+  if (!batch) {
+    upload_ring_unalloc(ring, ringBytes);
+    return NULL;
+  }
+
+  /* Account ring space to the batch first so it's reclaimed even if recording fails below */
+  batch->ringBytes += ringBytes;
+
+  if (batch->imageBarrierCount == batch->imageBarrierCap) {
+    if (upload_batch_grow((void **) &batch->imageBarriers, &batch->imageAccessMasks,
+                          &batch->imageBarrierCap, sizeof(VkImageMemoryBarrier)) == -1)
+      return NULL;
+  }
+
+  VkImageSubresourceRange range;
+  range.aspectMask = uvrvk->imageSubresource.aspectMask;
+  range.baseMipLevel = uvrvk->imageSubresource.mipLevel;
+  range.levelCount = levelCount;
+  range.baseArrayLayer = uvrvk->imageSubresource.baseArrayLayer;
+  range.layerCount = uvrvk->imageSubresource.layerCount;
+
+  VkImageMemoryBarrier to_transfer = {};
+  to_transfer.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+  to_transfer.pNext = NULL;
+  to_transfer.srcAccessMask = 0;
+  to_transfer.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+  to_transfer.oldLayout = uvrvk->oldLayout;
+  to_transfer.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+  to_transfer.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  to_transfer.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  to_transfer.image = uvrvk->dstImage;
+  to_transfer.subresourceRange = range;
+
+  for (r = 0; r < regionCount; r++)
+    regions[r].bufferOffset += offset;
+
+  cmdBuffer = ring->vkCommandbuffs.vkCommandbuffers[ring->batchIndex].buffer;
+  ring->dispatch->CmdPipelineBarrier(cmdBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, NULL, 0, NULL, 1, &to_transfer);
+  ring->dispatch->CmdCopyBufferToImage(cmdBuffer, ring->buffer.vkBuffer, uvrvk->dstImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, regionCount, regions);
+
+  VkImageMemoryBarrier *barrier = &batch->imageBarriers[batch->imageBarrierCount];
+  barrier->sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+  barrier->pNext = NULL;
+  barrier->srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+  barrier->dstAccessMask = uvrvk->dstAccessMask;
+  barrier->oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+  barrier->newLayout = uvrvk->newLayout;
+  barrier->srcQueueFamilyIndex = ring->srcQueueFamilyIndex;
+  barrier->dstQueueFamilyIndex = ring->dstQueueFamilyIndex;
+  barrier->image = uvrvk->dstImage;
+  barrier->subresourceRange = range;
+
+  batch->imageAccessMasks[batch->imageBarrierCount++] = uvrvk->dstAccessMask;
+  batch->dstStageMask |= uvrvk->dstStageMask;
+  batch->bytes += uvrvk->size;
+  ring->bytesUploaded += uvrvk->size;
+  ring->copyCount++;
+
+  *uploadId = batch->uploadId;
+  return (uint8_t *) ring->pMapped + offset;
+}
+
+
+uint64_t uvr_vk_upload_ring_copy_image(struct uvr_vk_upload_ring *ring, struct uvr_vk_upload_image_info *uvrvk) {
+  uint64_t uploadId = 0;
+  uint8_t *mapped = NULL;
+
+  VkBufferImageCopy region;
+  region.bufferOffset = 0;
+  region.bufferRowLength = 0;
+  region.bufferImageHeight = 0;
+  region.imageSubresource = uvrvk->imageSubresource;
+  region.imageOffset = uvrvk->imageOffset;
+  region.imageExtent = uvrvk->imageExtent;
+
+  mapped = upload_ring_image_reserve(ring, uvrvk, 1, 1, &region, &uploadId);
+  if (!mapped)
+    return 0;
+
+  memcpy(mapped, uvrvk->pData, uvrvk->size);
+
+  return uploadId;
+}
+
+
+/*
+ * Drops every copy recorded into the current batch after it failed to end or submit. The command buffer is reset
+ * so the next copy begins a fresh one and the batch's ring space, the most recent allocations, is handed back.
+ */
+static void upload_batch_discard(struct uvr_vk_upload_ring *ring, struct uvr_vk_upload_batch *batch, VkCommandBuffer cmdBuffer) {
+  VkResult res = VK_RESULT_MAX_ENUM;
+
+  res = ring->dispatch->ResetCommandBuffer(cmdBuffer, 0);
+  if (res)
+    uvr_utils_log(UVR_DANGER, "[x] vkResetCommandBuffer: %s", vkres_msg(res));
+
+  upload_ring_unalloc(ring, batch->ringBytes);
+  ring->bytesUploaded -= batch->bytes;
+
+  uvr_utils_log(UVR_WARNING, "uvr_vk_upload_ring_flush: discarded upload %" PRIu64 " (%" PRIu64 " bytes)",
+                             batch->uploadId, (uint64_t) batch->bytes);
+
+  batch->recording = VK_FALSE;
+  batch->ringBytes = batch->bytes = 0;
+  batch->bufferBarrierCount = batch->imageBarrierCount = 0;
+}
+
+
+int uvr_vk_upload_ring_flush(struct uvr_vk_upload_ring *ring, uint64_t *uploadId) {
+  struct uvr_vk_upload_batch *batch = &ring->batches[ring->batchIndex];
+  VkResult res = VK_RESULT_MAX_ENUM;
+  VkPipelineStageFlags dstStageMask;
+  VkBool32 release;
+  uint32_t b;
+
+  if (uploadId)
+    *uploadId = 0;
+
+  if (!batch->recording)
+    return 0;
+
+  VkCommandBuffer cmdBuffer = ring->vkCommandbuffs.vkCommandbuffers[ring->batchIndex].buffer;
+  VkFence fence = ring->vkSyncs.vkFences[ring->batchIndex].fence;
+
+  /*
+   * https://registry.khronos.org/vulkan/specs/1.3-extensions/html/vkspec.html#synchronization-queue-transfers
+   * Release half of a queue family ownership transfer. Destination access is performed by the acquire
+   * barrier recorded on the destination queue, so it's left empty here.
+   */
+  release = (ring->srcQueueFamilyIndex != ring->dstQueueFamilyIndex);
+  if (release) {
+    dstStageMask = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+    for (b = 0; b < batch->bufferBarrierCount; b++)
+      batch->bufferBarriers[b].dstAccessMask = 0;
+    for (b = 0; b < batch->imageBarrierCount; b++)
+      batch->imageBarriers[b].dstAccessMask = 0;
+  } else {
+    dstStageMask = (batch->dstStageMask) ? batch->dstStageMask : VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+    for (b = 0; b < batch->bufferBarrierCount; b++)
+      batch->bufferBarriers[b].srcQueueFamilyIndex = batch->bufferBarriers[b].dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    for (b = 0; b < batch->imageBarrierCount; b++)
+      batch->imageBarriers[b].srcQueueFamilyIndex = batch->imageBarriers[b].dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  }
+
+  ring->dispatch->CmdPipelineBarrier(cmdBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, dstStageMask, 0, 0, NULL,
+                                     batch->bufferBarrierCount, batch->bufferBarriers, batch->imageBarrierCount, batch->imageBarriers);
+
+  res = ring->dispatch->EndCommandBuffer(cmdBuffer);
+  if (res) {
+    uvr_utils_log(UVR_DANGER, "[x] vkEndCommandBuffer: %s", vkres_msg(res));
+    goto exit_vk_upload_ring_flush_discard;
+  }
+
+  res = ring->dispatch->ResetFences(ring->vkDevice, 1, &fence);
+  if (res) {
+    uvr_utils_log(UVR_DANGER, "[x] vkResetFences: %s", vkres_msg(res));
+    goto exit_vk_upload_ring_flush_discard;
+  }
+
+  struct uvr_vk_semaphore_submit signal_semaphore;
+  signal_semaphore.semaphore = (ring->timeline) ? ring->vkSyncs.vkSemaphores[0].semaphore : VK_NULL_HANDLE;
+  signal_semaphore.value = batch->uploadId;
+  signal_semaphore.stageMask = VK_PIPELINE_STAGE_TRANSFER_BIT;
+
+  struct uvr_vk_queue_submit_info submit_info;
+  submit_info.vkQueue = ring->vkQueue;
+  submit_info.commandBufferCount = 1;
+  submit_info.pCommandBuffers = &cmdBuffer;
+  submit_info.waitSemaphoreCount = 0;
+  submit_info.pWaitSemaphores = NULL;
+  submit_info.signalSemaphoreCount = (ring->timeline) ? 1 : 0;
+  submit_info.pSignalSemaphores = &signal_semaphore;
+  submit_info.vkFence = fence;
+
+  /* The fence was reset above, leaving it unsignaled would hang the next wait on this slot */
+  if (uvr_vk_queue_submit(&submit_info) == -1) {
+    fence_resignal(ring->dispatch, ring->vkQueue, fence);
+    goto exit_vk_upload_ring_flush_discard;
+  }
+
+  if (!ring->submitCount)
+    clock_gettime(CLOCK_MONOTONIC, &ring->firstSubmitTime);
+
+  batch->recording = VK_FALSE;
+  batch->submitted = VK_TRUE;
+  ring->submitCount++;
+  ring->nextUploadId++;
+  ring->batchIndex = (ring->batchIndex + 1) % ring->batchCount;
+
+  if (uploadId)
+    *uploadId = batch->uploadId;
+
+  return 0;
+
+exit_vk_upload_ring_flush_discard:
+  upload_batch_discard(ring, batch, cmdBuffer);
+  return -1;
+}
+
+
+int uvr_vk_upload_ring_poll(struct uvr_vk_upload_ring *ring, uint64_t uploadId) {
+  if (uploadId <= ring->retiredUploadId)
+    return 1;
+
+  upload_ring_retire(ring, VK_FALSE);
+
+  return (uploadId <= ring->retiredUploadId);
+}
+
+
+void uvr_vk_upload_ring_record_acquire(struct uvr_vk_upload_ring *ring, VkCommandBuffer cmdBuffer, uint64_t uploadId) {
+  struct uvr_vk_upload_batch *batch = NULL;
+  uint32_t b;
+
+  if (ring->srcQueueFamilyIndex == ring->dstQueueFamilyIndex || !uploadId)
+    return;
+
+  batch = &ring->batches[(uploadId - 1) % ring->batchCount];
+  if (batch->uploadId != uploadId || batch->recording) {
+    uvr_utils_log(UVR_WARNING, "uvr_vk_upload_ring_record_acquire: upload %" PRIu64 " not flushed or already recycled", uploadId);
+    return;
+  }
+
+  /* Acquire half of the ownership transfer, source access was made available by the release barrier */
+  for (b = 0; b < batch->bufferBarrierCount; b++) {
+    batch->bufferBarriers[b].srcAccessMask = 0;
+    batch->bufferBarriers[b].dstAccessMask = batch->bufferAccessMasks[b];
+  }
+
+  for (b = 0; b < batch->imageBarrierCount; b++) {
+    batch->imageBarriers[b].srcAccessMask = 0;
+    batch->imageBarriers[b].dstAccessMask = batch->imageAccessMasks[b];
+  }
+
+  ring->dispatch->CmdPipelineBarrier(cmdBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                                     (batch->dstStageMask) ? batch->dstStageMask : VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 0, NULL,
+                                     batch->bufferBarrierCount, batch->bufferBarriers, batch->imageBarrierCount, batch->imageBarriers);
+}
+
+
+struct uvr_vk_upload_ring_stats uvr_vk_upload_ring_get_stats(struct uvr_vk_upload_ring *ring) {
+  struct uvr_vk_upload_ring_stats stats;
+  struct timespec now;
+  uint64_t elapsedNs;
+
+  memset(&stats, 0, sizeof(stats));
+
+  upload_ring_retire(ring, VK_FALSE);
+
+  stats.bytesUploaded = ring->bytesUploaded;
+  stats.copyCount = ring->copyCount;
+  stats.submitCount = ring->submitCount;
+  stats.stallCount = ring->stallCount;
+  stats.stallMs = ring->stallNs / 1e6;
+  stats.usedBytes = ring->usedBytes;
+  stats.peakUsedBytes = ring->peakUsedBytes;
+
+  if (ring->submitCount) {
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    elapsedNs = timespec_diff_ns(&ring->firstSubmitTime, &now);
+    stats.bytesPerSecond = (elapsedNs) ? (double) ring->bytesRetired / (elapsedNs / 1e9) : 0;
+  }
+
+  return stats;
+}
+
+
+struct uvr_vk_descriptor_thread {
+  uint32_t         setsPerPool;
+  uint32_t         freeCount;
+  uint32_t         freeCap;
+  VkDescriptorPool *freePools;
+  uint64_t         poolCreateCount;
+  uint64_t         setCount;
+  uint64_t         retryCount;
+  uint64_t         resetCount;
+};
+
+
+struct uvr_vk_descriptor_frame_pools {
+  uint32_t         poolCount;
+  uint32_t         poolCap;
+  VkDescriptorPool *pools;
+};
+
+
+struct uvr_vk_descriptor_layout_entry {
+  uint64_t                         hash;
+  VkDescriptorSetLayout            layout;
+  VkDescriptorSetLayoutCreateFlags flags;
+  uint32_t                         bindingCount;
+  VkDescriptorSetLayoutBinding     *bindings;
+  VkDescriptorBindingFlags         *bindingFlags;
+  VkSampler                        *samplers;
+};
+
+
+struct uvr_vk_descriptor_layout_cache {
+  pthread_mutex_t                       lock;
+  uint32_t                              entryCount;
+  uint32_t                              entryCap;
+  struct uvr_vk_descriptor_layout_entry *entries;
+  uint64_t                              hits;
+  uint64_t                              misses;
+};
+
+
+static int descriptor_pool_push(VkDescriptorPool **pools, uint32_t *count, uint32_t *cap, VkDescriptorPool pool) {
+  VkDescriptorPool *newPools = NULL;
+
+  if (*count == *cap) {
+    newPools = realloc(*pools, ((*cap) ? (*cap) * 2 : 8) * sizeof(VkDescriptorPool));
+    if (!newPools) {
+      uvr_utils_log(UVR_DANGER, "[x] realloc: %s", strerror(errno));
+      return -1;
+    }
+
+    *pools = newPools;
+    *cap = (*cap) ? (*cap) * 2 : 8;
+  }
+
+  (*pools)[(*count)++] = pool;
+  return 0;
+}
+
+
+/* Makes a recycled or new pool the current pool of @threadIndex for the active frame */
+static VkDescriptorPool descriptor_pool_next(struct uvr_vk_descriptor_allocator *allocator, uint32_t threadIndex) {
+  struct uvr_vk_descriptor_thread *thread = &allocator->threads[threadIndex];
+  struct uvr_vk_descriptor_frame_pools *fp = &allocator->framePools[allocator->frameIndex * allocator->threadCount + threadIndex];
+  VkDescriptorPool pool = VK_NULL_HANDLE;
+  VkResult res = VK_RESULT_MAX_ENUM;
+  uint32_t p;
+
+  if (thread->freeCount) {
+    pool = thread->freePools[--thread->freeCount];
+  } else {
+    VkDescriptorPoolSize *poolSizes = alloca(allocator->poolSizeCount * sizeof(VkDescriptorPoolSize));
+    for (p = 0; p < allocator->poolSizeCount; p++) {
+      poolSizes[p].type = allocator->poolSizes[p].type;
+      poolSizes[p].descriptorCount = allocator->poolSizes[p].descriptorCount * thread->setsPerPool;
+    }
+
+    VkDescriptorPoolCreateInfo create_info = {};
+    create_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    create_info.pNext = NULL;
+    create_info.flags = allocator->poolFlags;
+    create_info.maxSets = thread->setsPerPool;
+    create_info.poolSizeCount = allocator->poolSizeCount;
+    create_info.pPoolSizes = poolSizes;
+
+    res = vkCreateDescriptorPool(allocator->vkDevice, &create_info, hostCallbacks, &pool);
+    if (res) {
+      uvr_utils_log(UVR_DANGER, "[x] vkCreateDescriptorPool: %s", vkres_msg(res));
+      return VK_NULL_HANDLE;
+    }
+
+    thread->poolCreateCount++;
+
+    /* Grow following pools so a busy thread converges on few large pools */
+    thread->setsPerPool = (thread->setsPerPool * 2 < allocator->maxSetsPerPool) ? thread->setsPerPool * 2 : allocator->maxSetsPerPool;
+  }
+
+  if (descriptor_pool_push(&fp->pools, &fp->poolCount, &fp->poolCap, pool) == -1) {
+    vkDestroyDescriptorPool(allocator->vkDevice, pool, hostCallbacks);
+    return VK_NULL_HANDLE;
+  }
+
+  return pool;
+}
+
+
+/*
+ * Creates a pool sized to @uvrvk for requests even a fresh pool of the thread couldn't satisfy (more sets or descriptors
+ * than a whole pool holds). Layouts from uvr_vk_descriptor_set_layout_get(3) are sized exactly, any other layout falls
+ * back to the allocator's per set average. Pool joins the active frame's list and is recycled like any other.
+ */
+static VkDescriptorPool descriptor_pool_request(struct uvr_vk_descriptor_allocator *allocator, struct uvr_vk_descriptor_set_alloc_info *uvrvk) {
+  struct uvr_vk_descriptor_layout_cache *cache = allocator->layoutCache;
+  struct uvr_vk_descriptor_thread *thread = &allocator->threads[uvrvk->threadIndex];
+  struct uvr_vk_descriptor_frame_pools *fp = &allocator->framePools[allocator->frameIndex * allocator->threadCount + uvrvk->threadIndex];
+  struct uvr_vk_descriptor_layout_entry *entry = NULL;
+  VkDescriptorPoolSize *poolSizes = NULL;
+  VkDescriptorPool pool = VK_NULL_HANDLE;
+  VkResult res = VK_RESULT_MAX_ENUM;
+  uint32_t s, b, e, p, count, poolSizeCount = 0, poolSizeCap, uncachedSets = 0;
+
+  pthread_mutex_lock(&cache->lock);
+
+  /* Worst case every binding adds a descriptor type the allocator's pool sizes don't list */
+  poolSizeCap = allocator->poolSizeCount;
+  for (s = 0; s < uvrvk->setCount; s++) {
+    for (e = 0; e < cache->entryCount; e++) {
+      if (cache->entries[e].layout == uvrvk->pSetLayouts[s]) {
+        poolSizeCap += cache->entries[e].bindingCount;
+        break;
+      }
+    }
+  }
+
+  poolSizes = calloc(poolSizeCap, sizeof(VkDescriptorPoolSize));
+  if (!poolSizes) {
+    uvr_utils_log(UVR_DANGER, "[x] calloc: %s", strerror(errno));
+    pthread_mutex_unlock(&cache->lock);
+    return VK_NULL_HANDLE;
+  }
+
+  for (p = 0; p < allocator->poolSizeCount; p++)
+    poolSizes[poolSizeCount++].type = allocator->poolSizes[p].type;
+
+  for (s = 0; s < uvrvk->setCount; s++) {
+    for (e = 0, entry = NULL; e < cache->entryCount && !entry; e++)
+      if (cache->entries[e].layout == uvrvk->pSetLayouts[s])
+        entry = &cache->entries[e];
+
+    if (!entry) {
+      uncachedSets++;
+      continue;
+    }
+
+    for (b = 0; b < entry->bindingCount; b++) {
+      count = entry->bindings[b].descriptorCount;
+      if ((entry->bindingFlags[b] & VK_DESCRIPTOR_BINDING_VARIABLE_DESCRIPTOR_COUNT_BIT) && uvrvk->pDescriptorCounts)
+        count = uvrvk->pDescriptorCounts[s];
+
+      for (p = 0; p < poolSizeCount && poolSizes[p].type != entry->bindings[b].descriptorType; p++);
+      if (p == poolSizeCount)
+        poolSizes[poolSizeCount++].type = entry->bindings[b].descriptorType;
+
+      poolSizes[p].descriptorCount += count;
+    }
+  }
+
+  pthread_mutex_unlock(&cache->lock);
+
+  for (p = 0; p < allocator->poolSizeCount; p++)
+    poolSizes[p].descriptorCount += allocator->poolSizes[p].descriptorCount * uncachedSets;
+
+  /* VkDescriptorPoolSize { member: descriptorCount } must be greater than zero */
+  for (p = 0, count = 0; p < poolSizeCount; p++)
+    if (poolSizes[p].descriptorCount)
+      poolSizes[count++] = poolSizes[p];
+
+  VkDescriptorPoolCreateInfo create_info = {};
+  create_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+  create_info.pNext = NULL;
+  create_info.flags = allocator->poolFlags;
+  create_info.maxSets = uvrvk->setCount;
+  create_info.poolSizeCount = count;
+  create_info.pPoolSizes = poolSizes;
+
+  res = vkCreateDescriptorPool(allocator->vkDevice, &create_info, hostCallbacks, &pool);
+  free(poolSizes);
+  if (res) {
+    uvr_utils_log(UVR_DANGER, "[x] vkCreateDescriptorPool: %s", vkres_msg(res));
+    return VK_NULL_HANDLE;
+  }
+
+  thread->poolCreateCount++;
+
+  if (descriptor_pool_push(&fp->pools, &fp->poolCount, &fp->poolCap, pool) == -1) {
+    vkDestroyDescriptorPool(allocator->vkDevice, pool, hostCallbacks);
+    return VK_NULL_HANDLE;
+  }
+
+  /* Pool is full after this request, keep the thread's regular pool as the one allocated from next */
+  if (fp->poolCount > 1) {
+    fp->pools[fp->poolCount - 1] = fp->pools[fp->poolCount - 2];
+    fp->pools[fp->poolCount - 2] = pool;
+  }
+
+  return pool;
+}
+
+
+struct uvr_vk_descriptor_allocator uvr_vk_descriptor_allocator_create(struct uvr_vk_descriptor_allocator_create_info *uvrvk) {
+  struct uvr_vk_descriptor_allocator allocator;
+  uint32_t t;
+
+  memset(&allocator, 0, sizeof(allocator));
+
+  if (!uvrvk->poolSizeCount) {
+    uvr_utils_log(UVR_DANGER, "[x] uvr_vk_descriptor_allocator_create: poolSizeCount must be greater than zero");
+    goto exit_vk_descriptor_allocator;
+  }
+
+  allocator.frameCount = (uvrvk->frameCount) ? uvrvk->frameCount : 1;
+  allocator.threadCount = (uvrvk->threadCount) ? uvrvk->threadCount : 1;
+  allocator.setsPerPool = (uvrvk->setsPerPool) ? uvrvk->setsPerPool : 64;
+  allocator.maxSetsPerPool = (uvrvk->maxSetsPerPool) ? uvrvk->maxSetsPerPool : 4096;
+  if (allocator.setsPerPool > allocator.maxSetsPerPool)
+    allocator.setsPerPool = allocator.maxSetsPerPool;
+
+  allocator.poolSizes = calloc(uvrvk->poolSizeCount, sizeof(VkDescriptorPoolSize));
+  if (!allocator.poolSizes) {
+    uvr_utils_log(UVR_DANGER, "[x] calloc: %s", strerror(errno));
+    goto exit_vk_descriptor_allocator;
+  }
+
+  memcpy(allocator.poolSizes, uvrvk->pPoolSizes, uvrvk->poolSizeCount * sizeof(VkDescriptorPoolSize));
+
+  allocator.threads = calloc(allocator.threadCount, sizeof(struct uvr_vk_descriptor_thread));
+  if (!allocator.threads) {
+    uvr_utils_log(UVR_DANGER, "[x] calloc: %s", strerror(errno));
+    goto exit_vk_descriptor_allocator_free_pool_sizes;
+  }
+
+  for (t = 0; t < allocator.threadCount; t++)
+    allocator.threads[t].setsPerPool = allocator.setsPerPool;
+
+  allocator.framePools = calloc(allocator.frameCount * allocator.threadCount, sizeof(struct uvr_vk_descriptor_frame_pools));
+  if (!allocator.framePools) {
+    uvr_utils_log(UVR_DANGER, "[x] calloc: %s", strerror(errno));
+    goto exit_vk_descriptor_allocator_free_threads;
+  }
+
+  allocator.layoutCache = calloc(1, sizeof(struct uvr_vk_descriptor_layout_cache));
+  if (!allocator.layoutCache) {
+    uvr_utils_log(UVR_DANGER, "[x] calloc: %s", strerror(errno));
+    goto exit_vk_descriptor_allocator_free_frame_pools;
+  }
+
+  if (pthread_mutex_init(&allocator.layoutCache->lock, NULL)) {
+    uvr_utils_log(UVR_DANGER, "[x] pthread_mutex_init: failed to initialize layout cache lock");
+    goto exit_vk_descriptor_allocator_free_layout_cache;
+  }
+
+  allocator.vkDevice = uvrvk->vkDevice;
+  allocator.poolSizeCount = uvrvk->poolSizeCount;
+  allocator.poolFlags = uvrvk->poolFlags;
+
+  uvr_utils_log(UVR_SUCCESS, "uvr_vk_descriptor_allocator_create: %u frames, %u threads, %u-%u sets per pool",
+                             allocator.frameCount, allocator.threadCount, allocator.setsPerPool, allocator.maxSetsPerPool);
+
+  return allocator;
+
+exit_vk_descriptor_allocator_free_layout_cache:
+  free(allocator.layoutCache);
+exit_vk_descriptor_allocator_free_frame_pools:
+  free(allocator.framePools);
+exit_vk_descriptor_allocator_free_threads:
+  free(allocator.threads);
+exit_vk_descriptor_allocator_free_pool_sizes:
+  free(allocator.poolSizes);
+exit_vk_descriptor_allocator:
+  return (struct uvr_vk_descriptor_allocator) { .vkDevice = VK_NULL_HANDLE, .poolSizes = NULL, .threads = NULL,
+                                                .framePools = NULL, .layoutCache = NULL };
+}
+
+
+int uvr_vk_descriptor_allocator_next_frame(struct uvr_vk_descriptor_allocator *allocator) {
+  struct uvr_vk_descriptor_frame_pools *fp = NULL;
+  struct uvr_vk_descriptor_thread *thread = NULL;
+  VkResult res = VK_RESULT_MAX_ENUM;
+  uint32_t t, p;
+
+  allocator->frameIndex = (allocator->frameIndex + 1) % allocator->frameCount;
+
+  for (t = 0; t < allocator->threadCount; t++) {
+    thread = &allocator->threads[t];
+    fp = &allocator->framePools[allocator->frameIndex * allocator->threadCount + t];
+
+    for (p = 0; p < fp->poolCount; p++) {
+      res = vkResetDescriptorPool(allocator->vkDevice, fp->pools[p], 0);
+      if (res) {
+        uvr_utils_log(UVR_DANGER, "[x] vkResetDescriptorPool: %s", vkres_msg(res));
+        return -1;
+      }
+
+      thread->resetCount++;
+
+      if (descriptor_pool_push(&thread->freePools, &thread->freeCount, &thread->freeCap, fp->pools[p]) == -1)
+        return -1;
+
+      fp->pools[p] = VK_NULL_HANDLE;
+    }
+
+    fp->poolCount = 0;
+  }
+
+  return 0;
+}
+
+
+int uvr_vk_descriptor_set_alloc(struct uvr_vk_descriptor_set_alloc_info *uvrvk, VkDescriptorSet *pDescriptorSets) {
+  struct uvr_vk_descriptor_allocator *allocator = uvrvk->allocator;
+  struct uvr_vk_descriptor_frame_pools *fp = NULL;
+  VkResult res = VK_RESULT_MAX_ENUM;
+  VkDescriptorPool pool;
+
+  if (uvrvk->threadIndex >= allocator->threadCount) {
+    uvr_utils_log(UVR_DANGER, "[x] uvr_vk_descriptor_set_alloc: thread index %u out of range", uvrvk->threadIndex);
+    return -1;
+  }
+
+  fp = &allocator->framePools[allocator->frameIndex * allocator->threadCount + uvrvk->threadIndex];
+  pool = (fp->poolCount) ? fp->pools[fp->poolCount - 1] : descriptor_pool_next(allocator, uvrvk->threadIndex);
+  if (!pool)
+    return -1;
+
+  VkDescriptorSetVariableDescriptorCountAllocateInfo variable_info = {};
+  variable_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_VARIABLE_DESCRIPTOR_COUNT_ALLOCATE_INFO;
+  variable_info.pNext = NULL;
+  variable_info.descriptorSetCount = uvrvk->setCount;
+  variable_info.pDescriptorCounts = uvrvk->pDescriptorCounts;
+
+  VkDescriptorSetAllocateInfo alloc_info = {};
+  alloc_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+  alloc_info.pNext = (uvrvk->pDescriptorCounts) ? &variable_info : NULL;
+  alloc_info.descriptorPool = pool;
+  alloc_info.descriptorSetCount = uvrvk->setCount;
+  alloc_info.pSetLayouts = uvrvk->pSetLayouts;
+
+  res = vkAllocateDescriptorSets(allocator->vkDevice, &alloc_info, pDescriptorSets);
+  if (res == VK_ERROR_OUT_OF_POOL_MEMORY || res == VK_ERROR_FRAGMENTED_POOL) {
+    allocator->threads[uvrvk->threadIndex].retryCount++;
+
+    alloc_info.descriptorPool = descriptor_pool_next(allocator, uvrvk->threadIndex);
+    if (!alloc_info.descriptorPool)
+      return -1;
+
+    res = vkAllocateDescriptorSets(allocator->vkDevice, &alloc_info, pDescriptorSets);
+  }
+
+  /* Request is larger than a whole pool of the thread */
+  if (res == VK_ERROR_OUT_OF_POOL_MEMORY || res == VK_ERROR_FRAGMENTED_POOL) {
+    alloc_info.descriptorPool = descriptor_pool_request(allocator, uvrvk);
+    if (!alloc_info.descriptorPool)
+      return -1;
+
+    res = vkAllocateDescriptorSets(allocator->vkDevice, &alloc_info, pDescriptorSets);
+  }
+
+  if (res) {
+    uvr_utils_log(UVR_DANGER, "[x] vkAllocateDescriptorSets: %s", vkres_msg(res));
+    return -1;
+  }
+
+  allocator->threads[uvrvk->threadIndex].setCount += uvrvk->setCount;
+
+  return 0;
+}
+
+
+struct layout_binding {
+  VkDescriptorSetLayoutBinding binding;
+  VkDescriptorBindingFlags     flags;
+};
+
+
+static int layout_binding_cmp(const void *a, const void *b) {
+  uint32_t x = ((const struct layout_binding *) a)->binding.binding;
+  uint32_t y = ((const struct layout_binding *) b)->binding.binding;
+  return (x > y) - (x < y);
+}
+
+
+static int layout_entry_match(struct uvr_vk_descriptor_layout_entry *entry, VkDescriptorSetLayoutCreateFlags flags,
+                              uint32_t bindingCount, struct layout_binding *bindings) {
+  uint32_t b;
+
+  if (entry->flags != flags || entry->bindingCount != bindingCount)
+    return 0;
+
+  for (b = 0; b < bindingCount; b++) {
+    if (entry->bindings[b].binding != bindings[b].binding.binding ||
+        entry->bindings[b].descriptorType != bindings[b].binding.descriptorType ||
+        entry->bindings[b].descriptorCount != bindings[b].binding.descriptorCount ||
+        entry->bindings[b].stageFlags != bindings[b].binding.stageFlags ||
+        entry->bindingFlags[b] != bindings[b].flags)
+      return 0;
+
+    if (!entry->bindings[b].pImmutableSamplers != !bindings[b].binding.pImmutableSamplers)
+      return 0;
+
+    if (bindings[b].binding.pImmutableSamplers &&
+        memcmp(entry->bindings[b].pImmutableSamplers, bindings[b].binding.pImmutableSamplers,
+               bindings[b].binding.descriptorCount * sizeof(VkSampler)))
+      return 0;
+  }
+
+  return 1;
+}
+
+
+static void layout_entry_free(struct uvr_vk_descriptor_layout_entry *entry) {
+  free(entry->bindings);
+  free(entry->bindingFlags);
+  free(entry->samplers);
+}
+
+
+VkDescriptorSetLayout uvr_vk_descriptor_set_layout_get(struct uvr_vk_descriptor_allocator *allocator,
+                                                       struct uvr_vk_descriptor_set_layout_info *uvrvk) {
+  struct uvr_vk_descriptor_layout_cache *cache = allocator->layoutCache;
+  struct uvr_vk_descriptor_layout_entry *entry = NULL, *newEntries = NULL;
+  VkDescriptorSetLayout layout = VK_NULL_HANDLE;
+  VkResult res = VK_RESULT_MAX_ENUM;
+  uint32_t b, e, samplerCount = 0;
+  uint64_t hash;
+
+  /* Canonicalize binding order so equal signatures hash equal regardless of how the caller listed them */
+  struct layout_binding *bindings = alloca(uvrvk->bindingCount * sizeof(struct layout_binding));
+  for (b = 0; b < uvrvk->bindingCount; b++) {
+    bindings[b].binding = uvrvk->pBindings[b];
+    bindings[b].flags = (uvrvk->pBindingFlags) ? uvrvk->pBindingFlags[b] : 0;
+  }
+
+  qsort(bindings, uvrvk->bindingCount, sizeof(struct layout_binding), layout_binding_cmp);
+
+  hash = fnv1a64(&uvrvk->flags, sizeof(uvrvk->flags));
+  for (b = 0; b < uvrvk->bindingCount; b++) {
+    hash = fnv1a64_update(hash, &bindings[b].binding.binding, sizeof(uint32_t));
+    hash = fnv1a64_update(hash, &bindings[b].binding.descriptorType, sizeof(VkDescriptorType));
+    hash = fnv1a64_update(hash, &bindings[b].binding.descriptorCount, sizeof(uint32_t));
+    hash = fnv1a64_update(hash, &bindings[b].binding.stageFlags, sizeof(VkShaderStageFlags));
+    hash = fnv1a64_update(hash, &bindings[b].flags, sizeof(VkDescriptorBindingFlags));
+    if (bindings[b].binding.pImmutableSamplers) {
+      hash = fnv1a64_update(hash, bindings[b].binding.pImmutableSamplers, bindings[b].binding.descriptorCount * sizeof(VkSampler));
+      samplerCount += bindings[b].binding.descriptorCount;
+    }
+  }
+
+  pthread_mutex_lock(&cache->lock);
+
+  for (e = 0; e < cache->entryCount; e++) {
+    if (cache->entries[e].hash == hash && layout_entry_match(&cache->entries[e], uvrvk->flags, uvrvk->bindingCount, bindings)) {
+      cache->hits++;
+      layout = cache->entries[e].layout;
+      goto exit_vk_descriptor_set_layout_unlock;
+    }
+  }
+
+  if (cache->entryCount == cache->entryCap) {
+    newEntries = realloc(cache->entries, ((cache->entryCap) ? cache->entryCap * 2 : 16) * sizeof(struct uvr_vk_descriptor_layout_entry));
+    if (!newEntries) {
+      uvr_utils_log(UVR_DANGER, "[x] realloc: %s", strerror(errno));
+      goto exit_vk_descriptor_set_layout_unlock;
+    }
+
+    cache->entries = newEntries;
+    cache->entryCap = (cache->entryCap) ? cache->entryCap * 2 : 16;
+  }
+
+  entry = &cache->entries[cache->entryCount];
+  memset(entry, 0, sizeof(struct uvr_vk_descriptor_layout_entry));
+
+  entry->bindings = calloc(uvrvk->bindingCount + 1, sizeof(VkDescriptorSetLayoutBinding));
+  entry->bindingFlags = calloc(uvrvk->bindingCount + 1, sizeof(VkDescriptorBindingFlags));
+  entry->samplers = calloc(samplerCount + 1, sizeof(VkSampler));
+  if (!entry->bindings || !entry->bindingFlags || !entry->samplers) {
+    uvr_utils_log(UVR_DANGER, "[x] calloc: %s", strerror(errno));
+    goto exit_vk_descriptor_set_layout_free_entry;
+  }
+
+  samplerCount = 0;
+  for (b = 0; b < uvrvk->bindingCount; b++) {
+    entry->bindings[b] = bindings[b].binding;
+    entry->bindingFlags[b] = bindings[b].flags;
+    if (bindings[b].binding.pImmutableSamplers) {
+      memcpy(&entry->samplers[samplerCount], bindings[b].binding.pImmutableSamplers, bindings[b].binding.descriptorCount * sizeof(VkSampler));
+      entry->bindings[b].pImmutableSamplers = &entry->samplers[samplerCount];
+      samplerCount += bindings[b].binding.descriptorCount;
+    }
+  }
+
+  VkDescriptorSetLayoutBindingFlagsCreateInfo binding_flags_info = {};
+  binding_flags_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+  binding_flags_info.pNext = NULL;
+  binding_flags_info.bindingCount = uvrvk->bindingCount;
+  binding_flags_info.pBindingFlags = entry->bindingFlags;
+
+  VkDescriptorSetLayoutCreateInfo create_info = {};
+  create_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+  create_info.pNext = (uvrvk->pBindingFlags) ? &binding_flags_info : NULL;
+  create_info.flags = uvrvk->flags;
+  create_info.bindingCount = uvrvk->bindingCount;
+  create_info.pBindings = entry->bindings;
+
+  res = vkCreateDescriptorSetLayout(allocator->vkDevice, &create_info, hostCallbacks, &entry->layout);
+  if (res) {
+    uvr_utils_log(UVR_DANGER, "[x] vkCreateDescriptorSetLayout: %s", vkres_msg(res));
+    goto exit_vk_descriptor_set_layout_free_entry;
+  }
+
+  entry->hash = hash;
+  entry->flags = uvrvk->flags;
+  entry->bindingCount = uvrvk->bindingCount;
+  layout = entry->layout;
+
+  cache->entryCount++;
+  cache->misses++;
+
+  uvr_utils_log(UVR_SUCCESS, "uvr_vk_descriptor_set_layout_get: VkDescriptorSetLayout successfully created retval(%p) hash(%016" PRIx64 ")",
+                             layout, hash);
+
+  goto exit_vk_descriptor_set_layout_unlock;
+
+exit_vk_descriptor_set_layout_free_entry:
+  layout_entry_free(entry);
+exit_vk_descriptor_set_layout_unlock:
+  pthread_mutex_unlock(&cache->lock);
+  return layout;
+}
+
+
+struct uvr_vk_descriptor_allocator_stats uvr_vk_descriptor_allocator_get_stats(struct uvr_vk_descriptor_allocator *allocator) {
+  struct uvr_vk_descriptor_allocator_stats stats;
+  uint32_t t, f;
+
+  memset(&stats, 0, sizeof(stats));
+
+  for (t = 0; t < allocator->threadCount; t++) {
+    stats.freePoolCount += allocator->threads[t].freeCount;
+    stats.poolCreateCount += allocator->threads[t].poolCreateCount;
+    stats.setCount += allocator->threads[t].setCount;
+    stats.retryCount += allocator->threads[t].retryCount;
+    stats.resetCount += allocator->threads[t].resetCount;
+  }
+
+  stats.poolCount = stats.freePoolCount;
+  for (f = 0; f < allocator->frameCount * allocator->threadCount; f++)
+    stats.poolCount += allocator->framePools[f].poolCount;
+
+  pthread_mutex_lock(&allocator->layoutCache->lock);
+  stats.layoutCount = allocator->layoutCache->entryCount;
+  stats.layoutHits = allocator->layoutCache->hits;
+  stats.layoutMisses = allocator->layoutCache->misses;
+  pthread_mutex_unlock(&allocator->layoutCache->lock);
+
+  return stats;
+}
+
+
+struct uvr_vk_bindless_retired {
+  uint32_t slot;
+  uint64_t frameNumber;
+};
+
+
+struct uvr_vk_bindless_table uvr_vk_bindless_table_create(struct uvr_vk_bindless_table_create_info *uvrvk) {
+  VkResult res = VK_RESULT_MAX_ENUM;
+  struct uvr_vk_bindless_table table;
+  uint32_t maxSlots;
+
+  memset(&table, 0, sizeof(table));
+
+  /* Zero would hand a freed slot out again while frames still in flight sample it */
+  if (!uvrvk->framesInFlight) {
+    uvr_utils_log(UVR_DANGER, "[x] uvr_vk_bindless_table_create: framesInFlight must be greater than zero");
+    goto exit_vk_bindless_table;
+  }
+
+  VkPhysicalDeviceDescriptorIndexingProperties indexing_props = {};
+  indexing_props.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES;
+  indexing_props.pNext = NULL;
+
+  VkPhysicalDeviceProperties2 props2 = {};
+  props2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+  props2.pNext = &indexing_props;
+
+  vkGetPhysicalDeviceProperties2(uvrvk->vkPhdev, &props2);
+
+  maxSlots = indexing_props.maxPerStageDescriptorUpdateAfterBindSampledImages;
+  if (uvrvk->descriptorType == VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER &&
+      indexing_props.maxPerStageDescriptorUpdateAfterBindSamplers < maxSlots)
+    maxSlots = indexing_props.maxPerStageDescriptorUpdateAfterBindSamplers;
+
+  /* Without descriptor indexing the update after bind limits are never written */
+  if (!maxSlots) {
+    uvr_utils_log(UVR_DANGER, "[x] uvr_vk_bindless_table_create: device limit is 0 update after bind slots, "
+                              "descriptor indexing unsupported or not enabled");
+    goto exit_vk_bindless_table;
+  }
+
+  table.capacity = (uvrvk->capacity < maxSlots) ? uvrvk->capacity : maxSlots;
+  if (!table.capacity) {
+    uvr_utils_log(UVR_DANGER, "[x] uvr_vk_bindless_table_create: capacity must be greater than zero");
+    goto exit_vk_bindless_table;
+  }
+
+  if (table.capacity != uvrvk->capacity)
+    uvr_utils_log(UVR_WARNING, "uvr_vk_bindless_table_create: capacity clamped to device limit of %u", table.capacity);
+
+  table.freeSlots = calloc(table.capacity, sizeof(uint32_t));
+  table.liveSlots = calloc((table.capacity + 31) / 32, sizeof(uint32_t));
+  table.retired = calloc(table.capacity, sizeof(struct uvr_vk_bindless_retired));
+  if (!table.freeSlots || !table.liveSlots || !table.retired) {
+    uvr_utils_log(UVR_DANGER, "[x] calloc: %s", strerror(errno));
+    goto exit_vk_bindless_table_free_arrays;
+  }
+
+  /*
+   * PARTIALLY_BOUND: unused slots may hold stale or no descriptors.
+   * UPDATE_AFTER_BIND/UPDATE_UNUSED_WHILE_PENDING: slots may be written while the set is bound by
+   * command buffers that are pending execution, as long as those command buffers don't index them.
+   */
+  VkDescriptorBindingFlags binding_flags = VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT |
+                                           VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT;
+
+  VkDescriptorSetLayoutBindingFlagsCreateInfo binding_flags_info = {};
+  binding_flags_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+  binding_flags_info.pNext = NULL;
+  binding_flags_info.bindingCount = 1;
+  binding_flags_info.pBindingFlags = &binding_flags;
+
+  VkDescriptorSetLayoutBinding binding = {};
+  binding.binding = 0;
+  binding.descriptorType = uvrvk->descriptorType;
+  binding.descriptorCount = table.capacity;
+  binding.stageFlags = uvrvk->stageFlags;
+  binding.pImmutableSamplers = NULL;
+
+  VkDescriptorSetLayoutCreateInfo layout_info = {};
+  layout_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+  layout_info.pNext = &binding_flags_info;
+  layout_info.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT;
+  layout_info.bindingCount = 1;
+  layout_info.pBindings = &binding;
+
+  res = vkCreateDescriptorSetLayout(uvrvk->vkDevice, &layout_info, hostCallbacks, &table.vkDescriptorSetLayout);
+  if (res) {
+    uvr_utils_log(UVR_DANGER, "[x] vkCreateDescriptorSetLayout: %s", vkres_msg(res));
+    goto exit_vk_bindless_table_free_arrays;
+  }
+
+  VkDescriptorPoolSize pool_size;
+  pool_size.type = uvrvk->descriptorType;
+  pool_size.descriptorCount = table.capacity;
+
+  VkDescriptorPoolCreateInfo pool_info = {};
+  pool_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+  pool_info.pNext = NULL;
+  pool_info.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT;
+  pool_info.maxSets = 1;
+  pool_info.poolSizeCount = 1;
+  pool_info.pPoolSizes = &pool_size;
+
+  res = vkCreateDescriptorPool(uvrvk->vkDevice, &pool_info, hostCallbacks, &table.vkDescriptorPool);
+  if (res) {
+    uvr_utils_log(UVR_DANGER, "[x] vkCreateDescriptorPool: %s", vkres_msg(res));
+    goto exit_vk_bindless_table_destroy_layout;
+  }
+
+  VkDescriptorSetAllocateInfo alloc_info = {};
+  alloc_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+  alloc_info.pNext = NULL;
+  alloc_info.descriptorPool = table.vkDescriptorPool;
+  alloc_info.descriptorSetCount = 1;
+  alloc_info.pSetLayouts = &table.vkDescriptorSetLayout;
+
+  res = vkAllocateDescriptorSets(uvrvk->vkDevice, &alloc_info, &table.vkDescriptorSet);
+  if (res) {
+    uvr_utils_log(UVR_DANGER, "[x] vkAllocateDescriptorSets: %s", vkres_msg(res));
+    goto exit_vk_bindless_table_destroy_pool;
+  }
+
+  table.vkDevice = uvrvk->vkDevice;
+  table.descriptorType = uvrvk->descriptorType;
+  table.framesInFlight = uvrvk->framesInFlight;
+
+  uvr_utils_log(UVR_SUCCESS, "uvr_vk_bindless_table_create: VkDescriptorSet successfully created retval(%p) with %u slots",
+                             table.vkDescriptorSet, table.capacity);
+
+  return table;
+
+exit_vk_bindless_table_destroy_pool:
+  vkDestroyDescriptorPool(uvrvk->vkDevice, table.vkDescriptorPool, hostCallbacks);
+exit_vk_bindless_table_destroy_layout:
+  vkDestroyDescriptorSetLayout(uvrvk->vkDevice, table.vkDescriptorSetLayout, hostCallbacks);
+exit_vk_bindless_table_free_arrays:
+  free(table.freeSlots);
+  free(table.liveSlots);
+  free(table.retired);
+exit_vk_bindless_table:
+  return (struct uvr_vk_bindless_table) { .vkDevice = VK_NULL_HANDLE, .vkDescriptorSetLayout = VK_NULL_HANDLE,
+                                          .vkDescriptorPool = VK_NULL_HANDLE, .vkDescriptorSet = VK_NULL_HANDLE,
+                                          .freeSlots = NULL, .liveSlots = NULL, .retired = NULL };
+}
+
+
+void uvr_vk_bindless_table_update(struct uvr_vk_bindless_table *table, uint32_t slot, VkImageView imageView,
+                                  VkImageLayout imageLayout, VkSampler sampler) {
+  VkDescriptorImageInfo image_info;
+  image_info.sampler = (table->descriptorType == VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER) ? sampler : VK_NULL_HANDLE;
+  image_info.imageView = imageView;
+  image_info.imageLayout = imageLayout;
+
+  VkWriteDescriptorSet write = {};
+  write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+  write.pNext = NULL;
+  write.dstSet = table->vkDescriptorSet;
+  write.dstBinding = 0;
+  write.dstArrayElement = slot;
+  write.descriptorCount = 1;
+  write.descriptorType = table->descriptorType;
+  write.pImageInfo = &image_info;
+  write.pBufferInfo = NULL;
+  write.pTexelBufferView = NULL;
+
+  vkUpdateDescriptorSets(table->vkDevice, 1, &write, 0, NULL);
+}
+
+
+uint32_t uvr_vk_bindless_table_alloc(struct uvr_vk_bindless_table *table, VkImageView imageView, VkImageLayout imageLayout, VkSampler sampler) {
+  uint32_t slot;
+
+  if (table->freeCount) {
+    slot = table->freeSlots[--table->freeCount];
+  } else if (table->highWater < table->capacity) {
+    slot = table->highWater++;
+  } else {
+    uvr_utils_log(UVR_DANGER, "[x] uvr_vk_bindless_table_alloc: all %u slots in use (%u awaiting reuse)", table->capacity, table->retiredCount);
+    return UVR_VK_BINDLESS_INVALID_SLOT;
+  }
+
+  uvr_vk_bindless_table_update(table, slot, imageView, imageLayout, sampler);
+
+  table->liveSlots[slot / 32] |= 1u << (slot % 32);
+  table->slotsInUse++;
+  if (table->slotsInUse > table->peakSlotsInUse)
+    table->peakSlotsInUse = table->slotsInUse;
+
+  return slot;
+}
+
+
+void uvr_vk_bindless_table_free(struct uvr_vk_bindless_table *table, uint32_t slot) {
+  struct uvr_vk_bindless_retired *retired = NULL;
+
+  /* A second free would overrun @retired and later hand the slot out twice */
+  if (slot >= table->highWater || !(table->liveSlots[slot / 32] & (1u << (slot % 32)))) {
+    uvr_utils_log(UVR_WARNING, "uvr_vk_bindless_table_free: slot %u isn't allocated, ignoring", slot);
+    return;
+  }
+
+  table->liveSlots[slot / 32] &= ~(1u << (slot % 32));
+
+  retired = &table->retired[(table->retiredHead + table->retiredCount) % table->capacity];
+  retired->slot = slot;
+  retired->frameNumber = table->frameNumber;
+
+  table->retiredCount++;
+  table->slotsInUse--;
+}
+
+
+void uvr_vk_bindless_table_next_frame(struct uvr_vk_bindless_table *table) {
+  struct uvr_vk_bindless_retired *retired = NULL;
+
+  table->frameNumber++;
+
+  /* Slots are retired in the order they were freed, stop at the first one the GPU may still access */
+  while (table->retiredCount) {
+    retired = &table->retired[table->retiredHead];
+    if (retired->frameNumber + table->framesInFlight > table->frameNumber)
+      break;
+
+    table->freeSlots[table->freeCount++] = retired->slot;
+    table->retiredHead = (table->retiredHead + 1) % table->capacity;
+    table->retiredCount--;
+  }
+}
+
+
+struct uvr_vk_deletion_entry {
+  VkSemaphore          timelineSemaphore;
+  uint64_t             timelineValue;
+  VkFence              fence;
+  struct uvr_vk_buffer buffer;
+  struct uvr_vk_image  image;
+  VkImageView          imageView;
+  VkPipeline           pipeline;
+  VkFramebuffer        framebuffer;
+  VkDescriptorPool     descriptorPool;
+  uint32_t             descriptorSetCount;
+  VkDescriptorSet      *pDescriptorSets;
+  VkDeviceSize         bytes;
+};
+
+
+struct uvr_vk_deletion_queue uvr_vk_deletion_queue_create(struct uvr_vk_deletion_queue_create_info *uvrvk) {
+  struct uvr_vk_deletion_entry *entries = NULL;
+  uint32_t capacity = (uvrvk->initialCapacity) ? uvrvk->initialCapacity : 64;
+
+  if (!uvrvk->vkDevice) {
+    uvr_utils_log(UVR_DANGER, "[x] uvr_vk_deletion_queue_create: VkDevice not initialized");
+    goto exit_vk_deletion_queue;
+  }
+
+  entries = calloc(capacity, sizeof(struct uvr_vk_deletion_entry));
+  if (!entries) {
+    uvr_utils_log(UVR_DANGER, "[x] calloc: %s", strerror(errno));
+    goto exit_vk_deletion_queue;
+  }
+
+  return (struct uvr_vk_deletion_queue) { .vkDevice = uvrvk->vkDevice, .entryCount = 0, .entryCapacity = capacity,
+                                          .entries = entries, .pendingBytes = 0, .peakPendingBytes = 0,
+                                          .destroyedCount = 0, .collectCount = 0 };
+
+exit_vk_deletion_queue:
+  return (struct uvr_vk_deletion_queue) { .vkDevice = VK_NULL_HANDLE, .entryCount = 0, .entryCapacity = 0, .entries = NULL,
+                                          .pendingBytes = 0, .peakPendingBytes = 0, .destroyedCount = 0, .collectCount = 0 };
+}
+
+
+int uvr_vk_deletion_queue_push(struct uvr_vk_deletion_queue *queue, struct uvr_vk_deletion_queue_push_info *uvrvk) {
+  struct uvr_vk_deletion_entry *entry = NULL, *entries = NULL;
+  VkDescriptorSet *sets = NULL;
+  uint32_t i, capacity;
+
+  if (!queue->entries)
+    return -1;
+
+  if (!uvrvk->timelineSemaphore && !uvrvk->fence) {
+    uvr_utils_log(UVR_DANGER, "[x] uvr_vk_deletion_queue_push: must pass either a timeline semaphore or a fence");
+    return -1;
+  }
+
+  if (uvrvk->descriptorSetCount && !uvrvk->descriptorPool) {
+    uvr_utils_log(UVR_DANGER, "[x] uvr_vk_deletion_queue_push: descriptor sets passed without the VkDescriptorPool they came from");
+    return -1;
+  }
+
+  if (queue->entryCount == queue->entryCapacity) {
+    capacity = queue->entryCapacity * 2;
+    entries = realloc(queue->entries, capacity * sizeof(struct uvr_vk_deletion_entry));
+    if (!entries) {
+      uvr_utils_log(UVR_DANGER, "[x] realloc: %s", strerror(errno));
+      return -1;
+    }
+
+    queue->entries = entries;
+    queue->entryCapacity = capacity;
+  }
+
+  if (uvrvk->descriptorSetCount && uvrvk->pDescriptorSets) {
+    sets = calloc(uvrvk->descriptorSetCount, sizeof(VkDescriptorSet));
+    if (!sets) {
+      uvr_utils_log(UVR_DANGER, "[x] calloc: %s", strerror(errno));
+      return -1;
+    }
+    memcpy(sets, uvrvk->pDescriptorSets, uvrvk->descriptorSetCount * sizeof(VkDescriptorSet));
+  }
+
+  entry = &queue->entries[queue->entryCount++];
+  memset(entry, 0, sizeof(struct uvr_vk_deletion_entry));
+  entry->timelineSemaphore = uvrvk->timelineSemaphore;
+  entry->timelineValue = uvrvk->timelineValue;
+  entry->fence = (uvrvk->timelineSemaphore) ? VK_NULL_HANDLE : uvrvk->fence;
+  entry->imageView = uvrvk->imageView;
+  entry->pipeline = uvrvk->pipeline;
+  entry->framebuffer = uvrvk->framebuffer;
+  entry->descriptorPool = uvrvk->descriptorPool;
+  entry->descriptorSetCount = (sets) ? uvrvk->descriptorSetCount : 0;
+  entry->pDescriptorSets = sets;
+
+  /* Queue takes ownership, caller's copies are nulled so uvr_vk_destory(3) won't double free */
+  if (uvrvk->buffer) {
+    entry->buffer = *uvrvk->buffer;
+    entry->bytes += entry->buffer.allocation.size;
+    memset(uvrvk->buffer, 0, sizeof(struct uvr_vk_buffer));
+  }
+
+  if (uvrvk->image) {
+    entry->image = *uvrvk->image;
+    if (entry->image.allocations) {
+      for (i = 0; i < entry->image.imageCount; i++)
+        entry->bytes += entry->image.allocations[i].size;
+    }
+    memset(uvrvk->image, 0, sizeof(struct uvr_vk_image));
+  }
+
+  queue->pendingBytes += entry->bytes;
+  if (queue->pendingBytes > queue->peakPendingBytes)
+    queue->peakPendingBytes = queue->pendingBytes;
+
+  return 0;
+}
+
+
+static uint32_t deletion_entry_destroy(VkDevice device, struct uvr_vk_deletion_entry *entry) {
+  uint32_t i, destroyed = 0;
+
+  if (entry->pDescriptorSets) {
+    vkFreeDescriptorSets(device, entry->descriptorPool, entry->descriptorSetCount, entry->pDescriptorSets);
+    destroyed += entry->descriptorSetCount;
+    free(entry->pDescriptorSets);
+  }
+
+  if (entry->framebuffer) {
+    vkDestroyFramebuffer(device, entry->framebuffer, hostCallbacks);
+    destroyed++;
+  }
+
+  if (entry->pipeline) {
+    vkDestroyPipeline(device, entry->pipeline, hostCallbacks);
+    destroyed++;
+  }
+
+  if (entry->imageView) {
+    vkDestroyImageView(device, entry->imageView, hostCallbacks);
+    destroyed++;
+  }
+
+  for (i = 0; i < entry->image.imageCount; i++) {
+    if (entry->image.vkImageViews && entry->image.vkImageViews[i].view)
+      vkDestroyImageView(entry->image.vkDevice, entry->image.vkImageViews[i].view, hostCallbacks);
+    /* Swapchain images are owned by the swapchain, only destroy images uvr_vk_image_create2 created */
+    if (entry->image.allocations) {
+      if (entry->image.vkImages[i].image)
+        vkDestroyImage(entry->image.vkDevice, entry->image.vkImages[i].image, hostCallbacks);
+      uvr_vk_allocator_free(entry->image.allocator, &entry->image.allocations[i]);
+    }
+    destroyed++;
+  }
+
+  free(entry->image.vkImages);
+  free(entry->image.vkImageViews);
+  free(entry->image.allocations);
+
+  if (entry->buffer.vkBuffer) {
+    vkDestroyBuffer(entry->buffer.vkDevice, entry->buffer.vkBuffer, hostCallbacks);
+    uvr_vk_allocator_free(entry->buffer.allocator, &entry->buffer.allocation);
+    destroyed++;
+  }
+
+  return destroyed;
+}
+
+
+/*
+ * Destroys every entry flagged in @ready and compacts the remaining ones to
+ * the front keeping push order.
+ */
+static uint32_t deletion_queue_release(struct uvr_vk_deletion_queue *queue, bool *ready) {
+  uint32_t e, kept = 0, destroyed = 0;
+
+  for (e = 0; e < queue->entryCount; e++) {
+    if (!ready[e]) {
+      if (kept != e)
+        queue->entries[kept] = queue->entries[e];
+      kept++;
+      continue;
+    }
+
+    destroyed += deletion_entry_destroy(queue->vkDevice, &queue->entries[e]);
+    queue->pendingBytes -= queue->entries[e].bytes;
+  }
+
+  queue->entryCount = kept;
+  queue->destroyedCount += destroyed;
+
+  return destroyed;
+}
+
+
+#define UVR_VK_DELETION_QUEUE_MAX_TIMELINES 8
+
+uint32_t uvr_vk_deletion_queue_collect(struct uvr_vk_deletion_queue *queue) {
+  VkSemaphore semaphores[UVR_VK_DELETION_QUEUE_MAX_TIMELINES];
+  uint64_t values[UVR_VK_DELETION_QUEUE_MAX_TIMELINES];
+  uint32_t e, s, semaphoreCount = 0, readyCount = 0, destroyed = 0;
+  struct uvr_vk_deletion_entry *entry = NULL;
+  bool *ready = NULL;
+  uint64_t value;
+  VkResult res;
+
+  if (!queue->entryCount)
+    return 0;
+
+  ready = calloc(queue->entryCount, sizeof(bool));
+  if (!ready) {
+    uvr_utils_log(UVR_DANGER, "[x] calloc: %s", strerror(errno));
+    return 0;
+  }
+
+  for (e = 0; e < queue->entryCount; e++) {
+    entry = &queue->entries[e];
+
+    if (entry->fence) {
+      ready[e] = (vkGetFenceStatus(queue->vkDevice, entry->fence) == VK_SUCCESS);
+      readyCount += ready[e];
+      continue;
+    }
+
+    /* Query each timeline counter once per collect, most applications only have one or two */
+    for (s = 0; s < semaphoreCount; s++)
+      if (semaphores[s] == entry->timelineSemaphore)
+        break;
+
+    if (s < semaphoreCount) {
+      value = values[s];
+    } else {
+      res = vkGetSemaphoreCounterValue(queue->vkDevice, entry->timelineSemaphore, &value);
+      if (res) {
+        uvr_utils_log(UVR_DANGER, "[x] vkGetSemaphoreCounterValue: %s", vkres_msg(res));
+        continue;
+      }
+
+      if (semaphoreCount < UVR_VK_DELETION_QUEUE_MAX_TIMELINES) {
+        semaphores[semaphoreCount] = entry->timelineSemaphore;
+        values[semaphoreCount++] = value;
+      }
+    }
+
+    ready[e] = (value >= entry->timelineValue);
+    readyCount += ready[e];
+  }
+
+  if (readyCount) {
+    destroyed = deletion_queue_release(queue, ready);
+    queue->collectCount++;
+  }
+
+  free(ready);
+  return destroyed;
+}
+
+
+void uvr_vk_deletion_queue_flush(struct uvr_vk_deletion_queue *queue) {
+  struct uvr_vk_deletion_entry *entry = NULL;
+  VkSemaphoreWaitInfo waitInfo;
+  bool *ready = NULL;
+  VkResult res;
+  uint32_t e;
+
+  if (!queue->entryCount)
+    return;
+
+  ready = calloc(queue->entryCount, sizeof(bool));
+  if (!ready) {
+    uvr_utils_log(UVR_DANGER, "[x] calloc: %s", strerror(errno));
+    return;
+  }
+
+  for (e = 0; e < queue->entryCount; e++) {
+    entry = &queue->entries[e];
+
+    if (entry->fence) {
+      res = vkWaitForFences(queue->vkDevice, 1, &entry->fence, VK_TRUE, UINT64_MAX);
+      if (res) {
+        uvr_utils_log(UVR_DANGER, "[x] vkWaitForFences: %s", vkres_msg(res));
+        continue;
+      }
+    } else {
+      waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+      waitInfo.pNext = NULL;
+      waitInfo.flags = 0;
+      waitInfo.semaphoreCount = 1;
+      waitInfo.pSemaphores = &entry->timelineSemaphore;
+      waitInfo.pValues = &entry->timelineValue;
+
+      res = vkWaitSemaphores(queue->vkDevice, &waitInfo, UINT64_MAX);
+      if (res) {
+        uvr_utils_log(UVR_DANGER, "[x] vkWaitSemaphores: %s", vkres_msg(res));
+        continue;
+      }
+    }
+
+    ready[e] = true;
+  }
+
+  deletion_queue_release(queue, ready);
+  free(ready);
+}
+
+
+/*
+ * Placed right before the pointer returned to the implementation. @offset is the
+ * distance from the start of the underlying block so it can be freed/rewound.
+ */
+struct uvr_vk_host_allocation {
+  size_t                  size;
+  size_t                  offset;
+  VkSystemAllocationScope scope;
+  bool                    arena;
+};
+
+
+static size_t host_align(size_t value, size_t alignment) {
+  return (value + alignment - 1) & ~(alignment - 1);
+}
+
+
+/* Must be called with @allocator->lock held */
+static void *host_allocation_create(struct uvr_vk_host_allocator *allocator, size_t size,
+                                    size_t alignment, VkSystemAllocationScope scope) {
+  struct uvr_vk_host_allocation *header = NULL;
+  unsigned char *block = NULL, *ptr = NULL;
+  size_t blockSize, arenaStart;
+  bool arena = false;
+
+  /* Keeps the header in front of the returned pointer naturally aligned */
+  if (alignment < _Alignof(struct uvr_vk_host_allocation))
+    alignment = _Alignof(struct uvr_vk_host_allocation);
+
+  blockSize = sizeof(struct uvr_vk_host_allocation) + alignment - 1 + size;
+
+  if (scope == VK_SYSTEM_ALLOCATION_SCOPE_COMMAND && allocator->arena) {
+    arenaStart = host_align((uintptr_t) allocator->arena + allocator->arenaOffset + sizeof(struct uvr_vk_host_allocation),
+                            alignment) - (uintptr_t) allocator->arena;
+    if (arenaStart + size <= allocator->arenaSize) {
+      block = allocator->arena + allocator->arenaOffset;
+      ptr = allocator->arena + arenaStart;
+      allocator->arenaOffset = arenaStart + size;
+      allocator->arenaLive++;
+      allocator->arenaAllocations++;
+      if (allocator->arenaOffset > allocator->arenaPeakBytes)
+        allocator->arenaPeakBytes = allocator->arenaOffset;
+      arena = true;
+    } else {
+      allocator->arenaFallbacks++;
+    }
+  }
+
+  if (!block) {
+    block = malloc(blockSize);
+    if (!block)
+      return NULL;
+    ptr = (unsigned char *) host_align((uintptr_t) block + sizeof(struct uvr_vk_host_allocation), alignment);
+  }
+
+  header = (struct uvr_vk_host_allocation *) ptr - 1;
+  header->size = size;
+  header->offset = ptr - block;
+  header->scope = scope;
+  header->arena = arena;
+
+  allocator->scopeBytes[scope] += size;
+  allocator->scopeAllocations[scope]++;
+  allocator->currentBytes += size;
+  if (allocator->currentBytes > allocator->peakBytes)
+    allocator->peakBytes = allocator->currentBytes;
+
+  return ptr;
+}
+
+
+/* Must be called with @allocator->lock held */
+static void host_allocation_destroy(struct uvr_vk_host_allocator *allocator, void *ptr) {
+  struct uvr_vk_host_allocation *header = (struct uvr_vk_host_allocation *) ptr - 1;
+
+  allocator->scopeBytes[header->scope] -= header->size;
+  allocator->currentBytes -= header->size;
+
+  if (!header->arena) {
+    free((unsigned char *) ptr - header->offset);
+    return;
+  }
+
+  /* COMMAND scope allocations don't outlive the call, the arena empties between Vulkan commands */
+  if (--allocator->arenaLive == 0) {
+    allocator->arenaOffset = 0;
+    allocator->arenaResets++;
+  }
+}
+
+
+static VKAPI_ATTR void *VKAPI_CALL host_allocation(void *pUserData, size_t size, size_t alignment, VkSystemAllocationScope scope) {
+  struct uvr_vk_host_allocator *allocator = pUserData;
+  void *ptr = NULL;
+
+  pthread_mutex_lock(&allocator->lock);
+  ptr = host_allocation_create(allocator, size, alignment, scope);
+  if (ptr)
+    allocator->allocationCount++;
+  pthread_mutex_unlock(&allocator->lock);
+
+  return ptr;
+}
+
+
+static VKAPI_ATTR void *VKAPI_CALL host_reallocation(void *pUserData, void *pOriginal, size_t size,
+                                                     size_t alignment, VkSystemAllocationScope scope) {
+  struct uvr_vk_host_allocator *allocator = pUserData;
+  struct uvr_vk_host_allocation *header = NULL;
+  void *ptr = NULL;
+
+  if (!pOriginal)
+    return host_allocation(pUserData, size, alignment, scope);
+
+  pthread_mutex_lock(&allocator->lock);
+
+  if (!size) {
+    host_allocation_destroy(allocator, pOriginal);
+    allocator->freeCount++;
+    goto exit_host_reallocation;
+  }
+
+  /* Spec requires the original allocation be left untouched on failure */
+  ptr = host_allocation_create(allocator, size, alignment, scope);
+  if (!ptr)
+    goto exit_host_reallocation;
+
+  header = (struct uvr_vk_host_allocation *) pOriginal - 1;
+  memcpy(ptr, pOriginal, (header->size < size) ? header->size : size);
+  host_allocation_destroy(allocator, pOriginal);
+  allocator->reallocationCount++;
+
+exit_host_reallocation:
+  pthread_mutex_unlock(&allocator->lock);
+  return ptr;
+}
+
+
+static VKAPI_ATTR void VKAPI_CALL host_free(void *pUserData, void *pMemory) {
+  struct uvr_vk_host_allocator *allocator = pUserData;
+
+  if (!pMemory)
+    return;
+
+  pthread_mutex_lock(&allocator->lock);
+  host_allocation_destroy(allocator, pMemory);
+  allocator->freeCount++;
+  pthread_mutex_unlock(&allocator->lock);
+}
+
+
+static VKAPI_ATTR void VKAPI_CALL host_internal_allocation(void *pUserData, size_t size, VkInternalAllocationType UNUSED type,
+                                                           VkSystemAllocationScope UNUSED scope) {
+  struct uvr_vk_host_allocator *allocator = pUserData;
+
+  pthread_mutex_lock(&allocator->lock);
+  allocator->internalBytes += size;
+  pthread_mutex_unlock(&allocator->lock);
+}
+
+
+static VKAPI_ATTR void VKAPI_CALL host_internal_free(void *pUserData, size_t size, VkInternalAllocationType UNUSED type,
+                                                     VkSystemAllocationScope UNUSED scope) {
+  struct uvr_vk_host_allocator *allocator = pUserData;
+
+  pthread_mutex_lock(&allocator->lock);
+  allocator->internalBytes -= size;
+  pthread_mutex_unlock(&allocator->lock);
+}
+
+
+int uvr_vk_host_allocator_create(struct uvr_vk_host_allocator *allocator, struct uvr_vk_host_allocator_create_info *uvrvk) {
+  memset(allocator, 0, sizeof(struct uvr_vk_host_allocator));
+
+  if (uvrvk->commandArenaSize) {
+    allocator->arena = malloc(uvrvk->commandArenaSize);
+    if (!allocator->arena) {
+      uvr_utils_log(UVR_DANGER, "[x] malloc: %s", strerror(errno));
+      return -1;
+    }
+    allocator->arenaSize = uvrvk->commandArenaSize;
+  }
+
+  if (pthread_mutex_init(&allocator->lock, NULL)) {
+    uvr_utils_log(UVR_DANGER, "[x] pthread_mutex_init: %s", strerror(errno));
+    free(allocator->arena);
+    allocator->arena = NULL;
+    return -1;
+  }
+
+  allocator->callbacks.pUserData = allocator;
+  allocator->callbacks.pfnAllocation = host_allocation;
+  allocator->callbacks.pfnReallocation = host_reallocation;
+  allocator->callbacks.pfnFree = host_free;
+  allocator->callbacks.pfnInternalAllocation = host_internal_allocation;
+  allocator->callbacks.pfnInternalFree = host_internal_free;
+
+  clock_gettime(CLOCK_MONOTONIC, &allocator->startTime);
+
+  uvr_utils_log(UVR_SUCCESS, "uvr_vk_host_allocator_create: %zu byte COMMAND scope arena", allocator->arenaSize);
+
+  return 0;
+}
+
+
+void uvr_vk_host_allocator_set(struct uvr_vk_host_allocator *allocator) {
+  hostCallbacks = (allocator) ? &allocator->callbacks : NULL;
+}
+
+
+const VkAllocationCallbacks *uvr_vk_host_allocator_get_callbacks(void) {
+  return hostCallbacks;
+}
+
+
+struct uvr_vk_host_allocator_stats uvr_vk_host_allocator_get_stats(struct uvr_vk_host_allocator *allocator) {
+  struct uvr_vk_host_allocator_stats stats;
+  struct timespec now;
+  double elapsedSec;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  elapsedSec = timespec_diff_ns(&allocator->startTime, &now) / 1e9;
+
+  pthread_mutex_lock(&allocator->lock);
+  memcpy(stats.scopeBytes, allocator->scopeBytes, sizeof(stats.scopeBytes));
+  memcpy(stats.scopeAllocations, allocator->scopeAllocations, sizeof(stats.scopeAllocations));
+  stats.currentBytes = allocator->currentBytes;
+  stats.peakBytes = allocator->peakBytes;
+  stats.internalBytes = allocator->internalBytes;
+  stats.allocationCount = allocator->allocationCount;
+  stats.reallocationCount = allocator->reallocationCount;
+  stats.freeCount = allocator->freeCount;
+  stats.arenaPeakBytes = allocator->arenaPeakBytes;
+  stats.arenaAllocations = allocator->arenaAllocations;
+  stats.arenaFallbacks = allocator->arenaFallbacks;
+  stats.arenaResets = allocator->arenaResets;
+  pthread_mutex_unlock(&allocator->lock);
+
+  stats.allocationsPerSecond = (elapsedSec > 0) ? (stats.allocationCount + stats.reallocationCount) / elapsedSec : 0;
+
+  return stats;
+}
+
+
+void uvr_vk_host_allocator_destroy(struct uvr_vk_host_allocator *allocator) {
+  if (hostCallbacks == &allocator->callbacks)
+    hostCallbacks = NULL;
+
+  if (allocator->currentBytes) {
+    uvr_utils_log(UVR_WARNING, "uvr_vk_host_allocator_destroy: %zu bytes in %" PRIu64 " allocations still live",
+                               allocator->currentBytes,
+                               allocator->allocationCount - allocator->freeCount);
+  }
+
+  /* Live arena allocations would dangle, keep the arena rather than free it under the implementation */
+  if (!allocator->arenaLive)
+    free(allocator->arena);
+
+  pthread_mutex_destroy(&allocator->lock);
+  allocator->arena = NULL;
+}
+
+
+struct uvr_vk_memory_budget uvr_vk_memory_budget_create(struct uvr_vk_memory_budget_create_info *uvrvk) {
+  struct uvr_vk_memory_budget budget;
+  memset(&budget, 0, sizeof(budget));
+
+  if (!uvrvk->vkPhdev) {
+    uvr_utils_log(UVR_DANGER, "[x] uvr_vk_memory_budget_create: VkPhysicalDevice not instantiated");
+    return (struct uvr_vk_memory_budget) { .vkPhdev = VK_NULL_HANDLE, .allocator = NULL, .callback = NULL };
+  }
+
+  budget.vkPhdev = uvrvk->vkPhdev;
+  budget.allocator = uvrvk->allocator;
+  budget.budgetExtension = uvrvk->budgetExtensionEnabled;
+  budget.highWaterMark = (uvrvk->highWaterMark > 0.f) ? uvrvk->highWaterMark : 0.9f;
+  budget.lowWaterMark = (uvrvk->lowWaterMark > 0.f && uvrvk->lowWaterMark < budget.highWaterMark) ?
+                        uvrvk->lowWaterMark : budget.highWaterMark - 0.1f;
+  budget.callback = uvrvk->callback;
+  budget.userData = uvrvk->userData;
+
+  uvr_vk_memory_budget_sample(&budget);
+
+  uvr_utils_log(UVR_SUCCESS, "uvr_vk_memory_budget_create: %u heaps, %s, high-water %.2f low-water %.2f",
+                             budget.heapCount, (budget.budgetExtension) ? "VK_EXT_memory_budget" : "allocator tracked usage",
+                             budget.highWaterMark, budget.lowWaterMark);
+
+  return budget;
+}
+
+
+uint32_t uvr_vk_memory_budget_sample(struct uvr_vk_memory_budget *budget) {
+  VkDeviceSize heapBudget[VK_MAX_MEMORY_HEAPS], heapUsage[VK_MAX_MEMORY_HEAPS];
+  struct uvr_vk_memory_budget_heap *heap = NULL;
+  uint32_t h, pressureCount = 0;
+  bool pressure;
+
+  VkPhysicalDeviceMemoryBudgetPropertiesEXT budget_props = {};
+  budget_props.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+  budget_props.pNext = NULL;
+
+  VkPhysicalDeviceMemoryProperties2 memprops = {};
+  memprops.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2;
+  memprops.pNext = (budget->budgetExtension) ? &budget_props : NULL;
+
+  vkGetPhysicalDeviceMemoryProperties2(budget->vkPhdev, &memprops);
+  budget->heapCount = memprops.memoryProperties.memoryHeapCount;
+
+  if (budget->budgetExtension) {
+    memcpy(heapBudget, budget_props.heapBudget, sizeof(heapBudget));
+    memcpy(heapUsage, budget_props.heapUsage, sizeof(heapUsage));
+  } else {
+    /* Only sees what the allocator reserved, not allocations made elsewhere in the process */
+    for (h = 0; h < budget->heapCount; h++)
+      heapBudget[h] = memprops.memoryProperties.memoryHeaps[h].size;
+
+    if (budget->allocator) {
+      struct uvr_vk_allocator_stats stats = uvr_vk_allocator_get_stats(budget->allocator);
+      memcpy(heapUsage, stats.heapUsage, sizeof(heapUsage));
+    } else {
+      memset(heapUsage, 0, sizeof(heapUsage));
+    }
+  }
+
+  for (h = 0; h < budget->heapCount; h++) {
+    heap = &budget->heaps[h];
+    heap->size = memprops.memoryProperties.memoryHeaps[h].size;
+    heap->flags = memprops.memoryProperties.memoryHeaps[h].flags;
+    heap->budget = heapBudget[h];
+    heap->usage = heapUsage[h];
+    heap->ratio = (heap->budget) ? (float) heap->usage / (float) heap->budget : 0.f;
+
+    /* Hysteresis, a heap hovering around the mark must not fire every frame */
+    pressure = (heap->pressure) ? heap->ratio > budget->lowWaterMark : heap->ratio >= budget->highWaterMark;
+    if (pressure != heap->pressure) {
+      heap->pressure = pressure;
+      if (pressure)
+        budget->pressureEvents++;
+
+      uvr_utils_log((pressure) ? UVR_WARNING : UVR_INFO,
+                    "uvr_vk_memory_budget_sample: heap %u %s pressure, %" PRIu64 " of %" PRIu64 " bytes (%.0f%%)",
+                    h, (pressure) ? "entered" : "left", heap->usage, heap->budget, heap->ratio * 100.f);
+
+      if (budget->callback)
+        budget->callback(budget->userData, h, heap);
+    }
+
+    if (heap->pressure)
+      pressureCount++;
+  }
+
+  budget->sampleCount++;
+
+  return pressureCount;
+}
+
+
+/* Every core VkFormat, extension formats live in the 1000000000+ range and are queried uncached */
+#define UVR_VK_FORMAT_CACHE_SIZE (VK_FORMAT_ASTC_12x12_SRGB_BLOCK + 1)
+
+struct uvr_vk_format_cache_entries {
+  pthread_mutex_t    lock;
+  bool               queried[UVR_VK_FORMAT_CACHE_SIZE];
+  VkFormatProperties properties[UVR_VK_FORMAT_CACHE_SIZE];
+  uint64_t           hitCount;
+  uint64_t           missCount;
+};
+
+
+struct uvr_vk_format_cache uvr_vk_format_cache_create(struct uvr_vk_format_cache_create_info *uvrvk) {
+  struct uvr_vk_format_cache_entries *entries = NULL;
+  VkPhysicalDeviceProperties phdevProps;
+
+  if (!uvrvk->vkPhdev) {
+    uvr_utils_log(UVR_DANGER, "[x] uvr_vk_format_cache_create: VkPhysicalDevice not instantiated");
+    goto exit_vk_format_cache;
+  }
+
+  entries = calloc(1, sizeof(struct uvr_vk_format_cache_entries));
+  if (!entries) {
+    uvr_utils_log(UVR_DANGER, "[x] calloc: %s", strerror(errno));
+    goto exit_vk_format_cache;
+  }
+
+  if (pthread_mutex_init(&entries->lock, NULL)) {
+    uvr_utils_log(UVR_DANGER, "[x] pthread_mutex_init: failed to initialize format cache lock");
+    goto exit_vk_format_cache_free_entries;
+  }
+
+  vkGetPhysicalDeviceProperties(uvrvk->vkPhdev, &phdevProps);
+
+  uvr_utils_log(UVR_SUCCESS, "uvr_vk_format_cache_create: Format cache successfully created for '%s'", phdevProps.deviceName);
+
+  return (struct uvr_vk_format_cache) { .vkPhdev = uvrvk->vkPhdev, .entries = entries };
+
+exit_vk_format_cache_free_entries:
+  free(entries);
+exit_vk_format_cache:
+  return (struct uvr_vk_format_cache) { .vkPhdev = VK_NULL_HANDLE, .entries = NULL };
+}
+
+
+VkFormatProperties uvr_vk_format_cache_get(struct uvr_vk_format_cache *cache, VkFormat format) {
+  struct uvr_vk_format_cache_entries *entries = cache->entries;
+  VkFormatProperties props;
+
+  if (format < 0 || format >= UVR_VK_FORMAT_CACHE_SIZE) {
+    vkGetPhysicalDeviceFormatProperties(cache->vkPhdev, format, &props);
+    return props;
+  }
+
+  pthread_mutex_lock(&entries->lock);
+
+  if (entries->queried[format]) {
+    entries->hitCount++;
+  } else {
+    vkGetPhysicalDeviceFormatProperties(cache->vkPhdev, format, &entries->properties[format]);
+    entries->queried[format] = true;
+    entries->missCount++;
+  }
+
+  props = entries->properties[format];
+
+  pthread_mutex_unlock(&entries->lock);
+
+  return props;
+}
+
+
+VkFormat uvr_vk_format_cache_select(struct uvr_vk_format_cache *cache, const VkFormat *pFormats, uint32_t formatCount,
+                                    VkImageTiling tiling, VkFormatFeatureFlags features) {
+  VkFormatProperties props;
+  VkFormatFeatureFlags supported;
+  uint32_t f;
+
+  for (f = 0; f < formatCount; f++) {
+    props = uvr_vk_format_cache_get(cache, pFormats[f]);
+    supported = (tiling == VK_IMAGE_TILING_OPTIMAL) ? props.optimalTilingFeatures : props.linearTilingFeatures;
+    if ((supported & features) == features)
+      return pFormats[f];
+  }
+
+  return VK_FORMAT_UNDEFINED;
+}
+
+
+/* Returns the R/B swapped twin of an 8-bit four channel format, VK_FORMAT_UNDEFINED if there's none */
+static VkFormat format_swap_rb(VkFormat format) {
+  switch (format) {
+    case VK_FORMAT_R8G8B8A8_UNORM: return VK_FORMAT_B8G8R8A8_UNORM;
+    case VK_FORMAT_R8G8B8A8_SRGB:  return VK_FORMAT_B8G8R8A8_SRGB;
+    case VK_FORMAT_B8G8R8A8_UNORM: return VK_FORMAT_R8G8B8A8_UNORM;
+    case VK_FORMAT_B8G8R8A8_SRGB:  return VK_FORMAT_R8G8B8A8_SRGB;
+    default: return VK_FORMAT_UNDEFINED;
+  }
+}
+
+
+/* Returns the sRGB/UNORM twin of an 8-bit format, VK_FORMAT_UNDEFINED if there's none */
+static VkFormat format_swap_srgb(VkFormat format) {
+  switch (format) {
+    case VK_FORMAT_R8_UNORM:       return VK_FORMAT_R8_SRGB;
+    case VK_FORMAT_R8_SRGB:        return VK_FORMAT_R8_UNORM;
+    case VK_FORMAT_R8G8_UNORM:     return VK_FORMAT_R8G8_SRGB;
+    case VK_FORMAT_R8G8_SRGB:      return VK_FORMAT_R8G8_UNORM;
+    case VK_FORMAT_R8G8B8A8_UNORM: return VK_FORMAT_R8G8B8A8_SRGB;
+    case VK_FORMAT_R8G8B8A8_SRGB:  return VK_FORMAT_R8G8B8A8_UNORM;
+    case VK_FORMAT_B8G8R8A8_UNORM: return VK_FORMAT_B8G8R8A8_SRGB;
+    case VK_FORMAT_B8G8R8A8_SRGB:  return VK_FORMAT_B8G8R8A8_UNORM;
+    default: return VK_FORMAT_UNDEFINED;
+  }
+}
+
+
+/*
+ * Candidates staged from data laid out in @base. Same bytes reinterpreted as another format is only sound for
+ * @base itself and its sRGB/UNORM twin, the R/B swapped twin is swizzled while staging.
+ */
+static bool texture_format_compatible(VkFormat base, VkFormat candidate) {
+  if (candidate == base)
+    return true;
+
+  return candidate == format_swap_srgb(base) || candidate == format_swap_rb(base);
+}
+
+
+/*
+ * Channel layout of the formats the host mip fallback can downsample. 8-bit formats are averaged
+ * per byte (sRGB color channels in linear space), 32-bit float formats per float. Returns 0 if unsupported.
+ */
+static uint32_t texture_host_channels(VkFormat format, bool *isFloat, bool *srgb) {
+  *isFloat = *srgb = false;
+
+  switch (format) {
+    case VK_FORMAT_R8_SRGB:
+      *srgb = true;
+      return 1;
+    case VK_FORMAT_R8_UNORM:
+      return 1;
+    case VK_FORMAT_R8G8_UNORM:
+      return 2;
+    case VK_FORMAT_R8G8B8A8_SRGB:
+    case VK_FORMAT_B8G8R8A8_SRGB:
+      *srgb = true;
+      return 4;
+    case VK_FORMAT_R8G8B8A8_UNORM:
+    case VK_FORMAT_B8G8R8A8_UNORM:
+      return 4;
+    case VK_FORMAT_R32_SFLOAT:
+      *isFloat = true;
+      return 1;
+    case VK_FORMAT_R32G32B32A32_SFLOAT:
+      *isFloat = true;
+      return 4;
+    default:
+      return 0;
+  }
+}
+
+
+static float srgb_to_linear(float c) {
+  return (c <= 0.04045f) ? c / 12.92f : powf((c + 0.055f) / 1.055f, 2.4f);
+}
+
+
+static float linear_to_srgb(float c) {
+  return (c <= 0.0031308f) ? c * 12.92f : 1.055f * powf(c, 1.f / 2.4f) - 0.055f;
+}
+
+
+/* Size of mip @level of an @extent texels wide dimension */
+static uint32_t mip_extent(uint32_t extent, uint32_t level) {
+  return (extent >> level) ? extent >> level : 1;
+}
+
+
+/* 2x2 box filter of @src into @dst. Odd edges clamp to the last row/column. */
+static void texture_host_downsample(const void *src, uint32_t srcWidth, uint32_t srcHeight, void *dst,
+                                    uint32_t dstWidth, uint32_t dstHeight, uint32_t channels, bool isFloat, bool srgb) {
+  uint32_t x, y, c, s, sx[2], sy[2];
+  float sum, value;
+
+  for (y = 0; y < dstHeight; y++) {
+    sy[0] = (y * 2 < srcHeight) ? y * 2 : srcHeight - 1;
+    sy[1] = (y * 2 + 1 < srcHeight) ? y * 2 + 1 : srcHeight - 1;
+
+    for (x = 0; x < dstWidth; x++) {
+      sx[0] = (x * 2 < srcWidth) ? x * 2 : srcWidth - 1;
+      sx[1] = (x * 2 + 1 < srcWidth) ? x * 2 + 1 : srcWidth - 1;
+
+      for (c = 0; c < channels; c++) {
+        sum = 0.f;
+
+        for (s = 0; s < 4; s++) {
+          size_t index = ((size_t) sy[s >> 1] * srcWidth + sx[s & 1]) * channels + c;
+          if (isFloat) {
+            sum += ((const float *) src)[index];
+          } else {
+            value = ((const uint8_t *) src)[index] / 255.f;
+            sum += (srgb && c < 3) ? srgb_to_linear(value) : value;
+          }
+        }
+
+        size_t index = ((size_t) y * dstWidth + x) * channels + c;
+        if (isFloat) {
+          ((float *) dst)[index] = sum * 0.25f;
+        } else {
+          value = sum * 0.25f;
+          value = (srgb && c < 3) ? linear_to_srgb(value) : value;
+          ((uint8_t *) dst)[index] = (uint8_t) (value * 255.f + 0.5f);
+        }
+      }
+    }
+  }
+}
+
+
+static const char *texture_mipmap_mode_name(uvr_vk_texture_mipmap_mode mode) {
+  switch (mode) {
+    case UVR_VK_TEXTURE_MIPMAP_BLIT:    return "blit";
+    case UVR_VK_TEXTURE_MIPMAP_COMPUTE: return "compute";
+    case UVR_VK_TEXTURE_MIPMAP_HOST:    return "host";
+    default: return "none";
+  }
+}
+
+
+/* Capabilities of queue family @index, zero if it doesn't exist */
+static VkQueueFlags queue_family_flags(VkPhysicalDevice vkPhdev, uint32_t index) {
+  VkQueueFamilyProperties *queueProps = NULL;
+  uint32_t queueFamilyCount = 0;
+  VkQueueFlags flags = 0;
+
+  vkGetPhysicalDeviceQueueFamilyProperties(vkPhdev, &queueFamilyCount, NULL);
+  if (index >= queueFamilyCount)
+    return 0;
+
+  queueProps = calloc(queueFamilyCount, sizeof(VkQueueFamilyProperties));
+  if (!queueProps) {
+    uvr_utils_log(UVR_DANGER, "[x] calloc: %s", strerror(errno));
+    return 0;
+  }
+
+  vkGetPhysicalDeviceQueueFamilyProperties(vkPhdev, &queueFamilyCount, queueProps);
+  flags = queueProps[index].queueFlags;
+  free(queueProps);
+
+  return flags;
+}
+
+
+struct uvr_vk_texture_downsample_pending {
+  uint64_t         uploadId;
+  VkDescriptorPool vkDescriptorPool;
+  uint32_t         viewCount;
+  VkImageView      *vkImageViews;
+};
+
+
+struct uvr_vk_texture_downsampler uvr_vk_texture_downsampler_create(struct uvr_vk_texture_downsampler_create_info *uvrvk) {
+  VkResult res = VK_RESULT_MAX_ENUM;
+  struct uvr_vk_texture_downsampler downsampler;
+
+  memset(&downsampler, 0, sizeof(downsampler));
+
+  if (!uvrvk->vkDevice || !uvrvk->shader || !format_texel_size(uvrvk->format)) {
+    uvr_utils_log(UVR_DANGER, "[x] uvr_vk_texture_downsampler_create: vkDevice, shader and an uploadable format must be set");
+    goto exit_vk_texture_downsampler;
+  }
+
+  VkDescriptorSetLayoutBinding bindings[2];
+  for (uint32_t b = 0; b < 2; b++) {
+    bindings[b].binding = b;
+    bindings[b].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+    bindings[b].descriptorCount = 1;
+    bindings[b].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    bindings[b].pImmutableSamplers = NULL;
+  }
+
+  VkDescriptorSetLayoutCreateInfo layout_info = {};
+  layout_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+  layout_info.pNext = NULL;
+  layout_info.flags = 0;
+  layout_info.bindingCount = 2;
+  layout_info.pBindings = bindings;
+
+  res = vkCreateDescriptorSetLayout(uvrvk->vkDevice, &layout_info, hostCallbacks, &downsampler.vkDescriptorSetLayout);
+  if (res) {
+    uvr_utils_log(UVR_DANGER, "[x] vkCreateDescriptorSetLayout: %s", vkres_msg(res));
+    goto exit_vk_texture_downsampler;
+  }
+
+  VkPipelineLayoutCreateInfo playout_info = {};
+  playout_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+  playout_info.pNext = NULL;
+  playout_info.flags = 0;
+  playout_info.setLayoutCount = 1;
+  playout_info.pSetLayouts = &downsampler.vkDescriptorSetLayout;
+  playout_info.pushConstantRangeCount = 0;
+  playout_info.pPushConstantRanges = NULL;
+
+  res = vkCreatePipelineLayout(uvrvk->vkDevice, &playout_info, hostCallbacks, &downsampler.vkPipelineLayout);
+  if (res) {
+    uvr_utils_log(UVR_DANGER, "[x] vkCreatePipelineLayout: %s", vkres_msg(res));
+    goto exit_vk_texture_downsampler_destroy_set_layout;
+  }
+
+  struct uvr_vk_compute_pipeline_create_info pipeline_info;
+  pipeline_info.vkPhdev = uvrvk->vkPhdev;
+  pipeline_info.vkDevice = uvrvk->vkDevice;
+  pipeline_info.shader = uvrvk->shader;
+  pipeline_info.pEntryPoint = NULL;
+  pipeline_info.pSpecializationInfo = NULL;
+  memcpy(pipeline_info.localSize, uvrvk->localSize, sizeof(pipeline_info.localSize));
+  pipeline_info.vkPipelineLayout = downsampler.vkPipelineLayout;
+  pipeline_info.vkPipelineCache = uvrvk->vkPipelineCache;
+
+  downsampler.pipeline = uvr_vk_compute_pipeline_create(&pipeline_info);
+  if (!downsampler.pipeline.computePipeline)
+    goto exit_vk_texture_downsampler_destroy_pipeline_layout;
+
+  downsampler.vkDevice = uvrvk->vkDevice;
+  downsampler.format = uvrvk->format;
+
+  uvr_utils_log(UVR_SUCCESS, "uvr_vk_texture_downsampler_create: VkFormat %d downsampler successfully created retval(%p)",
+                             downsampler.format, downsampler.pipeline.computePipeline);
+
+  return downsampler;
+
+exit_vk_texture_downsampler_destroy_pipeline_layout:
+  vkDestroyPipelineLayout(uvrvk->vkDevice, downsampler.vkPipelineLayout, hostCallbacks);
+exit_vk_texture_downsampler_destroy_set_layout:
+  vkDestroyDescriptorSetLayout(uvrvk->vkDevice, downsampler.vkDescriptorSetLayout, hostCallbacks);
+exit_vk_texture_downsampler:
+  return (struct uvr_vk_texture_downsampler) { .vkDevice = VK_NULL_HANDLE, .pipeline = {}, .vkDescriptorSetLayout = VK_NULL_HANDLE,
+                                               .vkPipelineLayout = VK_NULL_HANDLE, .pending = NULL };
+}
+
+
+static void texture_downsample_pending_free(VkDevice vkDevice, struct uvr_vk_texture_downsample_pending *pending) {
+  for (uint32_t v = 0; v < pending->viewCount; v++)
+    vkDestroyImageView(vkDevice, pending->vkImageViews[v], hostCallbacks);
+  vkDestroyDescriptorPool(vkDevice, pending->vkDescriptorPool, hostCallbacks);
+  free(pending->vkImageViews);
+}
+
+
+/* Destroy the level views and descriptor pools of every texture whose upload @ring retired. Keeps push order. */
+static void texture_downsampler_collect(struct uvr_vk_texture_downsampler *downsampler, struct uvr_vk_upload_ring *ring) {
+  uint32_t p, kept = 0;
+
+  for (p = 0; p < downsampler->pendingCount; p++) {
+    if (uvr_vk_upload_ring_poll(ring, downsampler->pending[p].uploadId)) {
+      texture_downsample_pending_free(downsampler->vkDevice, &downsampler->pending[p]);
+      continue;
+    }
+
+    downsampler->pending[kept++] = downsampler->pending[p];
+  }
+
+  downsampler->pendingCount = kept;
+}
+
+
+/*
+ * Creates one storage view per level plus a set per destination level. Everything that may fail happens here,
+ * before the upload is recorded, so recording the dispatches afterwards can't leave levels unwritten.
+ */
+static struct uvr_vk_texture_downsample_pending *texture_downsample_prepare(struct uvr_vk_texture_downsampler *downsampler,
+                                                                            struct uvr_vk_texture *texture, VkDescriptorSet *sets) {
+  VkResult res = VK_RESULT_MAX_ENUM;
+  struct uvr_vk_texture_downsample_pending *pending = NULL;
+  uint32_t level;
+
+  if (downsampler->pendingCount == downsampler->pendingCapacity) {
+    uint32_t newCap = (downsampler->pendingCapacity) ? downsampler->pendingCapacity * 2 : 16;
+    void *newPending = realloc(downsampler->pending, newCap * sizeof(struct uvr_vk_texture_downsample_pending));
+    if (!newPending) {
+      uvr_utils_log(UVR_DANGER, "[x] realloc: %s", strerror(errno));
+      return NULL;
+    }
+
+    downsampler->pending = newPending;
+    downsampler->pendingCapacity = newCap;
+  }
+
+  pending = &downsampler->pending[downsampler->pendingCount];
+  memset(pending, 0, sizeof(*pending));
+
+  pending->vkImageViews = calloc(texture->mipLevels, sizeof(VkImageView));
+  if (!pending->vkImageViews) {
+    uvr_utils_log(UVR_DANGER, "[x] calloc: %s", strerror(errno));
+    return NULL;
+  }
+
+  VkImageViewCreateInfo view_info = {};
+  view_info.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+  view_info.pNext = NULL;
+  view_info.flags = 0;
+  view_info.image = texture->image.vkImages[0].image;
+  view_info.viewType = VK_IMAGE_VIEW_TYPE_2D;
+  view_info.format = texture->format;
+  view_info.components = (VkComponentMapping) { VK_COMPONENT_SWIZZLE_IDENTITY, VK_COMPONENT_SWIZZLE_IDENTITY,
+                                                VK_COMPONENT_SWIZZLE_IDENTITY, VK_COMPONENT_SWIZZLE_IDENTITY };
+  view_info.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+  view_info.subresourceRange.levelCount = 1;
+  view_info.subresourceRange.baseArrayLayer = 0;
+  view_info.subresourceRange.layerCount = 1;
+
+  for (level = 0; level < texture->mipLevels; level++, pending->viewCount++) {
+    view_info.subresourceRange.baseMipLevel = level;
+    res = vkCreateImageView(downsampler->vkDevice, &view_info, hostCallbacks, &pending->vkImageViews[level]);
+    if (res) {
+      uvr_utils_log(UVR_DANGER, "[x] vkCreateImageView: %s", vkres_msg(res));
+      goto exit_vk_texture_downsample_prepare_free;
+    }
+  }
 
-  for (fbc = 0; fbc < uvrvk->frameBufferCount; fbc++) {
-    create_info.attachmentCount = 1;
-    create_info.pAttachments = &uvrvk->vkImageViews[fbc].view;
+  VkDescriptorPoolSize pool_size;
+  pool_size.type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+  pool_size.descriptorCount = 2 * (texture->mipLevels - 1);
+
+  VkDescriptorPoolCreateInfo pool_info = {};
+  pool_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+  pool_info.pNext = NULL;
+  pool_info.flags = 0;
+  pool_info.maxSets = texture->mipLevels - 1;
+  pool_info.poolSizeCount = 1;
+  pool_info.pPoolSizes = &pool_size;
 
-    res = vkCreateFramebuffer(uvrvk->vkDevice, &create_info, NULL, &vkfbs[fbc].fb);
+  res = vkCreateDescriptorPool(downsampler->vkDevice, &pool_info, hostCallbacks, &pending->vkDescriptorPool);
+  if (res) {
+    uvr_utils_log(UVR_DANGER, "[x] vkCreateDescriptorPool: %s", vkres_msg(res));
+    goto exit_vk_texture_downsample_prepare_free;
+  }
+
+  for (level = 1; level < texture->mipLevels; level++) {
+    VkDescriptorSetAllocateInfo alloc_info = {};
+    alloc_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    alloc_info.pNext = NULL;
+    alloc_info.descriptorPool = pending->vkDescriptorPool;
+    alloc_info.descriptorSetCount = 1;
+    alloc_info.pSetLayouts = &downsampler->vkDescriptorSetLayout;
+
+    res = vkAllocateDescriptorSets(downsampler->vkDevice, &alloc_info, &sets[level - 1]);
     if (res) {
-      uvr_utils_log(UVR_DANGER, "[x] vkCreateFramebuffer: %s", vkres_msg(res));
-      goto exit_vk_framebuffer_vk_framebuffer_destroy;
+      uvr_utils_log(UVR_DANGER, "[x] vkAllocateDescriptorSets: %s", vkres_msg(res));
+      goto exit_vk_texture_downsample_prepare_free;
     }
 
-    uvr_utils_log(UVR_SUCCESS, "uvr_vk_framebuffer_create: VkFramebuffer successfully created retval(%p)", vkfbs[fbc].fb);
+    VkDescriptorImageInfo image_infos[2];
+    VkWriteDescriptorSet writes[2];
+    for (uint32_t b = 0; b < 2; b++) {
+      image_infos[b].sampler = VK_NULL_HANDLE;
+      image_infos[b].imageView = pending->vkImageViews[level - 1 + b];
+      image_infos[b].imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+      writes[b].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+      writes[b].pNext = NULL;
+      writes[b].dstSet = sets[level - 1];
+      writes[b].dstBinding = b;
+      writes[b].dstArrayElement = 0;
+      writes[b].descriptorCount = 1;
+      writes[b].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+      writes[b].pImageInfo = &image_infos[b];
+      writes[b].pBufferInfo = NULL;
+      writes[b].pTexelBufferView = NULL;
+    }
+
+    vkUpdateDescriptorSets(downsampler->vkDevice, 2, writes, 0, NULL);
   }
 
-  return (struct uvr_vk_framebuffer) { .vkDevice = uvrvk->vkDevice, .frameBufferCount = uvrvk->frameBufferCount, .vkFrameBuffers = vkfbs };
+  return pending;
 
-exit_vk_framebuffer_vk_framebuffer_destroy:
-  for (fbc = 0; fbc < uvrvk->frameBufferCount; fbc++) {
-    if (vkfbs[fbc].fb)
-      vkDestroyFramebuffer(uvrvk->vkDevice, vkfbs[fbc].fb, NULL);
+exit_vk_texture_downsample_prepare_free:
+  texture_downsample_pending_free(downsampler->vkDevice, pending);
+  return NULL;
+}
+
+
+/*
+ * Records the downsample of every level into @cmdBuffer after level 0 was copied. The chain is handed back in
+ * VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL so the ring's release barrier transitions it like any other upload.
+ */
+static void texture_downsample_record(struct uvr_vk_texture_downsampler *downsampler, const struct uvr_vk_device_dispatch *dispatch,
+                                      VkCommandBuffer cmdBuffer, struct uvr_vk_texture *texture, VkDescriptorSet *sets) {
+  uint32_t level;
+
+  VkImageMemoryBarrier barrier = {};
+  barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+  barrier.pNext = NULL;
+  barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+  barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+  barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+  barrier.newLayout = VK_IMAGE_LAYOUT_GENERAL;
+  barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  barrier.image = texture->image.vkImages[0].image;
+  barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+  barrier.subresourceRange.baseMipLevel = 0;
+  barrier.subresourceRange.levelCount = texture->mipLevels;
+  barrier.subresourceRange.baseArrayLayer = 0;
+  barrier.subresourceRange.layerCount = 1;
+
+  dispatch->CmdPipelineBarrier(cmdBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                               0, 0, NULL, 0, NULL, 1, &barrier);
+
+  dispatch->CmdBindPipeline(cmdBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, downsampler->pipeline.computePipeline);
+
+  /* Level N is read by the next dispatch once it's been written */
+  barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+  barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+  barrier.oldLayout = VK_IMAGE_LAYOUT_GENERAL;
+  barrier.subresourceRange.levelCount = 1;
+
+  for (level = 1; level < texture->mipLevels; level++) {
+    dispatch->CmdBindDescriptorSets(cmdBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, downsampler->vkPipelineLayout, 0, 1,
+                                    &sets[level - 1], 0, NULL);
+
+    struct uvr_vk_compute_dispatch_info dispatch_info;
+    dispatch_info.commandBuffer = cmdBuffer;
+    dispatch_info.extent3D = (VkExtent3D) { mip_extent(texture->extent3D.width, level), mip_extent(texture->extent3D.height, level), 1 };
+    uvr_vk_compute_pipeline_dispatch(&downsampler->pipeline, &dispatch_info);
+
+    if (level + 1 == texture->mipLevels)
+      break;
+
+    barrier.subresourceRange.baseMipLevel = level;
+    dispatch->CmdPipelineBarrier(cmdBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                 0, 0, NULL, 0, NULL, 1, &barrier);
   }
-//exit_vk_framebuffer_free_vkfbs:
-  free(vkfbs);
-exit_vk_framebuffer:
-  return (struct uvr_vk_framebuffer) { .vkDevice = VK_NULL_HANDLE, .frameBufferCount = 0, .vkFrameBuffers = NULL };
+
+  barrier.srcAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+  barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+  barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+  barrier.subresourceRange.baseMipLevel = 0;
+  barrier.subresourceRange.levelCount = texture->mipLevels;
+
+  dispatch->CmdPipelineBarrier(cmdBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                               0, 0, NULL, 0, NULL, 1, &barrier);
 }
 
 
-struct uvr_vk_command_buffer uvr_vk_command_buffer_create(struct uvr_vk_command_buffer_create_info *uvrvk) {
-  VkResult res = VK_RESULT_MAX_ENUM;
-  VkCommandPool cmdpool = VK_NULL_HANDLE;
-  VkCommandBuffer *cmdbuffs = VK_NULL_HANDLE;
-  struct uvr_vk_command_buffer_handle *cbuffs = NULL;
+struct uvr_vk_texture uvr_vk_texture_create(struct uvr_vk_texture_create_info *uvrvk) {
+  struct uvr_vk_texture texture;
+  struct uvr_vk_upload_ring *ring = uvrvk->uploadRing;
+  struct uvr_vk_texture_downsampler *downsampler = uvrvk->downsampler;
+  struct uvr_vk_texture_downsample_pending *pending = NULL;
+  VkDescriptorSet *downsampleSets = NULL;
+  VkBufferImageCopy *regions = NULL;
+  VkFormatProperties props;
+  VkFormat swapped;
+  VkDeviceSize levelSize, offset;
+  VkQueueFlags queueFlags;
+  struct timespec stageStart, stageEnd, mipStart, mipEnd;
+  uint32_t f, level, texelSize, maxLevels, channels, copyCount, width, height;
+  bool isFloat, srgb, swizzle = false;
+  uint8_t *mapped = NULL;
+
+  memset(&texture, 0, sizeof(texture));
+
+  if (!uvrvk->allocator || !uvrvk->allocator->vkDevice) {
+    uvr_utils_log(UVR_DANGER, "[x] uvr_vk_texture_create: struct uvr_vk_allocator not instantiated");
+    goto exit_vk_texture;
+  }
 
-  VkCommandPoolCreateInfo create_info = {};
-  create_info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
-  create_info.pNext = NULL;
-  create_info.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
-  create_info.queueFamilyIndex = uvrvk->queueFamilyIndex;
+  if (!uvrvk->formatCache || !uvrvk->formatCache->entries) {
+    uvr_utils_log(UVR_DANGER, "[x] uvr_vk_texture_create: struct uvr_vk_format_cache not instantiated");
+    goto exit_vk_texture;
+  }
 
-  res = vkCreateCommandPool(uvrvk->vkDevice, &create_info, NULL, &cmdpool);
-  if (res) {
-    uvr_utils_log(UVR_DANGER, "[x] vkCreateCommandPool: %s", vkres_msg(res));
-    goto exit_vk_command_buffer;
+  if (!ring || !ring->pMapped || ring->vkDevice != uvrvk->allocator->vkDevice) {
+    uvr_utils_log(UVR_DANGER, "[x] uvr_vk_texture_create: struct uvr_vk_upload_ring not instantiated for the allocator's VkDevice");
+    goto exit_vk_texture;
   }
 
-  uvr_utils_log(UVR_SUCCESS, "uvr_vk_command_buffer_create: VkCommandPool successfully created retval(%p)", cmdpool);
+  if (!uvrvk->formatCount || !uvrvk->extent2D.width || !uvrvk->extent2D.height || !uvrvk->pData) {
+    uvr_utils_log(UVR_DANGER, "[x] uvr_vk_texture_create: formatCount, extent2D and pData must be set");
+    goto exit_vk_texture;
+  }
 
-  cmdbuffs = alloca(uvrvk->commandBufferCount * sizeof(VkCommandBuffer));
+  texelSize = format_texel_size(uvrvk->pFormats[0]);
+  if (!texelSize) {
+    uvr_utils_log(UVR_DANGER, "[x] uvr_vk_texture_create: VkFormat %d can't be uploaded", uvrvk->pFormats[0]);
+    goto exit_vk_texture;
+  }
 
-  VkCommandBufferAllocateInfo alloc_info = {};
-  alloc_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-  alloc_info.commandPool = cmdpool;
-  alloc_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-  alloc_info.commandBufferCount = uvrvk->commandBufferCount;
+  /* Every level is staged at a multiple of the ring's alignment, bufferOffset must be a multiple of the texel size and 4 */
+  if (ring->alignment % texelSize || ring->alignment % 4) {
+    uvr_utils_log(UVR_DANGER, "[x] uvr_vk_texture_create: upload ring alignment %" PRIu64 " isn't a multiple of %u and 4",
+                              (uint64_t) ring->alignment, texelSize);
+    goto exit_vk_texture;
+  }
 
-  res = vkAllocateCommandBuffers(uvrvk->vkDevice, &alloc_info, cmdbuffs);
-  if (res) {
-    uvr_utils_log(UVR_DANGER, "[x] vkAllocateCommandBuffers: %s", vkres_msg(res));
-    goto exit_vk_command_buffer_destroy_cmd_pool;
+  if (uvrvk->size != (VkDeviceSize) uvrvk->extent2D.width * uvrvk->extent2D.height * texelSize) {
+    uvr_utils_log(UVR_DANGER, "[x] uvr_vk_texture_create: size %" PRIu64 " doesn't match a tightly packed %ux%u level",
+                              uvrvk->size, uvrvk->extent2D.width, uvrvk->extent2D.height);
+    goto exit_vk_texture;
   }
 
-  cbuffs = calloc(uvrvk->commandBufferCount, sizeof(struct uvr_vk_command_buffer_handle));
-  if (!cbuffs) {
+  /* floor(log2(largest dimension)) + 1 levels takes the chain down to 1x1 */
+  maxLevels = 32 - __builtin_clz(uvrvk->extent2D.width | uvrvk->extent2D.height);
+  texture.mipLevels = (uvrvk->mipLevels && uvrvk->mipLevels < maxLevels) ? uvrvk->mipLevels : maxLevels;
+
+  /* vkCmdBlitImage is only supported on queues with graphics capabilities, dispatches on ones with compute */
+  queueFlags = queue_family_flags(uvrvk->formatCache->vkPhdev, ring->srcQueueFamilyIndex);
+
+  if (downsampler && downsampler->vkDevice != ring->vkDevice) {
+    uvr_utils_log(UVR_DANGER, "[x] uvr_vk_texture_create: struct uvr_vk_texture_downsampler VkDevice doesn't match the upload ring's");
+    goto exit_vk_texture;
+  }
+
+  /*
+   * Prefer a candidate that can blit its own mip chain, then the downsampler's format if it can be a storage
+   * image, otherwise take the first one that can be sampled and copied into. Lookups hit the format cache so
+   * this stays cheap per texture.
+   */
+  VkFormatFeatureFlags baseFeatures = VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT | VK_FORMAT_FEATURE_TRANSFER_DST_BIT;
+  VkFormatFeatureFlags blitFeatures = VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT |
+                                      VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+
+  for (f = 1; f < uvrvk->formatCount; f++) {
+    if (!texture_format_compatible(uvrvk->pFormats[0], uvrvk->pFormats[f])) {
+      uvr_utils_log(UVR_DANGER, "[x] uvr_vk_texture_create: candidate VkFormat %d can't hold data laid out as VkFormat %d, "
+                                "only the sRGB/UNORM and R/B swapped twins can", uvrvk->pFormats[f], uvrvk->pFormats[0]);
+      goto exit_vk_texture;
+    }
+  }
+
+  texture.format = VK_FORMAT_UNDEFINED;
+  for (f = 0; f < uvrvk->formatCount && texture.mipLevels > 1 && (queueFlags & VK_QUEUE_GRAPHICS_BIT) && !texture.format; f++) {
+    props = uvr_vk_format_cache_get(uvrvk->formatCache, uvrvk->pFormats[f]);
+    if ((props.optimalTilingFeatures & (baseFeatures | blitFeatures)) == (baseFeatures | blitFeatures)) {
+      texture.format = uvrvk->pFormats[f];
+      texture.mipmapMode = UVR_VK_TEXTURE_MIPMAP_BLIT;
+    }
+  }
+
+  for (f = 0; f < uvrvk->formatCount && texture.mipLevels > 1 && downsampler && (queueFlags & VK_QUEUE_COMPUTE_BIT) && !texture.format; f++) {
+    if (uvrvk->pFormats[f] != downsampler->format)
+      continue;
+
+    props = uvr_vk_format_cache_get(uvrvk->formatCache, uvrvk->pFormats[f]);
+    if ((props.optimalTilingFeatures & (baseFeatures | VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT)) == (baseFeatures | VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT)) {
+      texture.format = uvrvk->pFormats[f];
+      texture.mipmapMode = UVR_VK_TEXTURE_MIPMAP_COMPUTE;
+    }
+  }
+
+  for (f = 0; f < uvrvk->formatCount && !texture.format; f++) {
+    props = uvr_vk_format_cache_get(uvrvk->formatCache, uvrvk->pFormats[f]);
+    if ((props.optimalTilingFeatures & baseFeatures) == baseFeatures)
+      texture.format = uvrvk->pFormats[f];
+  }
+
+  if (!texture.format) {
+    uvr_utils_log(UVR_DANGER, "[x] uvr_vk_texture_create: none of the %u candidate formats can be sampled", uvrvk->formatCount);
+    goto exit_vk_texture;
+  }
+
+  swapped = format_swap_rb(uvrvk->pFormats[0]);
+  swizzle = (swapped != VK_FORMAT_UNDEFINED && texture.format == swapped);
+
+  channels = texture_host_channels(texture.format, &isFloat, &srgb);
+  if (texture.mipLevels > 1 && !texture.mipmapMode) {
+    if (channels) {
+      texture.mipmapMode = UVR_VK_TEXTURE_MIPMAP_HOST;
+    } else {
+      uvr_utils_log(UVR_WARNING, "uvr_vk_texture_create: VkFormat %d can't be downsampled, only level 0 is created", texture.format);
+      texture.mipLevels = 1;
+    }
+  }
+
+  texture.vkDevice = uvrvk->allocator->vkDevice;
+  texture.extent3D = (VkExtent3D) { uvrvk->extent2D.width, uvrvk->extent2D.height, 1 };
+
+  struct uvr_vk_image_create2_info image_info;
+  image_info.allocator = uvrvk->allocator;
+  image_info.memoryPropertyFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+  image_info.mode = UVR_VK_ALLOCATION_BUDDY;
+  image_info.imageCount = 1;
+  image_info.imageFlags = 0;
+  image_info.imageType = VK_IMAGE_TYPE_2D;
+  image_info.imageFormat = texture.format;
+  image_info.imageExtent3D = texture.extent3D;
+  image_info.imageMipLevels = texture.mipLevels;
+  image_info.imageArrayLayers = 1;
+  image_info.imageSamples = VK_SAMPLE_COUNT_1_BIT;
+  image_info.imageTiling = VK_IMAGE_TILING_OPTIMAL;
+  image_info.imageUsage = uvrvk->imageUsage | VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT |
+                          ((texture.mipmapMode == UVR_VK_TEXTURE_MIPMAP_BLIT) ? VK_IMAGE_USAGE_TRANSFER_SRC_BIT : 0) |
+                          ((texture.mipmapMode == UVR_VK_TEXTURE_MIPMAP_COMPUTE) ? VK_IMAGE_USAGE_STORAGE_BIT : 0);
+  image_info.imageSharingMode = VK_SHARING_MODE_EXCLUSIVE;
+  image_info.queueFamilyIndexCount = 0;
+  image_info.pQueueFamilyIndices = NULL;
+  image_info.imageInitialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+  image_info.imageViewFlags = 0;
+  image_info.imageViewType = VK_IMAGE_VIEW_TYPE_2D;
+  image_info.imageViewComponents.r = VK_COMPONENT_SWIZZLE_IDENTITY;
+  image_info.imageViewComponents.g = VK_COMPONENT_SWIZZLE_IDENTITY;
+  image_info.imageViewComponents.b = VK_COMPONENT_SWIZZLE_IDENTITY;
+  image_info.imageViewComponents.a = VK_COMPONENT_SWIZZLE_IDENTITY;
+  image_info.imageViewSubresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+  image_info.imageViewSubresourceRange.baseMipLevel = 0;
+  image_info.imageViewSubresourceRange.levelCount = texture.mipLevels;
+  image_info.imageViewSubresourceRange.baseArrayLayer = 0;
+  image_info.imageViewSubresourceRange.layerCount = 1;
+
+  texture.image = uvr_vk_image_create2(&image_info);
+  if (!texture.image.vkImages)
+    goto exit_vk_texture;
+
+  /* GPU generated chains only need level 0 staged, the host fallback stages the whole chain */
+  copyCount = (texture.mipmapMode == UVR_VK_TEXTURE_MIPMAP_HOST) ? texture.mipLevels : 1;
+  regions = calloc(copyCount, sizeof(VkBufferImageCopy));
+  if (!regions) {
     uvr_utils_log(UVR_DANGER, "[x] calloc: %s", strerror(errno));
-    goto exit_vk_command_buffer_destroy_cmd_pool;
+    goto exit_vk_texture_destroy_image;
   }
 
-  for (uint32_t i = 0; i < uvrvk->commandBufferCount; i++) {
-    cbuffs[i].buffer = cmdbuffs[i];
-    uvr_utils_log(UVR_WARNING, "uvr_vk_command_buffer_create: VkCommandBuffer successfully created retval(%p)", cbuffs[i].buffer);
+  for (level = 0, offset = 0; level < copyCount; level++) {
+    width = mip_extent(uvrvk->extent2D.width, level);
+    height = mip_extent(uvrvk->extent2D.height, level);
+
+    regions[level].bufferOffset = offset;
+    regions[level].bufferRowLength = 0;
+    regions[level].bufferImageHeight = 0;
+    regions[level].imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    regions[level].imageSubresource.mipLevel = level;
+    regions[level].imageSubresource.baseArrayLayer = 0;
+    regions[level].imageSubresource.layerCount = 1;
+    regions[level].imageOffset = (VkOffset3D) { 0, 0, 0 };
+    regions[level].imageExtent = (VkExtent3D) { width, height, 1 };
+
+    levelSize = (VkDeviceSize) width * height * texelSize;
+    offset = (offset + levelSize + ring->alignment - 1) / ring->alignment * ring->alignment;
   }
 
-  return (struct uvr_vk_command_buffer) { .vkDevice = uvrvk->vkDevice, .vkCommandPool = cmdpool,
-                                          .commandBufferCount = uvrvk->commandBufferCount, .vkCommandbuffers = cbuffs };
+  if (texture.mipmapMode == UVR_VK_TEXTURE_MIPMAP_COMPUTE) {
+    downsampleSets = calloc(texture.mipLevels - 1, sizeof(VkDescriptorSet));
+    if (!downsampleSets) {
+      uvr_utils_log(UVR_DANGER, "[x] calloc: %s", strerror(errno));
+      goto exit_vk_texture_free_regions;
+    }
 
-exit_vk_command_buffer_destroy_cmd_pool:
-  vkDestroyCommandPool(uvrvk->vkDevice, cmdpool, NULL);
-exit_vk_command_buffer:
-  return (struct uvr_vk_command_buffer) { .vkDevice = VK_NULL_HANDLE, .vkCommandPool = VK_NULL_HANDLE,
-                                          .commandBufferCount = 0, .vkCommandbuffers = NULL };
-}
+    texture_downsampler_collect(downsampler, ring);
+    pending = texture_downsample_prepare(downsampler, &texture, downsampleSets);
+    if (!pending)
+      goto exit_vk_texture_free_sets;
+  }
 
+  /* The whole chain is a single ring range so it lands in a single batch with a single upload ID */
+  struct uvr_vk_upload_image_info upload_info;
+  upload_info.pData = NULL;
+  upload_info.size = offset;
+  upload_info.dstImage = texture.image.vkImages[0].image;
+  upload_info.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+  upload_info.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+  upload_info.imageSubresource = regions[0].imageSubresource;
+  upload_info.imageOffset = regions[0].imageOffset;
+  upload_info.imageExtent = regions[0].imageExtent;
+  upload_info.dstStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+  upload_info.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+  mapped = upload_ring_image_reserve(ring, &upload_info, texture.mipLevels, copyCount, regions, &texture.uploadId);
+  if (!mapped)
+    goto exit_vk_texture_free_pending;
+
+  clock_gettime(CLOCK_MONOTONIC, &stageStart);
+
+  if (swizzle) {
+    const uint8_t *src = uvrvk->pData;
+    for (VkDeviceSize t = 0; t < uvrvk->size; t += 4) {
+      mapped[t + 0] = src[t + 2];
+      mapped[t + 1] = src[t + 1];
+      mapped[t + 2] = src[t + 0];
+      mapped[t + 3] = src[t + 3];
+    }
+  } else {
+    memcpy(mapped, uvrvk->pData, uvrvk->size);
+  }
 
-int uvr_vk_command_buffer_record_begin(struct uvr_vk_command_buffer_record_info *uvrvk) {
-  VkResult res = VK_RESULT_MAX_ENUM;
+  clock_gettime(CLOCK_MONOTONIC, &stageEnd);
+  texture.stageNs = timespec_diff_ns(&stageStart, &stageEnd);
+  texture.uploadBytes = upload_info.size;
 
-  VkCommandBufferBeginInfo begin_info = {};
-  begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-  begin_info.pNext = NULL;
-  begin_info.flags = uvrvk->flags;
-  // We don't use secondary command buffers in API so set to null
-  begin_info.pInheritanceInfo = NULL;
+  /* Each level is filtered from the previous one straight out of the ring, bufferOffset is now absolute */
+  if (texture.mipmapMode == UVR_VK_TEXTURE_MIPMAP_HOST) {
+    clock_gettime(CLOCK_MONOTONIC, &mipStart);
 
-  for (uint32_t i = 0; i < uvrvk->commandBufferCount; i++) {
-    res = vkBeginCommandBuffer(uvrvk->vkCommandbuffers[i].buffer, &begin_info);
-    if (res) {
-      uvr_utils_log(UVR_DANGER, "[x] vkBeginCommandBuffer: %s", vkres_msg(res));
-      return -1;
+    for (level = 1; level < texture.mipLevels; level++) {
+      texture_host_downsample(mapped + (regions[level - 1].bufferOffset - regions[0].bufferOffset),
+                              regions[level - 1].imageExtent.width, regions[level - 1].imageExtent.height,
+                              mapped + (regions[level].bufferOffset - regions[0].bufferOffset),
+                              regions[level].imageExtent.width, regions[level].imageExtent.height,
+                              channels, isFloat, srgb);
     }
+
+    clock_gettime(CLOCK_MONOTONIC, &mipEnd);
+    texture.mipmapNs = timespec_diff_ns(&mipStart, &mipEnd);
   }
 
-  return 0;
-}
+  const struct uvr_vk_device_dispatch *dispatch = ring->dispatch;
+  VkCommandBuffer cmdBuffer = ring->vkCommandbuffs.vkCommandbuffers[ring->batchIndex].buffer;
 
+  if (uvrvk->queryPool && (texture.mipmapMode == UVR_VK_TEXTURE_MIPMAP_BLIT || texture.mipmapMode == UVR_VK_TEXTURE_MIPMAP_COMPUTE)) {
+    uvr_vk_query_pool_reset(uvrvk->queryPool, cmdBuffer);
+    uvr_vk_query_pool_scope_begin(uvrvk->queryPool, cmdBuffer, "uvr_vk_texture_mipmaps");
+  }
 
-int uvr_vk_command_buffer_record_end(struct uvr_vk_command_buffer_record_info *uvrvk) {
-  VkResult res = VK_RESULT_MAX_ENUM;
+  if (texture.mipmapMode == UVR_VK_TEXTURE_MIPMAP_COMPUTE) {
+    texture_downsample_record(downsampler, dispatch, cmdBuffer, &texture, downsampleSets);
+    pending->uploadId = texture.uploadId;
+    downsampler->pendingCount++;
+  }
 
-  for (uint32_t i = 0; i < uvrvk->commandBufferCount; i++) {
-    res = vkEndCommandBuffer(uvrvk->vkCommandbuffers[i].buffer);
-    if (res) {
-      uvr_utils_log(UVR_DANGER, "[x] vkEndCommandBuffer: %s", vkres_msg(res));
-      return -1;
+  if (texture.mipmapMode == UVR_VK_TEXTURE_MIPMAP_BLIT) {
+    VkImageMemoryBarrier barrier = {};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.pNext = NULL;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = upload_info.dstImage;
+    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier.subresourceRange.levelCount = 1;
+    barrier.subresourceRange.baseArrayLayer = 0;
+    barrier.subresourceRange.layerCount = 1;
+
+    /* Level N-1 becomes a blit source once it's been written, level N is still a transfer destination */
+    for (level = 1; level < texture.mipLevels; level++) {
+      barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+      barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+      barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+      barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+      barrier.subresourceRange.baseMipLevel = level - 1;
+
+      dispatch->CmdPipelineBarrier(cmdBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                   0, 0, NULL, 0, NULL, 1, &barrier);
+
+      VkImageBlit blit = {};
+      blit.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+      blit.srcSubresource.mipLevel = level - 1;
+      blit.srcSubresource.baseArrayLayer = 0;
+      blit.srcSubresource.layerCount = 1;
+      blit.srcOffsets[0] = (VkOffset3D) { 0, 0, 0 };
+      blit.srcOffsets[1] = (VkOffset3D) { mip_extent(uvrvk->extent2D.width, level - 1),
+                                          mip_extent(uvrvk->extent2D.height, level - 1), 1 };
+      blit.dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+      blit.dstSubresource.mipLevel = level;
+      blit.dstSubresource.baseArrayLayer = 0;
+      blit.dstSubresource.layerCount = 1;
+      blit.dstOffsets[0] = (VkOffset3D) { 0, 0, 0 };
+      blit.dstOffsets[1] = (VkOffset3D) { mip_extent(uvrvk->extent2D.width, level),
+                                          mip_extent(uvrvk->extent2D.height, level), 1 };
+
+      dispatch->CmdBlitImage(cmdBuffer, upload_info.dstImage, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, upload_info.dstImage,
+                             VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &blit, VK_FILTER_LINEAR);
     }
+
+    /*
+     * Every level but the last was a blit source. Hand them back as transfer destinations so the ring's
+     * release barrier, recorded on flush, transitions the whole chain to VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL.
+     */
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.subresourceRange.baseMipLevel = 0;
+    barrier.subresourceRange.levelCount = texture.mipLevels - 1;
+
+    dispatch->CmdPipelineBarrier(cmdBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                 0, 0, NULL, 0, NULL, 1, &barrier);
   }
 
-  return 0;
+  if (uvrvk->queryPool && (texture.mipmapMode == UVR_VK_TEXTURE_MIPMAP_BLIT || texture.mipmapMode == UVR_VK_TEXTURE_MIPMAP_COMPUTE))
+    uvr_vk_query_pool_scope_end(uvrvk->queryPool, cmdBuffer, -1);
+
+  free(downsampleSets);
+  free(regions);
+
+  uvr_utils_log(UVR_SUCCESS, "uvr_vk_texture_create: %ux%u texture (VkFormat %d, %u mip level(s), %s) staged in upload %" PRIu64,
+                             texture.extent3D.width, texture.extent3D.height, texture.format, texture.mipLevels,
+                             texture_mipmap_mode_name(texture.mipmapMode), texture.uploadId);
+
+  return texture;
+
+exit_vk_texture_free_pending:
+  if (pending)
+    texture_downsample_pending_free(downsampler->vkDevice, pending);
+exit_vk_texture_free_sets:
+  free(downsampleSets);
+exit_vk_texture_free_regions:
+  free(regions);
+exit_vk_texture_destroy_image:
+  vkDestroyImageView(texture.vkDevice, texture.image.vkImageViews[0].view, hostCallbacks);
+  vkDestroyImage(texture.vkDevice, texture.image.vkImages[0].image, hostCallbacks);
+  uvr_vk_allocator_free(texture.image.allocator, &texture.image.allocations[0]);
+  free(texture.image.vkImages);
+  free(texture.image.vkImageViews);
+  free(texture.image.allocations);
+exit_vk_texture:
+  return (struct uvr_vk_texture) { .vkDevice = VK_NULL_HANDLE, .image = {}, .format = VK_FORMAT_UNDEFINED, .mipLevels = 0 };
 }
 
 
-struct uvr_vk_sync_obj uvr_vk_sync_obj_create(struct uvr_vk_sync_obj_create_info *uvrvk) {
-  VkResult res = VK_RESULT_MAX_ENUM;
-  struct uvr_vk_fence_handle *vkFences = NULL;
-  struct uvr_vk_semaphore_handle *vkSemaphores = NULL;
-  uint32_t s;
+struct uvr_vk_texture_stats uvr_vk_texture_get_stats(struct uvr_vk_texture *texture) {
+  struct uvr_vk_texture_stats stats;
 
-  vkFences = calloc(uvrvk->fenceCount, sizeof(vkFences));
-  if (!vkFences) {
-    uvr_utils_log(UVR_DANGER, "[x] calloc: %s", strerror(errno));
-    goto exit_vk_sync_obj;
+  memset(&stats, 0, sizeof(stats));
+
+  stats.uploadBytes = texture->uploadBytes;
+  stats.stageMs = (double) texture->stageNs / 1000000.0;
+  stats.mipmapMs = (double) texture->mipmapNs / 1000000.0;
+  stats.mipLevels = texture->mipLevels;
+  stats.mipmapMode = texture->mipmapMode;
+
+  return stats;
+}
+
+
+void uvr_vk_destory(struct uvr_vk_destroy *uvrvk) {
+  uint32_t i, j;
+
+  /* Queued resources are waited on through the fences they were pushed with, so flush before those go away */
+  if (uvrvk->uvr_vk_deletion_queue) {
+    for (i = 0; i < uvrvk->uvr_vk_deletion_queue_cnt; i++) {
+      uvr_vk_deletion_queue_flush(&uvrvk->uvr_vk_deletion_queue[i]);
+      free(uvrvk->uvr_vk_deletion_queue[i].entries);
+    }
   }
 
-  vkSemaphores = calloc(uvrvk->semaphoreCount, sizeof(vkSemaphores));
-  if (!vkSemaphores) {
-    uvr_utils_log(UVR_DANGER, "[x] calloc: %s", strerror(errno));
-    goto exit_vk_sync_obj_free_vk_fence;
+  if (uvrvk->uvr_vk_frame_ring) {
+    for (i = 0; i < uvrvk->uvr_vk_frame_ring_cnt; i++) {
+      sync_obj_destroy(&uvrvk->uvr_vk_frame_ring[i].vkSyncs);
+      sync_obj_destroy(&uvrvk->uvr_vk_frame_ring[i].vkPresentSyncs);
+      command_buffer_destroy(&uvrvk->uvr_vk_frame_ring[i].vkCommandbuffs);
+      free(uvrvk->uvr_vk_frame_ring[i].imageFences);
+
+      /* Frame fences were waited on above, nothing references retired swapchains anymore */
+      for (j = 0; j < uvrvk->uvr_vk_frame_ring[i].retiredCount; j++)
+        swapchain_retired_destroy(&uvrvk->uvr_vk_frame_ring[i].retired[j]);
+      free(uvrvk->uvr_vk_frame_ring[i].retired);
+    }
   }
 
-  VkFenceCreateInfo fence_create_info = {};
-  fence_create_info.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-  fence_create_info.pNext = NULL;
-  fence_create_info.flags = VK_FENCE_CREATE_SIGNALED_BIT;
+  /* Frame ring fences were waited on above, no replayed command buffer is pending */
+  if (uvrvk->uvr_vk_command_replay) {
+    for (i = 0; i < uvrvk->uvr_vk_command_replay_cnt; i++) {
+      if (uvrvk->uvr_vk_command_replay[i].vkDevice && uvrvk->uvr_vk_command_replay[i].vkCommandPool)
+        vkDestroyCommandPool(uvrvk->uvr_vk_command_replay[i].vkDevice, uvrvk->uvr_vk_command_replay[i].vkCommandPool, hostCallbacks);
+      free(uvrvk->uvr_vk_command_replay[i].images);
+      free(uvrvk->uvr_vk_command_replay[i].vkQueryBuffers);
+    }
+  }
 
-  VkSemaphoreCreateInfo semphore_create_info = {};
-  semphore_create_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
-  semphore_create_info.pNext = NULL;
-  semphore_create_info.flags = 0;
+  if (uvrvk->uvr_vk_headless_target) {
+    for (i = 0; i < uvrvk->uvr_vk_headless_target_cnt; i++) {
+      struct uvr_vk_headless_target *target = &uvrvk->uvr_vk_headless_target[i];
 
-  for (s = 0; s < uvrvk->fenceCount; s++) {
-    res = vkCreateFence(uvrvk->vkDevice, &fence_create_info, NULL, &vkFences[s].fence);
-    if (res) {
-      uvr_utils_log(UVR_DANGER, "[x] vkCreateFence: %s", vkres_msg(res));
-      goto exit_vk_sync_obj_destroy_vk_fence;
+      /* Waits on every frame fence, readbacks not drained by the application are dropped */
+      sync_obj_destroy(&target->vkSyncs);
+      command_buffer_destroy(&target->vkCommandbuffs);
+      free(target->pendingFrames);
+
+      if (target->readbackBuffer.vkBuffer) {
+        vkDestroyBuffer(target->vkDevice, target->readbackBuffer.vkBuffer, hostCallbacks);
+        uvr_vk_allocator_free(target->readbackBuffer.allocator, &target->readbackBuffer.allocation);
+      }
+
+      for (j = 0; j < target->images.imageCount; j++) {
+        vkDestroyImageView(target->vkDevice, target->images.vkImageViews[j].view, hostCallbacks);
+        vkDestroyImage(target->vkDevice, target->images.vkImages[j].image, hostCallbacks);
+        uvr_vk_allocator_free(target->images.allocator, &target->images.allocations[j]);
+      }
+
+      free(target->images.vkImages);
+      free(target->images.vkImageViews);
+      free(target->images.allocations);
     }
   }
 
-  for (s = 0; s < uvrvk->semaphoreCount; s++) {
-    res = vkCreateSemaphore(uvrvk->vkDevice, &semphore_create_info, NULL, &vkSemaphores[s].semaphore);
-    if (res) {
-      uvr_utils_log(UVR_DANGER, "[x] vkCreateSemaphore: %s", vkres_msg(res));
-      goto exit_vk_sync_obj_destroy_vk_semaphore;
+  /* Textures and downsample resources may still be read by in flight uploads, the ring waits on those */
+  if (uvrvk->uvr_vk_upload_ring) {
+    for (i = 0; i < uvrvk->uvr_vk_upload_ring_cnt; i++) {
+      sync_obj_destroy(&uvrvk->uvr_vk_upload_ring[i].vkSyncs);
+      command_buffer_destroy(&uvrvk->uvr_vk_upload_ring[i].vkCommandbuffs);
+      if (uvrvk->uvr_vk_upload_ring[i].batches) {
+        for (j = 0; j < uvrvk->uvr_vk_upload_ring[i].batchCount; j++)
+          upload_batch_free(&uvrvk->uvr_vk_upload_ring[i].batches[j]);
+      }
+      free(uvrvk->uvr_vk_upload_ring[i].batches);
+      if (uvrvk->uvr_vk_upload_ring[i].buffer.vkDevice && uvrvk->uvr_vk_upload_ring[i].buffer.vkBuffer)
+        vkDestroyBuffer(uvrvk->uvr_vk_upload_ring[i].buffer.vkDevice, uvrvk->uvr_vk_upload_ring[i].buffer.vkBuffer, hostCallbacks);
+      uvr_vk_allocator_free(uvrvk->uvr_vk_upload_ring[i].buffer.allocator, &uvrvk->uvr_vk_upload_ring[i].buffer.allocation);
     }
   }
 
-  return (struct uvr_vk_sync_obj) { .vkDevice = uvrvk->vkDevice, .fenceCount = uvrvk->fenceCount, .vkFences = vkFences,
-                                    .semaphoreCount = uvrvk->semaphoreCount, .vkSemaphores = vkSemaphores };
+  if (uvrvk->uvr_vk_texture_downsampler) {
+    for (i = 0; i < uvrvk->uvr_vk_texture_downsampler_cnt; i++) {
+      struct uvr_vk_texture_downsampler *downsampler = &uvrvk->uvr_vk_texture_downsampler[i];
 
+      for (j = 0; j < downsampler->pendingCount; j++)
+        texture_downsample_pending_free(downsampler->vkDevice, &downsampler->pending[j]);
+      free(downsampler->pending);
 
-exit_vk_sync_obj_destroy_vk_semaphore:
-  for (s = 0; s < uvrvk->semaphoreCount; s++)
-    if (vkSemaphores[s].semaphore)
-      vkDestroySemaphore(uvrvk->vkDevice, vkSemaphores[s].semaphore, NULL);
-exit_vk_sync_obj_destroy_vk_fence:
-  for (s = 0; s < uvrvk->fenceCount; s++)
-    if (vkFences[s].fence)
-      vkDestroyFence(uvrvk->vkDevice, vkFences[s].fence, NULL);
-//exit_vk_sync_obj_free_vk_semaphore:
-  free(vkSemaphores);
-exit_vk_sync_obj_free_vk_fence:
-  free(vkFences);
-exit_vk_sync_obj:
-  return (struct uvr_vk_sync_obj) { .vkDevice = VK_NULL_HANDLE, .fenceCount = 0, .vkFences = NULL, .semaphoreCount = 0, .vkSemaphores = NULL };
-};
+      if (downsampler->vkDevice && downsampler->pipeline.computePipeline)
+        vkDestroyPipeline(downsampler->vkDevice, downsampler->pipeline.computePipeline, hostCallbacks);
+      if (downsampler->vkDevice && downsampler->vkPipelineLayout)
+        vkDestroyPipelineLayout(downsampler->vkDevice, downsampler->vkPipelineLayout, hostCallbacks);
+      if (downsampler->vkDevice && downsampler->vkDescriptorSetLayout)
+        vkDestroyDescriptorSetLayout(downsampler->vkDevice, downsampler->vkDescriptorSetLayout, hostCallbacks);
+    }
+  }
 
+  if (uvrvk->uvr_vk_texture) {
+    for (i = 0; i < uvrvk->uvr_vk_texture_cnt; i++) {
+      struct uvr_vk_texture *texture = &uvrvk->uvr_vk_texture[i];
 
-void uvr_vk_destory(struct uvr_vk_destroy *uvrvk) {
-  uint32_t i, j;
+      for (j = 0; j < texture->image.imageCount; j++) {
+        vkDestroyImageView(texture->vkDevice, texture->image.vkImageViews[j].view, hostCallbacks);
+        vkDestroyImage(texture->vkDevice, texture->image.vkImages[j].image, hostCallbacks);
+        uvr_vk_allocator_free(texture->image.allocator, &texture->image.allocations[j]);
+      }
+
+      free(texture->image.vkImages);
+      free(texture->image.vkImageViews);
+      free(texture->image.allocations);
+    }
+  }
+
+  if (uvrvk->uvr_vk_format_cache) {
+    for (i = 0; i < uvrvk->uvr_vk_format_cache_cnt; i++) {
+      if (!uvrvk->uvr_vk_format_cache[i].entries)
+        continue;
+      uvr_utils_log(UVR_INFO, "uvr_vk_destory: format cache %" PRIu64 " hit(s) %" PRIu64 " miss(es)",
+                              uvrvk->uvr_vk_format_cache[i].entries->hitCount, uvrvk->uvr_vk_format_cache[i].entries->missCount);
+      pthread_mutex_destroy(&uvrvk->uvr_vk_format_cache[i].entries->lock);
+      free(uvrvk->uvr_vk_format_cache[i].entries);
+    }
+  }
 
   if (uvrvk->uvr_vk_sync_obj) {
-    for (i = 0; i < uvrvk->uvr_vk_sync_obj_cnt; i++) {
-      for (j = 0; j < uvrvk->uvr_vk_sync_obj[i].fenceCount; j++) {
-        if (uvrvk->uvr_vk_sync_obj[i].vkFences[j].fence) {
-          vkWaitForFences(uvrvk->uvr_vk_sync_obj[i].vkDevice, 1, &uvrvk->uvr_vk_sync_obj[i].vkFences[j].fence, VK_TRUE, UINT64_MAX);
-          vkDestroyFence(uvrvk->uvr_vk_sync_obj[i].vkDevice, uvrvk->uvr_vk_sync_obj[i].vkFences[j].fence, NULL);
+    for (i = 0; i < uvrvk->uvr_vk_sync_obj_cnt; i++)
+      sync_obj_destroy(&uvrvk->uvr_vk_sync_obj[i]);
+  }
+
+  if (uvrvk->uvr_vk_command_buffer) {
+    for (i = 0; i < uvrvk->uvr_vk_command_buffer_cnt; i++)
+      command_buffer_destroy(&uvrvk->uvr_vk_command_buffer[i]);
+  }
+
+  if (uvrvk->uvr_vk_query_pool) {
+    for (i = 0; i < uvrvk->uvr_vk_query_pool_cnt; i++) {
+      if (uvrvk->uvr_vk_query_pool[i].vkDevice && uvrvk->uvr_vk_query_pool[i].vkTimestampPool)
+        vkDestroyQueryPool(uvrvk->uvr_vk_query_pool[i].vkDevice, uvrvk->uvr_vk_query_pool[i].vkTimestampPool, hostCallbacks);
+      if (uvrvk->uvr_vk_query_pool[i].vkDevice && uvrvk->uvr_vk_query_pool[i].vkStatisticsPool)
+        vkDestroyQueryPool(uvrvk->uvr_vk_query_pool[i].vkDevice, uvrvk->uvr_vk_query_pool[i].vkStatisticsPool, hostCallbacks);
+      free(uvrvk->uvr_vk_query_pool[i].frames);
+      free(uvrvk->uvr_vk_query_pool[i].scopes);
+      free(uvrvk->uvr_vk_query_pool[i].names);
+      free(uvrvk->uvr_vk_query_pool[i].historyCount);
+      free(uvrvk->uvr_vk_query_pool[i].history);
+      free(uvrvk->uvr_vk_query_pool[i].results);
+    }
+  }
+
+  if (uvrvk->uvr_vk_command_recorder) {
+    for (i = 0; i < uvrvk->uvr_vk_command_recorder_cnt; i++) {
+      if (uvrvk->uvr_vk_command_recorder[i].threadPool)
+        uvr_utils_thread_pool_destroy(uvrvk->uvr_vk_command_recorder[i].threadPool);
+      for (j = 0; j < uvrvk->uvr_vk_command_recorder[i].threadCount; j++)
+        command_buffer_destroy(&uvrvk->uvr_vk_command_recorder[i].threadCommandbuffs[j]);
+      free(uvrvk->uvr_vk_command_recorder[i].threadCommandbuffs);
+      free(uvrvk->uvr_vk_command_recorder[i].threadPool);
+    }
+  }
+
+  if (uvrvk->uvr_vk_bindless_table) {
+    for (i = 0; i < uvrvk->uvr_vk_bindless_table_cnt; i++) {
+      if (uvrvk->uvr_vk_bindless_table[i].vkDevice && uvrvk->uvr_vk_bindless_table[i].vkDescriptorPool)
+        vkDestroyDescriptorPool(uvrvk->uvr_vk_bindless_table[i].vkDevice, uvrvk->uvr_vk_bindless_table[i].vkDescriptorPool, hostCallbacks);
+      if (uvrvk->uvr_vk_bindless_table[i].vkDevice && uvrvk->uvr_vk_bindless_table[i].vkDescriptorSetLayout)
+        vkDestroyDescriptorSetLayout(uvrvk->uvr_vk_bindless_table[i].vkDevice, uvrvk->uvr_vk_bindless_table[i].vkDescriptorSetLayout, hostCallbacks);
+      free(uvrvk->uvr_vk_bindless_table[i].freeSlots);
+      free(uvrvk->uvr_vk_bindless_table[i].liveSlots);
+      free(uvrvk->uvr_vk_bindless_table[i].retired);
+    }
+  }
+
+  if (uvrvk->uvr_vk_descriptor_allocator) {
+    for (i = 0; i < uvrvk->uvr_vk_descriptor_allocator_cnt; i++) {
+      struct uvr_vk_descriptor_allocator *dalloc = &uvrvk->uvr_vk_descriptor_allocator[i];
+
+      if (dalloc->threads) {
+        for (j = 0; j < dalloc->threadCount; j++) {
+          for (uint32_t p = 0; p < dalloc->threads[j].freeCount; p++)
+            vkDestroyDescriptorPool(dalloc->vkDevice, dalloc->threads[j].freePools[p], hostCallbacks);
+          free(dalloc->threads[j].freePools);
         }
       }
-      for (j = 0; j < uvrvk->uvr_vk_sync_obj[i].semaphoreCount; j++) {
-        if (uvrvk->uvr_vk_sync_obj[i].vkSemaphores[j].semaphore) {
-          vkDestroySemaphore(uvrvk->uvr_vk_sync_obj[i].vkDevice, uvrvk->uvr_vk_sync_obj[i].vkSemaphores[j].semaphore, NULL);
+
+      if (dalloc->framePools) {
+        for (j = 0; j < dalloc->frameCount * dalloc->threadCount; j++) {
+          for (uint32_t p = 0; p < dalloc->framePools[j].poolCount; p++)
+            vkDestroyDescriptorPool(dalloc->vkDevice, dalloc->framePools[j].pools[p], hostCallbacks);
+          free(dalloc->framePools[j].pools);
         }
       }
-      free(uvrvk->uvr_vk_sync_obj[i].vkFences);
-      free(uvrvk->uvr_vk_sync_obj[i].vkSemaphores);
-    }
-  }
 
-  if (uvrvk->uvr_vk_command_buffer) {
-    for (i = 0; i < uvrvk->uvr_vk_command_buffer_cnt; i++) {
-      if (uvrvk->uvr_vk_command_buffer[i].vkDevice && uvrvk->uvr_vk_command_buffer[i].vkCommandPool)
-        vkDestroyCommandPool(uvrvk->uvr_vk_command_buffer[i].vkDevice, uvrvk->uvr_vk_command_buffer[i].vkCommandPool, NULL);
-      free(uvrvk->uvr_vk_command_buffer[i].vkCommandbuffers);
+      if (dalloc->layoutCache) {
+        for (j = 0; j < dalloc->layoutCache->entryCount; j++) {
+          vkDestroyDescriptorSetLayout(dalloc->vkDevice, dalloc->layoutCache->entries[j].layout, hostCallbacks);
+          layout_entry_free(&dalloc->layoutCache->entries[j]);
+        }
+        pthread_mutex_destroy(&dalloc->layoutCache->lock);
+        free(dalloc->layoutCache->entries);
+      }
+
+      free(dalloc->layoutCache);
+      free(dalloc->framePools);
+      free(dalloc->threads);
+      free(dalloc->poolSizes);
     }
   }
 
@@ -991,7 +9468,7 @@ void uvr_vk_destory(struct uvr_vk_destroy *uvrvk) {
     for (i = 0; i < uvrvk->uvr_vk_framebuffer_cnt; i++) {
       for (j = 0; j < uvrvk->uvr_vk_framebuffer[i].frameBufferCount; j++) {
         if (uvrvk->uvr_vk_framebuffer[i].vkDevice && uvrvk->uvr_vk_framebuffer[i].vkFrameBuffers[j].fb)
-          vkDestroyFramebuffer(uvrvk->uvr_vk_framebuffer[i].vkDevice, uvrvk->uvr_vk_framebuffer[i].vkFrameBuffers[j].fb, NULL);
+          vkDestroyFramebuffer(uvrvk->uvr_vk_framebuffer[i].vkDevice, uvrvk->uvr_vk_framebuffer[i].vkFrameBuffers[j].fb, hostCallbacks);
       }
       free(uvrvk->uvr_vk_framebuffer[i].vkFrameBuffers);
     }
@@ -1000,28 +9477,127 @@ void uvr_vk_destory(struct uvr_vk_destroy *uvrvk) {
   if (uvrvk->uvr_vk_graphics_pipeline) {
     for (i = 0; i < uvrvk->uvr_vk_graphics_pipeline_cnt; i++) {
       if (uvrvk->uvr_vk_graphics_pipeline[i].vkDevice && uvrvk->uvr_vk_graphics_pipeline[i].graphicsPipeline)
-        vkDestroyPipeline(uvrvk->uvr_vk_graphics_pipeline[i].vkDevice, uvrvk->uvr_vk_graphics_pipeline[i].graphicsPipeline, NULL);
+        vkDestroyPipeline(uvrvk->uvr_vk_graphics_pipeline[i].vkDevice, uvrvk->uvr_vk_graphics_pipeline[i].graphicsPipeline, hostCallbacks);
+    }
+  }
+
+  if (uvrvk->uvr_vk_compute_pipeline) {
+    for (i = 0; i < uvrvk->uvr_vk_compute_pipeline_cnt; i++) {
+      if (uvrvk->uvr_vk_compute_pipeline[i].vkDevice && uvrvk->uvr_vk_compute_pipeline[i].computePipeline)
+        vkDestroyPipeline(uvrvk->uvr_vk_compute_pipeline[i].vkDevice, uvrvk->uvr_vk_compute_pipeline[i].computePipeline, hostCallbacks);
+    }
+  }
+
+  if (uvrvk->uvr_vk_pipeline_library) {
+    for (i = 0; i < uvrvk->uvr_vk_pipeline_library_cnt; i++) {
+      struct uvr_vk_pipeline_library *library = &uvrvk->uvr_vk_pipeline_library[i];
+      struct uvr_vk_pipeline_library_variant *variant, *next;
+
+      /* Joins the worker, optimized links still in flight finish first */
+      if (library->threadPool) {
+        uvr_utils_thread_pool_destroy(library->threadPool);
+        free(library->threadPool);
+      }
+
+      for (variant = library->variants; variant; variant = next) {
+        next = variant->next;
+        if (variant->optimizedPipeline)
+          vkDestroyPipeline(variant->vkDevice, variant->optimizedPipeline, hostCallbacks);
+        if (variant->fastPipeline)
+          vkDestroyPipeline(variant->vkDevice, variant->fastPipeline, hostCallbacks);
+        if (variant->libraries[3])
+          vkDestroyPipeline(variant->vkDevice, variant->libraries[3], hostCallbacks);
+        free(variant);
+      }
+
+      if (library->vkDevice) {
+        if (library->fragmentShader)
+          vkDestroyPipeline(library->vkDevice, library->fragmentShader, hostCallbacks);
+        if (library->preRasterization)
+          vkDestroyPipeline(library->vkDevice, library->preRasterization, hostCallbacks);
+        if (library->vertexInput)
+          vkDestroyPipeline(library->vkDevice, library->vertexInput, hostCallbacks);
+      }
+    }
+  }
+
+  if (uvrvk->uvr_vk_object_cache) {
+    for (i = 0; i < uvrvk->uvr_vk_object_cache_cnt; i++) {
+      struct uvr_vk_object_cache_tables *tables = uvrvk->uvr_vk_object_cache[i].tables;
+      VkDevice vkDevice = uvrvk->uvr_vk_object_cache[i].vkDevice;
+      uint32_t e;
+
+      if (!tables)
+        continue;
+
+      uvr_utils_log(UVR_INFO, "uvr_vk_destory: object cache pipelines %" PRIu64 " hit(s) %" PRIu64 " miss(es), "
+                              "render passes %" PRIu64 " hit(s) %" PRIu64 " miss(es), samplers %" PRIu64 " hit(s) %" PRIu64 " miss(es)",
+                              tables->pipelines.hits, tables->pipelines.misses, tables->renderPasses.hits,
+                              tables->renderPasses.misses, tables->samplers.hits, tables->samplers.misses);
+
+      /* Pipelines first, they may have been created against cached render passes */
+      for (e = 0; e < tables->pipelines.entryCount; e++) {
+        vkDestroyPipeline(vkDevice, tables->pipelines.entries[e].handle.pipeline, hostCallbacks);
+        free(tables->pipelines.entries[e].key);
+      }
+
+      for (e = 0; e < tables->renderPasses.entryCount; e++) {
+        vkDestroyRenderPass(vkDevice, tables->renderPasses.entries[e].handle.renderPass, hostCallbacks);
+        free(tables->renderPasses.entries[e].key);
+      }
+
+      for (e = 0; e < tables->samplers.entryCount; e++) {
+        vkDestroySampler(vkDevice, tables->samplers.entries[e].handle.sampler, hostCallbacks);
+        free(tables->samplers.entries[e].key);
+      }
+
+      free(tables->pipelines.entries);
+      free(tables->pipelines.buckets);
+      free(tables->renderPasses.entries);
+      free(tables->renderPasses.buckets);
+      free(tables->samplers.entries);
+      free(tables->samplers.buckets);
+      pthread_mutex_destroy(&tables->lock);
+      free(tables);
     }
   }
 
   if (uvrvk->uvr_vk_pipeline_layout) {
     for (i = 0; i < uvrvk->uvr_vk_pipeline_layout_cnt; i++) {
       if (uvrvk->uvr_vk_pipeline_layout[i].vkDevice && uvrvk->uvr_vk_pipeline_layout[i].vkPipelineLayout)
-        vkDestroyPipelineLayout(uvrvk->uvr_vk_pipeline_layout[i].vkDevice, uvrvk->uvr_vk_pipeline_layout[i].vkPipelineLayout, NULL);
+        vkDestroyPipelineLayout(uvrvk->uvr_vk_pipeline_layout[i].vkDevice, uvrvk->uvr_vk_pipeline_layout[i].vkPipelineLayout, hostCallbacks);
+    }
+  }
+
+  if (uvrvk->uvr_vk_pipeline_cache) {
+    for (i = 0; i < uvrvk->uvr_vk_pipeline_cache_cnt; i++) {
+      if (uvrvk->uvr_vk_pipeline_cache[i].vkDevice && uvrvk->uvr_vk_pipeline_cache[i].vkPipelineCache) {
+        if (uvrvk->uvr_vk_pipeline_cache[i].filePath)
+          uvr_vk_pipeline_cache_store(&uvrvk->uvr_vk_pipeline_cache[i]);
+        vkDestroyPipelineCache(uvrvk->uvr_vk_pipeline_cache[i].vkDevice, uvrvk->uvr_vk_pipeline_cache[i].vkPipelineCache, hostCallbacks);
+      }
     }
   }
 
   if (uvrvk->uvr_vk_render_pass) {
     for (i = 0; i < uvrvk->uvr_vk_render_pass_cnt; i++) {
       if (uvrvk->uvr_vk_render_pass[i].vkDevice && uvrvk->uvr_vk_render_pass[i].renderPass)
-        vkDestroyRenderPass(uvrvk->uvr_vk_render_pass[i].vkDevice, uvrvk->uvr_vk_render_pass[i].renderPass, NULL);
+        vkDestroyRenderPass(uvrvk->uvr_vk_render_pass[i].vkDevice, uvrvk->uvr_vk_render_pass[i].renderPass, hostCallbacks);
     }
   }
 
   if (uvrvk->uvr_vk_shader_module) {
     for (i = 0; i < uvrvk->uvr_vk_shader_module_cnt; i++) {
       if (uvrvk->uvr_vk_shader_module[i].vkDevice && uvrvk->uvr_vk_shader_module[i].shader)
-        vkDestroyShaderModule(uvrvk->uvr_vk_shader_module[i].vkDevice, uvrvk->uvr_vk_shader_module[i].shader, NULL);
+        vkDestroyShaderModule(uvrvk->uvr_vk_shader_module[i].vkDevice, uvrvk->uvr_vk_shader_module[i].shader, hostCallbacks);
+    }
+  }
+
+  if (uvrvk->uvr_vk_buffer) {
+    for (i = 0; i < uvrvk->uvr_vk_buffer_cnt; i++) {
+      if (uvrvk->uvr_vk_buffer[i].vkDevice && uvrvk->uvr_vk_buffer[i].vkBuffer)
+        vkDestroyBuffer(uvrvk->uvr_vk_buffer[i].vkDevice, uvrvk->uvr_vk_buffer[i].vkBuffer, hostCallbacks);
+      uvr_vk_allocator_free(uvrvk->uvr_vk_buffer[i].allocator, &uvrvk->uvr_vk_buffer[i].allocation);
     }
   }
 
@@ -1029,29 +9605,49 @@ void uvr_vk_destory(struct uvr_vk_destroy *uvrvk) {
     for (i = 0; i < uvrvk->uvr_vk_image_cnt; i++) {
       for (j = 0; j < uvrvk->uvr_vk_image[i].imageCount; j++) {
         if (uvrvk->uvr_vk_image[i].vkDevice && uvrvk->uvr_vk_image[i].vkImageViews[j].view)
-          vkDestroyImageView(uvrvk->uvr_vk_image[i].vkDevice, uvrvk->uvr_vk_image[i].vkImageViews[j].view, NULL);
+          vkDestroyImageView(uvrvk->uvr_vk_image[i].vkDevice, uvrvk->uvr_vk_image[i].vkImageViews[j].view, hostCallbacks);
+        /* Swapchain images are owned by the swapchain, only destroy images uvr_vk_image_create2 created */
+        if (uvrvk->uvr_vk_image[i].allocations) {
+          if (uvrvk->uvr_vk_image[i].vkDevice && uvrvk->uvr_vk_image[i].vkImages[j].image)
+            vkDestroyImage(uvrvk->uvr_vk_image[i].vkDevice, uvrvk->uvr_vk_image[i].vkImages[j].image, hostCallbacks);
+          uvr_vk_allocator_free(uvrvk->uvr_vk_image[i].allocator, &uvrvk->uvr_vk_image[i].allocations[j]);
+        }
       }
       free(uvrvk->uvr_vk_image[i].vkImages);
       free(uvrvk->uvr_vk_image[i].vkImageViews);
+      free(uvrvk->uvr_vk_image[i].allocations);
+    }
+  }
+
+  if (uvrvk->uvr_vk_allocator) {
+    for (i = 0; i < uvrvk->uvr_vk_allocator_cnt; i++) {
+      for (j = 0; j < uvrvk->uvr_vk_allocator[i].blockCount; j++)
+        block_destroy(&uvrvk->uvr_vk_allocator[i], uvrvk->uvr_vk_allocator[i].blocks[j]);
+      free(uvrvk->uvr_vk_allocator[i].blocks);
     }
   }
 
   if (uvrvk->uvr_vk_swapchain) {
     for (i = 0; i < uvrvk->uvr_vk_swapchain_cnt; i++) {
       if (uvrvk->uvr_vk_swapchain[i].vkDevice && uvrvk->uvr_vk_swapchain[i].vkSwapchain)
-        vkDestroySwapchainKHR(uvrvk->uvr_vk_swapchain[i].vkDevice, uvrvk->uvr_vk_swapchain[i].vkSwapchain, NULL);
+        vkDestroySwapchainKHR(uvrvk->uvr_vk_swapchain[i].vkDevice, uvrvk->uvr_vk_swapchain[i].vkSwapchain, hostCallbacks);
     }
   }
 
   for (i = 0; i < uvrvk->uvr_vk_lgdev_cnt; i++) {
     if (uvrvk->uvr_vk_lgdev[i].vkDevice) {
       vkDeviceWaitIdle(uvrvk->uvr_vk_lgdev[i].vkDevice);
-      vkDestroyDevice(uvrvk->uvr_vk_lgdev[i].vkDevice, NULL);
+      vkDestroyDevice(uvrvk->uvr_vk_lgdev[i].vkDevice, hostCallbacks);
     }
+    dispatch_destroy(uvrvk->uvr_vk_lgdev[i].dispatch);
   }
 
   if (uvrvk->vksurf)
-    vkDestroySurfaceKHR(uvrvk->vkinst, uvrvk->vksurf, NULL);
-  if (uvrvk->vkinst)
-    vkDestroyInstance(uvrvk->vkinst, NULL);
+    vkDestroySurfaceKHR(uvrvk->vkinst, uvrvk->vksurf, hostCallbacks);
+  if (uvrvk->vkinst) {
+    vkDestroyInstance(uvrvk->vkinst, hostCallbacks);
+#ifdef INCLUDE_VULKAN_DLOPEN
+    loader_close();
+#endif
+  }
 }